@@ -0,0 +1,198 @@
+/**
+ * @file ili9481_driver.h
+ * @brief ILI9481 TFT panel driver on the SPI HAL
+ *
+ * Sends the areas the display layer flushes (framebuffer dirty rectangles or
+ * display-list bands) as windowed RAM writes: CASET/PASET set the column and
+ * page window, RAMWR streams the pixels. Column or page ranges the panel
+ * already has are not sent again, so consecutive bands over the same columns
+ * cost a PASET and a RAMWR each.
+ *
+ * Pixels go out by DMA (hal_spi_transfer_async()). ili9481_push() returns
+ * once its transfers are queued; ili9481_wait() waits for them, and has to be
+ * called before the next push, as hal_display_flush() does with
+ * pico_display_set_output(ili9481_push, ili9481_wait, NULL).
+ *
+ * Vertical scrolling (VSCRDEF/VSCRSADD) rotates a range of the panel's 480
+ * gate lines - columns in landscape - so a strip chart moves by sending one
+ * new line and a two-byte start address instead of redrawing itself.
+ *
+ * On the host, include/mock_display.h stands in for the SPI bus and decodes
+ * the command stream back into panel memory.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef ILI9481_DRIVER_H
+#define ILI9481_DRIVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "hal_interface.h"
+#include "framebuffer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#define ILI9481_NATIVE_WIDTH 320 // Portrait; MADCTL row/column exchange swaps them
+#define ILI9481_NATIVE_HEIGHT 480
+
+// Commands used by the driver
+#define ILI9481_CMD_SLPIN 0x10
+#define ILI9481_CMD_SLPOUT 0x11
+#define ILI9481_CMD_DISPOFF 0x28
+#define ILI9481_CMD_DISPON 0x29
+#define ILI9481_CMD_CASET 0x2A
+#define ILI9481_CMD_PASET 0x2B
+#define ILI9481_CMD_RAMWR 0x2C
+#define ILI9481_CMD_VSCRDEF 0x33
+#define ILI9481_CMD_MADCTL 0x36
+#define ILI9481_CMD_VSCRSADD 0x37
+#define ILI9481_CMD_COLMOD 0x3A
+
+// MADCTL bits
+#define ILI9481_MADCTL_MV 0x20  // Row/column exchange (landscape)
+#define ILI9481_MADCTL_BGR 0x08 // Panel wired BGR
+#define ILI9481_MADCTL_SS 0x02  // Horizontal flip
+
+#define ILI9481_SLEEP_SETTLE_MS 120 // From SLPIN to SLPOUT at least
+#define ILI9481_WAKE_SETTLE_MS 20   // From SLPOUT to the next command (as in the init sequence)
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Pixel format on the wire (COLMOD)
+     */
+    typedef enum
+    {
+        ILI9481_RGB565 = 0x55, // 2 bytes per pixel, straight from the RGB565 buffers
+        ILI9481_RGB666 = 0x66  // 3 bytes per pixel: modules whose serial interface has no 16-bit mode
+    } ili9481_pixel_format_t;
+
+    /**
+     * @brief Panel wiring and placement
+     */
+    typedef struct
+    {
+        uint8_t spi_id;    // Initialized with hal_spi_init() beforehand
+        int16_t cs_pin;    // SPI_NO_PIN if tied low
+        int16_t dc_pin;    // Data/command select
+        int16_t rst_pin;   // SPI_NO_PIN if not wired
+        uint8_t madctl;    // Orientation (ILI9481_MADCTL_*)
+        uint16_t x_offset; // Where the screen's top-left pixel lands on the panel
+        uint16_t y_offset;
+        ili9481_pixel_format_t pixel_format;
+    } ili9481_config_t;
+
+    /**
+     * @brief What has crossed the bus since ili9481_init()
+     */
+    typedef struct
+    {
+        uint32_t pushes;          // Areas written
+        uint32_t window_commands; // CASET/PASET sent
+        uint32_t window_skipped;  // CASET/PASET the panel already had
+        uint64_t command_bytes;   // Command and parameter bytes
+        uint64_t pixel_bytes;     // RAMWR data
+    } ili9481_stats_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Reset and configure the panel, clear it to black and turn it on
+     * @param config Wiring and placement (copied)
+     * @return HAL status code
+     */
+    hal_status_t ili9481_init(const ili9481_config_t *config);
+
+    /**
+     * @brief Queue one area's pixels (a framebuffer_push_t)
+     * @param rect Area in screen coordinates
+     * @param pixels RGB565 pixels of its top-left corner; must stay unchanged until ili9481_wait()
+     * @param stride Pixels from one row to the next
+     * @param context Unused
+     */
+    void ili9481_push(const fb_rect_t *rect, const uint16_t *pixels, uint16_t stride, void *context);
+
+    /**
+     * @brief Wait until everything queued has been sent (a pico_display_wait_t)
+     * @param context Unused
+     */
+    void ili9481_wait(void *context);
+
+    /**
+     * @brief Fill a panel area with one colour
+     * @param x Left edge in panel coordinates
+     * @param y Top edge in panel coordinates
+     * @param width Area width
+     * @param height Area height
+     * @param color RGB565 colour
+     * @return HAL status code
+     */
+    hal_status_t ili9481_fill(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color);
+
+    /**
+     * @brief Set which lines scroll
+     *
+     * Lines run along the native 480-pixel side: columns in landscape
+     * (ILI9481_MADCTL_MV), rows in portrait. Lines outside the area stay put.
+     * Also scrolls the area back to its first line.
+     *
+     * @param first First line of the area (panel coordinates)
+     * @param count Lines in the area; 0 ends scrolling
+     * @return HAL status code
+     */
+    hal_status_t ili9481_set_scroll_area(uint16_t first, uint16_t count);
+
+    /**
+     * @brief Queue a scroll: show memory line 'line' at the start of the scroll area
+     *
+     * The lines after it follow, wrapping around within the area. Like
+     * ili9481_push(), needs an ili9481_wait() before the next call.
+     *
+     * @param line Line within the scroll area (panel coordinates)
+     */
+    void ili9481_scroll_to(uint16_t line);
+
+    /**
+     * @brief Put the panel to sleep or wake it
+     *
+     * Asleep, the display is off and the panel draws next to no current, but
+     * keeps its memory: waking shows the screen as it was. Waking waits out
+     * the panel's settling times, up to ILI9481_SLEEP_SETTLE_MS if it went to
+     * sleep only just before.
+     *
+     * @param sleep true for DISPOFF and SLPIN, false for SLPOUT and DISPON
+     * @return HAL status code
+     */
+    hal_status_t ili9481_set_sleep(bool sleep);
+
+    /**
+     * @brief Get bus counters
+     * @param stats Receives the counters
+     */
+    void ili9481_get_stats(ili9481_stats_t *stats);
+
+    /**
+     * @brief Panel size in the configured orientation
+     */
+    void ili9481_get_size(uint16_t *width, uint16_t *height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ILI9481_DRIVER_H
@@ -0,0 +1,107 @@
+/**
+ * @file mock_display.h
+ * @brief Host stand-in for an ILI9481 panel on the SPI bus
+ *
+ * Implements the SPI, GPIO and delay HAL calls the panel driver uses and
+ * decodes what is sent as the panel would: CASET/PASET windows, MADCTL,
+ * COLMOD, RAMWR pixels (RGB565 or RGB666), vertical scrolling, sleep and
+ * display on/off. The decoded panel memory, the image it shows once
+ * scrolling is applied, and a log of every command with the bytes that
+ * followed it let host tools check both what the panel shows and what it
+ * cost to get it there.
+ *
+ * Transfers complete at once; their callbacks run from hal_spi_poll(), as on
+ * the target.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef MOCK_DISPLAY_H
+#define MOCK_DISPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Bus traffic since the last mock_display_clear_counters()
+     */
+    typedef struct
+    {
+        uint64_t bytes;       // Everything sent
+        uint64_t pixel_bytes; // RAMWR data
+        uint32_t commands;    // Command bytes (DC low)
+        uint32_t windows;     // CASET and PASET commands
+        uint32_t ram_writes;  // RAMWR commands
+        uint32_t delay_ms;    // hal_delay_ms() total
+    } mock_display_counters_t;
+
+    /**
+     * @brief One logged command
+     */
+    typedef struct
+    {
+        uint8_t command;
+        uint32_t data_bytes; // Parameter or pixel bytes that followed it
+    } mock_display_command_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Power-on state: panel memory zeroed, asleep, display off, counters and log cleared
+     */
+    void mock_display_reset(void);
+
+    /**
+     * @brief Clear the counters and the command log
+     */
+    void mock_display_clear_counters(void);
+
+    /**
+     * @brief Get bus counters
+     * @param counters Receives the counters
+     */
+    void mock_display_get_counters(mock_display_counters_t *counters);
+
+    /**
+     * @brief Get the command log
+     * @param out Receives up to max entries, oldest first (may be NULL)
+     * @param max Entries out has room for
+     * @return Entries logged
+     */
+    size_t mock_display_get_commands(mock_display_command_t *out, size_t max);
+
+    /**
+     * @brief Panel memory as RGB565, in the orientation MADCTL set
+     * @param width Receives the row length
+     * @param height Receives the row count
+     */
+    const uint16_t *mock_display_get_pixels(uint16_t *width, uint16_t *height);
+
+    /**
+     * @brief What the panel shows: its memory with the scroll area rotated (VSCRDEF/VSCRSADD)
+     * @param width Receives the row length
+     * @param height Receives the row count
+     */
+    const uint16_t *mock_display_get_screen(uint16_t *width, uint16_t *height);
+
+    bool mock_display_is_on(void);
+    bool mock_display_is_sleeping(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOCK_DISPLAY_H
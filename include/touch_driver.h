@@ -0,0 +1,155 @@
+/**
+ * @file touch_driver.h
+ * @brief XPT2046 resistive touch controller driver on the SPI HAL
+ *
+ * Nothing runs while the screen is not touched: the controller's PENIRQ
+ * output falls when the pen goes down, and only that edge starts sampling.
+ * While the pen is down, a burst of conversions (pressure, then
+ * TOUCH_BURST_SAMPLES readings of each axis) is queued every sample
+ * interval as one DMA transfer (hal_spi_transfer_async()), at the
+ * controller's own clock, between whatever else is on the bus. Its
+ * completion callback does the filtering, and the last conversion powers
+ * the controller down with PENIRQ enabled again. Once the pressure drops,
+ * the interrupt is re-armed and the driver is idle again.
+ *
+ * Each burst is reduced to the median of each axis. A burst whose middle
+ * readings spread too far (the pen was landing, lifting or sliding fast) is
+ * dropped. The medians are smoothed by an IIR filter and mapped to screen
+ * coordinates by a three-point affine calibration. Taps, long presses and
+ * drags go into the input event queue (ui/input_handler.h).
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef TOUCH_DRIVER_H
+#define TOUCH_DRIVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "hal_interface.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+// Control bytes: start bit, channel, 12-bit differential mode, power-down bits
+#define XPT2046_CMD_X 0xD0     // X position
+#define XPT2046_CMD_Y 0x90     // Y position
+#define XPT2046_CMD_Z1 0xB0    // Pressure
+#define XPT2046_PD_ADC_ON 0x01 // Keep the ADC powered between conversions of a burst (PENIRQ off)
+
+#define TOUCH_BURST_SAMPLES 5   // Readings of each axis per burst, reduced to their median
+#define TOUCH_MAX_SPREAD 48     // Raw units the middle readings of a burst may spread over
+#define TOUCH_IIR_SHIFT 1       // Each burst moves the filtered position 1/2 of the way
+#define TOUCH_DRAG_THRESHOLD 8  // Pixels from the press point before it is a drag
+#define TOUCH_LONG_PRESS_MS 700 // Held in place this long: a long press
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    typedef struct
+    {
+        int16_t x;
+        int16_t y;
+    } touch_point_t;
+
+    /**
+     * @brief Raw readings to screen coordinates, in 16.16 fixed point
+     *
+     * x = (a * raw_x + b * raw_y + c) >> 16, y = (d * raw_x + e * raw_y + f) >> 16:
+     * covers scale, offset, swapped axes and a slightly rotated overlay.
+     */
+    typedef struct
+    {
+        int32_t a, b, c;
+        int32_t d, e, f;
+    } touch_calibration_t;
+
+    /**
+     * @brief Controller wiring and behaviour
+     */
+    typedef struct
+    {
+        uint8_t spi_id;        // Initialized with hal_spi_init() beforehand; may be shared
+        int16_t cs_pin;        // Chip select
+        uint32_t irq_pin;      // PENIRQ: low while pressed
+        uint32_t frequency;    // SPI clock for the controller (2.5 MHz at most)
+        uint16_t width;        // Screen size: positions are clamped to it
+        uint16_t height;
+        uint16_t pressure_min; // Z1 reading below which the screen is not pressed
+        uint16_t interval_ms;  // Between bursts while pressed
+        touch_calibration_t calibration;
+    } touch_config_t;
+
+    /**
+     * @brief Counters since touch_init()
+     */
+    typedef struct
+    {
+        uint32_t pen_downs;      // PENIRQ edges that started sampling
+        uint32_t bursts;         // Bursts read
+        uint32_t rejected;       // ... dropped as noisy
+        uint32_t taps;
+        uint32_t long_presses;
+        uint32_t drags;
+        uint32_t events_dropped; // Events the input queue had no room for
+    } touch_stats_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Configure the controller and arm the pen-down interrupt
+     * @param config Wiring and behaviour (copied)
+     * @return HAL status code
+     */
+    hal_status_t touch_init(const touch_config_t *config);
+
+    /**
+     * @brief Queue the next burst while the pen is down (call every loop)
+     *
+     * Returns at once while the screen is not touched. Results arrive
+     * through hal_spi_poll().
+     */
+    void touch_update(void);
+
+    /**
+     * @brief Solve a calibration from three touches
+     * @param raw Raw readings at three screen points
+     * @param screen The screen points, not on one line
+     * @param calibration Receives the calibration
+     * @return false if the points are collinear
+     */
+    bool touch_calibrate(const touch_point_t raw[3], const touch_point_t screen[3],
+                         touch_calibration_t *calibration);
+
+    void touch_set_calibration(const touch_calibration_t *calibration);
+
+    /**
+     * @brief Current position while pressed
+     * @param point Receives the filtered screen position (may be NULL)
+     * @param raw Receives the filtered raw reading, e.g. for calibration (may be NULL)
+     * @return false while the screen is not touched
+     */
+    bool touch_get_position(touch_point_t *point, touch_point_t *raw);
+
+    /**
+     * @brief Get touch counters
+     * @param stats Receives the counters
+     */
+    void touch_get_stats(touch_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TOUCH_DRIVER_H
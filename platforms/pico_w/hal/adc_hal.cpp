@@ -13,6 +13,7 @@
 #include "../include/board_config.h"
 #include "pico/stdlib.h"
 #include "hardware/adc.h"
+#include "hardware/sync.h"
 #include <stdio.h>
 
 // =============================================================================
@@ -94,11 +95,12 @@ hal_status_t hal_adc_read(uint8_t channel, uint16_t *value)
         return HAL_INVALID_PARAM;
     }
 
-    // Select ADC input channel
+    // Select and convert atomically: the sampler reads other inputs from a
+    // timer interrupt, which could otherwise switch the mux in between
+    uint32_t irq_state = save_and_disable_interrupts();
     adc_select_input(channel);
-
-    // Read ADC (12-bit result)
-    *value = adc_read();
+    *value = adc_read(); // 12-bit result, ~2 us
+    restore_interrupts(irq_state);
 
     return HAL_OK;
 }
@@ -2,8 +2,36 @@
  * @file display_hal.cpp
  * @brief Display Hardware Abstraction Layer implementation for Raspberry Pi Pico W
  *
- * This file implements the Display HAL interface for the Pico W platform using
- * a console-based display simulation (simplified for build compatibility).
+ * DISPLAY_RENDER_MODE picks where drawing goes:
+ *  - DISPLAY_RENDER_FRAMEBUFFER: a full-screen RGB565 framebuffer
+ *    (DISPLAY_BUFFER_SIZE, statically allocated) that records which areas
+ *    changed;
+ *  - DISPLAY_RENDER_BANDS: a display list (src/utils/display_list.h) that
+ *    hal_display_flush() rasterizes DISPLAY_BAND_HEIGHT rows at a time.
+ * Either way hal_display_flush() hands only what changed to the output set
+ * with pico_display_set_output(), so a flush after an unchanged redraw sends
+ * nothing, and both send the same pixels. With DISPLAY_PANEL_ILI9481 the
+ * output starts out as the ILI9481 on SPI_DISPLAY_* (include/ili9481_driver.h).
+ *
+ * pico_display_scroll_area() hands a range of columns to the panel's
+ * hardware scrolling: flushes leave those columns alone, and
+ * pico_display_scroll_column() moves them one left by writing just the new
+ * column and a new scroll start.
+ *
+ * Everything sent to the panel (scrolled columns included) is also handed
+ * to the web display mirror (include/display_mirror.h), which does nothing
+ * until a viewer subscribes; pico_display_repaint_mirror() sends it a
+ * stripe of the screen without touching the panel.
+ *
+ * The backlight (DISPLAY_BACKLIGHT_PWM) follows hal_display_set_brightness()
+ * and the power state: dimmed, or off with the panel asleep. Asleep, flushes
+ * return at once and leave what was drawn pending; the panel keeps its
+ * memory, so on waking the next flush sends only what changed.
+ *
+ * Text goes through a cache of the strings on screen (src/utils/text_cache.h):
+ * redrawing a string that is already there does nothing, and a changed one
+ * repaints only the characters that differ. Every other drawing call tells
+ * the cache what it drew over.
  *
  * @author Multi-Channel Diagnostic Test Rig Team
  * @date 2025
@@ -11,18 +39,17 @@
 
 #include "../utils/hal_interface.h"
 #include "../include/board_config.h"
+#include "../include/pico_display.h"
+#include "../include/display_mirror.h"
+#include "framebuffer.h"
+#include "display_list.h"
+#include "text_cache.h"
+#include "ili9481_driver.h"
 #include "pico/stdlib.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
-// =============================================================================
-// PRIVATE CONSTANTS
-// =============================================================================
-
-#define DISPLAY_COMMAND_BUFFER_SIZE 256
-#define MAX_TEXT_LENGTH 64
-
 // =============================================================================
 // PRIVATE TYPES
 // =============================================================================
@@ -33,10 +60,24 @@ typedef struct
     uint16_t width;
     uint16_t height;
     uint8_t brightness;
-    uint32_t bg_color;
-    uint32_t last_pixel_x;
-    uint32_t last_pixel_y;
-    uint32_t last_pixel_color;
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_BANDS
+    display_list_t list;
+#else
+    framebuffer_t fb;
+#endif
+    text_cache_t text;
+    bool status_drawn; // pico_display_show_status() background is on screen
+    framebuffer_push_t output;
+    pico_display_wait_t output_wait;
+    void *output_context;
+    bool panel_ready;      // The ILI9481 answered: hardware scrolling is available
+    uint16_t scroll_x;     // Columns [scroll_x, scroll_x + scroll_width) scroll; width 0 when none do
+    uint16_t scroll_width;
+    uint16_t scroll_start; // Panel line shown at the area's left edge: the oldest column
+    bool mirror_only;      // Flushing for the mirror: the panel is up to date already
+    pico_display_power_t power;
+    bool panel_behind;     // Changes went to the mirror alone while asleep: repaint on waking
+    pico_display_stats_t stats;
 } display_context_t;
 
 // =============================================================================
@@ -45,12 +86,255 @@ typedef struct
 
 static display_context_t display_ctx = {};
 
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_BANDS
+// Bands of rows, rasterized and pushed one at a time in turn
+static uint16_t display_pixels[DISPLAY_BAND_BUFFERS * DISPLAY_WIDTH * DISPLAY_BAND_HEIGHT];
+#else
+// 150 KB: the largest single allocation in the firmware
+static uint16_t display_pixels[DISPLAY_BUFFER_SIZE / sizeof(uint16_t)];
+#endif
+
 // =============================================================================
-// PRIVATE FUNCTION DECLARATIONS
+// PRIVATE FUNCTIONS
 // =============================================================================
 
-static uint32_t rgb888_to_rgb565(uint32_t rgb888);
-static void log_display_operation(const char *operation, const char *details);
+// The drawing surface of the configured render mode; false when a draw was dropped
+
+static bool surface_init(void)
+{
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_BANDS
+    return display_list_init(&display_ctx.list, display_ctx.width, display_ctx.height, DISPLAY_BAND_HEIGHT);
+#else
+    // Start black, and send all of it once: the panel's contents are unknown
+    memset(display_pixels, 0, sizeof(display_pixels));
+    framebuffer_init(&display_ctx.fb, display_pixels, display_ctx.width, display_ctx.height);
+    framebuffer_invalidate(&display_ctx.fb, 0, 0, display_ctx.width, display_ctx.height);
+    return true;
+#endif
+}
+
+static bool surface_fill_rect(int x, int y, int width, int height, uint16_t color)
+{
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_BANDS
+    return display_list_fill_rect(&display_ctx.list, x, y, width, height, color);
+#else
+    framebuffer_fill_rect(&display_ctx.fb, x, y, width, height, color);
+    return true;
+#endif
+}
+
+static bool surface_draw_rect(int x, int y, int width, int height, uint16_t color)
+{
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_BANDS
+    return display_list_draw_rect(&display_ctx.list, x, y, width, height, color);
+#else
+    framebuffer_draw_rect(&display_ctx.fb, x, y, width, height, color);
+    return true;
+#endif
+}
+
+static bool surface_set_pixel(int x, int y, uint16_t color)
+{
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_BANDS
+    return display_list_set_pixel(&display_ctx.list, x, y, color);
+#else
+    framebuffer_set_pixel(&display_ctx.fb, x, y, color);
+    return true;
+#endif
+}
+
+static bool surface_draw_text(int x, int y, const char *text, uint16_t fg, uint16_t bg)
+{
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_BANDS
+    return display_list_draw_text(&display_ctx.list, x, y, text, fg, bg);
+#else
+    framebuffer_draw_text(&display_ctx.fb, x, y, text, fg, bg);
+    return true;
+#endif
+}
+
+static bool surface_blit(int x, int y, int width, int height, const uint8_t *data)
+{
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_BANDS
+    return display_list_blit(&display_ctx.list, x, y, width, height, data);
+#else
+    framebuffer_blit(&display_ctx.fb, x, y, width, height, data);
+    return true;
+#endif
+}
+
+static void surface_invalidate(int x, int y, int width, int height)
+{
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_BANDS
+    display_list_invalidate(&display_ctx.list, x, y, width, height);
+#else
+    framebuffer_invalidate(&display_ctx.fb, x, y, width, height);
+#endif
+}
+
+static bool surface_is_dirty(void)
+{
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_BANDS
+    return display_list_is_dirty(&display_ctx.list);
+#else
+    return framebuffer_is_dirty(&display_ctx.fb);
+#endif
+}
+
+static void wait_output(void)
+{
+    if (display_ctx.output_wait)
+    {
+        display_ctx.output_wait(display_ctx.output_context);
+    }
+}
+
+/**
+ * @brief Send an area on to the output
+ */
+static void output_push(const fb_rect_t *rect, const uint16_t *pixels, uint16_t stride)
+{
+    if (display_ctx.mirror_only)
+    {
+        return;
+    }
+    display_ctx.stats.rects_pushed++;
+    if (display_ctx.output)
+    {
+        // One push in flight at a time: in band mode the other buffer is drawn meanwhile
+        wait_output();
+        display_ctx.output(rect, pixels, stride, display_ctx.output_context);
+    }
+}
+
+/**
+ * @brief Send an area to the mirror and the output
+ */
+static void send_area(const fb_rect_t *rect, const uint16_t *pixels, uint16_t stride)
+{
+#if WEB_DISPLAY_ENABLED && WEB_DISPLAY_WEBSOCKET
+    display_mirror_push(rect, pixels, stride);
+#endif
+    output_push(rect, pixels, stride);
+}
+
+/**
+ * @brief Count an area on its way to the output, leaving out the scrolling columns
+ *
+ * Panel memory under the scroll area is rotated against the screen, and
+ * holds the chart rather than what was drawn there.
+ */
+static void count_push(const fb_rect_t *rect, const uint16_t *pixels, uint16_t stride, void *context)
+{
+    (void)context;
+    uint16_t scroll_end = (uint16_t)(display_ctx.scroll_x + display_ctx.scroll_width);
+    if (display_ctx.scroll_width == 0 || rect->x >= scroll_end || rect->x + rect->width <= display_ctx.scroll_x)
+    {
+        send_area(rect, pixels, stride);
+        return;
+    }
+
+    if (rect->x < display_ctx.scroll_x)
+    {
+        fb_rect_t left = *rect;
+        left.width = (uint16_t)(display_ctx.scroll_x - rect->x);
+        send_area(&left, pixels, stride);
+    }
+    if (rect->x + rect->width > scroll_end)
+    {
+        fb_rect_t right = *rect;
+        right.x = scroll_end;
+        right.width = (uint16_t)(rect->x + rect->width - scroll_end);
+        send_area(&right, &pixels[scroll_end - rect->x], stride);
+    }
+}
+
+static size_t surface_flush(void)
+{
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_BANDS
+    // The buffer a push used is drawn into again only after the next push has waited for it
+    return display_list_flush(&display_ctx.list, display_pixels, DISPLAY_BAND_BUFFERS, count_push, NULL);
+#else
+    // Drawing changes the pixels the last push is still sending
+    size_t pixels = framebuffer_flush(&display_ctx.fb, count_push, NULL);
+    wait_output();
+    return pixels;
+#endif
+}
+
+/**
+ * @brief Turn a surface result into a HAL status, counting dropped draws
+ */
+static hal_status_t surface_status(bool ok)
+{
+    if (!ok)
+    {
+        display_ctx.stats.draws_dropped++;
+        return HAL_BUSY;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief Set the backlight for the brightness and power state
+ */
+static void backlight_update(void)
+{
+#if DISPLAY_BACKLIGHT_PWM
+    uint8_t percent = display_ctx.brightness;
+    if (display_ctx.power == PICO_DISPLAY_ASLEEP)
+    {
+        percent = 0;
+    }
+    else if (display_ctx.power == PICO_DISPLAY_DIMMED && percent > DISPLAY_DIM_BRIGHTNESS)
+    {
+        percent = DISPLAY_DIM_BRIGHTNESS;
+    }
+    hal_pwm_set_duty(DISPLAY_BACKLIGHT_SLICE, DISPLAY_BACKLIGHT_CHANNEL, percent);
+#endif
+}
+
+static void panel_sleep(bool sleep)
+{
+#if DISPLAY_PANEL_ILI9481
+    if (display_ctx.panel_ready)
+    {
+        ili9481_set_sleep(sleep);
+    }
+#else
+    (void)sleep;
+#endif
+}
+
+#if DISPLAY_PANEL_ILI9481
+/**
+ * @brief Bring up SPI_DISPLAY_* and the ILI9481 on it
+ */
+static hal_status_t panel_init(void)
+{
+    spi_config_t spi = {};
+    spi.frequency = SPI_DISPLAY_FREQUENCY;
+    spi.mode = 0;
+    spi.data_bits = 8;
+    spi.msb_first = true;
+    hal_status_t status = hal_spi_init(0, &spi);
+    if (status != HAL_OK)
+    {
+        return status;
+    }
+
+    ili9481_config_t panel = {};
+    panel.spi_id = 0;
+    panel.cs_pin = SPI_DISPLAY_CS_PIN;
+    panel.dc_pin = SPI_DISPLAY_DC_PIN;
+    panel.rst_pin = SPI_DISPLAY_RST_PIN;
+    panel.madctl = DISPLAY_PANEL_MADCTL;
+    panel.x_offset = DISPLAY_PANEL_X_OFFSET;
+    panel.y_offset = DISPLAY_PANEL_Y_OFFSET;
+    panel.pixel_format = DISPLAY_PANEL_RGB666 ? ILI9481_RGB666 : ILI9481_RGB565;
+    return ili9481_init(&panel);
+}
+#endif
 
 // =============================================================================
 // PUBLIC FUNCTIONS
@@ -72,17 +356,46 @@ hal_status_t hal_display_init(void)
     // Initialize display context
     display_ctx.width = DISPLAY_WIDTH;
     display_ctx.height = DISPLAY_HEIGHT;
-    display_ctx.brightness = 100;  // Full brightness
-    display_ctx.bg_color = 0x0000; // Black background
-    display_ctx.last_pixel_x = 0;
-    display_ctx.last_pixel_y = 0;
-    display_ctx.last_pixel_color = 0;
+    display_ctx.brightness = 100; // Full brightness
+    memset(&display_ctx.stats, 0, sizeof(display_ctx.stats));
+    text_cache_init(&display_ctx.text, FRAMEBUFFER_GLYPH_WIDTH, FRAMEBUFFER_GLYPH_HEIGHT);
+
+    if (!surface_init())
+    {
+        printf("[DISPLAY] Band height %d does not fit the display list\n", DISPLAY_BAND_HEIGHT);
+        return HAL_INIT_FAILED;
+    }
 
     display_ctx.initialized = true;
 
-    printf("[DISPLAY] Console-based display initialized (%dx%d)\n",
-           display_ctx.width, display_ctx.height);
-    printf("[DISPLAY] Display simulation active - commands will be logged\n");
+#if DISPLAY_PANEL_ILI9481
+    if (panel_init() == HAL_OK)
+    {
+        pico_display_set_output(ili9481_push, ili9481_wait, NULL);
+        display_ctx.panel_ready = true;
+    }
+    else
+    {
+        printf("[DISPLAY] No ILI9481 panel, web display only\n");
+    }
+#endif
+
+    display_ctx.power = PICO_DISPLAY_ON;
+#if DISPLAY_BACKLIGHT_PWM
+    if (hal_pwm_init(DISPLAY_BACKLIGHT_SLICE, DISPLAY_BACKLIGHT_FREQUENCY) == HAL_OK)
+    {
+        backlight_update();
+        hal_pwm_start(DISPLAY_BACKLIGHT_SLICE, DISPLAY_BACKLIGHT_CHANNEL);
+    }
+#endif
+
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_BANDS
+    printf("[DISPLAY] %dx%d RGB565 in %d-row bands ready (%u bytes)\n", display_ctx.width, display_ctx.height,
+           DISPLAY_BAND_HEIGHT, (unsigned)(sizeof(display_pixels) + sizeof(display_ctx.list)));
+#else
+    printf("[DISPLAY] %dx%d RGB565 framebuffer ready (%u bytes)\n", display_ctx.width, display_ctx.height,
+           (unsigned)sizeof(display_pixels));
+#endif
 
     return HAL_OK;
 }
@@ -100,8 +413,21 @@ hal_status_t hal_display_deinit(void)
 
     printf("[DISPLAY] Deinitializing display...\n");
 
-    // Clear display state
+    // Clear display state (the output stays attached)
+    wait_output();
+    framebuffer_push_t output = display_ctx.output;
+    pico_display_wait_t output_wait = display_ctx.output_wait;
+    void *output_context = display_ctx.output_context;
+#if DISPLAY_PANEL_ILI9481
+    if (display_ctx.scroll_width > 0)
+    {
+        ili9481_set_scroll_area(0, 0);
+    }
+#endif
     memset(&display_ctx, 0, sizeof(display_context_t));
+    display_ctx.output = output;
+    display_ctx.output_wait = output_wait;
+    display_ctx.output_context = output_context;
 
     printf("[DISPLAY] Display deinitialized\n");
 
@@ -120,20 +446,14 @@ hal_status_t hal_display_clear(uint32_t color)
         return HAL_ERROR;
     }
 
-    uint32_t rgb565_color = rgb888_to_rgb565(color); (void)rgb565_color;
-    display_ctx.bg_color = rgb565_color;
-
-    char details[64];
-    snprintf(details, sizeof(details), "color=0x%06lX (RGB565: 0x%04lX)",
-             color, rgb565_color);
-    log_display_operation("CLEAR", details);
-
-    return HAL_OK;
+    text_cache_clear(&display_ctx.text);
+    display_ctx.status_drawn = false;
+    return surface_status(surface_fill_rect(0, 0, display_ctx.width, display_ctx.height, framebuffer_rgb565(color)));
 }
 
 /**
  * @brief Update display with buffer data
- * @param buffer Display buffer structure
+ * @param buffer Display buffer structure (little-endian RGB565 pixels)
  * @return HAL status code
  */
 hal_status_t hal_display_update(const display_buffer_t *buffer)
@@ -150,15 +470,15 @@ hal_status_t hal_display_update(const display_buffer_t *buffer)
         return HAL_INVALID_PARAM;
     }
 
-    char details[128];
-    snprintf(details, sizeof(details),
-             "pos=(%d,%d) size=%dx%d bytes=%zu",
-             buffer->x_offset, buffer->y_offset,
-             buffer->width, buffer->height,
-             buffer->data_size);
-    log_display_operation("UPDATE", details);
+    if (buffer->data == nullptr || buffer->data_size < (size_t)buffer->width * buffer->height * 2)
+    {
+        return HAL_INVALID_PARAM;
+    }
 
-    return HAL_OK;
+    // Band mode keeps the pointer: the buffer has to outlive the flush
+    text_cache_invalidate(&display_ctx.text, buffer->x_offset, buffer->y_offset, buffer->width, buffer->height);
+    return surface_status(
+        surface_blit(buffer->x_offset, buffer->y_offset, buffer->width, buffer->height, buffer->data));
 }
 
 /**
@@ -180,25 +500,8 @@ hal_status_t hal_display_set_pixel(uint16_t x, uint16_t y, uint32_t color)
         return HAL_INVALID_PARAM;
     }
 
-    uint32_t rgb565_color = rgb888_to_rgb565(color); (void)rgb565_color;
-
-    // Store last pixel operation
-    display_ctx.last_pixel_x = x;
-    display_ctx.last_pixel_y = y;
-    display_ctx.last_pixel_color = rgb565_color;
-
-    // Only log occasional pixels to avoid spam
-    static uint32_t pixel_count = 0;
-    pixel_count++;
-
-    if (pixel_count % 100 == 1)
-    { // Log every 100th pixel
-        char details[64];
-        snprintf(details, sizeof(details), "pos=(%d,%d) color=0x%06lX", x, y, color);
-        log_display_operation("PIXEL", details);
-    }
-
-    return HAL_OK;
+    text_cache_invalidate(&display_ctx.text, x, y, 1, 1);
+    return surface_status(surface_set_pixel(x, y, framebuffer_rgb565(color)));
 }
 
 /**
@@ -224,15 +527,12 @@ hal_status_t hal_display_draw_rect(uint16_t x, uint16_t y, uint16_t width, uint1
         return HAL_INVALID_PARAM;
     }
 
-    uint32_t rgb565_color = rgb888_to_rgb565(color); (void)rgb565_color;
-
-    char details[128];
-    snprintf(details, sizeof(details),
-             "pos=(%d,%d) size=%dx%d color=0x%06lX %s",
-             x, y, width, height, color, filled ? "filled" : "outline");
-    log_display_operation("RECT", details);
-
-    return HAL_OK;
+    text_cache_invalidate(&display_ctx.text, x, y, width, height);
+    if (filled)
+    {
+        return surface_status(surface_fill_rect(x, y, width, height, framebuffer_rgb565(color)));
+    }
+    return surface_status(surface_draw_rect(x, y, width, height, framebuffer_rgb565(color)));
 }
 
 /**
@@ -256,21 +556,44 @@ hal_status_t hal_display_draw_text(uint16_t x, uint16_t y, const char *text, uin
         return HAL_INVALID_PARAM;
     }
 
-    // Truncate text if too long
-    char safe_text[MAX_TEXT_LENGTH];
-    strncpy(safe_text, text, sizeof(safe_text) - 1);
-    safe_text[sizeof(safe_text) - 1] = '\0';
-
-    uint32_t rgb565_color = rgb888_to_rgb565(color); (void)rgb565_color;
-    uint32_t rgb565_bg = rgb888_to_rgb565(bg_color); (void)rgb565_bg;
+    uint16_t fg = framebuffer_rgb565(color);
+    uint16_t bg = framebuffer_rgb565(bg_color);
+    text_cache_change_t change;
+    if (!text_cache_update(&display_ctx.text, x, y, text, fg, bg, &change))
+    {
+        display_ctx.stats.text_unchanged++;
+        return HAL_OK;
+    }
 
-    char details[256];
-    snprintf(details, sizeof(details),
-             "pos=(%d,%d) text=\"%s\" color=0x%06lX bg=0x%06lX",
-             x, y, safe_text, color, bg_color);
-    log_display_operation("TEXT", details);
+    // Text running off the right edge is clipped
+    size_t length = strlen(text);
+    bool ok = true;
+    if (change.count == length)
+    {
+        ok = surface_draw_text(x, y, text, fg, bg);
+    }
+    else if (change.count > 0)
+    {
+        // Only the characters that changed (a partial change is of a cached, so short, string)
+        char part[TEXT_CACHE_MAX_LENGTH + 1];
+        memcpy(part, &text[change.first], change.count);
+        part[change.count] = '\0';
+        ok = surface_draw_text(x + change.first * FRAMEBUFFER_GLYPH_WIDTH, y, part, fg, bg);
+        display_ctx.stats.text_partial++;
+    }
+    if (ok && change.erase > 0)
+    {
+        // Cells a longer string left behind
+        ok = surface_fill_rect(x + (int)length * FRAMEBUFFER_GLYPH_WIDTH, y, change.erase * FRAMEBUFFER_GLYPH_WIDTH,
+                               FRAMEBUFFER_GLYPH_HEIGHT, bg);
+    }
 
-    return HAL_OK;
+    if (!ok)
+    {
+        text_cache_invalidate(&display_ctx.text, x, y, (int)(length + change.erase) * FRAMEBUFFER_GLYPH_WIDTH,
+                              FRAMEBUFFER_GLYPH_HEIGHT);
+    }
+    return surface_status(ok);
 }
 
 /**
@@ -291,16 +614,16 @@ hal_status_t hal_display_set_brightness(uint8_t brightness)
     }
 
     display_ctx.brightness = brightness;
-
-    char details[32];
-    snprintf(details, sizeof(details), "level=%d%%", brightness);
-    log_display_operation("BRIGHTNESS", details);
+    backlight_update();
 
     return HAL_OK;
 }
 
 /**
  * @brief Flush display buffer to screen
+ *
+ * Only the areas that changed since the last flush are sent.
+ *
  * @return HAL status code
  */
 hal_status_t hal_display_flush(void)
@@ -310,47 +633,219 @@ hal_status_t hal_display_flush(void)
         return HAL_ERROR;
     }
 
-    log_display_operation("FLUSH", "rendering complete");
+    if (display_ctx.power == PICO_DISPLAY_ASLEEP)
+    {
+        return HAL_OK; // Pending until the panel wakes
+    }
+
+    display_ctx.stats.flushes++;
+    if (!surface_is_dirty())
+    {
+        display_ctx.stats.empty_flushes++;
+        return HAL_OK;
+    }
+
+    uint64_t start_us = hal_get_time_us();
+    display_ctx.stats.pixels_pushed += surface_flush();
+    display_ctx.stats.last_flush_us = (uint32_t)(hal_get_time_us() - start_us);
 
     return HAL_OK;
 }
 
 // =============================================================================
-// PRIVATE FUNCTIONS
+// HELPER FUNCTIONS
 // =============================================================================
 
 /**
- * @brief Convert RGB888 to RGB565 format
- * @param rgb888 24-bit RGB color
- * @return 16-bit RGB565 color
+ * @brief Set where flushed areas go
+ * @param push Called once per changed area, NULL to only count them
+ * @param wait Waits for the last push to be sent, NULL if push sends before returning
+ * @param context Passed to push and wait
  */
-static uint32_t rgb888_to_rgb565(uint32_t rgb888)
+void pico_display_set_output(framebuffer_push_t push, pico_display_wait_t wait, void *context)
 {
-    uint8_t r = (rgb888 >> 16) & 0xFF;
-    uint8_t g = (rgb888 >> 8) & 0xFF;
-    uint8_t b = rgb888 & 0xFF;
+    wait_output();
+    display_ctx.output = push;
+    display_ctx.output_wait = wait;
+    display_ctx.output_context = context;
+}
 
-    // Convert to 5-6-5 format
-    uint16_t r565 = (r >> 3) & 0x1F;
-    uint16_t g565 = (g >> 2) & 0x3F;
-    uint16_t b565 = (b >> 3) & 0x1F;
+/**
+ * @brief Mark the whole screen changed
+ */
+void pico_display_invalidate(void)
+{
+    if (display_ctx.initialized)
+    {
+        surface_invalidate(0, 0, display_ctx.width, display_ctx.height);
+    }
+}
+
+/**
+ * @brief Hand a range of columns to the panel's hardware scrolling
+ * @param x First column
+ * @param width Columns, 0 to end scrolling
+ * @return false without a panel that scrolls, or for a range off the screen
+ */
+bool pico_display_scroll_area(uint16_t x, uint16_t width)
+{
+#if DISPLAY_PANEL_ILI9481
+    if (!display_ctx.initialized || !display_ctx.panel_ready || x + width > display_ctx.width)
+    {
+        return false;
+    }
 
-    return (r565 << 11) | (g565 << 5) | b565;
+    // Whatever was drawn there goes out first: it is what the area starts from
+    hal_display_flush();
+    wait_output();
+
+    if (display_ctx.scroll_width > 0)
+    {
+        // The old area's memory is rotated: it gets repainted from the surface
+        surface_invalidate(display_ctx.scroll_x, 0, display_ctx.scroll_width, display_ctx.height);
+    }
+
+    uint16_t first = (uint16_t)(x + DISPLAY_PANEL_X_OFFSET);
+    if (ili9481_set_scroll_area(width > 0 ? first : 0, width) != HAL_OK)
+    {
+        display_ctx.scroll_width = 0;
+        return false;
+    }
+    display_ctx.scroll_x = x;
+    display_ctx.scroll_width = width;
+    display_ctx.scroll_start = first;
+    return true;
+#else
+    (void)x;
+    (void)width;
+    return false;
+#endif
 }
 
 /**
- * @brief Log display operation for debugging
- * @param operation Operation name
- * @param details Operation details
+ * @brief Scroll the scroll area one column left and show a new column at its right edge
+ * @param pixels DISPLAY_HEIGHT RGB565 pixels, top first
  */
-static void log_display_operation(const char *operation, const char *details)
+void pico_display_scroll_column(const uint16_t *pixels)
 {
-    printf("[DISPLAY] %s: %s\n", operation, details);
+#if DISPLAY_PANEL_ILI9481
+    if (display_ctx.scroll_width == 0 || pixels == NULL || display_ctx.power == PICO_DISPLAY_ASLEEP)
+    {
+        return;
+    }
+
+    // The oldest column's memory line becomes the newest once the start moves past it
+    fb_rect_t rect = {(uint16_t)(display_ctx.scroll_start - DISPLAY_PANEL_X_OFFSET), 0, 1, display_ctx.height};
+    output_push(&rect, pixels, 1);
+    uint16_t first = (uint16_t)(display_ctx.scroll_x + DISPLAY_PANEL_X_OFFSET);
+    display_ctx.scroll_start =
+        (uint16_t)(first + (display_ctx.scroll_start - first + 1) % display_ctx.scroll_width);
+    ili9481_scroll_to(display_ctx.scroll_start);
+#if WEB_DISPLAY_ENABLED && WEB_DISPLAY_WEBSOCKET
+    display_mirror_scroll(display_ctx.scroll_x, display_ctx.scroll_width, pixels, display_ctx.height);
+#endif
+
+    display_ctx.stats.columns_scrolled++;
+    display_ctx.stats.pixels_pushed += display_ctx.height;
+#else
+    (void)pixels;
+#endif
 }
 
-// =============================================================================
-// HELPER FUNCTIONS
-// =============================================================================
+/**
+ * @brief Send rows of the screen to the mirror alone
+ * @param y First row
+ * @param height Rows
+ */
+void pico_display_repaint_mirror(uint16_t y, uint16_t height)
+{
+    if (!display_ctx.initialized || y >= display_ctx.height)
+    {
+        return;
+    }
+
+    // Pending changes go to both, so only the repaint is left for the mirror alone.
+    // Asleep, they cannot: the mirror takes them now and the panel a full repaint on waking.
+    hal_display_flush();
+    wait_output();
+    if (display_ctx.power == PICO_DISPLAY_ASLEEP && surface_is_dirty())
+    {
+        display_ctx.panel_behind = true;
+    }
+
+    surface_invalidate(0, y, display_ctx.width, height);
+    display_ctx.mirror_only = true;
+    surface_flush();
+    display_ctx.mirror_only = false;
+}
+
+/**
+ * @brief Dim the backlight, or put the panel to sleep and wake it
+ * @param power New state
+ */
+void pico_display_set_power(pico_display_power_t power)
+{
+    if (!display_ctx.initialized || power == display_ctx.power)
+    {
+        return;
+    }
+
+    pico_display_power_t previous = display_ctx.power;
+    display_ctx.power = power;
+
+    // Dark before the panel turns off, lit only once it is on again
+    if (power == PICO_DISPLAY_ASLEEP)
+    {
+        wait_output();
+        backlight_update();
+        panel_sleep(true);
+        display_ctx.stats.sleeps++;
+        printf("[DISPLAY] Asleep: rendering suspended\n");
+        return;
+    }
+
+    if (previous == PICO_DISPLAY_ASLEEP)
+    {
+        panel_sleep(false);
+        if (display_ctx.panel_behind)
+        {
+            pico_display_invalidate();
+            display_ctx.panel_behind = false;
+        }
+        printf("[DISPLAY] Awake\n");
+    }
+    backlight_update();
+}
+
+pico_display_power_t pico_display_get_power(void)
+{
+    return display_ctx.power;
+}
+
+/**
+ * @brief Get the framebuffer behind the HAL
+ * @return Framebuffer, NULL before initialization or in band mode
+ */
+framebuffer_t *pico_display_get_framebuffer(void)
+{
+#if DISPLAY_RENDER_MODE == DISPLAY_RENDER_BANDS
+    return NULL;
+#else
+    return display_ctx.initialized ? &display_ctx.fb : NULL;
+#endif
+}
+
+/**
+ * @brief Get flush counters
+ * @param stats Receives the counters
+ */
+void pico_display_get_stats(pico_display_stats_t *stats)
+{
+    if (stats)
+    {
+        *stats = display_ctx.stats;
+    }
+}
 
 /**
  * @brief Get display dimensions
@@ -401,24 +896,26 @@ void pico_display_draw_progress_bar(uint16_t x, uint16_t y, uint16_t width, uint
         return;
     }
 
-    // Draw background
-    hal_display_draw_rect(x, y, width, height, bg_color, true);
+    if (width < 2 || height < 2)
+    {
+        return;
+    }
 
-    // Draw progress
+    // Filled and empty parts side by side inside the border: no pixel is
+    // painted twice, so a bar redrawn at the same value leaves nothing to flush
     uint16_t progress_width = (width * progress) / 100;
-    if (progress_width > 0)
+    uint16_t split = progress_width < 1 ? 1 : (progress_width > width - 1 ? width - 1 : progress_width);
+    if (split > 1)
+    {
+        hal_display_draw_rect(x + 1, y + 1, split - 1, height - 2, fg_color, true);
+    }
+    if (split < width - 1)
     {
-        hal_display_draw_rect(x, y, progress_width, height, fg_color, true);
+        hal_display_draw_rect(x + split, y + 1, width - 1 - split, height - 2, bg_color, true);
     }
 
     // Draw border
     hal_display_draw_rect(x, y, width, height, 0xFFFFFF, false);
-
-    char details[128];
-    snprintf(details, sizeof(details),
-             "pos=(%d,%d) size=%dx%d progress=%d%% fg=0x%06lX bg=0x%06lX",
-             x, y, width, height, progress, fg_color, bg_color);
-    log_display_operation("PROGRESS", details);
 }
 
 /**
@@ -433,8 +930,12 @@ void pico_display_show_status(uint32_t uptime_ms, uint32_t loop_count)
         return;
     }
 
-    // Clear display
-    hal_display_clear(0x000080); // Dark blue background
+    // The background once: after that the text cache repaints only the strings that changed
+    if (!display_ctx.status_drawn)
+    {
+        hal_display_clear(0x000080); // Dark blue background
+        display_ctx.status_drawn = true;
+    }
 
     // Title
     hal_display_draw_text(10, 10, "Pico W Diagnostic Rig", 0xFFFFFF, 0x000080);
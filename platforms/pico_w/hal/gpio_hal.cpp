@@ -3,7 +3,9 @@
  * @brief GPIO Hardware Abstraction Layer implementation for Raspberry Pi Pico W
  *
  * This file implements the GPIO HAL interface for the Pico W platform using
- * the Pico SDK GPIO functions.
+ * the Pico SDK GPIO functions. The SDK has one GPIO interrupt callback per
+ * core; it dispatches to a callback per pin here, so drivers enabling
+ * interrupts on different pins do not replace each other's.
  *
  * @author Multi-Channel Diagnostic Test Rig Team
  * @date 2025
@@ -20,6 +22,20 @@
 // =============================================================================
 
 static bool gpio_subsystem_initialized = false;
+static void (*pin_callbacks[NUM_BANK0_GPIOS])(uint32_t pin) = {};
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static void gpio_irq_dispatch(uint gpio, uint32_t events)
+{
+    (void)events;
+    if (gpio < NUM_BANK0_GPIOS && pin_callbacks[gpio] != nullptr)
+    {
+        pin_callbacks[gpio](gpio);
+    }
+}
 
 // =============================================================================
 // PUBLIC FUNCTIONS
@@ -189,12 +205,19 @@ hal_status_t hal_gpio_interrupt_enable(uint32_t pin, uint8_t trigger_edge, void
     {
         return HAL_ERROR;
     }
+    if (pin >= NUM_BANK0_GPIOS)
+    {
+        return HAL_INVALID_PARAM;
+    }
 
     uint32_t events = 0;
     if (trigger_edge & 1) events |= GPIO_IRQ_EDGE_RISE;
     if (trigger_edge & 2) events |= GPIO_IRQ_EDGE_FALL;
 
-    gpio_set_irq_enabled_with_callback(pin, events, true, (gpio_irq_callback_t)callback);
+    // An edge that happened while the interrupt was off is not delivered late
+    gpio_acknowledge_irq(pin, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL);
+    pin_callbacks[pin] = callback;
+    gpio_set_irq_enabled_with_callback(pin, events, true, gpio_irq_dispatch);
 
     return HAL_OK;
 }
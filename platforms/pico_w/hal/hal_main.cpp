@@ -96,6 +96,15 @@ uint32_t hal_get_tick_ms(void)
     return to_ms_since_boot(get_absolute_time());
 }
 
+/**
+ * @brief Get time since boot in microseconds
+ * @return Monotonic 64-bit microsecond count
+ */
+uint64_t hal_get_time_us(void)
+{
+    return time_us_64();
+}
+
 /**
  * @brief Delay execution for specified milliseconds
  * @param ms Delay time in milliseconds
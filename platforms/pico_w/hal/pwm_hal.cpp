@@ -1,29 +1,164 @@
 /**
  * @file pwm_hal.cpp
- * @brief PWM HAL stub for Pico W
+ * @brief PWM Hardware Abstraction Layer implementation for Raspberry Pi Pico W
+ *
+ * pwm_id is an RP2040 PWM slice and channel is PWM_CHAN_A or PWM_CHAN_B.
+ * Both channels of a slice share its counter, so they run at one frequency:
+ * initializing a slice that is already running at another frequency fails
+ * rather than retuning the other channel's output. Each slice channel can
+ * drive two GPIOs; hal_pwm_start() uses the one the board wires to a PWM
+ * output (fan, buzzer, backlight).
  */
 
 #include "../utils/hal_interface.h"
+#include "../include/board_config.h"
+#include "pico/stdlib.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
 #include <stdio.h>
 
+#define PWM_SLICES 8
+
+typedef struct {
+    bool initialized;
+    uint32_t frequency;
+    uint16_t wrap;         // Counter top: duty steps are 1 / (wrap + 1)
+    uint16_t level[2];     // Per channel, kept while stopped
+    bool running[2];
+} pwm_context_t;
+
+static pwm_context_t pwm_contexts[PWM_SLICES] = {};
+
+// Board pins that carry PWM outputs
+static const uint8_t pwm_pins[] = {
+    FAN_CONTROL_PIN,
+    BUZZER_PIN,
+#if DISPLAY_BACKLIGHT_PWM
+    DISPLAY_BACKLIGHT_PIN,
+#endif
+};
+
+/**
+ * @brief Board pin driven by a slice channel, -1 if none is wired
+ */
+static int pwm_pin(uint8_t slice, uint8_t channel) {
+    for (size_t i = 0; i < sizeof(pwm_pins) / sizeof(pwm_pins[0]); i++) {
+        if (pwm_gpio_to_slice_num(pwm_pins[i]) == slice && pwm_gpio_to_channel(pwm_pins[i]) == channel) {
+            return pwm_pins[i];
+        }
+    }
+    return -1;
+}
+
+static bool pwm_valid(uint8_t pwm_id, uint8_t channel) {
+    return pwm_id < PWM_SLICES && channel <= PWM_CHAN_B && pwm_contexts[pwm_id].initialized;
+}
+
 hal_status_t hal_pwm_init(uint8_t pwm_id, uint32_t frequency_hz) {
-    printf("[PWM] PWM%d init stub (%lu Hz)\n", pwm_id, frequency_hz);
+    if (pwm_id >= PWM_SLICES || frequency_hz == 0) {
+        return HAL_INVALID_PARAM;
+    }
+
+    pwm_context_t *ctx = &pwm_contexts[pwm_id];
+    if (ctx->initialized) {
+        if (ctx->frequency == frequency_hz) {
+            return HAL_OK;
+        }
+        printf("[PWM] Slice %d already runs at %lu Hz; %lu Hz refused\n", pwm_id, (unsigned long)ctx->frequency,
+               (unsigned long)frequency_hz);
+        return HAL_BUSY;
+    }
+
+    // Smallest integer divider that fits the period in the 16-bit counter: the finest duty steps
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+    uint32_t divider = (uint32_t)(sys_hz / ((uint64_t)frequency_hz * 65536u)) + 1;
+    if (divider > 255) {
+        return HAL_INVALID_PARAM; // Below about 8 Hz at 125 MHz
+    }
+    uint32_t wrap = sys_hz / (divider * frequency_hz) - 1;
+    if (wrap == 0 || wrap > 0xFFFF) {
+        return HAL_INVALID_PARAM;
+    }
+
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_clkdiv_int(&config, divider);
+    pwm_config_set_wrap(&config, (uint16_t)wrap);
+    pwm_init(pwm_id, &config, false);
+    pwm_set_both_levels(pwm_id, 0, 0);
+
+    ctx->initialized = true;
+    ctx->frequency = frequency_hz;
+    ctx->wrap = (uint16_t)wrap;
+    ctx->level[0] = ctx->level[1] = 0;
+    ctx->running[0] = ctx->running[1] = false;
+
+    printf("[PWM] Slice %d at %lu Hz (%lu steps)\n", pwm_id, (unsigned long)frequency_hz, (unsigned long)wrap + 1);
     return HAL_OK;
 }
 
 hal_status_t hal_pwm_deinit(uint8_t pwm_id) {
+    if (pwm_id >= PWM_SLICES || !pwm_contexts[pwm_id].initialized) {
+        return HAL_OK;
+    }
+
+    hal_pwm_stop(pwm_id, PWM_CHAN_A);
+    hal_pwm_stop(pwm_id, PWM_CHAN_B);
+    pwm_set_enabled(pwm_id, false);
+    pwm_contexts[pwm_id].initialized = false;
     return HAL_OK;
 }
 
 hal_status_t hal_pwm_set_duty(uint8_t pwm_id, uint8_t channel, float duty_percent) {
-    printf("[PWM] PWM%d Ch%d duty: %.1f%%\n", pwm_id, channel, duty_percent);
+    if (!pwm_valid(pwm_id, channel) || duty_percent < 0.0f || duty_percent > 100.0f) {
+        return HAL_INVALID_PARAM;
+    }
+
+    // Level wrap + 1 holds the output high for the whole period
+    pwm_context_t *ctx = &pwm_contexts[pwm_id];
+    ctx->level[channel] = (uint16_t)((ctx->wrap + 1u) * duty_percent / 100.0f + 0.5f);
+    pwm_set_chan_level(pwm_id, channel, ctx->level[channel]);
     return HAL_OK;
 }
 
 hal_status_t hal_pwm_start(uint8_t pwm_id, uint8_t channel) {
+    if (!pwm_valid(pwm_id, channel)) {
+        return HAL_INVALID_PARAM;
+    }
+
+    int pin = pwm_pin(pwm_id, channel);
+    if (pin < 0) {
+        printf("[PWM] Slice %d channel %c drives no board pin\n", pwm_id, 'A' + channel);
+        return HAL_INVALID_PARAM;
+    }
+
+    pwm_context_t *ctx = &pwm_contexts[pwm_id];
+    pwm_set_chan_level(pwm_id, channel, ctx->level[channel]);
+    gpio_set_function((uint)pin, GPIO_FUNC_PWM);
+    ctx->running[channel] = true;
+    pwm_set_enabled(pwm_id, true);
     return HAL_OK;
 }
 
 hal_status_t hal_pwm_stop(uint8_t pwm_id, uint8_t channel) {
+    if (!pwm_valid(pwm_id, channel)) {
+        return HAL_INVALID_PARAM;
+    }
+
+    pwm_context_t *ctx = &pwm_contexts[pwm_id];
+    if (!ctx->running[channel]) {
+        return HAL_OK;
+    }
+
+    // The pin goes back to a plain low output: off, not frozen wherever the counter stopped
+    int pin = pwm_pin(pwm_id, channel);
+    gpio_init((uint)pin);
+    gpio_set_dir((uint)pin, GPIO_OUT);
+    gpio_put((uint)pin, 0);
+    ctx->running[channel] = false;
+
+    if (!ctx->running[PWM_CHAN_A] && !ctx->running[PWM_CHAN_B]) {
+        pwm_set_enabled(pwm_id, false);
+    }
     return HAL_OK;
 }
@@ -1,24 +1,412 @@
 /**
  * @file spi_hal.cpp
- * @brief SPI HAL stub for Pico W
+ * @brief SPI Hardware Abstraction Layer implementation for Raspberry Pi Pico W
+ *
+ * Each instance owns two DMA channels (TX and RX) and a ring of queued
+ * transfers. The RX channel's completion interrupt finishes the running
+ * transfer and starts the next one, setting its DC and CS pins first, so
+ * queued transfers follow each other without the CPU. A finished transfer
+ * with a callback keeps its slot until hal_spi_poll() has run the callback, so
+ * a completion is never lost and callbacks never run in interrupt context.
+ * A transfer can ask for a slower clock, so a device such as a touch
+ * controller can share a bus with a fast display; the instance's clock is
+ * restored for the next transfer that does not.
+ *
+ * hal_spi_transfer() waits for the queue to drain and then uses the SDK's
+ * blocking calls: for the few bytes of a sensor read that beats setting up
+ * DMA.
  */
 
 #include "../utils/hal_interface.h"
+#include "../include/board_config.h"
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
 #include <stdio.h>
+#include <string.h>
+
+#define MAX_SPI_INSTANCES 2
+#define SPI_QUEUE_DEPTH 16 // Transfers queued or awaiting their callback, per instance
+
+typedef struct {
+    spi_inst_t *instance;
+    bool initialized;
+    uint32_t baudrate;
+    uint8_t data_bits;    // Instance default
+    uint8_t format_bits;  // What the hardware is set to now
+    uint32_t clock;       // Transfer frequency the hardware is set to now, 0 for baudrate
+    spi_cpol_t cpol;
+    spi_cpha_t cpha;
+    int tx_channel;
+    int rx_channel;
+
+    // Slots [done, finished) await their callback, [finished, queued) are running or waiting.
+    // queued is written with interrupts off, finished by the interrupt, done by hal_spi_poll().
+    spi_transfer_t queue[SPI_QUEUE_DEPTH];
+    hal_status_t status[SPI_QUEUE_DEPTH];
+    volatile uint32_t queued;
+    volatile uint32_t finished;
+    uint32_t done;
+} spi_context_t;
+
+static spi_context_t spi_contexts[MAX_SPI_INSTANCES] = {};
+static bool dma_irq_installed = false;
+
+// Sent when a transfer has no TX buffer, and where RX goes when it has no RX buffer
+static const uint16_t spi_fill = 0xFFFF;
+static uint16_t spi_discard;
+
+static spi_inst_t *get_spi_instance(uint8_t spi_id) {
+    switch (spi_id) {
+        case 0: return spi0;
+        case 1: return spi1;
+        default: return NULL;
+    }
+}
+
+// =============================================================================
+// TRANSFER QUEUE
+// =============================================================================
+
+/**
+ * @brief Start the transfer at the head of the queue (interrupts off, or from the interrupt)
+ */
+static void start_transfer(spi_context_t *ctx) {
+    const spi_transfer_t *t = &ctx->queue[ctx->finished % SPI_QUEUE_DEPTH];
+    uint8_t bits = t->data_bits ? t->data_bits : ctx->data_bits;
+
+    if (bits != ctx->format_bits) {
+        spi_set_format(ctx->instance, bits, ctx->cpol, ctx->cpha, SPI_MSB_FIRST);
+        ctx->format_bits = bits;
+    }
+    if (t->frequency != ctx->clock) {
+        spi_set_baudrate(ctx->instance, t->frequency ? t->frequency : ctx->baudrate);
+        ctx->clock = t->frequency;
+    }
+    if (t->dc_pin != SPI_NO_PIN) {
+        gpio_put(t->dc_pin, t->dc_level);
+    }
+    if (t->cs_pin != SPI_NO_PIN) {
+        gpio_put(t->cs_pin, 0);
+    }
+
+    enum dma_channel_transfer_size size = bits > 8 ? DMA_SIZE_16 : DMA_SIZE_8;
+    uint32_t count = bits > 8 ? (uint32_t)(t->size / 2) : (uint32_t)t->size;
+    io_rw_32 *dr = &spi_get_hw(ctx->instance)->dr;
+
+    dma_channel_config tx = dma_channel_get_default_config(ctx->tx_channel);
+    channel_config_set_transfer_data_size(&tx, size);
+    channel_config_set_read_increment(&tx, t->tx_data != NULL && !t->tx_repeat);
+    channel_config_set_write_increment(&tx, false);
+    channel_config_set_dreq(&tx, spi_get_dreq(ctx->instance, true));
+    dma_channel_configure(ctx->tx_channel, &tx, dr, t->tx_data ? (const void *)t->tx_data : &spi_fill, count, false);
+
+    // RX always runs: it keeps the RX FIFO from overflowing, and its completion means the last bit is out
+    dma_channel_config rx = dma_channel_get_default_config(ctx->rx_channel);
+    channel_config_set_transfer_data_size(&rx, size);
+    channel_config_set_read_increment(&rx, false);
+    channel_config_set_write_increment(&rx, t->rx_data != NULL);
+    channel_config_set_dreq(&rx, spi_get_dreq(ctx->instance, false));
+    dma_channel_configure(ctx->rx_channel, &rx, t->rx_data ? (void *)t->rx_data : &spi_discard, dr, count, false);
+
+    dma_start_channel_mask((1u << ctx->tx_channel) | (1u << ctx->rx_channel));
+}
+
+/**
+ * @brief Retire the running transfer and start the next one
+ */
+static void finish_transfer(spi_context_t *ctx, hal_status_t status) {
+    uint32_t slot = ctx->finished % SPI_QUEUE_DEPTH;
+    int16_t cs_pin = ctx->queue[slot].cs_pin;
+    ctx->status[slot] = status;
+    ctx->finished++;
+
+    bool more = ctx->finished != ctx->queued;
+    const spi_transfer_t *next = more ? &ctx->queue[ctx->finished % SPI_QUEUE_DEPTH] : NULL;
+
+    // Back-to-back transfers to the same device keep it selected
+    if (cs_pin != SPI_NO_PIN && (next == NULL || next->cs_pin != cs_pin)) {
+        gpio_put(cs_pin, 1);
+    }
+    if (more) {
+        start_transfer(ctx);
+    }
+}
+
+/**
+ * @brief Stop the running transfer and fail everything queued (interrupts off)
+ */
+static void abort_transfers(spi_context_t *ctx, hal_status_t status) {
+    if (ctx->finished == ctx->queued) {
+        return;
+    }
+
+    // Abort with the interrupt masked: an abort can raise a spurious completion
+    dma_channel_set_irq0_enabled(ctx->rx_channel, false);
+    dma_channel_abort(ctx->tx_channel);
+    dma_channel_abort(ctx->rx_channel);
+    dma_channel_acknowledge_irq0(ctx->rx_channel);
+    dma_channel_set_irq0_enabled(ctx->rx_channel, true);
+
+    while (ctx->finished != ctx->queued) {
+        uint32_t slot = ctx->finished % SPI_QUEUE_DEPTH;
+        if (ctx->queue[slot].cs_pin != SPI_NO_PIN) {
+            gpio_put(ctx->queue[slot].cs_pin, 1);
+        }
+        ctx->status[slot] = status;
+        ctx->finished++;
+    }
+
+    // Whatever the aborted transfer left in the RX FIFO
+    while (spi_is_readable(ctx->instance)) {
+        (void)spi_get_hw(ctx->instance)->dr;
+    }
+}
+
+static void spi_dma_irq_handler(void) {
+    for (int i = 0; i < MAX_SPI_INSTANCES; i++) {
+        spi_context_t *ctx = &spi_contexts[i];
+        if (ctx->initialized && dma_channel_get_irq0_status(ctx->rx_channel)) {
+            dma_channel_acknowledge_irq0(ctx->rx_channel);
+            finish_transfer(ctx, HAL_OK);
+        }
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
 
 hal_status_t hal_spi_init(uint8_t spi_id, const spi_config_t *config) {
-    printf("[SPI] SPI%d init stub\n", spi_id);
+    if (spi_id >= MAX_SPI_INSTANCES || !config || config->mode > 3) {
+        return HAL_INVALID_PARAM;
+    }
+
+    // The RP2040's SPI shifts MSB first only; DMA moves 8- or 16-bit frames
+    if (!config->msb_first || config->data_bits < 4 || config->data_bits > 16) {
+        return HAL_NOT_SUPPORTED;
+    }
+
+    spi_context_t *ctx = &spi_contexts[spi_id];
+    if (ctx->initialized) {
+        hal_spi_deinit(spi_id);
+    }
+
+    spi_inst_t *spi = get_spi_instance(spi_id);
+    int tx_channel = dma_claim_unused_channel(false);
+    int rx_channel = dma_claim_unused_channel(false);
+    if (tx_channel < 0 || rx_channel < 0) {
+        if (tx_channel >= 0) {
+            dma_channel_unclaim(tx_channel);
+        }
+        printf("[SPI] SPI%d: no free DMA channels\n", spi_id);
+        return HAL_INIT_FAILED;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->instance = spi;
+    ctx->baudrate = spi_init(spi, config->frequency);
+    ctx->data_bits = config->data_bits;
+    ctx->format_bits = config->data_bits;
+    ctx->cpol = (config->mode & 2) ? SPI_CPOL_1 : SPI_CPOL_0;
+    ctx->cpha = (config->mode & 1) ? SPI_CPHA_1 : SPI_CPHA_0;
+    ctx->tx_channel = tx_channel;
+    ctx->rx_channel = rx_channel;
+    spi_set_format(spi, ctx->data_bits, ctx->cpol, ctx->cpha, SPI_MSB_FIRST);
+
+    // Configure GPIO pins; chip select idles high
+    uint cs_pin;
+    if (spi_id == 0) {
+        gpio_set_function(SPI_DISPLAY_SCK_PIN, GPIO_FUNC_SPI);
+        gpio_set_function(SPI_DISPLAY_MOSI_PIN, GPIO_FUNC_SPI);
+        gpio_set_function(SPI_DISPLAY_MISO_PIN, GPIO_FUNC_SPI);
+        cs_pin = SPI_DISPLAY_CS_PIN;
+    } else {
+        gpio_set_function(SPI_EXT_SCK_PIN, GPIO_FUNC_SPI);
+        gpio_set_function(SPI_EXT_MOSI_PIN, GPIO_FUNC_SPI);
+        gpio_set_function(SPI_EXT_MISO_PIN, GPIO_FUNC_SPI);
+        cs_pin = SPI_EXT_CS_PIN;
+    }
+    gpio_init(cs_pin);
+    gpio_set_dir(cs_pin, GPIO_OUT);
+    gpio_put(cs_pin, 1);
+
+    if (!dma_irq_installed) {
+        irq_add_shared_handler(DMA_IRQ_0, spi_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        dma_irq_installed = true;
+    }
+    dma_channel_set_irq0_enabled(rx_channel, true);
+
+    ctx->initialized = true;
+
+    printf("[SPI] SPI%d initialized at %lu Hz (DMA %d/%d)\n", spi_id, (unsigned long)ctx->baudrate, tx_channel,
+           rx_channel);
+
     return HAL_OK;
 }
 
 hal_status_t hal_spi_deinit(uint8_t spi_id) {
+    if (spi_id >= MAX_SPI_INSTANCES) {
+        return HAL_INVALID_PARAM;
+    }
+
+    spi_context_t *ctx = &spi_contexts[spi_id];
+    if (!ctx->initialized) {
+        return HAL_OK;
+    }
+
+    uint32_t irq_state = save_and_disable_interrupts();
+    abort_transfers(ctx, HAL_ERROR);
+    dma_channel_set_irq0_enabled(ctx->rx_channel, false);
+    ctx->initialized = false;
+    restore_interrupts(irq_state);
+
+    // Callbacks of what was aborted still run, reporting the failure
+    hal_spi_poll();
+
+    dma_channel_unclaim(ctx->tx_channel);
+    dma_channel_unclaim(ctx->rx_channel);
+    spi_deinit(ctx->instance);
+
+    return HAL_OK;
+}
+
+hal_status_t hal_spi_transfer_async(uint8_t spi_id, const spi_transfer_t *transfer) {
+    if (spi_id >= MAX_SPI_INSTANCES || !transfer || transfer->size == 0) {
+        return HAL_INVALID_PARAM;
+    }
+
+    spi_context_t *ctx = &spi_contexts[spi_id];
+    if (!ctx->initialized) {
+        return HAL_ERROR;
+    }
+
+    // 16-bit frames move halfwords: an even size, and aligned buffers
+    uint8_t bits = transfer->data_bits ? transfer->data_bits : ctx->data_bits;
+    if (bits > 16 || (bits > 8 && ((transfer->size & 1) || ((uintptr_t)transfer->tx_data & 1) ||
+                                   ((uintptr_t)transfer->rx_data & 1)))) {
+        return HAL_INVALID_PARAM;
+    }
+
+    // Finished transfers without a callback need no hal_spi_poll() to free their slot
+    while (ctx->done != ctx->finished && ctx->queue[ctx->done % SPI_QUEUE_DEPTH].callback == NULL) {
+        ctx->done++;
+    }
+
+    uint32_t irq_state = save_and_disable_interrupts();
+    if (ctx->queued - ctx->done >= SPI_QUEUE_DEPTH) {
+        restore_interrupts(irq_state);
+        return HAL_BUSY;
+    }
+
+    ctx->queue[ctx->queued % SPI_QUEUE_DEPTH] = *transfer;
+    bool idle = ctx->finished == ctx->queued;
+    ctx->queued++;
+    if (idle) {
+        start_transfer(ctx);
+    }
+    restore_interrupts(irq_state);
+
     return HAL_OK;
 }
 
+bool hal_spi_is_busy(uint8_t spi_id) {
+    if (spi_id >= MAX_SPI_INSTANCES || !spi_contexts[spi_id].initialized) {
+        return false;
+    }
+    return spi_contexts[spi_id].finished != spi_contexts[spi_id].queued;
+}
+
+hal_status_t hal_spi_wait(uint8_t spi_id, uint32_t timeout_ms) {
+    if (spi_id >= MAX_SPI_INSTANCES) {
+        return HAL_INVALID_PARAM;
+    }
+
+    spi_context_t *ctx = &spi_contexts[spi_id];
+    if (!ctx->initialized) {
+        return HAL_ERROR;
+    }
+
+    absolute_time_t deadline = make_timeout_time_ms(timeout_ms);
+    while (ctx->finished != ctx->queued) {
+        if (time_reached(deadline)) {
+            uint32_t irq_state = save_and_disable_interrupts();
+            abort_transfers(ctx, HAL_TIMEOUT);
+            restore_interrupts(irq_state);
+            printf("[SPI] SPI%d: transfers timed out after %lu ms, queue aborted\n", spi_id,
+                   (unsigned long)timeout_ms);
+            return HAL_TIMEOUT;
+        }
+        tight_loop_contents();
+    }
+
+    return HAL_OK;
+}
+
+void hal_spi_poll(void) {
+    for (uint8_t i = 0; i < MAX_SPI_INSTANCES; i++) {
+        spi_context_t *ctx = &spi_contexts[i];
+        while (ctx->done != ctx->finished) {
+            uint32_t slot = ctx->done % SPI_QUEUE_DEPTH;
+            spi_complete_callback_t callback = ctx->queue[slot].callback;
+            void *context = ctx->queue[slot].context;
+            hal_status_t status = ctx->status[slot];
+
+            // Free the slot first: the callback may queue the next transfer
+            ctx->done++;
+            if (callback) {
+                callback(i, status, context);
+            }
+        }
+    }
+}
+
 hal_status_t hal_spi_transfer(uint8_t spi_id, const uint8_t *tx_data, uint8_t *rx_data, size_t size, uint32_t timeout_ms) {
-    return HAL_NOT_SUPPORTED;
+    if (spi_id >= MAX_SPI_INSTANCES || (!tx_data && !rx_data) || size == 0) {
+        return HAL_INVALID_PARAM;
+    }
+
+    spi_context_t *ctx = &spi_contexts[spi_id];
+    if (!ctx->initialized) {
+        return HAL_ERROR;
+    }
+
+    // Queued transfers go first; once idle, nothing else touches the hardware
+    hal_status_t status = hal_spi_wait(spi_id, timeout_ms);
+    if (status != HAL_OK) {
+        return status;
+    }
+
+    if (ctx->format_bits != 8) {
+        spi_set_format(ctx->instance, 8, ctx->cpol, ctx->cpha, SPI_MSB_FIRST);
+        ctx->format_bits = 8;
+    }
+    if (ctx->clock != 0) {
+        spi_set_baudrate(ctx->instance, ctx->baudrate);
+        ctx->clock = 0;
+    }
+
+    if (tx_data && rx_data) {
+        spi_write_read_blocking(ctx->instance, tx_data, rx_data, size);
+    } else if (tx_data) {
+        spi_write_blocking(ctx->instance, tx_data, size);
+    } else {
+        spi_read_blocking(ctx->instance, 0xFF, rx_data, size);
+    }
+
+    return HAL_OK;
 }
 
 hal_status_t hal_spi_set_cs(uint8_t spi_id, uint32_t cs_pin, bool active) {
+    if (spi_id >= MAX_SPI_INSTANCES) {
+        return HAL_INVALID_PARAM;
+    }
+
+    // Chip select is active low
+    gpio_put(cs_pin, !active);
     return HAL_OK;
 }
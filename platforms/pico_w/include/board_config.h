@@ -174,11 +174,12 @@ extern "C"
     // PWM CONFIGURATION
     // =============================================================================
 
-#define PWM_FAN_SLICE 4            // PWM slice for fan control
+// A slice's two channels share one frequency (hal_pwm_init() refuses a second one)
+#define PWM_FAN_SLICE 4            // PWM slice for fan control (FAN_CONTROL_PIN, GPIO 9)
 #define PWM_FAN_CHANNEL PWM_CHAN_B // PWM channel for fan
 #define PWM_FAN_FREQUENCY 25000    // 25 kHz PWM frequency
 
-#define PWM_BUZZER_SLICE 5            // PWM slice for buzzer
+#define PWM_BUZZER_SLICE 4            // PWM slice for buzzer (BUZZER_PIN, GPIO 8): the fan's slice
 #define PWM_BUZZER_CHANNEL PWM_CHAN_A // PWM channel for buzzer
 #define PWM_BUZZER_FREQUENCY 2000     // 2 kHz buzzer frequency
 
@@ -196,9 +197,10 @@ extern "C"
 #define WIFI_SSID_MAX_LENGTH 32
 #define WIFI_PASSWORD_MAX_LENGTH 64
 #define WIFI_HOSTNAME "pico-diagnostic-rig"
-#define WIFI_CONNECT_TIMEOUT_MS 30000      // 30 seconds
-#define WIFI_RECONNECT_DELAY_MS 5000       // 5 seconds
-#define WIFI_MAX_RETRY_COUNT 5            // Maximum connection retries
+#define WIFI_CONNECT_TIMEOUT_MS 30000      // Per attempt, checked without blocking
+#define WIFI_RECONNECT_DELAY_MS 5000       // First backoff delay, doubled per failure
+#define WIFI_RECONNECT_MAX_DELAY_MS 60000  // Backoff ceiling
+#define WIFI_MAX_RETRY_COUNT 5            // Failures after which the backoff stops doubling
 #define WIFI_STATUS_CHECK_INTERVAL_MS 1000 // Check connection status every 1s
 
 // Default WiFi credentials (change these for your network)
@@ -252,6 +254,7 @@ extern "C"
 #define WEBSOCKET_PING_INTERVAL_MS 30000 // 30 seconds
 #define WEBSOCKET_TIMEOUT_MS 60000       // 1 minute timeout
 #define WEBSOCKET_MAX_FRAME_SIZE 4096
+#define WEBSOCKET_DEFLATE_ENABLED 1 // Accept permessage-deflate offers (1 KiB window per client)
 
 // WebSocket message types
 #define WS_MSG_TEXT 0x01
@@ -260,6 +263,51 @@ extern "C"
 #define WS_MSG_PING 0x09
 #define WS_MSG_PONG 0x0A
 
+    // =============================================================================
+    // TELEMETRY CONFIGURATION
+    // =============================================================================
+
+#define TELEMETRY_CHANNEL_INTERVAL_MS 1000     // Channel change check period
+#define TELEMETRY_KEYFRAME_INTERVAL_MS 10000   // Full-state resync period per client
+#define TELEMETRY_VOLTAGE_DEADBAND_V 0.05f     // Voltage changes larger than this are reported
+#define TELEMETRY_CURRENT_DEADBAND_A 0.005f    // Current changes larger than this are reported
+#define TELEMETRY_RSSI_DEADBAND_DBM 3          // RSSI changes larger than this are reported
+
+    // =============================================================================
+    // UDP SAMPLE STREAM CONFIGURATION
+    // =============================================================================
+
+#define UDP_STREAM_ENABLED 1
+#define UDP_STREAM_DEFAULT_PORT NET_UDP_PORT
+#define UDP_STREAM_MAX_DATAGRAM 1460   // One TCP_MSS worth, so a block never fragments
+#define UDP_STREAM_MAX_LATENCY_MS 100  // Send a partial block once its oldest frame is this old
+
+    // =============================================================================
+    // TELNET CONSOLE CONFIGURATION
+    // =============================================================================
+
+#define TELNET_ENABLED 1
+#define TELNET_MAX_SESSIONS 2                // Keep RIG_LWIP_TELNET_SESSIONS in lwipopts.h in step
+#define TELNET_LINE_MAX 160                  // Longest command line, including terminator
+#define TELNET_LOG_IN_FLIGHT 2920            // Unacknowledged log bytes per session (lwIP heap)
+#define TELNET_KEEPALIVE_IDLE_MS 60000       // Probe a silent peer after this long
+#define TELNET_KEEPALIVE_INTERVAL_MS 10000   // Between unanswered probes
+#define TELNET_KEEPALIVE_COUNT 3             // Unanswered probes before the session is dropped
+
+    // =============================================================================
+    // TIME SYNC CONFIGURATION
+    // =============================================================================
+
+#define TIME_SYNC_ENABLED 1
+#define TIME_SYNC_SERVER "pool.ntp.org"      // Or the capture PC running rig_capture --ntp-port
+#define TIME_SYNC_PORT 123
+#define TIME_SYNC_INTERVAL_S 64              // Public pools ask for no more than one request a minute
+#define TIME_SYNC_BURST_COUNT 4              // Quick exchanges after start to fill the filter
+#define TIME_SYNC_BURST_INTERVAL_MS 2000
+#define TIME_SYNC_TIMEOUT_MS 1000            // Give up on a request after this long
+#define TIME_SYNC_RESOLVE_RETRY_MS 10000     // Wait before retrying a failed name lookup
+#define TIME_SYNC_RERESOLVE_TIMEOUTS 4       // Look the name up again after this many timeouts in a row
+
     // =============================================================================
     // HTTP SERVER CONFIGURATION
     // =============================================================================
@@ -286,6 +334,56 @@ extern "C"
 #define DISPLAY_UPDATE_RATE_MS 100 // Update every 100ms
 #define DISPLAY_BUFFER_SIZE (DISPLAY_WIDTH * DISPLAY_HEIGHT * 2)
 
+// Rendering: a full framebuffer (DISPLAY_BUFFER_SIZE bytes) or a display list
+// rasterized DISPLAY_BAND_HEIGHT rows at a time (about 15 KB in all)
+#define DISPLAY_RENDER_FRAMEBUFFER 0
+#define DISPLAY_RENDER_BANDS 1
+#define DISPLAY_RENDER_MODE DISPLAY_RENDER_BANDS
+#define DISPLAY_BAND_HEIGHT 8  // Band buffer: DISPLAY_WIDTH * 8 * 2 = 5 KB
+#define DISPLAY_BAND_BUFFERS 2 // One drawn while the other is sent
+
+// Panel on SPI_DISPLAY_*: an ILI9481 (320x480) in landscape, the screen centred on it.
+// 0 leaves the output to pico_display_set_output() (web display only).
+#define DISPLAY_PANEL_ILI9481 1
+#define DISPLAY_PANEL_MADCTL 0x28 // Row/column exchange, BGR
+#define DISPLAY_PANEL_X_OFFSET 80 // (ILI9481_NATIVE_HEIGHT - DISPLAY_WIDTH) / 2, landscape
+#define DISPLAY_PANEL_Y_OFFSET 40 // (ILI9481_NATIVE_WIDTH - DISPLAY_HEIGHT) / 2
+#define DISPLAY_PANEL_RGB666 0    // 1 for modules whose serial interface only takes 18-bit pixels
+
+// While a UDP stream runs the screen shows its channels as a hardware-scrolled
+// strip chart right of DISPLAY_CHART_X, one column per 1/DISPLAY_CHART_COLUMN_RATE s
+#define DISPLAY_CHART_X 80
+#define DISPLAY_CHART_COLUMN_RATE 50
+
+// XPT2046 touch controller of the panel module, on the display bus at its own clock.
+// CS and PENIRQ take the SPI_EXT chip select and the external interrupt input (SPI_EXT is not used).
+#define TOUCH_XPT2046 1
+#define TOUCH_CS_PIN SPI_EXT_CS_PIN
+#define TOUCH_IRQ_PIN EXT_INT_PIN
+#define TOUCH_SPI_FREQUENCY 2000000 // 2 MHz (2.5 MHz at most)
+#define TOUCH_SAMPLE_INTERVAL_MS 10 // Between bursts while pressed
+#define TOUCH_PRESSURE_MIN 100      // Z1 below this: not pressed
+// Raw readings at the panel edges, for the default calibration. The controller's
+// X runs along the panel's 320-pixel side, so in landscape it gives screen y.
+#define TOUCH_SWAP_XY 1
+#define TOUCH_RAW_LEFT 3870
+#define TOUCH_RAW_RIGHT 230
+#define TOUCH_RAW_TOP 3800
+#define TOUCH_RAW_BOTTOM 280
+
+// Panel backlight (LED) dimmed by PWM; the pin is SPI_EXT's MISO (SPI_EXT is not used)
+#define DISPLAY_BACKLIGHT_PWM 1
+#define DISPLAY_BACKLIGHT_PIN SPI_EXT_MISO_PIN
+#define DISPLAY_BACKLIGHT_SLICE 6         // GPIO 12
+#define DISPLAY_BACKLIGHT_CHANNEL PWM_CHAN_A
+#define DISPLAY_BACKLIGHT_FREQUENCY 20000 // Above hearing: no whine from the LED driver
+
+// Input inactivity: the backlight dims, then the panel sleeps and nothing is rendered
+// until a touch or button press. 0 disables either step.
+#define DISPLAY_DIM_TIMEOUT_MS 60000    // 1 minute
+#define DISPLAY_DIM_BRIGHTNESS 15       // Percent
+#define DISPLAY_SLEEP_TIMEOUT_MS 300000 // 5 minutes
+
 // Web display simulation
 #define WEB_DISPLAY_ENABLED 1
 #define WEB_DISPLAY_WEBSOCKET 1
@@ -403,15 +501,7 @@ extern "C"
     // WIFI STATUS DEFINITIONS
     // =============================================================================
 
-// WiFi connection states (for internal use - don't conflict with enums)
-#define WIFI_STATE_DISCONNECTED 0
-#define WIFI_STATE_CONNECTING 1
-#define WIFI_STATE_CONNECTED 2
-#define WIFI_STATE_FAILED 3
-#define WIFI_STATE_TIMEOUT 4
-#define WIFI_STATE_AP_MODE 5
-
-    // Remove conflicting event and auth definitions - these will be in wifi_manager.h as enums
+    // Connection states and events are the wifi_state_t enum in wifi_manager.h
 
     // =============================================================================
     // HELPER MACROS
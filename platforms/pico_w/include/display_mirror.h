@@ -0,0 +1,99 @@
+/**
+ * @file display_mirror.h
+ * @brief Live copy of the display for WebSocket viewers
+ *
+ * The display HAL hands every area it flushes (and every strip chart
+ * column it scrolls in) to display_mirror_push()/display_mirror_scroll(),
+ * which RLE-encode them into binary display_stream.h messages for the
+ * clients that asked for the mirror with DISPLAY_MIRROR. Viewers so see
+ * exactly what goes to the panel, and pay only for what changed: a value
+ * redraw costs tens of bytes, an idle screen nothing.
+ *
+ * A new viewer, or one whose message could not be sent (the WebSocket
+ * drops rather than blocks), is brought up to date by a resync: the screen
+ * repainted for the mirror alone, DISPLAY_MIRROR_RESYNC_ROWS at a time so
+ * the TCP send buffer keeps up. Strip chart history is not repainted; it
+ * fills in as columns scroll in.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef DISPLAY_MIRROR_H
+#define DISPLAY_MIRROR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "framebuffer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONFIGURATION CONSTANTS
+    // =============================================================================
+
+#define DISPLAY_MIRROR_MESSAGE_SIZE 2920      // Two TCP_MSS: half the send buffer
+#define DISPLAY_MIRROR_RESYNC_ROWS 8          // Rows repainted per resync step (5 KB even unencodable)
+#define DISPLAY_MIRROR_RESYNC_INTERVAL_MS 20  // Between steps, for the send buffer to drain: 0.6 s a screen
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Mirror counters since boot
+     */
+    typedef struct
+    {
+        uint8_t viewers;        // Clients receiving the mirror
+        uint32_t messages;      // Messages sent
+        uint32_t bytes;         // ... their bytes
+        uint32_t pixels;        // ... and the pixels they carried (2 bytes each unencoded)
+        uint32_t send_failures; // Messages a viewer did not get, each answered by a resync
+        uint32_t resyncs;       // Full repaints started
+    } display_mirror_stats_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Start or stop mirroring to a WebSocket client
+     *
+     * Safe from lwIP callbacks (commands, disconnects): the change is queued
+     * and applied by the next display_mirror_update().
+     *
+     * @param client_id WebSocket client
+     * @param enabled true to start (with a resync), false to stop
+     * @return false for an unknown client
+     */
+    bool display_mirror_set_viewer(int client_id, bool enabled);
+
+    /**
+     * @brief Send what the HAL pushed, at most WEB_DISPLAY_FRAMERATE times a second, and advance a resync
+     *
+     * Call every loop.
+     */
+    void display_mirror_update(void);
+
+    /**
+     * @brief A flushed area, in screen coordinates (from the display HAL)
+     */
+    void display_mirror_push(const fb_rect_t *rect, const uint16_t *pixels, uint16_t stride);
+
+    /**
+     * @brief A scroll step of the hardware scroll area (from the display HAL)
+     */
+    void display_mirror_scroll(uint16_t x, uint16_t width, const uint16_t *column, uint16_t height);
+
+    void display_mirror_get_stats(display_mirror_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_MIRROR_H
@@ -4,6 +4,13 @@
  *
  * This file configures the lwIP TCP/IP stack for the Pico W WiFi functionality.
  * Place this file in platforms/pico_w/include/ directory.
+ *
+ * Memory profile: every lwIP allocation comes from statically sized pools
+ * (memp) or the fixed lwIP heap (MEM_SIZE) - never from the libc heap - so a
+ * long run cannot fragment memory shared with the application. Pool sizes
+ * below are derived from the rig's workload; LWIP_STATS is on so the
+ * high-water marks can be read back (GET_NETSTATS, /api/netstats) and the
+ * numbers trimmed from measurements.
  */
 
 #ifndef LWIPOPTS_H
@@ -15,21 +22,51 @@
 #define LWIP_NETCONN 0
 #define LWIP_NETIF_API 0
 
-// Memory settings
-#define MEM_LIBC_MALLOC 1
-#define MEMP_MEM_MALLOC 1
+// =============================================================================
+// WORKLOAD
+// =============================================================================
+
+// Keep in step with board_config.h
+#define RIG_LWIP_WEBSOCKET_CLIENTS 4 // WEBSOCKET_MAX_CLIENTS
+#define RIG_LWIP_HTTP_CONNECTIONS 4  // HTTP_MAX_CONCURRENT_CONNECTIONS
+#define RIG_LWIP_TELNET_SESSIONS 2   // TELNET_MAX_SESSIONS
+#define RIG_LWIP_LISTENERS 3         // HTTP, WebSocket, telnet
+
+// =============================================================================
+// MEMORY - static pools only
+// =============================================================================
+
+#define MEM_LIBC_MALLOC 0
+#define MEMP_MEM_MALLOC 0
 #define MEM_ALIGNMENT 4
-#define MEM_SIZE 4000
-#define MEMP_NUM_TCP_SEG 32
-#define MEMP_NUM_ARP_QUEUE 10
+
+// lwIP heap: holds PBUF_RAM data, i.e. every tcp_write(..., TCP_WRITE_FLAG_COPY)
+// (WebSocket frames, HTTP headers) until it is acknowledged. Sized for every
+// dashboard having a few telemetry frames in flight at once.
+#define MEM_SIZE (16 * 1024)
+
+// Connection pools (+2 PCBs for connections lingering in TIME_WAIT)
+#define MEMP_NUM_TCP_PCB (RIG_LWIP_WEBSOCKET_CLIENTS + RIG_LWIP_HTTP_CONNECTIONS + RIG_LWIP_TELNET_SESSIONS + 2)
+#define MEMP_NUM_TCP_PCB_LISTEN RIG_LWIP_LISTENERS
+#define MEMP_NUM_UDP_PCB 5 // DHCP, DNS, sample stream, time sync, 1 spare
+
+// Queued TCP segments across all connections
+#define MEMP_NUM_TCP_SEG 48
+
+// PBUF_ROM/REF headers: zero-copy HTTP bodies sent straight from flash
+#define MEMP_NUM_PBUF 24
+
+// RX packet pool used by the CYW43 driver for incoming frames
 #define PBUF_POOL_SIZE 24
+#define MEMP_NUM_ARP_QUEUE 10
+
 #define LWIP_ARP 1
 #define LWIP_ETHERNET 1
 #define LWIP_ICMP 1
 #define LWIP_RAW 1
-#define TCP_WND (8 * TCP_MSS)
 #define TCP_MSS 1460
-#define TCP_SND_BUF (8 * TCP_MSS)
+#define TCP_WND (4 * TCP_MSS)
+#define TCP_SND_BUF (4 * TCP_MSS)
 #define TCP_SND_QUEUELEN ((4 * (TCP_SND_BUF) + (TCP_MSS - 1)) / (TCP_MSS))
 #define LWIP_TCP 1
 #define LWIP_UDP 1
@@ -44,12 +81,8 @@
 #define LWIP_IPV4 1
 #define LWIP_IPV6 0
 
-// HTTP server settings for WebSocket support
-#define LWIP_HTTPD 1
-#define LWIP_HTTPD_CGI 1
-#define LWIP_HTTPD_SSI 1
-#define LWIP_HTTPD_SSI_INCLUDE_TAG 0
-#define LWIP_HTTPD_SUPPORT_WEBSOCKET 1
+// The rig serves HTTP and WebSocket itself (web_server.cpp, websocket_server.cpp)
+#define LWIP_HTTPD 0
 
 // TCP settings for reliable connections
 #define LWIP_TCP_TIMESTAMPS 0
@@ -60,9 +93,23 @@
 #define LWIP_UDP 1
 #define LWIP_UDPLITE 0
 
-// Statistics and debugging
-#define LWIP_STATS 0
+// =============================================================================
+// STATISTICS
+// =============================================================================
+
+#define LWIP_STATS 1
 #define LWIP_STATS_DISPLAY 0
+#define LWIP_STATS_LARGE 1 // 32-bit counters; overnight runs overflow 16 bits
+#define MEM_STATS 1
+#define MEMP_STATS 1
+#define TCP_STATS 1
+#define UDP_STATS 1
+#define LINK_STATS 1
+#define IP_STATS 0
+#define ICMP_STATS 0
+#define SYS_STATS 0
+#define ETHARP_STATS 0
+#define IGMP_STATS 0
 
 // Threading (we're using NO_SYS=1, so these are disabled)
 #define LWIP_TCPIP_CORE_LOCKING 0
@@ -104,11 +151,6 @@
 #define MEMP_OVERFLOW_CHECK 0
 #define MEMP_SANITY_CHECK 0
 
-// Custom settings for our WebSocket server
-#define LWIP_HTTPD_MAX_TAG_NAME_LEN 16
-#define LWIP_HTTPD_MAX_TAG_INSERT_LEN 192
-#define LWIP_HTTPD_POST_MAX_PAYLOAD_LEN 512
-
 // Network interface settings
 #define LWIP_SINGLE_NETIF 1
 #define LWIP_BROADCAST_PING 1
@@ -154,7 +196,6 @@
 #define ICMP_DEBUG LWIP_DBG_OFF
 #define DHCP_DEBUG LWIP_DBG_OFF
 #define DNS_DEBUG LWIP_DBG_OFF
-#define HTTPD_DEBUG LWIP_DBG_ON
 #endif
 
-#endif /* LWIPOPTS_H */
\ No newline at end of file
+#endif /* LWIPOPTS_H */
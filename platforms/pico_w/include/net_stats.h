@@ -0,0 +1,104 @@
+/**
+ * @file net_stats.h
+ * @brief lwIP memory pool and protocol counters for the Pico W
+ *
+ * Snapshots the lwIP statistics (heap, every memp pool, TCP and link
+ * counters) so pool sizes in lwipopts.h can be tuned from high-water marks
+ * measured on a running rig rather than guessed. No lwIP types leak out of
+ * this header.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef NET_STATS_H
+#define NET_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "json_writer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONFIGURATION
+    // =============================================================================
+
+#define NET_STATS_MAX_POOLS 16
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Usage of one lwIP pool or the lwIP heap
+     */
+    typedef struct
+    {
+        const char *name;
+        uint32_t avail; // Capacity (elements, or bytes for the heap)
+        uint32_t used;  // Currently allocated
+        uint32_t max;   // High-water mark since boot
+        uint32_t err;   // Allocations refused because the pool was empty
+    } net_pool_stats_t;
+
+    /**
+     * @brief Snapshot of the lwIP counters
+     */
+    typedef struct
+    {
+        net_pool_stats_t heap;
+        net_pool_stats_t pools[NET_STATS_MAX_POOLS];
+        uint8_t pool_count;
+
+        uint32_t tcp_xmit;
+        uint32_t tcp_recv;
+        uint32_t tcp_drop;
+        uint32_t tcp_memerr; // Segments dropped for lack of memory
+        uint32_t tcp_err;
+
+        uint32_t link_drop;
+        uint32_t link_memerr; // Frames the driver could not get a pbuf for
+
+        uint32_t alloc_failures; // Heap plus all pool errors
+    } net_stats_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Take a snapshot of the lwIP counters
+     * @param stats Pointer to store the snapshot
+     */
+    void net_stats_get(net_stats_t *stats);
+
+    /**
+     * @brief Write the counters as a JSON object of type "netstats"
+     * @param w Writer positioned where a value may go
+     */
+    void net_stats_write_json(json_writer_t *w);
+
+    /**
+     * @brief Render the counters as a JSON object of type "netstats"
+     * @param buf Output buffer
+     * @param size Output buffer size
+     * @return Length written (excluding NUL), or 0 if it did not fit
+     */
+    size_t net_stats_format_json(char *buf, size_t size);
+
+    /**
+     * @brief Print the counters to the console
+     */
+    void net_stats_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NET_STATS_H
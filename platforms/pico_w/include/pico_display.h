@@ -0,0 +1,181 @@
+/**
+ * @file pico_display.h
+ * @brief Pico W display helpers beyond the generic display HAL
+ *
+ * hal_display_* draw into a DISPLAY_WIDTH x DISPLAY_HEIGHT RGB565 screen,
+ * kept as a framebuffer or as a display list rendered in bands
+ * (DISPLAY_RENDER_MODE); hal_display_flush() passes only the areas that
+ * changed to the output set here (the panel driver), so an unchanged screen
+ * costs no bus traffic at all.
+ *
+ * A range of columns can instead scroll in hardware (a strip chart): the
+ * panel rotates them and each step sends only the one new column.
+ *
+ * The backlight is dimmed by PWM, and the panel can be put to sleep: then
+ * nothing is flushed at all, leaving the CPU and the bus to acquisition.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef PICO_DISPLAY_H
+#define PICO_DISPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "framebuffer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Flush counters since hal_display_init()
+     */
+    typedef struct
+    {
+        uint32_t flushes;        // hal_display_flush() calls
+        uint32_t empty_flushes;  // ... with nothing to send
+        uint32_t rects_pushed;   // Areas handed to the output
+        uint64_t pixels_pushed;  // Pixels in those areas
+        uint32_t last_flush_us;  // Time the last non-empty flush took
+        uint32_t draws_dropped;  // Band mode: draws the display list had no room for
+        uint32_t text_unchanged; // Text draws skipped: the string was on screen already
+        uint32_t text_partial;   // Text draws cut down to the characters that changed
+        uint32_t columns_scrolled; // pico_display_scroll_column() steps sent
+        uint32_t sleeps;         // Times the panel went to sleep
+    } pico_display_stats_t;
+
+    /**
+     * @brief Panel power state
+     */
+    typedef enum
+    {
+        PICO_DISPLAY_ON,     // Backlight at hal_display_set_brightness()
+        PICO_DISPLAY_DIMMED, // Backlight at DISPLAY_DIM_BRIGHTNESS at most; drawing as usual
+        PICO_DISPLAY_ASLEEP  // Backlight off, panel in sleep mode, nothing flushed
+    } pico_display_power_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Called before the HAL reuses pixels it has pushed
+     *
+     * An output that sends asynchronously (e.g. by SPI DMA) returns from push
+     * at once and finishes the transfer here, so the next band is drawn while
+     * the previous one is on the bus.
+     */
+    typedef void (*pico_display_wait_t)(void *context);
+
+    /**
+     * @brief Set where flushed areas go
+     * @param push Called once per changed area, NULL to only count them
+     * @param wait Waits for the last push to be sent, NULL if push sends before returning
+     * @param context Passed to push and wait
+     */
+    void pico_display_set_output(framebuffer_push_t push, pico_display_wait_t wait, void *context);
+
+    /**
+     * @brief Mark the whole screen changed, e.g. after the panel was reset
+     */
+    void pico_display_invalidate(void);
+
+    /**
+     * @brief Hand a range of columns to the panel's hardware scrolling
+     *
+     * Pending drawing is flushed first; the area then shows it until
+     * scrolled columns push it out, so clear the area before starting. Later
+     * flushes leave the area to pico_display_scroll_column(). Ending (width 0)
+     * or moving the area repaints the old one from what was drawn there.
+     *
+     * @param x First screen column
+     * @param width Columns in the area, 0 to end scrolling
+     * @return false without an ILI9481, or for a range off the screen
+     */
+    bool pico_display_scroll_area(uint16_t x, uint16_t width);
+
+    /**
+     * @brief Move the scroll area one column left and show a new column at its right edge
+     * @param pixels DISPLAY_HEIGHT RGB565 pixels, top first; unchanged until the next call
+     */
+    void pico_display_scroll_column(const uint16_t *pixels);
+
+    /**
+     * @brief Send rows of the screen to the web display mirror, but not the panel
+     *
+     * Pending drawing is flushed (to both) first. The scroll area is left
+     * out, as in every flush.
+     *
+     * @param y First row
+     * @param height Rows
+     */
+    void pico_display_repaint_mirror(uint16_t y, uint16_t height);
+
+    /**
+     * @brief Dim the backlight, or put the panel to sleep and wake it
+     *
+     * Asleep, hal_display_flush() and pico_display_scroll_column() return at
+     * once and what was drawn stays pending; callers should stop drawing
+     * altogether. The panel keeps its memory, so waking shows the screen as
+     * it was and the next flush sends what changed meanwhile. Waking blocks
+     * for the panel's settling time (20 ms or more).
+     *
+     * @param power New state
+     */
+    void pico_display_set_power(pico_display_power_t power);
+
+    pico_display_power_t pico_display_get_power(void);
+
+    /**
+     * @brief The framebuffer behind the HAL (NULL before hal_display_init() or in band mode)
+     */
+    framebuffer_t *pico_display_get_framebuffer(void);
+
+    /**
+     * @brief Get flush counters
+     * @param stats Receives the counters
+     */
+    void pico_display_get_stats(pico_display_stats_t *stats);
+
+    void pico_display_get_dimensions(uint16_t *width, uint16_t *height);
+    uint8_t pico_display_get_brightness(void);
+    bool pico_display_is_ready(void);
+
+    /**
+     * @brief Draw a bordered progress bar
+     * @param x Left edge
+     * @param y Top edge
+     * @param width Bar width
+     * @param height Bar height
+     * @param progress Percentage (0-100)
+     * @param fg_color Filled part (RGB888)
+     * @param bg_color Empty part (RGB888)
+     */
+    void pico_display_draw_progress_bar(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t progress,
+                                        uint32_t fg_color, uint32_t bg_color);
+
+    /**
+     * @brief Draw the status screen and flush it
+     *
+     * The background is painted on the first call (and after
+     * hal_display_clear()); later calls repaint only the text that changed.
+     *
+     * @param uptime_ms System uptime in milliseconds
+     * @param loop_count Main loop iteration count
+     */
+    void pico_display_show_status(uint32_t uptime_ms, uint32_t loop_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PICO_DISPLAY_H
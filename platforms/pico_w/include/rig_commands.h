@@ -0,0 +1,72 @@
+/**
+ * @file rig_commands.h
+ * @brief The rig's command table and its UART and WebSocket front ends
+ *
+ * Every remote operation (channel control, WiFi, streaming, statistics)
+ * is one entry in a single sorted table served through command_registry.h,
+ * so the USB/UART console and the dashboard accept exactly the same
+ * commands and arguments. Type HELP on the console for the list.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef RIG_COMMANDS_H
+#define RIG_COMMANDS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Application actions the commands trigger but do not own
+     */
+    typedef struct
+    {
+        void (*publish_status)(void);   // Push system status to WebSocket clients
+        void (*publish_channels)(void); // Push channel readings to WebSocket clients
+        void (*emergency_stop)(void);   // Full emergency stop sequence
+    } rig_command_hooks_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Install the command table
+     * @param hooks Application actions (copied; members may be NULL)
+     */
+    void rig_commands_init(const rig_command_hooks_t *hooks);
+
+    /**
+     * @brief Run a WebSocket command or batch and answer the sender
+     *
+     * Matches websocket_message_callback_t.
+     * @param client_id Sending client
+     * @param text Complete message
+     * @param len Message length
+     * @return true if the message was a command envelope
+     */
+    bool rig_commands_websocket_message(int client_id, const char *text, size_t len);
+
+    /**
+     * @brief Read console input without blocking and run complete lines
+     *
+     * Call every loop; characters are collected until CR or LF.
+     */
+    void rig_commands_poll_uart(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RIG_COMMANDS_H
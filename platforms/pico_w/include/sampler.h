@@ -0,0 +1,102 @@
+/**
+ * @file sampler.h
+ * @brief Timer-driven ADC acquisition for the diagnostic channels
+ *
+ * A repeating hardware timer samples every analog channel at a fixed rate
+ * and pushes one frame per tick into a lock-free single-producer ring. The
+ * main loop drains the ring at its own pace (for example into UDP sample
+ * blocks), so acquisition timing does not depend on loop latency.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONFIGURATION
+    // =============================================================================
+
+#define SAMPLER_CHANNELS 3          // CH1 voltage, CH2 voltage, CH3 current
+#define SAMPLER_RING_FRAMES 256     // Must be a power of two
+#define SAMPLER_MAX_RATE_HZ 5000    // Three conversions per tick stay under 5% CPU
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Sampler counters
+     */
+    typedef struct
+    {
+        bool running;
+        uint32_t rate_hz;
+        uint32_t frames_captured; // Frames taken since sampler_start()
+        uint32_t frames_dropped;  // Frames lost because the ring was full
+        uint32_t ring_peak;       // Highest ring fill level seen
+    } sampler_stats_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Start sampling all channels
+     * @param rate_hz Frames per second (1..SAMPLER_MAX_RATE_HZ)
+     * @return true if the timer is running
+     */
+    bool sampler_start(uint32_t rate_hz);
+
+    /**
+     * @brief Stop sampling and discard buffered frames
+     */
+    void sampler_stop(void);
+
+    /**
+     * @brief Check if the sampler is running
+     * @return true while the timer is armed
+     */
+    bool sampler_is_running(void);
+
+    /**
+     * @brief Take buffered frames out of the ring
+     *
+     * Only returns consecutive frames: if frames were dropped, the read stops
+     * at the gap and the next call starts after it.
+     *
+     * @param samples Receives frames as SAMPLER_CHANNELS counts each
+     * @param max_frames Capacity of samples in frames
+     * @param first_index Receives the index (frames since start) of the first frame
+     * @return Number of frames copied
+     */
+    size_t sampler_read(uint16_t *samples, size_t max_frames, uint32_t *first_index);
+
+    /**
+     * @brief Time at which a frame was sampled
+     * @param index Frame index from sampler_read()
+     * @return Microseconds on the hal_get_time_us() clock
+     */
+    uint64_t sampler_frame_time_us(uint32_t index);
+
+    /**
+     * @brief Get sampler counters
+     * @param stats Pointer to store the counters
+     */
+    void sampler_get_stats(sampler_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SAMPLER_H
@@ -0,0 +1,128 @@
+/**
+ * @file telemetry.h
+ * @brief Change-only telemetry publisher for WebSocket clients
+ *
+ * Keeps the last value sent to each WebSocket client for every telemetry
+ * field and only emits fields that moved beyond their deadband. A periodic
+ * keyframe resends the full state so clients that missed a frame resync.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Deadbands and keyframe period used for change detection
+     */
+    typedef struct
+    {
+        float voltage_deadband;        // Volts
+        float current_deadband;        // Amps
+        int32_t rssi_deadband;         // dBm
+        uint32_t keyframe_interval_ms; // 0 disables periodic keyframes
+    } telemetry_config_t;
+
+    /**
+     * @brief One channel reading as seen by the publisher
+     */
+    typedef struct
+    {
+        bool enabled;
+        float voltage;
+        float current;
+    } telemetry_channel_t;
+
+    /**
+     * @brief System status fields as seen by the publisher
+     */
+    typedef struct
+    {
+        bool wifi_connected;
+        int32_t rssi;
+        uint32_t uptime_s;   // Keyframe-only field
+        uint32_t loop_count; // Keyframe-only field
+    } telemetry_status_t;
+
+    /**
+     * @brief Publisher counters
+     */
+    typedef struct
+    {
+        uint32_t messages_sent;
+        uint32_t fields_sent;
+        uint32_t fields_suppressed;
+        uint32_t keyframes_sent;
+    } telemetry_stats_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Initialize the telemetry publisher
+     * @param config Deadband configuration, or NULL for board defaults
+     */
+    void telemetry_init(const telemetry_config_t *config);
+
+    /**
+     * @brief Replace the deadband configuration
+     * @param config New configuration
+     */
+    void telemetry_set_config(const telemetry_config_t *config);
+
+    /**
+     * @brief Get the current deadband configuration
+     * @param config Pointer to store the configuration
+     */
+    void telemetry_get_config(telemetry_config_t *config);
+
+    /**
+     * @brief Forget what was sent to a client so its next update is a keyframe
+     * @param client_id The client ID (from the WebSocket server)
+     */
+    void telemetry_reset_client(int client_id);
+
+    /**
+     * @brief Force a keyframe for every client on the next publish
+     */
+    void telemetry_request_keyframe(void);
+
+    /**
+     * @brief Publish channel readings, sending only changed fields per client
+     * @param channels Array of NUM_DIAGNOSTIC_CHANNELS readings (channel 1 first)
+     * @param now_ms Current time in milliseconds
+     */
+    void telemetry_publish_channels(const telemetry_channel_t *channels, uint32_t now_ms);
+
+    /**
+     * @brief Publish system status, sending only changed fields per client
+     * @param status Current status
+     * @param now_ms Current time in milliseconds
+     */
+    void telemetry_publish_status(const telemetry_status_t *status, uint32_t now_ms);
+
+    /**
+     * @brief Get publisher counters
+     * @param stats Pointer to store the counters
+     */
+    void telemetry_get_stats(telemetry_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TELEMETRY_H
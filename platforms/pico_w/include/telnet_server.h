@@ -0,0 +1,85 @@
+/**
+ * @file telnet_server.h
+ * @brief Raw TCP console on NET_TELNET_PORT
+ *
+ * Each session is a remote copy of the USB/UART console: lines typed into
+ * it run through the same command table (command_execute_line()), and it
+ * receives the same log stream. Logs come from the deferred log ring
+ * (log_ring.h), which a stdio driver fills with everything the firmware
+ * prints, so nothing is formatted twice and each session only holds a read
+ * cursor. Sessions are served from the main loop within whatever send
+ * buffer they have free; a slow terminal falls behind and skips the log it
+ * missed instead of holding up output.
+ *
+ * Every log line enters the ring stamped with time_sync_now_us(): Unix
+ * seconds once the clock is synced ("[1760000000.123456] "), seconds since
+ * boot before that ("[+12.345678] "), so telnet logs from several rigs line
+ * up with their WebSocket logs and sample blocks.
+ *
+ * Works with telnet (line mode; option negotiation is ignored) and plain
+ * TCP clients such as netcat. QUIT closes the session.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef TELNET_SERVER_H
+#define TELNET_SERVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Console server counters
+     */
+    typedef struct
+    {
+        uint8_t sessions_total;
+        uint8_t sessions_in_use;
+        uint32_t connections_accepted;
+        uint32_t connections_rejected; // All sessions were in use
+        uint32_t commands_executed;
+        uint32_t log_bytes_sent;
+        uint32_t log_bytes_dropped; // Overwritten in the ring before a slow session read them
+    } telnet_server_stats_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Start capturing stdio into the log ring and listen on NET_TELNET_PORT
+     * @return true if the server is listening
+     */
+    bool telnet_server_init(void);
+
+    /**
+     * @brief Run received command lines and send pending log output (call every loop)
+     */
+    void telnet_server_update(void);
+
+    /**
+     * @brief Close every session and stop listening; stdio capture stays on
+     */
+    void telnet_server_stop(void);
+
+    /**
+     * @brief Get console server counters
+     * @param stats Pointer to store the counters
+     */
+    void telnet_server_get_stats(telnet_server_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TELNET_SERVER_H
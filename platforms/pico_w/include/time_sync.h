@@ -0,0 +1,118 @@
+/**
+ * @file time_sync.h
+ * @brief Firmware timestamps on the host's clock, kept in step over SNTP
+ *
+ * The local clock is hal_get_time_us(): 64-bit microseconds since boot,
+ * monotonic and free of wrap. This module polls an NTP server (a public
+ * one, or the capture PC itself, see tools/udp_capture) and maintains a
+ * clock_sync.h mapping from that clock to Unix time in microseconds.
+ * Sample blocks and log records carry mapped time once it is available,
+ * so captures from several rigs, or from a rig and a PC, line up on the
+ * host without further correction.
+ *
+ * Until the first exchange completes, conversions return the local clock
+ * unchanged and say so, so every timestamp states which clock it is on.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#define TIME_SYNC_SERVER_MAX 64 // Longest server name, including terminator
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Synchronisation state and counters
+     */
+    typedef struct
+    {
+        bool running;
+        bool synced;
+        char server[TIME_SYNC_SERVER_MAX];
+        uint16_t port;
+        uint32_t interval_s;
+        uint32_t requests_sent;
+        uint32_t replies;   // Valid replies fed to the estimator
+        uint32_t invalid;   // Stale, unsynchronised or kiss-of-death replies
+        uint32_t timeouts;  // Requests that were never answered
+        uint32_t dns_failures;
+        uint32_t steps;     // Times the mapping jumped instead of slewing
+        int32_t last_error_us; // Correction applied by the last update
+        uint32_t delay_us;     // Round trip of the exchange it used
+        int32_t drift_ppb;     // Local oscillator frequency error
+    } time_sync_stats_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Start (or retarget) synchronisation
+     * @param server NTP server name or dotted IPv4 address
+     * @param port Server UDP port (CLOCK_SYNC_NTP_PORT unless the server listens elsewhere)
+     * @param interval_s Seconds between exchanges once the initial burst is done
+     * @return true if polling started; the name may still be resolving
+     */
+    bool time_sync_start(const char *server, uint16_t port, uint32_t interval_s);
+
+    /**
+     * @brief Stop polling; the current mapping stays in use
+     */
+    void time_sync_stop(void);
+
+    /**
+     * @brief Send due requests and apply replies (call every loop)
+     */
+    void time_sync_update(void);
+
+    /**
+     * @brief Check whether timestamps are on the host clock
+     * @return true after the first successful exchange
+     */
+    bool time_sync_is_synced(void);
+
+    /**
+     * @brief Convert a hal_get_time_us() reading to host time
+     *
+     * Safe from any context; the mapping is published as a whole.
+     * @param local_us Local timestamp
+     * @param synced Receives whether the result is host time (may be NULL)
+     * @return Unix microseconds when synced, otherwise local_us
+     */
+    uint64_t time_sync_to_host_us(uint64_t local_us, bool *synced);
+
+    /**
+     * @brief Current time on the host clock when synced, else microseconds since boot
+     * @param synced Receives whether the result is host time (may be NULL)
+     * @return Timestamp in microseconds
+     */
+    uint64_t time_sync_now_us(bool *synced);
+
+    /**
+     * @brief Get synchronisation state and counters
+     * @param stats Pointer to store them
+     */
+    void time_sync_get_stats(time_sync_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TIME_SYNC_H
@@ -0,0 +1,109 @@
+/**
+ * @file udp_stream.h
+ * @brief Full-rate channel sample streaming over UDP
+ *
+ * Drains the sampler into sequence-numbered, timestamped sample-block
+ * datagrams (see sample_stream.h) and sends them to a unicast, broadcast or
+ * multicast address. Unlike the WebSocket, a lost datagram costs only its
+ * own samples and never stalls the ones behind it; the receiver sees the
+ * gap from the sequence and sample counters.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef UDP_STREAM_H
+#define UDP_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Streaming counters
+     */
+    typedef struct
+    {
+        bool active;
+        char destination[16];
+        uint16_t port;
+        uint32_t rate_hz;
+        uint32_t datagrams_sent;
+        uint32_t frames_sent;
+        uint32_t send_errors;     // udp_sendto() failures, e.g. while WiFi is down
+        uint32_t alloc_failures;  // No pbuf for a block; its frames were dropped
+        uint32_t sampler_dropped; // Frames the sampler lost before they were read
+    } udp_stream_stats_t;
+
+    /**
+     * @brief Sees every block of frames read from the sampler, e.g. a strip chart
+     * @param frames frame_count frames of SAMPLER_CHANNELS interleaved samples
+     * @param frame_count Frames in the block
+     * @param context Passed through from udp_stream_set_frame_listener()
+     */
+    typedef void (*udp_stream_frame_listener_t)(const uint16_t *frames, size_t frame_count, void *context);
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Start sampling and streaming
+     * @param destination Dotted IPv4 address; x.x.x.255 or 255.255.255.255
+     *        broadcast and 224.0.0.0/4 multicast are allowed
+     * @param port Destination UDP port
+     * @param rate_hz Sample rate for every channel
+     * @return true if the stream is running
+     */
+    bool udp_stream_start(const char *destination, uint16_t port, uint32_t rate_hz);
+
+    /**
+     * @brief Flush the open block, stop streaming and stop the sampler
+     */
+    void udp_stream_stop(void);
+
+    /**
+     * @brief Check if a stream is running
+     * @return true while streaming
+     */
+    bool udp_stream_is_active(void);
+
+    /**
+     * @brief Move sampled frames into datagrams (call every loop)
+     *
+     * Full blocks are sent immediately; a partial block is sent once its
+     * oldest frame is UDP_STREAM_MAX_LATENCY_MS old.
+     */
+    void udp_stream_update(void);
+
+    /**
+     * @brief Also hand the frames udp_stream_update() reads to a listener
+     *
+     * Called from udp_stream_update() before the frames are serialized,
+     * including frames then lost for lack of a pbuf.
+     *
+     * @param listener Listener, NULL for none
+     * @param context Passed to the listener
+     */
+    void udp_stream_set_frame_listener(udp_stream_frame_listener_t listener, void *context);
+
+    /**
+     * @brief Get streaming counters
+     * @param stats Pointer to store the counters
+     */
+    void udp_stream_get_stats(udp_stream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UDP_STREAM_H
@@ -0,0 +1,42 @@
+/**
+ * @file web_assets.h
+ * @brief Flash-resident web UI asset table
+ *
+ * The table itself is generated at build time by scripts/web/pack_web_assets.py
+ * from the web/ tree. Entries are sorted by path; identical files share one
+ * stored blob, and the blob hash is used as the HTTP ETag.
+ */
+
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief One servable asset
+     */
+    typedef struct
+    {
+        const char *path;         // URL path, e.g. "/static/index.html"
+        const char *content_type; // MIME type for Content-Type
+        const uint8_t *data;      // Stored bytes (gzip when gzip is true)
+        uint32_t length;          // Stored length in bytes
+        const char *etag;         // Quoted strong ETag
+        bool gzip;                // Stored gzip-compressed
+    } web_asset_t;
+
+    extern const web_asset_t web_assets[];
+    extern const size_t web_assets_count;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEB_ASSETS_H
@@ -0,0 +1,82 @@
+/**
+ * @file web_server.h
+ * @brief HTTP/1.1 static file server for the web UI on Raspberry Pi Pico W
+ *
+ * Serves the flash-resident asset table (see web_assets.h) on NET_HTTP_PORT
+ * with gzip content encoding, ETag revalidation and persistent connections.
+ * Small JSON endpoints (for example /api/netstats) can be registered
+ * alongside the static assets.
+ */
+
+#ifndef WEB_SERVER_H
+#define WEB_SERVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief HTTP server counters
+     */
+    typedef struct
+    {
+        uint32_t connections_accepted;
+        uint32_t connections_rejected;
+        uint32_t requests;
+        uint32_t responses_200;
+        uint32_t responses_304;
+        uint32_t responses_4xx;
+        uint32_t body_bytes_sent;
+    } web_server_stats_t;
+
+    /**
+     * @brief Handler that renders a JSON API response
+     * @param body Buffer to write the response body into
+     * @param size Buffer size in bytes
+     * @return Body length written, or 0 if the body did not fit
+     */
+    typedef size_t (*web_api_handler_t)(char *body, size_t size);
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Start the HTTP server on NET_HTTP_PORT
+     * @return true if the server is listening, false otherwise
+     */
+    bool web_server_init(void);
+
+    /**
+     * @brief Stop the HTTP server and close all connections
+     */
+    void web_server_stop(void);
+
+    /**
+     * @brief Get HTTP server counters
+     * @param stats Pointer to store the counters
+     */
+    void web_server_get_stats(web_server_stats_t *stats);
+
+    /**
+     * @brief Serve a JSON endpoint at a fixed path
+     * @param path Absolute request path, e.g. "/api/netstats" (must outlive the server)
+     * @param handler Called for every GET/HEAD of the path
+     * @return true if registered, false if the route table is full
+     */
+    bool web_server_register_api(const char *path, web_api_handler_t handler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEB_SERVER_H
@@ -1,6 +1,10 @@
 /**
  * @file websocket_server.h
  * @brief Simplified WebSocket server header for Raspberry Pi Pico W
+ *
+ * The send functions take the lwIP lock themselves, so they may be called
+ * from the main loop (command handlers, telemetry) as well as from lwIP
+ * callbacks.
  */
 
 #ifndef WEBSOCKET_SERVER_H
@@ -10,11 +14,25 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "json_writer.h"
+
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#define WEBSOCKET_FRAME_HEADROOM 4 // Largest header of a server frame (payload < 64 KiB)
+
+// Sec-WebSocket-Protocol values. A client offering rig.cbor gets its
+// structured messages as CBOR binary frames and may send commands as CBOR;
+// everyone else gets JSON text.
+#define WEBSOCKET_SUBPROTOCOL_JSON "rig.json"
+#define WEBSOCKET_SUBPROTOCOL_CBOR "rig.cbor"
+
     // =============================================================================
     // TYPE DEFINITIONS
     // =============================================================================
@@ -28,6 +46,15 @@ extern "C"
      */
     typedef bool (*websocket_command_callback_t)(const char *command, const char *params, int client_id);
 
+    /**
+     * @brief WebSocket text message callback function type
+     * @param client_id The client ID that sent the message
+     * @param text The complete, NUL terminated message
+     * @param len Message length in bytes
+     * @return true if the message was consumed
+     */
+    typedef bool (*websocket_message_callback_t)(int client_id, const char *text, size_t len);
+
     /**
      * @brief WebSocket client connection callback function type
      * @param client_id The client ID
@@ -36,6 +63,31 @@ extern "C"
      */
     typedef void (*websocket_client_callback_t)(int client_id, bool connected, const char *client_ip);
 
+    /**
+     * @brief WebSocket slot utilization and lifecycle counters
+     */
+    typedef struct
+    {
+        uint8_t slots_total;           // Client slots available
+        uint8_t slots_in_use;          // Slots holding a TCP connection
+        uint8_t slots_ready;           // Slots that completed the upgrade
+        uint8_t slots_cbor;            // Ready slots that negotiated CBOR
+        uint8_t slots_deflate;         // Ready slots that negotiated permessage-deflate
+        uint8_t peak_in_use;           // Highest slots_in_use seen
+        uint32_t connections_accepted;
+        uint32_t connections_rejected; // No slot free and none reclaimable
+        uint32_t slots_reclaimed;      // Stale clients displaced by a new connection
+        uint32_t idle_evictions;       // Upgraded clients that stopped answering pings
+        uint32_t handshake_timeouts;   // Connections that never upgraded
+        uint32_t pings_sent;
+        uint32_t pongs_received;
+        uint32_t last_rtt_ms;          // Round trip of the most recent ping
+        uint32_t protocol_errors;      // Frames rejected with a close frame
+        uint32_t frames_dropped;       // Structured frames skipped for lack of send buffer
+        uint32_t deflate_bytes_in;     // Payload bytes of messages sent compressed...
+        uint32_t deflate_bytes_out;    // ...and what they compressed to
+    } websocket_server_stats_t;
+
     // =============================================================================
     // PUBLIC FUNCTION DECLARATIONS
     // =============================================================================
@@ -62,6 +114,14 @@ extern "C"
      */
     void websocket_register_command_callback(websocket_command_callback_t callback);
 
+    /**
+     * @brief Register a callback that sees every text message first
+     *
+     * Messages it does not consume fall through to the command callback.
+     * @param callback The callback function to register
+     */
+    void websocket_register_message_callback(websocket_message_callback_t callback);
+
     /**
      * @brief Register a callback for client connection events
      * @param callback The callback function to register
@@ -84,6 +144,60 @@ extern "C"
      */
     void websocket_send_channel_data(int channel, float voltage, float current);
 
+    /**
+     * @brief Send a text message as a single WebSocket frame
+     * @param client_id The client ID to send to, or -1 to broadcast to all clients
+     * @param text The NUL-terminated message payload
+     * @return true if the frame was queued for at least one client, false otherwise
+     */
+    bool websocket_send_text(int client_id, const char *text);
+
+    /**
+     * @brief Send a binary message as a single WebSocket frame, uncompressed
+     * @param client_id The client ID to send to, or -1 to broadcast to all clients
+     * @param data Payload (copied)
+     * @param len Payload length, below 64 KiB
+     * @return true if the frame was queued (for every ready client, when broadcasting)
+     */
+    bool websocket_send_binary(int client_id, const uint8_t *data, size_t len);
+
+    /**
+     * @brief Send a structured message whose payload was composed in place
+     *
+     * The caller reserves WEBSOCKET_FRAME_HEADROOM bytes at the start of
+     * frame and writes the payload after them with a json_writer_t in the
+     * client's format (see websocket_client_format()); the header is filled
+     * into the headroom so the frame leaves in a single write without
+     * copying the payload first. JSON goes out as a text frame, CBOR as a
+     * binary frame.
+     * @param client_id The client ID to send to, or -1 to broadcast to all clients using format
+     * @param frame Headroom followed by the payload; the headroom is overwritten
+     * @param len Payload length
+     * @param format Encoding of the payload
+     * @return true if the frame was queued for at least one client, false otherwise
+     */
+    bool websocket_send_prepared(int client_id, uint8_t *frame, size_t len, json_format_t format);
+
+    /**
+     * @brief Get the message encoding a client negotiated
+     * @param client_id The client ID
+     * @return JSON_FORMAT_CBOR for rig.cbor clients, JSON_FORMAT_TEXT otherwise
+     */
+    json_format_t websocket_client_format(int client_id);
+
+    /**
+     * @brief Check whether a client has completed the WebSocket handshake
+     * @param client_id The client ID
+     * @return true if the client can receive frames, false otherwise
+     */
+    bool websocket_client_is_ready(int client_id);
+
+    /**
+     * @brief Get slot utilization and lifecycle counters
+     * @param stats Pointer to store the counters
+     */
+    void websocket_server_get_stats(websocket_server_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,6 +1,11 @@
 /**
  * @file wifi_manager.h
- * @brief Simplified WiFi manager header for Raspberry Pi Pico W
+ * @brief Non-blocking WiFi manager header for Raspberry Pi Pico W
+ *
+ * Connecting is a polled state machine: wifi_connect() only starts an
+ * attempt and wifi_manager_update() advances it, so no caller ever waits on
+ * the radio. Lost links and failed attempts are retried automatically with
+ * exponential backoff.
  */
 
 #ifndef WIFI_MANAGER_H
@@ -21,6 +26,30 @@ extern "C"
 #define WIFI_SSID_MAX_LENGTH 32
 #define WIFI_PASSWORD_MAX_LENGTH 64
 
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Connection state machine states
+     */
+    typedef enum
+    {
+        WIFI_STATE_IDLE = 0,       // No credentials, or disconnected on request
+        WIFI_STATE_SCANNING,       // Join started, looking for the access point
+        WIFI_STATE_AUTHENTICATING, // Associated, completing authentication
+        WIFI_STATE_DHCP,           // Link up, waiting for an address
+        WIFI_STATE_CONNECTED,      // Link up with an IP address
+        WIFI_STATE_BACKOFF         // Attempt failed or link lost; waiting to retry
+    } wifi_state_t;
+
+    /**
+     * @brief Called from wifi_manager_update() on every state change
+     * @param state New state
+     * @param previous State that was left
+     */
+    typedef void (*wifi_event_callback_t)(wifi_state_t state, wifi_state_t previous);
+
     // =============================================================================
     // PUBLIC FUNCTION DECLARATIONS
     // =============================================================================
@@ -37,15 +66,20 @@ extern "C"
     void wifi_manager_deinit(void);
 
     /**
-     * @brief Connect to a WiFi network
+     * @brief Start connecting to a WiFi network
+     *
+     * Returns immediately; progress is driven by wifi_manager_update() and
+     * reported through the event callback. The credentials are kept so a
+     * lost link is rejoined automatically.
+     *
      * @param ssid The network SSID
      * @param password The network password (can be NULL for open networks)
-     * @return true if connection was successful, false otherwise
+     * @return true if the attempt was started, false otherwise
      */
     bool wifi_connect(const char *ssid, const char *password);
 
     /**
-     * @brief Disconnect from the current WiFi network
+     * @brief Disconnect from the current WiFi network and stop reconnecting
      */
     void wifi_disconnect(void);
 
@@ -74,10 +108,38 @@ extern "C"
     int wifi_get_rssi(void);
 
     /**
-     * @brief Update the WiFi manager (call this periodically)
+     * @brief Advance the connection state machine (call this every loop)
+     *
+     * Never blocks: it only polls the link status, and starts a new join
+     * once a backoff delay has expired.
      */
     void wifi_manager_update(void);
 
+    /**
+     * @brief Get the connection state
+     * @return Current state machine state
+     */
+    wifi_state_t wifi_get_state(void);
+
+    /**
+     * @brief Get a printable name for a state
+     * @param state State to name
+     * @return Upper-case state name
+     */
+    const char *wifi_state_name(wifi_state_t state);
+
+    /**
+     * @brief Get the number of join attempts since wifi_connect()
+     * @return Attempts started, including the current one
+     */
+    uint32_t wifi_get_attempts(void);
+
+    /**
+     * @brief Get the time until the next join attempt
+     * @return Milliseconds left in WIFI_STATE_BACKOFF, 0 in any other state
+     */
+    uint32_t wifi_get_retry_delay_ms(void);
+
     /**
      * @brief Set the WiFi hostname
      * @param hostname The hostname to set
@@ -104,16 +166,16 @@ extern "C"
      */
     void wifi_toggle_led(void);
 
+    /**
+     * @brief Register the state change callback
+     * @param callback Function to call, or NULL to remove it
+     */
+    void wifi_register_event_callback(wifi_event_callback_t callback);
+
     // =============================================================================
     // COMPATIBILITY FUNCTIONS (simplified implementations)
     // =============================================================================
 
-    /**
-     * @brief Register an event callback (simplified - does nothing in this version)
-     * @param callback The callback function pointer
-     */
-    void wifi_register_event_callback(void *callback);
-
     /**
      * @brief Scan for available networks (simplified - does nothing in this version)
      * @return false (not implemented)
@@ -0,0 +1,250 @@
+/**
+ * @file display_mirror.cpp
+ * @brief Live copy of the display for WebSocket viewers
+ *
+ * One message is packed for all viewers and sent to each as a binary
+ * frame. Messages go out when full, or every 1000 / WEB_DISPLAY_FRAMERATE
+ * ms with whatever accumulated, so a burst of small redraws shares frames.
+ * A viewer that misses a message (its send buffer was full) has a stale
+ * screen; every viewer is then resynced, which for the usual single viewer
+ * is the same thing.
+ *
+ * Viewers join and leave from WebSocket callbacks, which may interrupt the
+ * main loop mid-message; the changes are queued under the lwIP lock and
+ * applied at the top of display_mirror_update(), so only the main loop
+ * touches the viewer set and the writer.
+ */
+
+#include "../include/display_mirror.h"
+#include "../include/pico_display.h"
+#include "../include/websocket_server.h"
+#include "../include/board_config.h"
+#include "hal_interface.h"
+#include "display_stream.h"
+#include "pico/cyw43_arch.h"
+
+#include <cstring>
+#include <cstdio>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define MIRROR_SEND_INTERVAL_MS (1000 / WEB_DISPLAY_FRAMERATE)
+#define MIRROR_MAX_WIDTH (DISPLAY_WIDTH > DISPLAY_HEIGHT ? DISPLAY_WIDTH : DISPLAY_HEIGHT)
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static uint8_t message[DISPLAY_MIRROR_MESSAGE_SIZE];
+static display_stream_writer_t writer;
+static bool writer_ready = false;
+
+static uint8_t viewers = 0; // Bit per WebSocket client id
+static volatile uint8_t viewers_joining = 0; // Queued by display_mirror_set_viewer()
+static volatile uint8_t viewers_leaving = 0;
+static bool resyncing = false;
+static uint16_t resync_row = 0; // Next row to repaint
+static uint32_t last_send_ms = 0;
+static uint32_t last_step_ms = 0;
+static display_mirror_stats_t mirror_stats = {};
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static bool send_message(const uint8_t *data, size_t len, void *context);
+static void start_resync(uint32_t now_ms);
+static void apply_viewer_changes(uint32_t now_ms);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+bool display_mirror_set_viewer(int client_id, bool enabled)
+{
+    if (client_id < 0 || client_id >= WEBSOCKET_MAX_CLIENTS)
+    {
+        return false;
+    }
+
+    // The last request wins: a client that leaves and rejoins before the
+    // next update is resynced, one that joins and leaves is never added
+    uint8_t bit = (uint8_t)(1u << client_id);
+    cyw43_arch_lwip_begin();
+    if (enabled)
+    {
+        viewers_joining |= bit;
+        viewers_leaving &= (uint8_t)~bit;
+    }
+    else
+    {
+        viewers_leaving |= bit;
+        viewers_joining &= (uint8_t)~bit;
+    }
+    cyw43_arch_lwip_end();
+    return true;
+}
+
+void display_mirror_update(void)
+{
+    uint32_t now_ms = hal_get_tick_ms();
+    apply_viewer_changes(now_ms);
+
+    if (viewers == 0)
+    {
+        writer.len = 0; // Nobody left to send to
+        resyncing = false;
+        return;
+    }
+
+    if (writer.failed)
+    {
+        start_resync(now_ms);
+    }
+
+    if (resyncing && now_ms - last_step_ms >= DISPLAY_MIRROR_RESYNC_INTERVAL_MS)
+    {
+        // Whatever is pending belongs before the repaint; a repaint is sent whole
+        display_stream_flush(&writer);
+        if (resync_row == 0)
+        {
+            display_stream_size(&writer, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+        }
+        pico_display_repaint_mirror(resync_row, DISPLAY_MIRROR_RESYNC_ROWS);
+        display_stream_flush(&writer);
+        last_send_ms = now_ms;
+        last_step_ms = now_ms;
+
+        resync_row = (uint16_t)(resync_row + DISPLAY_MIRROR_RESYNC_ROWS);
+        resyncing = resync_row < DISPLAY_HEIGHT;
+        return;
+    }
+
+    if (writer.len > 0 && now_ms - last_send_ms >= MIRROR_SEND_INTERVAL_MS)
+    {
+        display_stream_flush(&writer);
+        last_send_ms = now_ms;
+    }
+}
+
+void display_mirror_push(const fb_rect_t *rect, const uint16_t *pixels, uint16_t stride)
+{
+    if (viewers != 0)
+    {
+        display_stream_rect(&writer, rect, pixels, stride);
+    }
+}
+
+void display_mirror_scroll(uint16_t x, uint16_t width, const uint16_t *column, uint16_t height)
+{
+    if (viewers != 0)
+    {
+        display_stream_scroll(&writer, x, width, column, height);
+    }
+}
+
+void display_mirror_get_stats(display_mirror_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    *stats = mirror_stats;
+    stats->viewers = 0;
+    // Queued changes count, so a DISPLAY_MIRROR reply includes its own client
+    uint8_t current = (uint8_t)((viewers & ~viewers_leaving) | viewers_joining);
+    for (uint8_t mask = current; mask; mask &= (uint8_t)(mask - 1))
+    {
+        stats->viewers++;
+    }
+    stats->messages = writer.messages;
+    stats->bytes = (uint32_t)writer.bytes;
+    stats->pixels = (uint32_t)writer.pixels;
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static bool send_message(const uint8_t *data, size_t len, void *context)
+{
+    (void)context;
+    bool sent = true;
+    for (int i = 0; i < WEBSOCKET_MAX_CLIENTS; i++)
+    {
+        if ((viewers & (1u << i)) == 0)
+        {
+            continue;
+        }
+        if (!websocket_client_is_ready(i))
+        {
+            viewers &= (uint8_t)~(1u << i); // Gone without a disconnect callback yet
+            continue;
+        }
+        if (!websocket_send_binary(i, data, len))
+        {
+            mirror_stats.send_failures++;
+            sent = false;
+        }
+    }
+    return sent;
+}
+
+/**
+ * @brief Take the queued joins and leaves; a join starts a resync
+ */
+static void apply_viewer_changes(uint32_t now_ms)
+{
+    cyw43_arch_lwip_begin();
+    uint8_t joining = viewers_joining;
+    uint8_t leaving = viewers_leaving;
+    viewers_joining = 0;
+    viewers_leaving = 0;
+    cyw43_arch_lwip_end();
+
+    viewers &= (uint8_t)~leaving;
+    if (joining == 0)
+    {
+        return;
+    }
+
+    if (!writer_ready)
+    {
+        writer_ready = display_stream_writer_init(&writer, message, sizeof(message), MIRROR_MAX_WIDTH,
+                                                  send_message, NULL);
+        if (!writer_ready)
+        {
+            printf("[MIRROR] Stream writer setup failed\n");
+            return;
+        }
+    }
+
+    for (int i = 0; i < WEBSOCKET_MAX_CLIENTS; i++)
+    {
+        if ((joining & (1u << i)) != 0 && (viewers & (1u << i)) == 0)
+        {
+            printf("[MIRROR] Client %d viewing the display\n", i);
+        }
+    }
+    viewers |= joining;
+    start_resync(now_ms);
+}
+
+/**
+ * @brief Repaint everything, starting one send interval from now
+ *
+ * What is pending was already missed by someone; the wait lets the send
+ * buffer that refused it drain.
+ */
+static void start_resync(uint32_t now_ms)
+{
+    writer.len = 0;
+    writer.failed = false;
+    resyncing = true;
+    resync_row = 0;
+    last_step_ms = now_ms - DISPLAY_MIRROR_RESYNC_INTERVAL_MS + MIRROR_SEND_INTERVAL_MS;
+    mirror_stats.resyncs++;
+}
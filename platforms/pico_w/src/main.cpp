@@ -13,11 +13,26 @@
 #include "../system/system_loop.h"
 #include "../system/system_info.h"
 #include "../ui/input_handler.h"
+#include "../ui/display_manager.h"
+#include "../ui/status_indicators.h"
+#include "../ui/strip_chart.h"
 #include "../system/safety_monitor.h"
 #include "../utils/hal_demo.h"
 #include "../utils/hal_test.h"
 #include "../include/wifi_manager.h"
 #include "../include/websocket_server.h"
+#include "../include/web_server.h"
+#include "../include/net_stats.h"
+#include "../include/udp_stream.h"
+#include "../include/sampler.h"
+#include "../include/pico_display.h"
+#include "../include/telemetry.h"
+#include "../include/rig_commands.h"
+#include "../include/telnet_server.h"
+#include "../include/time_sync.h"
+#include "../include/display_mirror.h"
+#include "touch_driver.h"
+#include "ili9481_driver.h"
 #include "../monitoring/diagnostics_engine.h"
 #include "../include/board_config.h"
 
@@ -131,7 +146,7 @@ static void system_emergency_stop_handler(void);
 static void cleanup_and_exit(void);
 static bool setup_wifi_connection(void);
 static void wifi_event_handler_simplified(void);
-static bool websocket_command_handler(const char *command, const char *params, int client_id);
+static void wifi_state_changed(wifi_state_t state, wifi_state_t previous);
 static void websocket_client_handler(int client_id, bool connected, const char *client_ip);
 static void configure_wifi_via_uart(void);
 static void send_channel_updates(void);
@@ -139,7 +154,14 @@ static void web_integration_update(void);
 static void update_wifi_led_status(void);
 static bool initialize_pico_w_hardware(void);
 static void send_system_status_update(void);
-static void handle_uart_wifi_commands(void);
+static void update_status_screen(void);
+static void show_status_screen(void);
+static void show_chart_screen(void);
+static void update_chart_screen(void);
+static void setup_touch(void);
+static void handle_touch_events(void);
+static void update_display_power(void);
+void integrate_web_updates_in_main_loop(void);
 
 // =============================================================================
 // PRIVATE VARIABLES
@@ -147,18 +169,22 @@ static void handle_uart_wifi_commands(void);
 
 static bool wifi_setup_complete = false;
 static bool websocket_setup_complete = false;
+static bool http_setup_complete = false;
+static bool telnet_setup_complete = false;
+static bool time_sync_started = false;
 static bool pico_w_initialized = false;
 static uint32_t last_channel_update = 0;
-static uint32_t last_web_update = 0;
 static uint32_t last_status_update = 0;
+static uint32_t last_display_update = 0;
 static uint32_t last_wifi_led_update = 0;
-static uint32_t wifi_connection_attempts = 0;
 static bool wifi_led_state = false;
 
-// WiFi configuration buffer for UART commands
-static char wifi_ssid_buffer[WIFI_SSID_MAX_LENGTH] = {0};
-static char wifi_password_buffer[WIFI_PASSWORD_MAX_LENGTH] = {0};
-static bool wifi_configured_via_uart = false;
+// Strip chart screen, shown while a UDP stream runs
+static bool chart_screen_shown = false;
+static ui_widget_id_t chart_values[SAMPLER_CHANNELS];
+
+// The touch that woke the display was made on a dark screen: its gesture is dropped
+static bool touch_wake_gesture = false;
 
 // =============================================================================
 // MAIN FUNCTION
@@ -201,10 +227,19 @@ int main()
         cleanup_and_exit();
         return -2;
     }
+    setup_touch();
 
     // Setup emergency stop handling
     setup_emergency_stop();
 
+    // One command table for the UART console and WebSocket clients
+    static const rig_command_hooks_t command_hooks = {
+        send_system_status_update,
+        send_channel_updates,
+        system_emergency_stop_handler,
+    };
+    rig_commands_init(&command_hooks);
+
     // Print system information
     display_system_info();
     print_init_progress();
@@ -246,6 +281,9 @@ int main()
         }
     }
 
+    // Status screen on the display, refreshed from the main loop
+    show_status_screen();
+
     printf("\n");
     printf("=======================================================\n");
     printf(" System Ready - Starting Main Application Loop\n");
@@ -256,6 +294,13 @@ int main()
         printf("📡 WiFi Connected: %s\n", wifi_get_ip_address());
         printf("🌐 WebSocket Server: ws://%s:%d\n", wifi_get_ip_address(), NET_WEBSOCKET_PORT);
         printf("🖥️  Web Interface: http://%s:%d\n", wifi_get_ip_address(), NET_HTTP_PORT);
+#if TELNET_ENABLED
+        printf("⌨️  Console: telnet %s %d\n", wifi_get_ip_address(), NET_TELNET_PORT);
+#endif
+    }
+    else if (wifi_get_state() != WIFI_STATE_IDLE)
+    {
+        printf("📡 WiFi: Connecting to %s in the background (%s)\n", wifi_get_ssid(), wifi_state_name(wifi_get_state()));
     }
     else
     {
@@ -276,7 +321,8 @@ int main()
         websocket_send_log("info", "System", "Multi-Channel Diagnostic Test Rig online and ready");
     }
 
-    // Enter the main application loop
+    // Enter the main application loop with web integration hooked in
+    register_main_loop_hook(integrate_web_updates_in_main_loop);
     run_main_loop();
 
     // If we reach here, the system is shutting down
@@ -348,32 +394,18 @@ static bool setup_wifi_connection(void)
         return false;
     }
 
-    // Register simplified WiFi event callback (no actual callback in simplified version)
-    wifi_register_event_callback(NULL);
+    // Servers are started and stopped from the state change callback
+    wifi_register_event_callback(wifi_state_changed);
 
     // Set hostname
     wifi_set_hostname(WIFI_HOSTNAME);
 
-    // Connect to WiFi
-    bool wifi_connected = false;
-    wifi_connection_attempts = 0;
-
+    // Connect to WiFi in the background; the main loop drives the join
     if (USE_HARDCODED_WIFI)
     {
-        printf("[WIFI] Connecting to %s...\n", WIFI_SSID);
-        wifi_connection_attempts++;
-        wifi_connected = wifi_connect(WIFI_SSID, WIFI_PASSWORD);
-
-        if (wifi_connected)
+        if (!wifi_connect(WIFI_SSID, WIFI_PASSWORD))
         {
-            printf("[WIFI] Connection successful!\n");
-            // Initialize WebSocket server after successful WiFi connection
-            wifi_event_handler_simplified();
-        }
-        else
-        {
-            printf("[WIFI] Failed to connect to WiFi\n");
-            printf("[WIFI] Will continue attempting to connect in background\n");
+            printf("[WIFI] Failed to start connecting to %s\n", WIFI_SSID);
         }
     }
     else
@@ -400,76 +432,11 @@ static void configure_wifi_via_uart(void)
     printf("  For open networks: WIFI_CONNECT MyNetwork\n");
     printf("  Check status: WIFI_STATUS\n");
     printf("  Disconnect: WIFI_DISCONNECT\n");
+    printf("  All commands: HELP\n");
     printf("================================\n");
     printf("\n");
 }
 
-/**
- * @brief Handle UART WiFi commands
- */
-static void handle_uart_wifi_commands(void)
-{
-    char uart_command[256];
-    // This function would be called from the UART handler
-    // Implementation depends on your UART command parsing system
-
-    // Example implementation (you'd integrate this with your existing UART handler):
-
-    if (strncmp(uart_command, "WIFI_CONNECT", 12) == 0)
-    {
-        char ssid[WIFI_SSID_MAX_LENGTH];
-        char password[WIFI_PASSWORD_MAX_LENGTH];
-
-        // Parse command: WIFI_CONNECT <SSID> <PASSWORD>
-        int parsed = sscanf(uart_command + 13, "%31s %63s", ssid, password);
-
-        if (parsed >= 1)
-        {
-            strncpy(wifi_ssid_buffer, ssid, sizeof(wifi_ssid_buffer) - 1);
-            if (parsed >= 2)
-            {
-                strncpy(wifi_password_buffer, password, sizeof(wifi_password_buffer) - 1);
-            }
-            else
-            {
-                wifi_password_buffer[0] = '\0'; // Open network
-            }
-
-            wifi_configured_via_uart = true;
-            wifi_connection_attempts++;
-
-            printf("[WIFI] Attempting to connect to %s...\n", wifi_ssid_buffer);
-            if (wifi_connect(wifi_ssid_buffer, wifi_password_buffer))
-            {
-                printf("[WIFI] Connection initiated\n");
-            }
-            else
-            {
-                printf("[WIFI] Connection failed\n");
-            }
-        }
-    }
-    else if (strncmp(uart_command, "WIFI_STATUS", 11) == 0)
-    {
-        if (wifi_is_connected())
-        {
-            printf("[WIFI] Status: Connected to %s\n", wifi_get_ssid());
-            printf("[WIFI] IP Address: %s\n", wifi_get_ip_address());
-            printf("[WIFI] RSSI: %d dBm\n", wifi_get_rssi());
-        }
-        else
-        {
-            printf("[WIFI] Status: Disconnected\n");
-            printf("[WIFI] Attempts: %lu\n", wifi_connection_attempts);
-        }
-    }
-    else if (strncmp(uart_command, "WIFI_DISCONNECT", 15) == 0)
-    {
-        wifi_disconnect();
-        printf("[WIFI] Disconnected\n");
-    }
-}
-
 /**
  * @brief Simplified WiFi event handler
  */
@@ -478,7 +445,7 @@ static void wifi_event_handler_simplified(void)
     // Check if we're connected and handle WebSocket initialization
     if (wifi_is_connected())
     {
-        printf("[WIFI] WiFi connection detected\n");
+        printf("[WIFI] WiFi connection detected, IP: %s\n", wifi_get_ip_address());
 
         // Initialize WebSocket server now that WiFi is connected
         if (!websocket_setup_complete)
@@ -488,8 +455,11 @@ static void wifi_event_handler_simplified(void)
             {
                 websocket_setup_complete = true;
 
+                // Change-only telemetry starts with a keyframe for every client
+                telemetry_init(NULL);
+
                 // Register WebSocket callbacks
-                websocket_register_command_callback(websocket_command_handler);
+                websocket_register_message_callback(rig_commands_websocket_message);
                 websocket_register_client_callback(websocket_client_handler);
 
                 printf("[WEBSOCKET] WebSocket server started on port %d\n", NET_WEBSOCKET_PORT);
@@ -501,6 +471,34 @@ static void wifi_event_handler_simplified(void)
             }
         }
 
+#if HTTP_SERVER_ENABLED
+        // Serve the web UI from flash so the rig needs no external host
+        if (!http_setup_complete)
+        {
+            http_setup_complete = web_server_init();
+            if (http_setup_complete)
+            {
+                web_server_register_api("/api/netstats", net_stats_format_json);
+            }
+        }
+#endif
+
+#if TELNET_ENABLED
+        // Remote copies of the UART console: same commands, same log stream
+        if (!telnet_setup_complete)
+        {
+            telnet_setup_complete = telnet_server_init();
+        }
+#endif
+
+#if TIME_SYNC_ENABLED
+        // Put sample blocks and logs on the host's clock; TIME_SYNC may retarget it later
+        if (!time_sync_started)
+        {
+            time_sync_started = time_sync_start(TIME_SYNC_SERVER, TIME_SYNC_PORT, TIME_SYNC_INTERVAL_S);
+        }
+#endif
+
         if (websocket_setup_complete)
         {
             websocket_send_log("info", "WiFi", "Successfully connected to network");
@@ -517,57 +515,21 @@ static void wifi_event_handler_simplified(void)
             websocket_send_log("warn", "WiFi", "Disconnected from network");
         }
 
-        // Attempt reconnection if we have credentials
-        if (USE_HARDCODED_WIFI || wifi_configured_via_uart)
-        {
-            printf("[WIFI] Attempting reconnection in %d seconds...\n", WIFI_RECONNECT_DELAY_MS / 1000);
-            // Note: Actual reconnection logic would be handled by the WiFi manager
-        }
+        // The WiFi manager rejoins on its own, backing off between failures
     }
 }
 
 /**
- * @brief WebSocket command handler callback
+ * @brief WiFi state machine callback
  */
-static bool websocket_command_handler(const char *command, const char *params, int client_id)
+static void wifi_state_changed(wifi_state_t state, wifi_state_t previous)
 {
-    printf("[WEBSOCKET] Command from client %d: %s %s\n", client_id, command, params ? params : "");
+    printf("[WIFI] %s -> %s\n", wifi_state_name(previous), wifi_state_name(state));
 
-    // Handle specific commands
-    if (strcmp(command, "GET_STATUS") == 0)
+    if (state == WIFI_STATE_CONNECTED || previous == WIFI_STATE_CONNECTED)
     {
-        send_system_status_update();
-        return true;
+        wifi_event_handler_simplified();
     }
-    else if (strcmp(command, "GET_CHANNELS") == 0)
-    {
-        send_channel_updates();
-        return true;
-    }
-    else if (strcmp(command, "WIFI_STATUS") == 0)
-    {
-        // Send WiFi status
-        char wifi_status[256];
-        if (wifi_is_connected())
-        {
-            snprintf(wifi_status, sizeof(wifi_status),
-                     "Connected to %s, IP: %s, RSSI: %d dBm",
-                     wifi_get_ssid(), wifi_get_ip_address(), wifi_get_rssi());
-        }
-        else
-        {
-            snprintf(wifi_status, sizeof(wifi_status), "Disconnected");
-        }
-        websocket_send_log("info", "WiFi", wifi_status);
-        return true;
-    }
-
-    // Log command execution
-    char log_msg[128];
-    snprintf(log_msg, sizeof(log_msg), "Command executed: %s", command);
-    websocket_send_log("info", "Command", log_msg);
-
-    return true;
 }
 
 /**
@@ -583,12 +545,18 @@ static void websocket_client_handler(int client_id, bool connected, const char *
         snprintf(log_msg, sizeof(log_msg), "Client connected from %s", client_ip ? client_ip : "unknown");
         websocket_send_log("info", "WebSocket", log_msg);
 
-        // Send welcome message and initial status
+        // New clients start from a keyframe
+        telemetry_reset_client(client_id);
         send_system_status_update();
+        send_channel_updates();
     }
     else
     {
         printf("[WEBSOCKET] Client %d disconnected\n", client_id);
+        telemetry_reset_client(client_id);
+#if WEB_DISPLAY_ENABLED && WEB_DISPLAY_WEBSOCKET
+        display_mirror_set_viewer(client_id, false);
+#endif
         websocket_send_log("info", "WebSocket", "Client disconnected");
     }
 }
@@ -613,7 +581,7 @@ static void update_wifi_led_status(void)
             last_wifi_led_update = current_time;
         }
     }
-    else if (wifi_connection_attempts > 0)
+    else if (wifi_get_state() != WIFI_STATE_IDLE)
     {
         // Fast blink when trying to connect
         if (current_time - last_wifi_led_update >= WIFI_LED_BLINK_CONNECTING_MS)
@@ -633,20 +601,247 @@ static void update_wifi_led_status(void)
 
 /**
  * @brief Send system status update via WebSocket
+ *
+ * Only fields that changed since each client's last update are sent; uptime
+ * and loop count ride along with the periodic keyframe.
  */
 static void send_system_status_update(void)
 {
     if (!websocket_setup_complete)
         return;
 
-    // Create system status message
-    char status_msg[512];
-    snprintf(status_msg, sizeof(status_msg),
-             "System Status: Online | WiFi: %s | Uptime: %lu ms",
-             wifi_is_connected() ? "Connected" : "Disconnected",
-             to_ms_since_boot(get_absolute_time()));
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    bool connected = wifi_is_connected();
+
+    telemetry_status_t status;
+    status.wifi_connected = connected;
+    status.rssi = connected ? wifi_get_rssi() : 0;
+    status.uptime_s = get_system_uptime_seconds();
+    status.loop_count = get_loop_counter();
 
-    websocket_send_log("info", "Status", status_msg);
+    telemetry_publish_status(&status, now_ms);
+}
+
+/**
+ * @brief Show the current system status on the display
+ *
+ * Widgets only change when their values do, so the redraw sends just those.
+ */
+static void update_status_screen(void)
+{
+    bool connected = wifi_is_connected();
+
+    status_indicators_state_t state;
+    state.uptime_ms = to_ms_since_boot(get_absolute_time());
+    state.loop_count = get_loop_counter();
+    state.wifi_connected = connected;
+    state.rssi = connected ? wifi_get_rssi() : 0;
+    state.address = connected ? wifi_get_ip_address() : NULL;
+
+    status_indicators_update(&state);
+    display_manager_update();
+}
+
+/**
+ * @brief Build the status screen, ending the chart screen if it was shown
+ */
+static void show_status_screen(void)
+{
+    if (chart_screen_shown)
+    {
+        udp_stream_set_frame_listener(NULL, NULL);
+        pico_display_scroll_area(0, 0);
+        chart_screen_shown = false;
+    }
+
+    display_manager_init(DISPLAY_WIDTH, DISPLAY_HEIGHT, 0x000000, DISPLAY_UPDATE_RATE_MS);
+    status_indicators_init();
+    update_status_screen();
+}
+
+// =============================================================================
+// STRIP CHART SCREEN
+// =============================================================================
+
+static const uint32_t chart_colors[STRIP_CHART_MAX_CHANNELS] = {0xFFE000, 0x00E0FF, 0xFF60C0, 0x80FF40};
+
+static void chart_frames(const uint16_t *frames, size_t frame_count, void *context)
+{
+    (void)context;
+    if (pico_display_get_power() == PICO_DISPLAY_ASLEEP)
+    {
+        return; // Nothing is drawn while the panel sleeps
+    }
+    strip_chart_push_block(frames, frame_count, SAMPLER_CHANNELS);
+}
+
+static void chart_column(const uint16_t *pixels, uint16_t height, void *context)
+{
+    (void)height;
+    (void)context;
+    pico_display_scroll_column(pixels);
+}
+
+/**
+ * @brief Build the chart screen: lane captions and values left, the scrolling chart right
+ */
+static void show_chart_screen(void)
+{
+    udp_stream_stats_t stream;
+    udp_stream_get_stats(&stream);
+
+    display_manager_init(DISPLAY_WIDTH, DISPLAY_HEIGHT, 0x000000, DISPLAY_UPDATE_RATE_MS);
+    ui_widget_id_t captions = ui_panel_create(UI_SCREEN, 0, 0, DISPLAY_CHART_X, DISPLAY_HEIGHT, 0x101828, 0x5070A0);
+    uint16_t lane_height = DISPLAY_HEIGHT / SAMPLER_CHANNELS;
+    for (int ch = 0; ch < SAMPLER_CHANNELS; ch++)
+    {
+        char caption[8];
+        snprintf(caption, sizeof(caption), "CH%d", ch + 1);
+        uint16_t y = (uint16_t)(ch * lane_height + lane_height / 2 - 10);
+        ui_label_create(captions, 8, y, 4, caption, chart_colors[ch]);
+        chart_values[ch] = ui_value_create(captions, 8, (uint16_t)(y + 12), 7, 2, " V", 0xFFFFFF);
+    }
+    // The chart area starts out blank; columns scroll in from its right edge
+    ui_panel_create(UI_SCREEN, DISPLAY_CHART_X, 0, DISPLAY_WIDTH - DISPLAY_CHART_X, DISPLAY_HEIGHT, 0x000000,
+                    0x000000);
+    display_manager_update();
+
+    strip_chart_config_t chart = {};
+    chart.height = DISPLAY_HEIGHT;
+    chart.channels = SAMPLER_CHANNELS;
+    chart.samples_per_column = (uint16_t)(stream.rate_hz > DISPLAY_CHART_COLUMN_RATE
+                                              ? stream.rate_hz / DISPLAY_CHART_COLUMN_RATE
+                                              : 1);
+    chart.min = 0;
+    chart.max = 4095;
+    memcpy(chart.colors, chart_colors, sizeof(chart.colors));
+    chart.background = 0x000000;
+    chart.grid = 0x304060;
+    chart.output = chart_column;
+
+    if (!pico_display_scroll_area(DISPLAY_CHART_X, DISPLAY_WIDTH - DISPLAY_CHART_X))
+    {
+        printf("[MAIN] Display cannot scroll: strip chart values only\n");
+    }
+    strip_chart_init(&chart);
+    udp_stream_set_frame_listener(chart_frames, NULL);
+    chart_screen_shown = true;
+}
+
+/**
+ * @brief Show each lane's latest value beside the chart
+ */
+static void update_chart_screen(void)
+{
+    for (int ch = 0; ch < SAMPLER_CHANNELS; ch++)
+    {
+        ui_value_set(chart_values[ch], ADC_TO_VOLTAGE(strip_chart_get_latest((uint8_t)ch)));
+    }
+    display_manager_update();
+}
+
+/**
+ * @brief Start the touch controller on the display bus, calibrated from the board's edge readings
+ */
+static void setup_touch(void)
+{
+#if TOUCH_XPT2046
+    // Panel corners in screen coordinates (the screen is centred on the landscape panel)
+    const int16_t left = -DISPLAY_PANEL_X_OFFSET;
+    const int16_t right = ILI9481_NATIVE_HEIGHT - DISPLAY_PANEL_X_OFFSET;
+    const int16_t top = -DISPLAY_PANEL_Y_OFFSET;
+    const int16_t bottom = ILI9481_NATIVE_WIDTH - DISPLAY_PANEL_Y_OFFSET;
+    touch_point_t screen[3] = {{left, top}, {right, top}, {left, bottom}};
+#if TOUCH_SWAP_XY
+    touch_point_t raw[3] = {{TOUCH_RAW_TOP, TOUCH_RAW_LEFT},
+                            {TOUCH_RAW_TOP, TOUCH_RAW_RIGHT},
+                            {TOUCH_RAW_BOTTOM, TOUCH_RAW_LEFT}};
+#else
+    touch_point_t raw[3] = {{TOUCH_RAW_LEFT, TOUCH_RAW_TOP},
+                            {TOUCH_RAW_RIGHT, TOUCH_RAW_TOP},
+                            {TOUCH_RAW_LEFT, TOUCH_RAW_BOTTOM}};
+#endif
+
+    touch_config_t config = {};
+    config.spi_id = 0;
+    config.cs_pin = TOUCH_CS_PIN;
+    config.irq_pin = TOUCH_IRQ_PIN;
+    config.frequency = TOUCH_SPI_FREQUENCY;
+    config.width = DISPLAY_WIDTH;
+    config.height = DISPLAY_HEIGHT;
+    config.pressure_min = TOUCH_PRESSURE_MIN;
+    config.interval_ms = TOUCH_SAMPLE_INTERVAL_MS;
+    touch_calibrate(raw, screen, &config.calibration);
+
+    if (touch_init(&config) != HAL_OK)
+    {
+        printf("WARNING: Touch controller not available\n");
+    }
+#endif
+}
+
+/**
+ * @brief Log touch gestures queued since the last pass
+ */
+static void handle_touch_events(void)
+{
+    input_event_t event;
+    while (get_next_input_event(&event))
+    {
+        if (touch_wake_gesture)
+        {
+            continue;
+        }
+        switch (event.type)
+        {
+        case INPUT_EVENT_TOUCH_TAP:
+            printf("[TOUCH] Tap at (%d, %d)\n", event.data.touch.x, event.data.touch.y);
+            break;
+        case INPUT_EVENT_TOUCH_LONG_PRESS:
+            printf("[TOUCH] Long press at (%d, %d)\n", event.data.touch.x, event.data.touch.y);
+            break;
+        case INPUT_EVENT_TOUCH_DRAG_END:
+            printf("[TOUCH] Drag (%d, %d) -> (%d, %d) in %lu ms\n", event.data.touch.start_x,
+                   event.data.touch.start_y, event.data.touch.x, event.data.touch.y,
+                   (unsigned long)event.data.touch.duration_ms);
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (touch_wake_gesture && !touch_get_position(NULL, NULL))
+    {
+        touch_wake_gesture = false; // Released: the next touch counts
+    }
+}
+
+/**
+ * @brief Dim the display, then put it to sleep, after a while without input; wake it on input
+ */
+static void update_display_power(void)
+{
+    uint32_t idle_ms = input_get_idle_ms();
+    pico_display_power_t power = PICO_DISPLAY_ON;
+    if (DISPLAY_SLEEP_TIMEOUT_MS > 0 && idle_ms >= DISPLAY_SLEEP_TIMEOUT_MS)
+    {
+        power = PICO_DISPLAY_ASLEEP;
+    }
+    else if (DISPLAY_DIM_TIMEOUT_MS > 0 && idle_ms >= DISPLAY_DIM_TIMEOUT_MS)
+    {
+        power = PICO_DISPLAY_DIMMED;
+    }
+
+    pico_display_power_t previous = pico_display_get_power();
+    if (power == previous)
+    {
+        return;
+    }
+    if (previous == PICO_DISPLAY_ASLEEP)
+    {
+        touch_wake_gesture = touch_get_position(NULL, NULL);
+    }
+    pico_display_set_power(power);
 }
 
 /**
@@ -689,6 +884,9 @@ static void system_emergency_stop_handler(void)
 
 /**
  * @brief Send periodic channel data updates via WebSocket
+ *
+ * Readings are handed to the telemetry publisher, which decides per client
+ * which fields moved beyond their deadband and need to go on the wire.
  */
 static void send_channel_updates(void)
 {
@@ -697,64 +895,35 @@ static void send_channel_updates(void)
         return;
     }
 
-    // Read and send channel data for each diagnostic channel
+    static const uint32_t enable_pins[NUM_DIAGNOSTIC_CHANNELS] = {
+        DIAG_CH1_ENABLE_PIN, DIAG_CH2_ENABLE_PIN, DIAG_CH3_ENABLE_PIN, DIAG_CH4_ENABLE_PIN};
+
+    telemetry_channel_t readings[NUM_DIAGNOSTIC_CHANNELS];
+
+    // Read channel data for each diagnostic channel
     for (int channel = 1; channel <= NUM_DIAGNOSTIC_CHANNELS; channel++)
     {
-        // Read voltage and current for this channel
+        telemetry_channel_t *reading = &readings[channel - 1];
         uint16_t adc_value;
-        float voltage = 0.0f;
-        float current = 0.0f;
-        bool channel_enabled = false;
+        reading->enabled = false;
+        reading->voltage = 0.0f;
+        reading->current = 0.0f;
 
         // Check if channel is enabled (using correct GPIO_STATE_HIGH constant)
-        switch (channel)
+        gpio_state_t state;
+        if (hal_gpio_read(enable_pins[channel - 1], &state) == HAL_OK)
         {
-        case 1:
-        {
-            gpio_state_t state;
-            if (hal_gpio_read(DIAG_CH1_ENABLE_PIN, &state) == HAL_OK)
-            {
-                channel_enabled = (state == GPIO_STATE_HIGH);
-            }
-        }
-        break;
-        case 2:
-        {
-            gpio_state_t state;
-            if (hal_gpio_read(DIAG_CH2_ENABLE_PIN, &state) == HAL_OK)
-            {
-                channel_enabled = (state == GPIO_STATE_HIGH);
-            }
-        }
-        break;
-        case 3:
-        {
-            gpio_state_t state;
-            if (hal_gpio_read(DIAG_CH3_ENABLE_PIN, &state) == HAL_OK)
-            {
-                channel_enabled = (state == GPIO_STATE_HIGH);
-            }
-        }
-        break;
-        case 4:
-        {
-            gpio_state_t state;
-            if (hal_gpio_read(DIAG_CH4_ENABLE_PIN, &state) == HAL_OK)
-            {
-                channel_enabled = (state == GPIO_STATE_HIGH);
-            }
-        }
-        break;
+            reading->enabled = (state == GPIO_STATE_HIGH);
         }
 
-        if (channel_enabled)
+        if (reading->enabled)
         {
             // Read voltage (map channels to appropriate ADC inputs)
             if (channel <= 2)
             {
                 if (hal_adc_read(channel - 1, &adc_value) == HAL_OK)
                 {
-                    voltage = ADC_TO_VOLTAGE(adc_value) * (CHANNEL_VOLTAGE_RANGE / 3.3f);
+                    reading->voltage = ADC_TO_VOLTAGE(adc_value) * (CHANNEL_VOLTAGE_RANGE / 3.3f);
                 }
             }
 
@@ -763,14 +932,13 @@ static void send_channel_updates(void)
             {
                 if (hal_adc_read(ADC_CH3_CURRENT, &adc_value) == HAL_OK)
                 {
-                    current = ADC_TO_VOLTAGE(adc_value) * (CHANNEL_CURRENT_RANGE / 3.3f);
+                    reading->current = ADC_TO_VOLTAGE(adc_value) * (CHANNEL_CURRENT_RANGE / 3.3f);
                 }
             }
         }
-
-        // Send channel data via WebSocket
-        websocket_send_channel_data(channel, voltage, current);
     }
+
+    telemetry_publish_channels(readings, to_ms_since_boot(get_absolute_time()));
 }
 
 /**
@@ -780,19 +948,10 @@ static void web_integration_update(void)
 {
     uint32_t current_time = to_ms_since_boot(get_absolute_time());
 
-    // Update WiFi manager
+    // Advance the WiFi state machine; never blocks, events arrive via wifi_state_changed()
     if (wifi_setup_complete)
     {
         wifi_manager_update();
-
-        // Check WiFi status periodically and handle events
-        static bool last_wifi_status = false;
-        bool current_wifi_status = wifi_is_connected();
-        if (current_wifi_status != last_wifi_status)
-        {
-            wifi_event_handler_simplified();
-            last_wifi_status = current_wifi_status;
-        }
     }
 
     // Update WiFi LED status
@@ -804,8 +963,22 @@ static void web_integration_update(void)
         websocket_server_update();
     }
 
-    // Send periodic channel updates
-    if (current_time - last_channel_update >= 1000) // Every 1 second
+#if WEB_DISPLAY_ENABLED && WEB_DISPLAY_WEBSOCKET
+    // Send the display changes viewers have not seen (nothing without viewers)
+    display_mirror_update();
+#endif
+
+#if UDP_STREAM_ENABLED
+    // Move sampled frames into UDP sample blocks (and the strip chart, while it is shown)
+    udp_stream_update();
+    if (chart_screen_shown)
+    {
+        strip_chart_update();
+    }
+#endif
+
+    // Send periodic channel updates (unchanged fields are suppressed)
+    if (current_time - last_channel_update >= TELEMETRY_CHANNEL_INTERVAL_MS)
     {
         send_channel_updates();
         last_channel_update = current_time;
@@ -818,20 +991,57 @@ static void web_integration_update(void)
         last_status_update = current_time;
     }
 
-    // General web integration updates
-    if (current_time - last_web_update >= 100) // Every 100ms
-    {
-        // Handle any UART WiFi commands
-        handle_uart_wifi_commands();
+    // Dim and sleep the display when nobody is using it; wake it on input
+    update_display_power();
 
-        // Check for WiFi reconnection if needed
-        if (!wifi_is_connected() && (USE_HARDCODED_WIFI || wifi_configured_via_uart))
+    // Redraw what changed on the screen, switching to the strip chart while streaming
+    if (pico_display_get_power() != PICO_DISPLAY_ASLEEP && current_time - last_display_update >= DISPLAY_UPDATE_RATE_MS)
+    {
+#if UDP_STREAM_ENABLED
+        if (udp_stream_is_active() != chart_screen_shown)
+        {
+            if (chart_screen_shown)
+            {
+                show_status_screen();
+            }
+            else
+            {
+                show_chart_screen();
+            }
+        }
+        if (chart_screen_shown)
+        {
+            update_chart_screen();
+        }
+        else
+#endif
         {
-            // WiFi manager should handle automatic reconnection
+            update_status_screen();
         }
+        last_display_update = current_time;
+    }
+
+    // Run console commands as complete lines arrive; never waits for input
+    rig_commands_poll_uart();
 
-        last_web_update = current_time;
+    // Next touch burst while the screen is pressed; idle otherwise
+    touch_update();
+
+    // Callbacks of SPI transfers that finished since the last pass
+    hal_spi_poll();
+    handle_touch_events();
+
+#if TELNET_ENABLED
+    // Remote console sessions: their command lines, then whatever log output they have room for
+    if (telnet_setup_complete)
+    {
+        telnet_server_update();
     }
+#endif
+
+#if TIME_SYNC_ENABLED
+    time_sync_update();
+#endif
 }
 
 /**
@@ -855,6 +1065,30 @@ static void cleanup_and_exit(void)
         websocket_setup_complete = false;
     }
 
+#if UDP_STREAM_ENABLED
+    udp_stream_stop();
+#endif
+
+    // Stop HTTP server
+    if (http_setup_complete)
+    {
+        web_server_stop();
+        http_setup_complete = false;
+    }
+
+#if TELNET_ENABLED
+    if (telnet_setup_complete)
+    {
+        telnet_server_stop();
+        telnet_setup_complete = false;
+    }
+#endif
+
+#if TIME_SYNC_ENABLED
+    time_sync_stop();
+    time_sync_started = false;
+#endif
+
     // Disconnect WiFi
     if (wifi_setup_complete)
     {
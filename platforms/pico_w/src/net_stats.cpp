@@ -0,0 +1,165 @@
+/**
+ * @file net_stats.cpp
+ * @brief lwIP memory pool and protocol counter snapshots
+ *
+ * Reads lwip_stats directly; the pool names come from the same memp_std.h
+ * X-macro lwIP uses to build its pool table, so they always line up with
+ * the memp_t indices for the options in lwipopts.h.
+ */
+
+#include "../include/net_stats.h"
+
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+
+#include <cstring>
+#include <cstdio>
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+#if MEMP_STATS
+static const char *const pool_names[MEMP_MAX] = {
+#define LWIP_MEMPOOL(name, num, size, desc) #name,
+#include "lwip/priv/memp_std.h"
+};
+#endif
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+void net_stats_get(net_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->heap.name = "HEAP";
+
+#if MEM_STATS
+    stats->heap.avail = (uint32_t)lwip_stats.mem.avail;
+    stats->heap.used = (uint32_t)lwip_stats.mem.used;
+    stats->heap.max = (uint32_t)lwip_stats.mem.max;
+    stats->heap.err = (uint32_t)lwip_stats.mem.err;
+    stats->alloc_failures += stats->heap.err;
+#endif
+
+#if MEMP_STATS
+    for (int i = 0; i < MEMP_MAX && stats->pool_count < NET_STATS_MAX_POOLS; i++)
+    {
+        const struct stats_mem *memp = lwip_stats.memp[i];
+        if (memp == NULL)
+        {
+            continue;
+        }
+
+        net_pool_stats_t *pool = &stats->pools[stats->pool_count++];
+        pool->name = pool_names[i];
+        pool->avail = (uint32_t)memp->avail;
+        pool->used = (uint32_t)memp->used;
+        pool->max = (uint32_t)memp->max;
+        pool->err = (uint32_t)memp->err;
+        stats->alloc_failures += pool->err;
+    }
+#endif
+
+#if TCP_STATS
+    stats->tcp_xmit = lwip_stats.tcp.xmit;
+    stats->tcp_recv = lwip_stats.tcp.recv;
+    stats->tcp_drop = lwip_stats.tcp.drop;
+    stats->tcp_memerr = lwip_stats.tcp.memerr;
+    stats->tcp_err = lwip_stats.tcp.err;
+#endif
+
+#if LINK_STATS
+    stats->link_drop = lwip_stats.link.drop;
+    stats->link_memerr = lwip_stats.link.memerr;
+#endif
+}
+
+void net_stats_write_json(json_writer_t *w)
+{
+    net_stats_t stats;
+    net_stats_get(&stats);
+
+    json_begin_object(w);
+    json_kv_string(w, "type", "netstats");
+
+    json_key(w, "heap");
+    json_begin_object(w);
+    json_kv_uint(w, "avail", stats.heap.avail);
+    json_kv_uint(w, "used", stats.heap.used);
+    json_kv_uint(w, "max", stats.heap.max);
+    json_kv_uint(w, "err", stats.heap.err);
+    json_end_object(w);
+
+    json_key(w, "pools");
+    json_begin_array(w);
+    for (uint8_t i = 0; i < stats.pool_count; i++)
+    {
+        const net_pool_stats_t *pool = &stats.pools[i];
+        json_begin_object(w);
+        json_kv_string(w, "name", pool->name);
+        json_kv_uint(w, "avail", pool->avail);
+        json_kv_uint(w, "used", pool->used);
+        json_kv_uint(w, "max", pool->max);
+        json_kv_uint(w, "err", pool->err);
+        json_end_object(w);
+    }
+    json_end_array(w);
+
+    json_key(w, "tcp");
+    json_begin_object(w);
+    json_kv_uint(w, "xmit", stats.tcp_xmit);
+    json_kv_uint(w, "recv", stats.tcp_recv);
+    json_kv_uint(w, "drop", stats.tcp_drop);
+    json_kv_uint(w, "memerr", stats.tcp_memerr);
+    json_kv_uint(w, "err", stats.tcp_err);
+    json_end_object(w);
+
+    json_key(w, "link");
+    json_begin_object(w);
+    json_kv_uint(w, "drop", stats.link_drop);
+    json_kv_uint(w, "memerr", stats.link_memerr);
+    json_end_object(w);
+
+    json_kv_uint(w, "alloc_failures", stats.alloc_failures);
+    json_end_object(w);
+}
+
+size_t net_stats_format_json(char *buf, size_t size)
+{
+    json_writer_t w;
+    json_writer_init(&w, buf, size);
+    net_stats_write_json(&w);
+    return json_writer_finish(&w);
+}
+
+void net_stats_print(void)
+{
+    net_stats_t stats;
+    net_stats_get(&stats);
+
+    printf("[NET] %-14s %6s %6s %6s %6s\n", "pool", "avail", "used", "max", "err");
+    printf("[NET] %-14s %6lu %6lu %6lu %6lu\n", stats.heap.name,
+           (unsigned long)stats.heap.avail, (unsigned long)stats.heap.used,
+           (unsigned long)stats.heap.max, (unsigned long)stats.heap.err);
+
+    for (uint8_t i = 0; i < stats.pool_count; i++)
+    {
+        const net_pool_stats_t *pool = &stats.pools[i];
+        printf("[NET] %-14s %6lu %6lu %6lu %6lu%s\n", pool->name,
+               (unsigned long)pool->avail, (unsigned long)pool->used,
+               (unsigned long)pool->max, (unsigned long)pool->err,
+               pool->max >= pool->avail ? "  <- exhausted" : "");
+    }
+
+    printf("[NET] TCP xmit=%lu recv=%lu drop=%lu memerr=%lu  link drop=%lu memerr=%lu\n",
+           (unsigned long)stats.tcp_xmit, (unsigned long)stats.tcp_recv,
+           (unsigned long)stats.tcp_drop, (unsigned long)stats.tcp_memerr,
+           (unsigned long)stats.link_drop, (unsigned long)stats.link_memerr);
+}
@@ -0,0 +1,686 @@
+/**
+ * @file rig_commands.cpp
+ * @brief Rig command table, handlers and console front ends
+ *
+ * The table below is the only place a command name appears. It must stay
+ * sorted by name; the static_assert after it fails the build otherwise.
+ */
+
+#include "../include/rig_commands.h"
+#include "../include/wifi_manager.h"
+#include "../include/websocket_server.h"
+#include "../include/net_stats.h"
+#include "../include/udp_stream.h"
+#include "../include/sampler.h"
+#include "../include/telemetry.h"
+#include "../include/telnet_server.h"
+#include "../include/time_sync.h"
+#include "../include/display_mirror.h"
+#include "../include/board_config.h"
+#include "../ui/input_handler.h"
+#include "../system/safety_monitor.h"
+#include "../monitoring/diagnostics_engine.h"
+#include "../utils/hal_demo.h"
+#include "../utils/hal_test.h"
+#include "hal_interface.h"
+#include "command_registry.h"
+
+#include "pico/stdlib.h"
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define RIG_CONSOLE_LINE_MAX 160 // Longest UART command line
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static rig_command_hooks_t command_hooks = {};
+static char console_line[RIG_CONSOLE_LINE_MAX];
+static size_t console_len = 0;
+static bool console_overlong = false;
+
+static const uint32_t channel_enable_pins[NUM_DIAGNOSTIC_CHANNELS] = {
+    DIAG_CH1_ENABLE_PIN, DIAG_CH2_ENABLE_PIN, DIAG_CH3_ENABLE_PIN, DIAG_CH4_ENABLE_PIN};
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static void apply_channel(int channel, bool enable);
+static cmd_status_t reply_channels(cmd_context_t *ctx);
+
+static cmd_status_t cmd_disable_all_channels(cmd_context_t *ctx);
+static cmd_status_t cmd_disable_channel(cmd_context_t *ctx);
+static cmd_status_t cmd_display_mirror(cmd_context_t *ctx);
+static cmd_status_t cmd_emergency_stop(cmd_context_t *ctx);
+static cmd_status_t cmd_enable_all_channels(cmd_context_t *ctx);
+static cmd_status_t cmd_enable_channel(cmd_context_t *ctx);
+static cmd_status_t cmd_get_channels(cmd_context_t *ctx);
+static cmd_status_t cmd_get_netstats(cmd_context_t *ctx);
+static cmd_status_t cmd_get_status(cmd_context_t *ctx);
+static cmd_status_t cmd_get_telnet_stats(cmd_context_t *ctx);
+static cmd_status_t cmd_get_ws_stats(cmd_context_t *ctx);
+static cmd_status_t cmd_help(cmd_context_t *ctx);
+static cmd_status_t cmd_run_diagnostics(cmd_context_t *ctx);
+static cmd_status_t cmd_run_hal_demo(cmd_context_t *ctx);
+static cmd_status_t cmd_run_hal_test(cmd_context_t *ctx);
+static cmd_status_t cmd_set_channel(cmd_context_t *ctx);
+static cmd_status_t cmd_stream_start(cmd_context_t *ctx);
+static cmd_status_t cmd_stream_status(cmd_context_t *ctx);
+static cmd_status_t cmd_stream_stop(cmd_context_t *ctx);
+static cmd_status_t cmd_test_safety(cmd_context_t *ctx);
+static cmd_status_t cmd_time_status(cmd_context_t *ctx);
+static cmd_status_t cmd_time_sync(cmd_context_t *ctx);
+static cmd_status_t cmd_toggle_all_channels(cmd_context_t *ctx);
+static cmd_status_t cmd_toggle_channel(cmd_context_t *ctx);
+static cmd_status_t cmd_wifi_connect(cmd_context_t *ctx);
+static cmd_status_t cmd_wifi_disconnect(cmd_context_t *ctx);
+static cmd_status_t cmd_wifi_status(cmd_context_t *ctx);
+
+// =============================================================================
+// COMMAND TABLE
+// =============================================================================
+
+static constexpr cmd_arg_spec_t channel_args[] = {
+    {"channel", CMD_ARG_INT, true, 1, NUM_DIAGNOSTIC_CHANNELS},
+};
+
+static constexpr cmd_arg_spec_t display_mirror_args[] = {
+    {"enabled", CMD_ARG_BOOL, true, 0, 0},
+};
+
+static constexpr cmd_arg_spec_t set_channel_args[] = {
+    {"channel", CMD_ARG_INT, true, 1, NUM_DIAGNOSTIC_CHANNELS},
+    {"enabled", CMD_ARG_BOOL, true, 0, 0},
+};
+
+// "dest" may carry the port as ip:port, so the rate is the second positional argument
+static constexpr cmd_arg_spec_t stream_start_args[] = {
+    {"dest", CMD_ARG_STRING, true, 0, 21},
+    {"rate", CMD_ARG_INT, false, 1, SAMPLER_MAX_RATE_HZ},
+    {"port", CMD_ARG_INT, false, 1, 65535},
+};
+
+// "server" may carry the port as name:port
+static constexpr cmd_arg_spec_t time_sync_args[] = {
+    {"server", CMD_ARG_STRING, true, 0, CMD_STRING_ARG_MAX - 1},
+    {"interval", CMD_ARG_INT, false, 16, 86400},
+};
+
+static constexpr cmd_arg_spec_t wifi_connect_args[] = {
+    {"ssid", CMD_ARG_STRING, true, 0, WIFI_SSID_MAX_LENGTH - 1},
+    {"password", CMD_ARG_STRING, false, 0, CMD_STRING_ARG_MAX - 1},
+};
+
+#define RIG_COMMAND(name, handler, args, help) {name, handler, args, sizeof(args) / sizeof(args[0]), help}
+#define RIG_COMMAND_NOARGS(name, handler, help) {name, handler, nullptr, 0, help}
+
+static constexpr cmd_def_t command_table[] = {
+    RIG_COMMAND_NOARGS("DISABLE_ALL_CHANNELS", cmd_disable_all_channels, "Switch every channel off"),
+    RIG_COMMAND("DISABLE_CHANNEL", cmd_disable_channel, channel_args, "<channel>"),
+    RIG_COMMAND("DISPLAY_MIRROR", cmd_display_mirror, display_mirror_args, "<enabled>"),
+    RIG_COMMAND_NOARGS("EMERGENCY_STOP", cmd_emergency_stop, "Disable all outputs and stop the main loop"),
+    RIG_COMMAND_NOARGS("ENABLE_ALL_CHANNELS", cmd_enable_all_channels, "Switch every channel on"),
+    RIG_COMMAND("ENABLE_CHANNEL", cmd_enable_channel, channel_args, "<channel>"),
+    RIG_COMMAND_NOARGS("GET_CHANNELS", cmd_get_channels, "Channel states; resends readings"),
+    RIG_COMMAND_NOARGS("GET_NETSTATS", cmd_get_netstats, "lwIP pool and protocol counters"),
+    RIG_COMMAND_NOARGS("GET_STATUS", cmd_get_status, "System summary; resends full telemetry"),
+    RIG_COMMAND_NOARGS("GET_TELNET_STATS", cmd_get_telnet_stats, "Console session and log counters"),
+    RIG_COMMAND_NOARGS("GET_WS_STATS", cmd_get_ws_stats, "WebSocket slot counters"),
+    RIG_COMMAND_NOARGS("HELP", cmd_help, "List commands"),
+    RIG_COMMAND_NOARGS("RUN_DIAGNOSTICS", cmd_run_diagnostics, "Test the enabled channels"),
+    RIG_COMMAND_NOARGS("RUN_HAL_DEMO", cmd_run_hal_demo, "Run the HAL demonstration"),
+    RIG_COMMAND_NOARGS("RUN_HAL_TEST", cmd_run_hal_test, "Test every HAL subsystem"),
+    RIG_COMMAND("SET_CHANNEL", cmd_set_channel, set_channel_args, "<channel> <enabled>"),
+    RIG_COMMAND("STREAM_START", cmd_stream_start, stream_start_args, "<ip>[:port] [rate] [port=]"),
+    RIG_COMMAND_NOARGS("STREAM_STATUS", cmd_stream_status, "UDP stream counters"),
+    RIG_COMMAND_NOARGS("STREAM_STOP", cmd_stream_stop, "Stop the UDP stream"),
+    RIG_COMMAND_NOARGS("TEST_SAFETY", cmd_test_safety, "Run the safety monitor self test"),
+    RIG_COMMAND_NOARGS("TIME_STATUS", cmd_time_status, "Clock sync state and counters"),
+    RIG_COMMAND("TIME_SYNC", cmd_time_sync, time_sync_args, "<server>[:port] [interval]"),
+    RIG_COMMAND_NOARGS("TOGGLE_ALL_CHANNELS", cmd_toggle_all_channels, "Invert every channel"),
+    RIG_COMMAND("TOGGLE_CHANNEL", cmd_toggle_channel, channel_args, "<channel>"),
+    RIG_COMMAND("WIFI_CONNECT", cmd_wifi_connect, wifi_connect_args, "<ssid> [password]"),
+    RIG_COMMAND_NOARGS("WIFI_DISCONNECT", cmd_wifi_disconnect, "Leave the network"),
+    RIG_COMMAND_NOARGS("WIFI_STATUS", cmd_wifi_status, "Connection state, IP and RSSI"),
+};
+
+static_assert(command_table_is_sorted(command_table), "command_table must be sorted by name");
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+void rig_commands_init(const rig_command_hooks_t *hooks)
+{
+    if (hooks)
+    {
+        command_hooks = *hooks;
+    }
+
+    command_registry_init(command_table, sizeof(command_table) / sizeof(command_table[0]));
+    console_len = 0;
+    console_overlong = false;
+
+    printf("[CMD] %u commands registered\n", (unsigned)(sizeof(command_table) / sizeof(command_table[0])));
+}
+
+bool rig_commands_websocket_message(int client_id, const char *text, size_t len)
+{
+    // The reply is written behind the frame header room, in the client's encoding
+    static uint8_t reply[WEBSOCKET_FRAME_HEADROOM + CMD_REPLY_MAX];
+    (void)len; // text is NUL terminated by the server
+
+    json_format_t format = websocket_client_format(client_id);
+    size_t reply_len = command_execute_json(text, CMD_SOURCE_WEBSOCKET, client_id, format,
+                                            (char *)reply + WEBSOCKET_FRAME_HEADROOM, CMD_REPLY_MAX);
+    if (reply_len == 0)
+    {
+        return false;
+    }
+
+    websocket_send_prepared(client_id, reply, reply_len, format);
+    return true;
+}
+
+void rig_commands_poll_uart(void)
+{
+    // Drain whatever stdio has buffered; never waits for more
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT)
+    {
+        if (c == '\r' || c == '\n')
+        {
+            if (console_overlong)
+            {
+                printf("ERR - line longer than %d characters\n", RIG_CONSOLE_LINE_MAX - 1);
+            }
+            else if (console_len > 0)
+            {
+                console_line[console_len] = '\0';
+                process_uart_command(0, console_line);
+            }
+            console_len = 0;
+            console_overlong = false;
+        }
+        else if (c == '\b' || c == 0x7F)
+        {
+            if (console_len > 0)
+            {
+                console_len--;
+            }
+        }
+        else if (console_len + 1 < sizeof(console_line))
+        {
+            console_line[console_len++] = (char)c;
+        }
+        else
+        {
+            console_overlong = true;
+        }
+    }
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static void apply_channel(int channel, bool enable)
+{
+    // The engine tracks the state; the enable pin is what telemetry reads back
+    set_channel_enable(channel, enable);
+    hal_gpio_write(channel_enable_pins[channel - 1], enable ? GPIO_HIGH : GPIO_LOW);
+}
+
+static cmd_status_t reply_channels(cmd_context_t *ctx)
+{
+    bool states[NUM_DIAGNOSTIC_CHANNELS];
+    get_channel_states(states);
+
+    json_begin_object(ctx->json);
+    json_key(ctx->json, "channels");
+    json_begin_array(ctx->json);
+    for (int i = 0; i < NUM_DIAGNOSTIC_CHANNELS; i++)
+    {
+        json_bool(ctx->json, states[i]);
+    }
+    json_end_array(ctx->json);
+    json_end_object(ctx->json);
+
+    if (command_hooks.publish_channels)
+    {
+        command_hooks.publish_channels();
+    }
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_disable_all_channels(cmd_context_t *ctx)
+{
+    for (int channel = 1; channel <= NUM_DIAGNOSTIC_CHANNELS; channel++)
+    {
+        apply_channel(channel, false);
+    }
+    return reply_channels(ctx);
+}
+
+static cmd_status_t cmd_disable_channel(cmd_context_t *ctx)
+{
+    apply_channel(ctx->args[0].i, false);
+    return reply_channels(ctx);
+}
+
+static cmd_status_t cmd_display_mirror(cmd_context_t *ctx)
+{
+#if WEB_DISPLAY_ENABLED && WEB_DISPLAY_WEBSOCKET
+    // The frames go to the connection that asked, so only a WebSocket can
+    if (ctx->source != CMD_SOURCE_WEBSOCKET)
+    {
+        return cmd_error(ctx, CMD_ERR_UNAVAILABLE, "the display mirror needs a WebSocket connection");
+    }
+    if (!display_mirror_set_viewer(ctx->client_id, ctx->args[0].b))
+    {
+        return cmd_error(ctx, CMD_ERR_FAILED, "could not start the display mirror");
+    }
+
+    display_mirror_stats_t stats;
+    display_mirror_get_stats(&stats);
+
+    json_writer_t *w = ctx->json;
+    json_begin_object(w);
+    json_kv_bool(w, "enabled", ctx->args[0].b);
+    json_kv_uint(w, "width", DISPLAY_WIDTH);
+    json_kv_uint(w, "height", DISPLAY_HEIGHT);
+    json_kv_uint(w, "viewers", stats.viewers);
+    json_kv_uint(w, "messages", stats.messages);
+    json_kv_uint(w, "bytes", stats.bytes);
+    json_kv_uint(w, "pixels", stats.pixels);
+    json_kv_uint(w, "sendFailures", stats.send_failures);
+    json_kv_uint(w, "resyncs", stats.resyncs);
+    json_end_object(w);
+    return CMD_OK;
+#else
+    return cmd_error(ctx, CMD_ERR_UNAVAILABLE, "the display mirror is disabled in this build");
+#endif
+}
+
+static cmd_status_t cmd_emergency_stop(cmd_context_t *ctx)
+{
+    if (command_hooks.emergency_stop)
+    {
+        command_hooks.emergency_stop();
+    }
+    else
+    {
+        emergency_shutdown("Emergency stop command");
+    }
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_enable_all_channels(cmd_context_t *ctx)
+{
+    if (is_emergency_state())
+    {
+        return cmd_error(ctx, CMD_ERR_UNAVAILABLE, "emergency stop is active");
+    }
+    for (int channel = 1; channel <= NUM_DIAGNOSTIC_CHANNELS; channel++)
+    {
+        apply_channel(channel, true);
+    }
+    return reply_channels(ctx);
+}
+
+static cmd_status_t cmd_enable_channel(cmd_context_t *ctx)
+{
+    if (is_emergency_state())
+    {
+        return cmd_error(ctx, CMD_ERR_UNAVAILABLE, "emergency stop is active");
+    }
+    apply_channel(ctx->args[0].i, true);
+    return reply_channels(ctx);
+}
+
+static cmd_status_t cmd_get_channels(cmd_context_t *ctx)
+{
+    if (ctx->source == CMD_SOURCE_WEBSOCKET)
+    {
+        telemetry_reset_client(ctx->client_id);
+    }
+    return reply_channels(ctx);
+}
+
+static cmd_status_t cmd_get_netstats(cmd_context_t *ctx)
+{
+    net_stats_write_json(ctx->json);
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_get_status(cmd_context_t *ctx)
+{
+    // Explicit requests always get the full state
+    if (ctx->source == CMD_SOURCE_WEBSOCKET)
+    {
+        telemetry_reset_client(ctx->client_id);
+    }
+    if (command_hooks.publish_status)
+    {
+        command_hooks.publish_status();
+    }
+    if (command_hooks.publish_channels)
+    {
+        command_hooks.publish_channels();
+    }
+
+    json_begin_object(ctx->json);
+    json_kv_uint(ctx->json, "uptimeMs", hal_get_tick_ms());
+    json_kv_string(ctx->json, "wifi", wifi_state_name(wifi_get_state()));
+    json_kv_bool(ctx->json, "emergency", is_emergency_state());
+    json_kv_bool(ctx->json, "streaming", udp_stream_is_active());
+    json_end_object(ctx->json);
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_get_telnet_stats(cmd_context_t *ctx)
+{
+    telnet_server_stats_t stats;
+    telnet_server_get_stats(&stats);
+
+    json_writer_t *w = ctx->json;
+    json_begin_object(w);
+    json_kv_uint(w, "sessions", stats.sessions_total);
+    json_kv_uint(w, "inUse", stats.sessions_in_use);
+    json_kv_uint(w, "accepted", stats.connections_accepted);
+    json_kv_uint(w, "rejected", stats.connections_rejected);
+    json_kv_uint(w, "commands", stats.commands_executed);
+    json_kv_uint(w, "logSent", stats.log_bytes_sent);
+    json_kv_uint(w, "logDropped", stats.log_bytes_dropped);
+    json_end_object(w);
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_get_ws_stats(cmd_context_t *ctx)
+{
+    websocket_server_stats_t stats;
+    websocket_server_get_stats(&stats);
+
+    json_writer_t *w = ctx->json;
+    json_begin_object(w);
+    json_kv_uint(w, "slots", stats.slots_total);
+    json_kv_uint(w, "inUse", stats.slots_in_use);
+    json_kv_uint(w, "ready", stats.slots_ready);
+    json_kv_uint(w, "cbor", stats.slots_cbor);
+    json_kv_uint(w, "peak", stats.peak_in_use);
+    json_kv_uint(w, "accepted", stats.connections_accepted);
+    json_kv_uint(w, "rejected", stats.connections_rejected);
+    json_kv_uint(w, "reclaimed", stats.slots_reclaimed);
+    json_kv_uint(w, "evicted", stats.idle_evictions);
+    json_kv_uint(w, "handshakeTimeouts", stats.handshake_timeouts);
+    json_kv_uint(w, "rttMs", stats.last_rtt_ms);
+    json_kv_uint(w, "protocolErrors", stats.protocol_errors);
+    json_kv_uint(w, "framesDropped", stats.frames_dropped);
+    json_kv_uint(w, "deflate", stats.slots_deflate);
+    json_kv_uint(w, "deflateIn", stats.deflate_bytes_in);
+    json_kv_uint(w, "deflateOut", stats.deflate_bytes_out);
+    json_end_object(w);
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_help(cmd_context_t *ctx)
+{
+    size_t count;
+    const cmd_def_t *table = command_registry_table(&count);
+
+    json_begin_array(ctx->json);
+    for (size_t i = 0; i < count; i++)
+    {
+        json_begin_object(ctx->json);
+        json_kv_string(ctx->json, "name", table[i].name);
+        json_kv_string(ctx->json, "help", table[i].help);
+        json_end_object(ctx->json);
+    }
+    json_end_array(ctx->json);
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_run_diagnostics(cmd_context_t *ctx)
+{
+    test_diagnostic_channels();
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_run_hal_demo(cmd_context_t *ctx)
+{
+    run_hal_demo();
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_run_hal_test(cmd_context_t *ctx)
+{
+    bool passed = test_hal_subsystems();
+    json_begin_object(ctx->json);
+    json_kv_bool(ctx->json, "passed", passed);
+    json_end_object(ctx->json);
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_set_channel(cmd_context_t *ctx)
+{
+    if (ctx->args[1].b && is_emergency_state())
+    {
+        return cmd_error(ctx, CMD_ERR_UNAVAILABLE, "emergency stop is active");
+    }
+    apply_channel(ctx->args[0].i, ctx->args[1].b);
+    return reply_channels(ctx);
+}
+
+static cmd_status_t cmd_stream_start(cmd_context_t *ctx)
+{
+#if UDP_STREAM_ENABLED
+    char destination[16];
+    long port = ctx->args[2].present ? ctx->args[2].i : UDP_STREAM_DEFAULT_PORT;
+    uint32_t rate = ctx->args[1].present ? (uint32_t)ctx->args[1].i : CHANNEL_SAMPLE_RATE_HZ;
+
+    // dest is "ip" or "ip:port"
+    const char *colon = strchr(ctx->args[0].s, ':');
+    size_t ip_len = colon ? (size_t)(colon - ctx->args[0].s) : strlen(ctx->args[0].s);
+    if (ip_len == 0 || ip_len >= sizeof(destination))
+    {
+        return cmd_error(ctx, CMD_ERR_ARGS, "'dest' must be an IPv4 address");
+    }
+    memcpy(destination, ctx->args[0].s, ip_len);
+    destination[ip_len] = '\0';
+
+    if (colon)
+    {
+        char *end;
+        port = strtol(colon + 1, &end, 10);
+        if (*end != '\0' || port < 1 || port > 65535)
+        {
+            return cmd_error(ctx, CMD_ERR_ARGS, "'dest' port must be 1..65535");
+        }
+    }
+
+    if (!udp_stream_start(destination, (uint16_t)port, rate))
+    {
+        return cmd_error(ctx, CMD_ERR_FAILED, "could not start the UDP stream");
+    }
+    return cmd_stream_status(ctx);
+#else
+    return cmd_error(ctx, CMD_ERR_UNAVAILABLE, "UDP streaming is disabled in this build");
+#endif
+}
+
+static cmd_status_t cmd_stream_status(cmd_context_t *ctx)
+{
+    udp_stream_stats_t stats;
+    udp_stream_get_stats(&stats);
+
+    char dest[sizeof(stats.destination) + 6];
+    snprintf(dest, sizeof(dest), "%s:%u", stats.destination, stats.port);
+
+    json_writer_t *w = ctx->json;
+    json_begin_object(w);
+    json_kv_bool(w, "active", stats.active);
+    json_kv_string(w, "dest", dest);
+    json_kv_uint(w, "rateHz", stats.rate_hz);
+    json_kv_uint(w, "datagrams", stats.datagrams_sent);
+    json_kv_uint(w, "frames", stats.frames_sent);
+    json_kv_uint(w, "sendErrors", stats.send_errors);
+    json_kv_uint(w, "allocFailures", stats.alloc_failures);
+    json_kv_uint(w, "samplerDropped", stats.sampler_dropped);
+    json_end_object(w);
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_stream_stop(cmd_context_t *ctx)
+{
+    udp_stream_stop();
+    return cmd_stream_status(ctx);
+}
+
+static cmd_status_t cmd_test_safety(cmd_context_t *ctx)
+{
+    bool passed = test_safety_monitoring();
+    json_begin_object(ctx->json);
+    json_kv_bool(ctx->json, "passed", passed);
+    json_end_object(ctx->json);
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_time_status(cmd_context_t *ctx)
+{
+    time_sync_stats_t stats;
+    time_sync_get_stats(&stats);
+
+    uint64_t boot_us = hal_get_time_us();
+    uint64_t now_us = time_sync_to_host_us(boot_us, NULL);
+
+    char server[sizeof(stats.server) + 6];
+    snprintf(server, sizeof(server), "%s:%u", stats.server, stats.port);
+
+    json_writer_t *w = ctx->json;
+    json_begin_object(w);
+    json_kv_bool(w, "running", stats.running);
+    json_kv_bool(w, "synced", stats.synced);
+    json_kv_string(w, "server", stats.port ? server : "");
+    json_key(w, "bootUs");
+    json_uint64(w, boot_us);
+    json_key(w, "nowUs"); // Unix microseconds once synced
+    json_uint64(w, now_us);
+    json_kv_int(w, "driftPpb", stats.drift_ppb);
+    json_kv_int(w, "errorUs", stats.last_error_us);
+    json_kv_uint(w, "delayUs", stats.delay_us);
+    json_kv_uint(w, "requests", stats.requests_sent);
+    json_kv_uint(w, "replies", stats.replies);
+    json_kv_uint(w, "invalid", stats.invalid);
+    json_kv_uint(w, "timeouts", stats.timeouts);
+    json_kv_uint(w, "dnsFailures", stats.dns_failures);
+    json_kv_uint(w, "steps", stats.steps);
+    json_end_object(w);
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_time_sync(cmd_context_t *ctx)
+{
+    char server[TIME_SYNC_SERVER_MAX];
+    long port = TIME_SYNC_PORT;
+    uint32_t interval = ctx->args[1].present ? (uint32_t)ctx->args[1].i : TIME_SYNC_INTERVAL_S;
+
+    // server is "name" or "name:port"
+    const char *colon = strchr(ctx->args[0].s, ':');
+    size_t name_len = colon ? (size_t)(colon - ctx->args[0].s) : strlen(ctx->args[0].s);
+    if (name_len == 0 || name_len >= sizeof(server))
+    {
+        return cmd_error(ctx, CMD_ERR_ARGS, "'server' must be a host name or IPv4 address");
+    }
+    memcpy(server, ctx->args[0].s, name_len);
+    server[name_len] = '\0';
+
+    if (colon)
+    {
+        char *end;
+        port = strtol(colon + 1, &end, 10);
+        if (*end != '\0' || port < 1 || port > 65535)
+        {
+            return cmd_error(ctx, CMD_ERR_ARGS, "'server' port must be 1..65535");
+        }
+    }
+
+    if (!time_sync_start(server, (uint16_t)port, interval))
+    {
+        return cmd_error(ctx, CMD_ERR_FAILED, "could not start time sync");
+    }
+    return cmd_time_status(ctx);
+}
+
+static cmd_status_t cmd_toggle_all_channels(cmd_context_t *ctx)
+{
+    bool states[NUM_DIAGNOSTIC_CHANNELS];
+    get_channel_states(states);
+
+    for (int channel = 1; channel <= NUM_DIAGNOSTIC_CHANNELS; channel++)
+    {
+        bool enable = !states[channel - 1];
+        apply_channel(channel, enable && !is_emergency_state());
+    }
+    return reply_channels(ctx);
+}
+
+static cmd_status_t cmd_toggle_channel(cmd_context_t *ctx)
+{
+    bool states[NUM_DIAGNOSTIC_CHANNELS];
+    get_channel_states(states);
+
+    bool enable = !states[ctx->args[0].i - 1];
+    if (enable && is_emergency_state())
+    {
+        return cmd_error(ctx, CMD_ERR_UNAVAILABLE, "emergency stop is active");
+    }
+    apply_channel(ctx->args[0].i, enable);
+    return reply_channels(ctx);
+}
+
+static cmd_status_t cmd_wifi_connect(cmd_context_t *ctx)
+{
+    // An absent password joins an open network
+    if (!wifi_connect(ctx->args[0].s, ctx->args[1].present ? ctx->args[1].s : ""))
+    {
+        return cmd_error(ctx, CMD_ERR_FAILED, "could not start joining '%s'", ctx->args[0].s);
+    }
+    return cmd_wifi_status(ctx);
+}
+
+static cmd_status_t cmd_wifi_disconnect(cmd_context_t *ctx)
+{
+    wifi_disconnect();
+    return cmd_wifi_status(ctx);
+}
+
+static cmd_status_t cmd_wifi_status(cmd_context_t *ctx)
+{
+    wifi_state_t state = wifi_get_state();
+
+    // The SSID is user supplied and may need escaping
+    json_writer_t *w = ctx->json;
+    json_begin_object(w);
+    json_kv_string(w, "state", wifi_state_name(state));
+    json_kv_string(w, "ssid", wifi_get_ssid());
+    json_kv_uint(w, "attempts", wifi_get_attempts());
+    if (state == WIFI_STATE_CONNECTED)
+    {
+        json_kv_string(w, "ip", wifi_get_ip_address());
+        json_kv_int(w, "rssi", wifi_get_rssi());
+    }
+    else if (state == WIFI_STATE_BACKOFF)
+    {
+        json_kv_uint(w, "retryMs", wifi_get_retry_delay_ms());
+    }
+    json_end_object(w);
+    return CMD_OK;
+}
@@ -0,0 +1,222 @@
+/**
+ * @file sampler.cpp
+ * @brief Timer-driven ADC acquisition implementation
+ *
+ * The timer callback runs in interrupt context on the core that started the
+ * sampler and is the only writer of ring_head; the main loop is the only
+ * writer of ring_tail. Both are free-running counters, so fill level is a
+ * plain subtraction and no lock is needed.
+ */
+
+#include "../include/sampler.h"
+#include "../include/board_config.h"
+#include "hal_interface.h"
+
+#include "pico/stdlib.h"
+
+#include <cstring>
+#include <cstdio>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define SAMPLER_RING_MASK (SAMPLER_RING_FRAMES - 1)
+
+static_assert((SAMPLER_RING_FRAMES & SAMPLER_RING_MASK) == 0, "SAMPLER_RING_FRAMES must be a power of two");
+
+static const uint8_t sampler_adc_inputs[SAMPLER_CHANNELS] = {
+    ADC_CH1_VOLTAGE, ADC_CH2_VOLTAGE, ADC_CH3_CURRENT};
+
+// =============================================================================
+// PRIVATE TYPES
+// =============================================================================
+
+typedef struct
+{
+    uint32_t index;
+    uint16_t samples[SAMPLER_CHANNELS];
+} sampler_frame_t;
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static sampler_frame_t ring[SAMPLER_RING_FRAMES];
+static volatile uint32_t ring_head = 0; // Written by the timer callback only
+static volatile uint32_t ring_tail = 0; // Written by sampler_read() only
+static volatile uint32_t next_index = 0;
+static volatile uint32_t frames_dropped = 0;
+static volatile uint32_t ring_peak = 0;
+
+static struct repeating_timer sample_timer;
+static bool sampler_running = false;
+static uint32_t sample_rate_hz = 0;
+static uint64_t start_time_us = 0;
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static bool sample_tick(struct repeating_timer *timer);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+bool sampler_start(uint32_t rate_hz)
+{
+    if (rate_hz == 0 || rate_hz > SAMPLER_MAX_RATE_HZ)
+    {
+        printf("[SAMPLER] Invalid sample rate %lu Hz\n", (unsigned long)rate_hz);
+        return false;
+    }
+
+    if (sampler_running)
+    {
+        if (rate_hz == sample_rate_hz)
+        {
+            return true;
+        }
+        sampler_stop();
+    }
+
+    ring_head = 0;
+    ring_tail = 0;
+    next_index = 0;
+    frames_dropped = 0;
+    ring_peak = 0;
+    sample_rate_hz = rate_hz;
+    start_time_us = hal_get_time_us();
+
+    // A negative period schedules each tick from the previous one's start,
+    // so callback latency does not accumulate into the sample clock
+    int64_t period_us = (int64_t)(1000000u / rate_hz);
+    if (!add_repeating_timer_us(-period_us, sample_tick, NULL, &sample_timer))
+    {
+        printf("[SAMPLER] No alarm slot available\n");
+        return false;
+    }
+
+    sampler_running = true;
+    printf("[SAMPLER] Sampling %d channels at %lu Hz\n", SAMPLER_CHANNELS, (unsigned long)rate_hz);
+    return true;
+}
+
+void sampler_stop(void)
+{
+    if (!sampler_running)
+    {
+        return;
+    }
+
+    cancel_repeating_timer(&sample_timer);
+    sampler_running = false;
+    ring_tail = ring_head;
+    printf("[SAMPLER] Stopped after %lu frames (%lu dropped)\n",
+           (unsigned long)next_index, (unsigned long)frames_dropped);
+}
+
+bool sampler_is_running(void)
+{
+    return sampler_running;
+}
+
+size_t sampler_read(uint16_t *samples, size_t max_frames, uint32_t *first_index)
+{
+    uint32_t tail = ring_tail;
+    uint32_t available = ring_head - tail;
+    size_t count = 0;
+
+    __compiler_memory_barrier();
+
+    if (available > max_frames)
+    {
+        available = (uint32_t)max_frames;
+    }
+
+    for (; count < available; count++)
+    {
+        const sampler_frame_t *frame = &ring[(tail + count) & SAMPLER_RING_MASK];
+
+        if (count == 0)
+        {
+            if (first_index)
+            {
+                *first_index = frame->index;
+            }
+        }
+        else if (frame->index != ring[(tail + count - 1) & SAMPLER_RING_MASK].index + 1)
+        {
+            break; // Frames were dropped here; hand over the run before the gap
+        }
+
+        memcpy(&samples[count * SAMPLER_CHANNELS], frame->samples, sizeof(frame->samples));
+    }
+
+    // Release the slots only after they have been copied out
+    __compiler_memory_barrier();
+    ring_tail = tail + (uint32_t)count;
+    return count;
+}
+
+uint64_t sampler_frame_time_us(uint32_t index)
+{
+    if (sample_rate_hz == 0)
+    {
+        return start_time_us;
+    }
+
+    return start_time_us + ((uint64_t)index * 1000000u) / sample_rate_hz;
+}
+
+void sampler_get_stats(sampler_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    stats->running = sampler_running;
+    stats->rate_hz = sample_rate_hz;
+    stats->frames_captured = next_index;
+    stats->frames_dropped = frames_dropped;
+    stats->ring_peak = ring_peak;
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static bool sample_tick(struct repeating_timer *timer)
+{
+    uint32_t head = ring_head;
+    uint32_t index = next_index;
+    next_index = index + 1;
+
+    uint32_t fill = head - ring_tail;
+    if (fill >= SAMPLER_RING_FRAMES)
+    {
+        frames_dropped = frames_dropped + 1;
+        return true;
+    }
+
+    sampler_frame_t *frame = &ring[head & SAMPLER_RING_MASK];
+    frame->index = index;
+    for (int ch = 0; ch < SAMPLER_CHANNELS; ch++)
+    {
+        uint16_t value = 0;
+        hal_adc_read(sampler_adc_inputs[ch], &value);
+        frame->samples[ch] = value;
+    }
+
+    // Publish the frame only after it is complete
+    __compiler_memory_barrier();
+    ring_head = head + 1;
+
+    if (fill + 1 > ring_peak)
+    {
+        ring_peak = fill + 1;
+    }
+    return true;
+}
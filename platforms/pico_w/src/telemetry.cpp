@@ -0,0 +1,315 @@
+/**
+ * @file telemetry.cpp
+ * @brief Change-only telemetry publisher implementation
+ *
+ * Every client gets its own copy of the last values it was sent, so a client
+ * that connects later (or dropped a frame) is never left with stale deltas.
+ * Fields are compared against what that client last saw, not against the
+ * previous reading, so slow drift is reported once it crosses the deadband.
+ */
+
+#include "../include/telemetry.h"
+#include "../include/websocket_server.h"
+#include "../include/board_config.h"
+#include "json_writer.h"
+
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define TELEMETRY_MSG_SIZE 192
+
+// =============================================================================
+// PRIVATE TYPES
+// =============================================================================
+
+typedef struct
+{
+    bool channels_valid;
+    bool status_valid;
+    uint32_t last_channel_keyframe_ms;
+    uint32_t last_status_keyframe_ms;
+    telemetry_channel_t channels[NUM_DIAGNOSTIC_CHANNELS];
+    telemetry_status_t status;
+} telemetry_client_state_t;
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static telemetry_config_t telemetry_config = {
+    TELEMETRY_VOLTAGE_DEADBAND_V,
+    TELEMETRY_CURRENT_DEADBAND_A,
+    TELEMETRY_RSSI_DEADBAND_DBM,
+    TELEMETRY_KEYFRAME_INTERVAL_MS,
+};
+static telemetry_client_state_t client_state[WEBSOCKET_MAX_CLIENTS];
+static telemetry_stats_t telemetry_stats = {};
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static bool keyframe_due(bool valid, uint32_t last_keyframe_ms, uint32_t now_ms);
+static void begin_message(json_writer_t *w, uint8_t *frame, int client_id);
+static bool send_to_client(int client_id, json_writer_t *w, uint8_t *frame, uint32_t fields);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+void telemetry_init(const telemetry_config_t *config)
+{
+    if (config)
+    {
+        telemetry_config = *config;
+    }
+
+    memset(client_state, 0, sizeof(client_state));
+    memset(&telemetry_stats, 0, sizeof(telemetry_stats));
+
+    printf("[TELEMETRY] Change-only publisher ready (dV=%.3f V, dI=%.4f A, keyframe=%lu ms)\n",
+           telemetry_config.voltage_deadband, telemetry_config.current_deadband,
+           (unsigned long)telemetry_config.keyframe_interval_ms);
+}
+
+void telemetry_set_config(const telemetry_config_t *config)
+{
+    if (config)
+    {
+        telemetry_config = *config;
+        telemetry_request_keyframe();
+    }
+}
+
+void telemetry_get_config(telemetry_config_t *config)
+{
+    if (config)
+    {
+        *config = telemetry_config;
+    }
+}
+
+void telemetry_reset_client(int client_id)
+{
+    if (client_id >= 0 && client_id < WEBSOCKET_MAX_CLIENTS)
+    {
+        memset(&client_state[client_id], 0, sizeof(client_state[client_id]));
+    }
+}
+
+void telemetry_request_keyframe(void)
+{
+    for (int i = 0; i < WEBSOCKET_MAX_CLIENTS; i++)
+    {
+        client_state[i].channels_valid = false;
+        client_state[i].status_valid = false;
+    }
+}
+
+void telemetry_publish_channels(const telemetry_channel_t *channels, uint32_t now_ms)
+{
+    if (channels == NULL)
+    {
+        return;
+    }
+
+    uint8_t frame[WEBSOCKET_FRAME_HEADROOM + TELEMETRY_MSG_SIZE];
+    json_writer_t w;
+
+    for (int client = 0; client < WEBSOCKET_MAX_CLIENTS; client++)
+    {
+        if (!websocket_client_is_ready(client))
+        {
+            continue;
+        }
+
+        telemetry_client_state_t *state = &client_state[client];
+        bool keyframe = keyframe_due(state->channels_valid, state->last_channel_keyframe_ms, now_ms);
+        bool delivered = true;
+
+        for (int ch = 0; ch < NUM_DIAGNOSTIC_CHANNELS; ch++)
+        {
+            const telemetry_channel_t *now = &channels[ch];
+            telemetry_channel_t *sent = &state->channels[ch];
+
+            bool enabled_changed = keyframe || now->enabled != sent->enabled;
+            bool voltage_changed = keyframe || fabsf(now->voltage - sent->voltage) > telemetry_config.voltage_deadband;
+            bool current_changed = keyframe || fabsf(now->current - sent->current) > telemetry_config.current_deadband;
+            uint32_t fields = (uint32_t)enabled_changed + (uint32_t)voltage_changed + (uint32_t)current_changed;
+
+            telemetry_stats.fields_suppressed += 3 - fields;
+            if (fields == 0)
+            {
+                continue;
+            }
+
+            begin_message(&w, frame, client);
+            json_kv_string(&w, "type", "channel_data");
+            json_kv_int(&w, "channel", ch + 1);
+            if (enabled_changed)
+            {
+                json_kv_bool(&w, "enabled", now->enabled);
+            }
+            if (voltage_changed)
+            {
+                json_kv_float(&w, "voltage", now->voltage, 2);
+            }
+            if (current_changed)
+            {
+                json_kv_float(&w, "current", now->current, 3);
+            }
+            if (keyframe)
+            {
+                json_kv_bool(&w, "keyframe", true);
+            }
+            json_end_object(&w);
+
+            if (!send_to_client(client, &w, frame, fields))
+            {
+                // Leave the cached value alone so the field is retried next period
+                delivered = false;
+                continue;
+            }
+
+            if (enabled_changed)
+                sent->enabled = now->enabled;
+            if (voltage_changed)
+                sent->voltage = now->voltage;
+            if (current_changed)
+                sent->current = now->current;
+        }
+
+        if (keyframe && delivered)
+        {
+            state->channels_valid = true;
+            state->last_channel_keyframe_ms = now_ms;
+            telemetry_stats.keyframes_sent++;
+        }
+    }
+}
+
+void telemetry_publish_status(const telemetry_status_t *status, uint32_t now_ms)
+{
+    if (status == NULL)
+    {
+        return;
+    }
+
+    uint8_t frame[WEBSOCKET_FRAME_HEADROOM + TELEMETRY_MSG_SIZE];
+    json_writer_t w;
+
+    for (int client = 0; client < WEBSOCKET_MAX_CLIENTS; client++)
+    {
+        if (!websocket_client_is_ready(client))
+        {
+            continue;
+        }
+
+        telemetry_client_state_t *state = &client_state[client];
+        telemetry_status_t *sent = &state->status;
+        bool keyframe = keyframe_due(state->status_valid, state->last_status_keyframe_ms, now_ms);
+
+        bool wifi_changed = keyframe || status->wifi_connected != sent->wifi_connected;
+        int32_t rssi_delta = status->rssi - sent->rssi;
+        bool rssi_changed = keyframe || rssi_delta > telemetry_config.rssi_deadband ||
+                            -rssi_delta > telemetry_config.rssi_deadband;
+        uint32_t fields = (uint32_t)wifi_changed + (uint32_t)rssi_changed + (keyframe ? 2 : 0);
+
+        telemetry_stats.fields_suppressed += 4 - fields;
+        if (fields == 0)
+        {
+            continue;
+        }
+
+        begin_message(&w, frame, client);
+        json_kv_string(&w, "type", "status");
+        json_key(&w, "system");
+        json_begin_object(&w);
+        if (wifi_changed)
+        {
+            json_kv_bool(&w, "wifi", status->wifi_connected);
+        }
+        if (rssi_changed)
+        {
+            json_kv_int(&w, "rssi", status->rssi);
+        }
+        if (keyframe)
+        {
+            json_kv_uint(&w, "uptime", status->uptime_s);
+            json_kv_uint(&w, "loopCount", status->loop_count);
+        }
+        json_end_object(&w);
+        if (keyframe)
+        {
+            json_kv_bool(&w, "keyframe", true);
+        }
+        json_end_object(&w);
+
+        if (!send_to_client(client, &w, frame, fields))
+        {
+            continue;
+        }
+
+        if (wifi_changed)
+            sent->wifi_connected = status->wifi_connected;
+        if (rssi_changed)
+            sent->rssi = status->rssi;
+        if (keyframe)
+        {
+            sent->uptime_s = status->uptime_s;
+            sent->loop_count = status->loop_count;
+            state->status_valid = true;
+            state->last_status_keyframe_ms = now_ms;
+            telemetry_stats.keyframes_sent++;
+        }
+    }
+}
+
+void telemetry_get_stats(telemetry_stats_t *stats)
+{
+    if (stats)
+    {
+        *stats = telemetry_stats;
+    }
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static bool keyframe_due(bool valid, uint32_t last_keyframe_ms, uint32_t now_ms)
+{
+    if (!valid)
+    {
+        return true;
+    }
+
+    return telemetry_config.keyframe_interval_ms > 0 &&
+           (now_ms - last_keyframe_ms) >= telemetry_config.keyframe_interval_ms;
+}
+
+static void begin_message(json_writer_t *w, uint8_t *frame, int client_id)
+{
+    // Composed in place behind the frame header headroom, in the client's encoding
+    json_writer_init_format(w, (char *)frame + WEBSOCKET_FRAME_HEADROOM, TELEMETRY_MSG_SIZE,
+                            websocket_client_format(client_id));
+    json_begin_object(w);
+}
+
+static bool send_to_client(int client_id, json_writer_t *w, uint8_t *frame, uint32_t fields)
+{
+    size_t len = json_writer_finish(w);
+    if (len == 0 || !websocket_send_prepared(client_id, frame, len, (json_format_t)w->format))
+    {
+        return false;
+    }
+
+    telemetry_stats.messages_sent++;
+    telemetry_stats.fields_sent += fields;
+    return true;
+}
@@ -0,0 +1,641 @@
+/**
+ * @file telnet_server.cpp
+ * @brief Raw TCP console sessions sharing the UART command table and log stream
+ *
+ * Received bytes are only queued by the lwIP callback; the main loop parses
+ * them, one command line per session at a time, so commands run in the same
+ * context as UART commands. The receive window reopens as input is consumed,
+ * which makes a client that types faster than its replies drain wait.
+ *
+ * A command line is taken only when the session can queue a full reply, and
+ * log output is limited to send buffer beyond that reserve, so replies are
+ * never cut short by logs and logs never wait for a session.
+ */
+
+#include "../include/telnet_server.h"
+#include "../include/board_config.h"
+#include "../include/time_sync.h"
+#include "command_registry.h"
+#include "log_ring.h"
+
+#include "lwip/tcp.h"
+#include "lwip/pbuf.h"
+#include "lwip/err.h"
+#include "pico/cyw43_arch.h"
+#include "pico/stdio.h"
+#include "pico/stdio/driver.h"
+
+#include <cstring>
+#include <cstdio>
+#include <strings.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define TELNET_REPLY_SIZE (CMD_REPLY_MAX + CMD_BATCH_MAX + 1) // Reply plus a CR for each of its lines
+#define TELNET_QUEUE_RESERVE 4                                // Send queue entries kept for a reply
+#define TELNET_LOG_CHUNK 512                                  // Log bytes per tcp_write()
+#define TELNET_NOTICE_MAX 64                                  // "log bytes dropped" notice
+#define TELNET_STAMP_MAX 24                                   // "[1760000000.123456] "
+
+// Telnet commands (RFC 854)
+#define TELNET_SE 240
+#define TELNET_SB 250
+#define TELNET_WILL 251
+#define TELNET_IAC 255
+
+// Input parser states
+#define TELNET_RX_DATA 0
+#define TELNET_RX_IAC 1
+#define TELNET_RX_OPTION 2
+#define TELNET_RX_SUB 3
+#define TELNET_RX_SUB_IAC 4
+
+// =============================================================================
+// PRIVATE TYPES
+// =============================================================================
+
+typedef struct
+{
+    struct tcp_pcb *pcb;
+    bool connected;
+    char remote_ip[16];
+    struct pbuf *rx; // Received but not parsed yet; acknowledged to the peer as it is consumed
+    uint8_t rx_state;
+    bool line_ready; // line is complete and waits for room for its reply
+    bool line_overlong;
+    size_t line_len;
+    char line[TELNET_LINE_MAX];
+    log_ring_reader_t log;
+} telnet_session_t;
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static struct tcp_pcb *telnet_server_pcb = NULL;
+static telnet_session_t sessions[TELNET_MAX_SESSIONS];
+static telnet_server_stats_t server_stats;
+static bool server_initialized = false;
+static stdio_driver_t log_capture_driver;
+static bool log_capture_installed = false;
+static bool log_line_start = true; // The next captured byte begins a line
+static char reply[TELNET_REPLY_SIZE]; // Main loop only
+
+static const char telnet_banner[] = "Multi-Channel Diagnostic Test Rig console\r\n"
+                                    "HELP lists commands, QUIT closes this session\r\n";
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static void log_capture_out_chars(const char *buf, int len);
+static err_t telnet_accept(void *arg, struct tcp_pcb *newpcb, err_t err);
+static err_t telnet_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
+static void telnet_err(void *arg, err_t err);
+static bool next_line(int index, char *line);
+static void parse_input(telnet_session_t *session);
+static void parse_byte(telnet_session_t *session, uint8_t c);
+static size_t execute_line(int index, const char *line);
+static size_t expand_newlines(char *text, size_t len, size_t size);
+static bool has_reply_room(struct tcp_pcb *pcb);
+static size_t log_room(struct tcp_pcb *pcb);
+static void drain_log(telnet_session_t *session);
+static bool send_text(struct tcp_pcb *pcb, const char *text, size_t len);
+static void release_session(int index);
+static err_t close_session(int index);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+bool telnet_server_init(void)
+{
+    if (server_initialized)
+    {
+        return true;
+    }
+
+    if (!log_capture_installed)
+    {
+        // Everything printed from here on is also kept in the log ring
+        log_capture_driver.out_chars = log_capture_out_chars;
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT
+        stdio_set_translate_crlf(&log_capture_driver, true);
+#endif
+        stdio_set_driver_enabled(&log_capture_driver, true);
+        log_capture_installed = true;
+    }
+
+    memset(sessions, 0, sizeof(sessions));
+    memset(&server_stats, 0, sizeof(server_stats));
+    server_stats.sessions_total = TELNET_MAX_SESSIONS;
+
+    cyw43_arch_lwip_begin();
+    telnet_server_pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    err_t err = ERR_MEM;
+    if (telnet_server_pcb)
+    {
+        err = tcp_bind(telnet_server_pcb, IP_ANY_TYPE, NET_TELNET_PORT);
+    }
+    if (err == ERR_OK)
+    {
+        telnet_server_pcb = tcp_listen(telnet_server_pcb);
+        if (telnet_server_pcb)
+        {
+            tcp_accept(telnet_server_pcb, telnet_accept);
+        }
+    }
+    else if (telnet_server_pcb)
+    {
+        tcp_close(telnet_server_pcb);
+        telnet_server_pcb = NULL;
+    }
+    cyw43_arch_lwip_end();
+
+    if (telnet_server_pcb == NULL)
+    {
+        printf("[TELNET] Failed to listen on port %d: %d\n", NET_TELNET_PORT, err);
+        return false;
+    }
+
+    server_initialized = true;
+    printf("[TELNET] Console listening on port %d (%d sessions)\n", NET_TELNET_PORT, TELNET_MAX_SESSIONS);
+    return true;
+}
+
+void telnet_server_update(void)
+{
+    if (!server_initialized)
+    {
+        return;
+    }
+
+    for (int i = 0; i < TELNET_MAX_SESSIONS; i++)
+    {
+        char line[TELNET_LINE_MAX];
+
+        cyw43_arch_lwip_begin();
+        struct tcp_pcb *pcb = next_line(i, line) ? sessions[i].pcb : NULL;
+        cyw43_arch_lwip_end();
+
+        // Commands run unlocked since they may take a while; the modules they
+        // reach (WebSocket, UDP stream, time sync) lock around their own lwIP calls
+        size_t reply_len = pcb ? execute_line(i, line) : 0;
+
+        cyw43_arch_lwip_begin();
+        telnet_session_t *session = &sessions[i];
+        if (session->connected && session->pcb != NULL)
+        {
+            // The slot may have been closed, or even reused, while the command ran
+            if (reply_len > 0 && session->pcb == pcb)
+            {
+                send_text(pcb, reply, reply_len);
+            }
+            drain_log(session);
+            tcp_output(session->pcb);
+        }
+        cyw43_arch_lwip_end();
+    }
+}
+
+void telnet_server_stop(void)
+{
+    if (!server_initialized)
+    {
+        return;
+    }
+
+    cyw43_arch_lwip_begin();
+    for (int i = 0; i < TELNET_MAX_SESSIONS; i++)
+    {
+        if (sessions[i].connected)
+        {
+            close_session(i);
+        }
+    }
+
+    if (telnet_server_pcb)
+    {
+        tcp_close(telnet_server_pcb);
+        telnet_server_pcb = NULL;
+    }
+    cyw43_arch_lwip_end();
+
+    server_initialized = false;
+    printf("[TELNET] Console stopped\n");
+}
+
+void telnet_server_get_stats(telnet_server_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    *stats = server_stats;
+    stats->sessions_in_use = 0;
+    for (int i = 0; i < TELNET_MAX_SESSIONS; i++)
+    {
+        stats->sessions_in_use += sessions[i].connected ? 1 : 0;
+    }
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static void log_capture_out_chars(const char *buf, int len)
+{
+    // Lines are stamped when their first byte is printed; stdio hands the
+    // driver arbitrary pieces, so a line may start in one call and end later
+    size_t pos = 0;
+    while (pos < (size_t)len)
+    {
+        if (log_line_start)
+        {
+            bool synced = false;
+            uint64_t now_us = time_sync_now_us(&synced);
+            char stamp[TELNET_STAMP_MAX];
+            int stamp_len = snprintf(stamp, sizeof(stamp), synced ? "[%lu.%06lu] " : "[+%lu.%06lu] ",
+                                     (unsigned long)(now_us / 1000000u), (unsigned long)(now_us % 1000000u));
+            log_ring_write(stamp, (size_t)stamp_len);
+            log_line_start = false;
+        }
+
+        const char *newline = (const char *)memchr(buf + pos, '\n', (size_t)len - pos);
+        size_t end = newline ? (size_t)(newline - buf) + 1 : (size_t)len;
+        log_ring_write(buf + pos, end - pos);
+        log_line_start = newline != NULL;
+        pos = end;
+    }
+}
+
+static err_t telnet_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
+{
+    if (err != ERR_OK || newpcb == NULL)
+    {
+        return ERR_VAL;
+    }
+
+    int index = -1;
+    for (int i = 0; i < TELNET_MAX_SESSIONS && index < 0; i++)
+    {
+        index = sessions[i].connected ? -1 : i;
+    }
+    if (index < 0)
+    {
+        printf("[TELNET] All %d sessions in use, rejecting connection\n", TELNET_MAX_SESSIONS);
+        server_stats.connections_rejected++;
+        tcp_abort(newpcb);
+        return ERR_ABRT;
+    }
+
+    telnet_session_t *session = &sessions[index];
+    memset(session, 0, sizeof(*session));
+    session->pcb = newpcb;
+    session->connected = true;
+    snprintf(session->remote_ip, sizeof(session->remote_ip), "%s", ipaddr_ntoa(&newpcb->remote_ip));
+    log_ring_reader_init(&session->log);
+    server_stats.connections_accepted++;
+
+    tcp_arg(newpcb, session);
+    tcp_recv(newpcb, telnet_recv);
+    tcp_err(newpcb, telnet_err);
+
+    // A terminal left open on a machine that went away must not hold the slot forever
+    ip_set_option(newpcb, SOF_KEEPALIVE);
+    newpcb->keep_idle = TELNET_KEEPALIVE_IDLE_MS;
+    newpcb->keep_intvl = TELNET_KEEPALIVE_INTERVAL_MS;
+    newpcb->keep_cnt = TELNET_KEEPALIVE_COUNT;
+
+    send_text(newpcb, telnet_banner, sizeof(telnet_banner) - 1);
+    tcp_output(newpcb);
+
+    printf("[TELNET] Session %d connected from %s\n", index, session->remote_ip);
+    return ERR_OK;
+}
+
+static err_t telnet_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
+{
+    telnet_session_t *session = (telnet_session_t *)arg;
+
+    if (err != ERR_OK || session == NULL)
+    {
+        if (p)
+            pbuf_free(p);
+        return err;
+    }
+
+    int index = (int)(session - sessions);
+
+    if (p == NULL)
+    {
+        printf("[TELNET] Session %d closed by %s\n", index, session->remote_ip);
+        return close_session(index);
+    }
+
+    // Parsed by the main loop; the chain is bounded by the receive window
+    if (session->rx)
+    {
+        pbuf_cat(session->rx, p);
+    }
+    else
+    {
+        session->rx = p;
+    }
+    return ERR_OK;
+}
+
+static void telnet_err(void *arg, err_t err)
+{
+    telnet_session_t *session = (telnet_session_t *)arg;
+    if (session == NULL)
+    {
+        return;
+    }
+
+    // lwIP has already freed the PCB; only the slot needs releasing
+    int index = (int)(session - sessions);
+    printf("[TELNET] Error on session %d: %d\n", index, err);
+    session->pcb = NULL;
+    release_session(index);
+}
+
+/**
+ * Take the session's next command line, if it has one and room for the reply.
+ * Lines that need no command (overlong, QUIT) are answered here. Called locked.
+ */
+static bool next_line(int index, char *line)
+{
+    telnet_session_t *session = &sessions[index];
+    if (!session->connected || session->pcb == NULL)
+    {
+        return false;
+    }
+
+    if (!session->line_ready)
+    {
+        parse_input(session);
+    }
+    if (!session->line_ready || !has_reply_room(session->pcb))
+    {
+        return false;
+    }
+
+    session->line_ready = false;
+    session->line[session->line_len] = '\0';
+    session->line_len = 0;
+
+    if (session->line_overlong)
+    {
+        char error[64];
+        int len = snprintf(error, sizeof(error), "ERR - line longer than %d characters\r\n", TELNET_LINE_MAX - 1);
+        send_text(session->pcb, error, (size_t)len);
+        session->line_overlong = false;
+        return false;
+    }
+
+    if (strcasecmp(session->line, "QUIT") == 0 || strcasecmp(session->line, "EXIT") == 0)
+    {
+        printf("[TELNET] Session %d closed\n", index);
+        close_session(index);
+        return false;
+    }
+
+    memcpy(line, session->line, sizeof(session->line));
+    return true;
+}
+
+static void parse_input(telnet_session_t *session)
+{
+    while (session->rx != NULL && !session->line_ready)
+    {
+        struct pbuf *head = session->rx;
+        const uint8_t *data = (const uint8_t *)head->payload;
+        u16_t used = 0;
+        while (used < head->len && !session->line_ready)
+        {
+            parse_byte(session, data[used++]);
+        }
+
+        tcp_recved(session->pcb, used);
+        if (used < head->len)
+        {
+            pbuf_remove_header(head, used);
+        }
+        else
+        {
+            // Keep the rest of the chain alive while its first buffer is freed
+            session->rx = head->next;
+            if (session->rx)
+            {
+                pbuf_ref(session->rx);
+            }
+            pbuf_free(head);
+        }
+    }
+}
+
+static void parse_byte(telnet_session_t *session, uint8_t c)
+{
+    // Option negotiation is refused by ignoring it, which leaves clients in line mode
+    switch (session->rx_state)
+    {
+    case TELNET_RX_IAC:
+        if (c == TELNET_SB)
+        {
+            session->rx_state = TELNET_RX_SUB;
+        }
+        else if (c >= TELNET_WILL && c != TELNET_IAC)
+        {
+            session->rx_state = TELNET_RX_OPTION; // WILL/WONT/DO/DONT name an option next
+        }
+        else
+        {
+            session->rx_state = TELNET_RX_DATA; // Two-byte command, or IAC IAC (a literal 0xFF)
+        }
+        return;
+    case TELNET_RX_OPTION:
+        session->rx_state = TELNET_RX_DATA;
+        return;
+    case TELNET_RX_SUB:
+        session->rx_state = c == TELNET_IAC ? TELNET_RX_SUB_IAC : TELNET_RX_SUB;
+        return;
+    case TELNET_RX_SUB_IAC:
+        session->rx_state = c == TELNET_SE ? TELNET_RX_DATA : TELNET_RX_SUB;
+        return;
+    default:
+        break;
+    }
+
+    if (c == TELNET_IAC)
+    {
+        session->rx_state = TELNET_RX_IAC;
+    }
+    else if (c == '\r' || c == '\n')
+    {
+        // CR LF and CR NUL end one line; the empty line after it is ignored
+        session->line_ready = session->line_len > 0 || session->line_overlong;
+    }
+    else if (c == '\b' || c == 0x7F)
+    {
+        if (session->line_len > 0)
+        {
+            session->line_len--;
+        }
+    }
+    else if (c < ' ')
+    {
+        // Other control characters (NUL after CR, ^C) are not part of a command
+    }
+    else if (session->line_len + 1 < sizeof(session->line))
+    {
+        session->line[session->line_len++] = (char)c;
+    }
+    else
+    {
+        session->line_overlong = true;
+    }
+}
+
+static size_t execute_line(int index, const char *line)
+{
+    printf("[TELNET] Session %d command: %s\n", index, line);
+    server_stats.commands_executed++;
+
+    // One OK/ERR line per command, as on UART
+    size_t len = command_execute_line(line, CMD_SOURCE_TELNET, index, reply, CMD_REPLY_MAX);
+    return expand_newlines(reply, len, sizeof(reply));
+}
+
+/**
+ * Turn LF into CR LF in place for the terminal. The log ring needs no pass
+ * like this: stdio translates before the capture driver sees it.
+ */
+static size_t expand_newlines(char *text, size_t len, size_t size)
+{
+    size_t lines = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        lines += text[i] == '\n' ? 1 : 0;
+    }
+    if (lines == 0 || len + lines > size)
+    {
+        return len;
+    }
+
+    // Back to front, so every byte moves once and nothing unread is overwritten
+    size_t out = len + lines;
+    for (size_t i = len; i-- > 0;)
+    {
+        text[--out] = text[i];
+        if (text[i] == '\n')
+        {
+            text[--out] = '\r';
+        }
+    }
+    return len + lines;
+}
+
+static bool has_reply_room(struct tcp_pcb *pcb)
+{
+    return tcp_sndbuf(pcb) >= TELNET_REPLY_SIZE && tcp_sndqueuelen(pcb) + TELNET_QUEUE_RESERVE <= TCP_SND_QUEUELEN;
+}
+
+/**
+ * Log bytes the session may queue now: what is left after the reply
+ * reserve, and no more than TELNET_LOG_IN_FLIGHT unacknowledged in total,
+ * since unsent data sits in the lwIP heap every connection shares.
+ */
+static size_t log_room(struct tcp_pcb *pcb)
+{
+    size_t free_space = tcp_sndbuf(pcb);
+    size_t in_flight = TCP_SND_BUF - free_space;
+    if (free_space <= TELNET_REPLY_SIZE || in_flight >= TELNET_LOG_IN_FLIGHT ||
+        tcp_sndqueuelen(pcb) + 2 * TELNET_QUEUE_RESERVE > TCP_SND_QUEUELEN)
+    {
+        return 0;
+    }
+
+    size_t room = free_space - TELNET_REPLY_SIZE;
+    return room < TELNET_LOG_IN_FLIGHT - in_flight ? room : TELNET_LOG_IN_FLIGHT - in_flight;
+}
+
+static void drain_log(telnet_session_t *session)
+{
+    char chunk[TELNET_LOG_CHUNK];
+
+    for (;;)
+    {
+        size_t room = log_room(session->pcb);
+        if (room <= TELNET_NOTICE_MAX)
+        {
+            return;
+        }
+        room -= TELNET_NOTICE_MAX;
+
+        size_t len = log_ring_read(&session->log, chunk, room < sizeof(chunk) ? room : sizeof(chunk));
+        if (session->log.lost > 0)
+        {
+            // Output resumes mid-line after a gap, so say so on a line of its own
+            char notice[TELNET_NOTICE_MAX];
+            int notice_len = snprintf(notice, sizeof(notice), "\r\n[TELNET] %lu log bytes dropped\r\n",
+                                      (unsigned long)session->log.lost);
+            send_text(session->pcb, notice, (size_t)notice_len);
+            server_stats.log_bytes_dropped += session->log.lost;
+            session->log.lost = 0;
+        }
+        if (len == 0)
+        {
+            return;
+        }
+
+        if (!send_text(session->pcb, chunk, len))
+        {
+            server_stats.log_bytes_dropped += (uint32_t)len;
+            return;
+        }
+        server_stats.log_bytes_sent += (uint32_t)len;
+    }
+}
+
+static bool send_text(struct tcp_pcb *pcb, const char *text, size_t len)
+{
+    return tcp_write(pcb, text, (u16_t)len, TCP_WRITE_FLAG_COPY) == ERR_OK;
+}
+
+static void release_session(int index)
+{
+    telnet_session_t *session = &sessions[index];
+    if (session->rx)
+    {
+        pbuf_free(session->rx);
+    }
+    memset(session, 0, sizeof(*session));
+}
+
+static err_t close_session(int index)
+{
+    struct tcp_pcb *pcb = sessions[index].pcb;
+    release_session(index);
+
+    if (pcb == NULL)
+    {
+        return ERR_OK;
+    }
+
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_err(pcb, NULL);
+
+    // Queued output (the last reply) is still sent before the FIN
+    if (tcp_close(pcb) != ERR_OK)
+    {
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+
+    return ERR_OK;
+}
@@ -0,0 +1,392 @@
+/**
+ * @file time_sync.cpp
+ * @brief SNTP client feeding the clock_sync estimator
+ *
+ * Requests are sent from the main loop. Replies and DNS answers arrive in
+ * lwIP callbacks, which only timestamp and validate them; the estimator
+ * runs in time_sync_update(). The resulting mapping is published through
+ * a pair of slots so time_sync_to_host_us() can be called from any context
+ * (including an interrupt that preempts the update) without locking.
+ */
+
+#include "../include/time_sync.h"
+#include "../include/board_config.h"
+#include "hal_interface.h"
+#include "clock_sync.h"
+
+#include "pico/cyw43_arch.h"
+#include "lwip/udp.h"
+#include "lwip/pbuf.h"
+#include "lwip/ip_addr.h"
+#include "lwip/dns.h"
+
+#include <cstring>
+#include <cstdio>
+
+// =============================================================================
+// PRIVATE TYPES
+// =============================================================================
+
+typedef enum
+{
+    RESOLVE_NEEDED,
+    RESOLVE_PENDING,
+    RESOLVE_FAILED,
+    RESOLVE_DONE
+} resolve_state_t;
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static struct udp_pcb *sync_pcb = NULL;
+static clock_sync_t sync_state;
+static time_sync_stats_t sync_stats = {};
+
+// Published mapping: readers use mappings[active_mapping], updates go to the other slot
+static clock_sync_mapping_t mappings[2] = {};
+static volatile uint8_t active_mapping = 0;
+
+// Server address, filled by DNS
+static ip_addr_t server_addr;
+static volatile resolve_state_t resolve_state = RESOLVE_NEEDED;
+static volatile uint32_t resolve_generation = 0; // Ignores answers to lookups from before a restart
+static uint32_t resolve_failed_ms = 0;
+
+// Request in flight; cleared by the receive callback when answered
+static volatile bool request_outstanding = false;
+static uint64_t request_cookie = 0; // Also t1
+static uint32_t request_sent_ms = 0;
+static uint32_t last_request_ms = 0;
+static uint8_t burst_remaining = 0;
+static uint8_t consecutive_timeouts = 0;
+
+// Answer waiting for time_sync_update()
+static volatile bool reply_ready = false;
+static uint64_t reply_t1_us = 0;
+static int64_t reply_t2_us = 0;
+static int64_t reply_t3_us = 0;
+static uint64_t reply_t4_us = 0;
+static volatile uint32_t invalid_replies = 0;
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static void start_resolve(void);
+static void send_request(void);
+static void apply_reply(void);
+static void publish_mapping(void);
+static void dns_found(const char *name, const ip_addr_t *ipaddr, void *arg);
+static void sync_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+bool time_sync_start(const char *server, uint16_t port, uint32_t interval_s)
+{
+    if (server == NULL || server[0] == '\0' || strlen(server) >= TIME_SYNC_SERVER_MAX || port == 0 ||
+        interval_s == 0)
+    {
+        printf("[TIME] Invalid time server\n");
+        return false;
+    }
+
+    if (sync_pcb == NULL)
+    {
+        cyw43_arch_lwip_begin();
+        sync_pcb = udp_new_ip_type(IPADDR_TYPE_V4);
+        if (sync_pcb)
+        {
+            udp_recv(sync_pcb, sync_recv, NULL);
+        }
+        cyw43_arch_lwip_end();
+
+        if (sync_pcb == NULL)
+        {
+            printf("[TIME] Failed to create sync PCB\n");
+            return false;
+        }
+    }
+
+    // Exchanges with another server say nothing about this one; the mapping is kept and stepped only if it must be
+    clock_sync_mapping_t current = mappings[active_mapping];
+    clock_sync_init(&sync_state);
+    sync_state.mapping = current;
+
+    snprintf(sync_stats.server, sizeof(sync_stats.server), "%s", server);
+    sync_stats.port = port;
+    sync_stats.interval_s = interval_s;
+    sync_stats.running = true;
+
+    resolve_generation = resolve_generation + 1;
+    resolve_state = RESOLVE_NEEDED;
+    request_outstanding = false;
+    reply_ready = false;
+    burst_remaining = TIME_SYNC_BURST_COUNT;
+    consecutive_timeouts = 0;
+    last_request_ms = hal_get_tick_ms() - TIME_SYNC_BURST_INTERVAL_MS; // First request on the next update
+
+    printf("[TIME] Syncing to %s:%u every %lu s\n", server, port, (unsigned long)interval_s);
+    return true;
+}
+
+void time_sync_stop(void)
+{
+    if (sync_pcb == NULL)
+    {
+        return;
+    }
+
+    cyw43_arch_lwip_begin();
+    udp_remove(sync_pcb);
+    cyw43_arch_lwip_end();
+    sync_pcb = NULL;
+
+    resolve_generation = resolve_generation + 1;
+    request_outstanding = false;
+    reply_ready = false;
+    sync_stats.running = false;
+    printf("[TIME] Sync stopped (%s)\n", time_sync_is_synced() ? "keeping host time" : "never synced");
+}
+
+void time_sync_update(void)
+{
+    if (!sync_stats.running)
+    {
+        return;
+    }
+
+    if (reply_ready)
+    {
+        apply_reply();
+    }
+
+    uint32_t now = hal_get_tick_ms();
+
+    if (request_outstanding)
+    {
+        if (now - request_sent_ms < TIME_SYNC_TIMEOUT_MS)
+        {
+            return;
+        }
+        request_outstanding = false;
+        sync_stats.timeouts++;
+
+        // Pool names rotate through servers; a dead one is worth replacing
+        if (++consecutive_timeouts >= TIME_SYNC_RERESOLVE_TIMEOUTS)
+        {
+            consecutive_timeouts = 0;
+            resolve_state = RESOLVE_NEEDED;
+        }
+    }
+
+    if (resolve_state == RESOLVE_NEEDED ||
+        (resolve_state == RESOLVE_FAILED && now - resolve_failed_ms >= TIME_SYNC_RESOLVE_RETRY_MS))
+    {
+        start_resolve();
+    }
+    if (resolve_state != RESOLVE_DONE)
+    {
+        return; // Lookup in progress or waiting to retry
+    }
+
+    uint32_t wait_ms = burst_remaining > 0 ? TIME_SYNC_BURST_INTERVAL_MS : sync_stats.interval_s * 1000;
+    if (now - last_request_ms >= wait_ms)
+    {
+        send_request();
+    }
+}
+
+bool time_sync_is_synced(void)
+{
+    return mappings[active_mapping].synced;
+}
+
+uint64_t time_sync_to_host_us(uint64_t local_us, bool *synced)
+{
+    // Updates happen seconds apart, so the slot read here is never rewritten mid-copy
+    clock_sync_mapping_t mapping = mappings[active_mapping];
+
+    if (synced)
+    {
+        *synced = mapping.synced;
+    }
+    return (uint64_t)clock_sync_map(&mapping, local_us);
+}
+
+uint64_t time_sync_now_us(bool *synced)
+{
+    return time_sync_to_host_us(hal_get_time_us(), synced);
+}
+
+void time_sync_get_stats(time_sync_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    *stats = sync_stats;
+    stats->synced = time_sync_is_synced();
+    stats->invalid = invalid_replies;
+    stats->steps = sync_state.steps;
+    stats->last_error_us = sync_state.last_error_us;
+    stats->delay_us = sync_state.last_delay_us;
+    stats->drift_ppb = sync_state.mapping.drift_ppb;
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static void start_resolve(void)
+{
+    ip_addr_t addr;
+
+    if (ipaddr_aton(sync_stats.server, &addr))
+    {
+        server_addr = addr;
+        resolve_state = RESOLVE_DONE;
+        return;
+    }
+
+    resolve_state = RESOLVE_PENDING;
+    cyw43_arch_lwip_begin();
+    err_t err = dns_gethostbyname(sync_stats.server, &addr, dns_found, (void *)(uintptr_t)resolve_generation);
+    cyw43_arch_lwip_end();
+
+    if (err == ERR_OK)
+    {
+        server_addr = addr; // Cached
+        resolve_state = RESOLVE_DONE;
+    }
+    else if (err != ERR_INPROGRESS)
+    {
+        sync_stats.dns_failures++;
+        resolve_failed_ms = hal_get_tick_ms();
+        resolve_state = RESOLVE_FAILED;
+    }
+}
+
+static void send_request(void)
+{
+    cyw43_arch_lwip_begin();
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, CLOCK_SYNC_NTP_PACKET_SIZE, PBUF_RAM);
+    err_t err = ERR_MEM;
+    if (p)
+    {
+        // The cookie is t1, taken as late as possible; replies cannot be processed until lwip_end
+        request_cookie = hal_get_time_us();
+        clock_sync_ntp_request((uint8_t *)p->payload, request_cookie);
+        request_outstanding = true;
+        err = udp_sendto(sync_pcb, p, &server_addr, sync_stats.port);
+        if (err != ERR_OK)
+        {
+            request_outstanding = false;
+        }
+        pbuf_free(p);
+    }
+    cyw43_arch_lwip_end();
+
+    // Failures wait a full interval too, so a broken link is not hammered
+    last_request_ms = hal_get_tick_ms();
+    request_sent_ms = last_request_ms;
+    if (err == ERR_OK)
+    {
+        sync_stats.requests_sent++;
+        if (burst_remaining > 0)
+        {
+            burst_remaining--;
+        }
+    }
+}
+
+static void apply_reply(void)
+{
+    uint64_t t1 = reply_t1_us;
+    int64_t t2 = reply_t2_us;
+    int64_t t3 = reply_t3_us;
+    uint64_t t4 = reply_t4_us;
+    __atomic_signal_fence(__ATOMIC_ACQUIRE);
+    reply_ready = false;
+
+    sync_stats.replies++;
+    consecutive_timeouts = 0;
+
+    bool was_synced = sync_state.mapping.synced;
+    uint32_t steps = sync_state.steps;
+    if (!clock_sync_add_exchange(&sync_state, t1, t2, t3, t4))
+    {
+        return;
+    }
+    publish_mapping();
+
+    if (!was_synced)
+    {
+        printf("[TIME] Synced to %s, round trip %lu us\n", sync_stats.server, (unsigned long)sync_state.last_delay_us);
+    }
+    else if (sync_state.steps != steps)
+    {
+        printf("[TIME] Host clock jumped; timestamps stepped\n");
+    }
+}
+
+static void publish_mapping(void)
+{
+    uint8_t next = active_mapping ^ 1;
+
+    mappings[next] = sync_state.mapping;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    active_mapping = next;
+}
+
+static void dns_found(const char *name, const ip_addr_t *ipaddr, void *arg)
+{
+    if ((uint32_t)(uintptr_t)arg != resolve_generation || resolve_state != RESOLVE_PENDING)
+    {
+        return;
+    }
+
+    if (ipaddr)
+    {
+        server_addr = *ipaddr;
+        resolve_state = RESOLVE_DONE;
+    }
+    else
+    {
+        sync_stats.dns_failures++;
+        resolve_failed_ms = hal_get_tick_ms();
+        resolve_state = RESOLVE_FAILED;
+        printf("[TIME] Could not resolve %s\n", name);
+    }
+}
+
+static void sync_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+    // t4 comes first: everything after it would count as network delay
+    uint64_t t4 = hal_get_time_us();
+    uint8_t packet[CLOCK_SYNC_NTP_PACKET_SIZE];
+    int64_t t2, t3;
+
+    if (request_outstanding && !reply_ready && port == sync_stats.port && ip_addr_cmp(addr, &server_addr) &&
+        pbuf_copy_partial(p, packet, sizeof(packet), 0) == sizeof(packet))
+    {
+        if (clock_sync_ntp_parse_reply(packet, sizeof(packet), request_cookie, &t2, &t3))
+        {
+            reply_t1_us = request_cookie;
+            reply_t2_us = t2;
+            reply_t3_us = t3;
+            reply_t4_us = t4;
+            __atomic_signal_fence(__ATOMIC_RELEASE);
+            request_outstanding = false;
+            reply_ready = true;
+        }
+        else
+        {
+            invalid_replies = invalid_replies + 1;
+        }
+    }
+    pbuf_free(p);
+}
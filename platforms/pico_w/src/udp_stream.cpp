@@ -0,0 +1,289 @@
+/**
+ * @file udp_stream.cpp
+ * @brief Full-rate channel sample streaming over UDP
+ *
+ * The open block lives directly in a PBUF_RAM pbuf sized for a full
+ * datagram: frames are serialized straight into its payload, and the pbuf
+ * is trimmed and handed to udp_sendto() when the block closes, so samples
+ * are copied exactly once between the sampler ring and the radio.
+ */
+
+#include "../include/udp_stream.h"
+#include "../include/sampler.h"
+#include "../include/time_sync.h"
+#include "../include/board_config.h"
+#include "hal_interface.h"
+#include "sample_stream.h"
+
+#include "pico/cyw43_arch.h"
+#include "lwip/udp.h"
+#include "lwip/pbuf.h"
+#include "lwip/ip_addr.h"
+
+#include <cstring>
+#include <cstdio>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define UDP_STREAM_READ_FRAMES 32 // Frames moved from the sampler per read
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static struct udp_pcb *stream_pcb = NULL;
+static ip_addr_t stream_addr;
+static udp_stream_stats_t stream_stats = {};
+static uint16_t frames_per_block = 0;
+static uint32_t next_sequence = 0;
+static uint32_t expected_index = 0; // Sampler frame that should come next
+
+// Open block
+static struct pbuf *block = NULL;
+static uint16_t block_frames = 0;
+static uint32_t block_first_index = 0;
+static uint32_t block_opened_ms = 0;
+static bool gap_pending = false; // Set when frames were lost before the next block
+
+static udp_stream_frame_listener_t frame_listener = NULL;
+static void *frame_listener_context = NULL;
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static bool open_block(uint32_t first_index);
+static void flush_block(void);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+bool udp_stream_start(const char *destination, uint16_t port, uint32_t rate_hz)
+{
+    ip_addr_t addr;
+
+    if (destination == NULL || port == 0 || !ipaddr_aton(destination, &addr))
+    {
+        printf("[UDP] Invalid stream destination\n");
+        return false;
+    }
+
+    if (stream_stats.active)
+    {
+        udp_stream_stop();
+    }
+
+    frames_per_block = sample_stream_frames_per_datagram(SAMPLER_CHANNELS, UDP_STREAM_MAX_DATAGRAM);
+
+    cyw43_arch_lwip_begin();
+    stream_pcb = udp_new_ip_type(IPADDR_TYPE_V4);
+    if (stream_pcb)
+    {
+        // Needed for broadcast destinations; harmless for unicast and multicast
+        ip_set_option(stream_pcb, SOF_BROADCAST);
+    }
+    cyw43_arch_lwip_end();
+
+    if (stream_pcb == NULL)
+    {
+        printf("[UDP] Failed to create stream PCB\n");
+        return false;
+    }
+
+    if (!sampler_start(rate_hz))
+    {
+        cyw43_arch_lwip_begin();
+        udp_remove(stream_pcb);
+        cyw43_arch_lwip_end();
+        stream_pcb = NULL;
+        return false;
+    }
+
+    stream_addr = addr;
+    memset(&stream_stats, 0, sizeof(stream_stats));
+    snprintf(stream_stats.destination, sizeof(stream_stats.destination), "%s", destination);
+    stream_stats.port = port;
+    stream_stats.rate_hz = rate_hz;
+    stream_stats.active = true;
+    next_sequence = 0;
+    expected_index = 0;
+    gap_pending = false;
+
+    printf("[UDP] Streaming %d channels at %lu Hz to %s:%u (%u frames/datagram)\n",
+           SAMPLER_CHANNELS, (unsigned long)rate_hz, destination, port, frames_per_block);
+    return true;
+}
+
+void udp_stream_stop(void)
+{
+    if (!stream_stats.active)
+    {
+        return;
+    }
+
+    // Send what the sampler already holds before the ring is discarded
+    udp_stream_update();
+    sampler_stop();
+    flush_block();
+
+    cyw43_arch_lwip_begin();
+    udp_remove(stream_pcb);
+    cyw43_arch_lwip_end();
+    stream_pcb = NULL;
+    stream_stats.active = false;
+
+    printf("[UDP] Stream stopped: %lu datagrams, %lu frames, %lu send errors\n",
+           (unsigned long)stream_stats.datagrams_sent, (unsigned long)stream_stats.frames_sent,
+           (unsigned long)stream_stats.send_errors);
+}
+
+bool udp_stream_is_active(void)
+{
+    return stream_stats.active;
+}
+
+void udp_stream_update(void)
+{
+    if (!stream_stats.active)
+    {
+        return;
+    }
+
+    uint16_t samples[UDP_STREAM_READ_FRAMES * SAMPLER_CHANNELS];
+
+    for (;;)
+    {
+        size_t room = block ? (size_t)(frames_per_block - block_frames) : UDP_STREAM_READ_FRAMES;
+        if (room > UDP_STREAM_READ_FRAMES)
+        {
+            room = UDP_STREAM_READ_FRAMES;
+        }
+
+        uint32_t first_index;
+        size_t count = sampler_read(samples, room, &first_index);
+        if (count == 0)
+        {
+            break;
+        }
+
+        if (frame_listener)
+        {
+            frame_listener(samples, count, frame_listener_context);
+        }
+
+        // A block only ever holds consecutive frames
+        if (first_index != expected_index)
+        {
+            flush_block();
+            gap_pending = true;
+        }
+        expected_index = first_index + (uint32_t)count;
+
+        if (block == NULL && !open_block(first_index))
+        {
+            stream_stats.alloc_failures++;
+            gap_pending = true;
+            break; // Out of pbufs; the frames just read are lost
+        }
+
+        uint8_t *payload = (uint8_t *)block->payload + SAMPLE_STREAM_HEADER_SIZE;
+        for (size_t i = 0; i < count; i++)
+        {
+            sample_stream_write_frame(payload, block_frames++, &samples[i * SAMPLER_CHANNELS], SAMPLER_CHANNELS);
+        }
+
+        if (block_frames >= frames_per_block)
+        {
+            flush_block();
+        }
+    }
+
+    if (block && hal_get_tick_ms() - block_opened_ms >= UDP_STREAM_MAX_LATENCY_MS)
+    {
+        flush_block();
+    }
+}
+
+void udp_stream_set_frame_listener(udp_stream_frame_listener_t listener, void *context)
+{
+    frame_listener = listener;
+    frame_listener_context = context;
+}
+
+void udp_stream_get_stats(udp_stream_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    sampler_stats_t sampler;
+    sampler_get_stats(&sampler);
+
+    *stats = stream_stats;
+    stats->sampler_dropped = sampler.frames_dropped;
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static bool open_block(uint32_t first_index)
+{
+    cyw43_arch_lwip_begin();
+    block = pbuf_alloc(PBUF_TRANSPORT, (u16_t)sample_stream_datagram_size(SAMPLER_CHANNELS, frames_per_block), PBUF_RAM);
+    cyw43_arch_lwip_end();
+
+    if (block == NULL)
+    {
+        return false;
+    }
+
+    block_frames = 0;
+    block_first_index = first_index;
+    block_opened_ms = hal_get_tick_ms();
+    return true;
+}
+
+static void flush_block(void)
+{
+    if (block == NULL)
+    {
+        return;
+    }
+
+    sample_stream_header_t header;
+    bool host_time = false;
+    header.version = SAMPLE_STREAM_VERSION;
+    header.channel_count = SAMPLER_CHANNELS;
+    header.sequence = next_sequence++;
+    header.timestamp_us = time_sync_to_host_us(sampler_frame_time_us(block_first_index), &host_time);
+    header.first_sample = block_first_index;
+    header.sample_rate_hz = stream_stats.rate_hz;
+    header.frame_count = block_frames;
+    header.flags = (uint16_t)((gap_pending ? SAMPLE_STREAM_FLAG_OVERRUN : 0) |
+                              (host_time ? SAMPLE_STREAM_FLAG_HOST_TIME : 0));
+    sample_stream_write_header(&header, (uint8_t *)block->payload);
+
+    cyw43_arch_lwip_begin();
+    pbuf_realloc(block, (u16_t)sample_stream_datagram_size(SAMPLER_CHANNELS, block_frames));
+    err_t err = udp_sendto(stream_pcb, block, &stream_addr, stream_stats.port);
+    pbuf_free(block);
+    cyw43_arch_lwip_end();
+    block = NULL;
+
+    if (err == ERR_OK)
+    {
+        stream_stats.datagrams_sent++;
+        stream_stats.frames_sent += block_frames;
+        gap_pending = false;
+    }
+    else
+    {
+        // The sequence number was consumed, so the receiver counts this block as lost
+        stream_stats.send_errors++;
+    }
+}
@@ -0,0 +1,662 @@
+/**
+ * @file web_server.cpp
+ * @brief HTTP/1.1 static file server implementation for Raspberry Pi Pico W
+ *
+ * Asset bodies are handed to lwIP straight from flash (no copy) in chunks of
+ * at most one MSS, topped up from the sent callback as the window opens, so
+ * serving a file never needs more RAM than the response header. Requests are
+ * parsed incrementally straight out of the received pbuf chains.
+ */
+
+#include "../include/web_server.h"
+#include "../include/web_assets.h"
+#include "../include/board_config.h"
+#include "http_parser.h"
+
+// lwIP includes for networking
+#include "lwip/tcp.h"
+#include "lwip/pbuf.h"
+#include "lwip/err.h"
+#include "pico/cyw43_arch.h"
+
+#include <cstring>
+#include <cstdio>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define HTTP_HEADER_BUFFER_SIZE 320 // Response status line + headers
+#define HTTP_PATH_MAX 96
+#define HTTP_POLL_INTERVAL 4 // tcp_poll units of 500 ms
+#define HTTP_MAX_API_ROUTES 4
+#define HTTP_API_BODY_SIZE 1536
+
+// =============================================================================
+// PRIVATE TYPES
+// =============================================================================
+
+typedef struct
+{
+    struct tcp_pcb *pcb;
+    bool in_use;
+    bool close_after_response;
+    http_parser_t parser;
+    struct pbuf *pending; // Received data not yet parsed (pipelined requests)
+    u16_t pending_offset; // Bytes of pending already consumed
+    const uint8_t *body;
+    uint32_t body_remaining;
+    uint32_t last_activity;
+} http_connection_t;
+
+typedef struct
+{
+    const char *path;
+    web_api_handler_t handler;
+} http_api_route_t;
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static struct tcp_pcb *http_server_pcb = NULL;
+static http_connection_t connections[HTTP_MAX_CONCURRENT_CONNECTIONS];
+static web_server_stats_t http_stats = {};
+static bool http_server_initialized = false;
+static http_api_route_t api_routes[HTTP_MAX_API_ROUTES];
+static size_t api_route_count = 0;
+static char api_body[HTTP_API_BODY_SIZE];
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static err_t http_accept(void *arg, struct tcp_pcb *newpcb, err_t err);
+static err_t http_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
+static err_t http_sent(void *arg, struct tcp_pcb *tpcb, u16_t len);
+static err_t http_poll(void *arg, struct tcp_pcb *tpcb);
+static void http_err(void *arg, err_t err);
+static bool http_process_requests(http_connection_t *conn);
+static void http_respond(http_connection_t *conn, const http_parser_t *req);
+static bool http_send_error(http_connection_t *conn, int code);
+static bool http_send_api(http_connection_t *conn, const http_api_route_t *route, bool head_only);
+static const http_api_route_t *find_api_route(const char *path);
+static bool http_send_body(http_connection_t *conn);
+static const web_asset_t *find_asset(const char *path);
+static err_t http_close(http_connection_t *conn);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+bool web_server_init(void)
+{
+    if (http_server_initialized)
+    {
+        return true;
+    }
+
+    memset(connections, 0, sizeof(connections));
+
+    cyw43_arch_lwip_begin();
+    struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    err_t err = ERR_MEM;
+    if (pcb)
+    {
+        err = tcp_bind(pcb, IP_ANY_TYPE, NET_HTTP_PORT);
+    }
+    if (err == ERR_OK)
+    {
+        http_server_pcb = tcp_listen_with_backlog(pcb, HTTP_MAX_CONCURRENT_CONNECTIONS);
+        if (http_server_pcb)
+        {
+            tcp_accept(http_server_pcb, http_accept);
+        }
+        else
+        {
+            tcp_close(pcb);
+        }
+    }
+    else if (pcb)
+    {
+        tcp_close(pcb);
+    }
+    cyw43_arch_lwip_end();
+
+    if (http_server_pcb == NULL)
+    {
+        printf("[HTTP] Failed to listen on port %d: %d\n", NET_HTTP_PORT, err);
+        return false;
+    }
+
+    http_server_initialized = true;
+    printf("[HTTP] Server started on port %d (%u assets in flash)\n", NET_HTTP_PORT, (unsigned)web_assets_count);
+    return true;
+}
+
+void web_server_stop(void)
+{
+    if (!http_server_initialized)
+    {
+        return;
+    }
+
+    // The receive, sent and poll callbacks use the same slots and pcbs
+    cyw43_arch_lwip_begin();
+    for (int i = 0; i < HTTP_MAX_CONCURRENT_CONNECTIONS; i++)
+    {
+        if (connections[i].in_use)
+        {
+            http_close(&connections[i]);
+        }
+    }
+
+    if (http_server_pcb)
+    {
+        tcp_close(http_server_pcb);
+        http_server_pcb = NULL;
+    }
+    cyw43_arch_lwip_end();
+
+    http_server_initialized = false;
+    printf("[HTTP] Server stopped\n");
+}
+
+void web_server_get_stats(web_server_stats_t *stats)
+{
+    if (stats)
+    {
+        *stats = http_stats;
+    }
+}
+
+bool web_server_register_api(const char *path, web_api_handler_t handler)
+{
+    if (path == NULL || handler == NULL || api_route_count >= HTTP_MAX_API_ROUTES)
+    {
+        printf("[HTTP] Cannot register API route %s\n", path ? path : "(null)");
+        return false;
+    }
+
+    api_routes[api_route_count].path = path;
+    api_routes[api_route_count].handler = handler;
+    api_route_count++;
+    return true;
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static err_t http_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
+{
+    if (err != ERR_OK || newpcb == NULL)
+    {
+        return ERR_VAL;
+    }
+
+    http_connection_t *conn = NULL;
+    for (int i = 0; i < HTTP_MAX_CONCURRENT_CONNECTIONS; i++)
+    {
+        if (!connections[i].in_use)
+        {
+            conn = &connections[i];
+            break;
+        }
+    }
+
+    if (conn == NULL)
+    {
+        http_stats.connections_rejected++;
+        tcp_abort(newpcb);
+        return ERR_ABRT;
+    }
+
+    memset(conn, 0, sizeof(*conn));
+    conn->pcb = newpcb;
+    conn->in_use = true;
+    conn->last_activity = to_ms_since_boot(get_absolute_time());
+    http_parser_init(&conn->parser);
+    http_stats.connections_accepted++;
+
+    tcp_arg(newpcb, conn);
+    tcp_recv(newpcb, http_recv);
+    tcp_sent(newpcb, http_sent);
+    tcp_err(newpcb, http_err);
+    tcp_poll(newpcb, http_poll, HTTP_POLL_INTERVAL);
+
+    return ERR_OK;
+}
+
+static err_t http_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
+{
+    http_connection_t *conn = (http_connection_t *)arg;
+
+    if (err != ERR_OK || conn == NULL)
+    {
+        if (p)
+            pbuf_free(p);
+        return err;
+    }
+
+    if (p == NULL)
+    {
+        // Remote side closed the connection
+        return http_close(conn);
+    }
+
+    conn->last_activity = to_ms_since_boot(get_absolute_time());
+    tcp_recved(tpcb, p->tot_len);
+
+    // Keep the pbuf chain itself rather than copying it out; the parser walks
+    // it in place and it is released as soon as every byte has been consumed
+    if (conn->pending == NULL)
+    {
+        conn->pending = p;
+        conn->pending_offset = 0;
+    }
+    else if ((uint32_t)conn->pending->tot_len + p->tot_len > HTTP_PARSER_MAX_HEADER_BYTES)
+    {
+        // Client is pipelining faster than we can answer
+        pbuf_free(p);
+        return http_close(conn);
+    }
+    else
+    {
+        pbuf_cat(conn->pending, p);
+    }
+
+    // Requests arriving while a body is still streaming wait until it is done
+    if (conn->body_remaining == 0)
+    {
+        if (!http_process_requests(conn))
+        {
+            return ERR_ABRT;
+        }
+    }
+
+    return ERR_OK;
+}
+
+static err_t http_sent(void *arg, struct tcp_pcb *tpcb, u16_t len)
+{
+    http_connection_t *conn = (http_connection_t *)arg;
+    if (conn == NULL)
+    {
+        return ERR_OK;
+    }
+
+    conn->last_activity = to_ms_since_boot(get_absolute_time());
+
+    if (conn->body_remaining > 0)
+    {
+        http_send_body(conn);
+        return ERR_OK;
+    }
+
+    // Response fully queued; wait for the last bytes to be acknowledged before closing
+    if (conn->close_after_response)
+    {
+        if (tcp_sndqueuelen(tpcb) == 0)
+        {
+            return http_close(conn);
+        }
+        return ERR_OK;
+    }
+
+    // Keep-alive: serve any pipelined request that arrived meanwhile
+    return http_process_requests(conn) ? ERR_OK : ERR_ABRT;
+}
+
+static err_t http_poll(void *arg, struct tcp_pcb *tpcb)
+{
+    http_connection_t *conn = (http_connection_t *)arg;
+    if (conn == NULL)
+    {
+        return ERR_OK;
+    }
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    uint32_t limit = (conn->body_remaining > 0) ? HTTP_TIMEOUT_MS : HTTP_KEEPALIVE_TIMEOUT_MS;
+    if (now - conn->last_activity > limit)
+    {
+        return http_close(conn);
+    }
+
+    // Retry a body that stalled on a full send queue
+    if (conn->body_remaining > 0)
+    {
+        http_send_body(conn);
+    }
+
+    return ERR_OK;
+}
+
+static void http_err(void *arg, err_t err)
+{
+    http_connection_t *conn = (http_connection_t *)arg;
+
+    // The PCB has already been freed by lwIP
+    if (conn)
+    {
+        conn->pcb = NULL;
+        conn->in_use = false;
+        if (conn->pending)
+        {
+            pbuf_free(conn->pending);
+            conn->pending = NULL;
+        }
+    }
+}
+
+static bool http_process_requests(http_connection_t *conn)
+{
+    while (conn->in_use && conn->pending != NULL && conn->body_remaining == 0 && !conn->close_after_response)
+    {
+        http_parse_status_t status = HTTP_PARSE_INCOMPLETE;
+        u16_t offset = 0;
+        struct pbuf *q = pbuf_skip(conn->pending, conn->pending_offset, &offset);
+
+        for (; q != NULL && status == HTTP_PARSE_INCOMPLETE; q = q->next, offset = 0)
+        {
+            size_t used = 0;
+            status = http_parser_feed(&conn->parser, (const uint8_t *)q->payload + offset, q->len - offset, &used);
+            conn->pending_offset += (u16_t)used;
+        }
+
+        if (conn->pending_offset >= conn->pending->tot_len)
+        {
+            pbuf_free(conn->pending);
+            conn->pending = NULL;
+            conn->pending_offset = 0;
+        }
+
+        if (status == HTTP_PARSE_INCOMPLETE)
+        {
+            break; // Need more data; parser state carries over
+        }
+
+        http_stats.requests++;
+        if (status == HTTP_PARSE_ERROR)
+        {
+            conn->close_after_response = true;
+            http_send_error(conn, http_parse_error_status(conn->parser.error));
+            break;
+        }
+
+        conn->close_after_response = !http_parser_keep_alive(&conn->parser);
+        http_respond(conn, &conn->parser);
+        http_parser_init(&conn->parser);
+    }
+
+    return conn->in_use;
+}
+
+static void http_respond(http_connection_t *conn, const http_parser_t *req)
+{
+    bool head_only = req->method == HTTP_METHOD_HEAD;
+    if (req->method != HTTP_METHOD_GET && !head_only)
+    {
+        http_send_error(conn, 405);
+        return;
+    }
+
+    char path[HTTP_PATH_MAX];
+    if (!http_parser_path(req, path, sizeof(path)))
+    {
+        http_send_error(conn, 404);
+        return;
+    }
+
+    const http_api_route_t *route = find_api_route(path);
+    if (route != NULL)
+    {
+        http_send_api(conn, route, head_only);
+        return;
+    }
+
+    const web_asset_t *asset = find_asset(path);
+    if (asset == NULL)
+    {
+        http_send_error(conn, 404);
+        return;
+    }
+
+    if (asset->gzip && !http_header_has_token(http_parser_header(req, HTTP_HEADER_ACCEPT_ENCODING), "gzip"))
+    {
+        // Assets are only stored compressed; every browser we target accepts gzip
+        http_send_error(conn, 406);
+        return;
+    }
+
+    const char *if_none_match = http_parser_header(req, HTTP_HEADER_IF_NONE_MATCH);
+    bool not_modified = if_none_match != NULL && strstr(if_none_match, asset->etag) != NULL;
+
+    char header[HTTP_HEADER_BUFFER_SIZE];
+    int header_len;
+    if (not_modified)
+    {
+        header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 304 Not Modified\r\n"
+                              "ETag: %s\r\n"
+                              "Cache-Control: no-cache\r\n"
+                              "Connection: %s\r\n"
+                              "\r\n",
+                              asset->etag, conn->close_after_response ? "close" : "keep-alive");
+        http_stats.responses_304++;
+    }
+    else
+    {
+        header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 200 OK\r\n"
+                              "Content-Type: %s\r\n"
+                              "Content-Length: %lu\r\n"
+                              "%s"
+                              "Vary: Accept-Encoding\r\n"
+                              "ETag: %s\r\n"
+                              "Cache-Control: no-cache\r\n"
+                              "Connection: %s\r\n"
+                              "\r\n",
+                              asset->content_type, (unsigned long)asset->length,
+                              asset->gzip ? "Content-Encoding: gzip\r\n" : "",
+                              asset->etag, conn->close_after_response ? "close" : "keep-alive");
+        http_stats.responses_200++;
+    }
+
+    if (header_len <= 0 || header_len >= (int)sizeof(header) ||
+        tcp_write(conn->pcb, header, (u16_t)header_len, TCP_WRITE_FLAG_COPY) != ERR_OK)
+    {
+        conn->close_after_response = true;
+        return;
+    }
+
+    if (!not_modified && !head_only)
+    {
+        conn->body = asset->data;
+        conn->body_remaining = asset->length;
+        http_send_body(conn);
+    }
+    else
+    {
+        tcp_output(conn->pcb);
+    }
+}
+
+static bool http_send_error(http_connection_t *conn, int code)
+{
+    const char *reason = code == 404   ? "Not Found"
+                         : code == 405 ? "Method Not Allowed"
+                         : code == 406 ? "Not Acceptable"
+                         : code == 414 ? "URI Too Long"
+                         : code == 431 ? "Request Header Fields Too Large"
+                                       : "Bad Request";
+    char response[HTTP_HEADER_BUFFER_SIZE];
+    int body_len = (int)strlen(reason);
+    int len = snprintf(response, sizeof(response),
+                       "HTTP/1.1 %d %s\r\n"
+                       "Content-Type: text/plain\r\n"
+                       "Content-Length: %d\r\n"
+                       "Connection: %s\r\n"
+                       "\r\n"
+                       "%s",
+                       code, reason, body_len, conn->close_after_response ? "close" : "keep-alive", reason);
+
+    http_stats.responses_4xx++;
+    if (len <= 0 || len >= (int)sizeof(response) ||
+        tcp_write(conn->pcb, response, (u16_t)len, TCP_WRITE_FLAG_COPY) != ERR_OK)
+    {
+        return false;
+    }
+
+    tcp_output(conn->pcb);
+    return true;
+}
+
+static bool http_send_api(http_connection_t *conn, const http_api_route_t *route, bool head_only)
+{
+    size_t body_len = route->handler(api_body, sizeof(api_body));
+    if (body_len == 0 || body_len >= sizeof(api_body))
+    {
+        body_len = (size_t)snprintf(api_body, sizeof(api_body), "{\"error\":\"unavailable\"}");
+    }
+
+    char header[HTTP_HEADER_BUFFER_SIZE];
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 200 OK\r\n"
+                              "Content-Type: application/json\r\n"
+                              "Content-Length: %lu\r\n"
+                              "Cache-Control: no-store\r\n"
+                              "Connection: %s\r\n"
+                              "\r\n",
+                              (unsigned long)body_len, conn->close_after_response ? "close" : "keep-alive");
+
+    if (header_len <= 0 || header_len >= (int)sizeof(header) ||
+        tcp_write(conn->pcb, header, (u16_t)header_len, TCP_WRITE_FLAG_COPY) != ERR_OK)
+    {
+        conn->close_after_response = true;
+        return false;
+    }
+
+    // The body buffer is shared, so it is copied into the send queue right away
+    if (!head_only && tcp_write(conn->pcb, api_body, (u16_t)body_len, TCP_WRITE_FLAG_COPY) != ERR_OK)
+    {
+        conn->close_after_response = true;
+        return false;
+    }
+
+    http_stats.responses_200++;
+    if (!head_only)
+    {
+        http_stats.body_bytes_sent += body_len;
+    }
+    tcp_output(conn->pcb);
+    return true;
+}
+
+static const http_api_route_t *find_api_route(const char *path)
+{
+    for (size_t i = 0; i < api_route_count; i++)
+    {
+        if (strcmp(api_routes[i].path, path) == 0)
+        {
+            return &api_routes[i];
+        }
+    }
+
+    return NULL;
+}
+
+static bool http_send_body(http_connection_t *conn)
+{
+    struct tcp_pcb *pcb = conn->pcb;
+    u16_t mss = tcp_mss(pcb);
+
+    while (conn->body_remaining > 0 && tcp_sndqueuelen(pcb) < TCP_SND_QUEUELEN)
+    {
+        u16_t space = tcp_sndbuf(pcb);
+        if (space == 0)
+        {
+            break;
+        }
+
+        uint32_t chunk = conn->body_remaining;
+        if (chunk > mss)
+            chunk = mss;
+        if (chunk > space)
+            chunk = space;
+
+        // Asset data lives in flash for the life of the firmware, so lwIP can
+        // reference it directly instead of copying into pbuf RAM.
+        u8_t flags = (conn->body_remaining > chunk) ? TCP_WRITE_FLAG_MORE : 0;
+        if (tcp_write(pcb, conn->body, (u16_t)chunk, flags) != ERR_OK)
+        {
+            break; // Out of segments; resume from the sent/poll callback
+        }
+
+        conn->body += chunk;
+        conn->body_remaining -= chunk;
+        http_stats.body_bytes_sent += chunk;
+    }
+
+    tcp_output(pcb);
+    return conn->body_remaining == 0;
+}
+
+static const web_asset_t *find_asset(const char *path)
+{
+    size_t low = 0;
+    size_t high = web_assets_count;
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        int cmp = strcmp(path, web_assets[mid].path);
+        if (cmp == 0)
+        {
+            return &web_assets[mid];
+        }
+        if (cmp < 0)
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
+    }
+
+    return NULL;
+}
+
+static err_t http_close(http_connection_t *conn)
+{
+    struct tcp_pcb *pcb = conn->pcb;
+    conn->in_use = false;
+    conn->pcb = NULL;
+    conn->body_remaining = 0;
+
+    if (conn->pending)
+    {
+        pbuf_free(conn->pending);
+        conn->pending = NULL;
+    }
+
+    if (pcb == NULL)
+    {
+        return ERR_OK;
+    }
+
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0);
+
+    if (tcp_close(pcb) != ERR_OK)
+    {
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+
+    return ERR_OK;
+}
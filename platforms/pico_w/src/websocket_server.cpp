@@ -3,10 +3,33 @@
  * @brief Simplified WebSocket server implementation for Raspberry Pi Pico W
  *
  * This is a simplified version that works with lwIP and focuses on basic functionality.
+ *
+ * Client frames are decoded incrementally straight from the received pbufs,
+ * so a frame may span any number of segments. Every slot tracks when it last
+ * heard from its peer; idle clients are pinged and, if they stay silent,
+ * evicted so a browser that vanished without a FIN cannot hold a slot.
+ *
+ * The encoding of structured messages is negotiated per client through
+ * Sec-WebSocket-Protocol; broadcasts are composed once for each encoding
+ * that has a listener.
+ *
+ * Clients may also negotiate permessage-deflate. Each keeps the last 1 KiB
+ * it was sent as the compression dictionary, so a repeated log prefix or
+ * status layout costs a few bytes after the first time; the match finder
+ * and buffers are shared. Inbound messages are compressed one at a time
+ * (client_no_context_takeover), so no window is kept for them.
  */
 
 #include "../include/websocket_server.h"
 #include "../include/board_config.h"
+#include "../include/time_sync.h"
+#include "http_parser.h"
+#include "websocket_handshake.h"
+#include "hal_interface.h"
+#include "json_writer.h"
+#include "json_reader.h"
+#include "cbor_json.h"
+#include "deflate.h"
 
 // lwIP includes for networking
 #include "lwip/tcp.h"
@@ -14,6 +37,7 @@
 #include "lwip/err.h"
 #include "lwip/sys.h"
 #include "lwip/altcp.h"
+#include "pico/cyw43_arch.h"
 
 #include <cstring>
 #include <cstdio>
@@ -22,21 +46,71 @@
 // PRIVATE CONSTANTS
 // =============================================================================
 
-#define MAX_WEBSOCKET_CLIENTS 4
-#define WEBSOCKET_BUFFER_SIZE 512
+#define MAX_WEBSOCKET_CLIENTS WEBSOCKET_MAX_CLIENTS
+#define WEBSOCKET_RX_BUFFER_SIZE 1024 // Largest reassembled client message (command batches)
+#define WEBSOCKET_CONTROL_MAX 125    // RFC 6455 limit for control payloads
+#define WEBSOCKET_HANDSHAKE_TIMEOUT_MS HTTP_KEEPALIVE_TIMEOUT_MS
 #define HTTP_RESPONSE_SIZE 1024
+#define WEBSOCKET_CBOR_TEXT_SIZE (WEBSOCKET_RX_BUFFER_SIZE * 2) // A CBOR command converted to JSON text
+#define WEBSOCKET_LOG_PAYLOAD_SIZE 384 // Log frames; longer messages are cut and flagged
+#define WEBSOCKET_LOG_TAIL_RESERVE 20  // Room after the message for ,"truncated":true}
+#define WEBSOCKET_LOG_SNDBUF_RESERVE (TCP_SND_BUF / 2) // Send buffer logs leave for telemetry and replies
+#define WEBSOCKET_DEFLATE_MAX_MESSAGE 1024           // Larger messages are sent uncompressed
+#define WEBSOCKET_EXTENSIONS_SIZE 112                // Sec-WebSocket-Extensions response value
+
+// Close status codes (RFC 6455 section 7.4.1)
+#define WS_CLOSE_NORMAL 1000
+#define WS_CLOSE_PROTOCOL_ERROR 1002
+#define WS_CLOSE_TOO_BIG 1009
+
+// Frame decoder states
+#define WS_RX_HEADER 0
+#define WS_RX_PAYLOAD 1
 
 // =============================================================================
 // PRIVATE TYPES
 // =============================================================================
 
+typedef struct
+{
+    uint8_t state;
+    uint8_t header[14]; // Largest header: 2 + 8 (length) + 4 (mask)
+    uint8_t header_len;
+    uint8_t header_need;
+    uint8_t opcode;
+    bool fin;
+    uint8_t mask[4];
+    uint32_t payload_len;
+    uint32_t payload_pos;
+    uint8_t message_opcode; // Opcode of the message being reassembled, 0 if none
+    bool message_compressed; // RSV1 was set on its first frame
+    size_t message_len;
+    uint8_t message[WEBSOCKET_RX_BUFFER_SIZE + 1]; // +1 for a NUL terminator
+    uint8_t control[WEBSOCKET_CONTROL_MAX];
+} websocket_rx_t;
+
 typedef struct
 {
     struct tcp_pcb *pcb;
     bool connected;
     bool websocket_handshake_complete;
+    // The request parser is only needed until the upgrade, the frame decoder
+    // only after it, so they share storage
+    union
+    {
+        http_parser_t handshake;
+        websocket_rx_t rx;
+    };
     char client_ip[16];
-    uint32_t last_activity;
+    uint32_t connected_at;
+    uint32_t last_activity; // Last time any byte arrived from the peer
+    bool ping_outstanding;
+    uint32_t ping_sent_at;
+    uint8_t format; // json_format_t negotiated at the upgrade
+    bool deflate;       // permessage-deflate negotiated
+    bool deflate_reset; // Client asked for server_no_context_takeover
+    uint16_t deflate_history_len;
+    uint8_t deflate_history[DEFLATE_WINDOW_SIZE]; // Tail of what this client has inflated so far
 } websocket_client_t;
 
 // =============================================================================
@@ -46,9 +120,28 @@ typedef struct
 static struct tcp_pcb *websocket_server_pcb = NULL;
 static websocket_client_t clients[MAX_WEBSOCKET_CLIENTS];
 static bool server_initialized = false;
+static websocket_server_stats_t server_stats = {};
+
+// Last pcb handed to tcp_abort: a receive callback whose pcb was aborted
+// while it ran must return ERR_ABRT, and only then
+static struct tcp_pcb *aborted_pcb = NULL;
+
+// Inbound CBOR commands are converted here; only used from the receive callback
+static char cbor_text[WEBSOCKET_CBOR_TEXT_SIZE];
+
+// Outbound compression scratch, shared by all clients. Only used under the
+// lwIP lock (send_prepared), which also serializes each client's history.
+static deflate_compressor_t deflate_state;
+static uint8_t deflate_input[DEFLATE_WINDOW_SIZE + WEBSOCKET_DEFLATE_MAX_MESSAGE];
+static uint8_t deflate_frame[WEBSOCKET_FRAME_HEADROOM + WEBSOCKET_DEFLATE_MAX_MESSAGE];
+
+// Inbound compressed messages are inflated here; only used from the receive callback
+static deflate_decompressor_t inflate_state;
+static uint8_t inflate_message[WEBSOCKET_RX_BUFFER_SIZE + 1];
 
 // Callback function pointers
 static websocket_command_callback_t command_callback = NULL;
+static websocket_message_callback_t message_callback = NULL;
 static websocket_client_callback_t client_callback = NULL;
 
 // =============================================================================
@@ -59,9 +152,29 @@ static err_t websocket_accept(void *arg, struct tcp_pcb *newpcb, err_t err);
 static err_t websocket_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
 static void websocket_err(void *arg, err_t err);
 static err_t websocket_sent(void *arg, struct tcp_pcb *tpcb, u16_t len);
-static bool handle_http_request(struct tcp_pcb *pcb, const char *request);
-static bool handle_websocket_frame(int client_index, const char *data, size_t len);
-static void send_websocket_response(struct tcp_pcb *pcb, const char *key);
+static bool handle_http_request(struct tcp_pcb *pcb, const http_parser_t *request);
+static void send_http_error(struct tcp_pcb *pcb, int status);
+static err_t close_client(int client_index);
+static bool decode_frames(int client_index, const uint8_t *data, size_t len);
+static bool handle_frame(int client_index);
+static void handle_websocket_message(int client_index, char *text, size_t len);
+static bool parse_command_message(const char *text, size_t len, char *command, size_t command_size,
+                                  char *params, size_t params_size);
+static void send_close_frame(int client_index, uint16_t code);
+static void abort_client(int client_index);
+static int find_reclaimable_slot(uint32_t now);
+static bool send_websocket_response(struct tcp_pcb *pcb, const char *key, const char *protocol,
+                                    const char *extensions);
+static json_format_t negotiate_format(const http_parser_t *request, const char **protocol);
+static bool format_in_use(json_format_t format);
+static bool send_websocket_frame(int client_index, uint8_t opcode, const uint8_t *payload, size_t len);
+static bool write_websocket_frame(struct tcp_pcb *pcb, uint8_t opcode, const uint8_t *payload, size_t len);
+static bool send_prepared(int client_id, uint8_t *frame, size_t len, json_format_t format, size_t keep_free);
+static bool send_prepared_frame(int client_index, uint8_t *frame, size_t len, json_format_t format,
+                                size_t keep_free);
+static bool queue_prepared_frame(struct tcp_pcb *pcb, uint8_t *frame, size_t len, uint8_t first_byte,
+                                 size_t keep_free);
+static bool is_client_ready(int client_index);
 static int find_free_client_slot(void);
 static int find_client_by_pcb(struct tcp_pcb *pcb);
 static void cleanup_client_slot(int index);
@@ -78,14 +191,9 @@ bool websocket_server_init(void)
     }
 
     // Initialize client slots
-    for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++)
-    {
-        clients[i].pcb = NULL;
-        clients[i].connected = false;
-        clients[i].websocket_handshake_complete = false;
-        memset(clients[i].client_ip, 0, sizeof(clients[i].client_ip));
-        clients[i].last_activity = 0;
-    }
+    memset(clients, 0, sizeof(clients));
+    memset(&server_stats, 0, sizeof(server_stats));
+    server_stats.slots_total = MAX_WEBSOCKET_CLIENTS;
 
     // Create TCP PCB for the server
     websocket_server_pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
@@ -131,19 +239,50 @@ void websocket_server_update(void)
         return;
     }
 
-    // Check for inactive clients and clean them up
-    uint32_t current_time = 0; // You'd get this from your timer system
+    uint32_t now = hal_get_tick_ms();
 
+    // Evictions and pings touch the pcbs the receive callbacks use
+    cyw43_arch_lwip_begin();
     for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++)
     {
-        if (clients[i].connected && clients[i].pcb)
+        websocket_client_t *client = &clients[i];
+        if (!client->connected || client->pcb == NULL)
         {
-            // Check for timeout (simplified)
-            // if (current_time - clients[i].last_activity > WEBSOCKET_TIMEOUT_MS) {
-            //     cleanup_client_slot(i);
-            // }
+            continue;
+        }
+
+        if (!client->websocket_handshake_complete)
+        {
+            // Never upgraded (port scanner, stalled request): free the slot quickly
+            if (now - client->connected_at > WEBSOCKET_HANDSHAKE_TIMEOUT_MS)
+            {
+                printf("[WEBSOCKET] Client %d handshake timed out\n", i);
+                server_stats.handshake_timeouts++;
+                abort_client(i);
+            }
+            continue;
+        }
+
+        uint32_t idle = now - client->last_activity;
+        if (idle >= WEBSOCKET_TIMEOUT_MS)
+        {
+            // The peer ignored at least one ping; it is gone without a FIN
+            printf("[WEBSOCKET] Client %d idle for %lu ms, evicting\n", i, (unsigned long)idle);
+            server_stats.idle_evictions++;
+            abort_client(i);
+        }
+        else if (idle >= WEBSOCKET_PING_INTERVAL_MS && !client->ping_outstanding)
+        {
+            uint8_t payload[4] = {(uint8_t)(now >> 24), (uint8_t)(now >> 16), (uint8_t)(now >> 8), (uint8_t)now};
+            if (send_websocket_frame(i, WS_MSG_PING, payload, sizeof(payload)))
+            {
+                client->ping_outstanding = true;
+                client->ping_sent_at = now;
+                server_stats.pings_sent++;
+            }
         }
     }
+    cyw43_arch_lwip_end();
 }
 
 void websocket_server_stop(void)
@@ -154,12 +293,16 @@ void websocket_server_stop(void)
     }
 
     // Close all client connections
+    cyw43_arch_lwip_begin();
     for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++)
     {
-        if (clients[i].pcb)
+        if (clients[i].connected)
         {
-            tcp_close(clients[i].pcb);
-            cleanup_client_slot(i);
+            if (clients[i].websocket_handshake_complete)
+            {
+                send_close_frame(i, WS_CLOSE_NORMAL);
+            }
+            close_client(i);
         }
     }
 
@@ -169,6 +312,7 @@ void websocket_server_stop(void)
         tcp_close(websocket_server_pcb);
         websocket_server_pcb = NULL;
     }
+    cyw43_arch_lwip_end();
 
     server_initialized = false;
     printf("[WEBSOCKET] Server stopped\n");
@@ -179,6 +323,11 @@ void websocket_register_command_callback(websocket_command_callback_t callback)
     command_callback = callback;
 }
 
+void websocket_register_message_callback(websocket_message_callback_t callback)
+{
+    message_callback = callback;
+}
+
 void websocket_register_client_callback(websocket_client_callback_t callback)
 {
     client_callback = callback;
@@ -191,21 +340,50 @@ void websocket_send_log(const char *level, const char *category, const char *mes
         return;
     }
 
-    char json_msg[256];
-    snprintf(json_msg, sizeof(json_msg),
-             "{\"type\":\"log\",\"level\":\"%s\",\"category\":\"%s\",\"message\":\"%s\"}",
-             level, category, message);
-
-    // Send to all connected WebSocket clients
-    for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++)
+    // The message is written straight into the frame, escaped; composed
+    // once per encoding that has a listener
+    uint8_t frame[WEBSOCKET_FRAME_HEADROOM + WEBSOCKET_LOG_PAYLOAD_SIZE];
+    size_t message_len = message ? strlen(message) : 0;
+    bool host_time = false;
+    uint64_t timestamp_us = time_sync_now_us(&host_time);
+
+    // Held across composing and sending, so the set of formats in use
+    // cannot change between the two
+    cyw43_arch_lwip_begin();
+    for (int format = JSON_FORMAT_TEXT; format <= JSON_FORMAT_CBOR; format++)
     {
-        if (clients[i].connected && clients[i].websocket_handshake_complete && clients[i].pcb)
+        if (!format_in_use((json_format_t)format))
+        {
+            continue;
+        }
+
+        json_writer_t w;
+        json_writer_init_format(&w, (char *)frame + WEBSOCKET_FRAME_HEADROOM, WEBSOCKET_LOG_PAYLOAD_SIZE,
+                                (json_format_t)format);
+
+        json_begin_object(&w);
+        json_kv_string(&w, "type", "log");
+        json_kv_string(&w, "level", level);
+        json_kv_string(&w, "category", category);
+        json_key(&w, "ts"); // Unix microseconds when synced, else microseconds since boot
+        json_uint64(&w, timestamp_us);
+        json_kv_bool(&w, "synced", host_time);
+        json_key(&w, "message");
+        if (json_string_fit(&w, message ? message : "", message_len, WEBSOCKET_LOG_TAIL_RESERVE) < message_len)
+        {
+            json_kv_bool(&w, "truncated", true);
+        }
+        json_end_object(&w);
+
+        // Logs may only use the first half of the send buffer, so a burst
+        // of them over a slow link cannot crowd out telemetry
+        size_t len = json_writer_finish(&w);
+        if (len > 0)
         {
-            // Send WebSocket frame (simplified)
-            tcp_write(clients[i].pcb, json_msg, strlen(json_msg), TCP_WRITE_FLAG_COPY);
-            tcp_output(clients[i].pcb);
+            send_prepared(-1, frame, len, (json_format_t)format, WEBSOCKET_LOG_SNDBUF_RESERVE);
         }
     }
+    cyw43_arch_lwip_end();
 }
 
 void websocket_send_channel_data(int channel, float voltage, float current)
@@ -215,20 +393,137 @@ void websocket_send_channel_data(int channel, float voltage, float current)
         return;
     }
 
-    char json_msg[128];
-    snprintf(json_msg, sizeof(json_msg),
-             "{\"type\":\"channel_data\",\"channel\":%d,\"voltage\":%.2f,\"current\":%.3f}",
-             channel, voltage, current);
+    uint8_t frame[WEBSOCKET_FRAME_HEADROOM + 96];
 
-    // Send to all connected WebSocket clients
-    for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++)
+    for (int format = JSON_FORMAT_TEXT; format <= JSON_FORMAT_CBOR; format++)
+    {
+        if (!format_in_use((json_format_t)format))
+        {
+            continue;
+        }
+
+        json_writer_t w;
+        json_writer_init_format(&w, (char *)frame + WEBSOCKET_FRAME_HEADROOM, sizeof(frame) - WEBSOCKET_FRAME_HEADROOM,
+                                (json_format_t)format);
+
+        json_begin_object(&w);
+        json_kv_string(&w, "type", "channel_data");
+        json_kv_int(&w, "channel", channel);
+        json_kv_float(&w, "voltage", voltage, 2);
+        json_kv_float(&w, "current", current, 3);
+        json_end_object(&w);
+
+        size_t len = json_writer_finish(&w);
+        if (len > 0)
+        {
+            websocket_send_prepared(-1, frame, len, (json_format_t)format);
+        }
+    }
+}
+
+bool websocket_send_prepared(int client_id, uint8_t *frame, size_t len, json_format_t format)
+{
+    if (!server_initialized || frame == NULL)
+    {
+        return false;
+    }
+
+    return send_prepared(client_id, frame, len, format, 0);
+}
+
+json_format_t websocket_client_format(int client_id)
+{
+    if (client_id < 0 || client_id >= MAX_WEBSOCKET_CLIENTS)
+    {
+        return JSON_FORMAT_TEXT;
+    }
+    return (json_format_t)clients[client_id].format;
+}
+
+bool websocket_send_text(int client_id, const char *text)
+{
+    if (!server_initialized || text == NULL)
+    {
+        return false;
+    }
+
+    size_t len = strlen(text);
+
+    cyw43_arch_lwip_begin();
+    bool sent = false;
+    if (client_id >= 0)
+    {
+        sent = is_client_ready(client_id) &&
+               send_websocket_frame(client_id, WS_MSG_TEXT, (const uint8_t *)text, len);
+    }
+    else
+    {
+        // Broadcast to all connected WebSocket clients
+        for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++)
+        {
+            if (is_client_ready(i))
+            {
+                sent |= send_websocket_frame(i, WS_MSG_TEXT, (const uint8_t *)text, len);
+            }
+        }
+    }
+    cyw43_arch_lwip_end();
+    return sent;
+}
+
+bool websocket_send_binary(int client_id, const uint8_t *data, size_t len)
+{
+    if (!server_initialized || data == NULL)
+    {
+        return false;
+    }
+
+    cyw43_arch_lwip_begin();
+    bool sent = true;
+    if (client_id >= 0)
+    {
+        sent = is_client_ready(client_id) && send_websocket_frame(client_id, WS_MSG_BINARY, data, len);
+    }
+    else
     {
-        if (clients[i].connected && clients[i].websocket_handshake_complete && clients[i].pcb)
+        // Unlike text, a binary message is usually a delta: one client missing it is a failure
+        for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++)
         {
-            tcp_write(clients[i].pcb, json_msg, strlen(json_msg), TCP_WRITE_FLAG_COPY);
-            tcp_output(clients[i].pcb);
+            if (is_client_ready(i))
+            {
+                sent &= send_websocket_frame(i, WS_MSG_BINARY, data, len);
+            }
         }
     }
+    cyw43_arch_lwip_end();
+    return sent;
+}
+
+bool websocket_client_is_ready(int client_id)
+{
+    return server_initialized && is_client_ready(client_id);
+}
+
+void websocket_server_get_stats(websocket_server_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    server_stats.slots_in_use = 0;
+    server_stats.slots_ready = 0;
+    server_stats.slots_cbor = 0;
+    server_stats.slots_deflate = 0;
+    for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++)
+    {
+        server_stats.slots_in_use += clients[i].connected ? 1 : 0;
+        server_stats.slots_ready += is_client_ready(i) ? 1 : 0;
+        server_stats.slots_cbor += (is_client_ready(i) && clients[i].format == JSON_FORMAT_CBOR) ? 1 : 0;
+        server_stats.slots_deflate += (is_client_ready(i) && clients[i].deflate) ? 1 : 0;
+    }
+
+    *stats = server_stats;
 }
 
 // =============================================================================
@@ -242,26 +537,54 @@ static err_t websocket_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
         return ERR_VAL;
     }
 
-    // Find a free client slot
+    uint32_t now = hal_get_tick_ms();
+
+    // Find a free client slot, reclaiming a stale one if all are taken
     int client_index = find_free_client_slot();
     if (client_index == -1)
+    {
+        client_index = find_reclaimable_slot(now);
+        if (client_index != -1)
+        {
+            printf("[WEBSOCKET] Reclaiming stale client slot %d\n", client_index);
+            server_stats.slots_reclaimed++;
+            abort_client(client_index);
+        }
+    }
+    if (client_index == -1)
     {
         printf("[WEBSOCKET] No free client slots, rejecting connection\n");
-        tcp_close(newpcb);
-        return ERR_MEM;
+        server_stats.connections_rejected++;
+        tcp_abort(newpcb);
+        return ERR_ABRT;
     }
 
     // Set up client
-    clients[client_index].pcb = newpcb;
-    clients[client_index].connected = true;
-    clients[client_index].websocket_handshake_complete = false;
+    websocket_client_t *client = &clients[client_index];
+    memset(client, 0, sizeof(*client));
+    client->pcb = newpcb;
+    client->connected = true;
+    client->connected_at = now;
+    client->last_activity = now;
+    http_parser_init(&client->handshake);
+
+    server_stats.connections_accepted++;
+    uint8_t in_use = 0;
+    for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++)
+    {
+        in_use += clients[i].connected ? 1 : 0;
+    }
+    if (in_use > server_stats.peak_in_use)
+    {
+        server_stats.peak_in_use = in_use;
+    }
 
     // Get client IP (simplified)
     snprintf(clients[client_index].client_ip, sizeof(clients[client_index].client_ip),
              "%s", ipaddr_ntoa(&newpcb->remote_ip));
 
     // Set callbacks
-    tcp_arg(newpcb, (void *)(intptr_t)client_index);
+    tcp_arg(newpcb, client);
     tcp_recv(newpcb, websocket_recv);
     tcp_err(newpcb, websocket_err);
     tcp_sent(newpcb, websocket_sent);
@@ -279,74 +602,141 @@ static err_t websocket_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
 
 static err_t websocket_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
 {
-    int client_index = (int)(intptr_t)arg;
+    websocket_client_t *client = (websocket_client_t *)arg;
 
-    if (err != ERR_OK)
+    if (err != ERR_OK || client == NULL)
     {
         if (p)
             pbuf_free(p);
         return err;
     }
 
+    int client_index = (int)(client - clients);
+
     if (p == NULL)
     {
         // Connection closed
-        cleanup_client_slot(client_index);
-        return ERR_OK;
+        return close_client(client_index);
     }
 
-    // Copy data from pbuf
-    char buffer[WEBSOCKET_BUFFER_SIZE];
-    size_t len = pbuf_copy_partial(p, buffer, sizeof(buffer) - 1, 0);
-    buffer[len] = '\0';
-
-    // Free the pbuf
-    pbuf_free(p);
-
-    // Tell TCP that we've received the data
-    tcp_recved(tpcb, len);
+    // The whole chain is consumed either way, so open the window up front
+    tcp_recved(tpcb, p->tot_len);
+    aborted_pcb = NULL;
+    client->last_activity = hal_get_tick_ms();
 
-    // Handle the request
+    size_t offset = 0;
     if (!clients[client_index].websocket_handshake_complete)
     {
-        // This is an HTTP request for WebSocket upgrade
-        if (strstr(buffer, "Upgrade: websocket") != NULL)
+        // Walk the pbuf chain in place; the parser keeps its own state, so a
+        // header split across segments or receive callbacks just continues
+        http_parser_t *parser = &clients[client_index].handshake;
+        http_parse_status_t status = HTTP_PARSE_INCOMPLETE;
+
+        for (struct pbuf *q = p; q != NULL && status == HTTP_PARSE_INCOMPLETE; q = q->next)
         {
-            // Extract WebSocket key and send response
-            char *key_start = strstr(buffer, "Sec-WebSocket-Key:");
-            if (key_start)
-            {
-                key_start += 18; // Skip "Sec-WebSocket-Key:"
-                while (*key_start == ' ')
-                    key_start++; // Skip spaces
-                char *key_end = strstr(key_start, "\r\n");
-                if (key_end)
-                {
-                    *key_end = '\0';
-                    send_websocket_response(tpcb, key_start);
-                    clients[client_index].websocket_handshake_complete = true;
-                }
-            }
+            size_t used = 0;
+            status = http_parser_feed(parser, q->payload, q->len, &used);
+            offset += used;
         }
-        else
+
+        if (status == HTTP_PARSE_INCOMPLETE)
+        {
+            pbuf_free(p);
+            return ERR_OK;
+        }
+
+        if (status == HTTP_PARSE_ERROR)
+        {
+            printf("[WEBSOCKET] Client %d sent a malformed request\n", client_index);
+            pbuf_free(p);
+            send_http_error(tpcb, http_parse_error_status(parser->error));
+            return close_client(client_index);
+        }
+
+        if (!http_header_has_token(http_parser_header(parser, HTTP_HEADER_UPGRADE), "websocket"))
         {
             // Regular HTTP request
-            handle_http_request(tpcb, buffer);
+            pbuf_free(p);
+            handle_http_request(tpcb, parser);
+            return close_client(client_index);
+        }
+
+        const char *key = http_parser_header(parser, HTTP_HEADER_SEC_WEBSOCKET_KEY);
+        const char *version = http_parser_header(parser, HTTP_HEADER_SEC_WEBSOCKET_VERSION);
+        if (parser->method != HTTP_METHOD_GET || key == NULL ||
+            !http_header_has_token(http_parser_header(parser, HTTP_HEADER_CONNECTION), "upgrade"))
+        {
+            pbuf_free(p);
+            send_http_error(tpcb, 400);
+            return close_client(client_index);
         }
+        if (version == NULL || strcmp(version, "13") != 0)
+        {
+            pbuf_free(p);
+            send_http_error(tpcb, 426);
+            return close_client(client_index);
+        }
+
+        // Negotiated before rx reuses the parser's storage
+        const char *protocol = NULL;
+        json_format_t format = negotiate_format(parser, &protocol);
+        char extensions[WEBSOCKET_EXTENSIONS_SIZE];
+        bool deflate_reset = false;
+        bool deflate = WEBSOCKET_DEFLATE_ENABLED &&
+                       websocket_negotiate_deflate(http_parser_header(parser, HTTP_HEADER_SEC_WEBSOCKET_EXTENSIONS),
+                                                   DEFLATE_WINDOW_BITS, extensions, sizeof(extensions), &deflate_reset);
+        if (!send_websocket_response(tpcb, key, protocol, deflate ? extensions : NULL))
+        {
+            pbuf_free(p);
+            send_http_error(tpcb, 400);
+            return close_client(client_index);
+        }
+        client->websocket_handshake_complete = true;
+        client->format = (uint8_t)format;
+        client->deflate = deflate;
+        client->deflate_reset = deflate_reset;
+        client->deflate_history_len = 0;
+        memset(&client->rx, 0, sizeof(client->rx));
+        client->rx.header_need = 2;
+        // Frames pipelined behind the upgrade request fall through
     }
-    else
+
+    // Decode frames in place, segment by segment
+    u16_t skip = 0;
+    struct pbuf *q = pbuf_skip(p, (u16_t)offset, &skip);
+    for (; q != NULL; q = q->next, skip = 0)
     {
-        // This is a WebSocket frame
-        handle_websocket_frame(client_index, buffer, len);
+        if (!decode_frames(client_index, (const uint8_t *)q->payload + skip, q->len - skip))
+        {
+            pbuf_free(p);
+            return close_client(client_index);
+        }
+        if (!client->connected)
+        {
+            break; // Closed from a command handler
+        }
     }
+    pbuf_free(p);
 
+    if (!client->connected && aborted_pcb == tpcb)
+    {
+        return ERR_ABRT;
+    }
     return ERR_OK;
 }
 
 static void websocket_err(void *arg, err_t err)
 {
-    int client_index = (int)(intptr_t)arg;
+    websocket_client_t *client = (websocket_client_t *)arg;
+    if (client == NULL)
+    {
+        return;
+    }
+
+    // lwIP has already freed the PCB; only the slot needs releasing
+    int client_index = (int)(client - clients);
     printf("[WEBSOCKET] Error on client %d: %d\n", client_index, err);
+    client->pcb = NULL;
     cleanup_client_slot(client_index);
 }
 
@@ -356,52 +746,576 @@ static err_t websocket_sent(void *arg, struct tcp_pcb *tpcb, u16_t len)
     return ERR_OK;
 }
 
-static bool handle_http_request(struct tcp_pcb *pcb, const char *request)
+static bool handle_http_request(struct tcp_pcb *pcb, const http_parser_t *request)
 {
-    // Simple HTTP response for non-WebSocket requests
-    const char *response =
-        "HTTP/1.1 200 OK\r\n"
-        "Content-Type: text/html\r\n"
-        "Content-Length: 100\r\n"
-        "\r\n"
-        "<html><body><h1>Pico W Diagnostic Rig</h1><p>WebSocket server is running on port 8080</p></body></html>";
+    // The web UI is served by the HTTP server; point plain browsers there
+    const char *body = "Web UI is served on port 80\r\n";
+    char path[HTTP_PARSER_TARGET_SIZE];
+    if (!http_parser_path(request, path, sizeof(path)))
+    {
+        strcpy(path, "/");
+    }
 
-    tcp_write(pcb, response, strlen(response), TCP_WRITE_FLAG_COPY);
+    char response[HTTP_PARSER_TARGET_SIZE + 192];
+    int len = snprintf(response, sizeof(response),
+                       "HTTP/1.1 302 Found\r\n"
+                       "Location: http://%s%s\r\n"
+                       "Content-Type: text/plain\r\n"
+                       "Content-Length: %u\r\n"
+                       "Connection: close\r\n"
+                       "\r\n"
+                       "%s",
+                       ipaddr_ntoa(&pcb->local_ip), path, (unsigned)strlen(body), body);
+
+    if (len <= 0 || len >= (int)sizeof(response))
+    {
+        return false;
+    }
+
+    tcp_write(pcb, response, (u16_t)len, TCP_WRITE_FLAG_COPY);
     tcp_output(pcb);
 
     return true;
 }
 
-static void send_websocket_response(struct tcp_pcb *pcb, const char *key)
+static void send_http_error(struct tcp_pcb *pcb, int status)
 {
-    // Simplified WebSocket handshake response
-    const char *response =
-        "HTTP/1.1 101 Switching Protocols\r\n"
-        "Upgrade: websocket\r\n"
-        "Connection: Upgrade\r\n"
-        "Sec-WebSocket-Accept: dGhlIHNhbXBsZSBub25jZQ==\r\n" // Simplified
-        "\r\n";
+    const char *reason = status == 426   ? "Upgrade Required"
+                         : status == 414 ? "URI Too Long"
+                         : status == 431 ? "Request Header Fields Too Large"
+                                         : "Bad Request";
+    char response[160];
+    int len = snprintf(response, sizeof(response),
+                       "HTTP/1.1 %d %s\r\n"
+                       "Sec-WebSocket-Version: 13\r\n"
+                       "Content-Length: 0\r\n"
+                       "Connection: close\r\n"
+                       "\r\n",
+                       status, reason);
+
+    if (len > 0 && len < (int)sizeof(response))
+    {
+        tcp_write(pcb, response, (u16_t)len, TCP_WRITE_FLAG_COPY);
+        tcp_output(pcb);
+    }
+}
+
+static json_format_t negotiate_format(const http_parser_t *request, const char **protocol)
+{
+    // The server's preference wins over the order the client listed them in
+    const char *offered = http_parser_header(request, HTTP_HEADER_SEC_WEBSOCKET_PROTOCOL);
+    if (http_header_has_token(offered, WEBSOCKET_SUBPROTOCOL_CBOR))
+    {
+        *protocol = WEBSOCKET_SUBPROTOCOL_CBOR;
+        return JSON_FORMAT_CBOR;
+    }
+    if (http_header_has_token(offered, WEBSOCKET_SUBPROTOCOL_JSON))
+    {
+        *protocol = WEBSOCKET_SUBPROTOCOL_JSON;
+    }
+    return JSON_FORMAT_TEXT;
+}
+
+static bool format_in_use(json_format_t format)
+{
+    for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++)
+    {
+        if (is_client_ready(i) && clients[i].format == format)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool send_websocket_response(struct tcp_pcb *pcb, const char *key, const char *protocol,
+                                    const char *extensions)
+{
+    char accept[WEBSOCKET_ACCEPT_SIZE];
+
+    uint64_t start_us = hal_get_time_us();
+    bool valid = websocket_compute_accept(key, accept, sizeof(accept));
+    uint32_t elapsed_us = (uint32_t)(hal_get_time_us() - start_us);
 
-    tcp_write(pcb, response, strlen(response), TCP_WRITE_FLAG_COPY);
+    if (!valid)
+    {
+        return false;
+    }
+
+    char response[224 + WEBSOCKET_EXTENSIONS_SIZE];
+    int len = snprintf(response, sizeof(response),
+                       "HTTP/1.1 101 Switching Protocols\r\n"
+                       "Upgrade: websocket\r\n"
+                       "Connection: Upgrade\r\n"
+                       "Sec-WebSocket-Accept: %s\r\n"
+                       "%s%s%s"
+                       "%s%s%s"
+                       "\r\n",
+                       accept, protocol ? "Sec-WebSocket-Protocol: " : "", protocol ? protocol : "",
+                       protocol ? "\r\n" : "", extensions ? "Sec-WebSocket-Extensions: " : "",
+                       extensions ? extensions : "", extensions ? "\r\n" : "");
+    if (len <= 0 || len >= (int)sizeof(response))
+    {
+        return false;
+    }
+
+    tcp_write(pcb, response, (u16_t)len, TCP_WRITE_FLAG_COPY);
     tcp_output(pcb);
+
+    printf("[WEBSOCKET] Handshake accept computed in %lu us\n", (unsigned long)elapsed_us);
+    return true;
 }
 
-static bool handle_websocket_frame(int client_index, const char *data, size_t len)
+static bool decode_frames(int client_index, const uint8_t *data, size_t len)
 {
-    // Simplified frame parsing - just look for JSON commands
-    if (len > 2 && data[0] == '{')
+    websocket_rx_t *rx = &clients[client_index].rx;
+    size_t pos = 0;
+
+    while (pos < len)
     {
-        // This looks like a JSON command
-        printf("[WEBSOCKET] Received command from client %d: %.*s\n", client_index, (int)len, data);
+        if (rx->state == WS_RX_HEADER)
+        {
+            rx->header[rx->header_len++] = data[pos++];
+            if (rx->header_len == 2)
+            {
+                uint8_t len7 = rx->header[1] & 0x7F;
+                rx->header_need = 2 + (len7 == 126 ? 2 : len7 == 127 ? 8 : 0) + ((rx->header[1] & 0x80) ? 4 : 0);
+            }
+            if (rx->header_len < rx->header_need)
+            {
+                continue;
+            }
+
+            // Full header available
+            uint8_t b0 = rx->header[0];
+            uint8_t b1 = rx->header[1];
+            rx->fin = (b0 & 0x80) != 0;
+            rx->opcode = b0 & 0x0F;
+            bool control = (rx->opcode & 0x08) != 0;
+
+            uint64_t payload_len = b1 & 0x7F;
+            uint8_t at = 2;
+            if (payload_len == 126)
+            {
+                payload_len = ((uint64_t)rx->header[2] << 8) | rx->header[3];
+                at = 4;
+            }
+            else if (payload_len == 127)
+            {
+                payload_len = 0;
+                for (int i = 0; i < 8; i++)
+                {
+                    payload_len = (payload_len << 8) | rx->header[2 + i];
+                }
+                at = 10;
+            }
+
+            // Clients must mask, may only set RSV1 on the first frame of a
+            // message and only with permessage-deflate, and control frames
+            // are short and never fragmented
+            bool compressed = (b0 & 0x70) == 0x40 && clients[client_index].deflate && !control && rx->opcode != 0;
+            bool valid = (b1 & 0x80) && (!(b0 & 0x70) || compressed) &&
+                         (control ? (rx->fin && payload_len <= WEBSOCKET_CONTROL_MAX &&
+                                     (rx->opcode == WS_MSG_CLOSE || rx->opcode == WS_MSG_PING || rx->opcode == WS_MSG_PONG))
+                                  : (rx->opcode == 0 ? rx->message_opcode != 0
+                                                     : (rx->message_opcode == 0 &&
+                                                        (rx->opcode == WS_MSG_TEXT || rx->opcode == WS_MSG_BINARY))));
+            if (!valid)
+            {
+                server_stats.protocol_errors++;
+                send_close_frame(client_index, WS_CLOSE_PROTOCOL_ERROR);
+                return false;
+            }
+
+            if (!control && rx->message_len + payload_len > WEBSOCKET_RX_BUFFER_SIZE)
+            {
+                server_stats.protocol_errors++;
+                send_close_frame(client_index, WS_CLOSE_TOO_BIG);
+                return false;
+            }
+
+            memcpy(rx->mask, &rx->header[at], 4);
+            if (!control && rx->opcode != 0)
+            {
+                rx->message_opcode = rx->opcode;
+                rx->message_compressed = compressed;
+            }
+            rx->payload_len = (uint32_t)payload_len;
+            rx->payload_pos = 0;
+            rx->state = WS_RX_PAYLOAD;
+        }
 
-        if (command_callback)
+        if (rx->state == WS_RX_PAYLOAD)
         {
-            command_callback("test_command", "test_params", client_index);
+            size_t take = rx->payload_len - rx->payload_pos;
+            if (take > len - pos)
+            {
+                take = len - pos;
+            }
+
+            uint8_t *dest = (rx->opcode & 0x08) ? &rx->control[rx->payload_pos] : &rx->message[rx->message_len];
+            for (size_t i = 0; i < take; i++)
+            {
+                dest[i] = data[pos + i] ^ rx->mask[(rx->payload_pos + i) & 3];
+            }
+            pos += take;
+            rx->payload_pos += take;
+            if (!(rx->opcode & 0x08))
+            {
+                rx->message_len += take;
+            }
+
+            if (rx->payload_pos == rx->payload_len)
+            {
+                rx->state = WS_RX_HEADER;
+                rx->header_len = 0;
+                rx->header_need = 2;
+                if (!handle_frame(client_index))
+                {
+                    return false;
+                }
+                if (!clients[client_index].connected)
+                {
+                    return true;
+                }
+            }
         }
+    }
+
+    return true;
+}
+
+static bool handle_frame(int client_index)
+{
+    websocket_client_t *client = &clients[client_index];
+    websocket_rx_t *rx = &client->rx;
+
+    switch (rx->opcode)
+    {
+    case WS_MSG_PING:
+        send_websocket_frame(client_index, WS_MSG_PONG, rx->control, rx->payload_len);
         return true;
+
+    case WS_MSG_PONG:
+        if (client->ping_outstanding)
+        {
+            client->ping_outstanding = false;
+            server_stats.pongs_received++;
+            server_stats.last_rtt_ms = hal_get_tick_ms() - client->ping_sent_at;
+        }
+        return true;
+
+    case WS_MSG_CLOSE:
+    {
+        // Echo the peer's status code, then let TCP finish the close
+        uint16_t code = rx->payload_len >= 2 ? (uint16_t)((rx->control[0] << 8) | rx->control[1]) : WS_CLOSE_NORMAL;
+        send_close_frame(client_index, code);
+        return false;
     }
 
-    return false;
+    default:
+        break;
+    }
+
+    if (!rx->fin)
+    {
+        return true; // Wait for the continuation frames
+    }
+
+    uint8_t opcode = rx->message_opcode;
+    uint8_t *message = rx->message;
+    size_t len = rx->message_len;
+    bool compressed = rx->message_compressed;
+    rx->message_opcode = 0;
+    rx->message_len = 0;
+    rx->message_compressed = false;
+
+    if (compressed)
+    {
+        // Inflated size is held to the same limit as an uncompressed message
+        if (!deflate_decompress(&inflate_state, message, len, inflate_message, WEBSOCKET_RX_BUFFER_SIZE, &len))
+        {
+            server_stats.protocol_errors++;
+            send_close_frame(client_index, WS_CLOSE_PROTOCOL_ERROR);
+            return false;
+        }
+        message = inflate_message;
+    }
+
+    if (opcode == WS_MSG_TEXT)
+    {
+        message[len] = '\0';
+        handle_websocket_message(client_index, (char *)message, len);
+    }
+    else if (opcode == WS_MSG_BINARY && clients[client_index].format == JSON_FORMAT_CBOR)
+    {
+        // CBOR commands join the text path as JSON
+        size_t text_len = cbor_to_json(message, len, cbor_text, sizeof(cbor_text));
+        if (text_len == 0)
+        {
+            printf("[WEBSOCKET] Client %d sent an undecodable CBOR message (%u bytes)\n", client_index, (unsigned)len);
+            return true;
+        }
+        handle_websocket_message(client_index, cbor_text, text_len);
+    }
+
+    return true;
+}
+
+static void handle_websocket_message(int client_index, char *text, size_t len)
+{
+    // Commands arrive as {"type":"command","command":"NAME","params":{...}}
+    printf("[WEBSOCKET] Received command from client %d: %.*s\n", client_index, (int)len, text);
+
+    if (message_callback && message_callback(client_index, text, len))
+    {
+        return;
+    }
+
+    char command[32];
+    char params[128];
+    if (!parse_command_message(text, len, command, sizeof(command), params, sizeof(params)))
+    {
+        return;
+    }
+
+    if (command_callback)
+    {
+        command_callback(command, params, client_index);
+    }
+}
+
+static bool parse_command_message(const char *text, size_t len, char *command, size_t command_size,
+                                  char *params, size_t params_size)
+{
+    // {"command":"NAME","params":...}: a string params is unquoted, an
+    // object or array is passed on as its JSON text
+    json_reader_t reader;
+    json_reader_init(&reader, text, len);
+
+    command[0] = '\0';
+    params[0] = '\0';
+
+    if (json_next(&reader) != JSON_TOKEN_OBJECT_BEGIN)
+    {
+        return false;
+    }
+
+    json_token_t token;
+    while ((token = json_next(&reader)) == JSON_TOKEN_KEY)
+    {
+        if (json_token_is(&reader, "command"))
+        {
+            if (json_next(&reader) != JSON_TOKEN_STRING || !json_token_copy(&reader, command, command_size))
+            {
+                return false;
+            }
+        }
+        else if (json_token_is(&reader, "params"))
+        {
+            token = json_next(&reader);
+            if (token == JSON_TOKEN_OBJECT_BEGIN || token == JSON_TOKEN_ARRAY_BEGIN)
+            {
+                const char *start = reader.token;
+                if (!json_skip(&reader) || (size_t)(reader.p - start) >= params_size)
+                {
+                    return false;
+                }
+                memcpy(params, start, (size_t)(reader.p - start));
+                params[reader.p - start] = '\0';
+            }
+            else if (token != JSON_TOKEN_NULL)
+            {
+                json_token_copy(&reader, params, params_size);
+            }
+        }
+        else if (!json_skip(&reader))
+        {
+            return false;
+        }
+    }
+
+    return token == JSON_TOKEN_OBJECT_END && command[0] != '\0';
+}
+
+static void send_close_frame(int client_index, uint16_t code)
+{
+    uint8_t payload[2] = {(uint8_t)(code >> 8), (uint8_t)code};
+    send_websocket_frame(client_index, WS_MSG_CLOSE, payload, sizeof(payload));
+}
+
+static bool send_websocket_frame(int client_index, uint8_t opcode, const uint8_t *payload, size_t len)
+{
+    // Callers outside lwIP callbacks hold the lwIP lock; it is taken again
+    // here (it nests) so a late caller cannot write to a pcb being closed
+    cyw43_arch_lwip_begin();
+    bool sent = write_websocket_frame(clients[client_index].pcb, opcode, payload, len);
+    cyw43_arch_lwip_end();
+    return sent;
+}
+
+static bool write_websocket_frame(struct tcp_pcb *pcb, uint8_t opcode, const uint8_t *payload, size_t len)
+{
+    if (pcb == NULL)
+    {
+        return false; // Released while the caller waited for the lock
+    }
+
+    // Server-to-client frames are never masked (RFC 6455 section 5.1)
+    uint8_t header[4];
+    size_t header_len = 2;
+    header[0] = 0x80 | (opcode & 0x0F); // FIN + opcode
+    if (len < 126)
+    {
+        header[1] = (uint8_t)len;
+    }
+    else if (len <= 0xFFFF)
+    {
+        header[1] = 126;
+        header[2] = (uint8_t)(len >> 8);
+        header[3] = (uint8_t)(len & 0xFF);
+        header_len = 4;
+    }
+    else
+    {
+        return false; // Larger frames are never produced by this server
+    }
+
+    if (tcp_sndbuf(pcb) < header_len + len)
+    {
+        return false; // Drop rather than block; the next update resends state
+    }
+
+    if (tcp_write(pcb, header, header_len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE) != ERR_OK ||
+        tcp_write(pcb, payload, len, TCP_WRITE_FLAG_COPY) != ERR_OK)
+    {
+        return false;
+    }
+
+    tcp_output(pcb);
+    return true;
+}
+
+static bool send_prepared(int client_id, uint8_t *frame, size_t len, json_format_t format, size_t keep_free)
+{
+    // Telemetry publishes from the main loop; the lock keeps its writes off
+    // pcbs the callbacks are closing
+    cyw43_arch_lwip_begin();
+    bool sent = false;
+    if (client_id >= 0)
+    {
+        sent = is_client_ready(client_id) && send_prepared_frame(client_id, frame, len, format, keep_free);
+    }
+    else
+    {
+        for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++)
+        {
+            if (is_client_ready(i) && clients[i].format == format)
+            {
+                sent |= send_prepared_frame(i, frame, len, format, keep_free);
+            }
+        }
+    }
+    cyw43_arch_lwip_end();
+    return sent;
+}
+
+static bool send_prepared_frame(int client_index, uint8_t *frame, size_t len, json_format_t format,
+                                size_t keep_free)
+{
+    websocket_client_t *client = &clients[client_index];
+    uint8_t first_byte = 0x80 | (format == JSON_FORMAT_CBOR ? WS_MSG_BINARY : WS_MSG_TEXT); // FIN + opcode
+
+    if (!client->deflate || len > WEBSOCKET_DEFLATE_MAX_MESSAGE)
+    {
+        return queue_prepared_frame(client->pcb, frame, len, first_byte, keep_free);
+    }
+
+    // The dictionary is what this client already inflated, so the message
+    // goes right after it in one buffer
+    size_t history = client->deflate_reset ? 0 : client->deflate_history_len;
+    memcpy(deflate_input, client->deflate_history, history);
+    memcpy(deflate_input + history, frame + WEBSOCKET_FRAME_HEADROOM, len);
+    size_t packed = deflate_compress(&deflate_state, deflate_input, history, history + len,
+                                     deflate_frame + WEBSOCKET_FRAME_HEADROOM, len);
+
+    bool sent;
+    if (packed == 0)
+    {
+        sent = queue_prepared_frame(client->pcb, frame, len, first_byte, keep_free); // Would not shrink
+    }
+    else
+    {
+        sent = queue_prepared_frame(client->pcb, deflate_frame, packed, first_byte | 0x40, keep_free); // RSV1
+        if (sent)
+        {
+            // Only a message the client will inflate may extend its window
+            if (!client->deflate_reset)
+            {
+                size_t total = history + len;
+                size_t keep = total < DEFLATE_WINDOW_SIZE ? total : DEFLATE_WINDOW_SIZE;
+                memcpy(client->deflate_history, deflate_input + total - keep, keep);
+                client->deflate_history_len = (uint16_t)keep;
+            }
+            server_stats.deflate_bytes_in += len;
+            server_stats.deflate_bytes_out += packed;
+        }
+    }
+
+    return sent;
+}
+
+static bool queue_prepared_frame(struct tcp_pcb *pcb, uint8_t *frame, size_t len, uint8_t first_byte,
+                                 size_t keep_free)
+{
+    if (pcb == NULL)
+    {
+        return false;
+    }
+
+    // The header goes into the headroom right in front of the payload
+    uint8_t *payload = frame + WEBSOCKET_FRAME_HEADROOM;
+    uint8_t *header;
+    if (len < 126)
+    {
+        header = payload - 2;
+        header[1] = (uint8_t)len;
+    }
+    else if (len <= 0xFFFF)
+    {
+        header = payload - 4;
+        header[1] = 126;
+        header[2] = (uint8_t)(len >> 8);
+        header[3] = (uint8_t)(len & 0xFF);
+    }
+    else
+    {
+        return false;
+    }
+    header[0] = first_byte;
+
+    size_t frame_len = (size_t)(payload - header) + len;
+    if (tcp_sndbuf(pcb) < frame_len + keep_free)
+    {
+        server_stats.frames_dropped++;
+        return false; // Drop rather than block; the next update resends state
+    }
+
+    if (tcp_write(pcb, header, (u16_t)frame_len, TCP_WRITE_FLAG_COPY) != ERR_OK)
+    {
+        return false;
+    }
+
+    tcp_output(pcb);
+    return true;
+}
+
+static bool is_client_ready(int client_index)
+{
+    return client_index >= 0 && client_index < MAX_WEBSOCKET_CLIENTS &&
+           clients[client_index].connected &&
+           clients[client_index].websocket_handshake_complete &&
+           clients[client_index].pcb != NULL;
 }
 
 static int find_free_client_slot(void)
@@ -432,15 +1346,102 @@ static void cleanup_client_slot(int index)
 {
     if (index >= 0 && index < MAX_WEBSOCKET_CLIENTS)
     {
-        if (clients[index].connected && client_callback)
-        {
-            client_callback(index, false, clients[index].client_ip);
-        }
+        bool was_connected = clients[index].connected;
+        char client_ip[sizeof(clients[index].client_ip)];
+        memcpy(client_ip, clients[index].client_ip, sizeof(client_ip));
 
         clients[index].pcb = NULL;
         clients[index].connected = false;
         clients[index].websocket_handshake_complete = false;
+        clients[index].ping_outstanding = false;
+        clients[index].format = JSON_FORMAT_TEXT;
+        clients[index].deflate = false;
+        clients[index].deflate_reset = false;
+        clients[index].deflate_history_len = 0;
         memset(clients[index].client_ip, 0, sizeof(clients[index].client_ip));
         clients[index].last_activity = 0;
+
+        // Notified once the slot is released, so the callback cannot send to a closing pcb
+        if (was_connected && client_callback)
+        {
+            client_callback(index, false, client_ip);
+        }
     }
-}
\ No newline at end of file
+}
+
+static int find_reclaimable_slot(uint32_t now)
+{
+    // Prefer a connection that never completed its upgrade, then one that
+    // has already missed a ping; live dashboards are never displaced
+    int candidate = -1;
+    uint32_t worst_idle = 0;
+
+    for (int i = 0; i < MAX_WEBSOCKET_CLIENTS; i++)
+    {
+        if (!clients[i].connected)
+        {
+            continue;
+        }
+
+        uint32_t idle = now - clients[i].last_activity;
+        if (!clients[i].websocket_handshake_complete)
+        {
+            idle += WEBSOCKET_TIMEOUT_MS; // Rank above any upgraded client
+        }
+        else if (!clients[i].ping_outstanding || idle < WEBSOCKET_PING_INTERVAL_MS)
+        {
+            continue;
+        }
+
+        if (candidate == -1 || idle > worst_idle)
+        {
+            candidate = i;
+            worst_idle = idle;
+        }
+    }
+
+    return candidate;
+}
+
+static void abort_client(int client_index)
+{
+    struct tcp_pcb *pcb = clients[client_index].pcb;
+    cleanup_client_slot(client_index);
+
+    if (pcb != NULL)
+    {
+        // Detach first so lwIP does not call back into a released slot
+        tcp_arg(pcb, NULL);
+        tcp_recv(pcb, NULL);
+        tcp_sent(pcb, NULL);
+        tcp_err(pcb, NULL);
+        aborted_pcb = pcb;
+        tcp_abort(pcb);
+    }
+}
+
+static err_t close_client(int client_index)
+{
+    struct tcp_pcb *pcb = clients[client_index].pcb;
+    cleanup_client_slot(client_index);
+
+    if (pcb == NULL)
+    {
+        return ERR_OK;
+    }
+
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_err(pcb, NULL);
+
+    // Queued data (e.g. an error response) is still sent before the FIN
+    if (tcp_close(pcb) != ERR_OK)
+    {
+        aborted_pcb = pcb;
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+
+    return ERR_OK;
+}
@@ -1,6 +1,13 @@
 /**
  * @file wifi_manager.cpp
- * @brief Simplified WiFi manager implementation for Raspberry Pi Pico W
+ * @brief Non-blocking WiFi manager implementation for Raspberry Pi Pico W
+ *
+ * A join is started with cyw43_arch_wifi_connect_async() and then followed
+ * by polling cyw43_tcpip_link_status(), which walks DOWN (scanning) -> JOIN
+ * (associated) -> NOIP (DHCP) -> UP, or ends in FAIL / NONET / BADAUTH.
+ * Each attempt has its own deadline. Failures wait WIFI_RECONNECT_DELAY_MS,
+ * doubling per consecutive failure up to WIFI_RECONNECT_MAX_DELAY_MS, so a
+ * missing access point costs a status poll per loop rather than a 30 s stall.
  */
 
 #include "../include/wifi_manager.h"
@@ -17,11 +24,28 @@
 // =============================================================================
 
 static bool wifi_initialized = false;
-static bool wifi_connected = false;
+static wifi_state_t wifi_state = WIFI_STATE_IDLE;
+static wifi_event_callback_t event_callback = NULL;
 static char current_ssid[WIFI_SSID_MAX_LENGTH] = {0};
+static char current_password[WIFI_PASSWORD_MAX_LENGTH] = {0};
 static char current_ip[16] = {0};
 static int current_rssi = 0;
-static uint32_t connection_start_time = 0;
+static uint32_t state_entered_at = 0;  // Start of the current attempt or backoff
+static uint32_t attempt_deadline = 0;  // Give up on the current join at this time
+static uint32_t retry_at = 0;          // End of the current backoff
+static uint32_t last_status_check = 0; // Link/RSSI poll while connected
+static uint32_t attempt_count = 0;
+static uint32_t consecutive_failures = 0;
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static uint32_t now_ms(void);
+static void set_state(wifi_state_t state);
+static bool start_attempt(void);
+static void schedule_retry(const char *reason);
+static void refresh_ip_address(void);
 
 // =============================================================================
 // PUBLIC FUNCTION IMPLEMENTATIONS
@@ -35,6 +59,7 @@ bool wifi_manager_init(void)
     }
 
     // CYW43 should already be initialized in main.cpp
+    wifi_state = WIFI_STATE_IDLE;
     wifi_initialized = true;
     printf("[WIFI] WiFi manager initialized\n");
     return true;
@@ -42,7 +67,7 @@ bool wifi_manager_init(void)
 
 void wifi_manager_deinit(void)
 {
-    if (wifi_connected)
+    if (wifi_state != WIFI_STATE_IDLE)
     {
         wifi_disconnect();
     }
@@ -58,89 +83,50 @@ bool wifi_connect(const char *ssid, const char *password)
         return false;
     }
 
-    if (!ssid)
+    if (!ssid || strlen(ssid) == 0 || strlen(ssid) >= sizeof(current_ssid))
     {
-        printf("[WIFI] SSID cannot be NULL\n");
+        printf("[WIFI] Invalid SSID\n");
         return false;
     }
 
-    printf("[WIFI] Connecting to %s...\n", ssid);
-
-    // Store SSID
-    strncpy(current_ssid, ssid, sizeof(current_ssid) - 1);
-    current_ssid[sizeof(current_ssid) - 1] = '\0';
-
-    // Attempt connection
-    int result;
-    if (password && strlen(password) > 0)
-    {
-        result = cyw43_arch_wifi_connect_timeout_ms(ssid, password, CYW43_AUTH_WPA2_AES_PSK, WIFI_CONNECT_TIMEOUT_MS);
-    }
-    else
+    if (password && strlen(password) >= sizeof(current_password))
     {
-        result = cyw43_arch_wifi_connect_timeout_ms(ssid, NULL, CYW43_AUTH_OPEN, WIFI_CONNECT_TIMEOUT_MS);
+        printf("[WIFI] Password too long\n");
+        return false;
     }
 
-    if (result == 0)
+    // Drop any join in progress before switching networks
+    if (wifi_state != WIFI_STATE_IDLE)
     {
-        wifi_connected = true;
+        cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+    }
 
-        // Get IP address
-        const ip_addr_t *ip = netif_ip_addr4(netif_default);
-        if (ip)
-        {
-            snprintf(current_ip, sizeof(current_ip), "%s", ip4addr_ntoa(ip));
-        }
+    strcpy(current_ssid, ssid);
+    strcpy(current_password, password ? password : "");
+    memset(current_ip, 0, sizeof(current_ip));
+    attempt_count = 0;
+    consecutive_failures = 0;
 
-        printf("[WIFI] Connected successfully\n");
-        printf("[WIFI] IP Address: %s\n", current_ip);
-        return true;
-    }
-    else
-    {
-        printf("[WIFI] Connection failed with error: %d\n", result);
-        return false;
-    }
+    return start_attempt();
 }
 
 void wifi_disconnect(void)
 {
-    if (!wifi_initialized)
+    if (!wifi_initialized || wifi_state == WIFI_STATE_IDLE)
     {
         return;
     }
 
-    if (wifi_connected)
-    {
-        // Note: cyw43_arch_wifi_disconnect() doesn't exist in the SDK
-        // We'll set the status and let the connection timeout
-        wifi_connected = false;
-        memset(current_ip, 0, sizeof(current_ip));
-        printf("[WIFI] Disconnected\n");
-    }
+    cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+    memset(current_ip, 0, sizeof(current_ip));
+    current_rssi = 0;
+    set_state(WIFI_STATE_IDLE);
+    printf("[WIFI] Disconnected\n");
 }
 
 bool wifi_is_connected(void)
 {
-    if (!wifi_initialized)
-    {
-        return false;
-    }
-
-    // Check actual WiFi status
-    int status = cyw43_wifi_link_status(&cyw43_state, CYW43_ITF_STA);
-    bool actually_connected = (status == CYW43_LINK_UP);
-
-    if (wifi_connected != actually_connected)
-    {
-        wifi_connected = actually_connected;
-        if (!wifi_connected)
-        {
-            memset(current_ip, 0, sizeof(current_ip));
-        }
-    }
-
-    return wifi_connected;
+    return wifi_initialized && wifi_state == WIFI_STATE_CONNECTED;
 }
 
 const char *wifi_get_ip_address(void)
@@ -150,14 +136,9 @@ const char *wifi_get_ip_address(void)
         return "0.0.0.0";
     }
 
-    // Update IP address if needed
     if (strlen(current_ip) == 0)
     {
-        const ip_addr_t *ip = netif_ip_addr4(netif_default);
-        if (ip)
-        {
-            snprintf(current_ip, sizeof(current_ip), "%s", ip4addr_ntoa(ip));
-        }
+        refresh_ip_address();
     }
 
     return current_ip;
@@ -170,20 +151,144 @@ const char *wifi_get_ssid(void)
 
 int wifi_get_rssi(void)
 {
-    // This is a simplified implementation
-    // The actual RSSI would need to be read from the CYW43 chip
+    // Sampled by wifi_manager_update() every WIFI_STATUS_CHECK_INTERVAL_MS
     return current_rssi;
 }
 
 void wifi_manager_update(void)
 {
-    if (!wifi_initialized)
+    if (!wifi_initialized || wifi_state == WIFI_STATE_IDLE)
+    {
+        return;
+    }
+
+    uint32_t now = now_ms();
+
+    if (wifi_state == WIFI_STATE_BACKOFF)
+    {
+        if ((int32_t)(now - retry_at) >= 0)
+        {
+            start_attempt();
+        }
+        return;
+    }
+
+    if (wifi_state == WIFI_STATE_CONNECTED && now - last_status_check < WIFI_STATUS_CHECK_INTERVAL_MS)
+    {
+        return;
+    }
+    last_status_check = now;
+
+    int status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+
+    switch (status)
     {
+    case CYW43_LINK_UP:
+        if (wifi_state != WIFI_STATE_CONNECTED)
+        {
+            consecutive_failures = 0;
+            refresh_ip_address();
+            printf("[WIFI] Connected to %s in %lu ms, IP Address: %s\n", current_ssid,
+                   (unsigned long)(now - state_entered_at), current_ip);
+            set_state(WIFI_STATE_CONNECTED);
+        }
+        else
+        {
+            int32_t rssi;
+            if (cyw43_wifi_get_rssi(&cyw43_state, &rssi) == 0)
+            {
+                current_rssi = (int)rssi;
+            }
+        }
+        return;
+
+    case CYW43_LINK_FAIL:
+        schedule_retry("connection failed");
+        return;
+
+    case CYW43_LINK_NONET:
+        schedule_retry("network not found");
+        return;
+
+    case CYW43_LINK_BADAUTH:
+        schedule_retry("authentication failed");
+        return;
+
+    default:
+        break;
+    }
+
+    if (wifi_state == WIFI_STATE_CONNECTED)
+    {
+        // Link dropped or address lost: rejoin straight away, back off only if that fails
+        printf("[WIFI] Link to %s lost (status %d)\n", current_ssid, status);
+        memset(current_ip, 0, sizeof(current_ip));
+        current_rssi = 0;
+        cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+        start_attempt();
         return;
     }
 
-    // Check connection status
-    wifi_is_connected();
+    if ((int32_t)(now - attempt_deadline) >= 0)
+    {
+        schedule_retry("timed out");
+        return;
+    }
+
+    wifi_state_t next = status == CYW43_LINK_NOIP   ? WIFI_STATE_DHCP
+                        : status == CYW43_LINK_JOIN ? WIFI_STATE_AUTHENTICATING
+                                                    : WIFI_STATE_SCANNING;
+    if (next != wifi_state)
+    {
+        set_state(next);
+    }
+}
+
+wifi_state_t wifi_get_state(void)
+{
+    return wifi_state;
+}
+
+const char *wifi_state_name(wifi_state_t state)
+{
+    switch (state)
+    {
+    case WIFI_STATE_IDLE:
+        return "IDLE";
+    case WIFI_STATE_SCANNING:
+        return "SCANNING";
+    case WIFI_STATE_AUTHENTICATING:
+        return "AUTHENTICATING";
+    case WIFI_STATE_DHCP:
+        return "DHCP";
+    case WIFI_STATE_CONNECTED:
+        return "CONNECTED";
+    case WIFI_STATE_BACKOFF:
+        return "BACKOFF";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+uint32_t wifi_get_attempts(void)
+{
+    return attempt_count;
+}
+
+uint32_t wifi_get_retry_delay_ms(void)
+{
+    if (wifi_state != WIFI_STATE_BACKOFF)
+    {
+        return 0;
+    }
+
+    int32_t remaining = (int32_t)(retry_at - now_ms());
+    return remaining > 0 ? (uint32_t)remaining : 0;
+}
+
+void wifi_register_event_callback(wifi_event_callback_t callback)
+{
+    event_callback = callback;
 }
 
 void wifi_set_hostname(const char *hostname)
@@ -217,12 +322,6 @@ void wifi_toggle_led(void)
 }
 
 // Stub functions for compatibility
-void wifi_register_event_callback(void *callback)
-{
-    // Simplified - no event callbacks in this version
-    printf("[WIFI] Event callback registered (simplified implementation)\n");
-}
-
 bool wifi_scan_networks(void)
 {
     // Simplified - no network scanning in this version
@@ -234,4 +333,77 @@ void wifi_register_scan_callback(void *callback)
 {
     // Simplified - no scan callbacks in this version
     printf("[WIFI] Scan callback registered (simplified implementation)\n");
-}
\ No newline at end of file
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static uint32_t now_ms(void)
+{
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static void set_state(wifi_state_t state)
+{
+    wifi_state_t previous = wifi_state;
+    wifi_state = state;
+
+    if (state != previous && event_callback)
+    {
+        event_callback(state, previous);
+    }
+}
+
+static bool start_attempt(void)
+{
+    uint32_t auth = strlen(current_password) > 0 ? CYW43_AUTH_WPA2_AES_PSK : CYW43_AUTH_OPEN;
+    const char *password = strlen(current_password) > 0 ? current_password : NULL;
+
+    attempt_count++;
+    printf("[WIFI] Connecting to %s (attempt %lu)...\n", current_ssid, (unsigned long)attempt_count);
+
+    // Only queues the join; the driver reports progress through the link status
+    int result = cyw43_arch_wifi_connect_async(current_ssid, password, auth);
+
+    state_entered_at = now_ms();
+    if (result != 0)
+    {
+        printf("[WIFI] Could not start join: %d\n", result);
+        schedule_retry("join rejected");
+        return false;
+    }
+
+    attempt_deadline = state_entered_at + WIFI_CONNECT_TIMEOUT_MS;
+    set_state(WIFI_STATE_SCANNING);
+    return true;
+}
+
+static void schedule_retry(const char *reason)
+{
+    uint32_t doublings = consecutive_failures < WIFI_MAX_RETRY_COUNT ? consecutive_failures : WIFI_MAX_RETRY_COUNT - 1;
+    uint32_t delay = (uint32_t)WIFI_RECONNECT_DELAY_MS << doublings;
+    if (delay > WIFI_RECONNECT_MAX_DELAY_MS)
+    {
+        delay = WIFI_RECONNECT_MAX_DELAY_MS;
+    }
+
+    consecutive_failures++;
+
+    // Abandon the failed join so the next attempt starts from a clean state
+    cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+
+    state_entered_at = now_ms();
+    retry_at = state_entered_at + delay;
+    printf("[WIFI] %s: %s, retrying in %lu ms\n", current_ssid, reason, (unsigned long)delay);
+    set_state(WIFI_STATE_BACKOFF);
+}
+
+static void refresh_ip_address(void)
+{
+    const ip_addr_t *ip = netif_ip_addr4(netif_default);
+    if (ip)
+    {
+        snprintf(current_ip, sizeof(current_ip), "%s", ip4addr_ntoa(ip));
+    }
+}
@@ -0,0 +1,19 @@
+#!/bin/bash
+
+# Build and run the host micro-benchmarks in tools/bench
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+BUILD_DIR="$PROJECT_ROOT/build/bench"
+
+echo "Building host benchmarks..."
+cmake -S "$PROJECT_ROOT/tools/bench" -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE=Release > /dev/null
+cmake --build "$BUILD_DIR" -j"$(nproc 2>/dev/null || echo 2)"
+
+for bench in "$BUILD_DIR"/*_bench; do
+    echo ""
+    echo "=== $(basename "$bench") ==="
+    "$bench"
+done
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Render the display scenes on the host and compare them with the golden hashes.
+# Pass --update to accept the current output; PPMs are left in build/display_render/frames.
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/../.." && pwd)"
+BUILD_DIR="$PROJECT_ROOT/build/display_render"
+GOLDEN="$PROJECT_ROOT/tools/display_render/golden.txt"
+
+echo "Building display renderer..."
+cmake -S "$PROJECT_ROOT/tools/display_render" -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE=Release > /dev/null
+cmake --build "$BUILD_DIR" -j"$(nproc 2>/dev/null || echo 2)" > /dev/null
+
+mkdir -p "$BUILD_DIR/frames"
+if [ "$1" = "--update" ]; then
+    "$BUILD_DIR/display_render" --output "$BUILD_DIR/frames" --update "$GOLDEN"
+else
+    "$BUILD_DIR/display_render" --output "$BUILD_DIR/frames" --check "$GOLDEN"
+fi
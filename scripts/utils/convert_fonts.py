@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""
+Convert BDF bitmap fonts into constexpr glyph tables for src/utils/bitmap_font.h.
+
+Each font becomes one bitmap_font_t whose glyphs are stored row by row, one
+character cell per glyph, most significant bit leftmost, so drawing a line of
+text is a run of table lookups with no per-glyph decoding. Only fixed-cell
+fonts are accepted: every glyph has to advance by the same width and fit the
+cell given by FONT_ASCENT + FONT_DESCENT (or FONTBOUNDINGBOX).
+
+The first font given is the default one.
+
+Usage: convert_fonts.py <output.h> <font.bdf> [<font.bdf> ...]
+"""
+
+import os
+import sys
+
+
+def fail(path, message):
+    sys.exit(f"{path}: {message}")
+
+
+def parse_bdf(path):
+    """Return (properties, glyphs) where glyphs maps encoding -> (dwidth, bbx, rows)."""
+    props = {}
+    glyphs = {}
+    with open(path, encoding="ascii") as f:
+        lines = iter(f.read().splitlines())
+
+    for line in lines:
+        fields = line.split()
+        if not fields:
+            continue
+        key = fields[0]
+        if key in ("FONTBOUNDINGBOX", "FONT_ASCENT", "FONT_DESCENT", "DEFAULT_CHAR"):
+            props[key] = [int(v) for v in fields[1:]]
+        elif key == "STARTCHAR":
+            encoding, dwidth, bbx, rows = None, None, None, []
+            for line in lines:
+                fields = line.split()
+                if not fields:
+                    continue
+                if fields[0] == "ENCODING":
+                    encoding = int(fields[1])
+                elif fields[0] == "DWIDTH":
+                    dwidth = int(fields[1])
+                elif fields[0] == "BBX":
+                    bbx = [int(v) for v in fields[1:5]]
+                elif fields[0] == "BITMAP":
+                    for line in lines:
+                        if line.strip() == "ENDCHAR":
+                            break
+                        rows.append(int(line.strip(), 16))
+                    break
+            if encoding is None or dwidth is None or bbx is None:
+                fail(path, "glyph without ENCODING, DWIDTH or BBX")
+            if len(rows) != bbx[1]:
+                fail(path, f"glyph {encoding}: {len(rows)} rows, BBX says {bbx[1]}")
+            if encoding >= 0:
+                glyphs[encoding] = (dwidth, bbx, rows)
+
+    if "FONTBOUNDINGBOX" not in props:
+        fail(path, "no FONTBOUNDINGBOX")
+    if not glyphs:
+        fail(path, "no glyphs")
+    return props, glyphs
+
+
+def convert(path):
+    """Return (name, width, height, first, count, fallback, row_bytes, cell rows per glyph)."""
+    props, glyphs = parse_bdf(path)
+    box_w, box_h, _, box_y = props["FONTBOUNDINGBOX"]
+    ascent = props.get("FONT_ASCENT", [box_h + box_y])[0]
+    descent = props.get("FONT_DESCENT", [-box_y])[0]
+
+    widths = {g[0] for g in glyphs.values()}
+    if len(widths) != 1:
+        fail(path, f"not a fixed-cell font (advances {sorted(widths)})")
+    width = widths.pop()
+    height = ascent + descent
+    row_bytes = (width + 7) // 8
+    if width > 16 or height > 32:
+        fail(path, f"{width}x{height} cell is larger than 16x32")
+
+    first = min(glyphs)
+    last = max(glyphs)
+    if last > 255:
+        fail(path, f"encoding {last} is outside 8-bit characters")
+
+    def cell(encoding):
+        _, (bw, bh, bx, by), rows = glyphs[encoding]
+        top = ascent - (by + bh)
+        if bx < 0 or top < 0 or bx + bw > width or top + bh > height:
+            fail(path, f"glyph {encoding} does not fit the {width}x{height} cell")
+        out = [0] * height
+        src_bits = ((bw + 7) // 8) * 8
+        for r, bits in enumerate(rows):
+            # Left-align the glyph's row in the cell, then shift it to its x offset
+            out[top + r] = (bits << (row_bytes * 8 - src_bits)) >> bx
+        return out
+
+    fallback = props.get("DEFAULT_CHAR", [ord("?")])[0]
+    if fallback not in glyphs:
+        fallback = first
+    cells = [cell(e if e in glyphs else fallback) for e in range(first, last + 1)]
+
+    stem = os.path.splitext(os.path.basename(path))[0]
+    return stem, width, height, first, last - first + 1, fallback, row_bytes, cells
+
+
+def char_comment(encoding):
+    ch = chr(encoding)
+    if encoding < 32 or encoding > 126:
+        return f"0x{encoding:02X}"
+    if ch == "\\":
+        return "backslash"
+    return f"'{ch}'"
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    output, sources = sys.argv[1], sys.argv[2:]
+
+    fonts = [convert(path) for path in sources]
+
+    lines = [
+        "// Generated by scripts/utils/convert_fonts.py; do not edit.",
+        "// Sources: " + ", ".join(os.path.basename(p) for p in sources),
+        "",
+        "#ifndef FONT_TABLES_H",
+        "#define FONT_TABLES_H",
+        "",
+        '#include "bitmap_font.h"',
+        "",
+    ]
+    for stem, width, height, first, count, fallback, row_bytes, cells in fonts:
+        lines.append(f"// {stem}: {width}x{height} cell, characters {first}..{first + count - 1}")
+        lines.append(f"static constexpr uint8_t {stem}_rows[{count * height * row_bytes}] = {{")
+        for i, rows in enumerate(cells):
+            data = []
+            for bits in rows:
+                for b in range(row_bytes - 1, -1, -1):
+                    data.append(f"0x{(bits >> (8 * b)) & 0xFF:02X}")
+            lines.append("    " + ", ".join(data) + ", // " + char_comment(first + i))
+        lines.append("};")
+        lines.append("")
+        name = stem[5:] if stem.startswith("font_") else stem
+        lines.append(f"static constexpr bitmap_font_t {stem} = {{")
+        lines.append(f'    "{name}", {width}, {height}, {row_bytes}, {first}, {count}, {fallback}, {stem}_rows,')
+        lines.append("};")
+        lines.append("")
+
+    lines.append("static constexpr const bitmap_font_t *font_tables[] = {")
+    lines.append("    " + ", ".join(f"&{f[0]}" for f in fonts) + ",")
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif // FONT_TABLES_H")
+
+    os.makedirs(os.path.dirname(os.path.abspath(output)), exist_ok=True)
+    with open(output, "w", encoding="ascii") as f:
+        f.write("\n".join(lines) + "\n")
+
+    for stem, width, height, first, count, _, row_bytes, _ in fonts:
+        print(f"{stem}: {count} glyphs, {width}x{height}, {count * height * row_bytes} bytes")
+
+
+if __name__ == "__main__":
+    main()
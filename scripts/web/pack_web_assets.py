@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""
+Pack the web UI into a flash-resident asset table for the Pico W HTTP server.
+
+Every file is gzip-compressed once at build time (when that makes it smaller),
+hashed, and emitted as a const byte array. Identical blobs are stored once and
+shared by every path that refers to them, and the blob hash doubles as the
+HTTP ETag so browsers can revalidate with If-None-Match.
+
+Usage: pack_web_assets.py <web_root> <output.cpp> <dir> [<dir> ...]
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+CONTENT_TYPES = {
+    ".html": "text/html; charset=utf-8",
+    ".css": "text/css; charset=utf-8",
+    ".js": "application/javascript; charset=utf-8",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".png": "image/png",
+    ".jpg": "image/jpeg",
+    ".jpeg": "image/jpeg",
+    ".ico": "image/x-icon",
+    ".txt": "text/plain; charset=utf-8",
+}
+
+# Already-compressed formats are stored as-is
+INCOMPRESSIBLE = {".png", ".jpg", ".jpeg"}
+
+# Extra URL paths served by an existing asset
+ALIASES = {
+    "/": "/static/index.html",
+    "/index.html": "/static/index.html",
+}
+
+
+def collect(web_root, dirs):
+    files = []
+    for directory in dirs:
+        base = os.path.join(web_root, directory)
+        for root, _, names in os.walk(base):
+            for name in sorted(names):
+                full = os.path.join(root, name)
+                ext = os.path.splitext(name)[1].lower()
+                if ext not in CONTENT_TYPES or os.path.getsize(full) == 0:
+                    continue
+                url = "/" + os.path.relpath(full, web_root).replace(os.sep, "/")
+                files.append((url, full, ext))
+    return files
+
+
+def encode(raw, ext):
+    if ext not in INCOMPRESSIBLE:
+        packed = gzip.compress(raw, compresslevel=9, mtime=0)
+        if len(packed) < len(raw):
+            return packed, True
+    return raw, False
+
+
+def c_bytes(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    if len(sys.argv) < 4:
+        sys.stderr.write(__doc__)
+        return 1
+
+    web_root, output, dirs = sys.argv[1], sys.argv[2], sys.argv[3:]
+
+    blobs = {}  # sha1 -> (index, data)
+    entries = {}  # url -> (blob sha1, content type, gzip, raw size)
+    raw_total = 0
+
+    for url, full, ext in collect(web_root, dirs):
+        with open(full, "rb") as f:
+            raw = f.read()
+        data, gz = encode(raw, ext)
+        digest = hashlib.sha1(data).hexdigest()
+        if digest not in blobs:
+            blobs[digest] = (len(blobs), data)
+        entries[url] = (digest, CONTENT_TYPES[ext], gz, len(raw))
+        raw_total += len(raw)
+
+    for alias, target in ALIASES.items():
+        if target in entries and alias not in entries:
+            entries[alias] = entries[target]
+
+    out = []
+    out.append("// Generated by scripts/web/pack_web_assets.py - do not edit")
+    out.append('#include "web_assets.h"')
+    out.append("")
+    for digest, (index, data) in sorted(blobs.items(), key=lambda kv: kv[1][0]):
+        out.append("// sha1 %s" % digest)
+        out.append("static const uint8_t blob_%d[%d] = {" % (index, len(data)))
+        out.append(c_bytes(data))
+        out.append("};")
+        out.append("")
+
+    # Sorted by path so the server can binary search by path
+    out.append("const web_asset_t web_assets[] = {")
+    for url in sorted(entries):
+        digest, ctype, gz, _ = entries[url]
+        index, data = blobs[digest]
+        out.append('    {"%s", "%s", blob_%d, %d, "\\"%s\\"", %s},'
+                   % (url, ctype, index, len(data), digest[:16], "true" if gz else "false"))
+    out.append("};")
+    out.append("")
+    out.append("const size_t web_assets_count = sizeof(web_assets) / sizeof(web_assets[0]);")
+    out.append("")
+
+    os.makedirs(os.path.dirname(os.path.abspath(output)), exist_ok=True)
+    with open(output, "w") as f:
+        f.write("\n".join(out))
+
+    stored = sum(len(data) for _, data in blobs.values())
+    print("web assets: %d paths, %d blobs, %d bytes raw -> %d bytes in flash"
+          % (len(entries), len(blobs), raw_total, stored))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
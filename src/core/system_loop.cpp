@@ -18,6 +18,7 @@
 static volatile bool system_stop_requested = false;
 static uint32_t loop_counter = 0;
 static uint32_t system_start_time = 0;
+static void (*main_loop_hook)(void) = NULL;
 
 // =============================================================================
 // PUBLIC FUNCTIONS - ALL FUNCTIONS IMPLEMENTED
@@ -41,6 +42,12 @@ void run_main_loop(void)
         // Perform safety checks
         check_system_safety();
 
+        // Platform-specific periodic work (networking, display, ...)
+        if (main_loop_hook != NULL)
+        {
+            main_loop_hook();
+        }
+
         // Heartbeat task (blink LED)
         if (loop_counter % 1000 == 0)
         {
@@ -81,6 +88,11 @@ void reset_loop_counter(void)
     loop_counter = 0;
 }
 
+void register_main_loop_hook(void (*hook)(void))
+{
+    main_loop_hook = hook;
+}
+
 void heartbeat_task(void)
 {
     hal_gpio_toggle(LED_STATUS_PIN);
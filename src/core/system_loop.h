@@ -60,6 +60,12 @@ extern "C"
      */
     void reset_loop_counter(void);
 
+    /**
+     * @brief Register a platform task to run once per main loop iteration
+     * @param hook Function to call (NULL to remove)
+     */
+    void register_main_loop_hook(void (*hook)(void));
+
     /**
      * @brief Perform heartbeat task (typically blinks status LED)
      */
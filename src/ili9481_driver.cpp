@@ -0,0 +1,434 @@
+/**
+ * @file ili9481_driver.cpp
+ * @brief ILI9481 TFT panel driver implementation
+ */
+
+#include "ili9481_driver.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define ILI9481_STAGING_PIXELS 320 // RGB666 conversion buffer: one screen row
+
+// Power, panel timing and gamma, as recommended for the common 3.5" modules.
+// Each entry: command, parameter count, parameters, delay in ms after it.
+static const uint8_t init_sequence[] = {
+    ILI9481_CMD_SLPOUT, 0, ILI9481_WAKE_SETTLE_MS,
+    0xD0, 3, 0x07, 0x42, 0x18, 0,                                           // Power setting
+    0xD1, 3, 0x00, 0x07, 0x10, 0,                                           // VCOM control
+    0xD2, 2, 0x01, 0x02, 0,                                                 // Power setting, normal mode
+    0xC0, 5, 0x10, 0x3B, 0x00, 0x02, 0x11, 0,                               // Panel driving
+    0xC5, 1, 0x03, 0,                                                       // Frame rate: 72 Hz
+    0xC8, 12, 0x00, 0x32, 0x36, 0x45, 0x06, 0x16, 0x37, 0x75, 0x77, 0x54, 0x0C, 0x00, 0, // Gamma
+};
+
+// =============================================================================
+// PRIVATE TYPES
+// =============================================================================
+
+typedef struct
+{
+    bool initialized;
+    ili9481_config_t config;
+    uint16_t width;
+    uint16_t height;
+    bool asleep;
+    uint32_t sleep_ms; // When SLPIN was sent
+
+    // Window the panel has now; a range is unknown while its start > end
+    uint16_t col_start, col_end;
+    uint16_t page_start, page_end;
+
+    // Command bytes are sent by DMA from here, so they outlive the call that queued them
+    uint8_t caset[5];
+    uint8_t paset[5];
+    uint8_t ramwr[1];
+    uint8_t setup[2];
+    uint8_t vscrdef[7];
+    uint8_t vscrsadd[3];
+    uint16_t fill_color;
+    uint8_t staging[ILI9481_STAGING_PIXELS * 3];
+
+    ili9481_stats_t stats;
+} ili9481_context_t;
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static ili9481_context_t panel = {};
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+/**
+ * @brief Queue one transfer, waiting for a free slot if the SPI queue is full
+ */
+static void queue(const void *data, size_t size, bool is_data, uint8_t data_bits, bool repeat)
+{
+    spi_transfer_t t = {};
+    t.tx_data = (const uint8_t *)data;
+    t.tx_repeat = repeat;
+    t.size = size;
+    t.data_bits = data_bits;
+    t.cs_pin = panel.config.cs_pin;
+    t.dc_pin = panel.config.dc_pin;
+    t.dc_level = is_data;
+
+    while (hal_spi_transfer_async(panel.config.spi_id, &t) == HAL_BUSY)
+    {
+        hal_spi_poll(); // Slots of transfers with callbacks free up there
+    }
+}
+
+/**
+ * @brief Queue a command and its parameters (both must outlive the transfer)
+ */
+static void queue_command(const uint8_t *command, const uint8_t *params, size_t count)
+{
+    queue(command, 1, false, 8, false);
+    if (count)
+    {
+        queue(params, count, true, 8, false);
+    }
+    panel.stats.command_bytes += 1 + count;
+}
+
+static void put_range(uint8_t *buf, uint8_t command, uint16_t start, uint16_t end)
+{
+    buf[0] = command;
+    buf[1] = (uint8_t)(start >> 8);
+    buf[2] = (uint8_t)start;
+    buf[3] = (uint8_t)(end >> 8);
+    buf[4] = (uint8_t)end;
+}
+
+/**
+ * @brief Point RAMWR at a panel area (inclusive bounds), sending only the ranges that changed
+ */
+static void set_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    if (x0 != panel.col_start || x1 != panel.col_end)
+    {
+        put_range(panel.caset, ILI9481_CMD_CASET, x0, x1);
+        queue_command(&panel.caset[0], &panel.caset[1], 4);
+        panel.col_start = x0;
+        panel.col_end = x1;
+        panel.stats.window_commands++;
+    }
+    else
+    {
+        panel.stats.window_skipped++;
+    }
+
+    if (y0 != panel.page_start || y1 != panel.page_end)
+    {
+        put_range(panel.paset, ILI9481_CMD_PASET, y0, y1);
+        queue_command(&panel.paset[0], &panel.paset[1], 4);
+        panel.page_start = y0;
+        panel.page_end = y1;
+        panel.stats.window_commands++;
+    }
+    else
+    {
+        panel.stats.window_skipped++;
+    }
+
+    panel.ramwr[0] = ILI9481_CMD_RAMWR;
+    queue_command(panel.ramwr, NULL, 0);
+}
+
+static void forget_window(void)
+{
+    panel.col_start = panel.page_start = 1;
+    panel.col_end = panel.page_end = 0;
+}
+
+static void rgb666(uint8_t *out, uint16_t pixel)
+{
+    uint8_t r = (uint8_t)(pixel >> 11), g = (uint8_t)((pixel >> 5) & 0x3F), b = (uint8_t)(pixel & 0x1F);
+    out[0] = (uint8_t)(r << 3 | r >> 2);
+    out[1] = (uint8_t)(g << 2 | g >> 4);
+    out[2] = (uint8_t)(b << 3 | b >> 2);
+}
+
+/**
+ * @brief Queue one row of pixels in the configured format
+ */
+static void queue_row(const uint16_t *pixels, uint16_t count)
+{
+    if (panel.config.pixel_format == ILI9481_RGB565)
+    {
+        // 16-bit frames send each halfword MSB first: RGB565 as the panel wants it, no byte swapping
+        queue(pixels, (size_t)count * 2, true, 16, false);
+        panel.stats.pixel_bytes += (size_t)count * 2;
+        return;
+    }
+
+    // RGB666 is converted through the staging buffer, which has to be sent before it is refilled
+    while (count)
+    {
+        uint16_t n = count < ILI9481_STAGING_PIXELS ? count : ILI9481_STAGING_PIXELS;
+        hal_spi_wait(panel.config.spi_id, 100);
+        for (uint16_t i = 0; i < n; i++)
+        {
+            rgb666(&panel.staging[i * 3], pixels[i]);
+        }
+        queue(panel.staging, (size_t)n * 3, true, 8, false);
+        panel.stats.pixel_bytes += (size_t)n * 3;
+        pixels += n;
+        count -= n;
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+hal_status_t ili9481_init(const ili9481_config_t *config)
+{
+    if (config == NULL || config->dc_pin == SPI_NO_PIN)
+    {
+        return HAL_INVALID_PARAM;
+    }
+
+    memset(&panel, 0, sizeof(panel));
+    panel.config = *config;
+    bool landscape = (config->madctl & ILI9481_MADCTL_MV) != 0;
+    panel.width = landscape ? ILI9481_NATIVE_HEIGHT : ILI9481_NATIVE_WIDTH;
+    panel.height = landscape ? ILI9481_NATIVE_WIDTH : ILI9481_NATIVE_HEIGHT;
+    forget_window();
+
+    hal_gpio_config(config->dc_pin, GPIO_OUTPUT);
+    if (config->cs_pin != SPI_NO_PIN)
+    {
+        hal_gpio_config(config->cs_pin, GPIO_OUTPUT);
+        hal_gpio_write(config->cs_pin, GPIO_HIGH);
+    }
+    if (config->rst_pin != SPI_NO_PIN)
+    {
+        hal_gpio_config(config->rst_pin, GPIO_OUTPUT);
+        hal_gpio_write(config->rst_pin, GPIO_HIGH);
+        hal_delay_ms(5);
+        hal_gpio_write(config->rst_pin, GPIO_LOW);
+        hal_delay_ms(20);
+        hal_gpio_write(config->rst_pin, GPIO_HIGH);
+        hal_delay_ms(150); // Reset to first command
+    }
+
+    for (size_t i = 0; i < sizeof(init_sequence);)
+    {
+        const uint8_t *entry = &init_sequence[i];
+        uint8_t count = entry[1];
+        queue_command(&entry[0], &entry[2], count);
+        if (hal_spi_wait(config->spi_id, 100) != HAL_OK)
+        {
+            printf("[ILI9481] No response from SPI%d\n", config->spi_id);
+            return HAL_TIMEOUT;
+        }
+        if (entry[2 + count])
+        {
+            hal_delay_ms(entry[2 + count]);
+        }
+        i += 3 + count;
+    }
+
+    panel.setup[0] = ILI9481_CMD_MADCTL;
+    panel.setup[1] = config->madctl;
+    queue_command(&panel.setup[0], &panel.setup[1], 1);
+    hal_spi_wait(config->spi_id, 100);
+    panel.setup[0] = ILI9481_CMD_COLMOD;
+    panel.setup[1] = (uint8_t)config->pixel_format;
+    queue_command(&panel.setup[0], &panel.setup[1], 1);
+    hal_spi_wait(config->spi_id, 100);
+
+    panel.initialized = true;
+
+    // RAM holds noise after reset; the screen area is sent by the display layer, the border only here
+    ili9481_fill(0, 0, panel.width, panel.height, 0x0000);
+
+    panel.setup[0] = ILI9481_CMD_DISPON;
+    queue_command(&panel.setup[0], NULL, 0);
+    hal_status_t status = hal_spi_wait(config->spi_id, 1000);
+    hal_delay_ms(25);
+
+    printf("[ILI9481] %ux%u panel ready, %s over SPI%d\n", panel.width, panel.height,
+           config->pixel_format == ILI9481_RGB565 ? "RGB565" : "RGB666", config->spi_id);
+
+    return status;
+}
+
+void ili9481_push(const fb_rect_t *rect, const uint16_t *pixels, uint16_t stride, void *context)
+{
+    (void)context;
+    if (!panel.initialized || rect->width == 0 || rect->height == 0)
+    {
+        return;
+    }
+
+    uint16_t x = (uint16_t)(rect->x + panel.config.x_offset);
+    uint16_t y = (uint16_t)(rect->y + panel.config.y_offset);
+    set_window(x, y, (uint16_t)(x + rect->width - 1), (uint16_t)(y + rect->height - 1));
+
+    if (stride == rect->width && panel.config.pixel_format == ILI9481_RGB565)
+    {
+        // Rows are contiguous: one transfer for the whole area
+        queue(pixels, (size_t)rect->width * rect->height * 2, true, 16, false);
+        panel.stats.pixel_bytes += (size_t)rect->width * rect->height * 2;
+    }
+    else
+    {
+        for (uint16_t row = 0; row < rect->height; row++)
+        {
+            queue_row(&pixels[(size_t)row * stride], rect->width);
+        }
+    }
+    panel.stats.pushes++;
+}
+
+void ili9481_wait(void *context)
+{
+    (void)context;
+    if (panel.initialized)
+    {
+        hal_spi_wait(panel.config.spi_id, 1000);
+    }
+}
+
+hal_status_t ili9481_fill(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color)
+{
+    if (!panel.initialized || width == 0 || height == 0 || x + width > panel.width || y + height > panel.height)
+    {
+        return HAL_INVALID_PARAM;
+    }
+
+    // The colour and staging buffer may still be in use by an earlier fill
+    hal_spi_wait(panel.config.spi_id, 1000);
+    set_window(x, y, (uint16_t)(x + width - 1), (uint16_t)(y + height - 1));
+
+    size_t pixels = (size_t)width * height;
+    if (panel.config.pixel_format == ILI9481_RGB565)
+    {
+        // One halfword sent over and over
+        panel.fill_color = color;
+        queue(&panel.fill_color, pixels * 2, true, 16, true);
+        panel.stats.pixel_bytes += pixels * 2;
+    }
+    else
+    {
+        // Three bytes per pixel do not repeat as one DMA frame: send a staging row of them
+        for (uint16_t i = 0; i < ILI9481_STAGING_PIXELS; i++)
+        {
+            rgb666(&panel.staging[i * 3], color);
+        }
+        while (pixels)
+        {
+            size_t n = pixels < ILI9481_STAGING_PIXELS ? pixels : ILI9481_STAGING_PIXELS;
+            queue(panel.staging, n * 3, true, 8, false);
+            panel.stats.pixel_bytes += n * 3;
+            pixels -= n;
+        }
+    }
+    return HAL_OK;
+}
+
+hal_status_t ili9481_set_scroll_area(uint16_t first, uint16_t count)
+{
+    if (!panel.initialized || first + count > ILI9481_NATIVE_HEIGHT)
+    {
+        return HAL_INVALID_PARAM;
+    }
+    if (count == 0)
+    {
+        // All lines in one area at its start: the memory shows unrotated
+        first = 0;
+        count = ILI9481_NATIVE_HEIGHT;
+    }
+
+    // The parameter buffers may still be in use by an earlier call
+    hal_spi_wait(panel.config.spi_id, 1000);
+    uint16_t bottom = (uint16_t)(ILI9481_NATIVE_HEIGHT - first - count);
+    uint8_t *p = panel.vscrdef;
+    p[0] = ILI9481_CMD_VSCRDEF;
+    p[1] = (uint8_t)(first >> 8);
+    p[2] = (uint8_t)first;
+    p[3] = (uint8_t)(count >> 8);
+    p[4] = (uint8_t)count;
+    p[5] = (uint8_t)(bottom >> 8);
+    p[6] = (uint8_t)bottom;
+    queue_command(&p[0], &p[1], 6);
+    ili9481_scroll_to(first);
+    return HAL_OK;
+}
+
+void ili9481_scroll_to(uint16_t line)
+{
+    if (!panel.initialized)
+    {
+        return;
+    }
+    panel.vscrsadd[0] = ILI9481_CMD_VSCRSADD;
+    panel.vscrsadd[1] = (uint8_t)(line >> 8);
+    panel.vscrsadd[2] = (uint8_t)line;
+    queue_command(&panel.vscrsadd[0], &panel.vscrsadd[1], 2);
+}
+
+hal_status_t ili9481_set_sleep(bool sleep)
+{
+    if (!panel.initialized)
+    {
+        return HAL_ERROR;
+    }
+    if (sleep == panel.asleep)
+    {
+        return HAL_OK;
+    }
+
+    // The setup buffer may still be in use by an earlier command
+    hal_spi_wait(panel.config.spi_id, 1000);
+    if (sleep)
+    {
+        panel.setup[0] = ILI9481_CMD_DISPOFF;
+        panel.setup[1] = ILI9481_CMD_SLPIN;
+        queue_command(&panel.setup[0], NULL, 0);
+        queue_command(&panel.setup[1], NULL, 0);
+        panel.sleep_ms = hal_get_tick_ms();
+    }
+    else
+    {
+        uint32_t asleep_ms = hal_get_tick_ms() - panel.sleep_ms;
+        if (asleep_ms < ILI9481_SLEEP_SETTLE_MS)
+        {
+            hal_delay_ms(ILI9481_SLEEP_SETTLE_MS - asleep_ms);
+        }
+        panel.setup[0] = ILI9481_CMD_SLPOUT;
+        queue_command(&panel.setup[0], NULL, 0);
+        hal_spi_wait(panel.config.spi_id, 1000);
+        hal_delay_ms(ILI9481_WAKE_SETTLE_MS);
+        panel.setup[0] = ILI9481_CMD_DISPON;
+        queue_command(&panel.setup[0], NULL, 0);
+    }
+    panel.asleep = sleep;
+    return hal_spi_wait(panel.config.spi_id, 1000);
+}
+
+void ili9481_get_stats(ili9481_stats_t *stats)
+{
+    if (stats)
+    {
+        *stats = panel.stats;
+    }
+}
+
+void ili9481_get_size(uint16_t *width, uint16_t *height)
+{
+    if (width)
+        *width = panel.width;
+    if (height)
+        *height = panel.height;
+}
@@ -0,0 +1,407 @@
+/**
+ * @file mock_display.cpp
+ * @brief Host ILI9481 panel mock implementation
+ */
+
+#include "mock_display.h"
+#include "hal_interface.h"
+#include "ili9481_driver.h"
+
+#include <string.h>
+#include <vector>
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+namespace
+{
+    struct PendingCallback
+    {
+        spi_complete_callback_t callback;
+        uint8_t spi_id;
+        void *context;
+    };
+
+    struct Panel
+    {
+        std::vector<uint16_t> memory;
+        std::vector<uint16_t> screen; // memory as shown, built on request
+        uint16_t width = ILI9481_NATIVE_WIDTH;
+        uint16_t height = ILI9481_NATIVE_HEIGHT;
+        uint8_t colmod = ILI9481_RGB565;
+        bool on = false;
+        bool sleeping = true;
+        bool landscape = false;
+
+        // Vertical scrolling, in gate lines (columns in landscape)
+        uint16_t scroll_first = 0;
+        uint16_t scroll_count = ILI9481_NATIVE_HEIGHT;
+        uint16_t scroll_start = 0;
+
+        uint16_t col_start = 0, col_end = ILI9481_NATIVE_WIDTH - 1;
+        uint16_t page_start = 0, page_end = ILI9481_NATIVE_HEIGHT - 1;
+
+        // Command being received and its data so far
+        uint8_t command = 0;
+        std::vector<uint8_t> params;
+        uint16_t col = 0, page = 0; // RAMWR write position
+        uint8_t pixel[3] = {};
+        uint8_t pixel_fill = 0;
+
+        mock_display_counters_t counters = {};
+        std::vector<mock_display_command_t> log;
+        std::vector<PendingCallback> pending;
+    };
+
+    Panel panel;
+}
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static void resize(uint16_t width, uint16_t height)
+{
+    panel.width = width;
+    panel.height = height;
+    panel.memory.assign((size_t)width * height, 0);
+}
+
+static uint16_t range_start(void)
+{
+    return (uint16_t)(panel.params[0] << 8 | panel.params[1]);
+}
+
+static uint16_t range_end(void)
+{
+    return (uint16_t)(panel.params[2] << 8 | panel.params[3]);
+}
+
+/**
+ * @brief Apply a command once its parameters are in
+ */
+static void parameters_done(void)
+{
+    switch (panel.command)
+    {
+    case ILI9481_CMD_CASET:
+        if (panel.params.size() >= 4)
+        {
+            panel.col_start = range_start();
+            panel.col_end = range_end();
+        }
+        break;
+    case ILI9481_CMD_PASET:
+        if (panel.params.size() >= 4)
+        {
+            panel.page_start = range_start();
+            panel.page_end = range_end();
+        }
+        break;
+    case ILI9481_CMD_MADCTL:
+        if (!panel.params.empty())
+        {
+            panel.landscape = (panel.params[0] & ILI9481_MADCTL_MV) != 0;
+            resize(panel.landscape ? ILI9481_NATIVE_HEIGHT : ILI9481_NATIVE_WIDTH,
+                   panel.landscape ? ILI9481_NATIVE_WIDTH : ILI9481_NATIVE_HEIGHT);
+        }
+        break;
+    case ILI9481_CMD_VSCRDEF:
+        if (panel.params.size() >= 6 && range_start() + range_end() <= ILI9481_NATIVE_HEIGHT)
+        {
+            // Top fixed, scrolling and bottom fixed lines; the bottom is implied by the other two
+            panel.scroll_first = range_start();
+            panel.scroll_count = range_end();
+        }
+        break;
+    case ILI9481_CMD_VSCRSADD:
+        if (panel.params.size() >= 2)
+        {
+            panel.scroll_start = range_start();
+        }
+        break;
+    case ILI9481_CMD_COLMOD:
+        if (!panel.params.empty())
+        {
+            panel.colmod = panel.params[0];
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void write_pixel(uint16_t rgb565)
+{
+    if (panel.page > panel.page_end)
+    {
+        return; // Past the window: the panel ignores it
+    }
+    if (panel.col < panel.width && panel.page < panel.height)
+    {
+        panel.memory[(size_t)panel.page * panel.width + panel.col] = rgb565;
+    }
+    if (++panel.col > panel.col_end)
+    {
+        panel.col = panel.col_start;
+        panel.page++;
+    }
+}
+
+static void command_byte(uint8_t command)
+{
+    parameters_done();
+    panel.command = command;
+    panel.params.clear();
+    panel.pixel_fill = 0;
+    panel.counters.commands++;
+    panel.log.push_back({command, 0});
+
+    switch (command)
+    {
+    case ILI9481_CMD_CASET:
+    case ILI9481_CMD_PASET:
+        panel.counters.windows++;
+        break;
+    case ILI9481_CMD_RAMWR:
+        panel.counters.ram_writes++;
+        panel.col = panel.col_start;
+        panel.page = panel.page_start;
+        break;
+    case ILI9481_CMD_SLPIN:
+        panel.sleeping = true;
+        break;
+    case ILI9481_CMD_SLPOUT:
+        panel.sleeping = false;
+        break;
+    case ILI9481_CMD_DISPOFF:
+        panel.on = false;
+        break;
+    case ILI9481_CMD_DISPON:
+        panel.on = true;
+        break;
+    default:
+        break;
+    }
+}
+
+static void data_byte(uint8_t byte)
+{
+    if (!panel.log.empty())
+    {
+        panel.log.back().data_bytes++;
+    }
+    if (panel.command != ILI9481_CMD_RAMWR)
+    {
+        panel.params.push_back(byte);
+        // A scroll takes effect without waiting for the next command (applying it again then changes nothing)
+        if ((panel.command == ILI9481_CMD_VSCRSADD && panel.params.size() == 2) ||
+            (panel.command == ILI9481_CMD_VSCRDEF && panel.params.size() == 6))
+        {
+            parameters_done();
+        }
+        return;
+    }
+
+    panel.counters.pixel_bytes++;
+    panel.pixel[panel.pixel_fill++] = byte;
+    if (panel.colmod == ILI9481_RGB666 && panel.pixel_fill == 3)
+    {
+        // Top six bits of each byte; back to RGB565 by dropping the lowest red and blue bit
+        write_pixel((uint16_t)((panel.pixel[0] >> 3) << 11 | (panel.pixel[1] >> 2) << 5 | panel.pixel[2] >> 3));
+        panel.pixel_fill = 0;
+    }
+    else if (panel.colmod != ILI9481_RGB666 && panel.pixel_fill == 2)
+    {
+        write_pixel((uint16_t)(panel.pixel[0] << 8 | panel.pixel[1]));
+        panel.pixel_fill = 0;
+    }
+}
+
+static void bus_byte(uint8_t byte, bool is_data)
+{
+    panel.counters.bytes++;
+    if (is_data)
+    {
+        data_byte(byte);
+    }
+    else
+    {
+        command_byte(byte);
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void mock_display_reset(void)
+{
+    panel = Panel();
+    resize(ILI9481_NATIVE_WIDTH, ILI9481_NATIVE_HEIGHT);
+}
+
+void mock_display_clear_counters(void)
+{
+    memset(&panel.counters, 0, sizeof(panel.counters));
+    panel.log.clear();
+}
+
+void mock_display_get_counters(mock_display_counters_t *counters)
+{
+    if (counters)
+    {
+        *counters = panel.counters;
+    }
+}
+
+size_t mock_display_get_commands(mock_display_command_t *out, size_t max)
+{
+    for (size_t i = 0; out != nullptr && i < max && i < panel.log.size(); i++)
+    {
+        out[i] = panel.log[i];
+    }
+    return panel.log.size();
+}
+
+const uint16_t *mock_display_get_pixels(uint16_t *width, uint16_t *height)
+{
+    if (panel.memory.empty())
+    {
+        resize(panel.width, panel.height);
+    }
+    if (width)
+        *width = panel.width;
+    if (height)
+        *height = panel.height;
+    return panel.memory.data();
+}
+
+const uint16_t *mock_display_get_screen(uint16_t *width, uint16_t *height)
+{
+    const uint16_t *memory = mock_display_get_pixels(width, height);
+    panel.screen = panel.memory;
+
+    uint16_t first = panel.scroll_first, count = panel.scroll_count;
+    if (count == 0 || panel.scroll_start < first || panel.scroll_start >= first + count)
+    {
+        return panel.screen.data();
+    }
+    // Line first + i of the area shows memory line first + (start - first + i) % count
+    for (uint16_t i = 0; i < count; i++)
+    {
+        uint16_t from = (uint16_t)(first + (panel.scroll_start - first + i) % count);
+        uint16_t to = (uint16_t)(first + i);
+        if (panel.landscape)
+        {
+            for (uint16_t row = 0; row < panel.height; row++)
+            {
+                panel.screen[(size_t)row * panel.width + to] = memory[(size_t)row * panel.width + from];
+            }
+        }
+        else
+        {
+            memcpy(&panel.screen[(size_t)to * panel.width], &memory[(size_t)from * panel.width],
+                   panel.width * sizeof(uint16_t));
+        }
+    }
+    return panel.screen.data();
+}
+
+bool mock_display_is_on(void)
+{
+    return panel.on;
+}
+
+bool mock_display_is_sleeping(void)
+{
+    return panel.sleeping;
+}
+
+// =============================================================================
+// HAL FUNCTIONS USED BY THE PANEL DRIVER
+// =============================================================================
+
+hal_status_t hal_spi_transfer_async(uint8_t spi_id, const spi_transfer_t *transfer)
+{
+    if (transfer == nullptr || transfer->size == 0)
+    {
+        return HAL_INVALID_PARAM;
+    }
+
+    // The DC pin is the only one the panel listens to besides the bus
+    bool is_data = transfer->dc_pin == SPI_NO_PIN || transfer->dc_level;
+    size_t frame = transfer->data_bits > 8 ? 2 : 1;
+    for (size_t i = 0; i < transfer->size; i += frame)
+    {
+        size_t offset = transfer->tx_repeat ? 0 : i;
+        if (transfer->tx_data == nullptr)
+        {
+            bus_byte(0xFF, is_data);
+            if (frame == 2)
+                bus_byte(0xFF, is_data);
+        }
+        else if (frame == 2)
+        {
+            // Halfwords leave MSB first: the high byte of each little-endian pair goes out first
+            bus_byte(transfer->tx_data[offset + 1], is_data);
+            bus_byte(transfer->tx_data[offset], is_data);
+        }
+        else
+        {
+            bus_byte(transfer->tx_data[offset], is_data);
+        }
+    }
+    if (transfer->rx_data)
+    {
+        memset(transfer->rx_data, 0, transfer->size);
+    }
+    if (transfer->callback)
+    {
+        panel.pending.push_back({transfer->callback, spi_id, transfer->context});
+    }
+    return HAL_OK;
+}
+
+bool hal_spi_is_busy(uint8_t spi_id)
+{
+    (void)spi_id;
+    return false;
+}
+
+hal_status_t hal_spi_wait(uint8_t spi_id, uint32_t timeout_ms)
+{
+    (void)spi_id;
+    (void)timeout_ms;
+    return HAL_OK;
+}
+
+void hal_spi_poll(void)
+{
+    std::vector<PendingCallback> pending;
+    pending.swap(panel.pending);
+    for (const PendingCallback &p : pending)
+    {
+        p.callback(p.spi_id, HAL_OK, p.context);
+    }
+}
+
+hal_status_t hal_gpio_config(uint32_t pin, gpio_mode_t mode)
+{
+    (void)pin;
+    (void)mode;
+    return HAL_OK;
+}
+
+hal_status_t hal_gpio_write(uint32_t pin, gpio_state_t state)
+{
+    (void)pin;
+    (void)state;
+    return HAL_OK;
+}
+
+void hal_delay_ms(uint32_t ms)
+{
+    panel.counters.delay_ms += ms;
+}
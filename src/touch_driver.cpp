@@ -0,0 +1,422 @@
+/**
+ * @file touch_driver.cpp
+ * @brief XPT2046 resistive touch controller driver implementation
+ */
+
+#include "touch_driver.h"
+#include "input_handler.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+// Z1, then the X readings, then the Y readings
+#define TOUCH_BURST_COMMANDS (1 + 2 * TOUCH_BURST_SAMPLES)
+
+// Each command byte is followed by the two bytes its result comes back in; the next command goes out
+// with the second of them
+#define TOUCH_BURST_BYTES (2 * TOUCH_BURST_COMMANDS + 1)
+
+#define TOUCH_SPI_TIMEOUT_MS 10
+
+// =============================================================================
+// PRIVATE TYPES
+// =============================================================================
+
+typedef struct
+{
+    bool initialized;
+    touch_config_t config;
+
+    volatile bool pen_irq; // Set by the PENIRQ interrupt, taken by touch_update()
+    bool sampling;         // Bursts run until the pressure drops
+    bool burst_queued;
+    uint32_t next_burst_ms;
+
+    // Burst buffers: read by DMA after touch_update() returns
+    uint8_t tx[TOUCH_BURST_BYTES];
+    uint8_t rx[TOUCH_BURST_BYTES];
+
+    // Current press
+    bool pressed;
+    int32_t filter_x; // Raw position, 4 fractional bits
+    int32_t filter_y;
+    touch_point_t position;
+    touch_point_t start;
+    touch_point_t reported; // Position of the last drag event
+    uint32_t press_ms;
+    bool dragging;
+    bool long_pressed;
+
+    touch_stats_t stats;
+} touch_context_t;
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static touch_context_t touch = {};
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static void pen_irq_handler(uint32_t pin)
+{
+    // PENIRQ also toggles during conversions: sampling runs with it off
+    hal_gpio_interrupt_disable(pin);
+    touch.pen_irq = true;
+}
+
+/**
+ * @brief Wait for the next pen-down, or start sampling at once if the pen is already down
+ */
+static void arm_pen_irq(void)
+{
+    hal_gpio_interrupt_enable(touch.config.irq_pin, 2, pen_irq_handler);
+
+    gpio_state_t level = GPIO_HIGH;
+    if (hal_gpio_read(touch.config.irq_pin, &level) == HAL_OK && level == GPIO_LOW)
+    {
+        hal_gpio_interrupt_disable(touch.config.irq_pin);
+        touch.pen_irq = true;
+    }
+}
+
+/**
+ * @brief 12-bit result of burst command i
+ */
+static uint16_t burst_result(int i)
+{
+    return (uint16_t)((((uint16_t)touch.rx[2 * i + 1] << 8) | touch.rx[2 * i + 2]) >> 3) & 0x0FFF;
+}
+
+/**
+ * @brief Median of the axis readings starting at burst command first
+ * @param spread Receives how far the middle three readings spread
+ */
+static uint16_t burst_median(int first, uint16_t *spread)
+{
+    uint16_t v[TOUCH_BURST_SAMPLES];
+    for (int i = 0; i < TOUCH_BURST_SAMPLES; i++)
+    {
+        // Insertion sort: five values
+        uint16_t value = burst_result(first + i);
+        int j = i;
+        for (; j > 0 && v[j - 1] > value; j--)
+        {
+            v[j] = v[j - 1];
+        }
+        v[j] = value;
+    }
+
+    int mid = TOUCH_BURST_SAMPLES / 2;
+    *spread = (uint16_t)(v[mid + 1] - v[mid - 1]);
+    return v[mid];
+}
+
+static int16_t clamp(int32_t value, uint16_t size)
+{
+    return (int16_t)(value < 0 ? 0 : (value >= size ? size - 1 : value));
+}
+
+static touch_point_t to_screen(int32_t raw_x, int32_t raw_y)
+{
+    const touch_calibration_t *cal = &touch.config.calibration;
+    touch_point_t p;
+    p.x = clamp((cal->a * raw_x + cal->b * raw_y + cal->c) >> 16, touch.config.width);
+    p.y = clamp((cal->d * raw_x + cal->e * raw_y + cal->f) >> 16, touch.config.height);
+    return p;
+}
+
+static void post(input_event_type_t type)
+{
+    input_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.type = type;
+    event.button_id = BUTTON_COUNT; // Not a button
+    event.timestamp = hal_get_tick_ms();
+    event.data.touch.x = touch.position.x;
+    event.data.touch.y = touch.position.y;
+    event.data.touch.start_x = touch.start.x;
+    event.data.touch.start_y = touch.start.y;
+    event.data.touch.duration_ms = event.timestamp - touch.press_ms;
+
+    if (!input_post_event(&event))
+    {
+        touch.stats.events_dropped++;
+    }
+}
+
+/**
+ * @brief A filtered position while pressed: start, drag or long press
+ */
+static void track(uint16_t raw_x, uint16_t raw_y)
+{
+    uint32_t now = hal_get_tick_ms();
+    input_note_activity(); // Holding still is activity too, though it posts nothing
+    if (!touch.pressed)
+    {
+        touch.pressed = true;
+        touch.filter_x = (int32_t)raw_x << 4;
+        touch.filter_y = (int32_t)raw_y << 4;
+        touch.position = to_screen(raw_x, raw_y);
+        touch.start = touch.position;
+        touch.reported = touch.position;
+        touch.press_ms = now;
+        touch.dragging = false;
+        touch.long_pressed = false;
+        return;
+    }
+
+    touch.filter_x += (((int32_t)raw_x << 4) - touch.filter_x) >> TOUCH_IIR_SHIFT;
+    touch.filter_y += (((int32_t)raw_y << 4) - touch.filter_y) >> TOUCH_IIR_SHIFT;
+    touch.position = to_screen(touch.filter_x >> 4, touch.filter_y >> 4);
+
+    int dx = touch.position.x - touch.start.x;
+    int dy = touch.position.y - touch.start.y;
+    if (!touch.dragging && dx * dx + dy * dy >= TOUCH_DRAG_THRESHOLD * TOUCH_DRAG_THRESHOLD)
+    {
+        touch.dragging = true;
+        touch.stats.drags++;
+    }
+
+    if (touch.dragging)
+    {
+        if (touch.position.x != touch.reported.x || touch.position.y != touch.reported.y)
+        {
+            touch.reported = touch.position;
+            post(INPUT_EVENT_TOUCH_DRAG);
+        }
+    }
+    else if (!touch.long_pressed && now - touch.press_ms >= TOUCH_LONG_PRESS_MS)
+    {
+        touch.long_pressed = true;
+        touch.stats.long_presses++;
+        post(INPUT_EVENT_TOUCH_LONG_PRESS);
+    }
+}
+
+/**
+ * @brief The pressure dropped: finish the gesture and go back to waiting for PENIRQ
+ */
+static void release(void)
+{
+    if (touch.pressed)
+    {
+        if (touch.dragging)
+        {
+            post(INPUT_EVENT_TOUCH_DRAG_END);
+        }
+        else if (!touch.long_pressed)
+        {
+            touch.stats.taps++;
+            post(INPUT_EVENT_TOUCH_TAP);
+        }
+    }
+    touch.pressed = false;
+    touch.sampling = false;
+    arm_pen_irq();
+}
+
+static void burst_done(uint8_t spi_id, hal_status_t status, void *context)
+{
+    (void)spi_id;
+    (void)context;
+    touch.burst_queued = false;
+    if (status != HAL_OK)
+    {
+        touch.stats.rejected++;
+        return; // Try again next interval
+    }
+
+    touch.stats.bursts++;
+    if (burst_result(0) < touch.config.pressure_min)
+    {
+        release();
+        return;
+    }
+
+    uint16_t spread_x, spread_y;
+    uint16_t raw_x = burst_median(1, &spread_x);
+    uint16_t raw_y = burst_median(1 + TOUCH_BURST_SAMPLES, &spread_y);
+    if (spread_x > TOUCH_MAX_SPREAD || spread_y > TOUCH_MAX_SPREAD)
+    {
+        touch.stats.rejected++;
+        return;
+    }
+    track(raw_x, raw_y);
+}
+
+static hal_status_t queue_burst(spi_complete_callback_t callback, size_t size)
+{
+    spi_transfer_t t = {};
+    t.tx_data = touch.tx;
+    t.rx_data = touch.rx;
+    t.size = size;
+    t.data_bits = 8;
+    t.frequency = touch.config.frequency;
+    t.cs_pin = touch.config.cs_pin;
+    t.dc_pin = SPI_NO_PIN;
+    t.callback = callback;
+    return hal_spi_transfer_async(touch.config.spi_id, &t);
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+hal_status_t touch_init(const touch_config_t *config)
+{
+    if (config == NULL || config->cs_pin < 0 || config->width == 0 || config->height == 0)
+    {
+        return HAL_INVALID_PARAM;
+    }
+
+    memset(&touch, 0, sizeof(touch));
+    touch.config = *config;
+
+    hal_gpio_config((uint32_t)config->cs_pin, GPIO_OUTPUT);
+    hal_gpio_write((uint32_t)config->cs_pin, GPIO_HIGH);
+    hal_gpio_config(config->irq_pin, GPIO_INPUT_PULLUP);
+
+    // The burst: every conversion keeps the ADC on except the last, which powers down with PENIRQ enabled
+    int i = 0;
+    touch.tx[0] = XPT2046_CMD_Z1 | XPT2046_PD_ADC_ON;
+    for (i = 1; i <= TOUCH_BURST_SAMPLES; i++)
+    {
+        touch.tx[2 * i] = XPT2046_CMD_X | XPT2046_PD_ADC_ON;
+    }
+    for (; i < TOUCH_BURST_COMMANDS; i++)
+    {
+        touch.tx[2 * i] = XPT2046_CMD_Y | (i < TOUCH_BURST_COMMANDS - 1 ? XPT2046_PD_ADC_ON : 0);
+    }
+
+    // Its last command alone puts a controller in an unknown state into PENIRQ mode
+    uint8_t command[3] = {touch.tx[2 * (TOUCH_BURST_COMMANDS - 1)], 0, 0};
+    spi_transfer_t t = {};
+    t.tx_data = command;
+    t.size = sizeof(command);
+    t.data_bits = 8;
+    t.frequency = config->frequency;
+    t.cs_pin = config->cs_pin;
+    t.dc_pin = SPI_NO_PIN;
+    hal_status_t status = hal_spi_transfer_async(config->spi_id, &t);
+    if (status == HAL_OK)
+    {
+        status = hal_spi_wait(config->spi_id, TOUCH_SPI_TIMEOUT_MS);
+    }
+    if (status != HAL_OK)
+    {
+        printf("[TOUCH] XPT2046 not reachable on SPI%d (status %d)\n", config->spi_id, status);
+        return status;
+    }
+
+    touch.initialized = true;
+    arm_pen_irq();
+    printf("[TOUCH] XPT2046 ready: PENIRQ on GPIO %lu, %u-sample bursts every %u ms while pressed\n",
+           (unsigned long)config->irq_pin, TOUCH_BURST_SAMPLES, config->interval_ms);
+    return HAL_OK;
+}
+
+void touch_update(void)
+{
+    if (!touch.initialized)
+    {
+        return;
+    }
+
+    if (touch.pen_irq)
+    {
+        touch.pen_irq = false;
+        touch.sampling = true;
+        touch.next_burst_ms = hal_get_tick_ms();
+        touch.stats.pen_downs++;
+    }
+
+    if (!touch.sampling || touch.burst_queued || (int32_t)(hal_get_tick_ms() - touch.next_burst_ms) < 0)
+    {
+        return;
+    }
+
+    if (queue_burst(burst_done, TOUCH_BURST_BYTES) == HAL_OK)
+    {
+        touch.burst_queued = true;
+        touch.next_burst_ms += touch.config.interval_ms;
+        if ((int32_t)(hal_get_tick_ms() - touch.next_burst_ms) > 0)
+        {
+            touch.next_burst_ms = hal_get_tick_ms(); // Fell behind: no catching up
+        }
+    }
+}
+
+bool touch_calibrate(const touch_point_t raw[3], const touch_point_t screen[3], touch_calibration_t *calibration)
+{
+    if (raw == NULL || screen == NULL || calibration == NULL)
+    {
+        return false;
+    }
+
+    int64_t xr0 = raw[0].x, yr0 = raw[0].y, xr1 = raw[1].x, yr1 = raw[1].y, xr2 = raw[2].x, yr2 = raw[2].y;
+    int64_t divisor = (xr0 - xr2) * (yr1 - yr2) - (xr1 - xr2) * (yr0 - yr2);
+    if (divisor == 0)
+    {
+        return false;
+    }
+
+    // Cramer's rule for each screen axis, scaled to 16.16
+    int64_t coeff[6];
+    for (int axis = 0; axis < 2; axis++)
+    {
+        int64_t s0 = axis ? screen[0].y : screen[0].x;
+        int64_t s1 = axis ? screen[1].y : screen[1].x;
+        int64_t s2 = axis ? screen[2].y : screen[2].x;
+        coeff[axis * 3 + 0] = (s0 - s2) * (yr1 - yr2) - (s1 - s2) * (yr0 - yr2);
+        coeff[axis * 3 + 1] = (xr0 - xr2) * (s1 - s2) - (s0 - s2) * (xr1 - xr2);
+        coeff[axis * 3 + 2] = yr0 * (xr2 * s1 - xr1 * s2) + yr1 * (xr0 * s2 - xr2 * s0) + yr2 * (xr1 * s0 - xr0 * s1);
+    }
+
+    int32_t *out = &calibration->a;
+    for (int i = 0; i < 6; i++)
+    {
+        out[i] = (int32_t)(coeff[i] * 65536 / divisor);
+    }
+    return true;
+}
+
+void touch_set_calibration(const touch_calibration_t *calibration)
+{
+    if (calibration)
+    {
+        touch.config.calibration = *calibration;
+    }
+}
+
+bool touch_get_position(touch_point_t *point, touch_point_t *raw)
+{
+    if (!touch.pressed)
+    {
+        return false;
+    }
+    if (point)
+    {
+        *point = touch.position;
+    }
+    if (raw)
+    {
+        raw->x = (int16_t)(touch.filter_x >> 4);
+        raw->y = (int16_t)(touch.filter_y >> 4);
+    }
+    return true;
+}
+
+void touch_get_stats(touch_stats_t *stats)
+{
+    if (stats)
+    {
+        *stats = touch.stats;
+    }
+}
@@ -0,0 +1,716 @@
+/**
+ * @file display_manager.cpp
+ * @brief Retained-mode widget implementation
+ */
+
+#include "display_manager.h"
+#include "../utils/hal_interface.h"
+#include "../utils/framebuffer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define UI_DIRTY_CONTENT 0x01 // What the widget shows changed
+#define UI_DIRTY_FULL 0x02    // Draw all of it (new, shown again, or painted over)
+#define UI_DIRTY_ERASE 0x04   // Hidden: paint its area with the parent's background
+
+#define UI_NO_LEVEL 0xFF // Sparkline column without a sample
+
+#define UI_PLOT_WIDTH (UI_SPARKLINE_MAX_WIDTH - 2)
+#define UI_PLOT_HEIGHT (UI_SPARKLINE_MAX_HEIGHT - 2)
+
+// =============================================================================
+// PRIVATE TYPES
+// =============================================================================
+
+typedef struct
+{
+    uint8_t type;    // ui_widget_type_t
+    uint8_t dirty;   // UI_DIRTY_*
+    bool visible;    // Own flag: shown only if its panels are too
+    ui_widget_id_t parent;
+    uint16_t x;      // Screen position
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint32_t color;  // Panel background, text, bar fill, plot line, LED
+    uint32_t border; // Panel, bar and sparkline border
+    uint32_t empty;  // Bar: unfilled part
+
+    char text[UI_TEXT_MAX]; // Label text; value as drawn
+    char unit[UI_UNIT_MAX];
+    uint8_t width_chars;
+    uint8_t decimals;
+    uint8_t percent;  // Bar level
+    int8_t sparkline; // Sparkline: plot slot
+    float min;
+    float max;
+} ui_widget_t;
+
+/**
+ * @brief A sparkline's plot, kept as the pixels last blitted
+ */
+typedef struct
+{
+    bool used;
+    uint8_t level[UI_PLOT_WIDTH]; // Row of each column's sample (0 = top), UI_NO_LEVEL for none
+    uint8_t top[UI_PLOT_WIDTH];   // Rows each column shows, top > bottom for none
+    uint8_t bottom[UI_PLOT_WIDTH];
+    uint8_t pixels[UI_PLOT_WIDTH * UI_PLOT_HEIGHT * 2]; // Little-endian RGB565, rows the plot's width apart
+} ui_plot_t;
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static struct
+{
+    ui_widget_t widgets[UI_MAX_WIDGETS];
+    uint8_t count;
+    uint32_t period_ms;
+    uint32_t last_update_ms;
+    ui_stats_t stats;
+} ui;
+
+static ui_plot_t ui_plots[UI_MAX_SPARKLINES];
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static ui_widget_t *widget(ui_widget_id_t id, ui_widget_type_t type)
+{
+    if (id < 0 || id >= ui.count || ui.widgets[id].type != type)
+    {
+        return NULL;
+    }
+    return &ui.widgets[id];
+}
+
+/**
+ * @brief Whether a is b or one of b's panels
+ */
+static bool is_ancestor(ui_widget_id_t a, ui_widget_id_t b)
+{
+    for (; b != UI_NO_WIDGET; b = ui.widgets[b].parent)
+    {
+        if (a == b)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Whether a widget and all its panels are visible
+ */
+static bool shown(ui_widget_id_t id)
+{
+    for (; id != UI_NO_WIDGET; id = ui.widgets[id].parent)
+    {
+        if (!ui.widgets[id].visible)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t background_of(const ui_widget_t *w)
+{
+    return ui.widgets[w->parent].color;
+}
+
+static bool overlaps(const ui_widget_t *a, const ui_widget_t *b)
+{
+    return a->x < b->x + b->width && b->x < a->x + a->width && a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+static void mark(ui_widget_t *w, uint8_t flags)
+{
+    w->dirty |= flags;
+}
+
+/**
+ * @brief Add a widget inside a panel
+ * @return The widget, NULL if out of widgets or it does not fit
+ */
+static ui_widget_t *add(ui_widget_id_t parent, ui_widget_type_t type, uint16_t x, uint16_t y, uint16_t width,
+                        uint16_t height)
+{
+    const ui_widget_t *p = widget(parent, UI_WIDGET_PANEL);
+    if (p == NULL || ui.count == UI_MAX_WIDGETS || width == 0 || height == 0 || x + width > p->width ||
+        y + height > p->height)
+    {
+        return NULL;
+    }
+
+    ui_widget_t *w = &ui.widgets[ui.count++];
+    memset(w, 0, sizeof(*w));
+    w->type = (uint8_t)type;
+    w->dirty = UI_DIRTY_FULL;
+    w->visible = true;
+    w->parent = parent;
+    w->x = (uint16_t)(p->x + x);
+    w->y = (uint16_t)(p->y + y);
+    w->width = width;
+    w->height = height;
+    w->sparkline = -1;
+    return w;
+}
+
+static ui_widget_id_t id_of(const ui_widget_t *w)
+{
+    return w == NULL ? UI_NO_WIDGET : (ui_widget_id_t)(w - ui.widgets);
+}
+
+/**
+ * @brief Format a value into its cells, right-aligned, '*' if it does not fit
+ */
+static void format_value(const ui_widget_t *w, float value, char *out)
+{
+    size_t unit_len = strlen(w->unit); // Below UI_UNIT_MAX, so the clamp leaves room for it
+    int digits = w->width_chars > unit_len ? (int)(w->width_chars - unit_len) : 0;
+    if (digits > (int)(UI_TEXT_MAX - 1 - unit_len))
+    {
+        digits = (int)(UI_TEXT_MAX - 1 - unit_len);
+    }
+
+    char number[48];
+    if (isnan(value))
+    {
+        snprintf(number, sizeof(number), "--");
+    }
+    else
+    {
+        snprintf(number, sizeof(number), "%.*f", w->decimals, (double)value);
+    }
+    size_t number_len = strlen(number);
+    if (number_len > (size_t)digits)
+    {
+        memset(number, '*', (size_t)digits);
+        number_len = (size_t)digits;
+    }
+
+    // Padding, number, unit and terminator: digits + unit_len + 1 <= UI_TEXT_MAX
+    size_t pad = (size_t)digits - number_len;
+    memset(out, ' ', pad);
+    memcpy(out + pad, number, number_len);
+    memcpy(out + digits, w->unit, unit_len + 1);
+}
+
+static void set_plot_pixel(ui_plot_t *plot, int cols, int col, int row, uint16_t color)
+{
+    uint8_t *p = &plot->pixels[((size_t)row * cols + col) * 2];
+    p[0] = (uint8_t)(color & 0xFF);
+    p[1] = (uint8_t)(color >> 8);
+}
+
+/**
+ * @brief Bring a sparkline's bitmap up to date and blit it
+ * @param full Start from an empty plot
+ */
+static void draw_plot(const ui_widget_t *w, bool full)
+{
+    ui_plot_t *plot = &ui_plots[w->sparkline];
+    int cols = w->width - 2;
+    int rows = w->height - 2;
+    uint16_t line = framebuffer_rgb565(w->color);
+    uint16_t bg = framebuffer_rgb565(background_of(w));
+
+    if (full)
+    {
+        for (int row = 0; row < rows; row++)
+        {
+            for (int col = 0; col < cols; col++)
+            {
+                set_plot_pixel(plot, cols, col, row, bg);
+            }
+        }
+        memset(plot->top, 1, sizeof(plot->top));
+        memset(plot->bottom, 0, sizeof(plot->bottom));
+    }
+
+    bool changed = full;
+    for (int col = 0; col < cols; col++)
+    {
+        // Each sample is joined to the previous one by a vertical run
+        int top = 1, bottom = 0;
+        uint8_t level = plot->level[col];
+        uint8_t previous = col > 0 ? plot->level[col - 1] : UI_NO_LEVEL;
+        if (level != UI_NO_LEVEL)
+        {
+            top = bottom = level;
+            if (previous != UI_NO_LEVEL && previous < level)
+            {
+                top = previous + 1;
+            }
+            else if (previous != UI_NO_LEVEL && previous > level)
+            {
+                bottom = previous - 1;
+            }
+        }
+
+        int old_top = plot->top[col], old_bottom = plot->bottom[col];
+        if (top == old_top && bottom == old_bottom)
+        {
+            continue;
+        }
+        for (int row = old_top; row <= old_bottom; row++)
+        {
+            if (row < top || row > bottom)
+            {
+                set_plot_pixel(plot, cols, col, row, bg);
+            }
+        }
+        for (int row = top; row <= bottom; row++)
+        {
+            if (row < old_top || row > old_bottom)
+            {
+                set_plot_pixel(plot, cols, col, row, line);
+            }
+        }
+        plot->top[col] = (uint8_t)top;
+        plot->bottom[col] = (uint8_t)bottom;
+        changed = true;
+    }
+
+    if (changed)
+    {
+        // Band mode keeps the pointer, and redraws the blit from it whenever it is blitted again
+        display_buffer_t buffer = {(uint16_t)cols, (uint16_t)rows, (uint16_t)(w->x + 1), (uint16_t)(w->y + 1),
+                                   plot->pixels, (size_t)cols * rows * 2};
+        hal_display_update(&buffer);
+    }
+}
+
+/**
+ * @brief Draw a widget
+ * @param full Everything, else only what its content changed
+ */
+static void draw(ui_widget_id_t id, bool full)
+{
+    ui_widget_t *w = &ui.widgets[id];
+    switch (w->type)
+    {
+    case UI_WIDGET_PANEL:
+        if (w->border != w->color && w->width > 2 && w->height > 2)
+        {
+            hal_display_draw_rect(w->x, w->y, w->width, w->height, w->border, false);
+            hal_display_draw_rect(w->x + 1, w->y + 1, w->width - 2, w->height - 2, w->color, true);
+        }
+        else
+        {
+            hal_display_draw_rect(w->x, w->y, w->width, w->height, w->color, true);
+        }
+        // Painted over everything on it
+        for (int i = id + 1; i < ui.count; i++)
+        {
+            if (is_ancestor(id, ui.widgets[i].parent))
+            {
+                mark(&ui.widgets[i], UI_DIRTY_FULL);
+            }
+        }
+        break;
+
+    case UI_WIDGET_LABEL:
+    case UI_WIDGET_VALUE:
+    {
+        // Padded to all its cells, so shorter text clears what longer text left
+        char line[UI_TEXT_MAX];
+        size_t len = strlen(w->text);
+        memcpy(line, w->text, len);
+        memset(&line[len], ' ', w->width_chars - len);
+        line[w->width_chars] = '\0';
+        hal_display_draw_text(w->x, w->y, line, w->color, background_of(w));
+        break;
+    }
+
+    case UI_WIDGET_BAR:
+    {
+        if (full)
+        {
+            hal_display_draw_rect(w->x, w->y, w->width, w->height, w->border, false);
+        }
+        // Filled then empty part: together they replace the bar's previous two
+        uint16_t inner = w->width - 2;
+        uint16_t split = (uint16_t)((uint32_t)inner * w->percent / 100);
+        if (split > 0)
+        {
+            hal_display_draw_rect(w->x + 1, w->y + 1, split, w->height - 2, w->color, true);
+        }
+        if (split < inner)
+        {
+            hal_display_draw_rect(w->x + 1 + split, w->y + 1, inner - split, w->height - 2, w->empty, true);
+        }
+        break;
+    }
+
+    case UI_WIDGET_SPARKLINE:
+        if (full)
+        {
+            hal_display_draw_rect(w->x, w->y, w->width, w->height, w->border, false);
+        }
+        draw_plot(w, full);
+        break;
+
+    case UI_WIDGET_LED:
+        hal_display_draw_rect(w->x, w->y, w->width, w->height, w->color, true);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Paint a hidden widget's area with its panel's background, and mark what showed through
+ */
+static void erase(ui_widget_id_t id)
+{
+    const ui_widget_t *w = &ui.widgets[id];
+    hal_display_draw_rect(w->x, w->y, w->width, w->height, background_of(w), true);
+
+    for (int i = 0; i < ui.count; i++)
+    {
+        ui_widget_t *other = &ui.widgets[i];
+        if (!is_ancestor(id, i) && !is_ancestor(i, id) && shown(i) && overlaps(w, other))
+        {
+            mark(other, UI_DIRTY_FULL);
+        }
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void display_manager_init(uint16_t width, uint16_t height, uint32_t background, uint32_t period_ms)
+{
+    memset(&ui, 0, sizeof(ui));
+    memset(ui_plots, 0, sizeof(ui_plots));
+    ui.period_ms = period_ms;
+
+    ui_widget_t *screen = &ui.widgets[ui.count++];
+    screen->type = UI_WIDGET_PANEL;
+    screen->dirty = UI_DIRTY_FULL;
+    screen->visible = true;
+    screen->parent = UI_NO_WIDGET;
+    screen->width = width;
+    screen->height = height;
+    screen->color = background;
+    screen->border = background;
+    screen->sparkline = -1;
+
+    printf("[UI] Display manager initialized (%ux%u, redraw every %lu ms)\n", width, height,
+           (unsigned long)period_ms);
+}
+
+bool display_manager_update(void)
+{
+    ui.stats.updates++;
+    uint64_t start_us = hal_get_time_us();
+    bool drawn = false;
+
+    // Erase hidden widgets first: what they covered is redrawn below, in order
+    for (int i = 0; i < ui.count; i++)
+    {
+        ui_widget_t *w = &ui.widgets[i];
+        if (w->dirty & UI_DIRTY_ERASE)
+        {
+            w->dirty &= (uint8_t)~UI_DIRTY_ERASE;
+            if (!shown(w->parent))
+            {
+                continue;
+            }
+            erase((ui_widget_id_t)i);
+            drawn = true;
+        }
+    }
+
+    for (int i = 0; i < ui.count; i++)
+    {
+        ui_widget_t *w = &ui.widgets[i];
+        if (w->dirty == 0)
+        {
+            continue;
+        }
+        bool full = w->dirty & UI_DIRTY_FULL;
+        w->dirty = 0;
+        if (!shown((ui_widget_id_t)i))
+        {
+            // Drawn in full when shown again
+            continue;
+        }
+        draw((ui_widget_id_t)i, full);
+        if (full)
+        {
+            ui.stats.widgets_full++;
+        }
+        else
+        {
+            ui.stats.widgets_drawn++;
+        }
+        drawn = true;
+    }
+
+    if (!drawn)
+    {
+        ui.stats.idle_updates++;
+        return false;
+    }
+
+    hal_display_flush();
+    ui.stats.last_update_us = (uint32_t)(hal_get_time_us() - start_us);
+    return true;
+}
+
+void display_manager_poll(void)
+{
+    uint32_t now = hal_get_tick_ms();
+    if (now - ui.last_update_ms < ui.period_ms)
+    {
+        return;
+    }
+    ui.last_update_ms = now;
+    display_manager_update();
+}
+
+void display_manager_invalidate(void)
+{
+    if (ui.count > 0)
+    {
+        mark(&ui.widgets[UI_SCREEN], UI_DIRTY_FULL);
+    }
+}
+
+void display_manager_get_stats(ui_stats_t *stats)
+{
+    if (stats != NULL)
+    {
+        *stats = ui.stats;
+    }
+}
+
+ui_widget_id_t ui_panel_create(ui_widget_id_t parent, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                               uint32_t background, uint32_t border)
+{
+    ui_widget_t *w = add(parent, UI_WIDGET_PANEL, x, y, width, height);
+    if (w != NULL)
+    {
+        w->color = background;
+        w->border = border;
+    }
+    return id_of(w);
+}
+
+ui_widget_id_t ui_label_create(ui_widget_id_t parent, uint16_t x, uint16_t y, uint8_t width_chars,
+                               const char *text, uint32_t color)
+{
+    if (width_chars >= UI_TEXT_MAX)
+    {
+        width_chars = UI_TEXT_MAX - 1;
+    }
+    ui_widget_t *w =
+        add(parent, UI_WIDGET_LABEL, x, y, (uint16_t)(width_chars * FRAMEBUFFER_GLYPH_WIDTH), FRAMEBUFFER_GLYPH_HEIGHT);
+    if (w != NULL)
+    {
+        w->width_chars = width_chars;
+        w->color = color;
+        snprintf(w->text, (size_t)width_chars + 1, "%s", text ? text : "");
+    }
+    return id_of(w);
+}
+
+ui_widget_id_t ui_value_create(ui_widget_id_t parent, uint16_t x, uint16_t y, uint8_t width_chars,
+                               uint8_t decimals, const char *unit, uint32_t color)
+{
+    if (width_chars >= UI_TEXT_MAX)
+    {
+        width_chars = UI_TEXT_MAX - 1;
+    }
+    ui_widget_t *w =
+        add(parent, UI_WIDGET_VALUE, x, y, (uint16_t)(width_chars * FRAMEBUFFER_GLYPH_WIDTH), FRAMEBUFFER_GLYPH_HEIGHT);
+    if (w != NULL)
+    {
+        w->width_chars = width_chars;
+        w->decimals = decimals;
+        w->color = color;
+        size_t unit_size = width_chars < UI_UNIT_MAX - 1 ? width_chars + 1u : UI_UNIT_MAX;
+        snprintf(w->unit, unit_size, "%s", unit ? unit : "");
+        format_value(w, NAN, w->text);
+    }
+    return id_of(w);
+}
+
+ui_widget_id_t ui_bar_create(ui_widget_id_t parent, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                             uint32_t fill, uint32_t empty, uint32_t border)
+{
+    if (width < 3 || height < 3)
+    {
+        return UI_NO_WIDGET;
+    }
+    ui_widget_t *w = add(parent, UI_WIDGET_BAR, x, y, width, height);
+    if (w != NULL)
+    {
+        w->color = fill;
+        w->empty = empty;
+        w->border = border;
+    }
+    return id_of(w);
+}
+
+ui_widget_id_t ui_sparkline_create(ui_widget_id_t parent, uint16_t x, uint16_t y, uint16_t width,
+                                   uint16_t height, float min, float max, uint32_t color, uint32_t border)
+{
+    if (width < 3 || height < 3 || width > UI_SPARKLINE_MAX_WIDTH || height > UI_SPARKLINE_MAX_HEIGHT || !(max > min))
+    {
+        return UI_NO_WIDGET;
+    }
+    int slot = 0;
+    while (slot < UI_MAX_SPARKLINES && ui_plots[slot].used)
+    {
+        slot++;
+    }
+    if (slot == UI_MAX_SPARKLINES)
+    {
+        return UI_NO_WIDGET;
+    }
+
+    ui_widget_t *w = add(parent, UI_WIDGET_SPARKLINE, x, y, width, height);
+    if (w != NULL)
+    {
+        w->color = color;
+        w->border = border;
+        w->min = min;
+        w->max = max;
+        w->sparkline = (int8_t)slot;
+        ui_plots[slot].used = true;
+        memset(ui_plots[slot].level, UI_NO_LEVEL, sizeof(ui_plots[slot].level));
+    }
+    return id_of(w);
+}
+
+ui_widget_id_t ui_led_create(ui_widget_id_t parent, uint16_t x, uint16_t y, uint16_t size, uint32_t color)
+{
+    ui_widget_t *w = add(parent, UI_WIDGET_LED, x, y, size, size);
+    if (w != NULL)
+    {
+        w->color = color;
+    }
+    return id_of(w);
+}
+
+void ui_label_set_text(ui_widget_id_t id, const char *text)
+{
+    ui_widget_t *w = widget(id, UI_WIDGET_LABEL);
+    if (w == NULL || text == NULL)
+    {
+        return;
+    }
+    char cut[UI_TEXT_MAX];
+    snprintf(cut, (size_t)w->width_chars + 1, "%s", text);
+    if (strcmp(cut, w->text) != 0)
+    {
+        strcpy(w->text, cut);
+        mark(w, UI_DIRTY_CONTENT);
+    }
+}
+
+void ui_label_set_color(ui_widget_id_t id, uint32_t color)
+{
+    ui_widget_t *w = widget(id, UI_WIDGET_LABEL);
+    if (w != NULL && w->color != color)
+    {
+        w->color = color;
+        mark(w, UI_DIRTY_CONTENT);
+    }
+}
+
+void ui_value_set(ui_widget_id_t id, float value)
+{
+    ui_widget_t *w = widget(id, UI_WIDGET_VALUE);
+    if (w == NULL)
+    {
+        return;
+    }
+    char text[UI_TEXT_MAX];
+    format_value(w, value, text);
+    if (strcmp(text, w->text) != 0)
+    {
+        strcpy(w->text, text);
+        mark(w, UI_DIRTY_CONTENT);
+    }
+}
+
+void ui_bar_set(ui_widget_id_t id, uint8_t percent)
+{
+    ui_widget_t *w = widget(id, UI_WIDGET_BAR);
+    percent = percent > 100 ? 100 : percent;
+    if (w != NULL && w->percent != percent)
+    {
+        w->percent = percent;
+        mark(w, UI_DIRTY_CONTENT);
+    }
+}
+
+void ui_sparkline_push(ui_widget_id_t id, float sample)
+{
+    ui_widget_t *w = widget(id, UI_WIDGET_SPARKLINE);
+    if (w == NULL)
+    {
+        return;
+    }
+    ui_plot_t *plot = &ui_plots[w->sparkline];
+    int cols = w->width - 2;
+    int rows = w->height - 2;
+
+    uint8_t level = UI_NO_LEVEL;
+    if (!isnan(sample))
+    {
+        float t = (w->max - sample) / (w->max - w->min);
+        t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+        level = (uint8_t)lroundf(t * (float)(rows - 1));
+    }
+    memmove(plot->level, plot->level + 1, (size_t)cols - 1);
+    plot->level[cols - 1] = level;
+    mark(w, UI_DIRTY_CONTENT);
+}
+
+void ui_led_set(ui_widget_id_t id, uint32_t color)
+{
+    ui_widget_t *w = widget(id, UI_WIDGET_LED);
+    if (w != NULL && w->color != color)
+    {
+        w->color = color;
+        mark(w, UI_DIRTY_CONTENT);
+    }
+}
+
+void ui_widget_set_visible(ui_widget_id_t id, bool visible)
+{
+    if (id <= UI_SCREEN || id >= ui.count)
+    {
+        return;
+    }
+    ui_widget_t *w = &ui.widgets[id];
+    if (w->visible == visible)
+    {
+        return;
+    }
+    w->visible = visible;
+    if (visible)
+    {
+        w->dirty = (uint8_t)((w->dirty & ~UI_DIRTY_ERASE) | UI_DIRTY_FULL);
+    }
+    else
+    {
+        w->dirty |= UI_DIRTY_ERASE;
+    }
+}
@@ -0,0 +1,179 @@
+/**
+ * @file display_manager.h
+ * @brief Retained-mode widgets on top of the display HAL
+ *
+ * Screens are built once from widgets (panels, labels, values, bars,
+ * sparklines and LED indicators) that remember what they show. Setting a
+ * widget to what it already shows does nothing; a change marks just that
+ * widget, and display_manager_update() redraws only the marked widgets, each
+ * by the smallest change to what it drew last:
+ *  - labels and values always fill their cells (values right-aligned), so
+ *    the HAL's text cache repaints only the characters that changed;
+ *  - bars redraw their filled and empty parts, of which only the strip
+ *    between the old and the new level differs from the screen;
+ *  - sparklines keep their plot as an RGB565 bitmap, erase and draw per
+ *    column only the pixels that differ, and blit it;
+ *  - LEDs repaint when their colour changes.
+ * What reaches the panel is then only the HAL's dirty areas, so an update
+ * costs CPU and bus time in proportion to what changed. In band mode the
+ * display list stays the same length however often widgets change.
+ *
+ * Widgets form a tree: each has a parent panel whose background it is drawn
+ * on, positions are relative to the parent, and hiding a panel hides what is
+ * on it. Widgets are drawn in creation order, parents before children, so a
+ * later sibling is drawn over an earlier one it overlaps.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef DISPLAY_MANAGER_H
+#define DISPLAY_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONFIGURATION CONSTANTS
+    // =============================================================================
+
+#define UI_MAX_WIDGETS 32          // Screen panel included
+#define UI_TEXT_MAX 32             // Label text, terminator included
+#define UI_UNIT_MAX 8              // Value unit, terminator included
+#define UI_MAX_SPARKLINES 2          // Each has a plot bitmap of up to 126 x 30 pixels (7.4 KB)
+#define UI_SPARKLINE_MAX_WIDTH 128  // Border included
+#define UI_SPARKLINE_MAX_HEIGHT 32
+
+#define UI_NO_WIDGET (-1)
+#define UI_SCREEN 0 // The panel covering the display, parent of everything else
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    typedef int8_t ui_widget_id_t;
+
+    typedef enum
+    {
+        UI_WIDGET_PANEL = 0,
+        UI_WIDGET_LABEL,
+        UI_WIDGET_VALUE,
+        UI_WIDGET_BAR,
+        UI_WIDGET_SPARKLINE,
+        UI_WIDGET_LED
+    } ui_widget_type_t;
+
+    /**
+     * @brief Update counters since display_manager_init()
+     */
+    typedef struct
+    {
+        uint32_t updates;        // display_manager_update() calls
+        uint32_t idle_updates;   // ... with nothing to draw
+        uint32_t widgets_drawn;  // Widgets redrawn incrementally
+        uint32_t widgets_full;   // Widgets redrawn in full (new, shown, or under a redrawn panel)
+        uint32_t last_update_us; // Time the last non-idle update took, flush included
+    } ui_stats_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Drop all widgets and start a new screen, drawn in full on the next update
+     * @param width Display width
+     * @param height Display height
+     * @param background Screen colour (RGB888)
+     * @param period_ms Minimum time between redraws from display_manager_poll()
+     */
+    void display_manager_init(uint16_t width, uint16_t height, uint32_t background, uint32_t period_ms);
+
+    /**
+     * @brief Redraw the widgets that changed and flush the display
+     * @return true if anything was drawn
+     */
+    bool display_manager_update(void);
+
+    /**
+     * @brief Call from the main loop: display_manager_update() once per period
+     */
+    void display_manager_poll(void);
+
+    /**
+     * @brief Redraw every widget in full on the next update (after something else drew on the screen)
+     */
+    void display_manager_invalidate(void);
+
+    void display_manager_get_stats(ui_stats_t *stats);
+
+    // Widget creation: positions are relative to the parent panel; UI_NO_WIDGET when out of widgets, or the
+    // widget does not fit in its parent
+
+    /**
+     * @brief A filled area other widgets are placed on
+     * @param border Border colour (RGB888), or the background colour for none
+     */
+    ui_widget_id_t ui_panel_create(ui_widget_id_t parent, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                                   uint32_t background, uint32_t border);
+
+    /**
+     * @brief Text on the parent's background
+     * @param width_chars Cells the label covers; longer text is cut to fit
+     */
+    ui_widget_id_t ui_label_create(ui_widget_id_t parent, uint16_t x, uint16_t y, uint8_t width_chars,
+                                   const char *text, uint32_t color);
+
+    /**
+     * @brief A number, right-aligned in a fixed number of cells
+     * @param width_chars Cells for the number and its unit
+     * @param decimals Digits after the decimal point
+     * @param unit Appended to the number (may be NULL)
+     */
+    ui_widget_id_t ui_value_create(ui_widget_id_t parent, uint16_t x, uint16_t y, uint8_t width_chars,
+                                   uint8_t decimals, const char *unit, uint32_t color);
+
+    /**
+     * @brief A bordered horizontal bar
+     */
+    ui_widget_id_t ui_bar_create(ui_widget_id_t parent, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                                 uint32_t fill, uint32_t empty, uint32_t border);
+
+    /**
+     * @brief A bordered line plot of the last width - 2 samples, newest on the right (NaN leaves a gap)
+     * @param min Sample shown at the bottom (lower ones are clamped)
+     * @param max Sample shown at the top (higher ones are clamped)
+     * @return UI_NO_WIDGET also when UI_MAX_SPARKLINES are in use or it is over the maximum size
+     */
+    ui_widget_id_t ui_sparkline_create(ui_widget_id_t parent, uint16_t x, uint16_t y, uint16_t width,
+                                       uint16_t height, float min, float max, uint32_t color, uint32_t border);
+
+    /**
+     * @brief A square status light
+     */
+    ui_widget_id_t ui_led_create(ui_widget_id_t parent, uint16_t x, uint16_t y, uint16_t size, uint32_t color);
+
+    // Widget state: each is a no-op when the widget already shows it
+
+    void ui_label_set_text(ui_widget_id_t id, const char *text);
+    void ui_label_set_color(ui_widget_id_t id, uint32_t color);
+
+    /**
+     * @brief Set a value; NaN shows as dashes
+     */
+    void ui_value_set(ui_widget_id_t id, float value);
+
+    void ui_bar_set(ui_widget_id_t id, uint8_t percent);
+    void ui_sparkline_push(ui_widget_id_t id, float sample);
+    void ui_led_set(ui_widget_id_t id, uint32_t color);
+    void ui_widget_set_visible(ui_widget_id_t id, bool visible);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_MANAGER_H
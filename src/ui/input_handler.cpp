@@ -6,6 +6,7 @@
 #include "../ui/input_handler.h"
 #include "../monitoring/diagnostics_engine.h"
 #include "../utils/hal_interface.h"
+#include "../utils/command_registry.h"
 #include "../include/board_config.h"
 #include <stdio.h>
 #include <string.h>
@@ -18,6 +19,13 @@ static bool input_handler_initialized = false;
 static bool input_processing_enabled = true;
 static volatile bool user_button_pressed = false;
 static void (*emergency_stop_callback)(void) = NULL;
+static uint32_t last_activity_ms = 0;
+
+// Event queue: [event_head, event_head + event_count) modulo INPUT_EVENT_QUEUE_SIZE
+static input_event_t event_queue[INPUT_EVENT_QUEUE_SIZE];
+static uint8_t event_head = 0;
+static uint8_t event_count = 0;
+static uint32_t events_dropped = 0;
 
 // =============================================================================
 // PUBLIC FUNCTIONS - ALL FUNCTIONS IMPLEMENTED
@@ -32,6 +40,7 @@ bool input_handler_init(void)
 
     printf("[INPUT] Initializing input handler...\n");
     input_processing_enabled = true;
+    last_activity_ms = hal_get_tick_ms();
     input_handler_initialized = true;
     printf("[INPUT] Input handler initialized successfully\n");
     return true;
@@ -51,6 +60,7 @@ void handle_user_input(void)
     {
         user_button_pressed = false;
         last_button_time = current_time;
+        last_activity_ms = current_time;
 
         printf("[INPUT] User button pressed! Toggling diagnostic channels...\n");
         toggle_all_channels();
@@ -61,19 +71,70 @@ void handle_user_input(void)
     }
 }
 
-bool get_next_input_event(input_event_t *event __attribute__((unused)))
+bool input_post_event(const input_event_t *event)
+{
+    if (event == NULL)
+    {
+        return false;
+    }
+    last_activity_ms = hal_get_tick_ms();
+
+    if (event->type == INPUT_EVENT_TOUCH_DRAG && event_count > 0)
+    {
+        input_event_t *last = &event_queue[(event_head + event_count - 1) % INPUT_EVENT_QUEUE_SIZE];
+        if (last->type == INPUT_EVENT_TOUCH_DRAG)
+        {
+            *last = *event;
+            return true;
+        }
+    }
+
+    if (event_count >= INPUT_EVENT_QUEUE_SIZE)
+    {
+        if (events_dropped++ == 0)
+        {
+            printf("[INPUT] Event queue full; dropping events\n");
+        }
+        return false;
+    }
+
+    event_queue[(event_head + event_count) % INPUT_EVENT_QUEUE_SIZE] = *event;
+    event_count++;
+    return true;
+}
+
+bool get_next_input_event(input_event_t *event)
+{
+    if (event == NULL || event_count == 0)
+    {
+        return false;
+    }
+
+    *event = event_queue[event_head];
+    event_head = (uint8_t)((event_head + 1) % INPUT_EVENT_QUEUE_SIZE);
+    event_count--;
+    return true;
+}
+
+void input_note_activity(void)
+{
+    last_activity_ms = hal_get_tick_ms();
+}
+
+uint32_t input_get_idle_ms(void)
 {
-    // Stub implementation
-    return false;
+    return hal_get_tick_ms() - last_activity_ms;
 }
 
 uint8_t get_pending_input_count(void)
 {
-    return 0;
+    return event_count;
 }
 
 void clear_input_events(void)
 {
+    event_head = 0;
+    event_count = 0;
     printf("[INPUT] Input events cleared\n");
 }
 
@@ -92,7 +153,20 @@ void user_button_callback(uint32_t pin)
 
 void process_uart_command(uint8_t uart_id, const char *command)
 {
+    static char reply[CMD_REPLY_MAX];
+
+    if (!input_processing_enabled || command == NULL)
+    {
+        return;
+    }
+
     printf("[INPUT] UART%d command: %s\n", uart_id, command);
+
+    // Same command table as the WebSocket; one OK/ERR line per command
+    if (command_execute_line(command, CMD_SOURCE_UART, -1, reply, sizeof(reply)) > 0)
+    {
+        printf("%s", reply);
+    }
 }
 
 void set_input_processing_enabled(bool enabled)
@@ -27,6 +27,7 @@ extern "C"
 #define BUTTON_DEBOUNCE_MS 50
 #define LONG_PRESS_DURATION_MS 2000
 #define DOUBLE_CLICK_WINDOW_MS 500
+#define INPUT_EVENT_QUEUE_SIZE 16 // Events waiting for get_next_input_event()
 
     // =============================================================================
     // INPUT EVENT TYPES
@@ -40,7 +41,11 @@ extern "C"
         INPUT_EVENT_BUTTON_LONG_PRESS,
         INPUT_EVENT_BUTTON_DOUBLE_CLICK,
         INPUT_EVENT_UART_COMMAND,
-        INPUT_EVENT_EMERGENCY_STOP
+        INPUT_EVENT_EMERGENCY_STOP,
+        INPUT_EVENT_TOUCH_TAP,        // Pressed and released in place
+        INPUT_EVENT_TOUCH_LONG_PRESS, // Held in place for TOUCH_LONG_PRESS_MS; no tap follows
+        INPUT_EVENT_TOUCH_DRAG,       // Moved while pressed; queued drags merge into the latest
+        INPUT_EVENT_TOUCH_DRAG_END    // Released after a drag
     } input_event_type_t;
 
     typedef enum
@@ -69,6 +74,14 @@ extern "C"
                 char command[64]; // UART command string
                 uint8_t uart_id;  // Which UART received the command
             } uart;
+            struct
+            {
+                int16_t x;            // Screen coordinates, filtered and calibrated
+                int16_t y;
+                int16_t start_x;      // Where the press began
+                int16_t start_y;
+                uint32_t duration_ms; // Since the press began
+            } touch;
         } data;
     } input_event_t;
 
@@ -94,6 +107,34 @@ extern "C"
      */
     bool get_next_input_event(input_event_t *event);
 
+    /**
+     * @brief Queue an input event for get_next_input_event()
+     *
+     * From the main loop only (drivers' completion callbacks included), not
+     * from interrupt handlers. A drag merges into a drag at the tail of the
+     * queue, so a slow consumer sees where the drag has got to rather than
+     * running out of room.
+     *
+     * @param event Event to queue (copied)
+     * @return false if the queue is full and the event was dropped
+     */
+    bool input_post_event(const input_event_t *event);
+
+    /**
+     * @brief Note that the user did something (touch, button)
+     *
+     * Drivers call it for input that has not become an event yet, such as a
+     * press still being held; queued events and button presses count
+     * already.
+     */
+    void input_note_activity(void);
+
+    /**
+     * @brief Time since the last user input, e.g. to dim and sleep the display
+     * @return Milliseconds since input_note_activity() or input_handler_init()
+     */
+    uint32_t input_get_idle_ms(void);
+
     /**
      * @brief Check if there are pending input events
      * @return Number of pending events in the queue
@@ -112,9 +153,11 @@ extern "C"
     void user_button_callback(uint32_t pin);
 
     /**
-     * @brief Process UART command input
+     * @brief Run a console command line through the command registry
+     *
+     * Several commands may be separated by ';'; each prints an OK or ERR line.
      * @param uart_id UART instance that received data
-     * @param command Command string received
+     * @param command Command line received
      */
     void process_uart_command(uint8_t uart_id, const char *command);
 
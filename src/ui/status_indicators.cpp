@@ -0,0 +1,139 @@
+/**
+ * @file status_indicators.cpp
+ * @brief System status screen implementation
+ */
+
+#include "status_indicators.h"
+#include "display_manager.h"
+
+#include <math.h>
+#include <stdio.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define STATUS_BACKGROUND 0x101828
+#define STATUS_TITLE_BACKGROUND 0x203860
+#define STATUS_BORDER 0x5070A0
+#define STATUS_TEXT 0xFFFFFF
+#define STATUS_DIM_TEXT 0xA0B0C8
+#define STATUS_OK 0x00C040
+#define STATUS_BAD 0xC02020
+#define STATUS_PLOT 0x40C0FF
+
+#define STATUS_RATE_PERIOD_MS 1000 // One loop rate sample (and plot column) per second
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static struct
+{
+    bool ready;
+    ui_widget_id_t uptime;
+    ui_widget_id_t loops;
+    ui_widget_id_t rate;
+    ui_widget_id_t rate_plot;
+    ui_widget_id_t wifi_led;
+    ui_widget_id_t wifi_state;
+    ui_widget_id_t signal;
+    ui_widget_id_t signal_bar;
+
+    uint32_t rate_start_ms; // Start of the loop rate sample being counted
+    uint32_t rate_start_loops;
+    bool rate_started;
+} status;
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+/**
+ * @brief A dim caption with a value to its right
+ */
+static ui_widget_id_t add_row(ui_widget_id_t panel, uint16_t y, const char *caption, uint8_t width_chars,
+                              uint8_t decimals, const char *unit)
+{
+    ui_label_create(panel, 8, y, 10, caption, STATUS_DIM_TEXT);
+    return ui_value_create(panel, 72, y, width_chars, decimals, unit, STATUS_TEXT);
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+bool status_indicators_init(void)
+{
+    status.ready = false;
+    status.rate_started = false;
+
+    ui_widget_id_t title = ui_panel_create(UI_SCREEN, 0, 0, 320, 16, STATUS_TITLE_BACKGROUND, STATUS_TITLE_BACKGROUND);
+    ui_label_create(title, 4, 4, 30, "Diagnostic Test Rig", STATUS_TEXT);
+
+    ui_widget_id_t system = ui_panel_create(UI_SCREEN, 4, 22, 312, 96, STATUS_BACKGROUND, STATUS_BORDER);
+    status.uptime = add_row(system, 8, "Uptime", 12, 0, " s");
+    status.loops = add_row(system, 20, "Loops", 12, 0, NULL);
+    status.rate = add_row(system, 32, "Loop rate", 12, 0, " /s");
+    status.rate_plot = ui_sparkline_create(system, 8, 48, 128, 32, 0.0f, STATUS_LOOP_RATE_MAX, STATUS_PLOT,
+                                           STATUS_BORDER);
+
+    ui_widget_id_t network = ui_panel_create(UI_SCREEN, 4, 124, 312, 60, STATUS_BACKGROUND, STATUS_BORDER);
+    status.wifi_led = ui_led_create(network, 8, 8, 8, STATUS_BAD);
+    ui_label_create(network, 20, 8, 8, "WiFi", STATUS_DIM_TEXT);
+    status.wifi_state = ui_label_create(network, 72, 8, 24, "offline", STATUS_TEXT);
+    status.signal = add_row(network, 24, "Signal", 8, 0, " dBm");
+    status.signal_bar = ui_bar_create(network, 8, 38, 200, 12, STATUS_OK, STATUS_BACKGROUND, STATUS_BORDER);
+
+    status.ready = title != UI_NO_WIDGET && system != UI_NO_WIDGET && network != UI_NO_WIDGET &&
+                   status.rate_plot != UI_NO_WIDGET && status.signal_bar != UI_NO_WIDGET;
+    if (!status.ready)
+    {
+        printf("[STATUS] Status screen does not fit the display manager\n");
+    }
+    return status.ready;
+}
+
+void status_indicators_update(const status_indicators_state_t *state)
+{
+    if (!status.ready || state == NULL)
+    {
+        return;
+    }
+
+    ui_value_set(status.uptime, (float)(state->uptime_ms / 1000));
+    ui_value_set(status.loops, (float)state->loop_count);
+
+    // Loop rate: one sample per period, so the plot's time axis is steady
+    if (!status.rate_started)
+    {
+        status.rate_start_ms = state->uptime_ms;
+        status.rate_start_loops = state->loop_count;
+        status.rate_started = true;
+    }
+    uint32_t elapsed_ms = state->uptime_ms - status.rate_start_ms;
+    if (elapsed_ms >= STATUS_RATE_PERIOD_MS)
+    {
+        float rate = (float)(state->loop_count - status.rate_start_loops) * 1000.0f / (float)elapsed_ms;
+        ui_value_set(status.rate, rate);
+        ui_sparkline_push(status.rate_plot, rate);
+        status.rate_start_ms = state->uptime_ms;
+        status.rate_start_loops = state->loop_count;
+    }
+
+    ui_led_set(status.wifi_led, state->wifi_connected ? STATUS_OK : STATUS_BAD);
+    ui_label_set_text(status.wifi_state,
+                      state->wifi_connected ? (state->address ? state->address : "connected") : "offline");
+    if (state->wifi_connected)
+    {
+        int32_t rssi = state->rssi < STATUS_RSSI_MIN ? STATUS_RSSI_MIN
+                                                     : (state->rssi > STATUS_RSSI_MAX ? STATUS_RSSI_MAX : state->rssi);
+        ui_value_set(status.signal, (float)state->rssi);
+        ui_bar_set(status.signal_bar, (uint8_t)((rssi - STATUS_RSSI_MIN) * 100 / (STATUS_RSSI_MAX - STATUS_RSSI_MIN)));
+    }
+    else
+    {
+        ui_value_set(status.signal, NAN);
+        ui_bar_set(status.signal_bar, 0);
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * @file status_indicators.h
+ * @brief System status screen built from display manager widgets
+ *
+ * Uptime, main loop count and rate (with a plot of the last two minutes),
+ * WiFi state, address and signal strength. The screen is built once by
+ * status_indicators_init(); status_indicators_update() only sets widget
+ * values, so a refresh redraws just the ones that changed.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef STATUS_INDICATORS_H
+#define STATUS_INDICATORS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONFIGURATION CONSTANTS
+    // =============================================================================
+
+#define STATUS_LOOP_RATE_MAX 2000.0f // Loops/s at the top of the loop rate plot
+#define STATUS_RSSI_MIN (-90)        // dBm shown as an empty signal bar
+#define STATUS_RSSI_MAX (-30)        // dBm shown as a full one
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    typedef struct
+    {
+        uint32_t uptime_ms;
+        uint32_t loop_count;
+        bool wifi_connected;
+        int32_t rssi;        // dBm, when connected
+        const char *address; // IP address, when connected (may be NULL)
+    } status_indicators_state_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Build the status screen on the display manager's screen (after display_manager_init())
+     * @return true on success, false if the widgets did not fit
+     */
+    bool status_indicators_init(void);
+
+    /**
+     * @brief Show new values; drawn on the next display manager update
+     */
+    void status_indicators_update(const status_indicators_state_t *state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STATUS_INDICATORS_H
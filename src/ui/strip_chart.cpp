@@ -0,0 +1,244 @@
+/**
+ * @file strip_chart.cpp
+ * @brief Scrolling strip chart implementation
+ */
+
+#include "strip_chart.h"
+#include "../utils/hal_interface.h"
+#include "../utils/framebuffer.h"
+
+#include <string.h>
+
+// =============================================================================
+// PRIVATE TYPES
+// =============================================================================
+
+/**
+ * @brief One finished column before rendering
+ */
+typedef struct
+{
+    uint16_t low[STRIP_CHART_MAX_CHANNELS];
+    uint16_t high[STRIP_CHART_MAX_CHANNELS];
+    uint16_t last[STRIP_CHART_MAX_CHANNELS]; // Final sample: the next column's envelope reaches back to it
+    uint16_t mean[STRIP_CHART_MAX_CHANNELS];
+} column_t;
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static struct
+{
+    bool initialized;
+    strip_chart_config_t config;
+    uint16_t colors[STRIP_CHART_MAX_CHANNELS]; // RGB565 of config.colors
+    uint16_t background;
+    uint16_t grid;
+
+    // Column being reduced
+    column_t open;
+    uint32_t sums[STRIP_CHART_MAX_CHANNELS];
+    uint16_t open_frames;
+
+    // Finished columns, oldest at tail
+    column_t pending[STRIP_CHART_PENDING];
+    uint8_t head;
+    uint8_t tail;
+    uint8_t count;
+
+    column_t previous; // Last column output
+    bool has_previous;
+    uint32_t column_index;
+
+    // Output alternates between them: one can be on the bus while the other is rendered
+    uint16_t lines[2][STRIP_CHART_MAX_HEIGHT];
+    uint8_t next_line;
+
+    strip_chart_stats_t stats;
+} chart;
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+/**
+ * @brief Row of a sample within a lane's plot rows [top, top + rows)
+ */
+static int sample_row(uint16_t sample, int top, int rows)
+{
+    const strip_chart_config_t *c = &chart.config;
+    if (sample <= c->min)
+    {
+        return top + rows - 1;
+    }
+    if (sample >= c->max)
+    {
+        return top;
+    }
+    return top + (int)((uint32_t)(c->max - sample) * (uint32_t)(rows - 1) / (uint32_t)(c->max - c->min));
+}
+
+static void render_column(const column_t *col, uint16_t *line)
+{
+    const strip_chart_config_t *c = &chart.config;
+    int lane_height = c->height / c->channels;
+    bool tick = chart.column_index % STRIP_CHART_TICK_COLUMNS == 0;
+
+    for (int row = 0; row < c->height; row++)
+    {
+        line[row] = tick && row % 4 == 0 ? chart.grid : chart.background;
+    }
+
+    for (int ch = 0; ch < c->channels; ch++)
+    {
+        int top = ch * lane_height;
+        if (ch > 0)
+        {
+            line[top] = chart.grid; // Lane separator
+        }
+        // Plot rows between the separators, a dotted centre line behind them
+        int plot_top = top + 1;
+        int rows = lane_height - 1;
+        if (chart.column_index % 2 == 0)
+        {
+            line[plot_top + rows / 2] = chart.grid;
+        }
+
+        uint16_t low = col->low[ch], high = col->high[ch];
+        if (chart.has_previous)
+        {
+            uint16_t before = chart.previous.last[ch];
+            low = before < low ? before : low;
+            high = before > high ? before : high;
+        }
+        int from = sample_row(high, plot_top, rows);
+        int to = sample_row(low, plot_top, rows);
+        for (int row = from; row <= to; row++)
+        {
+            line[row] = chart.colors[ch];
+        }
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+bool strip_chart_init(const strip_chart_config_t *config)
+{
+    if (config == NULL || config->output == NULL || config->channels == 0 ||
+        config->channels > STRIP_CHART_MAX_CHANNELS || config->height > STRIP_CHART_MAX_HEIGHT ||
+        config->height / config->channels < 3 || config->samples_per_column == 0 || config->max <= config->min)
+    {
+        return false;
+    }
+
+    memset(&chart, 0, sizeof(chart));
+    chart.config = *config;
+    for (int ch = 0; ch < config->channels; ch++)
+    {
+        chart.colors[ch] = framebuffer_rgb565(config->colors[ch]);
+    }
+    chart.background = framebuffer_rgb565(config->background);
+    chart.grid = framebuffer_rgb565(config->grid);
+    chart.initialized = true;
+    return true;
+}
+
+void strip_chart_push_block(const uint16_t *frames, size_t frame_count, uint8_t channel_count)
+{
+    if (!chart.initialized || frames == NULL)
+    {
+        return;
+    }
+
+    uint8_t channels = channel_count < chart.config.channels ? channel_count : chart.config.channels;
+    for (size_t f = 0; f < frame_count; f++)
+    {
+        const uint16_t *frame = &frames[f * channel_count];
+        column_t *open = &chart.open;
+        for (uint8_t ch = 0; ch < channels; ch++)
+        {
+            uint16_t sample = frame[ch];
+            if (chart.open_frames == 0)
+            {
+                open->low[ch] = open->high[ch] = sample;
+                chart.sums[ch] = 0;
+            }
+            open->low[ch] = sample < open->low[ch] ? sample : open->low[ch];
+            open->high[ch] = sample > open->high[ch] ? sample : open->high[ch];
+            open->last[ch] = sample;
+            chart.sums[ch] += sample;
+        }
+        chart.stats.frames++;
+
+        if (++chart.open_frames < chart.config.samples_per_column)
+        {
+            continue;
+        }
+        for (uint8_t ch = 0; ch < channels; ch++)
+        {
+            open->mean[ch] = (uint16_t)(chart.sums[ch] / chart.open_frames);
+        }
+        chart.open_frames = 0;
+
+        if (chart.count == STRIP_CHART_PENDING)
+        {
+            // Rendering fell behind: the oldest column goes, so the chart stays current
+            chart.tail = (uint8_t)((chart.tail + 1) % STRIP_CHART_PENDING);
+            chart.count--;
+            chart.stats.columns_dropped++;
+        }
+        chart.pending[chart.head] = *open;
+        chart.head = (uint8_t)((chart.head + 1) % STRIP_CHART_PENDING);
+        chart.count++;
+    }
+}
+
+size_t strip_chart_update(void)
+{
+    if (!chart.initialized)
+    {
+        return 0;
+    }
+
+    size_t drawn = 0;
+    while (chart.count > 0)
+    {
+        uint64_t start_us = hal_get_time_us();
+        const column_t *col = &chart.pending[chart.tail];
+        uint16_t *line = chart.lines[chart.next_line];
+        chart.next_line ^= 1;
+
+        render_column(col, line);
+        chart.config.output(line, chart.config.height, chart.config.context);
+
+        chart.previous = *col;
+        chart.has_previous = true;
+        chart.column_index++;
+        chart.tail = (uint8_t)((chart.tail + 1) % STRIP_CHART_PENDING);
+        chart.count--;
+        chart.stats.columns++;
+        chart.stats.last_column_us = (uint32_t)(hal_get_time_us() - start_us);
+        drawn++;
+    }
+    return drawn;
+}
+
+uint16_t strip_chart_get_latest(uint8_t channel)
+{
+    if (!chart.has_previous || channel >= chart.config.channels)
+    {
+        return 0;
+    }
+    return chart.previous.mean[channel];
+}
+
+void strip_chart_get_stats(strip_chart_stats_t *stats)
+{
+    if (stats != NULL)
+    {
+        *stats = chart.stats;
+    }
+}
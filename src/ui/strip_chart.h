@@ -0,0 +1,120 @@
+/**
+ * @file strip_chart.h
+ * @brief Scrolling multi-channel strip chart fed from sample blocks
+ *
+ * Channels share one chart as lanes stacked top to bottom. Sample blocks
+ * (interleaved frames, as sampler_read() returns them) are reduced to one
+ * column per samples_per_column frames: the lowest and highest sample of
+ * each channel, drawn as a vertical envelope so spikes narrower than a
+ * column still show. An envelope also reaches back to the last sample of
+ * the previous column, keeping steep edges connected.
+ *
+ * The chart never redraws itself. Each finished column is rendered once, a
+ * full-height RGB565 line, and handed to the output, which scrolls the
+ * chart one column left and shows it at the right edge - on the panel with
+ * its hardware scrolling (pico_display_scroll_column()), so a column costs
+ * chart height x 2 bytes on the bus whatever the chart's width.
+ *
+ * Reduction runs in strip_chart_push_block(), rendering in
+ * strip_chart_update(); finished columns wait in between, so the two can
+ * run at different paces.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef STRIP_CHART_H
+#define STRIP_CHART_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONFIGURATION CONSTANTS
+    // =============================================================================
+
+#define STRIP_CHART_MAX_CHANNELS 4
+#define STRIP_CHART_MAX_HEIGHT 320 // Pixels per column
+#define STRIP_CHART_PENDING 32     // Finished columns waiting for strip_chart_update()
+#define STRIP_CHART_TICK_COLUMNS 50 // Columns between dotted time lines
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Scroll the chart one column left and show a new column at its right edge
+     * @param pixels height RGB565 pixels, top first; unchanged until the output is called again
+     * @param height Pixels in the column
+     * @param context Passed through from the configuration
+     */
+    typedef void (*strip_chart_output_t)(const uint16_t *pixels, uint16_t height, void *context);
+
+    typedef struct
+    {
+        uint16_t height;             // Column height in pixels
+        uint8_t channels;            // Lanes, 1..STRIP_CHART_MAX_CHANNELS
+        uint16_t samples_per_column; // Frames reduced into each column
+        uint16_t min;                // Sample at the bottom of a lane
+        uint16_t max;                // Sample at the top of a lane
+        uint32_t colors[STRIP_CHART_MAX_CHANNELS]; // RGB888, per lane
+        uint32_t background;         // RGB888
+        uint32_t grid;               // RGB888: lane separators, centre lines and time lines
+        strip_chart_output_t output;
+        void *context;
+    } strip_chart_config_t;
+
+    /**
+     * @brief Chart counters since strip_chart_init()
+     */
+    typedef struct
+    {
+        uint32_t frames;          // Frames reduced
+        uint32_t columns;         // Columns output
+        uint32_t columns_dropped; // Columns lost because strip_chart_update() fell behind
+        uint32_t last_column_us;  // Time rendering and outputting the last column took
+    } strip_chart_stats_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Start an empty chart
+     * @param config Layout, scaling and output (copied)
+     * @return false if the configuration is out of range
+     */
+    bool strip_chart_init(const strip_chart_config_t *config);
+
+    /**
+     * @brief Reduce a block of frames into columns
+     * @param frames frame_count frames of channel_count samples each
+     * @param frame_count Frames in the block
+     * @param channel_count Samples per frame; channels beyond the chart's are skipped
+     */
+    void strip_chart_push_block(const uint16_t *frames, size_t frame_count, uint8_t channel_count);
+
+    /**
+     * @brief Render and output the columns finished since the last call (call every loop)
+     * @return Columns output
+     */
+    size_t strip_chart_update(void);
+
+    /**
+     * @brief Newest column's mean sample of a channel (0 before the first column)
+     */
+    uint16_t strip_chart_get_latest(uint8_t channel);
+
+    void strip_chart_get_stats(strip_chart_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STRIP_CHART_H
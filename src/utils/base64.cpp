@@ -0,0 +1,64 @@
+/**
+ * @file base64.cpp
+ * @brief Table-free Base64 encoding implementation
+ */
+
+#include "base64.h"
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+// Map a 6-bit value onto A-Z a-z 0-9 + / by range arithmetic instead of a table
+static inline char base64_char(uint8_t v)
+{
+    if (v < 26)
+        return (char)('A' + v);
+    if (v < 52)
+        return (char)('a' + v - 26);
+    if (v < 62)
+        return (char)('0' + v - 52);
+    return v == 62 ? '+' : '/';
+}
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+size_t base64_encode(const uint8_t *data, size_t len, char *out, size_t out_size)
+{
+    size_t needed = BASE64_ENCODED_LEN(len);
+    if (out == NULL || out_size < needed + 1)
+    {
+        return 0;
+    }
+
+    char *p = out;
+    size_t i = 0;
+
+    for (; i + 3 <= len; i += 3)
+    {
+        uint32_t v = ((uint32_t)data[i] << 16) | ((uint32_t)data[i + 1] << 8) | data[i + 2];
+        *p++ = base64_char((v >> 18) & 0x3F);
+        *p++ = base64_char((v >> 12) & 0x3F);
+        *p++ = base64_char((v >> 6) & 0x3F);
+        *p++ = base64_char(v & 0x3F);
+    }
+
+    size_t rest = len - i;
+    if (rest > 0)
+    {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (rest == 2)
+        {
+            v |= (uint32_t)data[i + 1] << 8;
+        }
+        *p++ = base64_char((v >> 18) & 0x3F);
+        *p++ = base64_char((v >> 12) & 0x3F);
+        *p++ = (rest == 2) ? base64_char((v >> 6) & 0x3F) : '=';
+        *p++ = '=';
+    }
+
+    *p = '\0';
+    return needed;
+}
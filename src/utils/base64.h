@@ -0,0 +1,39 @@
+/**
+ * @file base64.h
+ * @brief Table-free Base64 encoding (RFC 4648, standard alphabet, padded)
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef BASE64_H
+#define BASE64_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Encoded length of n input bytes, excluding the terminator
+ */
+#define BASE64_ENCODED_LEN(n) ((((n) + 2) / 3) * 4)
+
+    /**
+     * @brief Encode bytes as Base64
+     * @param data Input bytes
+     * @param len Number of input bytes
+     * @param out Output buffer, NUL terminated on success
+     * @param out_size Output buffer size (at least BASE64_ENCODED_LEN(len) + 1)
+     * @return Number of characters written, or 0 if out is too small
+     */
+    size_t base64_encode(const uint8_t *data, size_t len, char *out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BASE64_H
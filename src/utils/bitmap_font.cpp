@@ -0,0 +1,95 @@
+/**
+ * @file bitmap_font.cpp
+ * @brief Bitmap font lookup and row rendering implementation
+ */
+
+#include "bitmap_font.h"
+#include "font_tables.h" // Generated from src/utils/fonts/*.bdf
+#include "framebuffer.h"
+
+#include <string.h>
+
+// The framebuffer and the display list lay text out in the default font's cells
+static_assert(font_tables[0]->width == FRAMEBUFFER_GLYPH_WIDTH && font_tables[0]->height == FRAMEBUFFER_GLYPH_HEIGHT,
+              "the first font in src/utils/fonts must have a FRAMEBUFFER_GLYPH_WIDTH x FRAMEBUFFER_GLYPH_HEIGHT cell");
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+/**
+ * @brief Expand pixels [from, from + count) of a glyph row
+ */
+static void expand(const bitmap_font_colors_t *colors, const uint8_t *bits, int from, int count, uint16_t *out)
+{
+    int end = from + count;
+    while (from < end)
+    {
+        // A nibble at a time: pixels 0-3 of a byte are its high nibble
+        uint8_t nibble = (uint8_t)((bits[from >> 3] >> (4 - (from & 4))) & 0x0F);
+        int offset = from & 3;
+        int take = 4 - offset < end - from ? 4 - offset : end - from;
+        memcpy(out, &colors->runs[nibble][offset], (size_t)take * sizeof(uint16_t));
+        out += take;
+        from += take;
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+const bitmap_font_t *bitmap_font_default(void)
+{
+    return font_tables[0];
+}
+
+const bitmap_font_t *bitmap_font_find(const char *name)
+{
+    for (const bitmap_font_t *font : font_tables)
+    {
+        if (name && strcmp(font->name, name) == 0)
+        {
+            return font;
+        }
+    }
+    return NULL;
+}
+
+void bitmap_font_colors(bitmap_font_colors_t *colors, uint16_t fg, uint16_t bg)
+{
+    for (int nibble = 0; nibble < 16; nibble++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            colors->runs[nibble][i] = nibble & (0x8 >> i) ? fg : bg;
+        }
+    }
+}
+
+const uint8_t *bitmap_font_glyph(const bitmap_font_t *font, char ch)
+{
+    unsigned index = (unsigned char)ch;
+    if (index < font->first || index >= (unsigned)font->first + font->count)
+    {
+        index = font->fallback;
+    }
+    return &font->rows[(size_t)(index - font->first) * font->height * font->row_bytes];
+}
+
+void bitmap_font_render_row(const bitmap_font_t *font, const bitmap_font_colors_t *colors, const char *text,
+                            size_t length, int row, int skip, int count, uint16_t *out)
+{
+    size_t index = (size_t)(skip / font->width);
+    int from = skip % font->width;
+    while (count > 0 && index < length)
+    {
+        const uint8_t *bits = bitmap_font_glyph(font, text[index]) + (size_t)row * font->row_bytes;
+        int take = font->width - from < count ? font->width - from : count;
+        expand(colors, bits, from, take, out);
+        out += take;
+        count -= take;
+        from = 0;
+        index++;
+    }
+}
@@ -0,0 +1,99 @@
+/**
+ * @file bitmap_font.h
+ * @brief Fixed-cell bitmap fonts and 1bpp to RGB565 text rendering
+ *
+ * Fonts are BDF files under src/utils/fonts, converted when the firmware is
+ * built (scripts/utils/convert_fonts.py) into constexpr tables that live in
+ * flash: each glyph is its character cell stored row by row, most
+ * significant bit leftmost. Rendering is therefore row-wise: one pixel row of
+ * a string is a table lookup per character and a colour expansion per
+ * nibble of glyph bits, through a 16-entry table of four-pixel runs built
+ * once per fg/bg pair (bitmap_font_colors()).
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef BITMAP_FONT_H
+#define BITMAP_FONT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief A converted font (see scripts/utils/convert_fonts.py)
+     */
+    typedef struct
+    {
+        const char *name;     // BDF file name without "font_" and ".bdf"
+        uint8_t width;        // Character cell, spacing included
+        uint8_t height;
+        uint8_t row_bytes;    // Bytes per glyph row
+        uint8_t first;        // First character in the table
+        uint8_t count;        // Characters in the table
+        uint8_t fallback;     // Shown for characters outside it
+        const uint8_t *rows;  // count glyphs of height rows of row_bytes
+    } bitmap_font_t;
+
+    /**
+     * @brief Colour expansion table for one fg/bg pair
+     */
+    typedef struct
+    {
+        uint16_t runs[16][4]; // Four pixels per nibble of glyph bits, leftmost first
+    } bitmap_font_colors_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief The built-in font (the first one converted)
+     */
+    const bitmap_font_t *bitmap_font_default(void);
+
+    /**
+     * @brief Find a converted font by name
+     * @return Font, NULL if there is none by that name
+     */
+    const bitmap_font_t *bitmap_font_find(const char *name);
+
+    /**
+     * @brief Build the expansion table for a colour pair
+     */
+    void bitmap_font_colors(bitmap_font_colors_t *colors, uint16_t fg, uint16_t bg);
+
+    /**
+     * @brief Rows of a character's glyph (the fallback glyph if the font lacks it)
+     */
+    const uint8_t *bitmap_font_glyph(const bitmap_font_t *font, char ch);
+
+    /**
+     * @brief Render part of one pixel row of a string
+     * @param font Font
+     * @param colors Expansion table for the text's colours
+     * @param text Characters (need not be NUL-terminated)
+     * @param length Characters in text
+     * @param row Pixel row within the character cell
+     * @param skip Pixels of the row to leave out on the left
+     * @param count Pixels to render from there, at most length * width - skip
+     * @param out Receives count RGB565 pixels
+     */
+    void bitmap_font_render_row(const bitmap_font_t *font, const bitmap_font_colors_t *colors, const char *text,
+                                size_t length, int row, int skip, int count, uint16_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BITMAP_FONT_H
@@ -0,0 +1,280 @@
+/**
+ * @file cbor_json.cpp
+ * @brief CBOR to JSON text conversion implementation
+ */
+
+#include "cbor_json.h"
+#include "json_writer.h"
+
+#include <string.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define CBOR_MAX_DEPTH (JSON_WRITER_MAX_DEPTH - 1)
+#define CBOR_KEY_MAX 64        // Longest map key, including terminator
+#define CBOR_FLOAT_DECIMALS 6
+
+// =============================================================================
+// PRIVATE TYPES
+// =============================================================================
+
+typedef struct
+{
+    const uint8_t *p;
+    const uint8_t *end;
+    json_writer_t *w;
+} cbor_input_t;
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static bool read_head(cbor_input_t *in, uint8_t *major, uint8_t *info, uint64_t *value);
+static bool convert_item(cbor_input_t *in, int depth);
+static bool convert_simple(cbor_input_t *in, uint8_t info, uint64_t value);
+static bool at_break(cbor_input_t *in);
+static float half_to_float(uint16_t half);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+size_t cbor_to_json(const uint8_t *cbor, size_t len, char *out, size_t out_size)
+{
+    if (cbor == NULL || len == 0)
+    {
+        return 0;
+    }
+
+    json_writer_t w;
+    json_writer_init(&w, out, out_size);
+
+    cbor_input_t in = {cbor, cbor + len, &w};
+    if (!convert_item(&in, 0) || in.p != in.end)
+    {
+        return 0;
+    }
+    return json_writer_finish(&w);
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static bool read_head(cbor_input_t *in, uint8_t *major, uint8_t *info, uint64_t *value)
+{
+    // Initial byte plus up to 8 bytes of big-endian argument
+    if (in->p >= in->end)
+    {
+        return false;
+    }
+    uint8_t initial = *in->p++;
+    *major = initial >> 5;
+    *info = initial & 0x1F;
+
+    if (*info < 24)
+    {
+        *value = *info;
+        return true;
+    }
+    if (*info == 31)
+    {
+        *value = 0; // Indefinite length (or a break); the caller checks info
+        return true;
+    }
+    if (*info > 27)
+    {
+        return false;
+    }
+
+    size_t bytes = (size_t)1 << (*info - 24);
+    if ((size_t)(in->end - in->p) < bytes)
+    {
+        return false;
+    }
+    *value = 0;
+    for (size_t i = 0; i < bytes; i++)
+    {
+        *value = (*value << 8) | *in->p++;
+    }
+    return true;
+}
+
+static bool convert_item(cbor_input_t *in, int depth)
+{
+    uint8_t major;
+    uint8_t info;
+    uint64_t value;
+    if (depth > CBOR_MAX_DEPTH || !read_head(in, &major, &info, &value))
+    {
+        return false;
+    }
+
+    json_writer_t *w = in->w;
+    bool indefinite = info == 31;
+
+    switch (major)
+    {
+    case 0:
+        json_uint64(w, value);
+        return true;
+
+    case 1:
+        // -1 - value; commands never need more than 32 bits
+        if (value > 0x7FFFFFFF)
+        {
+            return false;
+        }
+        json_int(w, (int32_t)(-1 - (int64_t)value));
+        return true;
+
+    case 3:
+        if (indefinite || value > (uint64_t)(in->end - in->p))
+        {
+            return false;
+        }
+        json_string_n(w, (const char *)in->p, (size_t)value);
+        in->p += value;
+        return true;
+
+    case 4:
+        json_begin_array(w);
+        for (uint64_t i = 0; indefinite ? !at_break(in) : i < value; i++)
+        {
+            if (!convert_item(in, depth + 1))
+            {
+                return false;
+            }
+        }
+        json_end_array(w);
+        return !json_writer_overflowed(w);
+
+    case 5:
+        json_begin_object(w);
+        for (uint64_t i = 0; indefinite ? !at_break(in) : i < value; i++)
+        {
+            // Keys must be short definite text strings
+            uint8_t key_major;
+            uint8_t key_info;
+            uint64_t key_len;
+            char key[CBOR_KEY_MAX];
+            if (!read_head(in, &key_major, &key_info, &key_len) || key_major != 3 || key_info == 31 ||
+                key_len >= sizeof(key) || key_len > (uint64_t)(in->end - in->p))
+            {
+                return false;
+            }
+            memcpy(key, in->p, (size_t)key_len);
+            key[key_len] = '\0';
+            in->p += key_len;
+
+            json_key(w, key);
+            if (!convert_item(in, depth + 1))
+            {
+                return false;
+            }
+        }
+        json_end_object(w);
+        return !json_writer_overflowed(w);
+
+    case 6:
+        return convert_item(in, depth); // Tag: the tagged item stands for itself
+
+    case 7:
+        return convert_simple(in, info, value);
+
+    default:
+        return false; // Byte strings
+    }
+}
+
+static bool convert_simple(cbor_input_t *in, uint8_t info, uint64_t value)
+{
+    json_writer_t *w = in->w;
+
+    switch (info)
+    {
+    case 20:
+        json_bool(w, false);
+        return true;
+    case 21:
+        json_bool(w, true);
+        return true;
+    case 22: // null
+    case 23: // undefined
+        json_null(w);
+        return true;
+    case 25:
+        json_float(w, half_to_float((uint16_t)value), CBOR_FLOAT_DECIMALS);
+        return true;
+    case 26:
+    {
+        uint32_t bits = (uint32_t)value;
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        json_float(w, f, CBOR_FLOAT_DECIMALS);
+        return true;
+    }
+    case 27:
+    {
+        double d;
+        memcpy(&d, &value, sizeof(d));
+        json_float(w, (float)d, CBOR_FLOAT_DECIMALS);
+        return true;
+    }
+    default:
+        return false; // Unassigned simple values and a stray break
+    }
+}
+
+static bool at_break(cbor_input_t *in)
+{
+    // Consumes the break that ends an indefinite container
+    if (in->p < in->end && *in->p == 0xFF)
+    {
+        in->p++;
+        return true;
+    }
+    return false;
+}
+
+static float half_to_float(uint16_t half)
+{
+    // Rebuild the single-precision bit pattern (RFC 8949 appendix D)
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    uint32_t bits;
+
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+        {
+            bits = sign;
+        }
+        else
+        {
+            // Subnormal: normalise into the wider exponent range
+            exponent = 127 - 15 + 1;
+            while ((mantissa & 0x400) == 0)
+            {
+                mantissa <<= 1;
+                exponent--;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+        }
+    }
+    else if (exponent == 0x1F)
+    {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
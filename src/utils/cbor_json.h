@@ -0,0 +1,50 @@
+/**
+ * @file cbor_json.h
+ * @brief CBOR to JSON text conversion for inbound binary WebSocket messages
+ *
+ * Clients that negotiated the CBOR encoding send their commands as CBOR
+ * too. Commands are few and small, so rather than teaching every parser a
+ * second syntax they are converted to JSON text once on arrival and take
+ * the normal command path. Outbound CBOR is written directly by
+ * json_writer_t in JSON_FORMAT_CBOR.
+ *
+ * Supported: integers, text strings, arrays and maps (definite and
+ * indefinite length, text keys), booleans, null/undefined, half, single and
+ * double floats; tags are ignored. Byte strings have no JSON form and are
+ * rejected.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef CBOR_JSON_H
+#define CBOR_JSON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Convert one CBOR data item to JSON text
+     * @param cbor Encoded item
+     * @param len Encoded length; trailing bytes are an error
+     * @param out Output buffer, NUL terminated on success
+     * @param out_size Output buffer size
+     * @return JSON length, 0 if the input is malformed, unsupported or does not fit
+     */
+    size_t cbor_to_json(const uint8_t *cbor, size_t len, char *out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CBOR_JSON_H
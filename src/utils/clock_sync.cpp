@@ -0,0 +1,282 @@
+/**
+ * @file clock_sync.cpp
+ * @brief Minimum-delay offset filter, drift estimate and SNTP packets
+ */
+
+#include "clock_sync.h"
+
+#include <string.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define NTP_MODE_CLIENT 3
+#define NTP_MODE_SERVER 4
+#define NTP_VERSION 4
+#define NTP_LEAP_UNSYNCHRONISED 3
+#define NTP_PRECISION_LOG2 -20 // About a microsecond
+
+// Field offsets
+#define NTP_OFFSET_REFERENCE_ID 12
+#define NTP_OFFSET_REFERENCE 16
+#define NTP_OFFSET_ORIGINATE 24
+#define NTP_OFFSET_RECEIVE 32
+#define NTP_OFFSET_TRANSMIT 40
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static void update_drift(clock_sync_t *sync, const clock_sync_sample_t *sample);
+static void put_be32(uint8_t *out, uint32_t value);
+static uint32_t get_be32(const uint8_t *in);
+static void put_ntp_time(uint8_t *out, int64_t unix_us);
+static int64_t get_ntp_time(const uint8_t *in);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+void clock_sync_init(clock_sync_t *sync)
+{
+    memset(sync, 0, sizeof(*sync));
+}
+
+bool clock_sync_add_exchange(clock_sync_t *sync, uint64_t t1_local_us, int64_t t2_host_us, int64_t t3_host_us,
+                             uint64_t t4_local_us)
+{
+    sync->exchanges++;
+
+    int64_t round_trip = (int64_t)(t4_local_us - t1_local_us) - (t3_host_us - t2_host_us);
+    if (t4_local_us < t1_local_us || round_trip < 0 || round_trip > CLOCK_SYNC_MAX_DELAY_US)
+    {
+        sync->rejected++;
+        return false;
+    }
+
+    clock_sync_sample_t *sample = &sync->samples[sync->next_sample];
+    sample->local_us = t1_local_us + (t4_local_us - t1_local_us) / 2;
+    sample->offset_us = ((t2_host_us - (int64_t)t1_local_us) + (t3_host_us - (int64_t)t4_local_us)) / 2;
+    sample->delay_us = (uint32_t)round_trip;
+    sync->next_sample = (uint8_t)((sync->next_sample + 1) % CLOCK_SYNC_FILTER_SIZE);
+    if (sync->sample_count < CLOCK_SYNC_FILTER_SIZE)
+    {
+        sync->sample_count++;
+    }
+
+    // The least-queued exchange is the most accurate one
+    const clock_sync_sample_t *best = &sync->samples[0];
+    for (uint8_t i = 1; i < sync->sample_count; i++)
+    {
+        if (sync->samples[i].delay_us < best->delay_us)
+        {
+            best = &sync->samples[i];
+        }
+    }
+    if (sync->mapping.synced && best->local_us <= sync->last_used_local_us)
+    {
+        return false; // Already acted on; a newer exchange will beat it eventually
+    }
+    sync->last_used_local_us = best->local_us;
+    sync->last_delay_us = best->delay_us;
+
+    // Error and continuity are judged against the mapping as it stands
+    clock_sync_mapping_t *mapping = &sync->mapping;
+    int64_t error = (int64_t)best->local_us + best->offset_us - clock_sync_map(mapping, best->local_us);
+    int64_t host_now = clock_sync_map(mapping, t4_local_us);
+    bool step = !mapping->synced || error > CLOCK_SYNC_STEP_US || error < -CLOCK_SYNC_STEP_US;
+    sync->last_error_us = step ? 0 : (int32_t)error;
+
+    if (step)
+    {
+        // The host clock jumped (or this is the first exchange): older offsets are no baseline for drift
+        sync->have_reference = false;
+    }
+    update_drift(sync, best);
+
+    mapping->base_local_us = t4_local_us;
+    if (step)
+    {
+        mapping->synced = true;
+        mapping->base_host_us = (int64_t)t4_local_us + best->offset_us +
+                                (int64_t)(t4_local_us - best->local_us) * mapping->drift_ppb / 1000000000;
+        mapping->slew_us = 0;
+        mapping->slew_duration_us = 0;
+        sync->steps++;
+    }
+    else
+    {
+        mapping->base_host_us = host_now;
+        mapping->slew_us = (int32_t)error;
+        uint32_t magnitude = (uint32_t)(error < 0 ? -error : error);
+        mapping->slew_duration_us = magnitude > 0 ? magnitude * (1000000 / CLOCK_SYNC_MAX_SLEW_PPM) : 1;
+    }
+    return true;
+}
+
+int64_t clock_sync_map(const clock_sync_mapping_t *mapping, uint64_t local_us)
+{
+    if (!mapping->synced)
+    {
+        return (int64_t)local_us;
+    }
+
+    int64_t elapsed = (int64_t)(local_us - mapping->base_local_us);
+    int64_t host = mapping->base_host_us + elapsed + elapsed * mapping->drift_ppb / 1000000000;
+    if (elapsed > 0 && mapping->slew_us != 0)
+    {
+        host += (uint64_t)elapsed >= mapping->slew_duration_us
+                    ? mapping->slew_us
+                    : (int64_t)mapping->slew_us * elapsed / (int64_t)mapping->slew_duration_us;
+    }
+    return host;
+}
+
+void clock_sync_ntp_request(uint8_t *out, uint64_t cookie)
+{
+    memset(out, 0, CLOCK_SYNC_NTP_PACKET_SIZE);
+    out[0] = (NTP_VERSION << 3) | NTP_MODE_CLIENT;
+    put_be32(out + NTP_OFFSET_TRANSMIT, (uint32_t)(cookie >> 32));
+    put_be32(out + NTP_OFFSET_TRANSMIT + 4, (uint32_t)cookie);
+}
+
+bool clock_sync_ntp_parse_reply(const uint8_t *data, size_t len, uint64_t cookie, int64_t *t2_host_us,
+                                int64_t *t3_host_us)
+{
+    if (data == NULL || len < CLOCK_SYNC_NTP_PACKET_SIZE)
+    {
+        return false;
+    }
+
+    uint8_t leap = data[0] >> 6;
+    uint8_t mode = data[0] & 0x07;
+    uint8_t stratum = data[1];
+    if (mode != NTP_MODE_SERVER || leap == NTP_LEAP_UNSYNCHRONISED || stratum == 0 || stratum > 15)
+    {
+        return false; // Stratum 0 is a kiss-of-death (RATE, DENY, ...)
+    }
+
+    // The server echoes our transmit timestamp; anything else is stale or forged
+    if (get_be32(data + NTP_OFFSET_ORIGINATE) != (uint32_t)(cookie >> 32) ||
+        get_be32(data + NTP_OFFSET_ORIGINATE + 4) != (uint32_t)cookie)
+    {
+        return false;
+    }
+    if (get_be32(data + NTP_OFFSET_TRANSMIT) == 0 && get_be32(data + NTP_OFFSET_TRANSMIT + 4) == 0)
+    {
+        return false;
+    }
+
+    *t2_host_us = get_ntp_time(data + NTP_OFFSET_RECEIVE);
+    *t3_host_us = get_ntp_time(data + NTP_OFFSET_TRANSMIT);
+    return true;
+}
+
+size_t clock_sync_ntp_answer(const uint8_t *request, size_t len, int64_t receive_us, int64_t transmit_us,
+                             uint8_t *out)
+{
+    if (request == NULL || len < CLOCK_SYNC_NTP_PACKET_SIZE || (request[0] & 0x07) != NTP_MODE_CLIENT)
+    {
+        return 0;
+    }
+    uint8_t version = (request[0] >> 3) & 0x07;
+    if (version == 0)
+    {
+        return 0;
+    }
+
+    memset(out, 0, CLOCK_SYNC_NTP_PACKET_SIZE);
+    out[0] = (uint8_t)((version << 3) | NTP_MODE_SERVER);
+    out[1] = 1;          // Primary: answered straight from the host's clock
+    out[2] = request[2]; // Poll interval
+    out[3] = (uint8_t)NTP_PRECISION_LOG2;
+    memcpy(out + NTP_OFFSET_REFERENCE_ID, "LOCL", 4);
+    put_ntp_time(out + NTP_OFFSET_REFERENCE, transmit_us);
+    memcpy(out + NTP_OFFSET_ORIGINATE, request + NTP_OFFSET_TRANSMIT, 8);
+    put_ntp_time(out + NTP_OFFSET_RECEIVE, receive_us);
+    put_ntp_time(out + NTP_OFFSET_TRANSMIT, transmit_us);
+    return CLOCK_SYNC_NTP_PACKET_SIZE;
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+/**
+ * Frequency error from the offset change since the reference exchange.
+ * Offsets are raw host-minus-local values, so corrections applied to the
+ * mapping do not disturb the estimate.
+ */
+static void update_drift(clock_sync_t *sync, const clock_sync_sample_t *sample)
+{
+    if (!sync->have_reference)
+    {
+        sync->have_reference = true;
+        sync->reference_local_us = sample->local_us;
+        sync->reference_offset_us = sample->offset_us;
+        return;
+    }
+
+    uint64_t interval = sample->local_us - sync->reference_local_us;
+    if (interval < CLOCK_SYNC_DRIFT_INTERVAL_US)
+    {
+        return;
+    }
+
+    int64_t frequency = (sample->offset_us - sync->reference_offset_us) * 1000000000 / (int64_t)interval;
+    if (frequency > CLOCK_SYNC_MAX_DRIFT_PPB)
+    {
+        frequency = CLOCK_SYNC_MAX_DRIFT_PPB;
+    }
+    else if (frequency < -CLOCK_SYNC_MAX_DRIFT_PPB)
+    {
+        frequency = -CLOCK_SYNC_MAX_DRIFT_PPB;
+    }
+
+    int32_t *drift = &sync->mapping.drift_ppb;
+    *drift = sync->have_drift ? *drift + (int32_t)((frequency - *drift) / CLOCK_SYNC_DRIFT_WEIGHT) : (int32_t)frequency;
+    sync->have_drift = true;
+    sync->reference_local_us = sample->local_us;
+    sync->reference_offset_us = sample->offset_us;
+}
+
+static void put_be32(uint8_t *out, uint32_t value)
+{
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+}
+
+static uint32_t get_be32(const uint8_t *in)
+{
+    return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3];
+}
+
+static void put_ntp_time(uint8_t *out, int64_t unix_us)
+{
+    int64_t seconds = unix_us / 1000000;
+    int64_t micros = unix_us % 1000000;
+    if (micros < 0)
+    {
+        seconds--;
+        micros += 1000000;
+    }
+    put_be32(out, (uint32_t)(seconds + (int64_t)CLOCK_SYNC_NTP_UNIX_OFFSET));
+    // Rounded up, so get_ntp_time() gives back the same microsecond
+    put_be32(out + 4, (uint32_t)((((uint64_t)micros << 32) + 999999) / 1000000));
+}
+
+static int64_t get_ntp_time(const uint8_t *in)
+{
+    uint64_t seconds = get_be32(in);
+    uint64_t fraction = get_be32(in + 4);
+
+    // Era 1 begins in 2036; a timestamp with the top bit clear is taken to be from it
+    if (seconds < 0x80000000u)
+    {
+        seconds += 1ull << 32;
+    }
+    return (int64_t)(seconds - CLOCK_SYNC_NTP_UNIX_OFFSET) * 1000000 + (int64_t)((fraction * 1000000) >> 32);
+}
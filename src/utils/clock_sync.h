@@ -0,0 +1,172 @@
+/**
+ * @file clock_sync.h
+ * @brief Offset and drift estimation against a host clock, plus the SNTP wire format
+ *
+ * Each exchange with the host gives four timestamps: t1 (request sent,
+ * local clock), t2 (received, host), t3 (answered, host) and t4 (answer
+ * received, local). As in NTP, the host-minus-local offset is
+ * ((t2 - t1) + (t3 - t4)) / 2 and the round trip is (t4 - t1) - (t3 - t2).
+ * Over WiFi most round trips are inflated by queuing, so only the exchange
+ * with the smallest round trip among the last CLOCK_SYNC_FILTER_SIZE is
+ * used. Offsets far enough apart give the local oscillator's frequency
+ * error (drift), which keeps the mapping accurate between exchanges.
+ *
+ * The result is a mapping from the local 64-bit microsecond clock to host
+ * time, normally Unix time in microseconds. After the first exchange it is
+ * only stepped for errors beyond CLOCK_SYNC_STEP_US; smaller ones are
+ * slewed out at no more than CLOCK_SYNC_MAX_SLEW_PPM, so timestamps stay
+ * monotonic and sample blocks keep their spacing.
+ *
+ * The SNTP helpers (RFC 4330) let the firmware use any NTP server, and
+ * let a host tool answer those requests from its own clock.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#define CLOCK_SYNC_FILTER_SIZE 8                 // Exchanges the minimum round trip is taken over
+#define CLOCK_SYNC_MAX_DELAY_US 500000           // Exchanges with longer round trips are ignored
+#define CLOCK_SYNC_STEP_US 128000                // Larger errors are stepped, smaller ones slewed
+#define CLOCK_SYNC_MAX_SLEW_PPM 500              // Fastest rate a slew corrects at
+#define CLOCK_SYNC_MAX_DRIFT_PPB 500000          // Largest frequency error believed
+#define CLOCK_SYNC_DRIFT_INTERVAL_US 60000000ull // Shortest baseline for a frequency estimate
+#define CLOCK_SYNC_DRIFT_WEIGHT 4                // New frequency estimates count 1/N
+
+#define CLOCK_SYNC_NTP_PACKET_SIZE 48
+#define CLOCK_SYNC_NTP_PORT 123
+#define CLOCK_SYNC_NTP_UNIX_OFFSET 2208988800ull // Seconds from 1900 (NTP era 0) to 1970
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Local-to-host time mapping; small enough to copy when publishing
+     *
+     * host = base_host_us + d + d * drift_ppb / 1e9 + slew progress, where
+     * d = local - base_local_us and the slew of slew_us is spread evenly
+     * over slew_duration_us.
+     */
+    typedef struct
+    {
+        bool synced;
+        uint64_t base_local_us;
+        int64_t base_host_us;
+        int32_t drift_ppb;
+        int32_t slew_us;
+        uint32_t slew_duration_us;
+    } clock_sync_mapping_t;
+
+    /**
+     * @brief One completed exchange
+     */
+    typedef struct
+    {
+        uint64_t local_us; // Midpoint of t1 and t4
+        int64_t offset_us; // Host minus local
+        uint32_t delay_us; // Round trip less the host's processing time
+    } clock_sync_sample_t;
+
+    /**
+     * @brief Estimator state
+     */
+    typedef struct
+    {
+        clock_sync_mapping_t mapping;
+        clock_sync_sample_t samples[CLOCK_SYNC_FILTER_SIZE];
+        uint8_t sample_count;
+        uint8_t next_sample;
+        uint64_t last_used_local_us; // Filters never act on the same exchange twice
+        bool have_reference;         // Baseline for the next frequency estimate
+        bool have_drift;
+        uint64_t reference_local_us;
+        int64_t reference_offset_us;
+        uint32_t exchanges;
+        uint32_t rejected; // Negative or overlong round trips
+        uint32_t steps;
+        int32_t last_error_us; // Filtered offset minus the mapping before it was corrected
+        uint32_t last_delay_us;
+    } clock_sync_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Reset the estimator; the mapping is the identity until the first exchange
+     * @param sync Estimator
+     */
+    void clock_sync_init(clock_sync_t *sync);
+
+    /**
+     * @brief Feed one exchange
+     * @param sync Estimator
+     * @param t1_local_us Request sent, local clock
+     * @param t2_host_us Request received, host clock
+     * @param t3_host_us Reply sent, host clock
+     * @param t4_local_us Reply received, local clock; the mapping is rebased here
+     * @return true if the mapping changed
+     */
+    bool clock_sync_add_exchange(clock_sync_t *sync, uint64_t t1_local_us, int64_t t2_host_us, int64_t t3_host_us,
+                                 uint64_t t4_local_us);
+
+    /**
+     * @brief Convert a local timestamp to host time
+     * @param mapping Mapping from clock_sync_t (or a published copy)
+     * @param local_us Local clock reading, may be slightly in the past
+     * @return Host time, or local_us unchanged if not synced yet
+     */
+    int64_t clock_sync_map(const clock_sync_mapping_t *mapping, uint64_t local_us);
+
+    /**
+     * @brief Build an SNTP client request
+     * @param out Buffer of CLOCK_SYNC_NTP_PACKET_SIZE bytes
+     * @param cookie Sent as the transmit timestamp; the server echoes it back
+     */
+    void clock_sync_ntp_request(uint8_t *out, uint64_t cookie);
+
+    /**
+     * @brief Validate an SNTP reply and extract the host timestamps
+     * @param data Reply bytes
+     * @param len Reply length
+     * @param cookie Cookie of the outstanding request
+     * @param t2_host_us Receives the server's receive time (Unix microseconds)
+     * @param t3_host_us Receives the server's transmit time (Unix microseconds)
+     * @return false for a stale, spoofed, unsynchronised or kiss-of-death reply
+     */
+    bool clock_sync_ntp_parse_reply(const uint8_t *data, size_t len, uint64_t cookie, int64_t *t2_host_us,
+                                    int64_t *t3_host_us);
+
+    /**
+     * @brief Answer an SNTP request (server side, for host tools)
+     * @param request Request bytes
+     * @param len Request length
+     * @param receive_us When the request arrived (Unix microseconds)
+     * @param transmit_us When the reply will be sent (Unix microseconds)
+     * @param out Buffer of CLOCK_SYNC_NTP_PACKET_SIZE bytes
+     * @return Reply length, 0 if the request is not an SNTP client request
+     */
+    size_t clock_sync_ntp_answer(const uint8_t *request, size_t len, int64_t receive_us, int64_t transmit_us,
+                                 uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CLOCK_SYNC_H
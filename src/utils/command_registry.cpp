@@ -0,0 +1,743 @@
+/**
+ * @file command_registry.cpp
+ * @brief Command lookup, argument conversion and reply envelopes
+ */
+
+#include "command_registry.h"
+#include "json_reader.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define CMD_ID_MAX 32        // Longest echoed request id
+#define CMD_TYPE_MAX 16      // Longest envelope type
+#define CMD_TOKENS_MAX 128   // Longest legacy params token string
+#define CMD_REPLY_RESERVE 96 // Room kept after a result for an error and the closing brackets
+
+// =============================================================================
+// PRIVATE TYPES
+// =============================================================================
+
+typedef struct
+{
+    json_token_t type; // STRING, NUMBER or NULL
+    char text[CMD_ID_MAX];
+} request_id_t;
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static const cmd_def_t *command_table = NULL;
+static size_t command_count = 0;
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static const char *skip_ws(const char *p);
+static bool next_token(const char **p, char *out, size_t size);
+static cmd_status_t parse_json_args(const cmd_def_t *def, const char *object, cmd_context_t *ctx);
+static cmd_status_t parse_token_args(const cmd_def_t *def, const char *text, cmd_context_t *ctx);
+static cmd_status_t convert_arg(const cmd_arg_spec_t *spec, const char *text, cmd_arg_value_t *value, cmd_context_t *ctx);
+static bool run_json_command(json_writer_t *w, const char *request, size_t len, cmd_source_t source, int client_id,
+                             const char *skip_reason);
+static void read_id(json_reader_t *r, request_id_t *id);
+static void write_id(json_writer_t *w, const request_id_t *id);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+void command_registry_init(const cmd_def_t *table, size_t count)
+{
+    command_table = table;
+    command_count = table ? count : 0;
+}
+
+const cmd_def_t *command_registry_table(size_t *count)
+{
+    if (count)
+    {
+        *count = command_count;
+    }
+    return command_table;
+}
+
+const cmd_def_t *command_find(const char *name)
+{
+    if (name == NULL)
+    {
+        return NULL;
+    }
+
+    size_t lo = 0;
+    size_t hi = command_count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int order = command_name_compare(name, command_table[mid].name);
+        if (order == 0)
+        {
+            return &command_table[mid];
+        }
+        if (order < 0)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+cmd_status_t command_execute(const char *name, const char *params, cmd_context_t *ctx)
+{
+    memset(ctx->args, 0, sizeof(ctx->args));
+    ctx->error[0] = '\0';
+
+    const cmd_def_t *def = command_find(name);
+    if (def == NULL)
+    {
+        return cmd_error(ctx, CMD_ERR_UNKNOWN, "unknown command '%.31s'", name ? name : "");
+    }
+
+    const char *text = skip_ws(params ? params : "");
+    cmd_status_t status = (*text == '{') ? parse_json_args(def, text, ctx) : parse_token_args(def, text, ctx);
+    if (status != CMD_OK)
+    {
+        return status;
+    }
+
+    for (uint8_t i = 0; i < def->arg_count; i++)
+    {
+        if (def->args[i].required && !ctx->args[i].present)
+        {
+            return cmd_error(ctx, CMD_ERR_ARGS, "missing argument '%s'", def->args[i].name);
+        }
+    }
+
+    // The handler writes straight into the reply; a checkpoint lets a
+    // failed or oversized result be taken back
+    json_writer_t before = *ctx->json;
+    status = def->handler(ctx);
+
+    if (status == CMD_OK && json_writer_overflowed(ctx->json))
+    {
+        status = cmd_error(ctx, CMD_ERR_OVERFLOW, "result too large for the reply");
+    }
+    if (status != CMD_OK)
+    {
+        *ctx->json = before;
+        if (ctx->error[0] == '\0')
+        {
+            cmd_error(ctx, status, "%s", cmd_status_name(status));
+        }
+        return status;
+    }
+
+    if (ctx->json->len == before.len)
+    {
+        json_null(ctx->json);
+    }
+    return CMD_OK;
+}
+
+size_t command_execute_json(const char *message, cmd_source_t source, int client_id, json_format_t format,
+                            char *out, size_t out_size)
+{
+    if (message == NULL || out == NULL || out_size <= CMD_REPLY_RESERVE)
+    {
+        return 0;
+    }
+
+    // One pass over the top-level members; the commands array is revisited
+    // from a copy of the reader taken where it starts
+    json_reader_t r;
+    size_t message_len = strlen(message);
+    json_reader_init(&r, message, message_len);
+    if (json_next(&r) != JSON_TOKEN_OBJECT_BEGIN)
+    {
+        return 0;
+    }
+
+    char type[CMD_TYPE_MAX] = "command";
+    request_id_t id = {JSON_TOKEN_NULL, ""};
+    bool has_command = false;
+    bool stop_on_error = false;
+    bool has_list = false;
+    json_reader_t list;
+
+    json_token_t token;
+    while ((token = json_next(&r)) == JSON_TOKEN_KEY)
+    {
+        if (json_token_is(&r, "type"))
+        {
+            if (json_next(&r) != JSON_TOKEN_STRING || !json_token_copy(&r, type, sizeof(type)))
+            {
+                return 0;
+            }
+        }
+        else if (json_token_is(&r, "id"))
+        {
+            read_id(&r, &id);
+        }
+        else if (json_token_is(&r, "stopOnError"))
+        {
+            stop_on_error = json_next(&r) == JSON_TOKEN_TRUE;
+            json_skip(&r);
+        }
+        else if (json_token_is(&r, "commands"))
+        {
+            has_list = json_next(&r) == JSON_TOKEN_ARRAY_BEGIN;
+            list = r;
+            json_skip(&r);
+        }
+        else
+        {
+            has_command |= json_token_is(&r, "command");
+            json_skip(&r);
+        }
+    }
+    if (token != JSON_TOKEN_OBJECT_END)
+    {
+        return 0;
+    }
+
+    bool batch = strcmp(type, "batch") == 0;
+    if ((!batch && strcmp(type, "command") != 0) || (!batch && !has_command))
+    {
+        return 0;
+    }
+
+    json_writer_t w;
+    json_writer_init_format(&w, out, out_size, format);
+    json_begin_object(&w);
+    json_kv_string(&w, "type", batch ? "batch_result" : "result");
+
+    if (!batch)
+    {
+        run_json_command(&w, message, message_len, source, client_id, NULL);
+    }
+    else if (!has_list)
+    {
+        write_id(&w, &id);
+        json_kv_bool(&w, "ok", false);
+        json_kv_string(&w, "error", "'commands' must be an array");
+    }
+    else
+    {
+        write_id(&w, &id);
+        json_key(&w, "results");
+        json_begin_array(&w);
+
+        const char *skip_reason = NULL;
+        int index = 0;
+        while ((token = json_next(&list)) != JSON_TOKEN_ARRAY_END && token != JSON_TOKEN_ERROR &&
+               !json_writer_overflowed(&w))
+        {
+            json_begin_object(&w);
+            if (token != JSON_TOKEN_OBJECT_BEGIN)
+            {
+                json_skip(&list);
+                json_key(&w, "id");
+                json_null(&w);
+                json_kv_bool(&w, "ok", false);
+                json_kv_string(&w, "error", "batch entries must be objects");
+            }
+            else
+            {
+                const char *item = list.token;
+                json_skip(&list);
+
+                bool ok = run_json_command(&w, item, (size_t)(list.p - item), source, client_id,
+                                           index >= CMD_BATCH_MAX ? "batch limit reached" : skip_reason);
+                if (stop_on_error && !ok && skip_reason == NULL)
+                {
+                    skip_reason = "skipped after an earlier failure";
+                }
+            }
+            json_end_object(&w);
+            index++;
+        }
+
+        json_end_array(&w);
+    }
+    json_end_object(&w);
+
+    size_t len = json_writer_finish(&w);
+    if (len == 0)
+    {
+        // Never send a truncated envelope; the client still gets its id back
+        json_writer_init_format(&w, out, out_size, format);
+        json_begin_object(&w);
+        json_kv_string(&w, "type", batch ? "batch_result" : "result");
+        write_id(&w, &id);
+        json_kv_bool(&w, "ok", false);
+        json_kv_string(&w, "error", "reply too large");
+        json_end_object(&w);
+        len = json_writer_finish(&w);
+    }
+    return len;
+}
+
+size_t command_execute_line(const char *line, cmd_source_t source, int client_id, char *out, size_t out_size)
+{
+    if (line == NULL || out == NULL || out_size <= CMD_REPLY_RESERVE)
+    {
+        return 0;
+    }
+
+    size_t len = 0;
+    out[0] = '\0';
+
+    const char *p = line;
+    int executed = 0;
+    while (*p && executed < CMD_BATCH_MAX)
+    {
+        // One segment per ';' outside quotes
+        char segment[160];
+        size_t n = 0;
+        bool quoted = false;
+        for (; *p && (quoted || *p != ';'); p++)
+        {
+            if (*p == '"')
+            {
+                quoted = !quoted;
+            }
+            if (n + 1 < sizeof(segment))
+            {
+                segment[n++] = *p;
+            }
+        }
+        segment[n] = '\0';
+        if (*p == ';')
+        {
+            p++;
+        }
+
+        const char *params = segment;
+        char name[CMD_NAME_MAX];
+        if (!next_token(&params, name, sizeof(name)))
+        {
+            continue; // Blank segment
+        }
+
+        // "OK NAME " is followed by the result written in place
+        int prefix = snprintf(out + len, out_size - len, "OK %s ", name);
+        if (prefix < 0 || out_size - len <= (size_t)prefix + CMD_REPLY_RESERVE)
+        {
+            break;
+        }
+
+        json_writer_t result;
+        json_writer_init(&result, out + len + prefix, out_size - len - (size_t)prefix - CMD_REPLY_RESERVE);
+
+        cmd_context_t ctx;
+        ctx.source = source;
+        ctx.client_id = client_id;
+        ctx.json = &result;
+
+        cmd_status_t status = command_execute(name, params, &ctx);
+        size_t result_len = (status == CMD_OK) ? json_writer_finish(&result) : 0;
+
+        int written;
+        if (result_len > 0)
+        {
+            len += (size_t)prefix + result_len;
+            written = snprintf(out + len, out_size - len, "\n");
+        }
+        else
+        {
+            written = snprintf(out + len, out_size - len, "ERR %s %s\n", name, ctx.error);
+        }
+        if (written < 0 || (size_t)written >= out_size - len)
+        {
+            break;
+        }
+        len += (size_t)written;
+        executed++;
+    }
+
+    out[len] = '\0';
+    return len;
+}
+
+cmd_status_t cmd_error(cmd_context_t *ctx, cmd_status_t status, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vsnprintf(ctx->error, sizeof(ctx->error), format, args);
+    va_end(args);
+    return status;
+}
+
+const char *cmd_status_name(cmd_status_t status)
+{
+    switch (status)
+    {
+    case CMD_OK:
+        return "ok";
+    case CMD_ERR_UNKNOWN:
+        return "unknown command";
+    case CMD_ERR_ARGS:
+        return "invalid arguments";
+    case CMD_ERR_FAILED:
+        return "failed";
+    case CMD_ERR_UNAVAILABLE:
+        return "unavailable";
+    case CMD_ERR_OVERFLOW:
+        return "result too large";
+    default:
+        return "error";
+    }
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static const char *skip_ws(const char *p)
+{
+    while (p && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+    {
+        p++;
+    }
+    return p;
+}
+
+static bool next_token(const char **p, char *out, size_t size)
+{
+    // Space separated; "double quotes" keep spaces and ';' inside a token
+    const char *s = skip_ws(*p);
+    size_t n = 0;
+    bool quoted = false;
+
+    if (*s == '\0')
+    {
+        *p = s;
+        return false;
+    }
+
+    for (; *s && (quoted || (*s != ' ' && *s != '\t')); s++)
+    {
+        if (*s == '"')
+        {
+            quoted = !quoted;
+            continue;
+        }
+        if (n + 1 < size)
+        {
+            out[n++] = *s;
+        }
+    }
+    out[n] = '\0';
+    *p = s;
+    return true;
+}
+
+static cmd_status_t parse_json_args(const cmd_def_t *def, const char *object, cmd_context_t *ctx)
+{
+    // Members are matched against the declared names in one pass; anything
+    // else is skipped unread
+    json_reader_t r;
+    json_reader_init(&r, object, strlen(object));
+    if (json_next(&r) != JSON_TOKEN_OBJECT_BEGIN)
+    {
+        return cmd_error(ctx, CMD_ERR_ARGS, "malformed params object");
+    }
+
+    json_token_t token;
+    while ((token = json_next(&r)) == JSON_TOKEN_KEY)
+    {
+        int index = -1;
+        for (uint8_t i = 0; i < def->arg_count && index < 0; i++)
+        {
+            if (json_token_is(&r, def->args[i].name))
+            {
+                index = i;
+            }
+        }
+        if (index < 0)
+        {
+            if (!json_skip(&r))
+            {
+                break;
+            }
+            continue;
+        }
+
+        const cmd_arg_spec_t *spec = &def->args[index];
+        token = json_next(&r);
+        if (token == JSON_TOKEN_NULL)
+        {
+            continue;
+        }
+
+        char text[CMD_STRING_ARG_MAX];
+        if (token == JSON_TOKEN_OBJECT_BEGIN || token == JSON_TOKEN_ARRAY_BEGIN || token == JSON_TOKEN_ERROR ||
+            !json_token_copy(&r, text, sizeof(text)))
+        {
+            return cmd_error(ctx, CMD_ERR_ARGS, "'%s' must be a short string, number or bool", spec->name);
+        }
+
+        cmd_status_t status = convert_arg(spec, text, &ctx->args[index], ctx);
+        if (status != CMD_OK)
+        {
+            return status;
+        }
+    }
+
+    if (token != JSON_TOKEN_OBJECT_END)
+    {
+        return cmd_error(ctx, CMD_ERR_ARGS, "malformed params object");
+    }
+    return CMD_OK;
+}
+
+static cmd_status_t parse_token_args(const cmd_def_t *def, const char *text, cmd_context_t *ctx)
+{
+    char token[CMD_STRING_ARG_MAX + CMD_NAME_MAX];
+    uint8_t positional = 0;
+
+    while (next_token(&text, token, sizeof(token)))
+    {
+        int index = -1;
+        const char *value = token;
+
+        // key=value names an argument directly
+        char *eq = strchr(token, '=');
+        if (eq)
+        {
+            *eq = '\0';
+            for (uint8_t i = 0; i < def->arg_count; i++)
+            {
+                if (command_name_compare(token, def->args[i].name) == 0)
+                {
+                    index = i;
+                    value = eq + 1;
+                    break;
+                }
+            }
+            if (index < 0)
+            {
+                *eq = '='; // Not a known name, so the '=' is part of a positional value
+            }
+        }
+
+        if (index < 0)
+        {
+            while (positional < def->arg_count && ctx->args[positional].present)
+            {
+                positional++;
+            }
+            if (positional >= def->arg_count)
+            {
+                return cmd_error(ctx, CMD_ERR_ARGS, "too many arguments (expected %u)", def->arg_count);
+            }
+            index = positional;
+        }
+
+        cmd_status_t status = convert_arg(&def->args[index], value, &ctx->args[index], ctx);
+        if (status != CMD_OK)
+        {
+            return status;
+        }
+    }
+    return CMD_OK;
+}
+
+static cmd_status_t convert_arg(const cmd_arg_spec_t *spec, const char *text, cmd_arg_value_t *value, cmd_context_t *ctx)
+{
+    char *end = NULL;
+
+    switch (spec->type)
+    {
+    case CMD_ARG_INT:
+    {
+        long v = strtol(text, &end, 0);
+        if (end == text || *end != '\0')
+        {
+            return cmd_error(ctx, CMD_ERR_ARGS, "'%s' must be an integer", spec->name);
+        }
+        if (v < spec->min || v > spec->max)
+        {
+            return cmd_error(ctx, CMD_ERR_ARGS, "'%s' must be %ld..%ld", spec->name, (long)spec->min, (long)spec->max);
+        }
+        value->i = (int32_t)v;
+        value->f = (float)v;
+        break;
+    }
+    case CMD_ARG_FLOAT:
+        value->f = strtof(text, &end);
+        if (end == text || *end != '\0')
+        {
+            return cmd_error(ctx, CMD_ERR_ARGS, "'%s' must be a number", spec->name);
+        }
+        value->i = (int32_t)value->f;
+        break;
+    case CMD_ARG_BOOL:
+        if (strcmp(text, "true") == 0 || strcmp(text, "1") == 0 || command_name_compare(text, "on") == 0)
+        {
+            value->b = true;
+        }
+        else if (strcmp(text, "false") == 0 || strcmp(text, "0") == 0 || command_name_compare(text, "off") == 0)
+        {
+            value->b = false;
+        }
+        else
+        {
+            return cmd_error(ctx, CMD_ERR_ARGS, "'%s' must be true or false", spec->name);
+        }
+        value->i = value->b ? 1 : 0;
+        break;
+    case CMD_ARG_STRING:
+    {
+        size_t len = strlen(text);
+        if (len >= sizeof(value->s) || (spec->max > 0 && len > (size_t)spec->max))
+        {
+            return cmd_error(ctx, CMD_ERR_ARGS, "'%s' is longer than %ld characters", spec->name,
+                             (long)(spec->max > 0 ? spec->max : (int32_t)sizeof(value->s) - 1));
+        }
+        break;
+    }
+    default:
+        return cmd_error(ctx, CMD_ERR_ARGS, "'%s' has an unsupported type", spec->name);
+    }
+
+    // The text form is kept for every type so handlers can echo or re-parse it
+    snprintf(value->s, sizeof(value->s), "%s", text);
+    value->present = true;
+    return CMD_OK;
+}
+
+static bool run_json_command(json_writer_t *w, const char *request, size_t len, cmd_source_t source, int client_id,
+                             const char *skip_reason)
+{
+    // Writes "id", "command" and the outcome members of the reply object
+    json_reader_t r;
+    json_reader_init(&r, request, len);
+    json_next(&r); // OBJECT_BEGIN, checked by the caller
+
+    request_id_t id = {JSON_TOKEN_NULL, ""};
+    char name[CMD_NAME_MAX] = "";
+    bool named = false;
+    const char *params = NULL;
+    char tokens[CMD_TOKENS_MAX] = "";
+
+    while (json_next(&r) == JSON_TOKEN_KEY)
+    {
+        if (json_token_is(&r, "id"))
+        {
+            read_id(&r, &id);
+        }
+        else if (json_token_is(&r, "command"))
+        {
+            named = json_next(&r) == JSON_TOKEN_STRING && json_token_copy(&r, name, sizeof(name));
+            json_skip(&r);
+        }
+        else if (json_token_is(&r, "params"))
+        {
+            // Params may be an object, parsed in place later, or, from
+            // older clients, a token string
+            json_token_t token = json_next(&r);
+            if (token == JSON_TOKEN_OBJECT_BEGIN)
+            {
+                params = r.token;
+                json_skip(&r);
+            }
+            else if (token == JSON_TOKEN_STRING && json_token_copy(&r, tokens, sizeof(tokens)))
+            {
+                params = tokens;
+            }
+            else
+            {
+                json_skip(&r);
+            }
+        }
+        else
+        {
+            json_skip(&r);
+        }
+    }
+
+    write_id(w, &id);
+    json_kv_string(w, "command", named ? name : "");
+
+    if (!named)
+    {
+        json_kv_bool(w, "ok", false);
+        json_kv_string(w, "error", "'command' must be a short string");
+        return false;
+    }
+    if (skip_reason)
+    {
+        json_kv_bool(w, "ok", false);
+        json_kv_string(w, "error", skip_reason);
+        return false;
+    }
+
+    json_writer_t before = *w;
+    json_kv_bool(w, "ok", true);
+    json_key(w, "result");
+    if (!json_writer_reserve(w, CMD_REPLY_RESERVE))
+    {
+        return false; // Overflow latched; the caller sends "reply too large"
+    }
+
+    // The handler writes its result straight into the reply
+    cmd_context_t ctx;
+    ctx.source = source;
+    ctx.client_id = client_id;
+    ctx.json = w;
+
+    cmd_status_t status = command_execute(name, params, &ctx);
+    if (status == CMD_OK)
+    {
+        json_writer_release(w, CMD_REPLY_RESERVE);
+        return true;
+    }
+
+    *w = before;
+    json_kv_bool(w, "ok", false);
+    json_kv_string(w, "status", cmd_status_name(status));
+    json_kv_string(w, "error", ctx.error);
+    return false;
+}
+
+static void read_id(json_reader_t *r, request_id_t *id)
+{
+    // Called at the "id" key; numbers are echoed as written, strings re-escaped
+    json_token_t token = json_next(r);
+    id->type = JSON_TOKEN_NULL;
+    if ((token == JSON_TOKEN_STRING || token == JSON_TOKEN_NUMBER) && json_token_copy(r, id->text, sizeof(id->text)))
+    {
+        id->type = token;
+    }
+    json_skip(r);
+}
+
+static void write_id(json_writer_t *w, const request_id_t *id)
+{
+    json_key(w, "id");
+    if (id->type == JSON_TOKEN_STRING)
+    {
+        json_string(w, id->text);
+    }
+    else if (id->type == JSON_TOKEN_NUMBER)
+    {
+        json_number(w, id->text, strlen(id->text));
+    }
+    else
+    {
+        json_null(w);
+    }
+}
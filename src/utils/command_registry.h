@@ -0,0 +1,271 @@
+/**
+ * @file command_registry.h
+ * @brief Compile-time command table with typed arguments, shared by every console
+ *
+ * Commands live in one constexpr table sorted by name; the sort order is
+ * checked with static_assert (see command_table_is_sorted()) so a lookup is
+ * a binary search with no runtime registration. Each command declares its
+ * arguments, and the registry converts them before the handler runs, from
+ * either a JSON params object (WebSocket) or "positional key=value" tokens
+ * (UART, telnet). Handlers write their result as one JSON value through a
+ * json_writer_t that points straight into the reply, and never see the
+ * transport.
+ *
+ * WebSocket envelopes:
+ *   {"type":"command","id":7,"command":"NAME","params":{...}}
+ *     -> {"type":"result","id":7,"command":"NAME","ok":true,"result":...}
+ *   {"type":"batch","id":8,"commands":[{"id":1,"command":"A"},...]}
+ *     -> {"type":"batch_result","id":8,"results":[{"id":1,"command":"A","ok":true,...},...]}
+ *
+ * Text consoles run "A; B arg; C key=value" in order and answer one
+ * "OK NAME <result>" or "ERR NAME <message>" line per command.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef COMMAND_REGISTRY_H
+#define COMMAND_REGISTRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "json_writer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#define CMD_MAX_ARGS 4        // Arguments per command
+#define CMD_NAME_MAX 32       // Longest command name, including terminator
+#define CMD_STRING_ARG_MAX 64 // Longest string argument, including terminator
+#define CMD_ERROR_MAX 80      // Longest error message, including terminator
+#define CMD_BATCH_MAX 16      // Commands executed from one batch envelope
+#define CMD_REPLY_MAX 2048    // Reply buffer that fits the largest single result
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Where a command came from
+     */
+    typedef enum
+    {
+        CMD_SOURCE_UART = 0,
+        CMD_SOURCE_WEBSOCKET,
+        CMD_SOURCE_TELNET
+    } cmd_source_t;
+
+    /**
+     * @brief Command outcome
+     */
+    typedef enum
+    {
+        CMD_OK = 0,
+        CMD_ERR_UNKNOWN,     // No such command
+        CMD_ERR_ARGS,        // Missing, malformed or out-of-range argument
+        CMD_ERR_FAILED,      // The handler ran and failed
+        CMD_ERR_UNAVAILABLE, // Not possible in the current state
+        CMD_ERR_OVERFLOW     // The result did not fit the reply
+    } cmd_status_t;
+
+    /**
+     * @brief Argument types
+     */
+    typedef enum
+    {
+        CMD_ARG_INT = 0, // Signed 32-bit, checked against min..max
+        CMD_ARG_FLOAT,
+        CMD_ARG_BOOL,   // true/false, 1/0, on/off
+        CMD_ARG_STRING, // At most max characters (and CMD_STRING_ARG_MAX - 1)
+    } cmd_arg_type_t;
+
+    /**
+     * @brief Declared argument
+     */
+    typedef struct
+    {
+        const char *name; // JSON key and key=value name
+        cmd_arg_type_t type;
+        bool required;
+        int32_t min; // INT: smallest value
+        int32_t max; // INT: largest value; STRING: longest length
+    } cmd_arg_spec_t;
+
+    /**
+     * @brief Converted argument
+     */
+    typedef struct
+    {
+        bool present;
+        int32_t i;
+        float f;
+        bool b;
+        char s[CMD_STRING_ARG_MAX];
+    } cmd_arg_value_t;
+
+    /**
+     * @brief Everything a handler sees
+     *
+     * args[] follows the order of the command's cmd_arg_spec_t list. The
+     * handler writes its result (a single JSON value; nothing means null)
+     * with the json_* functions and, on failure, describes the problem with
+     * cmd_error(). Output of a failed or overflowing handler is discarded.
+     */
+    typedef struct
+    {
+        cmd_source_t source;
+        int client_id; // WebSocket client or telnet session, -1 for UART
+        cmd_arg_value_t args[CMD_MAX_ARGS];
+        json_writer_t *json; // Positioned where the result value belongs
+        char error[CMD_ERROR_MAX];
+    } cmd_context_t;
+
+    typedef cmd_status_t (*cmd_handler_t)(cmd_context_t *ctx);
+
+    /**
+     * @brief One table entry
+     */
+    typedef struct
+    {
+        const char *name; // Upper case; matched case-insensitively
+        cmd_handler_t handler;
+        const cmd_arg_spec_t *args;
+        uint8_t arg_count;
+        const char *help;
+    } cmd_def_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Install the command table
+     * @param table Table sorted by name (check with command_table_is_sorted())
+     * @param count Number of entries
+     */
+    void command_registry_init(const cmd_def_t *table, size_t count);
+
+    /**
+     * @brief Get the installed table
+     * @param count Receives the number of entries
+     * @return First entry, NULL before command_registry_init()
+     */
+    const cmd_def_t *command_registry_table(size_t *count);
+
+    /**
+     * @brief Look up a command by name (binary search, case-insensitive)
+     * @param name Command name
+     * @return Entry or NULL
+     */
+    const cmd_def_t *command_find(const char *name);
+
+    /**
+     * @brief Parse arguments and run one command
+     * @param name Command name
+     * @param params JSON object text, or space separated tokens; may be NULL
+     * @param ctx Context with source, client_id and json filled in
+     * @return Outcome; ctx->error describes any failure
+     */
+    cmd_status_t command_execute(const char *name, const char *params, cmd_context_t *ctx);
+
+    /**
+     * @brief Run a WebSocket command or batch envelope
+     * @param message Complete JSON text of the message
+     * @param source Transport the message arrived on
+     * @param client_id Sender
+     * @param format Encoding of the reply (JSON text or CBOR)
+     * @param out Reply buffer
+     * @param out_size Reply buffer size
+     * @return Reply length, 0 if the message was not a command envelope
+     */
+    size_t command_execute_json(const char *message, cmd_source_t source, int client_id, json_format_t format,
+                                char *out, size_t out_size);
+
+    /**
+     * @brief Run a console line of ';' separated commands
+     * @param line Command line
+     * @param source Transport the line arrived on
+     * @param client_id Sender
+     * @param out Reply buffer, one line per command
+     * @param out_size Reply buffer size
+     * @return Reply length
+     */
+    size_t command_execute_line(const char *line, cmd_source_t source, int client_id, char *out, size_t out_size);
+
+    /**
+     * @brief Describe why a command failed
+     * @param ctx Handler context
+     * @param status Status to return from the handler
+     * @param format printf format
+     * @return status
+     */
+    cmd_status_t cmd_error(cmd_context_t *ctx, cmd_status_t status, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+    /**
+     * @brief Name of a status for replies and logs
+     * @param status Status
+     * @return Static string
+     */
+    const char *cmd_status_name(cmd_status_t status);
+
+#ifdef __cplusplus
+}
+
+// =============================================================================
+// COMPILE-TIME TABLE CHECKS
+// =============================================================================
+
+/**
+ * @brief Case-insensitive name order used by the table and the lookup
+ */
+constexpr int command_name_compare(const char *a, const char *b)
+{
+    for (;; a++, b++)
+    {
+        char ca = (*a >= 'a' && *a <= 'z') ? (char)(*a - 'a' + 'A') : *a;
+        char cb = (*b >= 'a' && *b <= 'z') ? (char)(*b - 'a' + 'A') : *b;
+        if (ca != cb || ca == '\0')
+        {
+            return (unsigned char)ca - (unsigned char)cb;
+        }
+    }
+}
+
+/**
+ * @brief Check that a table is strictly sorted and every entry fits the limits
+ *
+ * Use as static_assert(command_table_is_sorted(table), "...") next to the table.
+ */
+template <size_t N>
+constexpr bool command_table_is_sorted(const cmd_def_t (&table)[N])
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        size_t len = 0;
+        while (table[i].name[len] != '\0')
+        {
+            len++;
+        }
+        if (len == 0 || len >= CMD_NAME_MAX || table[i].arg_count > CMD_MAX_ARGS)
+        {
+            return false;
+        }
+        if (i > 0 && command_name_compare(table[i - 1].name, table[i].name) >= 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif
+
+#endif // COMMAND_REGISTRY_H
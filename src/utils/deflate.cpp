@@ -0,0 +1,517 @@
+/**
+ * @file deflate.cpp
+ * @brief Small-window raw DEFLATE implementation
+ */
+
+#include "deflate.h"
+
+#include <string.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define DEFLATE_MIN_MATCH 3
+#define DEFLATE_MAX_MATCH 258
+#define DEFLATE_END_OF_BLOCK 256
+
+#define BLOCK_STORED 0
+#define BLOCK_FIXED 1
+#define BLOCK_DYNAMIC 2
+
+// Length symbols 257..285 and distance symbols 0..29 (RFC 1951 section 3.2.5)
+static const uint16_t length_base[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                         31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t length_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                         2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t dist_base[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                       33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                       1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t dist_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                       6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Order in which code length code lengths are sent
+static const uint8_t code_length_order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// What the sender stripped after the sync flush (RFC 7692 section 7.2.2)
+static const uint8_t sync_tail[4] = {0x00, 0x00, 0xFF, 0xFF};
+
+// =============================================================================
+// PRIVATE TYPES
+// =============================================================================
+
+typedef struct
+{
+    uint8_t *out;
+    size_t size;
+    size_t len;
+    uint32_t bits;
+    uint8_t count;
+    bool overflow;
+} bit_writer_t;
+
+typedef struct
+{
+    const uint8_t *in;
+    size_t len;
+    size_t pos; // Past len it walks the implied sync tail
+    uint32_t bits;
+    uint8_t count;
+    bool overrun;
+} bit_reader_t;
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static inline uint32_t hash3(const uint8_t *p);
+static void put_bits(bit_writer_t *bw, uint32_t value, uint8_t count);
+static void put_huffman(bit_writer_t *bw, uint32_t code, uint8_t length);
+static void put_literal_length(bit_writer_t *bw, uint16_t symbol);
+static void put_match(bit_writer_t *bw, size_t length, size_t distance);
+static uint32_t get_bits(bit_reader_t *br, uint8_t count);
+static bool build_code(uint16_t *counts, uint16_t *symbols, const uint8_t *lengths, size_t n);
+static int decode_symbol(bit_reader_t *br, const uint16_t *counts, const uint16_t *symbols);
+static bool read_dynamic_codes(deflate_decompressor_t *d, bit_reader_t *br);
+static bool inflate_block(deflate_decompressor_t *d, bit_reader_t *br, uint8_t *out, size_t out_size, size_t *pos);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+size_t deflate_compress(deflate_compressor_t *c, const uint8_t *data, size_t start, size_t end, uint8_t *out,
+                        size_t out_size)
+{
+    if (c == NULL || data == NULL || out == NULL || start > end || end > DEFLATE_MAX_INPUT)
+    {
+        return 0;
+    }
+
+    bit_writer_t bw = {out, out_size, 0, 0, 0, false};
+    memset(c->head, 0, sizeof(c->head));
+
+    // Index the dictionary so the message can refer back into it
+    size_t pos = start > DEFLATE_WINDOW_SIZE ? start - DEFLATE_WINDOW_SIZE : 0;
+    for (; pos < start && pos + DEFLATE_MIN_MATCH <= end; pos++)
+    {
+        c->head[hash3(data + pos)] = (uint16_t)(pos + 1);
+    }
+
+    put_bits(&bw, BLOCK_FIXED << 1, 3); // BFINAL = 0: the message ends with a sync flush
+
+    pos = start;
+    while (pos < end && !bw.overflow)
+    {
+        size_t best_len = 0;
+        size_t best_dist = 0;
+
+        if (end - pos >= DEFLATE_MIN_MATCH)
+        {
+            uint32_t h = hash3(data + pos);
+            size_t candidate = c->head[h];
+            c->head[h] = (uint16_t)(pos + 1);
+
+            if (candidate != 0 && pos - (candidate - 1) <= DEFLATE_WINDOW_SIZE)
+            {
+                // Overlapping matches are fine: the decoder copies byte by byte
+                const uint8_t *a = data + candidate - 1;
+                const uint8_t *b = data + pos;
+                size_t max = end - pos < DEFLATE_MAX_MATCH ? end - pos : DEFLATE_MAX_MATCH;
+                size_t n = 0;
+                while (n < max && a[n] == b[n])
+                {
+                    n++;
+                }
+                if (n >= DEFLATE_MIN_MATCH)
+                {
+                    best_len = n;
+                    best_dist = pos - (candidate - 1);
+                }
+            }
+        }
+
+        if (best_len == 0)
+        {
+            put_literal_length(&bw, data[pos]);
+            pos++;
+            continue;
+        }
+
+        put_match(&bw, best_len, best_dist);
+        for (size_t i = 1; i < best_len && pos + i + DEFLATE_MIN_MATCH <= end; i++)
+        {
+            c->head[hash3(data + pos + i)] = (uint16_t)(pos + i + 1);
+        }
+        pos += best_len;
+    }
+
+    put_literal_length(&bw, DEFLATE_END_OF_BLOCK);
+    put_bits(&bw, BLOCK_STORED << 1, 3); // Empty stored block: header only, LEN/NLEN are the stripped tail
+    put_bits(&bw, 0, (uint8_t)((8 - bw.count) & 7));
+
+    return bw.overflow ? 0 : bw.len;
+}
+
+bool deflate_decompress(deflate_decompressor_t *d, const uint8_t *in, size_t len, uint8_t *out, size_t out_size,
+                        size_t *out_len)
+{
+    if (d == NULL || (in == NULL && len > 0) || out == NULL || out_len == NULL)
+    {
+        return false;
+    }
+
+    bit_reader_t br = {in, len, 0, 0, 0, false};
+    size_t pos = 0;
+    bool final = false;
+
+    while (!final)
+    {
+        final = get_bits(&br, 1) != 0;
+        uint32_t type = get_bits(&br, 2);
+
+        if (type == BLOCK_STORED)
+        {
+            // Byte aligned: drop the rest of the current byte
+            br.bits = 0;
+            br.count = 0;
+            uint32_t stored_len = get_bits(&br, 16);
+            if ((get_bits(&br, 16) ^ 0xFFFF) != stored_len || stored_len > out_size - pos)
+            {
+                return false;
+            }
+            for (uint32_t i = 0; i < stored_len; i++)
+            {
+                out[pos++] = (uint8_t)get_bits(&br, 8);
+            }
+        }
+        else if (type == BLOCK_FIXED || type == BLOCK_DYNAMIC)
+        {
+            if (type == BLOCK_FIXED)
+            {
+                memset(d->lengths, 8, 144);
+                memset(d->lengths + 144, 9, 112);
+                memset(d->lengths + 256, 7, 24);
+                memset(d->lengths + 280, 8, 8);
+                memset(d->lengths + 288, 5, 32);
+                build_code(d->lit_count, d->lit_symbol, d->lengths, 288);
+                build_code(d->dist_count, d->dist_symbol, d->lengths + 288, 32);
+            }
+            else if (!read_dynamic_codes(d, &br))
+            {
+                return false;
+            }
+
+            if (!inflate_block(d, &br, out, out_size, &pos))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+
+        if (br.overrun)
+        {
+            return false;
+        }
+
+        // The sync tail is an empty stored block; once it is used up the message is complete
+        if (!final && br.pos == br.len + sizeof(sync_tail))
+        {
+            if (type != BLOCK_STORED)
+            {
+                return false;
+            }
+            break;
+        }
+    }
+
+    *out_len = pos;
+    return true;
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static inline uint32_t hash3(const uint8_t *p)
+{
+    uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (v * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+}
+
+static void put_bits(bit_writer_t *bw, uint32_t value, uint8_t count)
+{
+    // DEFLATE packs bits from the least significant end
+    bw->bits |= value << bw->count;
+    bw->count += count;
+    while (bw->count >= 8)
+    {
+        if (bw->len < bw->size)
+        {
+            bw->out[bw->len++] = (uint8_t)bw->bits;
+        }
+        else
+        {
+            bw->overflow = true;
+        }
+        bw->bits >>= 8;
+        bw->count -= 8;
+    }
+}
+
+static void put_huffman(bit_writer_t *bw, uint32_t code, uint8_t length)
+{
+    // Huffman codes are sent most significant bit first
+    uint32_t reversed = 0;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    put_bits(bw, reversed, length);
+}
+
+static void put_literal_length(bit_writer_t *bw, uint16_t symbol)
+{
+    // Fixed code (RFC 1951 section 3.2.6)
+    if (symbol < 144)
+    {
+        put_huffman(bw, 0x30 + symbol, 8);
+    }
+    else if (symbol < 256)
+    {
+        put_huffman(bw, 0x190 + symbol - 144, 9);
+    }
+    else if (symbol < 280)
+    {
+        put_huffman(bw, symbol - 256, 7);
+    }
+    else
+    {
+        put_huffman(bw, 0xC0 + symbol - 280, 8);
+    }
+}
+
+static void put_match(bit_writer_t *bw, size_t length, size_t distance)
+{
+    int code = 28;
+    while (length_base[code] > length)
+    {
+        code--;
+    }
+    put_literal_length(bw, (uint16_t)(257 + code));
+    put_bits(bw, (uint32_t)(length - length_base[code]), length_extra[code]);
+
+    code = 29;
+    while (dist_base[code] > distance)
+    {
+        code--;
+    }
+    put_huffman(bw, (uint32_t)code, 5);
+    put_bits(bw, (uint32_t)(distance - dist_base[code]), dist_extra[code]);
+}
+
+static uint32_t get_bits(bit_reader_t *br, uint8_t count)
+{
+    while (br->count < count)
+    {
+        uint8_t byte = 0;
+        if (br->pos < br->len)
+        {
+            byte = br->in[br->pos];
+        }
+        else if (br->pos < br->len + sizeof(sync_tail))
+        {
+            byte = sync_tail[br->pos - br->len];
+        }
+        else
+        {
+            br->overrun = true; // Reads as zeros; callers check overrun before trusting the result
+        }
+        br->pos += br->overrun ? 0 : 1;
+        br->bits |= (uint32_t)byte << br->count;
+        br->count += 8;
+    }
+
+    uint32_t value = br->bits & ((1u << count) - 1);
+    br->bits >>= count;
+    br->count -= count;
+    return value;
+}
+
+static bool build_code(uint16_t *counts, uint16_t *symbols, const uint8_t *lengths, size_t n)
+{
+    // Canonical Huffman: codes of each length are consecutive, in symbol order
+    uint16_t offsets[16];
+
+    memset(counts, 0, 16 * sizeof(counts[0]));
+    for (size_t i = 0; i < n; i++)
+    {
+        counts[lengths[i]]++;
+    }
+    counts[0] = 0;
+
+    int left = 1;
+    for (int len = 1; len < 16; len++)
+    {
+        left = (left << 1) - counts[len];
+        if (left < 0)
+        {
+            return false; // Over-subscribed; incomplete codes are allowed
+        }
+    }
+
+    offsets[1] = 0;
+    for (int len = 1; len < 15; len++)
+    {
+        offsets[len + 1] = (uint16_t)(offsets[len] + counts[len]);
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        if (lengths[i] != 0)
+        {
+            symbols[offsets[lengths[i]]++] = (uint16_t)i;
+        }
+    }
+    return true;
+}
+
+static int decode_symbol(bit_reader_t *br, const uint16_t *counts, const uint16_t *symbols)
+{
+    int code = 0;
+    int first = 0;
+    int index = 0;
+
+    for (int len = 1; len < 16; len++)
+    {
+        code |= (int)get_bits(br, 1);
+        int count = counts[len];
+        if (code - first < count)
+        {
+            return symbols[index + code - first];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static bool read_dynamic_codes(deflate_decompressor_t *d, bit_reader_t *br)
+{
+    size_t lit_codes = get_bits(br, 5) + 257;
+    size_t dist_codes = get_bits(br, 5) + 1;
+    size_t length_codes = get_bits(br, 4) + 4;
+
+    // The code length code is decoded with the literal tables as scratch
+    memset(d->lengths, 0, 19);
+    for (size_t i = 0; i < length_codes; i++)
+    {
+        d->lengths[code_length_order[i]] = (uint8_t)get_bits(br, 3);
+    }
+    if (!build_code(d->lit_count, d->lit_symbol, d->lengths, 19))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < lit_codes + dist_codes;)
+    {
+        int symbol = decode_symbol(br, d->lit_count, d->lit_symbol);
+        if (symbol < 0 || br->overrun)
+        {
+            return false;
+        }
+        if (symbol < 16)
+        {
+            d->lengths[i++] = (uint8_t)symbol;
+            continue;
+        }
+
+        uint8_t value = 0;
+        size_t repeat;
+        if (symbol == 16)
+        {
+            if (i == 0)
+            {
+                return false;
+            }
+            value = d->lengths[i - 1];
+            repeat = 3 + get_bits(br, 2);
+        }
+        else if (symbol == 17)
+        {
+            repeat = 3 + get_bits(br, 3);
+        }
+        else
+        {
+            repeat = 11 + get_bits(br, 7);
+        }
+
+        if (repeat > lit_codes + dist_codes - i)
+        {
+            return false;
+        }
+        memset(d->lengths + i, value, repeat);
+        i += repeat;
+    }
+
+    if (d->lengths[DEFLATE_END_OF_BLOCK] == 0)
+    {
+        return false; // A block that can never end
+    }
+
+    // Distance lengths follow the literal ones directly; move them to their own area
+    memmove(d->lengths + 288, d->lengths + lit_codes, dist_codes);
+    return build_code(d->lit_count, d->lit_symbol, d->lengths, lit_codes) &&
+           build_code(d->dist_count, d->dist_symbol, d->lengths + 288, dist_codes);
+}
+
+static bool inflate_block(deflate_decompressor_t *d, bit_reader_t *br, uint8_t *out, size_t out_size, size_t *pos)
+{
+    for (;;)
+    {
+        int symbol = decode_symbol(br, d->lit_count, d->lit_symbol);
+        if (symbol < 0 || br->overrun)
+        {
+            return false;
+        }
+
+        if (symbol < 256)
+        {
+            if (*pos >= out_size)
+            {
+                return false;
+            }
+            out[(*pos)++] = (uint8_t)symbol;
+            continue;
+        }
+        if (symbol == DEFLATE_END_OF_BLOCK)
+        {
+            return true;
+        }
+
+        symbol -= 257;
+        if (symbol >= 29)
+        {
+            return false;
+        }
+        size_t length = length_base[symbol] + get_bits(br, length_extra[symbol]);
+
+        int dist_symbol = decode_symbol(br, d->dist_count, d->dist_symbol);
+        if (dist_symbol < 0 || dist_symbol >= 30)
+        {
+            return false;
+        }
+        size_t distance = dist_base[dist_symbol] + get_bits(br, dist_extra[dist_symbol]);
+
+        if (distance > *pos || length > out_size - *pos)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < length; i++, (*pos)++)
+        {
+            out[*pos] = out[*pos - distance];
+        }
+    }
+}
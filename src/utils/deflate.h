@@ -0,0 +1,108 @@
+/**
+ * @file deflate.h
+ * @brief Small-window raw DEFLATE (RFC 1951) for WebSocket permessage-deflate
+ *
+ * The compressor is sized for the RP2040 rather than for ratio: a greedy
+ * LZ77 match finder with one candidate per hash bucket, a 1 KiB window and
+ * the fixed Huffman code, so there are no trees to build or send. Its
+ * dictionary is supplied by the caller, which is how a WebSocket server
+ * keeps per-client context between messages without per-client match
+ * state. The repetitive JSON of logs and status frames compresses well
+ * even so; most of the gain is whole keys and log prefixes matched against
+ * earlier messages.
+ *
+ * The decompressor accepts any valid stream (stored, fixed and dynamic
+ * blocks) but keeps no window of its own: back-references must stay
+ * inside the output buffer, which is what a peer told to use
+ * client_no_context_takeover produces.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef DEFLATE_H
+#define DEFLATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#define DEFLATE_WINDOW_BITS 10
+#define DEFLATE_WINDOW_SIZE (1u << DEFLATE_WINDOW_BITS) // Farthest back-reference the compressor emits
+#define DEFLATE_HASH_BITS 9
+#define DEFLATE_MAX_INPUT 0xFFFE // Dictionary plus message, so positions fit 16 bits
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Compressor scratch state (1 KiB); contents do not persist between calls
+     */
+    typedef struct
+    {
+        uint16_t head[1u << DEFLATE_HASH_BITS]; // Latest position + 1 per hash, 0 if none
+    } deflate_compressor_t;
+
+    /**
+     * @brief Decompressor scratch state (Huffman tables); contents do not persist between calls
+     */
+    typedef struct
+    {
+        uint16_t lit_count[16];
+        uint16_t lit_symbol[288];
+        uint16_t dist_count[16];
+        uint16_t dist_symbol[32];
+        uint8_t lengths[288 + 32];
+    } deflate_decompressor_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Compress one message into a sync-flushed block
+     *
+     * data[0, start) is the dictionary: the last bytes the receiver
+     * decompressed, which matches may refer back into. data[start, end) is
+     * compressed. The output ends with an empty stored block whose
+     * 00 00 FF FF tail is left off, i.e. it is a complete permessage-deflate
+     * payload (RFC 7692 section 7.2.1).
+     * @param c Scratch state
+     * @param data Dictionary followed by the message
+     * @param start Dictionary length; only the last DEFLATE_WINDOW_SIZE bytes are used
+     * @param end Dictionary plus message length, at most DEFLATE_MAX_INPUT
+     * @param out Output buffer
+     * @param out_size Output buffer size
+     * @return Compressed length, 0 if it does not fit in out_size
+     */
+    size_t deflate_compress(deflate_compressor_t *c, const uint8_t *data, size_t start, size_t end, uint8_t *out,
+                            size_t out_size);
+
+    /**
+     * @brief Decompress one permessage-deflate payload
+     * @param d Scratch state
+     * @param in Payload; the trailing 00 00 FF FF removed by the sender is implied
+     * @param len Payload length
+     * @param out Output buffer
+     * @param out_size Output buffer size
+     * @param out_len Receives the decompressed length
+     * @return false if the data is malformed, refers outside the output or does not fit
+     */
+    bool deflate_decompress(deflate_decompressor_t *d, const uint8_t *in, size_t len, uint8_t *out, size_t out_size,
+                            size_t *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DEFLATE_H
@@ -0,0 +1,472 @@
+/**
+ * @file display_list.cpp
+ * @brief Band-rendered display list implementation
+ */
+
+#include "display_list.h"
+
+#include <string.h>
+
+// =============================================================================
+// PRIVATE TYPES
+// =============================================================================
+
+/**
+ * @brief Screen area (x1/y1 exclusive)
+ */
+typedef struct
+{
+    int x0, y0, x1, y1;
+} area_t;
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+/**
+ * @brief Part of a command's area on screen
+ * @return false if none of it is
+ */
+static bool visible_area(const display_list_t *dl, int x, int y, int width, int height, area_t *area)
+{
+    area->x0 = x < 0 ? 0 : x;
+    area->y0 = y < 0 ? 0 : y;
+    area->x1 = x + width > dl->width ? dl->width : x + width;
+    area->y1 = y + height > dl->height ? dl->height : y + height;
+    return area->x0 < area->x1 && area->y0 < area->y1;
+}
+
+static bool command_area(const display_list_t *dl, const display_command_t *cmd, area_t *area)
+{
+    return visible_area(dl, cmd->x, cmd->y, cmd->width, cmd->height, area);
+}
+
+static bool contains(const area_t *outer, const area_t *inner)
+{
+    return inner->x0 >= outer->x0 && inner->y0 >= outer->y0 && inner->x1 <= outer->x1 && inner->y1 <= outer->y1;
+}
+
+static bool overlaps(const area_t *a, const area_t *b)
+{
+    return a->x0 < b->x1 && b->x0 < a->x1 && a->y0 < b->y1 && b->y0 < a->y1;
+}
+
+/**
+ * @brief Whether two areas side by side make up one rectangle
+ * @param joined Receives that rectangle
+ */
+static bool join(const area_t *a, const area_t *b, area_t *joined)
+{
+    bool across = a->y0 == b->y0 && a->y1 == b->y1 && (a->x1 == b->x0 || b->x1 == a->x0);
+    bool down = a->x0 == b->x0 && a->x1 == b->x1 && (a->y1 == b->y0 || b->y1 == a->y0);
+    joined->x0 = a->x0 < b->x0 ? a->x0 : b->x0;
+    joined->y0 = a->y0 < b->y0 ? a->y0 : b->y0;
+    joined->x1 = a->x1 > b->x1 ? a->x1 : b->x1;
+    joined->y1 = a->y1 > b->y1 ? a->y1 : b->y1;
+    return across || down;
+}
+
+/**
+ * @brief Mark the tiles an area touches (already clipped)
+ */
+static void mark_dirty(display_list_t *dl, const area_t *area)
+{
+    uint16_t tiles = 0;
+    for (int t = area->x0 / DISPLAY_LIST_TILE_WIDTH; t * DISPLAY_LIST_TILE_WIDTH < area->x1; t++)
+    {
+        tiles |= (uint16_t)(1u << t);
+    }
+    for (int b = area->y0 / dl->band_height; b * dl->band_height < area->y1; b++)
+    {
+        dl->dirty[b] |= tiles;
+    }
+}
+
+static bool same_command(const display_list_t *dl, const display_command_t *a, const display_command_t *b,
+                         const char *text, size_t text_len)
+{
+    if (a->type != b->type || a->x != b->x || a->y != b->y || a->width != b->width || a->height != b->height ||
+        a->color != b->color)
+    {
+        return false;
+    }
+    if (a->type == DISPLAY_COMMAND_TEXT)
+    {
+        const char *stored = &dl->text[a->text];
+        return a->bg == b->bg && strncmp(stored, text, text_len) == 0 && stored[text_len] == '\0';
+    }
+    // Blit pixels may have changed behind the same pointer
+    return a->type == DISPLAY_COMMAND_FILL;
+}
+
+/**
+ * @brief Write text into the cells of an older text command it lies within
+ *
+ * Same row, colours and character grid: the characters replace the older
+ * command's in the text store instead of stacking a command on top of it.
+ */
+static bool patch_text(display_list_t *dl, const display_command_t *older, const display_command_t *cmd,
+                       const char *text, size_t text_len)
+{
+    if (older->type != DISPLAY_COMMAND_TEXT || cmd->type != DISPLAY_COMMAND_TEXT || older->y != cmd->y ||
+        older->color != cmd->color || older->bg != cmd->bg)
+    {
+        return false;
+    }
+    int offset = cmd->x - older->x;
+    if (offset < 0 || offset % FRAMEBUFFER_GLYPH_WIDTH != 0 || offset + cmd->width > older->width)
+    {
+        return false;
+    }
+    memcpy(&dl->text[older->text + offset / FRAMEBUFFER_GLYPH_WIDTH], text, text_len);
+    return true;
+}
+
+/**
+ * @brief Close the gaps texts of removed commands left in the text store
+ */
+static void compact_text(display_list_t *dl)
+{
+    // Text is appended in command order, so moving each string down never overwrites a live one
+    uint16_t used = 0;
+    for (uint16_t i = 0; i < dl->command_count; i++)
+    {
+        display_command_t *cmd = &dl->commands[i];
+        if (cmd->type != DISPLAY_COMMAND_TEXT)
+        {
+            continue;
+        }
+        size_t len = strlen(&dl->text[cmd->text]) + 1;
+        memmove(&dl->text[used], &dl->text[cmd->text], len);
+        cmd->text = used;
+        used += (uint16_t)len;
+    }
+    dl->text_used = used;
+}
+
+/**
+ * @brief Put a command on screen
+ * @param text TEXT: the characters to store (not terminated), else NULL
+ * @param text_len Characters in text
+ */
+static bool add_command(display_list_t *dl, display_command_t *cmd, const char *text, size_t text_len)
+{
+    area_t area;
+    if (!command_area(dl, cmd, &area))
+    {
+        return true;
+    }
+
+    // Already showing with nothing drawn over it since: no change. Characters changed within a string on top:
+    // the string is edited in place
+    for (int i = dl->command_count - 1; i >= 0; i--)
+    {
+        const display_command_t *older = &dl->commands[i];
+        if (same_command(dl, older, cmd, text, text_len))
+        {
+            return true;
+        }
+        area_t older_area;
+        if (command_area(dl, older, &older_area) && overlaps(&older_area, &area))
+        {
+            if (patch_text(dl, older, cmd, text, text_len))
+            {
+                mark_dirty(dl, &area);
+                return true;
+            }
+            break;
+        }
+    }
+
+    // Drop what the new command hides completely, keeping painter's order. With the previous command it may
+    // cover a larger rectangle (the filled and empty parts of a bar), hiding what lies inside the two
+    area_t previous, cover;
+    bool pair = dl->command_count > 0 && command_area(dl, &dl->commands[dl->command_count - 1], &previous) &&
+                join(&previous, &area, &cover);
+    uint16_t kept = 0;
+    for (uint16_t i = 0; i < dl->command_count; i++)
+    {
+        area_t older_area;
+        if (command_area(dl, &dl->commands[i], &older_area) &&
+            (contains(&area, &older_area) || (pair && i + 1 < dl->command_count && contains(&cover, &older_area))))
+        {
+            continue;
+        }
+        dl->commands[kept++] = dl->commands[i];
+    }
+    dl->command_count = kept;
+
+    if (text != NULL && dl->text_used + text_len + 1 > DISPLAY_LIST_TEXT_SIZE)
+    {
+        compact_text(dl);
+    }
+    if (dl->command_count == DISPLAY_LIST_MAX_COMMANDS ||
+        (text != NULL && dl->text_used + text_len + 1 > DISPLAY_LIST_TEXT_SIZE))
+    {
+        dl->dropped++;
+        return false;
+    }
+
+    if (text != NULL)
+    {
+        cmd->text = dl->text_used;
+        memcpy(&dl->text[dl->text_used], text, text_len);
+        dl->text[dl->text_used + text_len] = '\0';
+        dl->text_used += (uint16_t)(text_len + 1);
+    }
+    dl->commands[dl->command_count++] = *cmd;
+    mark_dirty(dl, &area);
+    return true;
+}
+
+/**
+ * @brief Draw one command into a band, translated so the band's top-left is (x0, y0)
+ */
+static void rasterize(const display_list_t *dl, const display_command_t *cmd, framebuffer_t *fb, int x0, int y0)
+{
+    switch (cmd->type)
+    {
+    case DISPLAY_COMMAND_FILL:
+        framebuffer_fill_rect(fb, cmd->x - x0, cmd->y - y0, cmd->width, cmd->height, cmd->color);
+        break;
+    case DISPLAY_COMMAND_TEXT:
+        framebuffer_draw_text(fb, cmd->x - x0, cmd->y - y0, &dl->text[cmd->text], cmd->color, cmd->bg);
+        break;
+    case DISPLAY_COMMAND_BLIT:
+        framebuffer_blit(fb, cmd->x - x0, cmd->y - y0, cmd->width, cmd->height, cmd->data);
+        break;
+    default:
+        break;
+    }
+}
+
+static uint32_t hash_tile(const uint16_t *pixels, uint16_t stride, int width, int height)
+{
+    // FNV-1a over the tile's pixels
+    uint32_t h = 2166136261u;
+    for (int row = 0; row < height; row++)
+    {
+        for (int col = 0; col < width; col++)
+        {
+            h = (h ^ pixels[(size_t)row * stride + col]) * 16777619u;
+        }
+    }
+    return h;
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+bool display_list_init(display_list_t *dl, uint16_t width, uint16_t height, uint16_t band_height)
+{
+    memset(dl, 0, sizeof(*dl));
+    if (band_height == 0 || width > DISPLAY_LIST_MAX_TILES * DISPLAY_LIST_TILE_WIDTH ||
+        (height + band_height - 1) / band_height > DISPLAY_LIST_MAX_BANDS)
+    {
+        return false;
+    }
+
+    dl->width = width;
+    dl->height = height;
+    dl->band_height = band_height;
+    dl->band_count = (uint16_t)((height + band_height - 1) / band_height);
+    display_list_invalidate(dl, 0, 0, width, height);
+    return true;
+}
+
+bool display_list_fill_rect(display_list_t *dl, int x, int y, int width, int height, uint16_t color)
+{
+    // Fills are stored clipped: the same pixels either way
+    area_t area;
+    if (!visible_area(dl, x, y, width, height, &area))
+    {
+        return true;
+    }
+
+    display_command_t cmd = {};
+    cmd.type = DISPLAY_COMMAND_FILL;
+    cmd.x = (int16_t)area.x0;
+    cmd.y = (int16_t)area.y0;
+    cmd.width = (uint16_t)(area.x1 - area.x0);
+    cmd.height = (uint16_t)(area.y1 - area.y0);
+    cmd.color = color;
+    return add_command(dl, &cmd, NULL, 0);
+}
+
+bool display_list_draw_rect(display_list_t *dl, int x, int y, int width, int height, uint16_t color)
+{
+    if (width <= 0 || height <= 0)
+    {
+        return true;
+    }
+
+    // Edges as separate fills, so the outline does not hide what is inside it
+    bool ok = display_list_fill_rect(dl, x, y, width, 1, color);
+    ok = display_list_fill_rect(dl, x, y + height - 1, width, 1, color) && ok;
+    ok = display_list_fill_rect(dl, x, y + 1, 1, height - 2, color) && ok;
+    ok = display_list_fill_rect(dl, x + width - 1, y + 1, 1, height - 2, color) && ok;
+    return ok;
+}
+
+bool display_list_set_pixel(display_list_t *dl, int x, int y, uint16_t color)
+{
+    return display_list_fill_rect(dl, x, y, 1, 1, color);
+}
+
+bool display_list_draw_text(display_list_t *dl, int x, int y, const char *text, uint16_t fg, uint16_t bg)
+{
+    // Keep only the characters that reach the screen
+    while (*text && x + FRAMEBUFFER_GLYPH_WIDTH <= 0)
+    {
+        text++;
+        x += FRAMEBUFFER_GLYPH_WIDTH;
+    }
+    size_t len = strlen(text);
+    if (x >= dl->width || len == 0)
+    {
+        return true;
+    }
+    size_t fits = (size_t)(dl->width - x + FRAMEBUFFER_GLYPH_WIDTH - 1) / FRAMEBUFFER_GLYPH_WIDTH;
+    len = len < fits ? len : fits;
+
+    display_command_t cmd = {};
+    cmd.type = DISPLAY_COMMAND_TEXT;
+    cmd.x = (int16_t)x;
+    cmd.y = (int16_t)y;
+    cmd.width = (uint16_t)(len * FRAMEBUFFER_GLYPH_WIDTH);
+    cmd.height = FRAMEBUFFER_GLYPH_HEIGHT;
+    cmd.color = fg;
+    cmd.bg = bg;
+    return add_command(dl, &cmd, text, len);
+}
+
+bool display_list_blit(display_list_t *dl, int x, int y, int width, int height, const uint8_t *data)
+{
+    if (data == NULL || width <= 0 || height <= 0)
+    {
+        return true;
+    }
+
+    display_command_t cmd = {};
+    cmd.type = DISPLAY_COMMAND_BLIT;
+    cmd.x = (int16_t)x;
+    cmd.y = (int16_t)y;
+    cmd.width = (uint16_t)width;
+    cmd.height = (uint16_t)height;
+    cmd.data = data;
+    return add_command(dl, &cmd, NULL, 0);
+}
+
+void display_list_invalidate(display_list_t *dl, int x, int y, int width, int height)
+{
+    area_t area;
+    if (!visible_area(dl, x, y, width, height, &area))
+    {
+        return;
+    }
+    mark_dirty(dl, &area);
+
+    // Whatever the hashes say, the panel has to be sent these tiles again
+    for (int b = area.y0 / dl->band_height; b * dl->band_height < area.y1; b++)
+    {
+        dl->known[b] &= (uint16_t)~dl->dirty[b];
+    }
+}
+
+bool display_list_is_dirty(const display_list_t *dl)
+{
+    for (uint16_t b = 0; b < dl->band_count; b++)
+    {
+        if (dl->dirty[b])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t display_list_flush(display_list_t *dl, uint16_t *bands, uint8_t buffers, framebuffer_push_t push,
+                          void *context)
+{
+    size_t pixels = 0;
+    buffers = buffers ? buffers : 1;
+
+    for (uint16_t b = 0; b < dl->band_count; b++)
+    {
+        uint16_t dirty = dl->dirty[b];
+        if (dirty == 0)
+        {
+            continue;
+        }
+        dl->dirty[b] = 0;
+
+        // Rasterize the columns from the first to the last tile drawn over
+        int first = 0, last = DISPLAY_LIST_MAX_TILES - 1;
+        while (!(dirty & (1u << first)))
+        {
+            first++;
+        }
+        while (!(dirty & (1u << last)))
+        {
+            last--;
+        }
+        int x0 = first * DISPLAY_LIST_TILE_WIDTH;
+        int x1 = (last + 1) * DISPLAY_LIST_TILE_WIDTH;
+        x1 = x1 > dl->width ? dl->width : x1;
+        int y0 = b * dl->band_height;
+        int rows = y0 + dl->band_height > dl->height ? dl->height - y0 : dl->band_height;
+        uint16_t stride = (uint16_t)(x1 - x0);
+
+        uint16_t *band = &bands[(size_t)(dl->next_buffer % buffers) * dl->width * dl->band_height];
+        memset(band, 0, (size_t)stride * rows * sizeof(uint16_t));
+        framebuffer_t fb;
+        framebuffer_init(&fb, band, stride, (uint16_t)rows);
+        area_t band_area = {x0, y0, x1, y0 + rows};
+        for (uint16_t i = 0; i < dl->command_count; i++)
+        {
+            area_t area;
+            if (command_area(dl, &dl->commands[i], &area) && overlaps(&area, &band_area))
+            {
+                rasterize(dl, &dl->commands[i], &fb, x0, y0);
+            }
+        }
+
+        // Only tiles that came out different from what the panel shows are sent
+        int changed_first = -1, changed_last = -1;
+        for (int t = first; t <= last; t++)
+        {
+            if (!(dirty & (1u << t)))
+            {
+                continue;
+            }
+            int tx = t * DISPLAY_LIST_TILE_WIDTH;
+            int tw = tx + DISPLAY_LIST_TILE_WIDTH > x1 ? x1 - tx : DISPLAY_LIST_TILE_WIDTH;
+            uint32_t h = hash_tile(&band[tx - x0], stride, tw, rows);
+            if ((dl->known[b] & (1u << t)) && dl->tile_hash[b][t] == h)
+            {
+                continue;
+            }
+            dl->tile_hash[b][t] = h;
+            dl->known[b] |= (uint16_t)(1u << t);
+            changed_first = changed_first < 0 ? t : changed_first;
+            changed_last = t;
+        }
+        if (changed_first < 0)
+        {
+            continue;
+        }
+
+        int px0 = changed_first * DISPLAY_LIST_TILE_WIDTH;
+        int px1 = (changed_last + 1) * DISPLAY_LIST_TILE_WIDTH;
+        px1 = px1 > x1 ? x1 : px1;
+        fb_rect_t r = {(uint16_t)px0, (uint16_t)y0, (uint16_t)(px1 - px0), (uint16_t)rows};
+        if (push)
+        {
+            push(&r, &band[px0 - x0], stride, context);
+        }
+        dl->next_buffer = (uint8_t)((dl->next_buffer + 1) % buffers);
+        pixels += (size_t)r.width * r.height;
+    }
+    return pixels;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file display_list.h
+ * @brief Display list rasterized one band at a time
+ *
+ * The band-rendering counterpart of framebuffer.h. Drawing calls are
+ * recorded as commands; display_list_flush() replays them one band of rows
+ * at a time into a buffer of width x band_height pixels and pushes each band
+ * before starting the next, so the screen costs a few KB instead of
+ * width x height x 2 bytes.
+ *
+ * The list behaves like a framebuffer that keeps its contents. Every command
+ * is opaque over its area (text paints its background), so a new command
+ * removes the earlier ones lying entirely inside it, or inside it and the
+ * command before it when the two tile a rectangle (a bar's filled and empty
+ * parts). Redrawing something already on screen with nothing over it is
+ * dropped, and text drawn over some of the cells of the string on top, in
+ * its colours, edits that string instead of adding a command, so updating
+ * part of a line leaves the list as long as it was. What remains on screen
+ * is what was drawn last; pixels no command covers are black.
+ *
+ * Bands are split into tiles of DISPLAY_LIST_TILE_WIDTH columns. Drawing
+ * marks the tiles it touches; a flush rasterizes only bands with marked
+ * tiles and compares each marked tile with a hash of what was last pushed
+ * there, so a clear-and-redraw that ends up identical sends nothing.
+ *
+ * With two or more band buffers, bands are rasterized into them in turn, so
+ * an output can still be sending one band while the next is drawn.
+ *
+ * Blits keep a pointer to the caller's pixels, which must stay valid (and
+ * unchanged, unless redrawn) while the blit is on screen.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef DISPLAY_LIST_H
+#define DISPLAY_LIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "framebuffer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#define DISPLAY_LIST_MAX_COMMANDS 128 // Commands on screen at once
+#define DISPLAY_LIST_TEXT_SIZE 1024   // Text on screen at once, one terminator per string
+#define DISPLAY_LIST_TILE_WIDTH 32    // Columns per change-tracking tile
+#define DISPLAY_LIST_MAX_TILES 10     // Tiles per band (at most 16): widths up to 320
+#define DISPLAY_LIST_MAX_BANDS 30     // Bands per screen: 240 rows in bands of 8
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    typedef enum
+    {
+        DISPLAY_COMMAND_FILL = 0,
+        DISPLAY_COMMAND_TEXT,
+        DISPLAY_COMMAND_BLIT
+    } display_command_type_t;
+
+    /**
+     * @brief One recorded drawing call
+     */
+    typedef struct
+    {
+        const uint8_t *data; // BLIT: little-endian RGB565 pixels
+        int16_t x;           // Top-left corner as drawn (may be off screen)
+        int16_t y;
+        uint16_t width; // Area covered, from x/y
+        uint16_t height;
+        uint16_t color; // FILL colour, TEXT foreground
+        uint16_t bg;    // TEXT background
+        uint16_t text;  // TEXT: offset into the text store
+        uint8_t type;   // display_command_type_t
+    } display_command_t;
+
+    /**
+     * @brief Display list state
+     */
+    typedef struct
+    {
+        uint16_t width;
+        uint16_t height;
+        uint16_t band_height;
+        uint16_t band_count;
+        uint16_t command_count;
+        uint16_t text_used;
+        display_command_t commands[DISPLAY_LIST_MAX_COMMANDS];
+        char text[DISPLAY_LIST_TEXT_SIZE];
+        uint16_t dirty[DISPLAY_LIST_MAX_BANDS]; // Tiles drawn over since the last flush, one bit each
+        uint16_t known[DISPLAY_LIST_MAX_BANDS]; // Tiles whose hash matches the panel
+        uint32_t tile_hash[DISPLAY_LIST_MAX_BANDS][DISPLAY_LIST_MAX_TILES];
+        uint32_t dropped;    // Commands that did not fit
+        uint8_t next_buffer; // Band buffer the next band is drawn into
+    } display_list_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Start with an empty (black) screen, all of it to be sent
+     * @param dl Display list
+     * @param width Screen width
+     * @param height Screen height
+     * @param band_height Rows rasterized at a time
+     * @return false if the screen needs more tiles or bands than the list has
+     */
+    bool display_list_init(display_list_t *dl, uint16_t width, uint16_t height, uint16_t band_height);
+
+    /**
+     * @brief Record a filled rectangle (see framebuffer_fill_rect())
+     * @return false if the list is full and the command was dropped
+     */
+    bool display_list_fill_rect(display_list_t *dl, int x, int y, int width, int height, uint16_t color);
+
+    /**
+     * @brief Record a one-pixel outline as four fills
+     */
+    bool display_list_draw_rect(display_list_t *dl, int x, int y, int width, int height, uint16_t color);
+
+    /**
+     * @brief Record one pixel
+     */
+    bool display_list_set_pixel(display_list_t *dl, int x, int y, uint16_t color);
+
+    /**
+     * @brief Record text (see framebuffer_draw_text()); the visible part is copied
+     */
+    bool display_list_draw_text(display_list_t *dl, int x, int y, const char *text, uint16_t fg, uint16_t bg);
+
+    /**
+     * @brief Record a blit of caller-owned pixels (see framebuffer_blit())
+     */
+    bool display_list_blit(display_list_t *dl, int x, int y, int width, int height, const uint8_t *data);
+
+    /**
+     * @brief Send an area on the next flush whatever the panel is thought to show
+     */
+    void display_list_invalidate(display_list_t *dl, int x, int y, int width, int height);
+
+    /**
+     * @brief Whether anything was drawn or invalidated since the last flush
+     */
+    bool display_list_is_dirty(const display_list_t *dl);
+
+    /**
+     * @brief Rasterize the bands drawn over and push the tiles that changed
+     *
+     * Bands are drawn into the buffers in turn, continuing across flushes,
+     * so the pixels of a push stay untouched until buffers - 1 more bands
+     * have been pushed.
+     *
+     * @param dl Display list
+     * @param bands buffers band buffers of width * band_height pixels, back to back
+     * @param buffers Number of band buffers (at least 1)
+     * @param push Called with each band's changed columns
+     * @param context Passed to push
+     * @return Pixels pushed
+     */
+    size_t display_list_flush(display_list_t *dl, uint16_t *bands, uint8_t buffers, framebuffer_push_t push,
+                              void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_LIST_H
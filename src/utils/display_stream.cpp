@@ -0,0 +1,320 @@
+/**
+ * @file display_stream.cpp
+ * @brief Display mirror wire format implementation
+ */
+
+#include "display_stream.h"
+
+#include <string.h>
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static inline void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * @brief RLE-encode count consecutive pixels
+ * @return Bytes written, at most DISPLAY_STREAM_RLE_MAX(count)
+ */
+static size_t rle_encode(const uint16_t *pixels, size_t count, uint8_t *out)
+{
+    uint8_t *p = out;
+    size_t i = 0;
+    while (i < count)
+    {
+        size_t run = 1;
+        while (i + run < count && run < 128 && pixels[i + run] == pixels[i])
+        {
+            run++;
+        }
+        if (run >= 2)
+        {
+            // Two equal pixels already cost less as a repeat
+            *p++ = (uint8_t)(0x80 | (run - 1));
+            put_u16(p, pixels[i]);
+            p += 2;
+            i += run;
+            continue;
+        }
+
+        // Literals up to the next pair of equal pixels
+        size_t end = i + 1;
+        while (end < count && end - i < 128 && !(end + 1 < count && pixels[end] == pixels[end + 1]))
+        {
+            end++;
+        }
+        *p++ = (uint8_t)(end - i - 1);
+        for (; i < end; i++)
+        {
+            put_u16(p, pixels[i]);
+            p += 2;
+        }
+    }
+    return (size_t)(p - out);
+}
+
+/**
+ * @brief Decode count pixels into rows of width pixels starting at dest
+ * @return Bytes consumed, 0 if the data ran out or a run overflowed
+ */
+static size_t rle_decode(const uint8_t *data, size_t len, size_t count, uint16_t *dest, size_t width,
+                         size_t dest_stride)
+{
+    size_t pos = 0;
+    size_t k = 0;
+    while (k < count)
+    {
+        if (pos >= len)
+        {
+            return 0;
+        }
+        uint8_t c = data[pos++];
+        size_t run = (size_t)(c & 0x7F) + 1;
+        bool repeat = (c & 0x80) != 0;
+        if (k + run > count || pos + (repeat ? 2 : run * 2) > len)
+        {
+            return 0;
+        }
+        for (size_t n = 0; n < run; n++, k++)
+        {
+            dest[(k / width) * dest_stride + k % width] = get_u16(&data[pos]);
+            pos += repeat ? 0 : 2;
+        }
+        pos += repeat ? 2 : 0;
+    }
+    return pos;
+}
+
+static void open_message(display_stream_writer_t *w)
+{
+    if (w->len == 0)
+    {
+        put_u16(w->buffer, DISPLAY_STREAM_MAGIC);
+        w->buffer[2] = DISPLAY_STREAM_VERSION;
+        w->buffer[3] = 0; // Flags
+        w->len = DISPLAY_STREAM_HEADER_SIZE;
+    }
+}
+
+/**
+ * @brief Make room for a record of up to need bytes, sending the message if it is too full
+ */
+static void reserve(display_stream_writer_t *w, size_t need)
+{
+    if (w->len + need > w->size)
+    {
+        display_stream_flush(w);
+    }
+    open_message(w);
+}
+
+/**
+ * @brief An area no wider than max_width, split between rows across messages
+ */
+static void write_rect(display_stream_writer_t *w, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                       const uint16_t *pixels, uint16_t stride)
+{
+    uint16_t row = 0;
+    while (row < height)
+    {
+        reserve(w, DISPLAY_STREAM_RECT_SIZE + DISPLAY_STREAM_RLE_MAX(width));
+        uint8_t *record = &w->buffer[w->len];
+        record[0] = DISPLAY_STREAM_OP_RECT;
+        put_u16(&record[1], x);
+        put_u16(&record[3], (uint16_t)(y + row));
+        put_u16(&record[5], width);
+        w->len += DISPLAY_STREAM_RECT_SIZE;
+
+        uint16_t rows = 0;
+        while (row < height && (rows == 0 || w->len + DISPLAY_STREAM_RLE_MAX(width) <= w->size))
+        {
+            w->len += rle_encode(&pixels[(size_t)row * stride], width, &w->buffer[w->len]);
+            row++;
+            rows++;
+        }
+        put_u16(&record[7], rows);
+    }
+    w->pixels += (size_t)width * height;
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+bool display_stream_writer_init(display_stream_writer_t *w, uint8_t *buffer, size_t size, uint16_t max_width,
+                                display_stream_send_t send, void *context)
+{
+    memset(w, 0, sizeof(*w));
+    if (buffer == NULL || max_width == 0 ||
+        size < DISPLAY_STREAM_HEADER_SIZE + DISPLAY_STREAM_RECT_SIZE + DISPLAY_STREAM_RLE_MAX(max_width))
+    {
+        return false;
+    }
+    w->buffer = buffer;
+    w->size = size;
+    w->max_width = max_width;
+    w->send = send;
+    w->context = context;
+    return true;
+}
+
+void display_stream_size(display_stream_writer_t *w, uint16_t width, uint16_t height)
+{
+    if (w->buffer == NULL)
+    {
+        return;
+    }
+    reserve(w, 5);
+    uint8_t *record = &w->buffer[w->len];
+    record[0] = DISPLAY_STREAM_OP_SIZE;
+    put_u16(&record[1], width);
+    put_u16(&record[3], height);
+    w->len += 5;
+}
+
+void display_stream_rect(display_stream_writer_t *w, const fb_rect_t *rect, const uint16_t *pixels, uint16_t stride)
+{
+    if (w->buffer == NULL || rect->width == 0 || rect->height == 0)
+    {
+        return;
+    }
+    for (uint16_t x = 0; x < rect->width; x += w->max_width)
+    {
+        uint16_t width = rect->width - x < w->max_width ? (uint16_t)(rect->width - x) : w->max_width;
+        write_rect(w, (uint16_t)(rect->x + x), rect->y, width, rect->height, &pixels[x], stride);
+    }
+}
+
+void display_stream_scroll(display_stream_writer_t *w, uint16_t x, uint16_t width, const uint16_t *column,
+                           uint16_t height)
+{
+    if (w->buffer == NULL)
+    {
+        return;
+    }
+    if (height > w->max_width)
+    {
+        w->failed = true; // Does not fit a message: the viewer misses a step
+        return;
+    }
+    reserve(w, DISPLAY_STREAM_SCROLL_SIZE + DISPLAY_STREAM_RLE_MAX(height));
+    uint8_t *record = &w->buffer[w->len];
+    record[0] = DISPLAY_STREAM_OP_SCROLL;
+    put_u16(&record[1], x);
+    put_u16(&record[3], width);
+    put_u16(&record[5], height);
+    w->len += DISPLAY_STREAM_SCROLL_SIZE;
+    w->len += rle_encode(column, height, &w->buffer[w->len]);
+    w->pixels += height;
+}
+
+bool display_stream_flush(display_stream_writer_t *w)
+{
+    if (w->len <= DISPLAY_STREAM_HEADER_SIZE)
+    {
+        w->len = 0;
+        return false;
+    }
+
+    bool sent = w->send == NULL || w->send(w->buffer, w->len, w->context);
+    if (sent)
+    {
+        w->messages++;
+        w->bytes += w->len;
+    }
+    else
+    {
+        w->failed = true;
+    }
+    w->len = 0;
+    return sent;
+}
+
+bool display_stream_apply(const uint8_t *message, size_t len, uint16_t *screen, uint16_t width, uint16_t height)
+{
+    if (len < DISPLAY_STREAM_HEADER_SIZE || get_u16(message) != DISPLAY_STREAM_MAGIC ||
+        message[2] != DISPLAY_STREAM_VERSION)
+    {
+        return false;
+    }
+
+    size_t pos = DISPLAY_STREAM_HEADER_SIZE;
+    while (pos < len)
+    {
+        const uint8_t *r = &message[pos];
+        size_t left = len - pos;
+        size_t used;
+        switch (r[0])
+        {
+        case DISPLAY_STREAM_OP_SIZE:
+            if (left < 5 || get_u16(&r[1]) != width || get_u16(&r[3]) != height)
+            {
+                return false;
+            }
+            memset(screen, 0, (size_t)width * height * sizeof(uint16_t));
+            pos += 5;
+            break;
+
+        case DISPLAY_STREAM_OP_RECT:
+        {
+            if (left < DISPLAY_STREAM_RECT_SIZE)
+            {
+                return false;
+            }
+            uint16_t x = get_u16(&r[1]), y = get_u16(&r[3]), w = get_u16(&r[5]), h = get_u16(&r[7]);
+            if (w == 0 || x + w > width || y + h > height)
+            {
+                return false;
+            }
+            used = rle_decode(&r[DISPLAY_STREAM_RECT_SIZE], left - DISPLAY_STREAM_RECT_SIZE, (size_t)w * h,
+                              &screen[(size_t)y * width + x], w, width);
+            if (used == 0 && h > 0)
+            {
+                return false;
+            }
+            pos += DISPLAY_STREAM_RECT_SIZE + used;
+            break;
+        }
+
+        case DISPLAY_STREAM_OP_SCROLL:
+        {
+            if (left < DISPLAY_STREAM_SCROLL_SIZE)
+            {
+                return false;
+            }
+            uint16_t x = get_u16(&r[1]), w = get_u16(&r[3]), h = get_u16(&r[5]);
+            if (w == 0 || x + w > width || h > height)
+            {
+                return false;
+            }
+            for (uint16_t row = 0; row < h; row++)
+            {
+                uint16_t *line = &screen[(size_t)row * width + x];
+                memmove(line, line + 1, (size_t)(w - 1) * sizeof(uint16_t));
+            }
+            used = rle_decode(&r[DISPLAY_STREAM_SCROLL_SIZE], left - DISPLAY_STREAM_SCROLL_SIZE, h,
+                              &screen[x + w - 1], 1, width);
+            if (used == 0 && h > 0)
+            {
+                return false;
+            }
+            pos += DISPLAY_STREAM_SCROLL_SIZE + used;
+            break;
+        }
+
+        default:
+            return false;
+        }
+    }
+    return true;
+}
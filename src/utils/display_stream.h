@@ -0,0 +1,134 @@
+/**
+ * @file display_stream.h
+ * @brief Wire format for mirroring the display to remote viewers
+ *
+ * A message is a 4-byte header followed by records, each an opcode and
+ * little-endian fields:
+ *   SIZE   width u16, height u16          - screen size; viewers clear to black
+ *   RECT   x, y, width, height u16, RLE    - pixels of an area, row by row
+ *   SCROLL x, width, height u16, RLE       - columns [x, x + width) move one left,
+ *                                             the height pixels are the new right column
+ * RLE data is a run of control bytes: c < 0x80 is followed by c + 1 literal
+ * RGB565 pixels, c >= 0x80 by one pixel repeated (c & 0x7F) + 1 times. Runs
+ * end with each row, so any row boundary is a place to split an area.
+ *
+ * The writer packs records into messages of a fixed size and hands each
+ * full one to a send callback, splitting areas between rows as needed.
+ * Shared by the firmware mirror, the host display tools and, in JavaScript,
+ * web/assets/js/display-sim.js.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef DISPLAY_STREAM_H
+#define DISPLAY_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "framebuffer.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#define DISPLAY_STREAM_MAGIC 0x4452 // "RD" on the wire
+#define DISPLAY_STREAM_VERSION 1
+#define DISPLAY_STREAM_HEADER_SIZE 4
+
+// Record opcodes
+#define DISPLAY_STREAM_OP_SIZE 0x01
+#define DISPLAY_STREAM_OP_RECT 0x02
+#define DISPLAY_STREAM_OP_SCROLL 0x03
+
+#define DISPLAY_STREAM_RECT_SIZE 9   // Opcode and fields before the pixels
+#define DISPLAY_STREAM_SCROLL_SIZE 7
+
+// Largest encoding of count pixels: all literal
+#define DISPLAY_STREAM_RLE_MAX(count) ((size_t)(count) * 2 + ((size_t)(count) + 127) / 128)
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Sends one complete message
+     * @return false if it could not be sent (the viewer is then out of step)
+     */
+    typedef bool (*display_stream_send_t)(const uint8_t *message, size_t len, void *context);
+
+    typedef struct
+    {
+        uint8_t *buffer;
+        size_t size;
+        size_t len; // Bytes of the message being packed, 0 if none is open
+        uint16_t max_width;
+        display_stream_send_t send;
+        void *context;
+        bool failed;       // A send failed since this was last cleared
+        uint32_t messages; // Messages sent
+        uint64_t bytes;    // ... and their bytes
+        uint64_t pixels;   // Pixels they carried
+    } display_stream_writer_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Start a writer
+     * @param w Writer
+     * @param buffer Message buffer; must hold a header, a record and a full row of max_width pixels
+     * @param size Buffer size: the largest message sent
+     * @param max_width Widest area or tallest scroll column written
+     * @param send Called with each full message
+     * @param context Passed to send
+     * @return false if the buffer is too small
+     */
+    bool display_stream_writer_init(display_stream_writer_t *w, uint8_t *buffer, size_t size, uint16_t max_width,
+                                    display_stream_send_t send, void *context);
+
+    void display_stream_size(display_stream_writer_t *w, uint16_t width, uint16_t height);
+
+    /**
+     * @brief Write an area's pixels (matches the framebuffer_push_t arguments)
+     * @param pixels First pixel of the area
+     * @param stride Pixels from one row to the next
+     */
+    void display_stream_rect(display_stream_writer_t *w, const fb_rect_t *rect, const uint16_t *pixels,
+                             uint16_t stride);
+
+    /**
+     * @brief Write a scroll step: columns [x, x + width) one left, column as the new right one
+     */
+    void display_stream_scroll(display_stream_writer_t *w, uint16_t x, uint16_t width, const uint16_t *column,
+                               uint16_t height);
+
+    /**
+     * @brief Send the message being packed, if any
+     * @return false if nothing was pending or the send failed
+     */
+    bool display_stream_flush(display_stream_writer_t *w);
+
+    /**
+     * @brief Apply a message to a screen image, as a viewer does
+     * @param message Message bytes
+     * @param len Message length
+     * @param screen width x height RGB565 pixels
+     * @return false if the message is malformed or does not fit the screen (applied up to the fault)
+     */
+    bool display_stream_apply(const uint8_t *message, size_t len, uint16_t *screen, uint16_t width,
+                              uint16_t height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISPLAY_STREAM_H
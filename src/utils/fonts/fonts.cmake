@@ -0,0 +1,22 @@
+# Bitmap font tables for src/utils/bitmap_font.cpp, converted from the BDF files here at build time.
+# The first font listed is the default one: its cell is the framebuffer's and display list's text cell.
+#
+#   include(<repo>/src/utils/fonts/fonts.cmake)
+#   then add ${FONT_TABLES_H} to the target's sources and ${FONT_TABLES_DIR} to its include directories
+
+find_package(Python3 REQUIRED COMPONENTS Interpreter)
+
+set(FONT_SOURCES
+    "${CMAKE_CURRENT_LIST_DIR}/font_5x7.bdf"
+)
+set(FONT_CONVERTER "${CMAKE_CURRENT_LIST_DIR}/../../../scripts/utils/convert_fonts.py")
+set(FONT_TABLES_DIR "${CMAKE_CURRENT_BINARY_DIR}/generated/fonts")
+set(FONT_TABLES_H "${FONT_TABLES_DIR}/font_tables.h")
+
+add_custom_command(
+    OUTPUT ${FONT_TABLES_H}
+    COMMAND ${Python3_EXECUTABLE} "${FONT_CONVERTER}" "${FONT_TABLES_H}" ${FONT_SOURCES}
+    DEPENDS ${FONT_SOURCES} "${FONT_CONVERTER}"
+    COMMENT "Converting bitmap fonts"
+    VERBATIM
+)
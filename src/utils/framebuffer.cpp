@@ -0,0 +1,346 @@
+/**
+ * @file framebuffer.cpp
+ * @brief RGB565 framebuffer and dirty-rectangle tracking implementation
+ */
+
+#include "framebuffer.h"
+#include "bitmap_font.h"
+
+#include <string.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+// Sending a rectangle costs a window setup on the panel; in pixels, roughly what that takes on the bus
+#define FRAMEBUFFER_RECT_COST 32
+
+#define FRAMEBUFFER_TEXT_SPAN 64 // Text is rendered this many pixels of a row at a time
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+/**
+ * @brief Clip x/y/width/height to the buffer
+ * @return false if nothing is left
+ */
+static bool clip(const framebuffer_t *fb, int *x, int *y, int *width, int *height)
+{
+    if (*x < 0)
+    {
+        *width += *x;
+        *x = 0;
+    }
+    if (*y < 0)
+    {
+        *height += *y;
+        *y = 0;
+    }
+    if (*x + *width > fb->width)
+    {
+        *width = fb->width - *x;
+    }
+    if (*y + *height > fb->height)
+    {
+        *height = fb->height - *y;
+    }
+    return *width > 0 && *height > 0;
+}
+
+static uint32_t rect_area(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+    return (x1 - x0) * (y1 - y0);
+}
+
+/**
+ * @brief Whether sending the union of two areas costs no more than sending both
+ */
+static bool worth_merging(const fb_rect_t *r, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    uint32_t ux0 = r->x < x0 ? r->x : x0;
+    uint32_t uy0 = r->y < y0 ? r->y : y0;
+    uint32_t ux1 = r->x + r->width > x1 ? r->x + r->width : x1;
+    uint32_t uy1 = r->y + r->height > y1 ? r->y + r->height : y1;
+    uint32_t separate = (uint32_t)r->width * r->height + rect_area(x0, y0, x1, y1) + FRAMEBUFFER_RECT_COST;
+    return rect_area(ux0, uy0, ux1, uy1) <= separate;
+}
+
+/**
+ * @brief Record a changed area (already clipped; x1/y1 exclusive)
+ */
+static void add_dirty(framebuffer_t *fb, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    // Absorb every rectangle it pays to send together with the new one; the union may reach further ones
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (uint8_t i = 0; i < fb->dirty_count; i++)
+        {
+            const fb_rect_t *r = &fb->dirty[i];
+            if (!worth_merging(r, x0, y0, x1, y1))
+            {
+                continue;
+            }
+            x0 = r->x < x0 ? r->x : x0;
+            y0 = r->y < y0 ? r->y : y0;
+            x1 = r->x + r->width > x1 ? r->x + r->width : x1;
+            y1 = r->y + r->height > y1 ? r->y + r->height : y1;
+            fb->dirty[i] = fb->dirty[--fb->dirty_count];
+            merged = true;
+            break;
+        }
+    }
+
+    if (fb->dirty_count == FRAMEBUFFER_MAX_DIRTY)
+    {
+        // Full: fold the new area into whichever rectangle grows the least
+        uint8_t best = 0;
+        uint32_t best_waste = UINT32_MAX;
+        for (uint8_t i = 0; i < fb->dirty_count; i++)
+        {
+            const fb_rect_t *r = &fb->dirty[i];
+            uint32_t ux0 = r->x < x0 ? r->x : x0;
+            uint32_t uy0 = r->y < y0 ? r->y : y0;
+            uint32_t ux1 = r->x + r->width > x1 ? r->x + r->width : x1;
+            uint32_t uy1 = r->y + r->height > y1 ? r->y + r->height : y1;
+            uint32_t waste = rect_area(ux0, uy0, ux1, uy1) - (uint32_t)r->width * r->height;
+            if (waste < best_waste)
+            {
+                best = i;
+                best_waste = waste;
+            }
+        }
+
+        fb_rect_t r = fb->dirty[best];
+        fb->dirty[best] = fb->dirty[--fb->dirty_count];
+        add_dirty(fb, r.x < x0 ? r.x : x0, r.y < y0 ? r.y : y0, r.x + r.width > x1 ? r.x + r.width : x1,
+                  r.y + r.height > y1 ? r.y + r.height : y1);
+        return;
+    }
+
+    fb_rect_t *r = &fb->dirty[fb->dirty_count++];
+    r->x = x0;
+    r->y = y0;
+    r->width = (uint16_t)(x1 - x0);
+    r->height = (uint16_t)(y1 - y0);
+}
+
+/**
+ * @brief Bounding box of the pixels a drawing call changed
+ */
+typedef struct
+{
+    int x0, y0, x1, y1; // x1/y1 exclusive; empty while x0 >= x1
+} change_box_t;
+
+static inline void change_box_init(change_box_t *box)
+{
+    box->x0 = box->y0 = 0x7FFF;
+    box->x1 = box->y1 = 0;
+}
+
+static inline void put(framebuffer_t *fb, change_box_t *box, int x, int y, uint16_t color)
+{
+    uint16_t *p = &fb->pixels[(size_t)y * fb->width + x];
+    if (*p == color)
+    {
+        return;
+    }
+    *p = color;
+    box->x0 = x < box->x0 ? x : box->x0;
+    box->y0 = y < box->y0 ? y : box->y0;
+    box->x1 = x + 1 > box->x1 ? x + 1 : box->x1;
+    box->y1 = y + 1 > box->y1 ? y + 1 : box->y1;
+}
+
+/**
+ * @brief Store a run of pixels in one row, recording only the part that changed
+ */
+static void put_span(framebuffer_t *fb, change_box_t *box, int x, int y, const uint16_t *span, int count)
+{
+    uint16_t *p = &fb->pixels[(size_t)y * fb->width + x];
+    int first = 0;
+    while (first < count && p[first] == span[first])
+    {
+        first++;
+    }
+    if (first == count)
+    {
+        return;
+    }
+    int last = count - 1;
+    while (p[last] == span[last])
+    {
+        last--;
+    }
+    memcpy(&p[first], &span[first], (size_t)(last - first + 1) * sizeof(uint16_t));
+
+    box->x0 = x + first < box->x0 ? x + first : box->x0;
+    box->y0 = y < box->y0 ? y : box->y0;
+    box->x1 = x + last + 1 > box->x1 ? x + last + 1 : box->x1;
+    box->y1 = y + 1 > box->y1 ? y + 1 : box->y1;
+}
+
+static inline void change_box_commit(framebuffer_t *fb, const change_box_t *box)
+{
+    if (box->x0 < box->x1)
+    {
+        add_dirty(fb, (uint16_t)box->x0, (uint16_t)box->y0, (uint16_t)box->x1, (uint16_t)box->y1);
+    }
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void framebuffer_init(framebuffer_t *fb, uint16_t *pixels, uint16_t width, uint16_t height)
+{
+    memset(fb, 0, sizeof(*fb));
+    fb->pixels = pixels;
+    fb->width = width;
+    fb->height = height;
+}
+
+uint16_t framebuffer_rgb565(uint32_t rgb888)
+{
+    return (uint16_t)(((rgb888 >> 8) & 0xF800) | ((rgb888 >> 5) & 0x07E0) | ((rgb888 >> 3) & 0x001F));
+}
+
+uint32_t framebuffer_rgb888(uint16_t rgb565)
+{
+    uint32_t r = (rgb565 >> 11) & 0x1F;
+    uint32_t g = (rgb565 >> 5) & 0x3F;
+    uint32_t b = rgb565 & 0x1F;
+    return ((r << 3 | r >> 2) << 16) | ((g << 2 | g >> 4) << 8) | (b << 3 | b >> 2);
+}
+
+void framebuffer_fill_rect(framebuffer_t *fb, int x, int y, int width, int height, uint16_t color)
+{
+    if (!clip(fb, &x, &y, &width, &height))
+    {
+        return;
+    }
+
+    change_box_t box;
+    change_box_init(&box);
+    for (int row = y; row < y + height; row++)
+    {
+        for (int col = x; col < x + width; col++)
+        {
+            put(fb, &box, col, row, color);
+        }
+    }
+    change_box_commit(fb, &box);
+}
+
+void framebuffer_draw_rect(framebuffer_t *fb, int x, int y, int width, int height, uint16_t color)
+{
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    // Edges are tracked separately so an outline does not dirty its whole interior
+    framebuffer_fill_rect(fb, x, y, width, 1, color);
+    framebuffer_fill_rect(fb, x, y + height - 1, width, 1, color);
+    framebuffer_fill_rect(fb, x, y + 1, 1, height - 2, color);
+    framebuffer_fill_rect(fb, x + width - 1, y + 1, 1, height - 2, color);
+}
+
+void framebuffer_set_pixel(framebuffer_t *fb, int x, int y, uint16_t color)
+{
+    if (x < 0 || y < 0 || x >= fb->width || y >= fb->height)
+    {
+        return;
+    }
+
+    change_box_t box;
+    change_box_init(&box);
+    put(fb, &box, x, y, color);
+    change_box_commit(fb, &box);
+}
+
+int framebuffer_draw_text(framebuffer_t *fb, int x, int y, const char *text, uint16_t fg, uint16_t bg)
+{
+    const bitmap_font_t *font = bitmap_font_default();
+    size_t length = strlen(text);
+    int width = (int)length * font->width;
+    int cx = x, cy = y, cw = width, ch = font->height;
+    if (!clip(fb, &cx, &cy, &cw, &ch))
+    {
+        return width;
+    }
+
+    bitmap_font_colors_t colors;
+    bitmap_font_colors(&colors, fg, bg);
+    change_box_t box;
+    change_box_init(&box);
+
+    uint16_t span[FRAMEBUFFER_TEXT_SPAN];
+    for (int row = cy - y; row < cy - y + ch; row++)
+    {
+        for (int done = 0; done < cw; done += FRAMEBUFFER_TEXT_SPAN)
+        {
+            int count = cw - done < FRAMEBUFFER_TEXT_SPAN ? cw - done : FRAMEBUFFER_TEXT_SPAN;
+            bitmap_font_render_row(font, &colors, text, length, row, cx - x + done, count, span);
+            put_span(fb, &box, cx + done, y + row, span, count);
+        }
+    }
+
+    change_box_commit(fb, &box);
+    return width;
+}
+
+void framebuffer_blit(framebuffer_t *fb, int x, int y, int width, int height, const uint8_t *data)
+{
+    int src_width = width;
+    int cx = x, cy = y;
+    if (data == NULL || !clip(fb, &cx, &cy, &width, &height))
+    {
+        return;
+    }
+
+    change_box_t box;
+    change_box_init(&box);
+    for (int row = 0; row < height; row++)
+    {
+        const uint8_t *src = data + ((size_t)(cy - y + row) * src_width + (cx - x)) * 2;
+        for (int col = 0; col < width; col++, src += 2)
+        {
+            put(fb, &box, cx + col, cy + row, (uint16_t)(src[0] | (src[1] << 8)));
+        }
+    }
+    change_box_commit(fb, &box);
+}
+
+void framebuffer_invalidate(framebuffer_t *fb, int x, int y, int width, int height)
+{
+    if (clip(fb, &x, &y, &width, &height))
+    {
+        add_dirty(fb, (uint16_t)x, (uint16_t)y, (uint16_t)(x + width), (uint16_t)(y + height));
+    }
+}
+
+bool framebuffer_is_dirty(const framebuffer_t *fb)
+{
+    return fb->dirty_count > 0;
+}
+
+size_t framebuffer_flush(framebuffer_t *fb, framebuffer_push_t push, void *context)
+{
+    size_t pixels = 0;
+
+    for (uint8_t i = 0; i < fb->dirty_count; i++)
+    {
+        const fb_rect_t *r = &fb->dirty[i];
+        if (push)
+        {
+            push(r, &fb->pixels[(size_t)r->y * fb->width + r->x], fb->width, context);
+        }
+        pixels += (size_t)r->width * r->height;
+    }
+    fb->dirty_count = 0;
+    return pixels;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file framebuffer.h
+ * @brief RGB565 framebuffer with dirty-rectangle tracking
+ *
+ * Drawing writes into caller-owned pixel memory and records which areas
+ * actually changed: a pixel written with the colour it already has does
+ * not count, so redrawing an unchanged screen leaves nothing to send.
+ * framebuffer_flush() hands each changed area to a push callback (the
+ * panel driver, a PPM writer on the host) and starts over.
+ *
+ * Changed areas are kept as at most FRAMEBUFFER_MAX_DIRTY rectangles.
+ * Two are merged whenever sending their bounding box costs no more than
+ * sending both (adjacent glyphs of a line of text, say), and when the list
+ * is full the new area joins whichever rectangle grows least, so a busy
+ * frame degrades towards one bounding box rather than losing changes.
+ *
+ * Colours are native-endian RGB565; coordinates may lie partly or wholly
+ * off the buffer and are clipped.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#define FRAMEBUFFER_MAX_DIRTY 8 // Rectangles tracked before merging
+
+#define FRAMEBUFFER_GLYPH_WIDTH 6  // Character cell of the built-in font (bitmap_font_default())
+#define FRAMEBUFFER_GLYPH_HEIGHT 8
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Area of the framebuffer
+     */
+    typedef struct
+    {
+        uint16_t x;
+        uint16_t y;
+        uint16_t width;
+        uint16_t height;
+    } fb_rect_t;
+
+    /**
+     * @brief Framebuffer state (pixels are owned by the caller)
+     */
+    typedef struct
+    {
+        uint16_t *pixels; // width * height, row-major
+        uint16_t width;
+        uint16_t height;
+        fb_rect_t dirty[FRAMEBUFFER_MAX_DIRTY];
+        uint8_t dirty_count;
+    } framebuffer_t;
+
+    /**
+     * @brief Receives one changed area during framebuffer_flush()
+     * @param rect Area
+     * @param pixels First pixel of the area
+     * @param stride Pixels from one row of the area to the next
+     * @param context Caller's pointer
+     */
+    typedef void (*framebuffer_push_t)(const fb_rect_t *rect, const uint16_t *pixels, uint16_t stride,
+                                       void *context);
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Attach pixel memory; the contents are left alone and nothing is dirty
+     * @param fb Framebuffer
+     * @param pixels width * height pixels
+     * @param width Width in pixels
+     * @param height Height in pixels
+     */
+    void framebuffer_init(framebuffer_t *fb, uint16_t *pixels, uint16_t width, uint16_t height);
+
+    /**
+     * @brief Convert 0xRRGGBB to RGB565
+     */
+    uint16_t framebuffer_rgb565(uint32_t rgb888);
+
+    /**
+     * @brief Convert RGB565 back to 0xRRGGBB (low bits replicated)
+     */
+    uint32_t framebuffer_rgb888(uint16_t rgb565);
+
+    /**
+     * @brief Fill a rectangle
+     * @param fb Framebuffer
+     * @param x Left edge
+     * @param y Top edge
+     * @param width Width
+     * @param height Height
+     * @param color RGB565 colour
+     */
+    void framebuffer_fill_rect(framebuffer_t *fb, int x, int y, int width, int height, uint16_t color);
+
+    /**
+     * @brief Draw a one-pixel rectangle outline
+     */
+    void framebuffer_draw_rect(framebuffer_t *fb, int x, int y, int width, int height, uint16_t color);
+
+    /**
+     * @brief Set one pixel
+     */
+    void framebuffer_set_pixel(framebuffer_t *fb, int x, int y, uint16_t color);
+
+    /**
+     * @brief Draw text in the built-in font (src/utils/bitmap_font.h), one 6x8 cell per character
+     * @param fb Framebuffer
+     * @param x Left edge
+     * @param y Top edge
+     * @param text NUL-terminated text; characters the font lacks show as '?'
+     * @param fg Glyph colour
+     * @param bg Cell background colour
+     * @return Width drawn in pixels
+     */
+    int framebuffer_draw_text(framebuffer_t *fb, int x, int y, const char *text, uint16_t fg, uint16_t bg);
+
+    /**
+     * @brief Copy pixels in, little-endian RGB565 byte pairs
+     * @param fb Framebuffer
+     * @param x Left edge
+     * @param y Top edge
+     * @param width Source width
+     * @param height Source height
+     * @param data width * height * 2 bytes
+     */
+    void framebuffer_blit(framebuffer_t *fb, int x, int y, int width, int height, const uint8_t *data);
+
+    /**
+     * @brief Mark an area changed without drawing (e.g. after the panel was reset)
+     */
+    void framebuffer_invalidate(framebuffer_t *fb, int x, int y, int width, int height);
+
+    /**
+     * @brief Whether anything changed since the last flush
+     */
+    bool framebuffer_is_dirty(const framebuffer_t *fb);
+
+    /**
+     * @brief Push every changed area and clear the list
+     * @param fb Framebuffer
+     * @param push Callback, called once per area
+     * @param context Passed to the callback
+     * @return Pixels pushed
+     */
+    size_t framebuffer_flush(framebuffer_t *fb, framebuffer_push_t push, void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAMEBUFFER_H
@@ -95,6 +95,36 @@ extern "C"
         bool msb_first;
     } spi_config_t;
 
+    /**
+     * @brief Called once an asynchronous SPI transfer has finished (see hal_spi_poll())
+     * @param spi_id SPI instance ID
+     * @param status HAL_OK, or why the transfer did not complete
+     * @param context As passed in spi_transfer_t
+     */
+    typedef void (*spi_complete_callback_t)(uint8_t spi_id, hal_status_t status, void *context);
+
+#define SPI_NO_PIN (-1) // spi_transfer_t cs_pin / dc_pin unused
+
+    /**
+     * @brief One queued SPI transfer
+     *
+     * The buffers belong to the caller until the transfer completes.
+     */
+    typedef struct
+    {
+        const uint8_t *tx_data; // NULL sends 0xFF
+        bool tx_repeat;         // Send tx_data's first frame over and over (a fill)
+        uint8_t *rx_data;       // NULL discards what comes back
+        size_t size;            // Bytes; even when data_bits is 16
+        uint8_t data_bits;      // 8, or 16 to send halfwords MSB first (RGB565 as-is); 0 for the instance's
+        uint32_t frequency;     // Clock in Hz for a slower device on the bus; 0 for the instance's
+        int16_t cs_pin;         // Held low during the transfer, and between transfers sharing it
+        int16_t dc_pin;         // Set to dc_level before the transfer (display data/command)
+        bool dc_level;
+        spi_complete_callback_t callback; // May be NULL
+        void *context;
+    } spi_transfer_t;
+
     /**
      * @brief I2C configuration
      */
@@ -151,6 +181,12 @@ extern "C"
      */
     uint32_t hal_get_tick_ms(void);
 
+    /**
+     * @brief Get time since boot in microseconds
+     * @return Monotonic 64-bit microsecond count (does not wrap in practice)
+     */
+    uint64_t hal_get_time_us(void);
+
     /**
      * @brief Delay execution for specified milliseconds
      * @param ms Delay time in milliseconds
@@ -348,7 +384,7 @@ extern "C"
     hal_status_t hal_spi_deinit(uint8_t spi_id);
 
     /**
-     * @brief Transmit data via SPI
+     * @brief Transmit data via SPI, waiting for it (and anything queued before it)
      * @param spi_id SPI instance ID
      * @param tx_data Data to transmit
      * @param rx_data Buffer for received data (can be NULL)
@@ -358,6 +394,39 @@ extern "C"
      */
     hal_status_t hal_spi_transfer(uint8_t spi_id, const uint8_t *tx_data, uint8_t *rx_data, size_t size, uint32_t timeout_ms);
 
+    /**
+     * @brief Queue a DMA transfer and return at once
+     *
+     * Transfers on one instance run in the order queued, each started from
+     * the interrupt of the one before, so the bus stays busy without the CPU.
+     * Callbacks run from hal_spi_poll(), not from the interrupt.
+     *
+     * @param spi_id SPI instance ID
+     * @param transfer Transfer to queue (copied)
+     * @return HAL_OK if queued, HAL_BUSY while the queue is full
+     */
+    hal_status_t hal_spi_transfer_async(uint8_t spi_id, const spi_transfer_t *transfer);
+
+    /**
+     * @brief Check whether an instance still has transfers queued or running
+     * @param spi_id SPI instance ID
+     * @return true while busy
+     */
+    bool hal_spi_is_busy(uint8_t spi_id);
+
+    /**
+     * @brief Wait until every transfer queued on an instance has finished
+     * @param spi_id SPI instance ID
+     * @param timeout_ms Timeout in milliseconds; on timeout the queue is aborted
+     * @return HAL status code
+     */
+    hal_status_t hal_spi_wait(uint8_t spi_id, uint32_t timeout_ms);
+
+    /**
+     * @brief Run the callbacks of transfers that finished since the last call
+     */
+    void hal_spi_poll(void);
+
     /**
      * @brief Set SPI chip select state
      * @param spi_id SPI instance ID
@@ -0,0 +1,472 @@
+/**
+ * @file http_parser.cpp
+ * @brief Incremental HTTP/1.1 request header parser implementation
+ *
+ * Every byte moves the state machine forward exactly once, so the cost of a
+ * request is linear in its size no matter how it is split across feeds.
+ */
+
+#include "http_parser.h"
+
+#include <string.h>
+#include <strings.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+enum
+{
+    S_METHOD = 0,
+    S_TARGET,
+    S_VERSION,
+    S_REQUEST_LF,
+    S_LINE_START,
+    S_NAME,
+    S_VALUE_START,
+    S_VALUE,
+    S_VALUE_LF,
+    S_BLANK_LF,
+    S_DONE,
+    S_ERROR
+};
+
+static const char *const header_names[HTTP_HEADER_COUNT] = {
+    "Host",
+    "Connection",
+    "Upgrade",
+    "Accept-Encoding",
+    "If-None-Match",
+    "Content-Length",
+    "Sec-WebSocket-Key",
+    "Sec-WebSocket-Version",
+    "Sec-WebSocket-Protocol",
+    "Sec-WebSocket-Extensions",
+};
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static http_parse_status_t fail(http_parser_t *parser, http_parse_error_t error);
+static bool is_tchar(uint8_t c);
+static bool finish_request_line(http_parser_t *parser);
+static void begin_header(http_parser_t *parser);
+static bool capture(http_parser_t *parser, char c);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+void http_parser_init(http_parser_t *parser)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->state = S_METHOD;
+    parser->current = -1;
+}
+
+http_parse_status_t http_parser_feed(http_parser_t *parser, const void *data, size_t len, size_t *consumed)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    size_t i = 0;
+
+    if (consumed)
+    {
+        *consumed = 0;
+    }
+
+    if (parser->state == S_DONE)
+    {
+        return HTTP_PARSE_DONE;
+    }
+    if (parser->state == S_ERROR)
+    {
+        return HTTP_PARSE_ERROR;
+    }
+
+    for (; i < len; i++)
+    {
+        uint8_t c = bytes[i];
+
+        if (++parser->total_bytes > HTTP_PARSER_MAX_HEADER_BYTES)
+        {
+            return fail(parser, HTTP_PARSE_ERR_HEADERS_TOO_LARGE);
+        }
+
+        switch (parser->state)
+        {
+        case S_METHOD:
+            if (c == ' ')
+            {
+                if (parser->token_len == 0)
+                {
+                    return fail(parser, HTTP_PARSE_ERR_SYNTAX);
+                }
+                parser->token[parser->token_len] = '\0';
+                parser->state = S_TARGET;
+            }
+            else if ((c == '\r' || c == '\n') && parser->token_len == 0)
+            {
+                // Tolerate stray line breaks between pipelined requests
+            }
+            else if (is_tchar(c) && parser->token_len < 7)
+            {
+                parser->token[parser->token_len++] = (char)c;
+            }
+            else
+            {
+                return fail(parser, HTTP_PARSE_ERR_SYNTAX);
+            }
+            break;
+
+        case S_TARGET:
+            if (c == ' ')
+            {
+                if (parser->target_len == 0)
+                {
+                    return fail(parser, HTTP_PARSE_ERR_SYNTAX);
+                }
+                parser->target[parser->target_len] = '\0';
+                parser->method = strcmp(parser->token, "GET") == 0    ? HTTP_METHOD_GET
+                                 : strcmp(parser->token, "HEAD") == 0 ? HTTP_METHOD_HEAD
+                                 : strcmp(parser->token, "POST") == 0 ? HTTP_METHOD_POST
+                                                                      : HTTP_METHOD_UNKNOWN;
+                parser->token_len = 0;
+                parser->state = S_VERSION;
+            }
+            else if (c <= 0x20 || c >= 0x7F)
+            {
+                return fail(parser, HTTP_PARSE_ERR_SYNTAX);
+            }
+            else if (parser->target_len >= HTTP_PARSER_TARGET_SIZE - 1)
+            {
+                return fail(parser, HTTP_PARSE_ERR_TARGET_TOO_LONG);
+            }
+            else
+            {
+                parser->target[parser->target_len++] = (char)c;
+            }
+            break;
+
+        case S_VERSION:
+            if (c == '\r' || c == '\n')
+            {
+                if (!finish_request_line(parser))
+                {
+                    return fail(parser, HTTP_PARSE_ERR_SYNTAX);
+                }
+                parser->state = (c == '\r') ? S_REQUEST_LF : S_LINE_START;
+            }
+            else if (parser->token_len < 8)
+            {
+                parser->token[parser->token_len++] = (char)c;
+            }
+            else
+            {
+                return fail(parser, HTTP_PARSE_ERR_SYNTAX);
+            }
+            break;
+
+        case S_REQUEST_LF:
+        case S_VALUE_LF:
+            if (c != '\n')
+            {
+                return fail(parser, HTTP_PARSE_ERR_SYNTAX);
+            }
+            parser->state = S_LINE_START;
+            break;
+
+        case S_LINE_START:
+            if (c == '\r')
+            {
+                parser->state = S_BLANK_LF;
+                break;
+            }
+            if (c == '\n')
+            {
+                parser->state = S_DONE;
+                break;
+            }
+            if (!is_tchar(c))
+            {
+                // Includes obsolete line folding, which RFC 7230 says to reject
+                return fail(parser, HTTP_PARSE_ERR_SYNTAX);
+            }
+            if (++parser->header_count > HTTP_PARSER_MAX_HEADERS)
+            {
+                return fail(parser, HTTP_PARSE_ERR_HEADERS_TOO_LARGE);
+            }
+            parser->token_len = 0;
+            parser->token[parser->token_len++] = (char)c;
+            parser->state = S_NAME;
+            break;
+
+        case S_NAME:
+            if (c == ':')
+            {
+                begin_header(parser);
+                parser->state = S_VALUE_START;
+            }
+            else if (!is_tchar(c))
+            {
+                return fail(parser, HTTP_PARSE_ERR_SYNTAX);
+            }
+            else if (parser->token_len < HTTP_PARSER_NAME_SIZE - 1)
+            {
+                parser->token[parser->token_len++] = (char)c;
+            }
+            else
+            {
+                // Longer than any header we keep; remember only that it is
+                parser->token_len = HTTP_PARSER_NAME_SIZE;
+            }
+            break;
+
+        case S_VALUE_START:
+            if (c == ' ' || c == '\t')
+            {
+                break;
+            }
+            parser->state = S_VALUE;
+            // fall through
+        case S_VALUE:
+            if (c == '\r' || c == '\n')
+            {
+                if (parser->current >= 0)
+                {
+                    parser->values[parser->current][parser->lengths[parser->current]] = '\0';
+                }
+                parser->pending_ws = 0;
+                parser->current = -1;
+                parser->state = (c == '\r') ? S_VALUE_LF : S_LINE_START;
+            }
+            else if (c == ' ' || c == '\t')
+            {
+                // Held back so trailing whitespace never reaches the value
+                if (parser->pending_ws < 0xFF)
+                {
+                    parser->pending_ws++;
+                }
+            }
+            else if (c < 0x20 || c == 0x7F)
+            {
+                return fail(parser, HTTP_PARSE_ERR_SYNTAX);
+            }
+            else if (parser->current >= 0)
+            {
+                for (; parser->pending_ws > 0; parser->pending_ws--)
+                {
+                    if (!capture(parser, ' '))
+                    {
+                        return fail(parser, HTTP_PARSE_ERR_HEADERS_TOO_LARGE);
+                    }
+                }
+                if (!capture(parser, (char)c))
+                {
+                    return fail(parser, HTTP_PARSE_ERR_HEADERS_TOO_LARGE);
+                }
+            }
+            break;
+
+        case S_BLANK_LF:
+            if (c != '\n')
+            {
+                return fail(parser, HTTP_PARSE_ERR_SYNTAX);
+            }
+            parser->state = S_DONE;
+            break;
+
+        default:
+            break;
+        }
+
+        if (parser->state == S_DONE)
+        {
+            i++;
+            break;
+        }
+    }
+
+    if (consumed)
+    {
+        *consumed = i;
+    }
+
+    return (parser->state == S_DONE) ? HTTP_PARSE_DONE : HTTP_PARSE_INCOMPLETE;
+}
+
+const char *http_parser_header(const http_parser_t *parser, http_header_id_t id)
+{
+    if (id < 0 || id >= HTTP_HEADER_COUNT || !(parser->present & (1u << id)))
+    {
+        return NULL;
+    }
+
+    return parser->values[id];
+}
+
+bool http_parser_path(const http_parser_t *parser, char *path, size_t size)
+{
+    const char *query = (const char *)memchr(parser->target, '?', parser->target_len);
+    size_t len = query ? (size_t)(query - parser->target) : parser->target_len;
+
+    if (size == 0 || len >= size)
+    {
+        return false;
+    }
+
+    memcpy(path, parser->target, len);
+    path[len] = '\0';
+    return true;
+}
+
+bool http_parser_keep_alive(const http_parser_t *parser)
+{
+    const char *connection = http_parser_header(parser, HTTP_HEADER_CONNECTION);
+
+    if (parser->version_minor >= 1)
+    {
+        return !http_header_has_token(connection, "close");
+    }
+
+    return http_header_has_token(connection, "keep-alive");
+}
+
+bool http_header_has_token(const char *list, const char *token)
+{
+    if (list == NULL || token == NULL)
+    {
+        return false;
+    }
+
+    size_t token_len = strlen(token);
+    const char *p = list;
+
+    while (*p)
+    {
+        while (*p == ' ' || *p == '\t' || *p == ',')
+        {
+            p++;
+        }
+
+        const char *start = p;
+        while (*p && *p != ',' && *p != ';' && *p != ' ' && *p != '\t')
+        {
+            p++;
+        }
+
+        if ((size_t)(p - start) == token_len && strncasecmp(start, token, token_len) == 0)
+        {
+            return true;
+        }
+
+        // Skip parameters and anything else up to the next element
+        while (*p && *p != ',')
+        {
+            p++;
+        }
+    }
+
+    return false;
+}
+
+int http_parse_error_status(http_parse_error_t error)
+{
+    switch (error)
+    {
+    case HTTP_PARSE_ERR_TARGET_TOO_LONG:
+        return 414;
+    case HTTP_PARSE_ERR_HEADERS_TOO_LARGE:
+        return 431;
+    default:
+        return 400;
+    }
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static http_parse_status_t fail(http_parser_t *parser, http_parse_error_t error)
+{
+    parser->state = S_ERROR;
+    parser->error = error;
+    return HTTP_PARSE_ERROR;
+}
+
+static bool is_tchar(uint8_t c)
+{
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
+    {
+        return true;
+    }
+
+    return c != 0 && strchr("!#$%&'*+-.^_`|~", c) != NULL;
+}
+
+static bool finish_request_line(http_parser_t *parser)
+{
+    if (parser->token_len != 8 || strncmp(parser->token, "HTTP/1.", 7) != 0)
+    {
+        return false;
+    }
+
+    char minor = parser->token[7];
+    if (minor < '0' || minor > '9')
+    {
+        return false;
+    }
+
+    parser->version_minor = (uint8_t)(minor - '0');
+    return true;
+}
+
+static void begin_header(http_parser_t *parser)
+{
+    parser->current = -1;
+    parser->pending_ws = 0;
+
+    if (parser->token_len >= HTTP_PARSER_NAME_SIZE)
+    {
+        return;
+    }
+
+    parser->token[parser->token_len] = '\0';
+    for (int id = 0; id < HTTP_HEADER_COUNT; id++)
+    {
+        if (strcasecmp(parser->token, header_names[id]) == 0)
+        {
+            parser->current = (int8_t)id;
+            break;
+        }
+    }
+
+    if (parser->current < 0)
+    {
+        return;
+    }
+
+    uint16_t bit = (uint16_t)(1u << parser->current);
+    if (parser->present & bit)
+    {
+        // Repeated field: combine as a list, per RFC 7230 section 3.2.2.
+        // Overflow is caught when the first value byte is captured.
+        parser->pending_ws = 0;
+        capture(parser, ',');
+        parser->pending_ws = 1;
+    }
+    parser->present |= bit;
+}
+
+static bool capture(http_parser_t *parser, char c)
+{
+    uint8_t *len = &parser->lengths[parser->current];
+
+    if (*len >= HTTP_PARSER_VALUE_SIZE - 1)
+    {
+        return false;
+    }
+
+    parser->values[parser->current][(*len)++] = c;
+    return true;
+}
@@ -0,0 +1,189 @@
+/**
+ * @file http_parser.h
+ * @brief Incremental HTTP/1.1 request header parser
+ *
+ * The parser is a byte-level state machine that can be fed a request in
+ * arbitrary pieces (for example each pbuf of an lwIP chain, in place), so a
+ * header split across TCP segments or receive callbacks needs no reassembly
+ * buffer. Only the headers the firmware cares about are kept, each in a
+ * fixed-size slot inside the parser; everything else is skipped as it
+ * streams past. No heap allocation is performed.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONFIGURATION
+    // =============================================================================
+
+#ifndef HTTP_PARSER_MAX_HEADER_BYTES
+#define HTTP_PARSER_MAX_HEADER_BYTES 4096 // Request line + all headers
+#endif
+
+#ifndef HTTP_PARSER_MAX_HEADERS
+#define HTTP_PARSER_MAX_HEADERS 48 // Header lines, known or not
+#endif
+
+#define HTTP_PARSER_TARGET_SIZE 128 // Request target incl. query, NUL terminated
+#define HTTP_PARSER_VALUE_SIZE 64   // Per kept header value, NUL terminated
+#define HTTP_PARSER_NAME_SIZE 32    // Longest header name that can be matched
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Parser progress
+     */
+    typedef enum
+    {
+        HTTP_PARSE_INCOMPLETE = 0, // Need more bytes
+        HTTP_PARSE_DONE = 1,       // Blank line seen; headers are available
+        HTTP_PARSE_ERROR = 2       // Malformed or over a limit; see error
+    } http_parse_status_t;
+
+    /**
+     * @brief Why parsing failed
+     */
+    typedef enum
+    {
+        HTTP_PARSE_OK = 0,
+        HTTP_PARSE_ERR_SYNTAX,           // 400 Bad Request
+        HTTP_PARSE_ERR_TARGET_TOO_LONG,  // 414 URI Too Long
+        HTTP_PARSE_ERR_HEADERS_TOO_LARGE // 431 Request Header Fields Too Large
+    } http_parse_error_t;
+
+    /**
+     * @brief Request methods the firmware distinguishes
+     */
+    typedef enum
+    {
+        HTTP_METHOD_UNKNOWN = 0,
+        HTTP_METHOD_GET,
+        HTTP_METHOD_HEAD,
+        HTTP_METHOD_POST
+    } http_method_t;
+
+    /**
+     * @brief Headers kept by the parser
+     */
+    typedef enum
+    {
+        HTTP_HEADER_HOST = 0,
+        HTTP_HEADER_CONNECTION,
+        HTTP_HEADER_UPGRADE,
+        HTTP_HEADER_ACCEPT_ENCODING,
+        HTTP_HEADER_IF_NONE_MATCH,
+        HTTP_HEADER_CONTENT_LENGTH,
+        HTTP_HEADER_SEC_WEBSOCKET_KEY,
+        HTTP_HEADER_SEC_WEBSOCKET_VERSION,
+        HTTP_HEADER_SEC_WEBSOCKET_PROTOCOL,
+        HTTP_HEADER_SEC_WEBSOCKET_EXTENSIONS,
+        HTTP_HEADER_COUNT
+    } http_header_id_t;
+
+    /**
+     * @brief Parser state; embed one per connection
+     */
+    typedef struct
+    {
+        uint8_t state;
+        uint8_t version_minor;
+        http_method_t method;
+        http_parse_error_t error;
+
+        uint16_t total_bytes;  // Header bytes consumed so far
+        uint16_t header_count; // Header lines seen so far
+        uint16_t target_len;
+        uint8_t token_len;    // Method / version / header name scratch length
+        int8_t current;       // Header being captured, -1 when skipping
+        uint8_t pending_ws;   // Whitespace held back until more value arrives
+
+        char token[HTTP_PARSER_NAME_SIZE];
+        char target[HTTP_PARSER_TARGET_SIZE];
+        char values[HTTP_HEADER_COUNT][HTTP_PARSER_VALUE_SIZE];
+        uint8_t lengths[HTTP_HEADER_COUNT];
+        uint16_t present; // Bit per http_header_id_t
+    } http_parser_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Reset a parser for a new request
+     * @param parser Parser to reset
+     */
+    void http_parser_init(http_parser_t *parser);
+
+    /**
+     * @brief Feed the next piece of the request
+     * @param parser Parser state
+     * @param data Bytes to parse (need not be NUL terminated)
+     * @param len Number of bytes available
+     * @param consumed Receives the number of bytes used; once the parse is
+     *        done, bytes past this point belong to the body or next message
+     * @return Parser status after this piece
+     */
+    http_parse_status_t http_parser_feed(http_parser_t *parser, const void *data, size_t len, size_t *consumed);
+
+    /**
+     * @brief Get a kept header value
+     * @param parser Parser that has finished (HTTP_PARSE_DONE)
+     * @param id Header to fetch
+     * @return NUL terminated value with surrounding whitespace removed, or
+     *         NULL if the header was absent. Repeated headers are joined
+     *         with ", ".
+     */
+    const char *http_parser_header(const http_parser_t *parser, http_header_id_t id);
+
+    /**
+     * @brief Get the request path without the query string
+     * @param parser Parser that has finished
+     * @param path Output buffer
+     * @param size Output buffer size
+     * @return true if the path fitted
+     */
+    bool http_parser_path(const http_parser_t *parser, char *path, size_t size);
+
+    /**
+     * @brief Whether the connection should stay open after the response
+     * @param parser Parser that has finished
+     * @return true for HTTP/1.1 without "close", or HTTP/1.0 with "keep-alive"
+     */
+    bool http_parser_keep_alive(const http_parser_t *parser);
+
+    /**
+     * @brief Case-insensitive search for a token in a comma separated list
+     * @param list Header value such as "keep-alive, Upgrade" (may be NULL)
+     * @param token Token to look for
+     * @return true if the token is one of the list elements; parameters
+     *         after ';' are ignored
+     */
+    bool http_header_has_token(const char *list, const char *token);
+
+    /**
+     * @brief HTTP status code matching a parse error
+     * @param error Parse error
+     * @return 400, 414 or 431
+     */
+    int http_parse_error_status(http_parse_error_t error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HTTP_PARSER_H
@@ -0,0 +1,533 @@
+/**
+ * @file json_reader.cpp
+ * @brief JSON pull parser implementation
+ */
+
+#include "json_reader.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+// What the next token may be
+enum
+{
+    STATE_VALUE = 0,    // Top level, after ':' or after ',' in an array
+    STATE_VALUE_OR_END, // After '['
+    STATE_KEY,          // After ',' in an object
+    STATE_KEY_OR_END,   // After '{'
+    STATE_AFTER_VALUE,  // ',' or the closing bracket
+    STATE_DONE,
+    STATE_ERROR
+};
+
+#define JSON_NUMBER_TEXT_MAX 32
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static json_token_t fail(json_reader_t *r);
+static json_token_t emit(json_reader_t *r, json_token_t token, const char *start, size_t len);
+static json_token_t open_container(json_reader_t *r, bool object);
+static json_token_t close_container(json_reader_t *r, bool object);
+static bool scan_string(json_reader_t *r);
+static json_token_t scan_value(json_reader_t *r);
+static bool at_end(const json_reader_t *r);
+static void skip_ws(json_reader_t *r);
+static int hex_value(char c);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+void json_reader_init(json_reader_t *r, const char *text, size_t len)
+{
+    r->p = text;
+    r->end = text ? text + len : text;
+    r->token = text;
+    r->token_len = 0;
+    r->last = JSON_TOKEN_END;
+    r->in_object = 0;
+    r->depth = 0;
+    r->state = text ? STATE_VALUE : STATE_ERROR;
+}
+
+json_token_t json_next(json_reader_t *r)
+{
+    for (;;)
+    {
+        skip_ws(r);
+
+        switch (r->state)
+        {
+        case STATE_DONE:
+            return emit(r, JSON_TOKEN_END, r->p, 0);
+
+        case STATE_ERROR:
+            return JSON_TOKEN_ERROR;
+
+        case STATE_AFTER_VALUE:
+        {
+            bool object = (r->in_object >> r->depth) & 1u;
+            if (r->depth == 0)
+            {
+                // Only whitespace may follow the top-level value
+                if (!at_end(r))
+                {
+                    return fail(r);
+                }
+                r->state = STATE_DONE;
+                continue;
+            }
+            if (at_end(r))
+            {
+                return fail(r);
+            }
+            if (*r->p == ',')
+            {
+                r->p++;
+                r->state = object ? STATE_KEY : STATE_VALUE;
+                continue;
+            }
+            return close_container(r, object);
+        }
+
+        case STATE_KEY_OR_END:
+            if (!at_end(r) && *r->p == '}')
+            {
+                return close_container(r, true);
+            }
+            // Fall through
+        case STATE_KEY:
+        {
+            if (at_end(r) || *r->p != '"' || !scan_string(r))
+            {
+                return fail(r);
+            }
+            const char *key = r->token;
+            size_t key_len = r->token_len;
+
+            skip_ws(r);
+            if (at_end(r) || *r->p != ':')
+            {
+                return fail(r);
+            }
+            r->p++;
+            r->state = STATE_VALUE;
+            return emit(r, JSON_TOKEN_KEY, key, key_len);
+        }
+
+        case STATE_VALUE_OR_END:
+            if (!at_end(r) && *r->p == ']')
+            {
+                return close_container(r, false);
+            }
+            // Fall through
+        case STATE_VALUE:
+        default:
+            return scan_value(r);
+        }
+    }
+}
+
+bool json_skip(json_reader_t *r)
+{
+    json_token_t token = r->last;
+
+    if (token == JSON_TOKEN_KEY)
+    {
+        token = json_next(r);
+        if (token != JSON_TOKEN_OBJECT_BEGIN && token != JSON_TOKEN_ARRAY_BEGIN)
+        {
+            return token != JSON_TOKEN_ERROR && token != JSON_TOKEN_END;
+        }
+    }
+
+    if (token != JSON_TOKEN_OBJECT_BEGIN && token != JSON_TOKEN_ARRAY_BEGIN)
+    {
+        return true;
+    }
+
+    uint8_t target = (uint8_t)(r->depth - 1);
+    while (r->depth > target)
+    {
+        token = json_next(r);
+        if (token == JSON_TOKEN_ERROR || token == JSON_TOKEN_END)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool json_token_is(const json_reader_t *r, const char *text)
+{
+    if (r->last != JSON_TOKEN_KEY && r->last != JSON_TOKEN_STRING)
+    {
+        return false;
+    }
+    size_t len = strlen(text);
+    return len == r->token_len && memcmp(r->token, text, len) == 0;
+}
+
+bool json_token_copy(const json_reader_t *r, char *out, size_t size)
+{
+    if (size == 0)
+    {
+        return false;
+    }
+    out[0] = '\0';
+
+    if (r->last == JSON_TOKEN_NUMBER || r->last == JSON_TOKEN_TRUE || r->last == JSON_TOKEN_FALSE ||
+        r->last == JSON_TOKEN_NULL)
+    {
+        if (r->token_len >= size)
+        {
+            return false;
+        }
+        memcpy(out, r->token, r->token_len);
+        out[r->token_len] = '\0';
+        return true;
+    }
+    if (r->last != JSON_TOKEN_KEY && r->last != JSON_TOKEN_STRING)
+    {
+        return false;
+    }
+
+    size_t n = 0;
+    const char *p = r->token;
+    const char *end = r->token + r->token_len;
+    while (p < end)
+    {
+        char utf8[4];
+        size_t utf8_len = 1;
+        utf8[0] = *p++;
+
+        if (utf8[0] == '\\')
+        {
+            char c = *p++; // scan_string() guarantees a character after '\'
+            switch (c)
+            {
+            case 'n':
+                utf8[0] = '\n';
+                break;
+            case 'r':
+                utf8[0] = '\r';
+                break;
+            case 't':
+                utf8[0] = '\t';
+                break;
+            case 'b':
+                utf8[0] = '\b';
+                break;
+            case 'f':
+                utf8[0] = '\f';
+                break;
+            case 'u':
+            {
+                uint32_t code = 0;
+                for (int i = 0; i < 4; i++)
+                {
+                    code = (code << 4) | (uint32_t)hex_value(*p++);
+                }
+                if (code >= 0xD800 && code <= 0xDFFF)
+                {
+                    utf8[0] = '?'; // Surrogate pairs are not needed by any command
+                }
+                else if (code < 0x80)
+                {
+                    utf8[0] = (char)code;
+                }
+                else if (code < 0x800)
+                {
+                    utf8[0] = (char)(0xC0 | (code >> 6));
+                    utf8[1] = (char)(0x80 | (code & 0x3F));
+                    utf8_len = 2;
+                }
+                else
+                {
+                    utf8[0] = (char)(0xE0 | (code >> 12));
+                    utf8[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+                    utf8[2] = (char)(0x80 | (code & 0x3F));
+                    utf8_len = 3;
+                }
+                break;
+            }
+            default:
+                utf8[0] = c; // \" \\ \/
+                break;
+            }
+        }
+
+        if (n + utf8_len >= size)
+        {
+            out[n] = '\0';
+            return false;
+        }
+        memcpy(out + n, utf8, utf8_len);
+        n += utf8_len;
+    }
+    out[n] = '\0';
+    return true;
+}
+
+bool json_token_int(const json_reader_t *r, int32_t *value)
+{
+    char text[JSON_NUMBER_TEXT_MAX];
+    if (r->last != JSON_TOKEN_NUMBER || !json_token_copy(r, text, sizeof(text)) ||
+        strpbrk(text, ".eE") != NULL)
+    {
+        return false;
+    }
+
+    char *end;
+    long long v = strtoll(text, &end, 10);
+    if (*end != '\0' || v < INT32_MIN || v > INT32_MAX)
+    {
+        return false;
+    }
+    *value = (int32_t)v;
+    return true;
+}
+
+bool json_token_float(const json_reader_t *r, float *value)
+{
+    char text[JSON_NUMBER_TEXT_MAX];
+    if (r->last != JSON_TOKEN_NUMBER || !json_token_copy(r, text, sizeof(text)))
+    {
+        return false;
+    }
+
+    char *end;
+    *value = strtof(text, &end);
+    return *end == '\0';
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static json_token_t fail(json_reader_t *r)
+{
+    r->state = STATE_ERROR;
+    r->last = JSON_TOKEN_ERROR;
+    r->token = r->p;
+    r->token_len = 0;
+    return JSON_TOKEN_ERROR;
+}
+
+static json_token_t emit(json_reader_t *r, json_token_t token, const char *start, size_t len)
+{
+    r->last = token;
+    r->token = start;
+    r->token_len = len;
+    return token;
+}
+
+static json_token_t open_container(json_reader_t *r, bool object)
+{
+    if (r->depth + 1 >= JSON_READER_MAX_DEPTH)
+    {
+        return fail(r);
+    }
+
+    const char *start = r->p++;
+    r->depth++;
+    if (object)
+    {
+        r->in_object |= (uint16_t)(1u << r->depth);
+        r->state = STATE_KEY_OR_END;
+    }
+    else
+    {
+        r->in_object &= (uint16_t)~(1u << r->depth);
+        r->state = STATE_VALUE_OR_END;
+    }
+    return emit(r, object ? JSON_TOKEN_OBJECT_BEGIN : JSON_TOKEN_ARRAY_BEGIN, start, 1);
+}
+
+static json_token_t close_container(json_reader_t *r, bool object)
+{
+    if (at_end(r) || *r->p != (object ? '}' : ']'))
+    {
+        return fail(r);
+    }
+
+    const char *start = r->p++;
+    r->depth--;
+    r->state = STATE_AFTER_VALUE;
+    return emit(r, object ? JSON_TOKEN_OBJECT_END : JSON_TOKEN_ARRAY_END, start, 1);
+}
+
+static bool scan_string(json_reader_t *r)
+{
+    // r->p is at the opening quote; leaves the contents span in token/token_len
+    const char *start = ++r->p;
+
+    while (!at_end(r) && *r->p != '"')
+    {
+        unsigned char c = (unsigned char)*r->p;
+        if (c < 0x20)
+        {
+            return false;
+        }
+        if (c == '\\')
+        {
+            r->p++;
+            if (at_end(r))
+            {
+                return false;
+            }
+            if (*r->p == 'u')
+            {
+                for (int i = 0; i < 4; i++)
+                {
+                    r->p++;
+                    if (at_end(r) || hex_value(*r->p) < 0)
+                    {
+                        return false;
+                    }
+                }
+            }
+            else if (strchr("\"\\/bfnrt", *r->p) == NULL)
+            {
+                return false;
+            }
+        }
+        r->p++;
+    }
+
+    if (at_end(r))
+    {
+        return false;
+    }
+
+    r->token = start;
+    r->token_len = (size_t)(r->p - start);
+    r->p++; // Closing quote
+    return true;
+}
+
+static json_token_t scan_value(json_reader_t *r)
+{
+    if (at_end(r))
+    {
+        return fail(r);
+    }
+
+    const char *start = r->p;
+    char c = *r->p;
+
+    if (c == '{' || c == '[')
+    {
+        return open_container(r, c == '{');
+    }
+
+    json_token_t token;
+    if (c == '"')
+    {
+        if (!scan_string(r))
+        {
+            return fail(r);
+        }
+        r->state = STATE_AFTER_VALUE;
+        return emit(r, JSON_TOKEN_STRING, r->token, r->token_len);
+    }
+    else if (c == '-' || (c >= '0' && c <= '9'))
+    {
+        // -?digits(.digits)?([eE][+-]?digits)?
+        if (c == '-')
+        {
+            r->p++;
+        }
+        const char *digits = r->p;
+        while (!at_end(r) && *r->p >= '0' && *r->p <= '9')
+        {
+            r->p++;
+        }
+        bool ok = r->p > digits;
+        if (ok && !at_end(r) && *r->p == '.')
+        {
+            digits = ++r->p;
+            while (!at_end(r) && *r->p >= '0' && *r->p <= '9')
+            {
+                r->p++;
+            }
+            ok = r->p > digits;
+        }
+        if (ok && !at_end(r) && (*r->p == 'e' || *r->p == 'E'))
+        {
+            r->p++;
+            if (!at_end(r) && (*r->p == '+' || *r->p == '-'))
+            {
+                r->p++;
+            }
+            digits = r->p;
+            while (!at_end(r) && *r->p >= '0' && *r->p <= '9')
+            {
+                r->p++;
+            }
+            ok = r->p > digits;
+        }
+        if (!ok)
+        {
+            return fail(r);
+        }
+        token = JSON_TOKEN_NUMBER;
+    }
+    else
+    {
+        static const struct
+        {
+            const char *text;
+            size_t len;
+            json_token_t token;
+        } literals[] = {{"true", 4, JSON_TOKEN_TRUE}, {"false", 5, JSON_TOKEN_FALSE}, {"null", 4, JSON_TOKEN_NULL}};
+
+        token = JSON_TOKEN_ERROR;
+        for (size_t i = 0; i < sizeof(literals) / sizeof(literals[0]); i++)
+        {
+            if ((size_t)(r->end - r->p) >= literals[i].len && memcmp(r->p, literals[i].text, literals[i].len) == 0)
+            {
+                r->p += literals[i].len;
+                token = literals[i].token;
+                break;
+            }
+        }
+        if (token == JSON_TOKEN_ERROR)
+        {
+            return fail(r);
+        }
+    }
+
+    r->state = STATE_AFTER_VALUE;
+    return emit(r, token, start, (size_t)(r->p - start));
+}
+
+static bool at_end(const json_reader_t *r)
+{
+    return r->p >= r->end || *r->p == '\0';
+}
+
+static void skip_ws(json_reader_t *r)
+{
+    while (!at_end(r) && (*r->p == ' ' || *r->p == '\t' || *r->p == '\r' || *r->p == '\n'))
+    {
+        r->p++;
+    }
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
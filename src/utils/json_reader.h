@@ -0,0 +1,128 @@
+/**
+ * @file json_reader.h
+ * @brief Zero-allocation pull parser for inbound JSON messages
+ *
+ * The caller asks for one token at a time and decides what to keep, so a
+ * command message is walked once in place: no DOM, no copies of values
+ * the caller does not want. Strings are reported as spans of the input
+ * with escapes left intact; json_token_copy() decodes one on demand.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#define JSON_READER_MAX_DEPTH 16
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Tokens returned by json_next()
+     */
+    typedef enum
+    {
+        JSON_TOKEN_END = 0, // Document complete
+        JSON_TOKEN_ERROR,   // Malformed input; every later call returns this too
+        JSON_TOKEN_OBJECT_BEGIN,
+        JSON_TOKEN_OBJECT_END,
+        JSON_TOKEN_ARRAY_BEGIN,
+        JSON_TOKEN_ARRAY_END,
+        JSON_TOKEN_KEY, // Object member name; its value is the next token
+        JSON_TOKEN_STRING,
+        JSON_TOKEN_NUMBER,
+        JSON_TOKEN_TRUE,
+        JSON_TOKEN_FALSE,
+        JSON_TOKEN_NULL
+    } json_token_t;
+
+    /**
+     * @brief Reader state (treat as opaque, except token/token_len)
+     */
+    typedef struct
+    {
+        const char *p;
+        const char *end;
+        const char *token; // Current token: string/key contents without quotes, number text, or the bracket
+        size_t token_len;
+        json_token_t last;
+        uint16_t in_object; // Bit per depth: container is an object
+        uint8_t depth;
+        uint8_t state;
+    } json_reader_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Start reading a document
+     * @param r Reader
+     * @param text Input (need not be NUL terminated; a NUL also ends it)
+     * @param len Input length
+     */
+    void json_reader_init(json_reader_t *r, const char *text, size_t len);
+
+    /**
+     * @brief Advance to the next token
+     * @param r Reader
+     * @return Token type; details in r->token and r->token_len
+     */
+    json_token_t json_next(json_reader_t *r);
+
+    /**
+     * @brief Skip a value without reporting its tokens
+     *
+     * After a KEY, skips the member's value; after an OBJECT_BEGIN or
+     * ARRAY_BEGIN, skips the rest of that container. Otherwise does nothing.
+     * @param r Reader
+     * @return false on malformed input
+     */
+    bool json_skip(json_reader_t *r);
+
+    /**
+     * @brief Compare the current KEY or STRING with plain text (no unescaping)
+     */
+    bool json_token_is(const json_reader_t *r, const char *text);
+
+    /**
+     * @brief Decode the current KEY or STRING, or copy a scalar's text
+     * @param r Reader
+     * @param out Output buffer, always NUL terminated
+     * @param size Output buffer size
+     * @return false if it did not fit or the token has no text
+     */
+    bool json_token_copy(const json_reader_t *r, char *out, size_t size);
+
+    /**
+     * @brief Convert the current NUMBER to an integer
+     * @return false if it is not an integer or out of range
+     */
+    bool json_token_int(const json_reader_t *r, int32_t *value);
+
+    /**
+     * @brief Convert the current NUMBER to a float
+     */
+    bool json_token_float(const json_reader_t *r, float *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_READER_H
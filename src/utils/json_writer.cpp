@@ -0,0 +1,609 @@
+/**
+ * @file json_writer.cpp
+ * @brief Streaming JSON writer implementation
+ */
+
+#include "json_writer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+// CBOR major types and simple values
+#define CBOR_UNSIGNED 0
+#define CBOR_NEGATIVE 1
+#define CBOR_TEXT 3
+#define CBOR_FALSE 0xF4
+#define CBOR_TRUE 0xF5
+#define CBOR_NULL 0xF6
+#define CBOR_FLOAT32 0xFA
+#define CBOR_FLOAT64 0xFB
+#define CBOR_MAP_OPEN 0xBF   // Indefinite-length map
+#define CBOR_ARRAY_OPEN 0x9F // Indefinite-length array
+#define CBOR_BREAK 0xFF
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static const char hex_digits[] = "0123456789abcdef";
+
+static const uint32_t pow10_table[JSON_FLOAT_MAX_DECIMALS + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static void put(json_writer_t *w, const char *data, size_t len);
+static void put_char(json_writer_t *w, char c);
+static void begin_value(json_writer_t *w);
+static void put_u64(json_writer_t *w, uint64_t value);
+static void put_escaped(json_writer_t *w, const char *text, size_t len);
+static size_t escaped_size(unsigned char c);
+static void put_cbor_head(json_writer_t *w, uint8_t major, uint64_t value);
+static size_t cbor_head_size(uint64_t value);
+static void put_be(json_writer_t *w, uint8_t initial, uint64_t bits, size_t bytes);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+void json_writer_init(json_writer_t *w, char *buf, size_t size)
+{
+    json_writer_init_format(w, buf, size, JSON_FORMAT_TEXT);
+}
+
+void json_writer_init_format(json_writer_t *w, char *buf, size_t size, json_format_t format)
+{
+    w->buf = buf;
+    w->size = size;
+    w->len = 0;
+    w->has_items = 0;
+    w->depth = 0;
+    w->format = (uint8_t)format;
+    w->after_key = false;
+    w->overflow = (buf == NULL || size == 0);
+}
+
+size_t json_writer_finish(json_writer_t *w)
+{
+    if (w->overflow || w->depth != 0 || w->after_key)
+    {
+        return 0;
+    }
+    w->buf[w->len] = '\0';
+    return w->len;
+}
+
+bool json_writer_overflowed(const json_writer_t *w)
+{
+    return w->overflow;
+}
+
+bool json_writer_reserve(json_writer_t *w, size_t bytes)
+{
+    if (w->overflow || bytes >= w->size - w->len)
+    {
+        w->overflow = true;
+        return false;
+    }
+    w->size -= bytes;
+    return true;
+}
+
+void json_writer_release(json_writer_t *w, size_t bytes)
+{
+    w->size += bytes;
+}
+
+void json_begin_object(json_writer_t *w)
+{
+    begin_value(w);
+    put_char(w, w->format == JSON_FORMAT_CBOR ? (char)CBOR_MAP_OPEN : '{');
+    if (w->depth + 1 >= JSON_WRITER_MAX_DEPTH)
+    {
+        w->overflow = true;
+        return;
+    }
+    w->depth++;
+    w->has_items &= (uint16_t)~(1u << w->depth);
+}
+
+void json_end_object(json_writer_t *w)
+{
+    if (w->depth > 0)
+    {
+        w->depth--;
+    }
+    put_char(w, w->format == JSON_FORMAT_CBOR ? (char)CBOR_BREAK : '}');
+}
+
+void json_begin_array(json_writer_t *w)
+{
+    begin_value(w);
+    put_char(w, w->format == JSON_FORMAT_CBOR ? (char)CBOR_ARRAY_OPEN : '[');
+    if (w->depth + 1 >= JSON_WRITER_MAX_DEPTH)
+    {
+        w->overflow = true;
+        return;
+    }
+    w->depth++;
+    w->has_items &= (uint16_t)~(1u << w->depth);
+}
+
+void json_end_array(json_writer_t *w)
+{
+    if (w->depth > 0)
+    {
+        w->depth--;
+    }
+    put_char(w, w->format == JSON_FORMAT_CBOR ? (char)CBOR_BREAK : ']');
+}
+
+void json_key(json_writer_t *w, const char *key)
+{
+    begin_value(w);
+    size_t len = strlen(key);
+    if (w->format == JSON_FORMAT_CBOR)
+    {
+        put_cbor_head(w, CBOR_TEXT, len);
+        put(w, key, len);
+    }
+    else
+    {
+        put_char(w, '"');
+        put_escaped(w, key, len);
+        put(w, "\":", 2);
+    }
+    w->after_key = true;
+}
+
+void json_string(json_writer_t *w, const char *text)
+{
+    if (text == NULL)
+    {
+        json_null(w);
+        return;
+    }
+    json_string_n(w, text, strlen(text));
+}
+
+void json_string_n(json_writer_t *w, const char *text, size_t len)
+{
+    begin_value(w);
+    if (w->format == JSON_FORMAT_CBOR)
+    {
+        put_cbor_head(w, CBOR_TEXT, len);
+        put(w, text, len);
+        return;
+    }
+    put_char(w, '"');
+    put_escaped(w, text, len);
+    put_char(w, '"');
+}
+
+size_t json_string_fit(json_writer_t *w, const char *text, size_t len, size_t reserve)
+{
+    begin_value(w);
+    bool cbor = w->format == JSON_FORMAT_CBOR;
+    if (!cbor)
+    {
+        put_char(w, '"');
+    }
+    if (w->overflow)
+    {
+        return 0;
+    }
+
+    // Room for the text, excluding the closing quote (or CBOR head), reserve and terminator
+    size_t overhead = cbor ? cbor_head_size(len) : 1;
+    size_t room = (w->size - 1 - w->len > reserve + overhead) ? w->size - 1 - w->len - reserve - overhead : 0;
+    size_t fit = 0;
+    if (cbor)
+    {
+        fit = len < room ? len : room; // A shorter text never needs a longer head
+    }
+    else
+    {
+        size_t used = 0;
+        while (fit < len)
+        {
+            size_t cost = escaped_size((unsigned char)text[fit]);
+            if (used + cost > room)
+            {
+                break;
+            }
+            used += cost;
+            fit++;
+        }
+    }
+
+    if (fit < len)
+    {
+        // Never end inside a multi-byte sequence
+        while (fit > 0 && ((unsigned char)text[fit] & 0xC0) == 0x80)
+        {
+            fit--;
+        }
+    }
+
+    if (cbor)
+    {
+        put_cbor_head(w, CBOR_TEXT, fit);
+        put(w, text, fit);
+    }
+    else
+    {
+        put_escaped(w, text, fit);
+        put_char(w, '"');
+    }
+    return fit;
+}
+
+void json_int(json_writer_t *w, int32_t value)
+{
+    begin_value(w);
+    if (w->format == JSON_FORMAT_CBOR)
+    {
+        // Negative integers are stored as -1 - n
+        if (value < 0)
+        {
+            put_cbor_head(w, CBOR_NEGATIVE, (uint64_t)(-(value + 1)));
+        }
+        else
+        {
+            put_cbor_head(w, CBOR_UNSIGNED, (uint64_t)value);
+        }
+        return;
+    }
+    if (value < 0)
+    {
+        put_char(w, '-');
+        put_u64(w, (uint64_t)(-(int64_t)value));
+    }
+    else
+    {
+        put_u64(w, (uint64_t)value);
+    }
+}
+
+void json_uint(json_writer_t *w, uint32_t value)
+{
+    json_uint64(w, value);
+}
+
+void json_uint64(json_writer_t *w, uint64_t value)
+{
+    begin_value(w);
+    if (w->format == JSON_FORMAT_CBOR)
+    {
+        put_cbor_head(w, CBOR_UNSIGNED, value);
+        return;
+    }
+    put_u64(w, value);
+}
+
+void json_float(json_writer_t *w, float value, uint8_t decimals)
+{
+    // Self-comparison rejects NaN; JSON has no NaN or infinity
+    if (!(value == value) || value >= 1e18f || value <= -1e18f)
+    {
+        json_null(w);
+        return;
+    }
+    if (w->format == JSON_FORMAT_CBOR)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        begin_value(w);
+        put_be(w, CBOR_FLOAT32, bits, 4);
+        return;
+    }
+    if (decimals > JSON_FLOAT_MAX_DECIMALS)
+    {
+        decimals = JSON_FLOAT_MAX_DECIMALS;
+    }
+
+    bool negative = value < 0.0f;
+    double magnitude = negative ? -(double)value : (double)value;
+    uint32_t scale = pow10_table[decimals];
+    uint64_t scaled = (uint64_t)(magnitude * scale + 0.5);
+
+    begin_value(w);
+    if (negative && scaled != 0)
+    {
+        put_char(w, '-');
+    }
+    put_u64(w, scaled / scale);
+
+    if (decimals > 0)
+    {
+        char frac[JSON_FLOAT_MAX_DECIMALS + 1];
+        uint32_t rest = (uint32_t)(scaled % scale);
+        frac[0] = '.';
+        for (int i = decimals; i > 0; i--)
+        {
+            frac[i] = (char)('0' + rest % 10);
+            rest /= 10;
+        }
+        put(w, frac, (size_t)decimals + 1);
+    }
+}
+
+void json_number(json_writer_t *w, const char *text, size_t len)
+{
+    if (w->format != JSON_FORMAT_CBOR)
+    {
+        json_raw(w, text, len);
+        return;
+    }
+
+    // Integers keep their exact value; anything else becomes a double
+    bool negative = len > 0 && text[0] == '-';
+    size_t digits = len - (negative ? 1 : 0);
+    uint64_t magnitude = 0;
+    bool integer = digits > 0 && digits <= 18;
+    for (size_t i = negative ? 1 : 0; integer && i < len; i++)
+    {
+        integer = text[i] >= '0' && text[i] <= '9';
+        magnitude = magnitude * 10 + (uint64_t)(text[i] - '0');
+    }
+
+    begin_value(w);
+    if (integer)
+    {
+        if (negative && magnitude > 0)
+        {
+            put_cbor_head(w, CBOR_NEGATIVE, magnitude - 1);
+        }
+        else
+        {
+            put_cbor_head(w, CBOR_UNSIGNED, magnitude);
+        }
+        return;
+    }
+
+    char copy[32];
+    if (len >= sizeof(copy))
+    {
+        w->overflow = true;
+        return;
+    }
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+    double value = strtod(copy, NULL);
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_be(w, CBOR_FLOAT64, bits, 8);
+}
+
+void json_bool(json_writer_t *w, bool value)
+{
+    begin_value(w);
+    if (w->format == JSON_FORMAT_CBOR)
+    {
+        put_char(w, (char)(value ? CBOR_TRUE : CBOR_FALSE));
+        return;
+    }
+    if (value)
+    {
+        put(w, "true", 4);
+    }
+    else
+    {
+        put(w, "false", 5);
+    }
+}
+
+void json_null(json_writer_t *w)
+{
+    begin_value(w);
+    if (w->format == JSON_FORMAT_CBOR)
+    {
+        put_char(w, (char)CBOR_NULL);
+        return;
+    }
+    put(w, "null", 4);
+}
+
+void json_raw(json_writer_t *w, const char *json, size_t len)
+{
+    begin_value(w);
+    put(w, json, len);
+}
+
+void json_kv_string(json_writer_t *w, const char *key, const char *text)
+{
+    json_key(w, key);
+    json_string(w, text);
+}
+
+void json_kv_int(json_writer_t *w, const char *key, int32_t value)
+{
+    json_key(w, key);
+    json_int(w, value);
+}
+
+void json_kv_uint(json_writer_t *w, const char *key, uint32_t value)
+{
+    json_key(w, key);
+    json_uint(w, value);
+}
+
+void json_kv_float(json_writer_t *w, const char *key, float value, uint8_t decimals)
+{
+    json_key(w, key);
+    json_float(w, value, decimals);
+}
+
+void json_kv_bool(json_writer_t *w, const char *key, bool value)
+{
+    json_key(w, key);
+    json_bool(w, value);
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static void put(json_writer_t *w, const char *data, size_t len)
+{
+    if (w->overflow || len > w->size - 1 - w->len)
+    {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, data, len);
+    w->len += len;
+}
+
+static void put_char(json_writer_t *w, char c)
+{
+    if (w->overflow || w->len + 1 >= w->size)
+    {
+        w->overflow = true;
+        return;
+    }
+    w->buf[w->len++] = c;
+}
+
+static void begin_value(json_writer_t *w)
+{
+    // Separates this value from the previous member or element
+    if (w->after_key)
+    {
+        w->after_key = false;
+        return;
+    }
+    if (w->format == JSON_FORMAT_CBOR)
+    {
+        return; // Items are self-delimiting
+    }
+
+    uint16_t bit = (uint16_t)(1u << w->depth);
+    if (w->has_items & bit)
+    {
+        put_char(w, ',');
+    }
+    w->has_items |= bit;
+}
+
+static void put_u64(json_writer_t *w, uint64_t value)
+{
+    char digits[20];
+    size_t n = sizeof(digits);
+    do
+    {
+        digits[--n] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    put(w, digits + n, sizeof(digits) - n);
+}
+
+static void put_escaped(json_writer_t *w, const char *text, size_t len)
+{
+    size_t run = 0; // Start of the pending run of characters that need no escaping
+
+    for (size_t i = 0; i < len; i++)
+    {
+        unsigned char c = (unsigned char)text[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue; // UTF-8 passes through unchanged
+        }
+
+        put(w, text + run, i - run);
+        run = i + 1;
+
+        char escape[6] = {'\\', 0, 0, 0, 0, 0};
+        size_t escape_len = 2;
+        switch (c)
+        {
+        case '"':
+            escape[1] = '"';
+            break;
+        case '\\':
+            escape[1] = '\\';
+            break;
+        case '\n':
+            escape[1] = 'n';
+            break;
+        case '\r':
+            escape[1] = 'r';
+            break;
+        case '\t':
+            escape[1] = 't';
+            break;
+        case '\b':
+            escape[1] = 'b';
+            break;
+        case '\f':
+            escape[1] = 'f';
+            break;
+        default:
+            escape[1] = 'u';
+            escape[2] = '0';
+            escape[3] = '0';
+            escape[4] = hex_digits[c >> 4];
+            escape[5] = hex_digits[c & 0x0F];
+            escape_len = 6;
+            break;
+        }
+        put(w, escape, escape_len);
+    }
+    put(w, text + run, len - run);
+}
+
+static size_t escaped_size(unsigned char c)
+{
+    if (c >= 0x20)
+    {
+        return (c == '"' || c == '\\') ? 2 : 1;
+    }
+    return (c == '\n' || c == '\r' || c == '\t' || c == '\b' || c == '\f') ? 2 : 6;
+}
+
+static void put_cbor_head(json_writer_t *w, uint8_t major, uint64_t value)
+{
+    // Initial byte carries the major type; small values fit in it directly
+    uint8_t initial = (uint8_t)(major << 5);
+    if (value < 24)
+    {
+        put_char(w, (char)(initial | value));
+    }
+    else if (value <= 0xFF)
+    {
+        put_be(w, initial | 24, value, 1);
+    }
+    else if (value <= 0xFFFF)
+    {
+        put_be(w, initial | 25, value, 2);
+    }
+    else if (value <= 0xFFFFFFFFu)
+    {
+        put_be(w, initial | 26, value, 4);
+    }
+    else
+    {
+        put_be(w, initial | 27, value, 8);
+    }
+}
+
+static size_t cbor_head_size(uint64_t value)
+{
+    return value < 24 ? 1 : value <= 0xFF ? 2 : value <= 0xFFFF ? 3 : value <= 0xFFFFFFFFu ? 5 : 9;
+}
+
+static void put_be(json_writer_t *w, uint8_t initial, uint64_t bits, size_t bytes)
+{
+    char out[9];
+    out[0] = (char)initial;
+    for (size_t i = 0; i < bytes; i++)
+    {
+        out[bytes - i] = (char)(bits >> (8 * i));
+    }
+    put(w, out, bytes + 1);
+}
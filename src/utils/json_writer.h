@@ -0,0 +1,204 @@
+/**
+ * @file json_writer.h
+ * @brief Zero-allocation streaming JSON writer
+ *
+ * Values are appended straight into a caller-owned buffer (typically the
+ * payload area of an outbound WebSocket frame) as they are produced, so a
+ * message never exists in an intermediate buffer. Commas, nesting and
+ * string escaping are handled by the writer; numbers are formatted without
+ * printf, and floats use fixed-point conversion instead of %f, which on the
+ * FPU-less RP2040 pulls in the soft-float printf path.
+ *
+ * Running out of room never produces a truncated document: the writer
+ * latches an overflow flag and json_writer_finish() returns 0.
+ *
+ * The writer is a plain struct; copying it is a cheap checkpoint, and
+ * assigning the copy back rewinds the output to that point.
+ *
+ * The same calls can emit CBOR (RFC 8949) instead of text, for WebSocket
+ * clients that negotiated the binary encoding: containers become
+ * indefinite-length maps/arrays, so nothing has to be counted up front,
+ * and floats are stored as IEEE single precision with no formatting at
+ * all.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#define JSON_WRITER_MAX_DEPTH 16 // Nested objects/arrays
+#define JSON_FLOAT_MAX_DECIMALS 6
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Output encodings
+     */
+    typedef enum
+    {
+        JSON_FORMAT_TEXT = 0, // JSON text
+        JSON_FORMAT_CBOR      // CBOR data items with the same structure
+    } json_format_t;
+
+    /**
+     * @brief Writer state (treat as opaque)
+     */
+    typedef struct
+    {
+        char *buf;
+        size_t size; // Capacity including the terminator
+        size_t len;
+        uint16_t has_items; // Bit per depth: container already holds a value
+        uint8_t depth;
+        uint8_t format; // json_format_t
+        bool after_key;
+        bool overflow;
+    } json_writer_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Start a document
+     * @param w Writer
+     * @param buf Output buffer
+     * @param size Buffer size; one byte is kept for the terminator
+     */
+    void json_writer_init(json_writer_t *w, char *buf, size_t size);
+
+    /**
+     * @brief Start a document in a given encoding
+     * @param w Writer
+     * @param buf Output buffer
+     * @param size Buffer size; one byte is kept for the terminator
+     * @param format Encoding of everything written
+     */
+    void json_writer_init_format(json_writer_t *w, char *buf, size_t size, json_format_t format);
+
+    /**
+     * @brief Complete the document
+     * @param w Writer
+     * @return Length without the terminator, 0 on overflow or unclosed containers
+     */
+    size_t json_writer_finish(json_writer_t *w);
+
+    /**
+     * @brief Check whether anything failed to fit so far
+     */
+    bool json_writer_overflowed(const json_writer_t *w);
+
+    /**
+     * @brief Hold back room at the end of the buffer
+     *
+     * For output that must still fit after a nested part written by someone
+     * else (e.g. an envelope's closing brackets after a command result).
+     * @param w Writer
+     * @param bytes Bytes to hold back until json_writer_release()
+     * @return false (and overflow) if that much room is not left
+     */
+    bool json_writer_reserve(json_writer_t *w, size_t bytes);
+
+    /**
+     * @brief Return room held back by json_writer_reserve()
+     */
+    void json_writer_release(json_writer_t *w, size_t bytes);
+
+    void json_begin_object(json_writer_t *w);
+    void json_end_object(json_writer_t *w);
+    void json_begin_array(json_writer_t *w);
+    void json_end_array(json_writer_t *w);
+
+    /**
+     * @brief Write an object key; the next call writes its value
+     * @param w Writer
+     * @param key Key (escaped like any string)
+     */
+    void json_key(json_writer_t *w, const char *key);
+
+    /**
+     * @brief Write a string value with JSON escaping
+     * @param w Writer
+     * @param text NUL terminated text; NULL writes null
+     */
+    void json_string(json_writer_t *w, const char *text);
+
+    /**
+     * @brief Write the first len bytes of text as a string value
+     */
+    void json_string_n(json_writer_t *w, const char *text, size_t len);
+
+    /**
+     * @brief Write as much of text as fits, leaving room for what follows
+     *
+     * Cuts on a UTF-8 character boundary so the string stays valid; use
+     * for free text such as log messages that should be shortened rather
+     * than dropped.
+     * @param w Writer
+     * @param text Text
+     * @param len Text length in bytes
+     * @param reserve Bytes to keep free after the closing quote
+     * @return Bytes of text written; less than len if it was cut
+     */
+    size_t json_string_fit(json_writer_t *w, const char *text, size_t len, size_t reserve);
+
+    void json_int(json_writer_t *w, int32_t value);
+    void json_uint(json_writer_t *w, uint32_t value);
+    void json_uint64(json_writer_t *w, uint64_t value);
+
+    /**
+     * @brief Write a float with a fixed number of decimals
+     * @param w Writer
+     * @param value Value; NaN, infinities and magnitudes >= 1e18 become null
+     * @param decimals Digits after the point (0..JSON_FLOAT_MAX_DECIMALS); CBOR keeps full precision
+     */
+    void json_float(json_writer_t *w, float value, uint8_t decimals);
+
+    /**
+     * @brief Write a number given as JSON text, e.g. echoed from a request
+     * @param w Writer
+     * @param text Number text (already validated by the reader)
+     * @param len Length in bytes
+     */
+    void json_number(json_writer_t *w, const char *text, size_t len);
+
+    void json_bool(json_writer_t *w, bool value);
+    void json_null(json_writer_t *w);
+
+    /**
+     * @brief Write an already encoded value verbatim
+     * @param w Writer
+     * @param json Value encoded in the writer's format
+     * @param len Length in bytes
+     */
+    void json_raw(json_writer_t *w, const char *json, size_t len);
+
+    // Key/value shorthands for object members
+    void json_kv_string(json_writer_t *w, const char *key, const char *text);
+    void json_kv_int(json_writer_t *w, const char *key, int32_t value);
+    void json_kv_uint(json_writer_t *w, const char *key, uint32_t value);
+    void json_kv_float(json_writer_t *w, const char *key, float value, uint8_t decimals);
+    void json_kv_bool(json_writer_t *w, const char *key, bool value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_WRITER_H
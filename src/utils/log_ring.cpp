@@ -0,0 +1,132 @@
+/**
+ * @file log_ring.cpp
+ * @brief Overwriting byte ring with independent reader cursors
+ */
+
+#include "log_ring.h"
+
+#include <string.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+
+#define LOG_RING_MASK (LOG_RING_SIZE - 1u)
+#define LOG_RING_READ_ATTEMPTS 3 // Reads overtaken this often in a row give up until next call
+
+// =============================================================================
+// PRIVATE VARIABLES
+// =============================================================================
+
+static char ring[LOG_RING_SIZE];
+static volatile uint32_t ring_head = 0; // Bytes written since boot
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static void skip_overwritten(log_ring_reader_t *reader, uint32_t head);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+void log_ring_write(const char *data, size_t len)
+{
+    if (data == NULL || len == 0)
+    {
+        return;
+    }
+
+    uint32_t head = ring_head;
+    if (len > LOG_RING_SIZE)
+    {
+        // Only the tail survives anyway; readers see the rest as lost
+        head += (uint32_t)(len - LOG_RING_SIZE);
+        data += len - LOG_RING_SIZE;
+        len = LOG_RING_SIZE;
+    }
+
+    size_t offset = head & LOG_RING_MASK;
+    size_t first = LOG_RING_SIZE - offset;
+    if (first > len)
+    {
+        first = len;
+    }
+    memcpy(ring + offset, data, first);
+    memcpy(ring, data + first, len - first);
+
+    // Publish the bytes only after they are in place
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    ring_head = head + (uint32_t)len;
+}
+
+void log_ring_reader_init(log_ring_reader_t *reader)
+{
+    reader->cursor = ring_head;
+    reader->lost = 0;
+}
+
+size_t log_ring_available(const log_ring_reader_t *reader)
+{
+    uint32_t pending = ring_head - reader->cursor;
+    return pending > LOG_RING_SIZE ? LOG_RING_SIZE : pending;
+}
+
+size_t log_ring_read(log_ring_reader_t *reader, char *out, size_t max)
+{
+    for (int attempt = 0; attempt < LOG_RING_READ_ATTEMPTS; attempt++)
+    {
+        uint32_t head = ring_head;
+        skip_overwritten(reader, head);
+
+        size_t len = head - reader->cursor;
+        if (len > max)
+        {
+            len = max;
+        }
+        if (len == 0)
+        {
+            return 0;
+        }
+
+        size_t offset = reader->cursor & LOG_RING_MASK;
+        size_t first = LOG_RING_SIZE - offset;
+        if (first > len)
+        {
+            first = len;
+        }
+        memcpy(out, ring + offset, first);
+        memcpy(out + first, ring, len - first);
+
+        // A write that landed during the copy may have reused the start of it
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        if (ring_head - reader->cursor <= LOG_RING_SIZE)
+        {
+            reader->cursor += (uint32_t)len;
+            return len;
+        }
+    }
+    return 0;
+}
+
+uint32_t log_ring_total(void)
+{
+    return ring_head;
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static void skip_overwritten(log_ring_reader_t *reader, uint32_t head)
+{
+    uint32_t behind = head - reader->cursor;
+    if (behind > LOG_RING_SIZE)
+    {
+        reader->lost += behind - LOG_RING_SIZE;
+        reader->cursor = head - LOG_RING_SIZE;
+    }
+}
@@ -0,0 +1,100 @@
+/**
+ * @file log_ring.h
+ * @brief Deferred log ring: console output kept for readers that drain it later
+ *
+ * Everything the firmware prints is appended to one fixed ring, and each
+ * remote console keeps its own read cursor into it. Writing never waits for
+ * a reader: the oldest bytes are overwritten, and a reader that fell more
+ * than LOG_RING_SIZE behind skips ahead and is told how much it lost. So a
+ * slow terminal costs only its own backlog, never the firmware's time.
+ *
+ * Cursors count bytes written since boot and are compared with unsigned
+ * wrap-around, so they stay valid after 4 GiB of output.
+ *
+ * Writes must not run concurrently with each other (Pico stdio serialises
+ * its drivers behind the print mutex). Reads may be interrupted by a write
+ * at any point; a read that was overtaken is discarded and retried.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 4096 // Bytes kept for lagging readers; must be a power of two
+#endif
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief One reader's position in the ring
+     */
+    typedef struct
+    {
+        uint32_t cursor; // Next byte to read
+        uint32_t lost;   // Bytes overwritten before this reader got to them, since last cleared
+    } log_ring_reader_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Append output, overwriting the oldest bytes if the ring is full
+     * @param data Bytes to append
+     * @param len Number of bytes; only the last LOG_RING_SIZE are kept
+     */
+    void log_ring_write(const char *data, size_t len);
+
+    /**
+     * @brief Start a reader at the current end, so it sees only new output
+     * @param reader Reader to initialise
+     */
+    void log_ring_reader_init(log_ring_reader_t *reader);
+
+    /**
+     * @brief Count bytes waiting for a reader
+     * @param reader Reader
+     * @return Unread bytes still in the ring
+     */
+    size_t log_ring_available(const log_ring_reader_t *reader);
+
+    /**
+     * @brief Copy the reader's next bytes out and advance it
+     *
+     * Bytes the reader missed are skipped and added to reader->lost.
+     * @param reader Reader
+     * @param out Destination buffer
+     * @param max Largest number of bytes to copy
+     * @return Bytes copied, 0 if there is nothing new
+     */
+    size_t log_ring_read(log_ring_reader_t *reader, char *out, size_t max);
+
+    /**
+     * @brief Total bytes written since boot (wraps at 4 GiB)
+     * @return Write cursor
+     */
+    uint32_t log_ring_total(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOG_RING_H
@@ -0,0 +1,172 @@
+/**
+ * @file sample_stream.cpp
+ * @brief UDP sample-block wire format implementation
+ */
+
+#include "sample_stream.h"
+
+#include <string.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+// A sequence number this far behind the expected one means the sender
+// restarted rather than a datagram arriving late
+#define SAMPLE_STREAM_RESTART_WINDOW 4096
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static inline void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static inline uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+size_t sample_stream_datagram_size(uint8_t channel_count, uint16_t frame_count)
+{
+    return SAMPLE_STREAM_HEADER_SIZE + (size_t)frame_count * channel_count * 2;
+}
+
+uint16_t sample_stream_frames_per_datagram(uint8_t channel_count, size_t max_datagram)
+{
+    if (channel_count == 0 || max_datagram <= SAMPLE_STREAM_HEADER_SIZE)
+    {
+        return 0;
+    }
+
+    size_t frames = (max_datagram - SAMPLE_STREAM_HEADER_SIZE) / ((size_t)channel_count * 2);
+    return frames > 0xFFFF ? 0xFFFF : (uint16_t)frames;
+}
+
+void sample_stream_write_header(const sample_stream_header_t *header, uint8_t *out)
+{
+    put_u16(out + 0, SAMPLE_STREAM_MAGIC);
+    out[2] = SAMPLE_STREAM_VERSION;
+    out[3] = header->channel_count;
+    put_u32(out + 4, header->sequence);
+    put_u32(out + 8, (uint32_t)header->timestamp_us);
+    put_u32(out + 12, (uint32_t)(header->timestamp_us >> 32));
+    put_u32(out + 16, header->first_sample);
+    put_u32(out + 20, header->sample_rate_hz);
+    put_u16(out + 24, header->frame_count);
+    put_u16(out + 26, header->flags);
+}
+
+void sample_stream_write_frame(uint8_t *payload, uint16_t frame, const uint16_t *samples, uint8_t channel_count)
+{
+    uint8_t *p = payload + (size_t)frame * channel_count * 2;
+
+    for (uint8_t ch = 0; ch < channel_count; ch++)
+    {
+        put_u16(p + ch * 2, samples[ch]);
+    }
+}
+
+bool sample_stream_parse(const uint8_t *data, size_t len, sample_stream_header_t *header, const uint8_t **payload)
+{
+    if (data == NULL || header == NULL || len < SAMPLE_STREAM_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    if (get_u16(data) != SAMPLE_STREAM_MAGIC || data[2] != SAMPLE_STREAM_VERSION)
+    {
+        return false;
+    }
+
+    header->version = data[2];
+    header->channel_count = data[3];
+    header->sequence = get_u32(data + 4);
+    header->timestamp_us = (uint64_t)get_u32(data + 8) | ((uint64_t)get_u32(data + 12) << 32);
+    header->first_sample = get_u32(data + 16);
+    header->sample_rate_hz = get_u32(data + 20);
+    header->frame_count = get_u16(data + 24);
+    header->flags = get_u16(data + 26);
+
+    if (header->channel_count == 0 || header->channel_count > SAMPLE_STREAM_MAX_CHANNELS ||
+        len != sample_stream_datagram_size(header->channel_count, header->frame_count))
+    {
+        return false;
+    }
+
+    if (payload)
+    {
+        *payload = data + SAMPLE_STREAM_HEADER_SIZE;
+    }
+    return true;
+}
+
+uint16_t sample_stream_get_sample(const uint8_t *payload, size_t index)
+{
+    return get_u16(payload + index * 2);
+}
+
+void sample_stream_tracker_init(sample_stream_tracker_t *tracker)
+{
+    memset(tracker, 0, sizeof(*tracker));
+}
+
+sample_stream_event_t sample_stream_track(sample_stream_tracker_t *tracker, const sample_stream_header_t *header)
+{
+    sample_stream_event_t event = SAMPLE_STREAM_IN_ORDER;
+    int32_t ahead = (int32_t)(header->sequence - tracker->next_sequence);
+
+    tracker->datagrams++;
+
+    if (!tracker->started)
+    {
+        tracker->started = true;
+    }
+    else if (ahead < 0)
+    {
+        if (header->sequence != 0 && -ahead < SAMPLE_STREAM_RESTART_WINDOW)
+        {
+            tracker->datagrams_late++;
+            return SAMPLE_STREAM_LATE;
+        }
+
+        tracker->restarts++;
+        event = SAMPLE_STREAM_RESTART;
+    }
+    else
+    {
+        int32_t missing = (int32_t)(header->first_sample - tracker->next_sample);
+
+        tracker->datagrams_lost += (uint32_t)ahead;
+        if (missing > 0)
+        {
+            tracker->samples_lost += (uint32_t)missing;
+        }
+        if (ahead > 0 || missing != 0)
+        {
+            event = SAMPLE_STREAM_GAP;
+        }
+    }
+
+    tracker->next_sequence = header->sequence + 1;
+    tracker->next_sample = header->first_sample + header->frame_count;
+    return event;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file sample_stream.h
+ * @brief Wire format for UDP sample-block datagrams
+ *
+ * Each datagram carries one block of consecutive ADC frames (one raw 12-bit
+ * count per channel per frame) behind a fixed 28-byte little-endian header.
+ * The sequence number counts datagrams so the receiver can spot loss and
+ * reordering; the first sample index counts frames since acquisition
+ * started so it can tell exactly which samples are missing. Shared by the
+ * firmware sender and the host capture tools.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef SAMPLE_STREAM_H
+#define SAMPLE_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#define SAMPLE_STREAM_MAGIC 0x5352 // "RS" on the wire
+#define SAMPLE_STREAM_VERSION 1
+#define SAMPLE_STREAM_HEADER_SIZE 28
+#define SAMPLE_STREAM_MAX_CHANNELS 8
+
+// Header flags
+#define SAMPLE_STREAM_FLAG_OVERRUN 0x0001 // Samples were dropped on the device before this block
+#define SAMPLE_STREAM_FLAG_HOST_TIME 0x0002 // timestamp_us is Unix time from the synced clock, not time since boot
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    /**
+     * @brief Decoded datagram header
+     *
+     * Wire layout (little-endian):
+     *   0  u16 magic          2  u8 version       3  u8 channel_count
+     *   4  u32 sequence       8  u64 timestamp_us (first frame)
+     *  16  u32 first_sample  20  u32 sample_rate_hz
+     *  24  u16 frame_count   26  u16 flags
+     *  28  u16 samples[frame_count][channel_count]
+     */
+    typedef struct
+    {
+        uint8_t version;
+        uint8_t channel_count;
+        uint32_t sequence;
+        uint64_t timestamp_us;
+        uint32_t first_sample;
+        uint32_t sample_rate_hz;
+        uint16_t frame_count;
+        uint16_t flags;
+    } sample_stream_header_t;
+
+    /**
+     * @brief What a received datagram means for the stream
+     */
+    typedef enum
+    {
+        SAMPLE_STREAM_IN_ORDER = 0, // Next expected datagram
+        SAMPLE_STREAM_GAP,          // Datagrams or samples were skipped
+        SAMPLE_STREAM_LATE,         // Older than expected: reordered or duplicate
+        SAMPLE_STREAM_RESTART       // Sender restarted its counters
+    } sample_stream_event_t;
+
+    /**
+     * @brief Receiver-side loss accounting
+     */
+    typedef struct
+    {
+        bool started;
+        uint32_t next_sequence;
+        uint32_t next_sample;
+        uint32_t datagrams;
+        uint32_t datagrams_lost;
+        uint32_t datagrams_late;
+        uint64_t samples_lost; // Frames missing between blocks
+        uint32_t restarts;
+    } sample_stream_tracker_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Datagram size for a block
+     * @param channel_count Channels per frame
+     * @param frame_count Frames in the block
+     * @return Header plus payload bytes
+     */
+    size_t sample_stream_datagram_size(uint8_t channel_count, uint16_t frame_count);
+
+    /**
+     * @brief Frames that fit in a datagram of a given size
+     * @param channel_count Channels per frame
+     * @param max_datagram Largest datagram to produce
+     * @return Frame capacity, 0 if not even the header fits
+     */
+    uint16_t sample_stream_frames_per_datagram(uint8_t channel_count, size_t max_datagram);
+
+    /**
+     * @brief Serialize a header
+     * @param header Header to write (frame_count and channel_count must match the payload)
+     * @param out Buffer of at least SAMPLE_STREAM_HEADER_SIZE bytes
+     */
+    void sample_stream_write_header(const sample_stream_header_t *header, uint8_t *out);
+
+    /**
+     * @brief Serialize one frame of samples into a block payload
+     * @param payload Payload start (datagram + SAMPLE_STREAM_HEADER_SIZE)
+     * @param frame Frame index within the block
+     * @param samples One count per channel
+     * @param channel_count Channels per frame
+     */
+    void sample_stream_write_frame(uint8_t *payload, uint16_t frame, const uint16_t *samples, uint8_t channel_count);
+
+    /**
+     * @brief Validate and decode a received datagram
+     * @param data Datagram bytes
+     * @param len Datagram length
+     * @param header Receives the decoded header
+     * @param payload Receives a pointer to the first sample (may be NULL)
+     * @return true if the magic, version and length are consistent
+     */
+    bool sample_stream_parse(const uint8_t *data, size_t len, sample_stream_header_t *header, const uint8_t **payload);
+
+    /**
+     * @brief Read one sample from a parsed payload
+     * @param payload Payload pointer from sample_stream_parse()
+     * @param index Frame * channel_count + channel
+     * @return Raw sample count
+     */
+    uint16_t sample_stream_get_sample(const uint8_t *payload, size_t index);
+
+    /**
+     * @brief Reset loss accounting
+     * @param tracker Tracker to reset
+     */
+    void sample_stream_tracker_init(sample_stream_tracker_t *tracker);
+
+    /**
+     * @brief Account for a received datagram
+     * @param tracker Tracker state
+     * @param header Header of the datagram
+     * @return How the datagram relates to the ones seen before
+     */
+    sample_stream_event_t sample_stream_track(sample_stream_tracker_t *tracker, const sample_stream_header_t *header);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SAMPLE_STREAM_H
@@ -0,0 +1,158 @@
+/**
+ * @file sha1.cpp
+ * @brief Compact SHA-1 implementation
+ */
+
+#include "sha1.h"
+
+#include <string.h>
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static inline uint32_t rol32(uint32_t value, unsigned bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static void sha1_compress(uint32_t h[5], const uint8_t block[SHA1_BLOCK_SIZE])
+{
+    uint32_t w[16];
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+
+    for (int i = 0; i < 16; i++)
+    {
+        w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+               ((uint32_t)block[i * 4 + 2] << 8) | (uint32_t)block[i * 4 + 3];
+    }
+
+    for (int t = 0; t < 80; t++)
+    {
+        // Rolling schedule: W[t] replaces W[t-16] in place
+        if (t >= 16)
+        {
+            w[t & 15] = rol32(w[(t + 13) & 15] ^ w[(t + 8) & 15] ^ w[(t + 2) & 15] ^ w[t & 15], 1);
+        }
+
+        uint32_t f, k;
+        if (t < 20)
+        {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        }
+        else if (t < 40)
+        {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        }
+        else if (t < 60)
+        {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        }
+        else
+        {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+
+        uint32_t temp = rol32(a, 5) + f + e + k + w[t & 15];
+        e = d;
+        d = c;
+        c = rol32(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+}
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+void sha1_init(sha1_ctx_t *ctx)
+{
+    ctx->h[0] = 0x67452301;
+    ctx->h[1] = 0xEFCDAB89;
+    ctx->h[2] = 0x98BADCFE;
+    ctx->h[3] = 0x10325476;
+    ctx->h[4] = 0xC3D2E1F0;
+    ctx->length = 0;
+    ctx->block_len = 0;
+}
+
+void sha1_update(sha1_ctx_t *ctx, const void *data, size_t len)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    ctx->length += len;
+
+    while (len > 0)
+    {
+        // Whole blocks are compressed straight from the caller's buffer
+        if (ctx->block_len == 0 && len >= SHA1_BLOCK_SIZE)
+        {
+            sha1_compress(ctx->h, bytes);
+            bytes += SHA1_BLOCK_SIZE;
+            len -= SHA1_BLOCK_SIZE;
+            continue;
+        }
+
+        size_t take = SHA1_BLOCK_SIZE - ctx->block_len;
+        if (take > len)
+        {
+            take = len;
+        }
+        memcpy(ctx->block + ctx->block_len, bytes, take);
+        ctx->block_len += (uint8_t)take;
+        bytes += take;
+        len -= take;
+
+        if (ctx->block_len == SHA1_BLOCK_SIZE)
+        {
+            sha1_compress(ctx->h, ctx->block);
+            ctx->block_len = 0;
+        }
+    }
+}
+
+void sha1_final(sha1_ctx_t *ctx, uint8_t digest[SHA1_DIGEST_SIZE])
+{
+    uint64_t bit_length = ctx->length * 8;
+
+    // Padding: 0x80, zeros, then the 64-bit big-endian message length
+    ctx->block[ctx->block_len++] = 0x80;
+    if (ctx->block_len > SHA1_BLOCK_SIZE - 8)
+    {
+        memset(ctx->block + ctx->block_len, 0, SHA1_BLOCK_SIZE - ctx->block_len);
+        sha1_compress(ctx->h, ctx->block);
+        ctx->block_len = 0;
+    }
+    memset(ctx->block + ctx->block_len, 0, SHA1_BLOCK_SIZE - 8 - ctx->block_len);
+    for (int i = 0; i < 8; i++)
+    {
+        ctx->block[SHA1_BLOCK_SIZE - 1 - i] = (uint8_t)(bit_length >> (i * 8));
+    }
+    sha1_compress(ctx->h, ctx->block);
+
+    for (int i = 0; i < 5; i++)
+    {
+        digest[i * 4] = (uint8_t)(ctx->h[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(ctx->h[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(ctx->h[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)ctx->h[i];
+    }
+}
+
+void sha1(const void *data, size_t len, uint8_t digest[SHA1_DIGEST_SIZE])
+{
+    sha1_ctx_t ctx;
+    sha1_init(&ctx);
+    sha1_update(&ctx, data, len);
+    sha1_final(&ctx, digest);
+}
@@ -0,0 +1,72 @@
+/**
+ * @file sha1.h
+ * @brief Compact SHA-1 (FIPS 180-4) for protocol handshakes
+ *
+ * Used for the WebSocket Sec-WebSocket-Accept key, not for security. The
+ * implementation keeps a 16-word rolling message schedule and computes the
+ * round constants inline, so it needs no lookup tables and about 100 bytes
+ * of state.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef SHA1_H
+#define SHA1_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SHA1_DIGEST_SIZE 20
+#define SHA1_BLOCK_SIZE 64
+
+    /**
+     * @brief Streaming SHA-1 state
+     */
+    typedef struct
+    {
+        uint32_t h[5];
+        uint64_t length; // Total bytes hashed
+        uint8_t block[SHA1_BLOCK_SIZE];
+        uint8_t block_len;
+    } sha1_ctx_t;
+
+    /**
+     * @brief Start a new digest
+     * @param ctx Context to initialize
+     */
+    void sha1_init(sha1_ctx_t *ctx);
+
+    /**
+     * @brief Add data to the digest
+     * @param ctx Context
+     * @param data Bytes to hash
+     * @param len Number of bytes
+     */
+    void sha1_update(sha1_ctx_t *ctx, const void *data, size_t len);
+
+    /**
+     * @brief Finish the digest
+     * @param ctx Context (must be re-initialized before reuse)
+     * @param digest Receives the 20-byte digest
+     */
+    void sha1_final(sha1_ctx_t *ctx, uint8_t digest[SHA1_DIGEST_SIZE]);
+
+    /**
+     * @brief One-shot digest of a buffer
+     * @param data Bytes to hash
+     * @param len Number of bytes
+     * @param digest Receives the 20-byte digest
+     */
+    void sha1(const void *data, size_t len, uint8_t digest[SHA1_DIGEST_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SHA1_H
@@ -0,0 +1,150 @@
+/**
+ * @file text_cache.cpp
+ * @brief On-screen string cache implementation
+ */
+
+#include "text_cache.h"
+
+#include <string.h>
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static bool overlaps(const text_cache_t *cache, const text_cache_entry_t *e, int x, int y, int width, int height)
+{
+    int ex1 = e->x + e->length * cache->cell_width;
+    int ey1 = e->y + cache->cell_height;
+    return e->x < x + width && x < ex1 && e->y < y + height && y < ey1;
+}
+
+/**
+ * @brief Entry for a position: the one there, else a free or the least recently used one
+ */
+static text_cache_entry_t *slot_for(text_cache_t *cache, int x, int y, bool *found)
+{
+    text_cache_entry_t *slot = NULL;
+    for (text_cache_entry_t *e = cache->entries; e < cache->entries + TEXT_CACHE_ENTRIES; e++)
+    {
+        if (e->used && e->x == x && e->y == y)
+        {
+            *found = true;
+            return e;
+        }
+        if (slot == NULL || (slot->used && (!e->used || e->last_used < slot->last_used)))
+        {
+            slot = e;
+        }
+    }
+    *found = false;
+    return slot;
+}
+
+// =============================================================================
+// PUBLIC FUNCTIONS
+// =============================================================================
+
+void text_cache_init(text_cache_t *cache, uint8_t cell_width, uint8_t cell_height)
+{
+    memset(cache, 0, sizeof(*cache));
+    cache->cell_width = cell_width;
+    cache->cell_height = cell_height;
+}
+
+bool text_cache_update(text_cache_t *cache, int x, int y, const char *text, uint16_t fg, uint16_t bg,
+                       text_cache_change_t *change)
+{
+    size_t length = strlen(text);
+    bool found;
+    text_cache_entry_t *entry = slot_for(cache, x, y, &found);
+
+    bool same_colors = found && entry->fg == fg && entry->bg == bg;
+    change->first = 0;
+    change->count = (uint16_t)length;
+    change->erase = (uint16_t)(found && entry->length > length ? entry->length - length : 0);
+
+    if (same_colors)
+    {
+        // Paint from the first difference to the last
+        size_t common = length < entry->length ? length : entry->length;
+        size_t first = 0;
+        while (first < common && text[first] == entry->text[first])
+        {
+            first++;
+        }
+        size_t last = length;
+        while (last > first && last <= entry->length && text[last - 1] == entry->text[last - 1])
+        {
+            last--;
+        }
+        change->first = (uint16_t)first;
+        change->count = (uint16_t)(last - first);
+    }
+
+    // Strings the new one is drawn over are gone, whether or not it can be cached
+    for (text_cache_entry_t *e = cache->entries; e < cache->entries + TEXT_CACHE_ENTRIES; e++)
+    {
+        if (e->used && !(found && e == entry) &&
+            overlaps(cache, e, x, y, (int)length * cache->cell_width, cache->cell_height))
+        {
+            e->used = false;
+        }
+    }
+
+    if (length > TEXT_CACHE_MAX_LENGTH)
+    {
+        // Drawn in full every time
+        change->first = 0;
+        change->count = (uint16_t)length;
+        if (found)
+        {
+            entry->used = false;
+        }
+        cache->full++;
+        return true;
+    }
+
+    if (same_colors)
+    {
+        if (change->count == 0 && change->erase == 0)
+        {
+            entry->last_used = ++cache->clock;
+            cache->unchanged++;
+            return false;
+        }
+        cache->partial++;
+    }
+    else
+    {
+        cache->full++;
+    }
+
+    entry->used = true;
+    entry->x = (int16_t)x;
+    entry->y = (int16_t)y;
+    entry->fg = fg;
+    entry->bg = bg;
+    entry->length = (uint8_t)length;
+    memcpy(entry->text, text, length);
+    entry->last_used = ++cache->clock;
+    return true;
+}
+
+void text_cache_invalidate(text_cache_t *cache, int x, int y, int width, int height)
+{
+    for (text_cache_entry_t *e = cache->entries; e < cache->entries + TEXT_CACHE_ENTRIES; e++)
+    {
+        if (e->used && overlaps(cache, e, x, y, width, height))
+        {
+            e->used = false;
+        }
+    }
+}
+
+void text_cache_clear(text_cache_t *cache)
+{
+    for (text_cache_entry_t *e = cache->entries; e < cache->entries + TEXT_CACHE_ENTRIES; e++)
+    {
+        e->used = false;
+    }
+}
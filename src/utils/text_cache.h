@@ -0,0 +1,117 @@
+/**
+ * @file text_cache.h
+ * @brief Cache of the strings on screen, so redrawn text costs only what changed
+ *
+ * Remembers the last string drawn at each position, with its colours. A
+ * draw of the same string is skipped outright; a different string at the
+ * same place is cut down to the characters that differ, plus clearing the
+ * cells an older, longer string leaves behind. Status lines that change a
+ * number each refresh then repaint only that number's cells.
+ *
+ * The cache only knows what was drawn through it: anything else drawn over
+ * a cached string has to be reported with text_cache_invalidate() (the
+ * display HAL does this for every other drawing call), or the screen and
+ * the cache disagree.
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // =============================================================================
+    // CONSTANTS
+    // =============================================================================
+
+#define TEXT_CACHE_ENTRIES 16    // Strings remembered; the least recently drawn goes first
+#define TEXT_CACHE_MAX_LENGTH 40 // Longer strings are drawn in full every time
+
+    // =============================================================================
+    // TYPE DEFINITIONS
+    // =============================================================================
+
+    typedef struct
+    {
+        bool used;
+        uint8_t length;
+        int16_t x;
+        int16_t y;
+        uint16_t fg;
+        uint16_t bg;
+        uint32_t last_used;
+        char text[TEXT_CACHE_MAX_LENGTH];
+    } text_cache_entry_t;
+
+    typedef struct
+    {
+        text_cache_entry_t entries[TEXT_CACHE_ENTRIES];
+        uint8_t cell_width;
+        uint8_t cell_height;
+        uint32_t clock;
+
+        uint32_t unchanged; // Draws skipped: the string was on screen already
+        uint32_t partial;   // Draws cut down to the characters that changed
+        uint32_t full;      // Draws done in full
+    } text_cache_t;
+
+    /**
+     * @brief What a draw has to paint
+     */
+    typedef struct
+    {
+        uint16_t first; // First character of the new string to draw
+        uint16_t count; // Characters to draw from there
+        uint16_t erase; // Cells after the new string to clear to its background
+    } text_cache_change_t;
+
+    // =============================================================================
+    // PUBLIC FUNCTION DECLARATIONS
+    // =============================================================================
+
+    /**
+     * @brief Start empty
+     * @param cache Cache
+     * @param cell_width Character cell of the font strings are drawn in
+     * @param cell_height
+     */
+    void text_cache_init(text_cache_t *cache, uint8_t cell_width, uint8_t cell_height);
+
+    /**
+     * @brief Record a string about to be drawn and work out what of it has to be
+     * @param cache Cache
+     * @param x Left edge
+     * @param y Top edge
+     * @param text NUL-terminated string
+     * @param fg Glyph colour
+     * @param bg Cell background colour
+     * @param change Receives what to paint
+     * @return false if the screen shows exactly this already
+     */
+    bool text_cache_update(text_cache_t *cache, int x, int y, const char *text, uint16_t fg, uint16_t bg,
+                           text_cache_change_t *change);
+
+    /**
+     * @brief Forget the strings an area overlaps (it was drawn over, or a draw into it failed)
+     */
+    void text_cache_invalidate(text_cache_t *cache, int x, int y, int width, int height);
+
+    /**
+     * @brief Forget every string
+     */
+    void text_cache_clear(text_cache_t *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEXT_CACHE_H
@@ -0,0 +1,218 @@
+/**
+ * @file websocket_handshake.cpp
+ * @brief WebSocket opening handshake helpers implementation
+ */
+
+#include "websocket_handshake.h"
+#include "sha1.h"
+#include "base64.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+static const char websocket_guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+#define WEBSOCKET_KEY_LEN 24 // Base64 of a 16-byte nonce
+
+#define DEFLATE_EXTENSION "permessage-deflate"
+
+// permessage-deflate parameters, one bit each to catch duplicates
+#define DEFLATE_PARAM_SERVER_NO_CONTEXT 0x01
+#define DEFLATE_PARAM_CLIENT_NO_CONTEXT 0x02
+#define DEFLATE_PARAM_SERVER_WINDOW 0x04
+#define DEFLATE_PARAM_CLIENT_WINDOW 0x08
+
+// =============================================================================
+// PRIVATE FUNCTION DECLARATIONS
+// =============================================================================
+
+static bool accept_deflate_offer(const char *p, const char *end, uint8_t window_bits, bool *no_context_takeover);
+static void trim(const char **start, const char **end);
+static bool span_is(const char *start, const char *end, const char *text);
+static int parse_window_bits(const char *start, const char *end);
+
+// =============================================================================
+// PUBLIC FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+bool websocket_compute_accept(const char *client_key, char *accept, size_t size)
+{
+    if (client_key == NULL || accept == NULL || size < WEBSOCKET_ACCEPT_SIZE ||
+        strlen(client_key) != WEBSOCKET_KEY_LEN)
+    {
+        return false;
+    }
+
+    // accept = base64(sha1(key + GUID)), hashed in two pieces to avoid a concat buffer
+    uint8_t digest[SHA1_DIGEST_SIZE];
+    sha1_ctx_t ctx;
+    sha1_init(&ctx);
+    sha1_update(&ctx, client_key, WEBSOCKET_KEY_LEN);
+    sha1_update(&ctx, websocket_guid, sizeof(websocket_guid) - 1);
+    sha1_final(&ctx, digest);
+
+    return base64_encode(digest, sizeof(digest), accept, size) == WEBSOCKET_ACCEPT_SIZE - 1;
+}
+
+bool websocket_negotiate_deflate(const char *extensions, uint8_t window_bits, char *response, size_t size,
+                                 bool *no_context_takeover)
+{
+    if (extensions == NULL || response == NULL || no_context_takeover == NULL)
+    {
+        return false;
+    }
+
+    // Offers are listed in the client's order of preference
+    const char *p = extensions;
+    while (*p)
+    {
+        const char *end = strchr(p, ',');
+        if (end == NULL)
+        {
+            end = p + strlen(p);
+        }
+
+        bool reset = false;
+        if (accept_deflate_offer(p, end, window_bits, &reset))
+        {
+            int len = snprintf(response, size,
+                               DEFLATE_EXTENSION "; server_max_window_bits=%u; client_no_context_takeover%s",
+                               (unsigned)window_bits, reset ? "; server_no_context_takeover" : "");
+            *no_context_takeover = reset;
+            return len > 0 && (size_t)len < size;
+        }
+
+        p = *end ? end + 1 : end;
+    }
+
+    return false;
+}
+
+// =============================================================================
+// PRIVATE FUNCTION IMPLEMENTATIONS
+// =============================================================================
+
+static bool accept_deflate_offer(const char *p, const char *end, uint8_t window_bits, bool *no_context_takeover)
+{
+    // name *( ";" param [ "=" value ] ); the first element is the extension name
+    unsigned seen = 0;
+    bool named = false;
+
+    while (p < end)
+    {
+        const char *stop = (const char *)memchr(p, ';', (size_t)(end - p));
+        if (stop == NULL)
+        {
+            stop = end;
+        }
+
+        const char *name = p;
+        const char *name_end = stop;
+        const char *value = (const char *)memchr(p, '=', (size_t)(stop - p));
+        const char *value_end = stop;
+        if (value != NULL)
+        {
+            name_end = value++;
+            trim(&value, &value_end);
+            if (value_end - value >= 2 && *value == '"' && value_end[-1] == '"')
+            {
+                value++;
+                value_end--;
+            }
+        }
+        trim(&name, &name_end);
+
+        unsigned param;
+        if (!named)
+        {
+            if (value != NULL || !span_is(name, name_end, DEFLATE_EXTENSION))
+            {
+                return false;
+            }
+            named = true;
+            param = 0;
+        }
+        else if (span_is(name, name_end, "server_no_context_takeover") && value == NULL)
+        {
+            param = DEFLATE_PARAM_SERVER_NO_CONTEXT;
+            *no_context_takeover = true;
+        }
+        else if (span_is(name, name_end, "client_no_context_takeover") && value == NULL)
+        {
+            param = DEFLATE_PARAM_CLIENT_NO_CONTEXT;
+        }
+        else if (span_is(name, name_end, "server_max_window_bits") && value != NULL)
+        {
+            // The client may cap our window, but not below what we compress with
+            param = DEFLATE_PARAM_SERVER_WINDOW;
+            if (parse_window_bits(value, value_end) < window_bits)
+            {
+                return false;
+            }
+        }
+        else if (span_is(name, name_end, "client_max_window_bits"))
+        {
+            // Only tells us the client could use a smaller window; ours needs none
+            param = DEFLATE_PARAM_CLIENT_WINDOW;
+            if (value != NULL && parse_window_bits(value, value_end) < 0)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+
+        if (seen & param)
+        {
+            return false;
+        }
+        seen |= param;
+        p = stop + 1;
+    }
+
+    return named;
+}
+
+static void trim(const char **start, const char **end)
+{
+    while (*start < *end && (**start == ' ' || **start == '\t'))
+    {
+        (*start)++;
+    }
+    while (*end > *start && ((*end)[-1] == ' ' || (*end)[-1] == '\t'))
+    {
+        (*end)--;
+    }
+}
+
+static bool span_is(const char *start, const char *end, const char *text)
+{
+    size_t len = strlen(text);
+    return (size_t)(end - start) == len && strncasecmp(start, text, len) == 0;
+}
+
+static int parse_window_bits(const char *start, const char *end)
+{
+    // 8..15 without leading zeros (RFC 7692 section 7.1.2)
+    int bits = 0;
+    if (start == end || (*start == '0') || end - start > 2)
+    {
+        return -1;
+    }
+    for (const char *p = start; p < end; p++)
+    {
+        if (*p < '0' || *p > '9')
+        {
+            return -1;
+        }
+        bits = bits * 10 + (*p - '0');
+    }
+    return bits >= 8 && bits <= 15 ? bits : -1;
+}
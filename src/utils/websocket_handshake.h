@@ -0,0 +1,60 @@
+/**
+ * @file websocket_handshake.h
+ * @brief WebSocket opening handshake helpers (RFC 6455 section 4.2.2)
+ *
+ * @author Multi-Channel Diagnostic Test Rig Team
+ * @date 2025
+ */
+
+#ifndef WEBSOCKET_HANDSHAKE_H
+#define WEBSOCKET_HANDSHAKE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Sec-WebSocket-Accept length including the terminator
+ */
+#define WEBSOCKET_ACCEPT_SIZE 29
+
+    /**
+     * @brief Compute the Sec-WebSocket-Accept value for a client key
+     * @param client_key Sec-WebSocket-Key request header value
+     * @param accept Output buffer for the Base64 accept token
+     * @param size Output buffer size (at least WEBSOCKET_ACCEPT_SIZE)
+     * @return true on success, false if the key is not 24 Base64 characters
+     *         or the buffer is too small
+     */
+    bool websocket_compute_accept(const char *client_key, char *accept, size_t size);
+
+    /**
+     * @brief Accept the first usable permessage-deflate offer (RFC 7692)
+     *
+     * The response always limits the server window to window_bits and asks
+     * the client to compress every message on its own
+     * (client_no_context_takeover), so the server never has to keep a
+     * window for inbound messages. Offers with unknown or duplicate
+     * parameters, or a server window smaller than window_bits, are passed
+     * over.
+     * @param extensions Sec-WebSocket-Extensions request header (may be NULL)
+     * @param window_bits Server window this end compresses with (8..15)
+     * @param response Output buffer for the Sec-WebSocket-Extensions response value
+     * @param size Output buffer size
+     * @param no_context_takeover Receives whether the client asked the server to
+     *        start every message from an empty window
+     * @return true if an offer was accepted and the response fitted
+     */
+    bool websocket_negotiate_deflate(const char *extensions, uint8_t window_bits, char *response, size_t size,
+                                     bool *no_context_takeover);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEBSOCKET_HANDSHAKE_H
@@ -0,0 +1,170 @@
+/**
+ * @file cbor_bench.cpp
+ * @brief Host benchmark comparing the JSON text and CBOR encodings
+ *
+ * Writes the structured WebSocket messages through the same json_writer
+ * calls in both formats, checks that each CBOR message converts back to
+ * the text form, then reports encoded size and encode time. Float-heavy
+ * messages are where CBOR gains most: floats are stored, not formatted.
+ */
+
+#include "json_writer.h"
+#include "cbor_json.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+typedef void (*message_fn)(json_writer_t *w, int i);
+
+static bool check(const char *what, bool ok)
+{
+    printf("  %s: %s\n", what, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static void write_channel(json_writer_t *w, int i)
+{
+    json_begin_object(w);
+    json_kv_string(w, "type", "channel_data");
+    json_kv_int(w, "channel", (i & 3) + 1);
+    json_kv_float(w, "voltage", 12.0f + (float)(i & 255) * 0.01f, 2);
+    json_kv_float(w, "current", 0.5f, 3);
+    json_end_object(w);
+}
+
+static void write_status(json_writer_t *w, int i)
+{
+    json_begin_object(w);
+    json_kv_string(w, "type", "status");
+    json_kv_uint(w, "uptime", 123456u + (uint32_t)i);
+    json_kv_float(w, "temperature", 31.25f, 1);
+    json_kv_uint(w, "free_heap", 98304);
+    json_key(w, "channels");
+    json_begin_array(w);
+    for (int ch = 0; ch < 4; ch++)
+    {
+        json_begin_object(w);
+        json_kv_bool(w, "enabled", ch != 2);
+        json_kv_float(w, "voltage", 3.3f + (float)ch, 3);
+        json_kv_float(w, "current", 0.125f * (float)ch, 3);
+        json_end_object(w);
+    }
+    json_end_array(w);
+    json_end_object(w);
+}
+
+static void write_perf(json_writer_t *w, int i)
+{
+    json_begin_object(w);
+    json_kv_string(w, "type", "perf");
+    json_key(w, "loop_us");
+    json_begin_object(w);
+    json_kv_uint(w, "min", 12);
+    json_kv_uint(w, "avg", 48 + (uint32_t)(i & 7));
+    json_kv_uint(w, "max", 1875);
+    json_end_object(w);
+    json_kv_float(w, "cpu_load", 0.375f, 3);
+    json_kv_uint(w, "tcp_pbufs_free", 14);
+    json_kv_uint(w, "ws_tx_bytes", 4123456);
+    json_end_object(w);
+}
+
+static void write_log(json_writer_t *w, int)
+{
+    json_begin_object(w);
+    json_kv_string(w, "type", "log");
+    json_kv_string(w, "level", "WARN");
+    json_kv_string(w, "category", "SAFETY");
+    json_kv_string(w, "message", "Channel 3 over-current: \"limit\" 1.250 A\treset in 5 s");
+    json_end_object(w);
+}
+
+static size_t encode(message_fn fn, json_format_t format, char *buf, size_t size, int i)
+{
+    json_writer_t w;
+    json_writer_init_format(&w, buf, size, format);
+    fn(&w, i);
+    return json_writer_finish(&w);
+}
+
+template <typename F>
+static double time_ns(int iterations, F &&body)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        body(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+int main()
+{
+    static const struct
+    {
+        const char *name;
+        message_fn fn;
+        bool exact; // No floats, so CBOR converts back to identical text
+    } messages[] = {
+        {"channel_data", write_channel, false},
+        {"status", write_status, false},
+        {"perf", write_perf, false},
+        {"log", write_log, true},
+    };
+
+    char text[512];
+    char cbor[512];
+    char back[512];
+    bool ok = true;
+
+    printf("Correctness\n");
+    for (const auto &m : messages)
+    {
+        size_t text_len = encode(m.fn, JSON_FORMAT_TEXT, text, sizeof(text), 0);
+        size_t cbor_len = encode(m.fn, JSON_FORMAT_CBOR, cbor, sizeof(cbor), 0);
+        size_t back_len = cbor_to_json((const uint8_t *)cbor, cbor_len, back, sizeof(back));
+        bool same = m.exact ? (back_len == text_len && memcmp(back, text, text_len) == 0) : back_len > 0;
+        ok &= check(m.name, text_len > 0 && cbor_len > 0 && same);
+    }
+    ok &= check("overflow", encode(write_status, JSON_FORMAT_CBOR, cbor, 64, 0) == 0);
+    ok &= check("trailing bytes rejected", cbor_to_json((const uint8_t *)"\xF5\xF5", 2, back, sizeof(back)) == 0);
+
+    if (!ok)
+    {
+        return 1;
+    }
+
+    const int iterations = 1000000;
+    unsigned sink = 0;
+
+    printf("\nBenchmark (%d iterations)\n", iterations);
+    printf("  %-14s %10s %10s %10s %10s\n", "message", "json B", "cbor B", "json ns", "cbor ns");
+    for (const auto &m : messages)
+    {
+        size_t text_len = encode(m.fn, JSON_FORMAT_TEXT, text, sizeof(text), 0);
+        size_t cbor_len = encode(m.fn, JSON_FORMAT_CBOR, cbor, sizeof(cbor), 0);
+        double text_ns = time_ns(iterations, [&](int i) {
+            sink += (unsigned)encode(m.fn, JSON_FORMAT_TEXT, text, sizeof(text), i);
+        });
+        double cbor_ns = time_ns(iterations, [&](int i) {
+            sink += (unsigned)encode(m.fn, JSON_FORMAT_CBOR, cbor, sizeof(cbor), i);
+        });
+        printf("  %-14s %10zu %10zu %10.0f %10.0f\n", m.name, text_len, cbor_len, text_ns, cbor_ns);
+    }
+
+    // Inbound direction: a CBOR command converted to text for the registry
+    static const uint8_t command[] = {0xA3, 0x64, 't',  'y',  'p',  'e',  0x67, 'c',  'o',  'm',  'm',  'a',
+                                      'n',  'd',  0x67, 'c',  'o',  'm',  'm',  'a',  'n',  'd',  0x6A, 'G',
+                                      'E',  'T',  '_',  'S',  'T',  'A',  'T',  'U',  'S',  0x62, 'i',  'd',
+                                      0x18, 42};
+    double decode_ns = time_ns(iterations, [&](int) {
+        sink += (unsigned)cbor_to_json(command, sizeof(command), back, sizeof(back));
+    });
+    printf("  inbound command cbor_to_json: %zu -> %zu bytes, %.0f ns\n", sizeof(command),
+           cbor_to_json(command, sizeof(command), back, sizeof(back)), decode_ns);
+    printf("  checksum %u\n", sink);
+
+    return 0;
+}
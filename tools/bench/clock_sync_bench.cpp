@@ -0,0 +1,159 @@
+/**
+ * @file clock_sync_bench.cpp
+ * @brief Simulated accuracy of the clock_sync estimator over a WiFi-like link
+ *
+ * A device clock running 25 ppm fast is synchronised to a host over a link
+ * whose one-way delays have a 1.5 ms floor, exponential queuing jitter and
+ * occasional 100 ms stalls, one SNTP exchange every 16 s after a short
+ * burst. Every exchange goes through the real SNTP packet code. Reports
+ * how far mapped device time is from true host time once settled, checks
+ * that it never runs backwards, and times the per-exchange cost.
+ */
+
+#include "clock_sync.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static const int64_t HOST_EPOCH_US = 1760000000000000LL; // Host time when the device booted
+static const double DEVICE_PPM = 25.0;                   // Device oscillator error
+static const int64_t EXCHANGE_INTERVAL_US = 16000000;
+static const int BURST_EXCHANGES = 4;
+static const int64_t BURST_INTERVAL_US = 2000000;
+static const int64_t SETTLE_US = 300000000; // Errors are counted after 5 minutes
+static const int64_t RUN_US = 7200000000LL; // Two hours
+
+static std::mt19937_64 rng(12345);
+
+static bool check(const char *what, bool ok)
+{
+    printf("  %s: %s\n", what, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// Device clock reading at true (host) time t, relative to boot
+static uint64_t device_clock(int64_t host_us)
+{
+    double elapsed = (double)(host_us - HOST_EPOCH_US);
+    return (uint64_t)llround(elapsed * (1.0 + DEVICE_PPM * 1e-6));
+}
+
+static int64_t one_way_delay_us()
+{
+    std::exponential_distribution<double> queuing(1.0 / 4000.0);
+    std::uniform_real_distribution<double> stall(0.0, 1.0);
+    double delay = 1500.0 + queuing(rng);
+    if (stall(rng) < 0.03)
+    {
+        delay += 100000.0; // Power-save wakeup or retransmission
+    }
+    return (int64_t)delay;
+}
+
+// One SNTP exchange starting at true time now; the host clock is true time
+static void exchange(clock_sync_t *sync, int64_t now)
+{
+    uint8_t request[CLOCK_SYNC_NTP_PACKET_SIZE];
+    uint8_t reply[CLOCK_SYNC_NTP_PACKET_SIZE];
+
+    uint64_t t1 = device_clock(now);
+    clock_sync_ntp_request(request, t1);
+
+    int64_t t2 = now + one_way_delay_us();
+    int64_t t3 = t2 + 40; // Host processing
+    clock_sync_ntp_answer(request, sizeof(request), t2, t3, reply);
+
+    int64_t arrival = t3 + one_way_delay_us();
+    uint64_t t4 = device_clock(arrival);
+
+    int64_t host_receive, host_transmit;
+    if (clock_sync_ntp_parse_reply(reply, sizeof(reply), t1, &host_receive, &host_transmit))
+    {
+        clock_sync_add_exchange(sync, t1, host_receive, host_transmit, t4);
+    }
+}
+
+int main()
+{
+    bool ok = true;
+    uint8_t request[CLOCK_SYNC_NTP_PACKET_SIZE];
+    uint8_t reply[CLOCK_SYNC_NTP_PACKET_SIZE];
+    int64_t t2 = 0, t3 = 0;
+
+    printf("Correctness\n");
+    clock_sync_ntp_request(request, 0x0123456789ABCDEFull);
+    size_t reply_len = clock_sync_ntp_answer(request, sizeof(request), HOST_EPOCH_US + 1, HOST_EPOCH_US + 999999,
+                                             reply);
+    ok &= check("sntp round trip", reply_len == sizeof(reply) &&
+                                       clock_sync_ntp_parse_reply(reply, reply_len, 0x0123456789ABCDEFull, &t2, &t3) &&
+                                       t2 == HOST_EPOCH_US + 1 && t3 == HOST_EPOCH_US + 999999);
+    ok &= check("stale reply rejected", !clock_sync_ntp_parse_reply(reply, reply_len, 42, &t2, &t3));
+    reply[1] = 0;
+    ok &= check("kiss-of-death rejected", !clock_sync_ntp_parse_reply(reply, reply_len, 0x0123456789ABCDEFull, &t2,
+                                                                       &t3));
+    if (!ok)
+    {
+        return 1;
+    }
+
+    clock_sync_t sync;
+    clock_sync_init(&sync);
+
+    std::vector<double> errors;
+    int64_t previous_mapped = INT64_MIN;
+    bool monotonic = true;
+    int64_t next_exchange = HOST_EPOCH_US + 1000000;
+    int exchanges = 0;
+
+    // Sample the mapping every 100 ms of true time
+    for (int64_t now = HOST_EPOCH_US; now < HOST_EPOCH_US + RUN_US; now += 100000)
+    {
+        while (next_exchange <= now)
+        {
+            exchange(&sync, next_exchange);
+            next_exchange += ++exchanges < BURST_EXCHANGES ? BURST_INTERVAL_US : EXCHANGE_INTERVAL_US;
+        }
+        if (!sync.mapping.synced)
+        {
+            continue;
+        }
+
+        int64_t mapped = clock_sync_map(&sync.mapping, device_clock(now));
+        monotonic &= mapped > previous_mapped;
+        previous_mapped = mapped;
+        if (now - HOST_EPOCH_US >= SETTLE_US)
+        {
+            errors.push_back(std::fabs((double)(mapped - now)));
+        }
+    }
+    ok &= check("monotonic after first sync", monotonic && sync.steps == 1);
+
+    std::sort(errors.begin(), errors.end());
+    printf("\nSimulated link: %.0f ppm device, 1.5 ms + ~4 ms jitter each way, 3%% 100 ms stalls\n", DEVICE_PPM);
+    printf("  exchanges %u, rejected %u, steps %u\n", sync.exchanges, sync.rejected, sync.steps);
+    printf("  drift estimate %.2f ppm (true %.2f)\n", sync.mapping.drift_ppb / 1000.0,
+           1e6 / (1.0 + DEVICE_PPM * 1e-6) - 1e6);
+    printf("  |mapped - host| after 5 min: median %.0f us, p95 %.0f us, max %.0f us\n",
+           errors[errors.size() / 2], errors[errors.size() * 95 / 100], errors.back());
+
+    const int rounds = 1000000;
+    clock_sync_init(&sync);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t sink = 0;
+    for (int i = 0; i < rounds; i++)
+    {
+        uint64_t t1 = (uint64_t)i * 16000000;
+        clock_sync_add_exchange(&sync, t1, HOST_EPOCH_US + (int64_t)t1 + 3000 + (i % 7) * 100,
+                                HOST_EPOCH_US + (int64_t)t1 + 3040 + (i % 7) * 100, t1 + 6000);
+        sink += (uint64_t)clock_sync_map(&sync.mapping, t1 + 7000);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    printf("  add_exchange + map: %.0f ns (checksum %llu)\n",
+           std::chrono::duration<double, std::nano>(elapsed).count() / rounds, (unsigned long long)(sink & 0xFFFF));
+
+    return 0;
+}
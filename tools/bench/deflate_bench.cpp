@@ -0,0 +1,150 @@
+/**
+ * @file deflate_bench.cpp
+ * @brief Host benchmark for permessage-deflate on log and status traffic
+ *
+ * Replays a verbose-logging session (log frames interleaved with
+ * channel_data) the way the WebSocket server sends it to one client:
+ * each message compressed against the last window of what came before.
+ * Reports wire bytes with and without that context and the time per
+ * message, after checking that context-free output decompresses.
+ */
+
+#include "deflate.h"
+#include "json_writer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static const char *log_lines[] = {
+    "[WEBSOCKET] Client %d connected from 192.168.1.%d",
+    "Command executed: SET_CHANNEL {\"channel\":%d,\"enabled\":true} in %d us",
+    "[TELEMETRY] Status broadcast to %d clients, %d bytes",
+    "[WEBSOCKET] Client %d idle for %d ms, pinging",
+    "[SAFETY] Channel %d current within limits (%d mA)",
+};
+
+static deflate_compressor_t compressor;
+static deflate_decompressor_t decompressor;
+
+static bool check(const char *what, bool ok)
+{
+    printf("  %s: %s\n", what, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static size_t session_message(int i, char *buf, size_t size)
+{
+    json_writer_t w;
+    json_writer_init(&w, buf, size);
+    json_begin_object(&w);
+
+    if (i % 3 == 2)
+    {
+        json_kv_string(&w, "type", "channel_data");
+        json_kv_int(&w, "channel", (i & 3) + 1);
+        json_kv_float(&w, "voltage", 12.0f + (float)((i * 37) % 100) * 0.01f, 2);
+        json_kv_float(&w, "current", (float)((i * 53) % 1000) * 0.001f, 3);
+    }
+    else
+    {
+        char message[128];
+        snprintf(message, sizeof(message), log_lines[(i / 3) % 5], i & 3, (i * 7919) % 1000);
+        json_kv_string(&w, "type", "log");
+        json_kv_string(&w, "level", "INFO");
+        json_kv_string(&w, "category", "NET");
+        json_kv_string(&w, "message", message);
+    }
+
+    json_end_object(&w);
+    return json_writer_finish(&w);
+}
+
+/**
+ * Compress a session; context carries the last DEFLATE_WINDOW_SIZE bytes
+ * between messages like a client without server_no_context_takeover
+ */
+static size_t run_session(int messages, bool context, size_t *raw_bytes)
+{
+    static uint8_t input[DEFLATE_WINDOW_SIZE + 512];
+    uint8_t out[512];
+    size_t history = 0;
+    size_t wire = 0;
+    *raw_bytes = 0;
+
+    for (int i = 0; i < messages; i++)
+    {
+        size_t len = session_message(i, (char *)input + history, 512);
+        size_t packed = deflate_compress(&compressor, input, history, history + len, out, len);
+        wire += packed > 0 ? packed : len; // Sent as is when it would not shrink
+        *raw_bytes += len;
+
+        if (context && packed > 0)
+        {
+            size_t total = history + len;
+            history = total < DEFLATE_WINDOW_SIZE ? total : DEFLATE_WINDOW_SIZE;
+            memmove(input, input + total - history, history);
+        }
+    }
+    return wire;
+}
+
+int main()
+{
+    bool ok = true;
+    char message[512];
+    uint8_t packed[512];
+    uint8_t unpacked[512];
+
+    printf("Correctness\n");
+    for (int i = 0; i < 15; i++)
+    {
+        size_t len = session_message(i, message, sizeof(message));
+        size_t n = deflate_compress(&compressor, (const uint8_t *)message, 0, len, packed, sizeof(packed));
+        size_t out_len = 0;
+        if (n == 0 || !deflate_decompress(&decompressor, packed, n, unpacked, sizeof(unpacked), &out_len) ||
+            out_len != len || memcmp(unpacked, message, len) != 0)
+        {
+            ok = false;
+        }
+    }
+    ok &= check("round trip", ok);
+
+    // RFC 7692 section 7.2.3.6: an empty message compresses to a single 0x00
+    size_t out_len = 1;
+    ok &= check("empty message", deflate_decompress(&decompressor, (const uint8_t *)"\0", 1, unpacked,
+                                                    sizeof(unpacked), &out_len) &&
+                                     out_len == 0);
+    ok &= check("corrupt input rejected", !deflate_decompress(&decompressor, (const uint8_t *)"\xFF\xFF", 2, unpacked,
+                                                              sizeof(unpacked), &out_len));
+
+    if (!ok)
+    {
+        return 1;
+    }
+
+    const int messages = 3000;
+    size_t raw = 0;
+
+    printf("\nSession of %d messages (2/3 log, 1/3 channel_data)\n", messages);
+    size_t with_context = run_session(messages, true, &raw);
+    size_t without_context = run_session(messages, false, &raw);
+    printf("  uncompressed         %7zu bytes\n", raw);
+    printf("  no context takeover  %7zu bytes (%.0f%%)\n", without_context, 100.0 * without_context / raw);
+    printf("  1 KiB context        %7zu bytes (%.0f%%)\n", with_context, 100.0 * with_context / raw);
+
+    const int rounds = 100;
+    auto start = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (int r = 0; r < rounds; r++)
+    {
+        sink += run_session(messages, true, &raw);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / (rounds * messages);
+    printf("  compress with context: %.0f ns/message (includes composing it), checksum %zu\n", ns, sink);
+    printf("  state: compressor %zu bytes, decompressor %zu bytes\n", sizeof(deflate_compressor_t),
+           sizeof(deflate_decompressor_t));
+
+    return 0;
+}
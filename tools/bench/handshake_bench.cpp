@@ -0,0 +1,73 @@
+/**
+ * @file handshake_bench.cpp
+ * @brief Host benchmark for the WebSocket accept key computation
+ *
+ * Verifies the implementation against the RFC 6455 and FIPS 180 examples,
+ * then reports the per-handshake cost. On the RP2040 the same code path is
+ * timed with hal_get_time_us() and logged for every upgrade.
+ */
+
+#include "sha1.h"
+#include "base64.h"
+#include "websocket_handshake.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static bool check_sha1(const char *input, const char *expected_hex)
+{
+    uint8_t digest[SHA1_DIGEST_SIZE];
+    char hex[SHA1_DIGEST_SIZE * 2 + 1];
+
+    sha1(input, strlen(input), digest);
+    for (int i = 0; i < SHA1_DIGEST_SIZE; i++)
+    {
+        snprintf(hex + i * 2, 3, "%02x", digest[i]);
+    }
+
+    bool ok = strcmp(hex, expected_hex) == 0;
+    printf("  sha1(%zu bytes): %s\n", strlen(input), ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main()
+{
+    printf("Correctness\n");
+
+    bool ok = check_sha1("abc", "a9993e364706816aba3e25717850c26c9cd0d89d");
+    ok &= check_sha1("", "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    ok &= check_sha1("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+                     "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+
+    char accept[WEBSOCKET_ACCEPT_SIZE];
+    bool accept_ok = websocket_compute_accept("dGhlIHNhbXBsZSBub25jZQ==", accept, sizeof(accept)) &&
+                     strcmp(accept, "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") == 0;
+    printf("  RFC 6455 accept key: %s\n", accept_ok ? "ok" : "FAIL");
+    ok &= accept_ok;
+
+    if (!ok)
+    {
+        return 1;
+    }
+
+    const int iterations = 200000;
+    char key[] = "dGhlIHNhbXBsZSBub25jZQ==";
+    unsigned sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        key[i & 15] ^= 1; // Defeat hoisting without leaving the Base64 alphabet
+        websocket_compute_accept(key, accept, sizeof(accept));
+        sink += (unsigned char)accept[0];
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    printf("\nBenchmark\n");
+    printf("  accept key: %.0f ns/handshake (%d iterations, checksum %u)\n", ns, iterations, sink);
+    printf("  context size: %zu bytes\n", sizeof(sha1_ctx_t));
+
+    return 0;
+}
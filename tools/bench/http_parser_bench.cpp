@@ -0,0 +1,167 @@
+/**
+ * @file http_parser_bench.cpp
+ * @brief Host benchmark and check for the incremental HTTP request parser
+ *
+ * Every request is fed in two pieces, split at each byte offset in turn, the
+ * way a header can arrive across pbufs or receive callbacks; each split must
+ * give the same result as the whole. Covers the kept header values, joining
+ * of a repeated header, the 414/431 limits and obs-fold rejection, then
+ * reports the parse cost of a typical WebSocket upgrade.
+ */
+
+#include "http_parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+static const char upgrade_request[] = "GET /ws?session=7 HTTP/1.1\r\n"
+                                      "Host: rig.local\r\n"
+                                      "Connection: keep-alive\r\n"
+                                      "Upgrade:  websocket \r\n"
+                                      "User-Agent: bench/1.0 (ignored)\r\n"
+                                      "Connection: Upgrade\r\n"
+                                      "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                                      "Sec-WebSocket-Version: 13\r\n"
+                                      "Sec-WebSocket-Protocol: rig.cbor, rig.json\r\n"
+                                      "\r\n"
+                                      "BODY";
+
+static bool check(const char *what, bool ok)
+{
+    printf("  %s: %s\n", what, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+/**
+ * @brief Parse a request fed as [0, split) then [split, len)
+ * @return Final status; *consumed is the header length when done
+ */
+static http_parse_status_t parse_split(http_parser_t *parser, const std::string &request, size_t split,
+                                       size_t *consumed)
+{
+    http_parser_init(parser);
+
+    size_t used = 0;
+    http_parse_status_t status = http_parser_feed(parser, request.data(), split, &used);
+    *consumed = used;
+    if (status == HTTP_PARSE_INCOMPLETE)
+    {
+        status = http_parser_feed(parser, request.data() + split, request.size() - split, &used);
+        *consumed += used;
+    }
+    return status;
+}
+
+static bool header_is(const http_parser_t *parser, http_header_id_t id, const char *expected)
+{
+    const char *value = http_parser_header(parser, id);
+    return value != NULL && strcmp(value, expected) == 0;
+}
+
+static bool upgrade_parsed(const http_parser_t *parser, http_parse_status_t status, size_t consumed)
+{
+    char path[HTTP_PARSER_TARGET_SIZE];
+    return status == HTTP_PARSE_DONE && consumed == sizeof(upgrade_request) - 1 - 4 && // Body left over
+           parser->method == HTTP_METHOD_GET && strcmp(parser->target, "/ws?session=7") == 0 &&
+           http_parser_path(parser, path, sizeof(path)) && strcmp(path, "/ws") == 0 &&
+           header_is(parser, HTTP_HEADER_HOST, "rig.local") &&
+           header_is(parser, HTTP_HEADER_CONNECTION, "keep-alive, Upgrade") &&
+           header_is(parser, HTTP_HEADER_UPGRADE, "websocket") &&
+           header_is(parser, HTTP_HEADER_SEC_WEBSOCKET_KEY, "dGhlIHNhbXBsZSBub25jZQ==") &&
+           header_is(parser, HTTP_HEADER_SEC_WEBSOCKET_VERSION, "13") &&
+           header_is(parser, HTTP_HEADER_SEC_WEBSOCKET_PROTOCOL, "rig.cbor, rig.json") &&
+           http_parser_header(parser, HTTP_HEADER_ACCEPT_ENCODING) == NULL &&
+           http_header_has_token(http_parser_header(parser, HTTP_HEADER_CONNECTION), "upgrade") &&
+           http_parser_keep_alive(parser);
+}
+
+/**
+ * @brief Check that a request gives the expected HTTP status at every split
+ * @param expected_status 0 for a request that must parse
+ */
+static bool check_all_splits(const char *what, const std::string &request, int expected_status)
+{
+    http_parser_t parser;
+    for (size_t split = 0; split <= request.size(); split++)
+    {
+        size_t consumed = 0;
+        http_parse_status_t status = parse_split(&parser, request, split, &consumed);
+        bool ok = expected_status == 0 ? status == HTTP_PARSE_DONE
+                                       : status == HTTP_PARSE_ERROR &&
+                                             http_parse_error_status(parser.error) == expected_status;
+        if (!ok)
+        {
+            printf("  %s: FAIL at split %zu (status %d, error %d)\n", what, split, (int)status, (int)parser.error);
+            return false;
+        }
+    }
+    return check(what, true);
+}
+
+int main()
+{
+    printf("Correctness\n");
+
+    const std::string upgrade(upgrade_request, sizeof(upgrade_request) - 1);
+    bool split_ok = true;
+    http_parser_t parser;
+    for (size_t split = 0; split <= upgrade.size() && split_ok; split++)
+    {
+        size_t consumed = 0;
+        http_parse_status_t status = parse_split(&parser, upgrade, split, &consumed);
+        split_ok = upgrade_parsed(&parser, status, consumed);
+        if (!split_ok)
+        {
+            printf("  upgrade request: FAIL at split %zu\n", split);
+        }
+    }
+    bool ok = check("upgrade request at every split", split_ok);
+
+    const std::string longest_target = "GET /" + std::string(HTTP_PARSER_TARGET_SIZE - 2, 'a') + " HTTP/1.1\r\n\r\n";
+    const std::string long_target = "GET /" + std::string(HTTP_PARSER_TARGET_SIZE - 1, 'a') + " HTTP/1.1\r\n\r\n";
+    ok &= check_all_splits("127-byte target accepted", longest_target, 0);
+    ok &= check_all_splits("128-byte target -> 414", long_target, 414);
+
+    const std::string long_value =
+        "GET / HTTP/1.1\r\nHost: " + std::string(HTTP_PARSER_VALUE_SIZE, 'h') + "\r\n\r\n";
+    ok &= check_all_splits("oversized Host value -> 431", long_value, 431);
+
+    std::string many_headers = "GET / HTTP/1.1\r\n";
+    for (int i = 0; i <= HTTP_PARSER_MAX_HEADERS; i++)
+    {
+        many_headers += "X-Filler: " + std::to_string(i) + "\r\n";
+    }
+    many_headers += "\r\n";
+    ok &= check_all_splits("too many headers -> 431", many_headers, 431);
+
+    ok &= check_all_splits("obs-fold -> 400", "GET / HTTP/1.1\r\nHost: rig\r\n .local\r\n\r\n", 400);
+    ok &= check_all_splits("bare LF line endings", "GET / HTTP/1.1\nHost: rig\n\n", 0);
+
+    if (!ok)
+    {
+        return 1;
+    }
+
+    const int iterations = 200000;
+    unsigned sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        size_t consumed = 0;
+        http_parser_init(&parser);
+        http_parser_feed(&parser, upgrade_request, sizeof(upgrade_request) - 1, &consumed);
+        sink += (unsigned)consumed + (unsigned char)parser.values[HTTP_HEADER_SEC_WEBSOCKET_KEY][i & 15];
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    printf("\nBenchmark\n");
+    printf("  upgrade request (%zu header bytes): %.0f ns/request, %.2f ns/byte (%d iterations, checksum %u)\n",
+           upgrade.size() - 4, ns, ns / (double)(upgrade.size() - 4), iterations, sink);
+    printf("  parser size: %zu bytes\n", sizeof(http_parser_t));
+
+    return 0;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file json_bench.cpp
+ * @brief Host benchmark for the streaming JSON writer and pull parser
+ *
+ * Checks escaping, overflow and round trips first, then times the writer
+ * against the snprintf formatting it replaced (telemetry and log frames)
+ * and the reader against a strstr field lookup on a command envelope.
+ * The snprintf log variant does not escape, so it is the optimistic case.
+ */
+
+#include "json_writer.h"
+#include "json_reader.h"
+#include "command_registry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const char *log_text = "Channel 3 over-current: \"limit\" 1.250 A\treset in 5 s";
+static const char *command_text =
+    "{\"type\":\"command\",\"id\":42,\"command\":\"SET_CHANNEL\",\"params\":{\"channel\":3,\"enabled\":true}}";
+
+static bool check(const char *what, bool ok)
+{
+    printf("  %s: %s\n", what, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static size_t write_channel(char *buf, size_t size, int channel, float voltage, float current)
+{
+    json_writer_t w;
+    json_writer_init(&w, buf, size);
+    json_begin_object(&w);
+    json_kv_string(&w, "type", "channel_data");
+    json_kv_int(&w, "channel", channel);
+    json_kv_float(&w, "voltage", voltage, 2);
+    json_kv_float(&w, "current", current, 3);
+    json_end_object(&w);
+    return json_writer_finish(&w);
+}
+
+static size_t write_log(char *buf, size_t size, const char *message)
+{
+    json_writer_t w;
+    json_writer_init(&w, buf, size);
+    json_begin_object(&w);
+    json_kv_string(&w, "type", "log");
+    json_kv_string(&w, "level", "WARN");
+    json_kv_string(&w, "category", "SAFETY");
+    json_kv_string(&w, "message", message);
+    json_end_object(&w);
+    return json_writer_finish(&w);
+}
+
+static int read_channel_arg(const char *text)
+{
+    json_reader_t r;
+    json_reader_init(&r, text, strlen(text));
+    int32_t channel = -1;
+    if (json_next(&r) != JSON_TOKEN_OBJECT_BEGIN)
+    {
+        return -1;
+    }
+    while (json_next(&r) == JSON_TOKEN_KEY)
+    {
+        if (!json_token_is(&r, "params"))
+        {
+            json_skip(&r);
+            continue;
+        }
+        if (json_next(&r) != JSON_TOKEN_OBJECT_BEGIN)
+        {
+            return -1;
+        }
+        while (json_next(&r) == JSON_TOKEN_KEY)
+        {
+            if (json_token_is(&r, "channel") && json_next(&r) == JSON_TOKEN_NUMBER)
+            {
+                json_token_int(&r, &channel);
+            }
+            else
+            {
+                json_skip(&r);
+            }
+        }
+    }
+    return channel;
+}
+
+static bool well_formed(const char *text)
+{
+    json_reader_t r;
+    json_reader_init(&r, text, strlen(text));
+    json_token_t token;
+    while ((token = json_next(&r)) != JSON_TOKEN_END && token != JSON_TOKEN_ERROR)
+    {
+    }
+    return token == JSON_TOKEN_END;
+}
+
+static int strstr_channel_arg(const char *text)
+{
+    // The pre-parser approach: find the key text anywhere in the message
+    const char *p = strstr(text, "\"channel\":");
+    return p ? atoi(p + 10) : -1;
+}
+
+static cmd_status_t bench_handler(cmd_context_t *ctx)
+{
+    json_begin_object(ctx->json);
+    json_kv_int(ctx->json, "channel", ctx->args[0].i);
+    json_kv_bool(ctx->json, "enabled", ctx->args[1].b);
+    json_end_object(ctx->json);
+    return CMD_OK;
+}
+
+static constexpr cmd_arg_spec_t bench_args[] = {
+    {"channel", CMD_ARG_INT, true, 1, 4},
+    {"enabled", CMD_ARG_BOOL, true, 0, 0},
+};
+static constexpr cmd_def_t bench_table[] = {
+    {"SET_CHANNEL", bench_handler, bench_args, 2, "Set one channel"},
+};
+static_assert(command_table_is_sorted(bench_table), "bench table must be sorted");
+
+template <typename F>
+static double time_ns(int iterations, F &&body)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        body(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+int main()
+{
+    char buf[512];
+    bool ok = true;
+
+    printf("Correctness\n");
+
+    ok &= check("channel_data",
+                write_channel(buf, sizeof(buf), 2, 12.345f, -0.0004f) > 0 &&
+                    strcmp(buf, "{\"type\":\"channel_data\",\"channel\":2,\"voltage\":12.35,\"current\":0.000}") == 0);
+
+    ok &= check("escaping", write_log(buf, sizeof(buf), log_text) > 0 &&
+                                strstr(buf, "\\\"limit\\\" 1.250 A\\treset") != NULL);
+
+    json_reader_t r;
+    json_reader_init(&r, buf, strlen(buf));
+    bool round_trip = false;
+    for (json_token_t token = json_next(&r); token != JSON_TOKEN_END && token != JSON_TOKEN_ERROR;
+         token = json_next(&r))
+    {
+        if (token == JSON_TOKEN_KEY && json_token_is(&r, "message"))
+        {
+            char decoded[128];
+            round_trip = json_next(&r) == JSON_TOKEN_STRING && json_token_copy(&r, decoded, sizeof(decoded)) &&
+                         strcmp(decoded, log_text) == 0;
+        }
+    }
+    ok &= check("round trip", round_trip);
+
+    ok &= check("overflow is not truncation", write_log(buf, 40, log_text) == 0);
+
+    json_writer_t w;
+    json_writer_init(&w, buf, 32);
+    size_t kept = json_string_fit(&w, log_text, strlen(log_text), 1);
+    json_end_array(&w); // Unbalanced on purpose: only the fit matters here
+    ok &= check("string fit", kept > 0 && kept < strlen(log_text) && !json_writer_overflowed(&w));
+
+    ok &= check("reader", read_channel_arg(command_text) == 3);
+    ok &= check("malformed input", !well_formed("{\"channel\":3,}") && !well_formed("{\"a\":1} x") &&
+                                       well_formed(command_text));
+
+    command_registry_init(bench_table, 1);
+    size_t reply_len = command_execute_json(command_text, CMD_SOURCE_WEBSOCKET, 0, JSON_FORMAT_TEXT, buf, sizeof(buf));
+    ok &= check("registry envelope",
+                reply_len > 0 && strcmp(buf, "{\"type\":\"result\",\"id\":42,\"command\":\"SET_CHANNEL\",\"ok\":true,"
+                                             "\"result\":{\"channel\":3,\"enabled\":true}}") == 0);
+
+    if (!ok)
+    {
+        return 1;
+    }
+
+    const int iterations = 1000000;
+    unsigned sink = 0;
+
+    printf("\nBenchmark (%d iterations)\n", iterations);
+
+    double writer_ns = time_ns(iterations, [&](int i) {
+        sink += (unsigned)write_channel(buf, sizeof(buf), (i & 3) + 1, 12.0f + (float)(i & 255) * 0.01f, 0.5f);
+    });
+    double snprintf_ns = time_ns(iterations, [&](int i) {
+        sink += (unsigned)snprintf(buf, sizeof(buf),
+                                   "{\"type\":\"channel_data\",\"channel\":%d,\"voltage\":%.2f,\"current\":%.3f}",
+                                   (i & 3) + 1, 12.0f + (float)(i & 255) * 0.01f, 0.5f);
+    });
+    printf("  channel_data: writer %.0f ns, snprintf %.0f ns\n", writer_ns, snprintf_ns);
+
+    writer_ns = time_ns(iterations, [&](int) { sink += (unsigned)write_log(buf, sizeof(buf), log_text); });
+    snprintf_ns = time_ns(iterations, [&](int) {
+        sink += (unsigned)snprintf(buf, sizeof(buf),
+                                   "{\"type\":\"log\",\"level\":\"%s\",\"category\":\"%s\",\"message\":\"%s\"}",
+                                   "WARN", "SAFETY", log_text);
+    });
+    printf("  log (escaped vs unescaped): writer %.0f ns, snprintf %.0f ns\n", writer_ns, snprintf_ns);
+
+    double reader_ns = time_ns(iterations, [&](int) { sink += (unsigned)read_channel_arg(command_text); });
+    double strstr_ns = time_ns(iterations, [&](int) { sink += (unsigned)strstr_channel_arg(command_text); });
+    printf("  command params: reader %.0f ns, strstr %.0f ns\n", reader_ns, strstr_ns);
+
+    double registry_ns = time_ns(iterations / 10, [&](int) {
+        sink += (unsigned)command_execute_json(command_text, CMD_SOURCE_WEBSOCKET, 0, JSON_FORMAT_TEXT, buf,
+                                               sizeof(buf));
+    });
+    printf("  registry envelope round trip: %.0f ns\n", registry_ns);
+
+    printf("  checksum %u; writer %zu bytes, reader %zu bytes of state\n", sink, sizeof(json_writer_t),
+           sizeof(json_reader_t));
+
+    return 0;
+}
@@ -0,0 +1,813 @@
+/**
+ * @file display_render.cpp
+ * @brief Render display scenes on the host and check them against golden images
+ *
+ * Draws each scene with the same code the firmware uses, through both
+ * render modes: the framebuffer (src/utils/framebuffer.h) and the band
+ * display list (src/utils/display_list.h). Writes the framebuffer as a binary
+ * PPM and prints a hash of its pixels plus what each mode's flushes sent.
+ * The band mode's pushes go through the ILI9481 driver (include/ili9481_driver.h)
+ * into the panel mock (include/mock_display.h), whose decoded panel memory
+ * has to match the framebuffer pixel for pixel. --check compares the hashes,
+ * and the bytes the last flush put on the SPI bus, with a golden list, so any
+ * change to what reaches the panel or what it costs shows up; the PPMs are
+ * there to look at when one does. Text goes through the string cache
+ * (src/utils/text_cache.h) as it does in the display HAL.
+ *
+ * The widget scenes run the display manager (src/ui/display_manager.h) and
+ * the status screen (src/ui/status_indicators.h) unchanged, on a stand-in
+ * for the hal_display_* calls they make that draws into the scene's canvas.
+ * The strip chart scene scrolls part of the screen as pico_display_scroll_area()
+ * does, with the panel's hardware scrolling; the mock applies it before the
+ * comparison, and the framebuffer shifts the area in software to match.
+ *
+ * What goes to the panel also goes through the web display mirror's wire
+ * format (src/utils/display_stream.h) into a viewer's image, as
+ * platforms/pico_w/src/display_mirror.cpp sends it, which has to match the
+ * framebuffer as well; the "mirror" column is what the scene cost a viewer.
+ *
+ * Usage:
+ *   display_render [--output DIR] [--check GOLDEN] [--update GOLDEN]
+ *
+ * scripts/testing/display_golden.sh builds and runs the check against
+ * tools/display_render/golden.txt.
+ */
+
+#include "framebuffer.h"
+#include "display_list.h"
+#include "text_cache.h"
+#include "ili9481_driver.h"
+#include "mock_display.h"
+#include "hal_interface.h"
+#include "display_manager.h"
+#include "status_indicators.h"
+#include "strip_chart.h"
+#include "display_stream.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// CONSTANTS
+// =============================================================================
+
+// As DISPLAY_WIDTH / DISPLAY_HEIGHT in platforms/pico_w/include/board_config.h
+#define RENDER_WIDTH 320
+#define RENDER_HEIGHT 240
+#define RENDER_BAND_HEIGHT 8  // DISPLAY_BAND_HEIGHT
+#define RENDER_BAND_BUFFERS 2 // DISPLAY_BAND_BUFFERS
+#define RENDER_MIRROR_MESSAGE 2920 // DISPLAY_MIRROR_MESSAGE_SIZE
+#define RENDER_PANEL_MADCTL 0x28 // DISPLAY_PANEL_MADCTL
+#define RENDER_PANEL_X_OFFSET 80 // DISPLAY_PANEL_X_OFFSET
+#define RENDER_PANEL_Y_OFFSET 40 // DISPLAY_PANEL_Y_OFFSET
+
+// =============================================================================
+// OPTIONS
+// =============================================================================
+
+struct Options
+{
+    std::string output_dir;
+    std::string check_file;
+    std::string update_file;
+};
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "Usage: %s [--output DIR] [--check GOLDEN] [--update GOLDEN]\n"
+            "  --output DIR     Write one PPM per scene into DIR\n"
+            "  --check GOLDEN   Compare scene hashes with the list in GOLDEN\n"
+            "  --update GOLDEN  Rewrite GOLDEN with the current hashes\n",
+            argv0);
+}
+
+static bool parse_options(int argc, char **argv, Options &opt)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[++i] : nullptr;
+        if (value == nullptr)
+        {
+            return false;
+        }
+        if (arg == "--output")
+        {
+            opt.output_dir = value;
+        }
+        else if (arg == "--check")
+        {
+            opt.check_file = value;
+        }
+        else if (arg == "--update")
+        {
+            opt.update_file = value;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// =============================================================================
+// CANVAS
+// =============================================================================
+
+/**
+ * Both render modes drawn in step: a framebuffer with its pixels, and a
+ * display list whose band pushes go through the panel driver to the mock
+ * panel. Counts what each flush sends.
+ */
+class Canvas
+{
+public:
+    Canvas()
+        : pixels_(RENDER_WIDTH * RENDER_HEIGHT, 0), band_(RENDER_BAND_BUFFERS * RENDER_WIDTH * RENDER_BAND_HEIGHT),
+          mirror_(RENDER_WIDTH * RENDER_HEIGHT, 0), message_(RENDER_MIRROR_MESSAGE)
+    {
+        // One panel for all canvases: reset it and bring it up as hal_display_init() does
+        mock_display_reset();
+        ili9481_config_t panel = {};
+        panel.cs_pin = 5;
+        panel.dc_pin = 6;
+        panel.rst_pin = 7;
+        panel.madctl = RENDER_PANEL_MADCTL;
+        panel.x_offset = RENDER_PANEL_X_OFFSET;
+        panel.y_offset = RENDER_PANEL_Y_OFFSET;
+        panel.pixel_format = ILI9481_RGB565;
+        ili9481_init(&panel);
+
+        framebuffer_init(&fb_, pixels_.data(), RENDER_WIDTH, RENDER_HEIGHT);
+        text_cache_init(&text_, FRAMEBUFFER_GLYPH_WIDTH, FRAMEBUFFER_GLYPH_HEIGHT);
+        display_list_init(&list_, RENDER_WIDTH, RENDER_HEIGHT, RENDER_BAND_HEIGHT);
+        // The framebuffer starts out matching a black panel; so does the list after one (uncounted) flush
+        display_list_flush(&list_, band_.data(), RENDER_BAND_BUFFERS, nullptr, nullptr);
+        mock_display_clear_counters();
+
+        // A viewer subscribing: black, from the size record on
+        display_stream_writer_init(&mirror_writer_, message_.data(), message_.size(), RENDER_WIDTH, to_viewer, this);
+        display_stream_size(&mirror_writer_, RENDER_WIDTH, RENDER_HEIGHT);
+    }
+
+    // Canvases are handed to the writer and panel callbacks by address
+    Canvas(const Canvas &) = delete;
+    Canvas &operator=(const Canvas &) = delete;
+
+    void fill_rect(int x, int y, int width, int height, uint16_t color)
+    {
+        text_cache_invalidate(&text_, x, y, width, height);
+        framebuffer_fill_rect(&fb_, x, y, width, height, color);
+        display_list_fill_rect(&list_, x, y, width, height, color);
+    }
+
+    void draw_rect(int x, int y, int width, int height, uint16_t color)
+    {
+        text_cache_invalidate(&text_, x, y, width, height);
+        framebuffer_draw_rect(&fb_, x, y, width, height, color);
+        display_list_draw_rect(&list_, x, y, width, height, color);
+    }
+
+    void set_pixel(int x, int y, uint16_t color)
+    {
+        text_cache_invalidate(&text_, x, y, 1, 1);
+        framebuffer_set_pixel(&fb_, x, y, color);
+        display_list_set_pixel(&list_, x, y, color);
+    }
+
+    // As hal_display_draw_text(): only the characters that changed, then the cells a longer string left behind
+    void draw_text(int x, int y, const char *text, uint16_t fg, uint16_t bg)
+    {
+        text_cache_change_t change;
+        if (!text_cache_update(&text_, x, y, text, fg, bg, &change))
+        {
+            return;
+        }
+        std::string part(text + change.first, change.count);
+        int drawn_x = x + change.first * FRAMEBUFFER_GLYPH_WIDTH;
+        framebuffer_draw_text(&fb_, drawn_x, y, part.c_str(), fg, bg);
+        display_list_draw_text(&list_, drawn_x, y, part.c_str(), fg, bg);
+        if (change.erase)
+        {
+            fill_rect(x + (int)strlen(text) * FRAMEBUFFER_GLYPH_WIDTH, y, change.erase * FRAMEBUFFER_GLYPH_WIDTH,
+                      FRAMEBUFFER_GLYPH_HEIGHT, bg);
+        }
+    }
+
+    void blit(int x, int y, int width, int height, const uint8_t *data)
+    {
+        text_cache_invalidate(&text_, x, y, width, height);
+        framebuffer_blit(&fb_, x, y, width, height, data);
+        display_list_blit(&list_, x, y, width, height, data);
+    }
+
+    // Flushes both modes; returns the pixels the framebuffer flush sent
+    size_t flush()
+    {
+        rects_ += fb_.dirty_count;
+        size_t pixels = framebuffer_flush(&fb_, nullptr, nullptr);
+        pushed_ += pixels;
+
+        last_band_pushes_ = 0;
+        last_band_pushed_ = display_list_flush(&list_, band_.data(), RENDER_BAND_BUFFERS, to_panel, this);
+        ili9481_wait(nullptr);
+        hal_spi_poll();
+        display_stream_flush(&mirror_writer_);
+        // Bus bytes since the last flush: scrolled columns go out between flushes
+        mock_display_get_counters(&last_bus_);
+        mock_display_clear_counters();
+        return pixels;
+    }
+
+    // As pico_display_scroll_area(): what was drawn goes out first, later flushes leave the area alone
+    void scroll_area(int x, int width)
+    {
+        flush();
+        scroll_x_ = x;
+        scroll_width_ = width;
+        scroll_start_ = x + RENDER_PANEL_X_OFFSET;
+        ili9481_set_scroll_area((uint16_t)scroll_start_, (uint16_t)width);
+    }
+
+    // As pico_display_scroll_column(): the panel writes the oldest column's line and scrolls past it; the
+    // framebuffer moves the area left in software
+    void scroll_column(const uint16_t *column)
+    {
+        for (int row = 0; row < RENDER_HEIGHT; row++)
+        {
+            uint16_t *line = &pixels_[(size_t)row * RENDER_WIDTH + scroll_x_];
+            memmove(line, line + 1, (scroll_width_ - 1) * sizeof(uint16_t));
+            line[scroll_width_ - 1] = column[row];
+        }
+
+        fb_rect_t rect = {(uint16_t)(scroll_start_ - RENDER_PANEL_X_OFFSET), 0, 1, RENDER_HEIGHT};
+        ili9481_wait(nullptr);
+        ili9481_push(&rect, column, 1, nullptr);
+        int first = scroll_x_ + RENDER_PANEL_X_OFFSET;
+        scroll_start_ = first + (scroll_start_ - first + 1) % scroll_width_;
+        ili9481_scroll_to((uint16_t)scroll_start_);
+        display_stream_scroll(&mirror_writer_, (uint16_t)scroll_x_, (uint16_t)scroll_width_, column, RENDER_HEIGHT);
+    }
+
+    size_t rects() const { return rects_; }
+    size_t pushed() const { return pushed_; }
+    size_t band_pushes() const { return last_band_pushes_; }
+    size_t band_pushed() const { return last_band_pushed_; }
+    uint32_t band_dropped() const { return list_.dropped; }
+    const mock_display_counters_t &bus() const { return last_bus_; }
+    uint64_t mirror_bytes() const { return mirror_writer_.bytes; }
+
+    bool mirror_matches() const { return mirror_ok_ && !mirror_writer_.failed && mirror_ == pixels_; }
+
+    bool bands_match() const
+    {
+        uint16_t width, height;
+        const uint16_t *panel = mock_display_get_screen(&width, &height);
+        for (int row = 0; row < RENDER_HEIGHT; row++)
+        {
+            const uint16_t *on_panel = &panel[(size_t)(RENDER_PANEL_Y_OFFSET + row) * width + RENDER_PANEL_X_OFFSET];
+            if (memcmp(on_panel, &pixels_[(size_t)row * RENDER_WIDTH], RENDER_WIDTH * sizeof(uint16_t)) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint64_t hash() const
+    {
+        // FNV-1a over the pixels, little-endian
+        uint64_t h = 1469598103934665603ull;
+        for (uint16_t pixel : pixels_)
+        {
+            h = (h ^ (pixel & 0xFF)) * 1099511628211ull;
+            h = (h ^ (pixel >> 8)) * 1099511628211ull;
+        }
+        return h;
+    }
+
+    bool write_ppm(const std::string &path) const
+    {
+        FILE *file = fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            perror(path.c_str());
+            return false;
+        }
+        fprintf(file, "P6\n%d %d\n255\n", RENDER_WIDTH, RENDER_HEIGHT);
+        for (uint16_t pixel : pixels_)
+        {
+            uint32_t rgb = framebuffer_rgb888(pixel);
+            uint8_t bytes[3] = {(uint8_t)(rgb >> 16), (uint8_t)(rgb >> 8), (uint8_t)rgb};
+            fwrite(bytes, 1, sizeof(bytes), file);
+        }
+        return fclose(file) == 0;
+    }
+
+private:
+    // As the display HAL's count_push(): the previous push is sent before the next one is queued, and the
+    // scrolling columns are left out
+    static void to_panel(const fb_rect_t *rect, const uint16_t *pixels, uint16_t stride, void *context)
+    {
+        Canvas *canvas = static_cast<Canvas *>(context);
+        int scroll_end = canvas->scroll_x_ + canvas->scroll_width_;
+        if (canvas->scroll_width_ == 0 || rect->x >= scroll_end || rect->x + rect->width <= canvas->scroll_x_)
+        {
+            canvas->push(rect, pixels, stride);
+            return;
+        }
+        if (rect->x < canvas->scroll_x_)
+        {
+            fb_rect_t left = *rect;
+            left.width = (uint16_t)(canvas->scroll_x_ - rect->x);
+            canvas->push(&left, pixels, stride);
+        }
+        if (rect->x + rect->width > scroll_end)
+        {
+            fb_rect_t right = *rect;
+            right.x = (uint16_t)scroll_end;
+            right.width = (uint16_t)(rect->x + rect->width - scroll_end);
+            canvas->push(&right, &pixels[scroll_end - rect->x], stride);
+        }
+    }
+
+    // As the display HAL's send_area(): the mirror takes its copy before the panel push
+    void push(const fb_rect_t *rect, const uint16_t *pixels, uint16_t stride)
+    {
+        display_stream_rect(&mirror_writer_, rect, pixels, stride);
+        ili9481_wait(nullptr);
+        ili9481_push(rect, pixels, stride, nullptr);
+        last_band_pushes_++;
+    }
+
+    static bool to_viewer(const uint8_t *message, size_t len, void *context)
+    {
+        Canvas *canvas = static_cast<Canvas *>(context);
+        canvas->mirror_ok_ &= display_stream_apply(message, len, canvas->mirror_.data(), RENDER_WIDTH, RENDER_HEIGHT);
+        return true;
+    }
+
+    std::vector<uint16_t> pixels_;
+    framebuffer_t fb_;
+    size_t rects_ = 0;
+    size_t pushed_ = 0;
+    text_cache_t text_;
+
+    display_list_t list_;
+    std::vector<uint16_t> band_;
+    size_t last_band_pushes_ = 0;
+    size_t last_band_pushed_ = 0;
+    mock_display_counters_t last_bus_ = {};
+
+    int scroll_x_ = 0;
+    int scroll_width_ = 0; // No scroll area while 0
+    int scroll_start_ = 0; // Panel line at the area's left edge
+
+    std::vector<uint16_t> mirror_; // The viewer's image
+    std::vector<uint8_t> message_;
+    display_stream_writer_t mirror_writer_ = {};
+    bool mirror_ok_ = true; // Every message decoded
+};
+
+// =============================================================================
+// SCENES
+// =============================================================================
+
+static uint16_t rgb(uint32_t rgb888)
+{
+    return framebuffer_rgb565(rgb888);
+}
+
+// pico_display_draw_progress_bar()
+static void progress_bar(Canvas &c, int x, int y, int width, int height, int progress, uint32_t fg, uint32_t bg)
+{
+    int filled = width * progress / 100;
+    int split = filled < 1 ? 1 : (filled > width - 1 ? width - 1 : filled);
+    c.fill_rect(x + 1, y + 1, split - 1, height - 2, rgb(fg));
+    c.fill_rect(x + split, y + 1, width - 1 - split, height - 2, rgb(bg));
+    c.draw_rect(x, y, width, height, rgb(0xFFFFFF));
+}
+
+// pico_display_show_status(): the background only on the first call
+static void status_screen(Canvas &c, uint32_t uptime_s, uint32_t loop_count, bool first = true)
+{
+    char text[64];
+    if (first)
+    {
+        c.fill_rect(0, 0, RENDER_WIDTH, RENDER_HEIGHT, rgb(0x000080));
+    }
+    c.draw_text(10, 10, "Pico W Diagnostic Rig", rgb(0xFFFFFF), rgb(0x000080));
+    snprintf(text, sizeof(text), "Uptime: %lu s", (unsigned long)uptime_s);
+    c.draw_text(10, 30, text, rgb(0x00FF00), rgb(0x000080));
+    snprintf(text, sizeof(text), "Loop: %lu", (unsigned long)loop_count);
+    c.draw_text(10, 50, text, rgb(0x00FF00), rgb(0x000080));
+    c.draw_text(10, 80, "Status:", rgb(0xFFFF00), rgb(0x000080));
+    c.draw_text(80, 80, "RUNNING", rgb(0x00FF00), rgb(0x000080));
+    progress_bar(c, 10, 100, 200, 20, 95, 0x00FF00, 0x333333);
+}
+
+// 64x48 RGB565 gradient, little-endian
+static const uint8_t *gradient()
+{
+    static std::vector<uint8_t> pixels;
+    if (pixels.empty())
+    {
+        for (int y = 0; y < 48; y++)
+        {
+            for (int x = 0; x < 64; x++)
+            {
+                uint16_t p = rgb((uint32_t)(x * 4) << 16 | (uint32_t)(y * 5) << 8 | 0x40);
+                pixels.push_back((uint8_t)p);
+                pixels.push_back((uint8_t)(p >> 8));
+            }
+        }
+    }
+    return pixels.data();
+}
+
+// =============================================================================
+// DISPLAY HAL STAND-IN
+// =============================================================================
+
+// Canvas the hal_display_* calls below draw into
+static Canvas *hal_canvas = nullptr;
+
+// Set to leave the next hal_display_flush() to the scene runner, which measures it
+static bool hal_flush_deferred = false;
+
+hal_status_t hal_display_clear(uint32_t color)
+{
+    hal_canvas->fill_rect(0, 0, RENDER_WIDTH, RENDER_HEIGHT, rgb(color));
+    return HAL_OK;
+}
+
+hal_status_t hal_display_update(const display_buffer_t *buffer)
+{
+    hal_canvas->blit(buffer->x_offset, buffer->y_offset, buffer->width, buffer->height, buffer->data);
+    return HAL_OK;
+}
+
+hal_status_t hal_display_set_pixel(uint16_t x, uint16_t y, uint32_t color)
+{
+    hal_canvas->set_pixel(x, y, rgb(color));
+    return HAL_OK;
+}
+
+hal_status_t hal_display_draw_rect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t color, bool filled)
+{
+    if (filled)
+    {
+        hal_canvas->fill_rect(x, y, width, height, rgb(color));
+    }
+    else
+    {
+        hal_canvas->draw_rect(x, y, width, height, rgb(color));
+    }
+    return HAL_OK;
+}
+
+hal_status_t hal_display_draw_text(uint16_t x, uint16_t y, const char *text, uint32_t color, uint32_t bg_color)
+{
+    hal_canvas->draw_text(x, y, text, rgb(color), rgb(bg_color));
+    return HAL_OK;
+}
+
+hal_status_t hal_display_flush(void)
+{
+    if (!hal_flush_deferred)
+    {
+        hal_canvas->flush();
+    }
+    hal_flush_deferred = false;
+    return HAL_OK;
+}
+
+uint32_t hal_get_tick_ms(void)
+{
+    return 0;
+}
+
+uint64_t hal_get_time_us(void)
+{
+    return 0;
+}
+
+/**
+ * Status screen after a minute of once-a-second refreshes; the last one's flush is the scene's
+ */
+static void widget_screen(Canvas &c, int seconds, bool connected)
+{
+    hal_canvas = &c;
+    display_manager_init(RENDER_WIDTH, RENDER_HEIGHT, 0x000000, 100);
+    status_indicators_init();
+
+    status_indicators_state_t state = {};
+    for (int s = 0; s <= seconds; s++)
+    {
+        // A loop rate that wanders between about 900 and 1500 loops/s
+        state.uptime_ms = (uint32_t)s * 1000;
+        state.loop_count += (uint32_t)(1200 + (s * 37 % 23 - 11) * 25);
+        state.wifi_connected = connected && s >= 3;
+        state.rssi = -52 - s % 7;
+        state.address = "192.168.1.50";
+        status_indicators_update(&state);
+        hal_flush_deferred = s == seconds;
+        display_manager_update();
+    }
+}
+
+static void chart_column(const uint16_t *pixels, uint16_t height, void *context)
+{
+    (void)height;
+    static_cast<Canvas *>(context)->scroll_column(pixels);
+}
+
+/**
+ * The firmware's strip chart screen while streaming: three synthetic channels at 1 kHz, 50 columns/s, lane
+ * values refreshed ten times a second. Runs past a full chart width so the scroll area wraps; the last
+ * refresh is the scene's, with the columns scrolled in since the one before.
+ */
+static void chart_screen(Canvas &c, int columns)
+{
+    const uint32_t colors[STRIP_CHART_MAX_CHANNELS] = {0xFFE000, 0x00E0FF, 0xFF60C0, 0x80FF40};
+    const int chart_x = 80; // DISPLAY_CHART_X
+    const int channels = 3; // SAMPLER_CHANNELS
+    const int samples_per_column = 20;
+
+    hal_canvas = &c;
+    display_manager_init(RENDER_WIDTH, RENDER_HEIGHT, 0x000000, 100);
+    ui_widget_id_t captions = ui_panel_create(UI_SCREEN, 0, 0, chart_x, RENDER_HEIGHT, 0x101828, 0x5070A0);
+    ui_widget_id_t values[channels];
+    for (int ch = 0; ch < channels; ch++)
+    {
+        char caption[8];
+        snprintf(caption, sizeof(caption), "CH%d", ch + 1);
+        uint16_t y = (uint16_t)(ch * (RENDER_HEIGHT / channels) + RENDER_HEIGHT / channels / 2 - 10);
+        ui_label_create(captions, 8, y, 4, caption, colors[ch]);
+        values[ch] = ui_value_create(captions, 8, (uint16_t)(y + 12), 7, 2, " V", 0xFFFFFF);
+    }
+    ui_panel_create(UI_SCREEN, chart_x, 0, RENDER_WIDTH - chart_x, RENDER_HEIGHT, 0x000000, 0x000000);
+    display_manager_update();
+    c.scroll_area(chart_x, RENDER_WIDTH - chart_x);
+
+    strip_chart_config_t config = {};
+    config.height = RENDER_HEIGHT;
+    config.channels = channels;
+    config.samples_per_column = samples_per_column;
+    config.max = 4095;
+    memcpy(config.colors, colors, sizeof(config.colors));
+    config.grid = 0x304060;
+    config.output = chart_column;
+    config.context = &c;
+    strip_chart_init(&config);
+
+    // A sine, a square wave with a spike, and a slow ramp with noise; read 32 frames at a time as the UDP stream does
+    uint16_t frames[32 * channels];
+    int frame = 0;
+    for (int col = 1; col <= columns; col++)
+    {
+        for (int f = 0; f < samples_per_column; f++, frame++)
+        {
+            uint16_t *out = &frames[(frame % 32) * channels];
+            out[0] = (uint16_t)(2048 + 1600 * sin(frame * 0.004));
+            out[1] = (uint16_t)(frame % 1700 < 850 ? 900 : 3100) + (frame % 997 == 0 ? 800 : 0);
+            out[2] = (uint16_t)(frame * 7 % 4000 + (frame * 7919) % 61);
+            if (frame % 32 == 31)
+            {
+                strip_chart_push_block(frames, 32, channels);
+            }
+        }
+        strip_chart_update();
+
+        if (col % 5 == 0)
+        {
+            for (int ch = 0; ch < channels; ch++)
+            {
+                ui_value_set(values[ch], strip_chart_get_latest((uint8_t)ch) * 3.3f / 4095.0f);
+            }
+            hal_flush_deferred = col == columns;
+            display_manager_update();
+        }
+    }
+}
+
+struct Scene
+{
+    const char *name;
+    std::function<void(Canvas &)> draw;
+};
+
+static const std::vector<Scene> scenes = {
+    {"status", [](Canvas &c) { status_screen(c, 0, 0); }},
+    {"status_update",
+     // Second refresh of the status screen: only the changed digits are drawn and sent
+     [](Canvas &c) {
+         status_screen(c, 41, 123456);
+         c.flush();
+         status_screen(c, 42, 123460, false);
+     }},
+    {"relabel",
+     // Cached strings replaced by shorter ones, in other colours, and partly drawn over
+     [](Canvas &c) {
+         status_screen(c, 9, 99);
+         c.flush();
+         status_screen(c, 10, 100, false);
+         c.draw_text(80, 80, "STOPPED", rgb(0xFF0000), rgb(0x000080));
+         c.draw_text(80, 80, "OK", rgb(0xFF0000), rgb(0x000080));
+         c.fill_rect(10, 28, 30, 4, rgb(0xFF00FF));
+         c.draw_text(10, 30, "Uptime: 10 s", rgb(0x00FF00), rgb(0x000080));
+     }},
+    {"charset",
+     [](Canvas &c) {
+         char line[17] = {};
+         for (int ch = 32; ch < 128; ch++)
+         {
+             line[(ch - 32) % 16] = (char)ch;
+             if ((ch - 32) % 16 == 15)
+             {
+                 c.draw_text(8, 8 + (ch - 32) / 16 * 12, line, rgb(0xFFFFFF), rgb(0x202020));
+             }
+         }
+     }},
+    {"clipping",
+     [](Canvas &c) {
+         c.fill_rect(-20, -20, 60, 60, rgb(0xFF0000));
+         c.fill_rect(RENDER_WIDTH - 30, RENDER_HEIGHT - 30, 60, 60, rgb(0x00FF00));
+         c.draw_rect(-5, 100, RENDER_WIDTH + 10, 20, rgb(0xFFFF00));
+         c.draw_text(RENDER_WIDTH - 20, 50, "clipped", rgb(0xFFFFFF), rgb(0x0000FF));
+         c.draw_text(-9, RENDER_HEIGHT - 4, "edge", rgb(0xFFFFFF), rgb(0x0000FF));
+         c.set_pixel(RENDER_WIDTH, 0, rgb(0xFFFFFF));
+     }},
+    {"scattered",
+     // More separate changes than there are dirty slots
+     [](Canvas &c) {
+         for (int i = 0; i < 24; i++)
+         {
+             c.fill_rect((i * 53) % (RENDER_WIDTH - 8), (i * 37) % (RENDER_HEIGHT - 8), 8, 8,
+                         rgb(0x808080 + i * 0x050505));
+         }
+     }},
+    {"layered",
+     // Partly covered drawing, blits and redraws: what the band list has to keep in order
+     [](Canvas &c) {
+         c.fill_rect(20, 20, 120, 80, rgb(0x400000));
+         c.blit(-16, 150, 64, 48, gradient());
+         c.blit(100, 60, 64, 48, gradient());
+         c.draw_text(40, 70, "under the blit", rgb(0xFFFFFF), rgb(0x400000));
+         c.flush();
+         c.fill_rect(30, 30, 20, 20, rgb(0x00FFFF));
+         c.draw_text(150, 90, "over", rgb(0x000000), rgb(0xFFFF00));
+         c.draw_text(40, 70, "under the blit", rgb(0xFFFFFF), rgb(0x400000));
+         c.fill_rect(20, 20, 120, 80, rgb(0x400000));
+         c.draw_text(40, 40, "covered, redrawn", rgb(0xFFFFFF), rgb(0x400000));
+     }},
+    {"widgets",
+     // One more refresh of a running status screen: changed digits, bar step, plot scrolled by a column
+     [](Canvas &c) { widget_screen(c, 60, true); }},
+    {"widgets_hidden",
+     // Panels hidden and shown again: what they covered repainted, then all of them redrawn
+     [](Canvas &c) {
+         // Widgets in creation order: 3 and 11 are the system and network panels, 12 the WiFi LED
+         widget_screen(c, 20, true);
+         ui_widget_set_visible(3, false);
+         ui_widget_set_visible(11, false);
+         display_manager_update();
+         ui_widget_set_visible(11, true);
+         ui_widget_set_visible(3, true);
+         display_manager_update();
+         ui_widget_set_visible(12, false);
+         hal_flush_deferred = true;
+         display_manager_update();
+     }},
+    {"strip_chart", [](Canvas &c) { chart_screen(c, 300); }},
+};
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+// Scene name to "<hash> <bus bytes>"
+static std::map<std::string, std::string> read_golden(const std::string &path)
+{
+    std::map<std::string, std::string> golden;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string name, hash, bytes;
+        if (fields >> name >> hash >> bytes)
+        {
+            golden[name] = hash + " " + bytes;
+        }
+    }
+    return golden;
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    if (!parse_options(argc, argv, opt))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::map<std::string, std::string> golden;
+    if (!opt.check_file.empty())
+    {
+        golden = read_golden(opt.check_file);
+        if (golden.empty())
+        {
+            fprintf(stderr, "No golden hashes in %s\n", opt.check_file.c_str());
+            return 1;
+        }
+    }
+
+    std::string updated = "# Pixel hashes of the display_render scenes and SPI bytes of their last flush; "
+                          "regenerate with --update\n";
+    int failures = 0;
+
+    printf("framebuffer %zu bytes, bands %zu bytes (display list %zu + %d %d-row bands)\n",
+           (size_t)RENDER_WIDTH * RENDER_HEIGHT * 2,
+           sizeof(display_list_t) + RENDER_BAND_BUFFERS * RENDER_WIDTH * RENDER_BAND_HEIGHT * 2,
+           sizeof(display_list_t), RENDER_BAND_BUFFERS, RENDER_BAND_HEIGHT);
+    printf("%-16s %-16s %6s %9s %9s %6s %9s %8s %8s %8s\n", "scene", "hash", "rects", "pushed", "of", "bands",
+           "pushed", "windows", "bytes", "mirror");
+    for (const Scene &scene : scenes)
+    {
+        Canvas canvas;
+        scene.draw(canvas);
+
+        // What the final flush sends
+        size_t before = canvas.rects();
+        size_t pushed = canvas.flush();
+        char hash[17];
+        snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)canvas.hash());
+        std::string expected = std::string(hash) + " " + std::to_string(canvas.bus().bytes);
+        printf("%-16s %-16s %6zu %9zu %9d %6zu %9zu %8u %8llu %8llu", scene.name, hash, canvas.rects() - before,
+               pushed, RENDER_WIDTH * RENDER_HEIGHT, canvas.band_pushes(), canvas.band_pushed(), canvas.bus().windows,
+               (unsigned long long)canvas.bus().bytes, (unsigned long long)canvas.mirror_bytes());
+
+        // Band mode has to put the same pixels on the panel
+        if (!canvas.bands_match() || canvas.band_dropped())
+        {
+            printf("  BANDS DIFFER");
+            failures++;
+        }
+
+        // ... and so has a viewer of the mirror
+        if (!canvas.mirror_matches())
+        {
+            printf("  MIRROR DIFFERS");
+            failures++;
+        }
+
+        if (!opt.check_file.empty())
+        {
+            auto it = golden.find(scene.name);
+            bool ok = it != golden.end() && it->second == expected;
+            printf("  %s", ok ? "ok" : (it == golden.end() ? "MISSING" : "CHANGED"));
+            failures += ok ? 0 : 1;
+        }
+        printf("\n");
+
+        updated += std::string(scene.name) + " " + expected + "\n";
+        if (!opt.output_dir.empty() && !canvas.write_ppm(opt.output_dir + "/" + scene.name + ".ppm"))
+        {
+            return 1;
+        }
+    }
+
+    if (!opt.update_file.empty())
+    {
+        std::ofstream out(opt.update_file);
+        out << updated;
+        if (!out)
+        {
+            fprintf(stderr, "Cannot write %s\n", opt.update_file.c_str());
+            return 1;
+        }
+    }
+
+    if (failures)
+    {
+        fprintf(stderr, "%d scene(s) differ from %s\n", failures, opt.check_file.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,1250 @@
+/**
+ * @file rig_gateway.cpp
+ * @brief Fan several rigs in to one time-ordered feed for any number of dashboards
+ *
+ * Each rig serves at most WEBSOCKET_MAX_CLIENTS dashboards over WiFi. The
+ * gateway takes one of those slots per rig, merges what the rigs send into
+ * one feed ordered by time, and serves it to as many browsers as the host
+ * can handle, so viewers cost the rigs nothing.
+ *
+ * Every forwarded message gains "rig" (which rig sent it) and "time"
+ * (Unix microseconds: the rig's own "ts" when its clock is synced, else
+ * when the gateway received it). Messages are held for --hold-ms and
+ * released in time order, so bursts delayed by WiFi power save interleave
+ * correctly with the other rigs; anything later than that is sent at once
+ * with "late":true. A browser joining mid-session first gets the latest
+ * telemetry of every rig as keyframes, rather than waiting for the rigs'
+ * next ones.
+ *
+ * Browsers send the usual command envelopes, plus "rig":"NAME" to pick a
+ * rig; without it the command goes to every connected rig, each reply
+ * tagged with its rig. Replies are routed back to the browser that asked.
+ * With --udp, rigs streaming samples here (STREAM_START <gateway>:PORT)
+ * add one "samples" summary per block to the feed.
+ *
+ * Usage:
+ *   rig_gateway --rig NAME=HOST[:PORT] [--rig ...] [--listen PORT] [--udp PORT]
+ *               [--hold-ms N] [--max-clients N]
+ *
+ * The dashboard connects to the gateway exactly as it would to a rig.
+ * tools/rig_gateway/rig_sim stands in for real rigs on one machine.
+ */
+
+#include "ws_link.h"
+
+#include "json_reader.h"
+#include "json_writer.h"
+#include "sample_stream.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// CONSTANTS
+// =============================================================================
+
+#define GATEWAY_DEFAULT_RIG_PORT 8080
+#define GATEWAY_PROTOCOL "rig.json"          // Browsers offering it get it; CBOR is not spoken here
+#define GATEWAY_CONNECT_TIMEOUT_MS 5000      // Connect plus handshake
+#define GATEWAY_RETRY_MIN_MS 1000            // Reconnect backoff, doubled per failure
+#define GATEWAY_RETRY_MAX_MS 30000
+#define GATEWAY_COMMAND_TIMEOUT_MS 30000     // Forget unanswered commands after this long
+#define GATEWAY_STATUS_INTERVAL_MS 5000      // "gateway" message to every browser
+#define GATEWAY_CLIENT_QUEUE_LIMIT (1 << 20) // Per-browser backlog before feed messages are dropped
+#define GATEWAY_MESSAGE_SIZE 1024            // Messages the gateway composes itself
+
+// =============================================================================
+// OPTIONS
+// =============================================================================
+
+struct RigSpec
+{
+    std::string name;
+    std::string host;
+    uint16_t port = GATEWAY_DEFAULT_RIG_PORT;
+};
+
+struct Options
+{
+    std::vector<RigSpec> rigs;
+    uint16_t listen_port = 8080;
+    uint16_t udp_port = 0;
+    uint32_t hold_ms = 250;
+    size_t max_clients = 64;
+};
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int)
+{
+    stop_requested = 1;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "Usage: %s --rig NAME=HOST[:PORT] [--rig ...] [--listen PORT] [--udp PORT] [--hold-ms N]\n"
+            "          [--max-clients N]\n"
+            "  --rig NAME=HOST[:PORT]  Rig to connect to (port 8080 unless given); NAME defaults to HOST\n"
+            "  --listen PORT           WebSocket port for browsers (default 8080)\n"
+            "  --udp PORT              Accept the rigs' UDP sample streams on this port\n"
+            "  --hold-ms N             How long messages wait to be put in time order (default 250)\n"
+            "  --max-clients N         Browser connections accepted (default 64)\n",
+            argv0);
+}
+
+static bool valid_name(const std::string &name)
+{
+    // Names go into JSON unescaped
+    return !name.empty() && name.size() < 32 &&
+           std::all_of(name.begin(), name.end(), [](char c) { return isalnum((unsigned char)c) || strchr("_.-", c); });
+}
+
+static bool parse_options(int argc, char **argv, Options &opt)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (value == nullptr)
+        {
+            return false;
+        }
+
+        if (arg == "--rig")
+        {
+            RigSpec rig;
+            std::string target = value;
+            size_t equals = target.find('=');
+            if (equals != std::string::npos)
+            {
+                rig.name = target.substr(0, equals);
+                target.erase(0, equals + 1);
+            }
+            if (!split_host_port(target, rig.host, rig.port))
+            {
+                return false;
+            }
+            if (rig.name.empty())
+            {
+                rig.name = rig.host;
+            }
+            if (!valid_name(rig.name))
+            {
+                fprintf(stderr, "Rig names may only use letters, digits, '_', '.' and '-'\n");
+                return false;
+            }
+            opt.rigs.push_back(rig);
+        }
+        else if (arg == "--listen")
+        {
+            opt.listen_port = (uint16_t)atoi(value);
+        }
+        else if (arg == "--udp")
+        {
+            opt.udp_port = (uint16_t)atoi(value);
+        }
+        else if (arg == "--hold-ms")
+        {
+            opt.hold_ms = (uint32_t)atoi(value);
+        }
+        else if (arg == "--max-clients")
+        {
+            opt.max_clients = (size_t)atoi(value);
+        }
+        else
+        {
+            return false;
+        }
+        i++;
+    }
+
+    for (size_t i = 0; i < opt.rigs.size(); i++)
+    {
+        for (size_t j = 0; j < i; j++)
+        {
+            if (opt.rigs[i].name == opt.rigs[j].name)
+            {
+                fprintf(stderr, "Rig name '%s' is used twice\n", opt.rigs[i].name.c_str());
+                return false;
+            }
+        }
+    }
+    return !opt.rigs.empty() && opt.listen_port != 0;
+}
+
+// =============================================================================
+// JSON MEMBERS
+// =============================================================================
+
+/**
+ * One top-level member of a message, as written: the key without quotes,
+ * the value including them. Messages are re-assembled from these, so the
+ * gateway never re-encodes what it only passes through.
+ */
+struct JsonMember
+{
+    std::string key;
+    std::string value;
+    json_token_t type;
+};
+
+static bool split_object(const std::string &text, std::vector<JsonMember> &members)
+{
+    json_reader_t r;
+    json_reader_init(&r, text.data(), text.size());
+    members.clear();
+    if (json_next(&r) != JSON_TOKEN_OBJECT_BEGIN)
+    {
+        return false;
+    }
+
+    json_token_t token;
+    while ((token = json_next(&r)) == JSON_TOKEN_KEY)
+    {
+        JsonMember member;
+        member.key.assign(r.token, r.token_len);
+        member.type = json_next(&r);
+
+        const char *start = r.token;
+        const char *end = r.token + r.token_len;
+        if (member.type == JSON_TOKEN_STRING)
+        {
+            start--; // Keep the quotes
+            end++;
+        }
+        else if (member.type == JSON_TOKEN_OBJECT_BEGIN || member.type == JSON_TOKEN_ARRAY_BEGIN)
+        {
+            if (!json_skip(&r))
+            {
+                return false;
+            }
+            end = r.p;
+        }
+        else if (member.type == JSON_TOKEN_ERROR || member.type == JSON_TOKEN_END)
+        {
+            return false;
+        }
+        member.value.assign(start, (size_t)(end - start));
+        members.push_back(std::move(member));
+    }
+    return token == JSON_TOKEN_OBJECT_END;
+}
+
+static const JsonMember *find_member(const std::vector<JsonMember> &members, const char *key)
+{
+    for (const JsonMember &member : members)
+    {
+        if (member.key == key)
+        {
+            return &member;
+        }
+    }
+    return nullptr;
+}
+
+static std::string string_value(const JsonMember *member)
+{
+    // Only used for simple identifiers (types, rig names), which never need escapes
+    if (member == nullptr || member->type != JSON_TOKEN_STRING || member->value.size() < 2)
+    {
+        return "";
+    }
+    return member->value.substr(1, member->value.size() - 2);
+}
+
+/**
+ * Build an object from leading members (already "key":value text) followed
+ * by the given members, minus any whose key is in skip.
+ */
+static std::string join_object(const std::string &lead, const std::vector<JsonMember> &members,
+                               std::initializer_list<const char *> skip)
+{
+    std::string out = "{" + lead;
+    for (const JsonMember &member : members)
+    {
+        bool skipped = false;
+        for (const char *key : skip)
+        {
+            skipped |= member.key == key;
+        }
+        if (skipped)
+        {
+            continue;
+        }
+        if (out.size() > 1)
+        {
+            out += ',';
+        }
+        out += '"' + member.key + "\":" + member.value;
+    }
+    return out + "}";
+}
+
+// =============================================================================
+// TELEMETRY STATE
+// =============================================================================
+
+/**
+ * Latest value of every telemetry field a rig has sent, so a browser that
+ * joins late can be given the full picture at once. Rigs send only the
+ * fields that changed, one level deep ("status" nests its fields under
+ * "system"), so members are merged at both levels.
+ */
+class TelemetryState
+{
+public:
+    static bool is_telemetry(const std::string &type) { return type == "channel_data" || type == "status"; }
+
+    void update(const std::string &type, const std::vector<JsonMember> &members)
+    {
+        const JsonMember *channel = find_member(members, "channel");
+        Entry &entry = entries_[type + "/" + (channel ? channel->value : "")];
+        entry.type = type;
+
+        for (const JsonMember &member : members)
+        {
+            if (member.key == "type" || member.key == "keyframe" || member.key == "ts" || member.key == "synced")
+            {
+                continue;
+            }
+
+            std::vector<JsonMember> nested;
+            if (member.type == JSON_TOKEN_OBJECT_BEGIN && split_object(member.value, nested))
+            {
+                for (const JsonMember &field : nested)
+                {
+                    set(entry.nested[member.key], field.key, field.value);
+                }
+            }
+            else
+            {
+                set(entry.fields, member.key, member.value);
+            }
+        }
+    }
+
+    // One keyframe message body per tracked item
+    std::vector<std::string> keyframes() const
+    {
+        std::vector<std::string> out;
+        for (const auto &item : entries_)
+        {
+            const Entry &entry = item.second;
+            std::string text = "{\"type\":\"" + entry.type + "\"";
+            for (const auto &field : entry.fields)
+            {
+                text += ",\"" + field.first + "\":" + field.second;
+            }
+            for (const auto &object : entry.nested)
+            {
+                text += ",\"" + object.first + "\":{";
+                for (size_t i = 0; i < object.second.size(); i++)
+                {
+                    text += (i ? ",\"" : "\"") + object.second[i].first + "\":" + object.second[i].second;
+                }
+                text += "}";
+            }
+            out.push_back(text + ",\"keyframe\":true}");
+        }
+        return out;
+    }
+
+private:
+    typedef std::vector<std::pair<std::string, std::string>> Fields; // Kept in first-seen order
+
+    struct Entry
+    {
+        std::string type;
+        Fields fields;
+        std::map<std::string, Fields> nested;
+    };
+
+    static void set(Fields &fields, const std::string &key, const std::string &value)
+    {
+        for (auto &field : fields)
+        {
+            if (field.first == key)
+            {
+                field.second = value;
+                return;
+            }
+        }
+        fields.emplace_back(key, value);
+    }
+
+    std::map<std::string, Entry> entries_;
+};
+
+// =============================================================================
+// CONNECTIONS
+// =============================================================================
+
+struct Rig
+{
+    RigSpec spec;
+    sockaddr_in addr = {};
+    bool resolved = false;
+    std::unique_ptr<WsLink> link;
+    uint64_t attempt_ms = 0;      // When the current connection attempt started
+    uint64_t next_attempt_ms = 0; // Earliest reconnect
+    uint32_t backoff_ms = GATEWAY_RETRY_MIN_MS;
+    TelemetryState telemetry;
+    sample_stream_tracker_t samples;
+
+    uint32_t connects = 0;
+    uint64_t messages = 0;
+    uint64_t blocks = 0;
+
+    bool connected() const { return link && link->is_open(); }
+};
+
+struct Browser
+{
+    uint32_t id;
+    std::string peer;
+    std::unique_ptr<WsLink> link;
+    bool greeted = false; // Snapshot sent once the handshake finished
+    uint64_t dropped = 0;
+};
+
+struct PendingCommand
+{
+    uint32_t browser;
+    size_t rig;
+    std::string id; // The browser's own id, as written
+    std::string type;
+    uint64_t sent_ms;
+};
+
+/**
+ * A message waiting for its turn. seq breaks ties so messages with the same
+ * time keep their arrival order.
+ */
+struct FeedItem
+{
+    int64_t time_us;
+    uint64_t seq;
+    size_t rig;
+    std::string body; // Members after "rig" and "time", without the braces
+
+    bool operator>(const FeedItem &other) const
+    {
+        return time_us != other.time_us ? time_us > other.time_us : seq > other.seq;
+    }
+};
+
+// =============================================================================
+// GATEWAY
+// =============================================================================
+
+class Gateway
+{
+public:
+    explicit Gateway(const Options &opt) : opt_(opt)
+    {
+        for (const RigSpec &spec : opt.rigs)
+        {
+            Rig rig;
+            rig.spec = spec;
+            sample_stream_tracker_init(&rig.samples);
+            rigs_.push_back(std::move(rig));
+        }
+    }
+
+    bool open()
+    {
+        listener_ = tcp_listen(opt_.listen_port);
+        if (listener_ < 0)
+        {
+            return false;
+        }
+        if (opt_.udp_port != 0)
+        {
+            udp_ = open_udp(opt_.udp_port);
+            if (udp_ < 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void run()
+    {
+        uint64_t last_report_ms = monotonic_ms();
+        uint64_t last_status_ms = last_report_ms;
+
+        while (!stop_requested)
+        {
+            uint64_t now_ms = monotonic_ms();
+            maintain_rigs(now_ms);
+            expire_commands(now_ms);
+
+            if (now_ms - last_status_ms >= GATEWAY_STATUS_INTERVAL_MS)
+            {
+                broadcast_status();
+                last_status_ms = now_ms;
+            }
+            if (now_ms - last_report_ms >= 2000)
+            {
+                report();
+                last_report_ms = now_ms;
+            }
+
+            poll_once();
+            release_feed(false);
+        }
+
+        release_feed(true);
+        for (Browser &browser : browsers_)
+        {
+            browser.link->close(1001);
+        }
+        fprintf(stderr, "\n");
+        report();
+        fprintf(stderr, "\n");
+    }
+
+    ~Gateway()
+    {
+        if (listener_ >= 0)
+        {
+            close(listener_);
+        }
+        if (udp_ >= 0)
+        {
+            close(udp_);
+        }
+    }
+
+private:
+    // -------------------------------------------------------------------------
+    // Event loop
+    // -------------------------------------------------------------------------
+
+    void poll_once()
+    {
+        std::vector<pollfd> fds;
+        fds.push_back({listener_, POLLIN, 0});
+        fds.push_back({udp_, (short)(udp_ >= 0 ? POLLIN : 0), 0});
+        for (Rig &rig : rigs_)
+        {
+            int fd = rig.link ? rig.link->fd() : -1;
+            fds.push_back({fd, (short)(POLLIN | (rig.link && rig.link->wants_write() ? POLLOUT : 0)), 0});
+        }
+        for (Browser &browser : browsers_)
+        {
+            fds.push_back({browser.link->fd(), (short)(POLLIN | (browser.link->wants_write() ? POLLOUT : 0)), 0});
+        }
+
+        // Wake up in time to release the oldest held message
+        int timeout_ms = 100;
+        if (!feed_.empty())
+        {
+            int64_t due_us = feed_.top().time_us + (int64_t)opt_.hold_ms * 1000 - wall_clock_us();
+            timeout_ms = (int)std::max<int64_t>(0, std::min<int64_t>(timeout_ms, due_us / 1000 + 1));
+        }
+
+        if (poll(fds.data(), fds.size(), timeout_ms) < 0)
+        {
+            if (errno != EINTR)
+            {
+                perror("poll");
+                stop_requested = 1;
+            }
+            return;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            accept_browsers();
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            receive_samples();
+        }
+
+        for (size_t i = 0; i < rigs_.size(); i++)
+        {
+            short events = fds[2 + i].revents;
+            if (events != 0 && rigs_[i].link)
+            {
+                service_rig(i, events);
+            }
+        }
+
+        // Browsers may be removed while servicing, so match them up by fd first
+        std::vector<std::pair<uint32_t, short>> ready;
+        for (size_t i = 0; i < browsers_.size(); i++)
+        {
+            short events = fds[2 + rigs_.size() + i].revents;
+            if (events != 0)
+            {
+                ready.emplace_back(browsers_[i].id, events);
+            }
+        }
+        for (const auto &item : ready)
+        {
+            service_browser(item.first, item.second);
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    // Rigs
+    // -------------------------------------------------------------------------
+
+    void maintain_rigs(uint64_t now_ms)
+    {
+        for (size_t i = 0; i < rigs_.size(); i++)
+        {
+            Rig &rig = rigs_[i];
+            if (rig.link && !rig.link->is_open() && now_ms - rig.attempt_ms >= GATEWAY_CONNECT_TIMEOUT_MS)
+            {
+                rig.link->abort("connect timed out");
+                rig_lost(i, now_ms);
+            }
+            if (rig.link || now_ms < rig.next_attempt_ms)
+            {
+                continue;
+            }
+
+            rig.attempt_ms = now_ms;
+            rig.resolved = rig.resolved || resolve_ipv4(rig.spec.host, rig.spec.port, &rig.addr);
+            int fd = rig.resolved ? tcp_connect(rig.addr) : -1;
+            if (fd < 0)
+            {
+                schedule_retry(rig, now_ms);
+                continue;
+            }
+            std::string host = rig.spec.host + ":" + std::to_string(rig.spec.port);
+            rig.link.reset(new WsLink(WsLink::client(fd, host, GATEWAY_PROTOCOL)));
+        }
+    }
+
+    void schedule_retry(Rig &rig, uint64_t now_ms)
+    {
+        rig.next_attempt_ms = now_ms + rig.backoff_ms;
+        rig.backoff_ms = std::min<uint32_t>(rig.backoff_ms * 2, GATEWAY_RETRY_MAX_MS);
+    }
+
+    void service_rig(size_t index, short events)
+    {
+        Rig &rig = rigs_[index];
+        bool was_open = rig.link->is_open();
+        std::vector<WsMessage> messages;
+        bool alive = true;
+
+        if (events & (POLLOUT | POLLERR | POLLHUP))
+        {
+            alive = rig.link->on_writable();
+        }
+        if (alive && (events & (POLLIN | POLLERR | POLLHUP)))
+        {
+            alive = rig.link->on_readable(messages);
+        }
+
+        if (!was_open && rig.link->is_open())
+        {
+            rig.connects++;
+            rig.backoff_ms = GATEWAY_RETRY_MIN_MS;
+            fprintf(stderr, "\n[%s] connected to %s:%u\n", rig.spec.name.c_str(), rig.spec.host.c_str(),
+                    rig.spec.port);
+            broadcast_status();
+        }
+
+        for (const WsMessage &message : messages)
+        {
+            if (message.opcode == WS_OPCODE_TEXT)
+            {
+                from_rig(index, message.data);
+            }
+        }
+
+        if (!alive)
+        {
+            rig_lost(index, monotonic_ms());
+        }
+    }
+
+    void rig_lost(size_t index, uint64_t now_ms)
+    {
+        Rig &rig = rigs_[index];
+        std::string why = rig.link ? rig.link->error() : "";
+        rig.link.reset();
+        schedule_retry(rig, now_ms);
+
+        fprintf(stderr, "\n[%s] %s; retrying in %llu ms\n", rig.spec.name.c_str(),
+                why.empty() ? "disconnected" : why.c_str(), (unsigned long long)(rig.next_attempt_ms - now_ms));
+
+        // Commands in flight to this rig will not be answered
+        for (auto it = pending_.begin(); it != pending_.end();)
+        {
+            if (it->second.rig == index)
+            {
+                reply_error(it->second, "rig disconnected");
+                it = pending_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        broadcast_status();
+    }
+
+    void from_rig(size_t index, const std::string &text)
+    {
+        Rig &rig = rigs_[index];
+        std::vector<JsonMember> members;
+        if (!split_object(text, members))
+        {
+            return;
+        }
+        rig.messages++;
+
+        std::string type = string_value(find_member(members, "type"));
+        if (type == "result" || type == "batch_result")
+        {
+            route_reply(index, members);
+            return;
+        }
+
+        if (TelemetryState::is_telemetry(type))
+        {
+            rig.telemetry.update(type, members);
+        }
+
+        // The rig's own timestamp when it is on the host clock
+        int64_t time_us = wall_clock_us();
+        const JsonMember *ts = find_member(members, "ts");
+        const JsonMember *synced = find_member(members, "synced");
+        if (ts && ts->type == JSON_TOKEN_NUMBER && synced && synced->type == JSON_TOKEN_TRUE)
+        {
+            time_us = strtoll(ts->value.c_str(), nullptr, 10);
+        }
+
+        std::string body = join_object("", members, {"rig", "time"});
+        enqueue(index, time_us, body.substr(1, body.size() - 2));
+    }
+
+    void route_reply(size_t index, const std::vector<JsonMember> &members)
+    {
+        const JsonMember *id = find_member(members, "id");
+        auto it = id ? pending_.find((uint32_t)strtoul(id->value.c_str(), nullptr, 10)) : pending_.end();
+        if (it == pending_.end())
+        {
+            return; // Timed out, or the browser left
+        }
+
+        std::string lead = "\"rig\":\"" + rigs_[index].spec.name + "\",\"id\":" + it->second.id;
+        send_to_browser(it->second.browser, join_object(lead, members, {"id", "rig"}));
+        pending_.erase(it);
+    }
+
+    // -------------------------------------------------------------------------
+    // Browsers
+    // -------------------------------------------------------------------------
+
+    void accept_browsers()
+    {
+        sockaddr_in peer;
+        int fd;
+        while ((fd = tcp_accept(listener_, &peer)) >= 0)
+        {
+            if (browsers_.size() >= opt_.max_clients)
+            {
+                const char *busy = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+                send(fd, busy, strlen(busy), MSG_NOSIGNAL);
+                close(fd);
+                rejected_++;
+                continue;
+            }
+
+            char address[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &peer.sin_addr, address, sizeof(address));
+
+            Browser browser;
+            browser.id = next_browser_id_++;
+            browser.peer = std::string(address) + ":" + std::to_string(ntohs(peer.sin_port));
+            browser.link.reset(new WsLink(WsLink::server(fd, GATEWAY_PROTOCOL)));
+            browsers_.push_back(std::move(browser));
+        }
+    }
+
+    Browser *find_browser(uint32_t id)
+    {
+        for (Browser &browser : browsers_)
+        {
+            if (browser.id == id)
+            {
+                return &browser;
+            }
+        }
+        return nullptr;
+    }
+
+    void service_browser(uint32_t id, short events)
+    {
+        Browser *browser = find_browser(id);
+        if (browser == nullptr)
+        {
+            return;
+        }
+
+        std::vector<WsMessage> messages;
+        bool alive = true;
+        if (events & (POLLOUT | POLLERR | POLLHUP))
+        {
+            alive = browser->link->on_writable();
+        }
+        if (alive && (events & (POLLIN | POLLERR | POLLHUP)))
+        {
+            alive = browser->link->on_readable(messages);
+        }
+
+        if (browser->link->is_open() && !browser->greeted)
+        {
+            browser->greeted = true;
+            greet(*browser);
+        }
+        for (const WsMessage &message : messages)
+        {
+            if (message.opcode == WS_OPCODE_TEXT)
+            {
+                from_browser(id, message.data);
+            }
+        }
+
+        if (!alive)
+        {
+            remove_browser(id);
+        }
+    }
+
+    void greet(Browser &browser)
+    {
+        fprintf(stderr, "\nViewer %s connected (%zu watching)\n", browser.peer.c_str(), browsers_.size());
+        browser.link->send_text(status_message());
+
+        // Full telemetry of every rig now, instead of at the rigs' next keyframes. It is
+        // stamped where the feed has got to, so the held messages that follow stay in order.
+        int64_t now_us = released_us_ != INT64_MIN ? released_us_ : wall_clock_us() - (int64_t)opt_.hold_ms * 1000;
+        for (const Rig &rig : rigs_)
+        {
+            for (const std::string &keyframe : rig.telemetry.keyframes())
+            {
+                browser.link->send_text("{\"rig\":\"" + rig.spec.name + "\",\"time\":" + std::to_string(now_us) + "," +
+                                        keyframe.substr(1));
+            }
+        }
+    }
+
+    void remove_browser(uint32_t id)
+    {
+        for (auto it = browsers_.begin(); it != browsers_.end(); ++it)
+        {
+            if (it->id == id)
+            {
+                fprintf(stderr, "\nViewer %s left%s%s\n", it->peer.c_str(), it->link->error().empty() ? "" : ": ",
+                        it->link->error().c_str());
+                browsers_.erase(it);
+                break;
+            }
+        }
+        for (auto it = pending_.begin(); it != pending_.end();)
+        {
+            it = it->second.browser == id ? pending_.erase(it) : std::next(it);
+        }
+    }
+
+    void from_browser(uint32_t browser, const std::string &text)
+    {
+        std::vector<JsonMember> members;
+        if (!split_object(text, members))
+        {
+            return;
+        }
+        std::string type = string_value(find_member(members, "type"));
+        if (type != "command" && type != "batch")
+        {
+            return;
+        }
+
+        const JsonMember *id_member = find_member(members, "id");
+        PendingCommand command;
+        command.browser = browser;
+        command.id = id_member ? id_member->value : "null";
+        command.type = type == "batch" ? "batch_result" : "result";
+        command.sent_ms = monotonic_ms();
+
+        std::string target = string_value(find_member(members, "rig"));
+        bool matched = false;
+        for (size_t i = 0; i < rigs_.size(); i++)
+        {
+            if (!target.empty() && rigs_[i].spec.name != target)
+            {
+                continue;
+            }
+            matched = true;
+            command.rig = i;
+            if (!rigs_[i].connected())
+            {
+                reply_error(command, "rig not connected");
+                continue;
+            }
+
+            // The rig sees a gateway id, unique across browsers
+            uint32_t gateway_id = next_command_id_++;
+            rigs_[i].link->send_text(join_object("\"id\":" + std::to_string(gateway_id), members, {"id", "rig"}));
+            pending_[gateway_id] = command;
+            commands_++;
+        }
+
+        if (!matched)
+        {
+            command.rig = SIZE_MAX;
+            reply_error(command, "no such rig");
+        }
+    }
+
+    void reply_error(const PendingCommand &command, const char *error)
+    {
+        std::string rig = command.rig < rigs_.size() ? "\"" + rigs_[command.rig].spec.name + "\"" : "null";
+        send_to_browser(command.browser, "{\"type\":\"" + command.type + "\",\"rig\":" + rig + ",\"id\":" +
+                                             command.id + ",\"ok\":false,\"error\":\"" + error + "\"}");
+    }
+
+    void expire_commands(uint64_t now_ms)
+    {
+        for (auto it = pending_.begin(); it != pending_.end();)
+        {
+            if (now_ms - it->second.sent_ms >= GATEWAY_COMMAND_TIMEOUT_MS)
+            {
+                reply_error(it->second, "rig did not answer");
+                it = pending_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void send_to_browser(uint32_t id, const std::string &text)
+    {
+        Browser *browser = find_browser(id);
+        if (browser && browser->link->is_open())
+        {
+            browser->link->send_text(text);
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    // Feed
+    // -------------------------------------------------------------------------
+
+    void enqueue(size_t rig, int64_t time_us, std::string body)
+    {
+        if (time_us < released_us_)
+        {
+            // Its moment has passed; better out of order than not at all
+            late_++;
+            deliver(rig, time_us, body, true);
+            return;
+        }
+        feed_.push(FeedItem{time_us, next_seq_++, rig, std::move(body)});
+    }
+
+    void release_feed(bool all)
+    {
+        int64_t cutoff = wall_clock_us() - (int64_t)opt_.hold_ms * 1000;
+        while (!feed_.empty() && (all || feed_.top().time_us <= cutoff))
+        {
+            const FeedItem &item = feed_.top();
+            released_us_ = std::max(released_us_, item.time_us);
+            deliver(item.rig, item.time_us, item.body, false);
+            feed_.pop();
+        }
+    }
+
+    void deliver(size_t rig, int64_t time_us, const std::string &body, bool late)
+    {
+        std::string text = "{\"rig\":\"" + rigs_[rig].spec.name + "\",\"time\":" + std::to_string(time_us) +
+                           (late ? ",\"late\":true" : "") + (body.empty() ? "" : ",") + body + "}";
+        delivered_++;
+
+        for (Browser &browser : browsers_)
+        {
+            if (!browser.link->is_open())
+            {
+                continue;
+            }
+            // A viewer that cannot keep up loses feed messages, not the connection
+            if (browser.link->queued() > GATEWAY_CLIENT_QUEUE_LIMIT)
+            {
+                browser.dropped++;
+                dropped_++;
+                continue;
+            }
+            browser.link->send_text(text);
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    // UDP sample streams
+    // -------------------------------------------------------------------------
+
+    static int open_udp(uint16_t port)
+    {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0)
+        {
+            perror("socket");
+            return -1;
+        }
+        int rcvbuf = 4 * 1024 * 1024;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+        if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0)
+        {
+            fprintf(stderr, "Cannot listen on UDP port %u: %s\n", port, strerror(errno));
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void receive_samples()
+    {
+        uint8_t datagram[65536];
+        for (;;)
+        {
+            sockaddr_in from = {};
+            socklen_t from_len = sizeof(from);
+            ssize_t len = recvfrom(udp_, datagram, sizeof(datagram), MSG_DONTWAIT, (sockaddr *)&from, &from_len);
+            if (len <= 0)
+            {
+                return;
+            }
+
+            // Blocks are attributed by source address
+            size_t index = rigs_.size();
+            for (size_t i = 0; i < rigs_.size(); i++)
+            {
+                if (rigs_[i].resolved && rigs_[i].addr.sin_addr.s_addr == from.sin_addr.s_addr)
+                {
+                    index = i;
+                    break;
+                }
+            }
+
+            sample_stream_header_t header;
+            const uint8_t *payload;
+            if (index == rigs_.size() || !sample_stream_parse(datagram, (size_t)len, &header, &payload))
+            {
+                stray_datagrams_++;
+                continue;
+            }
+            summarize_block(index, header, payload);
+        }
+    }
+
+    void summarize_block(size_t index, const sample_stream_header_t &header, const uint8_t *payload)
+    {
+        Rig &rig = rigs_[index];
+        uint64_t lost_before = rig.samples.samples_lost;
+        sample_stream_event_t event = sample_stream_track(&rig.samples, &header);
+        if (event == SAMPLE_STREAM_LATE)
+        {
+            return;
+        }
+        rig.blocks++;
+
+        uint16_t low[SAMPLE_STREAM_MAX_CHANNELS];
+        uint16_t high[SAMPLE_STREAM_MAX_CHANNELS];
+        uint32_t sum[SAMPLE_STREAM_MAX_CHANNELS] = {};
+        for (unsigned ch = 0; ch < header.channel_count; ch++)
+        {
+            low[ch] = UINT16_MAX;
+            high[ch] = 0;
+        }
+        for (uint16_t frame = 0; frame < header.frame_count; frame++)
+        {
+            for (unsigned ch = 0; ch < header.channel_count; ch++)
+            {
+                uint16_t sample = sample_stream_get_sample(payload, (size_t)frame * header.channel_count + ch);
+                low[ch] = std::min(low[ch], sample);
+                high[ch] = std::max(high[ch], sample);
+                sum[ch] += sample;
+            }
+        }
+
+        char text[GATEWAY_MESSAGE_SIZE];
+        json_writer_t w;
+        json_writer_init(&w, text, sizeof(text));
+        json_begin_object(&w);
+        json_kv_string(&w, "type", "samples");
+        json_kv_uint(&w, "first", header.first_sample);
+        json_kv_uint(&w, "frames", header.frame_count);
+        json_kv_uint(&w, "rateHz", header.sample_rate_hz);
+        json_kv_uint(&w, "lost", (uint32_t)(rig.samples.samples_lost - lost_before));
+        json_key(&w, "min");
+        json_begin_array(&w);
+        for (unsigned ch = 0; ch < header.channel_count; ch++)
+        {
+            json_uint(&w, low[ch]);
+        }
+        json_end_array(&w);
+        json_key(&w, "max");
+        json_begin_array(&w);
+        for (unsigned ch = 0; ch < header.channel_count; ch++)
+        {
+            json_uint(&w, high[ch]);
+        }
+        json_end_array(&w);
+        json_key(&w, "mean");
+        json_begin_array(&w);
+        for (unsigned ch = 0; ch < header.channel_count; ch++)
+        {
+            json_float(&w, header.frame_count ? (float)sum[ch] / header.frame_count : 0.0f, 1);
+        }
+        json_end_array(&w);
+        json_end_object(&w);
+
+        size_t len = json_writer_finish(&w);
+        if (len < 2)
+        {
+            return;
+        }
+        bool host_time = (header.flags & SAMPLE_STREAM_FLAG_HOST_TIME) != 0;
+        enqueue(index, host_time ? (int64_t)header.timestamp_us : wall_clock_us(), std::string(text + 1, len - 2));
+    }
+
+    // -------------------------------------------------------------------------
+    // Status
+    // -------------------------------------------------------------------------
+
+    std::string status_message() const
+    {
+        char text[GATEWAY_MESSAGE_SIZE * 4];
+        json_writer_t w;
+        json_writer_init(&w, text, sizeof(text));
+        json_begin_object(&w);
+        json_kv_string(&w, "type", "gateway");
+        json_kv_uint(&w, "viewers", (uint32_t)browsers_.size());
+        json_kv_uint(&w, "holdMs", opt_.hold_ms);
+        json_key(&w, "rigs");
+        json_begin_array(&w);
+        for (const Rig &rig : rigs_)
+        {
+            json_begin_object(&w);
+            json_kv_string(&w, "name", rig.spec.name.c_str());
+            json_kv_bool(&w, "connected", rig.connected());
+            json_kv_uint(&w, "messages", (uint32_t)rig.messages);
+            json_kv_uint(&w, "blocks", (uint32_t)rig.blocks);
+            json_kv_uint(&w, "samplesLost", (uint32_t)rig.samples.samples_lost);
+            json_end_object(&w);
+        }
+        json_end_array(&w);
+        json_end_object(&w);
+        size_t len = json_writer_finish(&w);
+        return std::string(text, len);
+    }
+
+    void broadcast_status()
+    {
+        std::string text = status_message();
+        for (Browser &browser : browsers_)
+        {
+            if (browser.link->is_open())
+            {
+                browser.link->send_text(text);
+            }
+        }
+    }
+
+    void report() const
+    {
+        size_t connected = 0;
+        for (const Rig &rig : rigs_)
+        {
+            connected += rig.connected() ? 1 : 0;
+        }
+        fprintf(stderr, "\r%zu/%zu rigs, %zu viewers, %llu delivered, %llu late, %llu dropped, %llu commands   ",
+                connected, rigs_.size(), browsers_.size(), (unsigned long long)delivered_,
+                (unsigned long long)late_, (unsigned long long)dropped_, (unsigned long long)commands_);
+    }
+
+    const Options &opt_;
+    int listener_ = -1;
+    int udp_ = -1;
+    std::vector<Rig> rigs_;
+    std::vector<Browser> browsers_;
+    std::map<uint32_t, PendingCommand> pending_;
+    std::priority_queue<FeedItem, std::vector<FeedItem>, std::greater<FeedItem>> feed_;
+    int64_t released_us_ = INT64_MIN; // Newest time already delivered
+    uint64_t next_seq_ = 0;
+    uint32_t next_browser_id_ = 1;
+    uint32_t next_command_id_ = 1;
+
+    uint64_t delivered_ = 0;
+    uint64_t late_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t commands_ = 0;
+    uint32_t rejected_ = 0;
+    uint32_t stray_datagrams_ = 0;
+};
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    if (!parse_options(argc, argv, opt))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    Gateway gateway(opt);
+    if (!gateway.open())
+    {
+        return 1;
+    }
+
+    fprintf(stderr, "Serving %zu rig(s) on ws://0.0.0.0:%u/ws", opt.rigs.size(), opt.listen_port);
+    if (opt.udp_port)
+    {
+        fprintf(stderr, ", sample streams on UDP %u", opt.udp_port);
+    }
+    fprintf(stderr, "\n");
+
+    gateway.run();
+    return 0;
+}
@@ -0,0 +1,577 @@
+/**
+ * @file rig_sim.cpp
+ * @brief Stand-in rig for exercising rig_gateway on one machine
+ *
+ * Speaks the firmware's WebSocket protocol (JSON encoding only): the same
+ * command envelopes run through src/utils/command_registry, channel_data
+ * readings, status messages, and logs stamped with "ts"/"synced". It
+ * keeps the firmware's limit of four clients.
+ *
+ * Usage:
+ *   rig_sim [--port N] [--name NAME] [--rate-ms N] [--burst-ms N] [--skew-us N]
+ *           [--unsynced]
+ *
+ * --burst-ms holds outgoing messages and sends them in bursts, the way a
+ * rig in WiFi power save does, so the gateway's reordering can be seen.
+ * --skew-us offsets the simulated host clock. STREAM_START sends sample
+ * blocks stamped with host time, like a synced rig.
+ */
+
+#include "ws_link.h"
+
+#include "command_registry.h"
+#include "json_writer.h"
+#include "sample_stream.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// CONSTANTS
+// =============================================================================
+
+#define SIM_MAX_CLIENTS 4          // As MAX_WEBSOCKET_CLIENTS on the Pico W
+#define SIM_CHANNELS 4             // As NUM_DIAGNOSTIC_CHANNELS
+#define SIM_STATUS_INTERVAL_MS 1000
+#define SIM_LOG_INTERVAL_MS 3000
+#define SIM_STREAM_RATE_HZ 1000
+#define SIM_STREAM_FRAMES 100
+#define SIM_MESSAGE_SIZE 512
+
+// =============================================================================
+// OPTIONS
+// =============================================================================
+
+struct Options
+{
+    uint16_t port = 8080;
+    std::string name = "sim";
+    uint32_t rate_ms = 100;
+    uint32_t burst_ms = 0;
+    int64_t skew_us = 0;
+    bool synced = true;
+};
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int)
+{
+    stop_requested = 1;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "Usage: %s [--port N] [--name NAME] [--rate-ms N] [--burst-ms N] [--skew-us N] [--unsynced]\n"
+            "  --port N      WebSocket port (default 8080)\n"
+            "  --name NAME   Name used in logs (default sim)\n"
+            "  --rate-ms N   Interval between channel readings (default 100)\n"
+            "  --burst-ms N  Hold outgoing messages and send them every N ms\n"
+            "  --skew-us N   Offset of the simulated host clock\n"
+            "  --unsynced    Behave like a rig whose clock has not synced\n",
+            argv0);
+}
+
+static bool parse_options(int argc, char **argv, Options &opt)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--unsynced")
+        {
+            opt.synced = false;
+            continue;
+        }
+
+        const char *value = (i + 1 < argc) ? argv[++i] : nullptr;
+        if (value == nullptr)
+        {
+            return false;
+        }
+        if (arg == "--port")
+        {
+            opt.port = (uint16_t)atoi(value);
+        }
+        else if (arg == "--name")
+        {
+            opt.name = value;
+        }
+        else if (arg == "--rate-ms")
+        {
+            opt.rate_ms = (uint32_t)atoi(value);
+        }
+        else if (arg == "--burst-ms")
+        {
+            opt.burst_ms = (uint32_t)atoi(value);
+        }
+        else if (arg == "--skew-us")
+        {
+            opt.skew_us = strtoll(value, nullptr, 10);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return opt.port != 0 && opt.rate_ms != 0;
+}
+
+// =============================================================================
+// SIMULATED RIG
+// =============================================================================
+
+static Options options;
+static uint64_t boot_ms;
+static bool channels[SIM_CHANNELS];
+
+static int stream_socket = -1;
+static sockaddr_in stream_dest;
+static uint32_t stream_sequence;
+static uint32_t stream_first_sample;
+static uint64_t stream_next_ms;
+
+// Timestamp as the firmware reports it: host time when synced, else time since boot
+static uint64_t rig_time_us()
+{
+    if (options.synced)
+    {
+        return (uint64_t)(wall_clock_us() + options.skew_us);
+    }
+    return (monotonic_ms() - boot_ms) * 1000;
+}
+
+static float channel_voltage(int channel, uint64_t now_ms)
+{
+    if (!channels[channel - 1])
+    {
+        return 0.0f;
+    }
+    return 3.3f + 0.05f * (float)sin((double)now_ms / 1000.0 + channel);
+}
+
+// =============================================================================
+// COMMANDS
+// =============================================================================
+
+static cmd_status_t reply_channels(cmd_context_t *ctx)
+{
+    json_begin_object(ctx->json);
+    json_key(ctx->json, "channels");
+    json_begin_array(ctx->json);
+    for (int i = 0; i < SIM_CHANNELS; i++)
+    {
+        json_bool(ctx->json, channels[i]);
+    }
+    json_end_array(ctx->json);
+    json_end_object(ctx->json);
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_disable_channel(cmd_context_t *ctx)
+{
+    channels[ctx->args[0].i - 1] = false;
+    return reply_channels(ctx);
+}
+
+static cmd_status_t cmd_enable_channel(cmd_context_t *ctx)
+{
+    channels[ctx->args[0].i - 1] = true;
+    return reply_channels(ctx);
+}
+
+static cmd_status_t cmd_get_channels(cmd_context_t *ctx)
+{
+    return reply_channels(ctx);
+}
+
+static cmd_status_t cmd_get_status(cmd_context_t *ctx)
+{
+    json_begin_object(ctx->json);
+    json_kv_string(ctx->json, "name", options.name.c_str());
+    json_kv_uint(ctx->json, "uptime", (uint32_t)((monotonic_ms() - boot_ms) / 1000));
+    json_kv_bool(ctx->json, "synced", options.synced);
+    json_end_object(ctx->json);
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_set_channel(cmd_context_t *ctx)
+{
+    channels[ctx->args[0].i - 1] = ctx->args[1].b;
+    return reply_channels(ctx);
+}
+
+static cmd_status_t cmd_stream_start(cmd_context_t *ctx)
+{
+    std::string host;
+    uint16_t port = ctx->args[2].present ? (uint16_t)ctx->args[2].i : 8082;
+    if (!split_host_port(ctx->args[0].s, host, port) || !resolve_ipv4(host, port, &stream_dest))
+    {
+        return cmd_error(ctx, CMD_ERR_ARGS, "'dest' must be an IPv4 address");
+    }
+
+    if (stream_socket < 0)
+    {
+        stream_socket = socket(AF_INET, SOCK_DGRAM, 0);
+        if (stream_socket < 0)
+        {
+            return cmd_error(ctx, CMD_ERR_FAILED, "could not start the UDP stream");
+        }
+    }
+    stream_sequence = 0;
+    stream_first_sample = 0;
+    stream_next_ms = monotonic_ms();
+    return CMD_OK;
+}
+
+static cmd_status_t cmd_stream_stop(cmd_context_t *ctx)
+{
+    (void)ctx;
+    if (stream_socket >= 0)
+    {
+        close(stream_socket);
+        stream_socket = -1;
+    }
+    return CMD_OK;
+}
+
+static constexpr cmd_arg_spec_t channel_args[] = {
+    {"channel", CMD_ARG_INT, true, 1, SIM_CHANNELS},
+};
+
+static constexpr cmd_arg_spec_t set_channel_args[] = {
+    {"channel", CMD_ARG_INT, true, 1, SIM_CHANNELS},
+    {"enabled", CMD_ARG_BOOL, true, 0, 0},
+};
+
+static constexpr cmd_arg_spec_t stream_start_args[] = {
+    {"dest", CMD_ARG_STRING, true, 0, 21},
+    {"rate", CMD_ARG_INT, false, 1, SIM_STREAM_RATE_HZ},
+    {"port", CMD_ARG_INT, false, 1, 65535},
+};
+
+#define SIM_COMMAND(name, handler, args, help) {name, handler, args, sizeof(args) / sizeof(args[0]), help}
+#define SIM_COMMAND_NOARGS(name, handler, help) {name, handler, nullptr, 0, help}
+
+static constexpr cmd_def_t command_table[] = {
+    SIM_COMMAND("DISABLE_CHANNEL", cmd_disable_channel, channel_args, "<channel>"),
+    SIM_COMMAND("ENABLE_CHANNEL", cmd_enable_channel, channel_args, "<channel>"),
+    SIM_COMMAND_NOARGS("GET_CHANNELS", cmd_get_channels, "Channel states"),
+    SIM_COMMAND_NOARGS("GET_STATUS", cmd_get_status, "System summary"),
+    SIM_COMMAND("SET_CHANNEL", cmd_set_channel, set_channel_args, "<channel> <enabled>"),
+    SIM_COMMAND("STREAM_START", cmd_stream_start, stream_start_args, "<ip>[:port] [rate] [port=]"),
+    SIM_COMMAND_NOARGS("STREAM_STOP", cmd_stream_stop, "Stop the UDP stream"),
+};
+
+static_assert(command_table_is_sorted(command_table), "command_table must be sorted by name");
+
+// =============================================================================
+// SERVER
+// =============================================================================
+
+class SimServer
+{
+public:
+    bool open()
+    {
+        listener_ = tcp_listen(options.port);
+        return listener_ >= 0;
+    }
+
+    void run()
+    {
+        uint64_t next_reading_ms = monotonic_ms();
+        uint64_t next_status_ms = next_reading_ms;
+        uint64_t next_log_ms = next_reading_ms;
+        uint64_t next_flush_ms = next_reading_ms;
+
+        while (!stop_requested)
+        {
+            uint64_t now_ms = monotonic_ms();
+            if (now_ms >= next_reading_ms)
+            {
+                for (int channel = 1; channel <= SIM_CHANNELS; channel++)
+                {
+                    send_reading(channel, now_ms);
+                }
+                next_reading_ms += options.rate_ms;
+            }
+            if (now_ms >= next_status_ms)
+            {
+                send_status(now_ms);
+                next_status_ms += SIM_STATUS_INTERVAL_MS;
+            }
+            if (now_ms >= next_log_ms)
+            {
+                send_log("INFO", "SIM", "heartbeat");
+                next_log_ms += SIM_LOG_INTERVAL_MS;
+            }
+            if (stream_socket >= 0 && now_ms >= stream_next_ms)
+            {
+                send_block();
+                stream_next_ms += SIM_STREAM_FRAMES * 1000 / SIM_STREAM_RATE_HZ;
+            }
+            if (options.burst_ms == 0 || now_ms >= next_flush_ms)
+            {
+                flush_held();
+                next_flush_ms = now_ms + options.burst_ms;
+            }
+
+            poll_once();
+        }
+
+        for (Client &client : clients_)
+        {
+            client.link.close(1001);
+            client.link.on_writable();
+        }
+        close(listener_);
+    }
+
+private:
+    struct Client
+    {
+        WsLink link;
+        std::vector<std::string> held; // Waiting for the next burst
+    };
+
+    void poll_once()
+    {
+        std::vector<pollfd> fds;
+        fds.push_back({listener_, POLLIN, 0});
+        for (Client &client : clients_)
+        {
+            fds.push_back({client.link.fd(), (short)(POLLIN | (client.link.wants_write() ? POLLOUT : 0)), 0});
+        }
+
+        if (poll(fds.data(), fds.size(), 10) < 0)
+        {
+            if (errno != EINTR)
+            {
+                perror("poll");
+                stop_requested = 1;
+            }
+            return;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            accept_clients();
+        }
+
+        std::vector<bool> alive(clients_.size(), true);
+        for (size_t i = 0; i < clients_.size() && i + 1 < fds.size(); i++)
+        {
+            short events = fds[i + 1].revents;
+            std::vector<WsMessage> messages;
+            if (events & (POLLOUT | POLLERR | POLLHUP))
+            {
+                alive[i] = clients_[i].link.on_writable();
+            }
+            if (alive[i] && (events & (POLLIN | POLLERR | POLLHUP)))
+            {
+                alive[i] = clients_[i].link.on_readable(messages);
+            }
+            for (const WsMessage &message : messages)
+            {
+                if (message.opcode == WS_OPCODE_TEXT)
+                {
+                    execute(i, message.data);
+                }
+            }
+        }
+
+        for (size_t i = alive.size(); i-- > 0;)
+        {
+            if (!alive[i])
+            {
+                fprintf(stderr, "[%s] client left\n", options.name.c_str());
+                clients_.erase(clients_.begin() + i);
+            }
+        }
+    }
+
+    void accept_clients()
+    {
+        int fd;
+        while ((fd = tcp_accept(listener_, nullptr)) >= 0)
+        {
+            if (clients_.size() >= SIM_MAX_CLIENTS)
+            {
+                close(fd); // The firmware refuses the connection the same way
+                continue;
+            }
+            clients_.push_back(Client{WsLink::server(fd, "rig.json"), {}});
+            fprintf(stderr, "[%s] client connected\n", options.name.c_str());
+        }
+    }
+
+    void execute(size_t index, const std::string &text)
+    {
+        char reply[CMD_REPLY_MAX];
+        size_t len = command_execute_json(text.c_str(), CMD_SOURCE_WEBSOCKET, (int)index, JSON_FORMAT_TEXT, reply,
+                                          sizeof(reply));
+        if (len > 0)
+        {
+            // Replies are not held: the firmware answers from the receive callback
+            clients_[index].link.send_text(std::string(reply, len));
+        }
+    }
+
+    void broadcast(const char *text, size_t len)
+    {
+        for (Client &client : clients_)
+        {
+            if (!client.link.is_open())
+            {
+                continue;
+            }
+            if (options.burst_ms)
+            {
+                client.held.emplace_back(text, len);
+            }
+            else
+            {
+                client.link.send_text(std::string(text, len));
+            }
+        }
+    }
+
+    void flush_held()
+    {
+        for (Client &client : clients_)
+        {
+            for (const std::string &text : client.held)
+            {
+                client.link.send_text(text);
+            }
+            client.held.clear();
+        }
+    }
+
+    void send_reading(int channel, uint64_t now_ms)
+    {
+        char text[SIM_MESSAGE_SIZE];
+        json_writer_t w;
+        json_writer_init(&w, text, sizeof(text));
+        json_begin_object(&w);
+        json_kv_string(&w, "type", "channel_data");
+        json_kv_int(&w, "channel", channel);
+        json_kv_bool(&w, "enabled", channels[channel - 1]);
+        json_kv_float(&w, "voltage", channel_voltage(channel, now_ms), 2);
+        json_kv_float(&w, "current", channels[channel - 1] ? 0.1f * channel : 0.0f, 3);
+        json_end_object(&w);
+        broadcast(text, json_writer_finish(&w));
+    }
+
+    void send_status(uint64_t now_ms)
+    {
+        char text[SIM_MESSAGE_SIZE];
+        json_writer_t w;
+        json_writer_init(&w, text, sizeof(text));
+        json_begin_object(&w);
+        json_kv_string(&w, "type", "status");
+        json_key(&w, "system");
+        json_begin_object(&w);
+        json_kv_bool(&w, "wifi", true);
+        json_kv_int(&w, "rssi", -50 - (int)((now_ms / 1000) % 10));
+        json_kv_uint(&w, "uptime", (uint32_t)((now_ms - boot_ms) / 1000));
+        json_end_object(&w);
+        json_end_object(&w);
+        broadcast(text, json_writer_finish(&w));
+    }
+
+    void send_log(const char *level, const char *category, const char *message)
+    {
+        char text[SIM_MESSAGE_SIZE];
+        json_writer_t w;
+        json_writer_init(&w, text, sizeof(text));
+        json_begin_object(&w);
+        json_kv_string(&w, "type", "log");
+        json_kv_string(&w, "level", level);
+        json_kv_string(&w, "category", category);
+        json_key(&w, "ts");
+        json_uint64(&w, rig_time_us());
+        json_kv_bool(&w, "synced", options.synced);
+        json_kv_string(&w, "message", message);
+        json_end_object(&w);
+        broadcast(text, json_writer_finish(&w));
+    }
+
+    void send_block()
+    {
+        uint8_t datagram[SAMPLE_STREAM_HEADER_SIZE + SIM_STREAM_FRAMES * SIM_CHANNELS * 2];
+        sample_stream_header_t header = {};
+        header.version = SAMPLE_STREAM_VERSION;
+        header.channel_count = SIM_CHANNELS;
+        header.sequence = stream_sequence++;
+        header.timestamp_us = rig_time_us();
+        header.first_sample = stream_first_sample;
+        header.sample_rate_hz = SIM_STREAM_RATE_HZ;
+        header.frame_count = SIM_STREAM_FRAMES;
+        header.flags = options.synced ? SAMPLE_STREAM_FLAG_HOST_TIME : 0;
+        sample_stream_write_header(&header, datagram);
+
+        uint64_t now_ms = monotonic_ms();
+        for (uint16_t frame = 0; frame < SIM_STREAM_FRAMES; frame++)
+        {
+            uint16_t samples[SIM_CHANNELS];
+            for (int ch = 0; ch < SIM_CHANNELS; ch++)
+            {
+                samples[ch] = (uint16_t)(channel_voltage(ch + 1, now_ms) / 3.3f * 2048.0f) + frame % 8;
+            }
+            sample_stream_write_frame(datagram + SAMPLE_STREAM_HEADER_SIZE, frame, samples, SIM_CHANNELS);
+        }
+        stream_first_sample += SIM_STREAM_FRAMES;
+
+        sendto(stream_socket, datagram, sizeof(datagram), 0, (sockaddr *)&stream_dest, sizeof(stream_dest));
+    }
+
+    int listener_ = -1;
+    std::vector<Client> clients_;
+};
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(int argc, char **argv)
+{
+    if (!parse_options(argc, argv, options))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    boot_ms = monotonic_ms();
+    for (bool &channel : channels)
+    {
+        channel = true;
+    }
+    command_registry_init(command_table, sizeof(command_table) / sizeof(command_table[0]));
+
+    SimServer server;
+    if (!server.open())
+    {
+        return 1;
+    }
+    fprintf(stderr, "[%s] simulated rig on ws://0.0.0.0:%u/ws%s\n", options.name.c_str(), options.port,
+            options.synced ? "" : " (clock not synced)");
+    server.run();
+    return 0;
+}
@@ -0,0 +1,378 @@
+/**
+ * @file rig_watch.cpp
+ * @brief Watch a rig_gateway feed from the command line
+ *
+ * Connects the way a dashboard does, counts messages per rig and type, and
+ * checks that the feed arrives in time order. With --command it also sends
+ * one command and waits for the answer, so a script can check that
+ * commands reach the rigs through the gateway.
+ *
+ * Usage:
+ *   rig_watch [--gateway HOST[:PORT]] [--duration SECONDS] [--command "RIG COMMAND [params]"]
+ *             [--print]
+ *
+ * RIG may be "*" to send the command to every rig. Exits with status 1 if
+ * the connection fails, a command fails or goes unanswered, or messages
+ * arrive out of order without "late" set.
+ */
+
+#include "ws_link.h"
+
+#include "json_reader.h"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// OPTIONS
+// =============================================================================
+
+struct Options
+{
+    std::string host = "127.0.0.1";
+    uint16_t port = 8080;
+    double duration_s = 5;
+    std::string rig;     // Command target, "*" for all
+    std::string command; // Command name, empty for none
+    std::string params;  // JSON object text
+    bool print = false;
+};
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int)
+{
+    stop_requested = 1;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "Usage: %s [--gateway HOST[:PORT]] [--duration S] [--command \"RIG NAME [params]\"] [--print]\n"
+            "  --gateway HOST[:PORT]  Gateway to watch (default 127.0.0.1:8080)\n"
+            "  --duration S           Watch for S seconds (default 5)\n"
+            "  --command \"RIG NAME [params]\"\n"
+            "                         Send one command; RIG is a rig name or '*', params a JSON object\n"
+            "  --print                Print every message\n",
+            argv0);
+}
+
+static bool parse_command(const std::string &text, Options &opt)
+{
+    size_t space = text.find(' ');
+    if (space == std::string::npos)
+    {
+        return false;
+    }
+    opt.rig = text.substr(0, space);
+
+    std::string rest = text.substr(space + 1);
+    space = rest.find(' ');
+    opt.command = rest.substr(0, space);
+    opt.params = space == std::string::npos ? "" : rest.substr(space + 1);
+    return !opt.command.empty();
+}
+
+static bool parse_options(int argc, char **argv, Options &opt)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--print")
+        {
+            opt.print = true;
+            continue;
+        }
+
+        const char *value = (i + 1 < argc) ? argv[++i] : nullptr;
+        if (value == nullptr)
+        {
+            return false;
+        }
+        if (arg == "--gateway")
+        {
+            if (!split_host_port(value, opt.host, opt.port))
+            {
+                return false;
+            }
+        }
+        else if (arg == "--duration")
+        {
+            opt.duration_s = atof(value);
+        }
+        else if (arg == "--command")
+        {
+            if (!parse_command(value, opt))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return opt.duration_s > 0;
+}
+
+// =============================================================================
+// FEED CHECKS
+// =============================================================================
+
+/**
+ * The members rig_watch looks at. Values are token text: strings without
+ * quotes, numbers as written.
+ */
+struct Summary
+{
+    std::string type;
+    std::string rig;
+    std::string id;
+    std::string error;
+    int64_t time_us = 0;
+    bool has_time = false;
+    bool late = false;
+    bool ok = false;
+};
+
+static bool summarize(const std::string &text, Summary &summary)
+{
+    json_reader_t r;
+    json_reader_init(&r, text.data(), text.size());
+    if (json_next(&r) != JSON_TOKEN_OBJECT_BEGIN)
+    {
+        return false;
+    }
+
+    json_token_t token;
+    while ((token = json_next(&r)) == JSON_TOKEN_KEY)
+    {
+        std::string key(r.token, r.token_len);
+        json_token_t value = json_next(&r);
+        std::string text_value(r.token, value == JSON_TOKEN_OBJECT_BEGIN || value == JSON_TOKEN_ARRAY_BEGIN ? 0 : r.token_len);
+
+        if (key == "type")
+        {
+            summary.type = text_value;
+        }
+        else if (key == "rig")
+        {
+            summary.rig = text_value;
+        }
+        else if (key == "id")
+        {
+            summary.id = text_value;
+        }
+        else if (key == "error")
+        {
+            summary.error = text_value;
+        }
+        else if (key == "time" && value == JSON_TOKEN_NUMBER)
+        {
+            summary.time_us = strtoll(text_value.c_str(), nullptr, 10);
+            summary.has_time = true;
+        }
+        else if (key == "late")
+        {
+            summary.late = value == JSON_TOKEN_TRUE;
+        }
+        else if (key == "ok")
+        {
+            summary.ok = value == JSON_TOKEN_TRUE;
+        }
+
+        if (!json_skip(&r))
+        {
+            return false;
+        }
+    }
+    return token == JSON_TOKEN_OBJECT_END;
+}
+
+// =============================================================================
+// WATCHER
+// =============================================================================
+
+class Watcher
+{
+public:
+    explicit Watcher(const Options &opt) : opt_(opt) {}
+
+    bool run()
+    {
+        sockaddr_in addr;
+        if (!resolve_ipv4(opt_.host, opt_.port, &addr))
+        {
+            fprintf(stderr, "Cannot resolve %s\n", opt_.host.c_str());
+            return false;
+        }
+        int fd = tcp_connect(addr);
+        if (fd < 0)
+        {
+            return false;
+        }
+        WsLink link = WsLink::client(fd, opt_.host + ":" + std::to_string(opt_.port), "rig.json");
+
+        uint64_t start_ms = monotonic_ms();
+        uint64_t end_ms = start_ms + (uint64_t)(opt_.duration_s * 1000);
+        bool command_sent = false;
+
+        while (!stop_requested && monotonic_ms() < end_ms)
+        {
+            pollfd pfd = {link.fd(), (short)(POLLIN | (link.wants_write() ? POLLOUT : 0)), 0};
+            if (poll(&pfd, 1, 100) < 0 && errno != EINTR)
+            {
+                perror("poll");
+                return false;
+            }
+
+            std::vector<WsMessage> messages;
+            bool alive = true;
+            if (pfd.revents & (POLLOUT | POLLERR | POLLHUP))
+            {
+                alive = link.on_writable();
+            }
+            if (alive && (pfd.revents & (POLLIN | POLLERR | POLLHUP)))
+            {
+                alive = link.on_readable(messages);
+            }
+            for (const WsMessage &message : messages)
+            {
+                handle(message.data);
+            }
+            if (!alive)
+            {
+                fprintf(stderr, "Connection lost: %s\n", link.error().empty() ? "closed" : link.error().c_str());
+                return false;
+            }
+
+            if (link.is_open() && !command_sent && !opt_.command.empty())
+            {
+                std::string text = "{\"type\":\"command\",\"id\":1,\"command\":\"" + opt_.command + "\"";
+                if (opt_.rig != "*")
+                {
+                    text += ",\"rig\":\"" + opt_.rig + "\"";
+                }
+                if (!opt_.params.empty())
+                {
+                    text += ",\"params\":" + opt_.params;
+                }
+                link.send_text(text + "}");
+                command_sent = true;
+            }
+        }
+
+        link.close();
+        link.on_writable();
+        return report(monotonic_ms() - start_ms);
+    }
+
+private:
+    void handle(const std::string &text)
+    {
+        if (opt_.print)
+        {
+            printf("%s\n", text.c_str());
+        }
+
+        Summary summary;
+        if (!summarize(text, summary))
+        {
+            malformed_++;
+            return;
+        }
+
+        if (summary.type == "result" || summary.type == "batch_result")
+        {
+            replies_++;
+            fprintf(stderr, "Reply from %s: %s%s%s\n", summary.rig.c_str(), summary.ok ? "ok" : "failed",
+                    summary.error.empty() ? "" : ", ", summary.error.c_str());
+            failed_replies_ += summary.ok ? 0 : 1;
+            return;
+        }
+        if (summary.type == "gateway")
+        {
+            return;
+        }
+
+        counts_[summary.rig + " " + summary.type]++;
+        if (!summary.has_time)
+        {
+            malformed_++;
+            return;
+        }
+        if (summary.late)
+        {
+            late_++;
+        }
+        else if (summary.time_us < last_time_us_)
+        {
+            out_of_order_++;
+        }
+        else
+        {
+            last_time_us_ = summary.time_us;
+        }
+    }
+
+    bool report(uint64_t elapsed_ms) const
+    {
+        uint64_t total = 0;
+        for (const auto &count : counts_)
+        {
+            fprintf(stderr, "%-32s %8llu  %.1f/s\n", count.first.c_str(), (unsigned long long)count.second,
+                    count.second * 1000.0 / (elapsed_ms ? elapsed_ms : 1));
+            total += count.second;
+        }
+        fprintf(stderr, "%llu messages, %llu late, %llu out of order, %llu malformed\n", (unsigned long long)total,
+                (unsigned long long)late_, (unsigned long long)out_of_order_, (unsigned long long)malformed_);
+
+        bool ok = total > 0 && out_of_order_ == 0 && malformed_ == 0;
+        if (!opt_.command.empty())
+        {
+            fprintf(stderr, "%llu replies, %llu failed\n", (unsigned long long)replies_,
+                    (unsigned long long)failed_replies_);
+            ok = ok && replies_ > 0 && failed_replies_ == 0;
+        }
+        return ok;
+    }
+
+    const Options &opt_;
+    std::map<std::string, uint64_t> counts_;
+    int64_t last_time_us_ = 0;
+    uint64_t late_ = 0;
+    uint64_t out_of_order_ = 0;
+    uint64_t malformed_ = 0;
+    uint64_t replies_ = 0;
+    uint64_t failed_replies_ = 0;
+};
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    if (!parse_options(argc, argv, opt))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    Watcher watcher(opt);
+    return watcher.run() ? 0 : 1;
+}
@@ -0,0 +1,697 @@
+/**
+ * @file ws_link.cpp
+ * @brief Non-blocking WebSocket framing and handshakes over POSIX sockets
+ */
+
+#include "ws_link.h"
+
+#include "base64.h"
+#include "http_parser.h"
+#include "websocket_handshake.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+
+// =============================================================================
+// PRIVATE CONSTANTS
+// =============================================================================
+
+#define WS_OPCODE_CONTINUATION 0x0
+#define WS_OPCODE_CLOSE 0x8
+#define WS_OPCODE_PING 0x9
+#define WS_OPCODE_PONG 0xA
+
+#define WS_CLOSE_PROTOCOL_ERROR 1002
+#define WS_CLOSE_TOO_BIG 1009
+
+#define WS_READ_CHUNK 16384
+
+// =============================================================================
+// PRIVATE FUNCTIONS
+// =============================================================================
+
+static std::mt19937 &random_source()
+{
+    static std::mt19937 rng(std::random_device{}());
+    return rng;
+}
+
+static bool set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static void set_nodelay(int fd)
+{
+    // Messages are small and latency matters more than packet count
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+}
+
+// Case-insensitive header lookup in a raw HTTP response
+static std::string find_header(const std::string &head, const char *name)
+{
+    size_t name_len = strlen(name);
+    size_t pos = head.find("\r\n");
+    while (pos != std::string::npos && pos + 2 < head.size())
+    {
+        size_t start = pos + 2;
+        size_t end = head.find("\r\n", start);
+        if (end == std::string::npos)
+        {
+            break;
+        }
+        if (end - start > name_len && head[start + name_len] == ':' &&
+            strncasecmp(head.c_str() + start, name, name_len) == 0)
+        {
+            size_t value = start + name_len + 1;
+            while (value < end && (head[value] == ' ' || head[value] == '\t'))
+            {
+                value++;
+            }
+            size_t value_end = end;
+            while (value_end > value && (head[value_end - 1] == ' ' || head[value_end - 1] == '\t'))
+            {
+                value_end--;
+            }
+            return head.substr(value, value_end - value);
+        }
+        pos = end;
+    }
+    return "";
+}
+
+// =============================================================================
+// SOCKET HELPERS
+// =============================================================================
+
+int64_t wall_clock_us()
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint64_t monotonic_ms()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+int tcp_listen(uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        perror("socket");
+        return -1;
+    }
+
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0 || !set_nonblocking(fd))
+    {
+        fprintf(stderr, "Cannot listen on TCP port %u: %s\n", port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int tcp_accept(int listener, sockaddr_in *peer)
+{
+    sockaddr_in addr = {};
+    socklen_t addr_len = sizeof(addr);
+    int fd = accept(listener, (sockaddr *)&addr, &addr_len);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (!set_nonblocking(fd))
+    {
+        close(fd);
+        return -1;
+    }
+    set_nodelay(fd);
+    if (peer)
+    {
+        *peer = addr;
+    }
+    return fd;
+}
+
+bool resolve_ipv4(const std::string &host, uint16_t port, sockaddr_in *addr)
+{
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || result == nullptr)
+    {
+        return false;
+    }
+
+    *addr = *(const sockaddr_in *)result->ai_addr;
+    addr->sin_port = htons(port);
+    freeaddrinfo(result);
+    return true;
+}
+
+int tcp_connect(const sockaddr_in &addr)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (!set_nonblocking(fd))
+    {
+        close(fd);
+        return -1;
+    }
+    set_nodelay(fd);
+
+    if (connect(fd, (const sockaddr *)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool split_host_port(const std::string &text, std::string &host, uint16_t &port)
+{
+    size_t colon = text.rfind(':');
+    if (colon == std::string::npos)
+    {
+        host = text;
+        return !host.empty();
+    }
+
+    host = text.substr(0, colon);
+    char *end;
+    long value = strtol(text.c_str() + colon + 1, &end, 10);
+    if (*end != '\0' || value < 1 || value > 65535 || host.empty())
+    {
+        return false;
+    }
+    port = (uint16_t)value;
+    return true;
+}
+
+// =============================================================================
+// WEBSOCKET LINK
+// =============================================================================
+
+WsLink::WsLink(int fd, bool client) : fd_(fd), client_(client)
+{
+}
+
+WsLink WsLink::client(int fd, const std::string &host, const std::string &protocols)
+{
+    WsLink link(fd, true);
+    link.state_ = State::Connecting;
+    link.host_ = host;
+    link.offer_ = protocols;
+
+    uint8_t nonce[16];
+    for (uint8_t &byte : nonce)
+    {
+        byte = (uint8_t)random_source()();
+    }
+    char key[BASE64_ENCODED_LEN(sizeof(nonce)) + 1];
+    base64_encode(nonce, sizeof(nonce), key, sizeof(key));
+    link.key_ = key;
+    return link;
+}
+
+WsLink WsLink::server(int fd, const std::string &protocol)
+{
+    WsLink link(fd, false);
+    link.state_ = State::Handshake;
+    link.offer_ = protocol;
+    return link;
+}
+
+WsLink::WsLink(WsLink &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+WsLink &WsLink::operator=(WsLink &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+        }
+        fd_ = other.fd_;
+        client_ = other.client_;
+        state_ = other.state_;
+        closing_ = other.closing_;
+        host_ = std::move(other.host_);
+        offer_ = std::move(other.offer_);
+        protocol_ = std::move(other.protocol_);
+        key_ = std::move(other.key_);
+        in_ = std::move(other.in_);
+        out_ = std::move(other.out_);
+        fragments_ = std::move(other.fragments_);
+        fragment_opcode_ = other.fragment_opcode_;
+        error_ = std::move(other.error_);
+        other.fd_ = -1;
+        other.state_ = State::Closed;
+    }
+    return *this;
+}
+
+WsLink::~WsLink()
+{
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+    }
+}
+
+bool WsLink::on_readable(std::vector<WsMessage> &messages)
+{
+    if (state_ == State::Closed || state_ == State::Connecting)
+    {
+        return state_ != State::Closed;
+    }
+
+    char chunk[WS_READ_CHUNK];
+    bool eof = false;
+    for (;;)
+    {
+        ssize_t got = recv(fd_, chunk, sizeof(chunk), 0);
+        if (got > 0)
+        {
+            in_.append(chunk, (size_t)got);
+            continue;
+        }
+        if (got == 0)
+        {
+            eof = true;
+            break;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            break;
+        }
+        if (errno != EINTR)
+        {
+            abort(strerror(errno));
+            return false;
+        }
+    }
+
+    // Whatever arrived before the peer closed still counts
+    if (state_ == State::Handshake && !parse_handshake(messages))
+    {
+        return false;
+    }
+    if (state_ == State::Open && !parse_frames(messages))
+    {
+        return false;
+    }
+    if (eof)
+    {
+        abort(closing_ ? "" : "connection closed by peer");
+        return false;
+    }
+    return state_ != State::Closed;
+}
+
+bool WsLink::on_writable()
+{
+    if (state_ == State::Connecting)
+    {
+        int err = 0;
+        socklen_t err_len = sizeof(err);
+        if (getsockopt(fd_, SOL_SOCKET, SO_ERROR, &err, &err_len) < 0 || err != 0)
+        {
+            abort(strerror(err ? err : errno));
+            return false;
+        }
+
+        state_ = State::Handshake;
+        out_ = "GET /ws HTTP/1.1\r\n"
+               "Host: " + host_ + "\r\n"
+               "Upgrade: websocket\r\n"
+               "Connection: Upgrade\r\n"
+               "Sec-WebSocket-Key: " + key_ + "\r\n"
+               "Sec-WebSocket-Version: 13\r\n";
+        if (!offer_.empty())
+        {
+            out_ += "Sec-WebSocket-Protocol: " + offer_ + "\r\n";
+        }
+        out_ += "\r\n";
+    }
+    return flush();
+}
+
+void WsLink::send(uint8_t opcode, const void *data, size_t len)
+{
+    if (state_ != State::Open || closing_)
+    {
+        return;
+    }
+    queue_frame(opcode, data, len);
+    flush();
+}
+
+void WsLink::close(uint16_t code)
+{
+    if (state_ != State::Open || closing_)
+    {
+        abort("");
+        return;
+    }
+    uint8_t payload[2] = {(uint8_t)(code >> 8), (uint8_t)code};
+    queue_frame(WS_OPCODE_CLOSE, payload, sizeof(payload));
+    closing_ = true;
+    flush();
+}
+
+void WsLink::abort(const std::string &why)
+{
+    if (error_.empty())
+    {
+        error_ = why;
+    }
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    state_ = State::Closed;
+    out_.clear();
+}
+
+void WsLink::queue_frame(uint8_t opcode, const void *data, size_t len)
+{
+    uint8_t header[14];
+    size_t header_len = 2;
+    header[0] = (uint8_t)(0x80 | opcode);
+    if (len < 126)
+    {
+        header[1] = (uint8_t)len;
+    }
+    else if (len <= 0xFFFF)
+    {
+        header[1] = 126;
+        header[2] = (uint8_t)(len >> 8);
+        header[3] = (uint8_t)len;
+        header_len = 4;
+    }
+    else
+    {
+        header[1] = 127;
+        for (int i = 0; i < 8; i++)
+        {
+            header[2 + i] = (uint8_t)((uint64_t)len >> (56 - 8 * i));
+        }
+        header_len = 10;
+    }
+
+    // Clients must mask every frame (RFC 6455 section 5.3)
+    uint8_t mask[4] = {0, 0, 0, 0};
+    if (client_)
+    {
+        uint32_t bits = random_source()();
+        memcpy(mask, &bits, sizeof(mask));
+        header[1] |= 0x80;
+        memcpy(header + header_len, mask, sizeof(mask));
+        header_len += 4;
+    }
+
+    out_.append((const char *)header, header_len);
+    size_t start = out_.size();
+    out_.append((const char *)data, len);
+    if (client_)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            out_[start + i] = (char)(out_[start + i] ^ mask[i & 3]);
+        }
+    }
+}
+
+bool WsLink::parse_handshake(std::vector<WsMessage> &messages)
+{
+    size_t end = in_.find("\r\n\r\n");
+    if (end == std::string::npos)
+    {
+        if (in_.size() > WS_LINK_MAX_HANDSHAKE)
+        {
+            abort("handshake too large");
+            return false;
+        }
+        return true;
+    }
+
+    std::string head = in_.substr(0, end + 4);
+    in_.erase(0, end + 4);
+    bool ok = client_ ? client_handshake_done(head) : server_handshake_done(head);
+    if (!ok)
+    {
+        return false;
+    }
+    state_ = State::Open;
+    return parse_frames(messages);
+}
+
+bool WsLink::client_handshake_done(const std::string &response)
+{
+    if (response.compare(0, 12, "HTTP/1.1 101") != 0)
+    {
+        abort("handshake refused: " + response.substr(0, response.find("\r\n")));
+        return false;
+    }
+
+    char expected[WEBSOCKET_ACCEPT_SIZE];
+    if (!websocket_compute_accept(key_.c_str(), expected, sizeof(expected)) ||
+        find_header(response, "Sec-WebSocket-Accept") != expected)
+    {
+        abort("handshake accept key mismatch");
+        return false;
+    }
+    if (!find_header(response, "Sec-WebSocket-Extensions").empty())
+    {
+        abort("server enabled an extension that was not offered");
+        return false;
+    }
+    protocol_ = find_header(response, "Sec-WebSocket-Protocol");
+    return true;
+}
+
+bool WsLink::server_handshake_done(const std::string &request)
+{
+    http_parser_t parser;
+    http_parser_init(&parser);
+    size_t consumed = 0;
+    http_parse_status_t status = http_parser_feed(&parser, request.data(), request.size(), &consumed);
+
+    const char *key = status == HTTP_PARSE_DONE ? http_parser_header(&parser, HTTP_HEADER_SEC_WEBSOCKET_KEY) : nullptr;
+    char accept[WEBSOCKET_ACCEPT_SIZE];
+    if (key == nullptr || !http_header_has_token(http_parser_header(&parser, HTTP_HEADER_UPGRADE), "websocket") ||
+        !websocket_compute_accept(key, accept, sizeof(accept)))
+    {
+        const char *refusal = "HTTP/1.1 426 Upgrade Required\r\n"
+                              "Sec-WebSocket-Version: 13\r\n"
+                              "Content-Length: 0\r\n"
+                              "Connection: close\r\n"
+                              "\r\n";
+        ::send(fd_, refusal, strlen(refusal), MSG_NOSIGNAL);
+        abort("not a WebSocket request");
+        return false;
+    }
+
+    out_ = "HTTP/1.1 101 Switching Protocols\r\n"
+           "Upgrade: websocket\r\n"
+           "Connection: Upgrade\r\n"
+           "Sec-WebSocket-Accept: " + std::string(accept) + "\r\n";
+    if (!offer_.empty() &&
+        http_header_has_token(http_parser_header(&parser, HTTP_HEADER_SEC_WEBSOCKET_PROTOCOL), offer_.c_str()))
+    {
+        protocol_ = offer_;
+        out_ += "Sec-WebSocket-Protocol: " + protocol_ + "\r\n";
+    }
+    out_ += "\r\n";
+    return flush();
+}
+
+bool WsLink::parse_frames(std::vector<WsMessage> &messages)
+{
+    for (;;)
+    {
+        if (in_.size() < 2)
+        {
+            return true;
+        }
+        const uint8_t *p = (const uint8_t *)in_.data();
+        bool fin = (p[0] & 0x80) != 0;
+        uint8_t opcode = p[0] & 0x0F;
+        bool masked = (p[1] & 0x80) != 0;
+        uint64_t len = p[1] & 0x7F;
+        size_t header_len = 2;
+
+        if ((p[0] & 0x70) != 0 || masked == client_)
+        {
+            // No extension sets RSV bits, and only clients mask
+            return fail(WS_CLOSE_PROTOCOL_ERROR, "protocol error");
+        }
+        if (len == 126)
+        {
+            if (in_.size() < 4)
+            {
+                return true;
+            }
+            len = ((uint64_t)p[2] << 8) | p[3];
+            header_len = 4;
+        }
+        else if (len == 127)
+        {
+            if (in_.size() < 10)
+            {
+                return true;
+            }
+            len = 0;
+            for (int i = 0; i < 8; i++)
+            {
+                len = (len << 8) | p[2 + i];
+            }
+            header_len = 10;
+        }
+        if (len + fragments_.size() > WS_LINK_MAX_MESSAGE)
+        {
+            return fail(WS_CLOSE_TOO_BIG, "message too big");
+        }
+
+        size_t mask_at = header_len;
+        if (masked)
+        {
+            header_len += 4;
+        }
+        if (in_.size() < header_len + len)
+        {
+            return true;
+        }
+
+        std::string payload = in_.substr(header_len, (size_t)len);
+        if (masked)
+        {
+            for (size_t i = 0; i < payload.size(); i++)
+            {
+                payload[i] = (char)(payload[i] ^ p[mask_at + (i & 3)]);
+            }
+        }
+        in_.erase(0, header_len + (size_t)len);
+
+        switch (opcode)
+        {
+        case WS_OPCODE_PING:
+            if (!closing_)
+            {
+                queue_frame(WS_OPCODE_PONG, payload.data(), payload.size());
+                flush();
+            }
+            break;
+        case WS_OPCODE_PONG:
+            break;
+        case WS_OPCODE_CLOSE:
+            if (!closing_)
+            {
+                // Echo the status code, then the exchange is over
+                queue_frame(WS_OPCODE_CLOSE, payload.data(), payload.size() >= 2 ? 2 : 0);
+                flush();
+            }
+            abort(closing_ ? "" : "closed by peer");
+            return false;
+        case WS_OPCODE_CONTINUATION:
+        case WS_OPCODE_TEXT:
+        case WS_OPCODE_BINARY:
+            if ((opcode == WS_OPCODE_CONTINUATION) != (fragment_opcode_ != 0))
+            {
+                return fail(WS_CLOSE_PROTOCOL_ERROR, "bad fragment sequence");
+            }
+            if (opcode != WS_OPCODE_CONTINUATION)
+            {
+                fragment_opcode_ = opcode;
+            }
+            fragments_ += payload;
+            if (fin)
+            {
+                messages.push_back(WsMessage{fragment_opcode_, std::move(fragments_)});
+                fragments_.clear();
+                fragment_opcode_ = 0;
+            }
+            break;
+        default:
+            return fail(WS_CLOSE_PROTOCOL_ERROR, "unknown opcode");
+        }
+    }
+}
+
+bool WsLink::fail(uint16_t code, const char *why)
+{
+    // Best effort: tell the peer why, then drop whatever else it sent
+    if (!closing_)
+    {
+        uint8_t payload[2] = {(uint8_t)(code >> 8), (uint8_t)code};
+        queue_frame(WS_OPCODE_CLOSE, payload, sizeof(payload));
+        flush();
+    }
+    abort(why);
+    return false;
+}
+
+bool WsLink::flush()
+{
+    while (!out_.empty() && fd_ >= 0)
+    {
+        ssize_t sent = ::send(fd_, out_.data(), out_.size(), MSG_NOSIGNAL);
+        if (sent > 0)
+        {
+            out_.erase(0, (size_t)sent);
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return true;
+        }
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        abort(strerror(errno));
+        return false;
+    }
+
+    if (closing_ && out_.empty() && fd_ >= 0)
+    {
+        // Our close frame is out; half-close and let the peer finish
+        shutdown(fd_, SHUT_WR);
+    }
+    return state_ != State::Closed;
+}
@@ -0,0 +1,205 @@
+/**
+ * @file ws_link.h
+ * @brief Non-blocking WebSocket connections for the host tools
+ *
+ * One WsLink wraps one TCP socket, on either end of the handshake: the
+ * gateway is a client of each rig and a server to each browser, and
+ * rig_sim and rig_watch each play one side. Everything runs from a
+ * poll() loop: the owner polls fd() for POLLIN, plus POLLOUT while
+ * wants_write(), and calls on_readable() / on_writable(). Outgoing
+ * frames are queued, so a slow peer never blocks the loop; the owner
+ * decides what to drop by watching queued().
+ *
+ * Only text and binary messages are surfaced. Pings are answered, close
+ * frames are echoed, and fragmented messages are reassembled. Extensions
+ * are never negotiated.
+ */
+
+#ifndef WS_LINK_H
+#define WS_LINK_H
+
+#include <netinet/in.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// CONSTANTS
+// =============================================================================
+
+#define WS_OPCODE_TEXT 0x1
+#define WS_OPCODE_BINARY 0x2
+
+#define WS_LINK_MAX_MESSAGE (1u << 20) // Larger incoming messages close the link
+#define WS_LINK_MAX_HANDSHAKE 8192     // Longest handshake request or response
+
+// =============================================================================
+// SOCKET HELPERS
+// =============================================================================
+
+/**
+ * @brief Wall clock (CLOCK_REALTIME) in Unix microseconds
+ */
+int64_t wall_clock_us();
+
+/**
+ * @brief Monotonic clock in milliseconds, for timeouts
+ */
+uint64_t monotonic_ms();
+
+/**
+ * @brief Open a non-blocking TCP listener on all interfaces
+ * @param port Port to listen on
+ * @return Socket, or -1 after printing the error
+ */
+int tcp_listen(uint16_t port);
+
+/**
+ * @brief Accept one pending connection as a non-blocking socket
+ * @param listener Listening socket
+ * @param peer Receives the peer address (may be NULL)
+ * @return Socket, or -1 if none was pending
+ */
+int tcp_accept(int listener, sockaddr_in *peer);
+
+/**
+ * @brief Resolve an IPv4 host name or address
+ * @param host Name or dotted address
+ * @param port Port to put in the address
+ * @param addr Receives the address
+ * @return true if resolved
+ */
+bool resolve_ipv4(const std::string &host, uint16_t port, sockaddr_in *addr);
+
+/**
+ * @brief Start a non-blocking connect; completion shows as writability
+ * @param addr Destination
+ * @return Socket, or -1 on immediate failure
+ */
+int tcp_connect(const sockaddr_in &addr);
+
+/**
+ * @brief Split "host[:port]"
+ * @param text Input
+ * @param host Receives the host part
+ * @param port Receives the port, left alone if none is given
+ * @return false if the port is present but not 1..65535
+ */
+bool split_host_port(const std::string &text, std::string &host, uint16_t &port);
+
+// =============================================================================
+// WEBSOCKET LINK
+// =============================================================================
+
+/**
+ * @brief One complete incoming message
+ */
+struct WsMessage
+{
+    uint8_t opcode; // WS_OPCODE_TEXT or WS_OPCODE_BINARY
+    std::string data;
+};
+
+class WsLink
+{
+public:
+    enum class State
+    {
+        Connecting, // Client: TCP connect in progress
+        Handshake,  // Waiting for the other side's handshake
+        Open,
+        Closed
+    };
+
+    /**
+     * @brief Client end; sends its request once the connect completes
+     * @param fd Socket from tcp_connect()
+     * @param host Host header value ("host:port")
+     * @param protocols Sec-WebSocket-Protocol offer, empty for none
+     */
+    static WsLink client(int fd, const std::string &host, const std::string &protocols = "");
+
+    /**
+     * @brief Server end of an accepted socket
+     * @param fd Socket from tcp_accept()
+     * @param protocol Subprotocol to accept when the client offers it, empty for none
+     */
+    static WsLink server(int fd, const std::string &protocol = "");
+
+    WsLink(WsLink &&other) noexcept;
+    WsLink &operator=(WsLink &&other) noexcept;
+    WsLink(const WsLink &) = delete;
+    WsLink &operator=(const WsLink &) = delete;
+    ~WsLink();
+
+    int fd() const { return fd_; }
+    State state() const { return state_; }
+    bool is_open() const { return state_ == State::Open; }
+    bool wants_write() const { return state_ == State::Connecting || !out_.empty(); }
+    size_t queued() const { return out_.size(); }
+    const std::string &protocol() const { return protocol_; }
+    const std::string &error() const { return error_; }
+
+    /**
+     * @brief Read what the socket has
+     * @param messages Complete messages are appended here
+     * @return false once the link is closed
+     */
+    bool on_readable(std::vector<WsMessage> &messages);
+
+    /**
+     * @brief Finish a connect and flush queued output
+     * @return false once the link is closed
+     */
+    bool on_writable();
+
+    /**
+     * @brief Queue one message (ignored unless open)
+     * @param opcode WS_OPCODE_TEXT or WS_OPCODE_BINARY
+     * @param data Payload
+     * @param len Payload length
+     */
+    void send(uint8_t opcode, const void *data, size_t len);
+    void send_text(const std::string &text) { send(WS_OPCODE_TEXT, text.data(), text.size()); }
+
+    /**
+     * @brief Send a close frame; the socket closes once it is flushed
+     * @param code Close status code
+     */
+    void close(uint16_t code = 1000);
+
+    /**
+     * @brief Drop the connection immediately
+     * @param why Reason kept in error()
+     */
+    void abort(const std::string &why);
+
+private:
+    WsLink(int fd, bool client);
+
+    void queue_frame(uint8_t opcode, const void *data, size_t len);
+    bool parse_handshake(std::vector<WsMessage> &messages);
+    bool client_handshake_done(const std::string &response);
+    bool server_handshake_done(const std::string &request);
+    bool parse_frames(std::vector<WsMessage> &messages);
+    bool fail(uint16_t code, const char *why);
+    bool flush();
+
+    int fd_ = -1;
+    bool client_ = false;
+    State state_ = State::Closed;
+    bool closing_ = false; // Close frame queued; shut down once flushed
+    std::string host_;
+    std::string offer_;    // Client: protocols offered; server: protocol accepted if offered
+    std::string protocol_; // Agreed subprotocol
+    std::string key_;      // Client: Sec-WebSocket-Key sent
+    std::string in_;
+    std::string out_;
+    std::string fragments_;
+    uint8_t fragment_opcode_ = 0;
+    std::string error_;
+};
+
+#endif // WS_LINK_H
@@ -0,0 +1,569 @@
+/**
+ * @file rig_capture.cpp
+ * @brief Capture the rig's UDP sample stream to a file
+ *
+ * Receives sample-block datagrams (src/utils/sample_stream.h), puts them
+ * back in sequence order with a small reorder window, accounts for every
+ * missing datagram and sample, and writes the frames as CSV (one row per
+ * frame, gaps as comment lines) or as the raw length-prefixed datagrams.
+ *
+ * Usage:
+ *   rig_capture [--port N] [--group ADDR] [--output FILE] [--raw]
+ *               [--duration SECONDS] [--reorder N] [--ntp-port N]
+ *
+ * Start the stream from the dashboard or a WebSocket client with
+ * "STREAM_START <this host's IP>[:port] [rate_hz]". Use --group to join a
+ * multicast destination; broadcast needs no extra option.
+ *
+ * Timestamps are on this host's clock (Unix microseconds) once the rig has
+ * synced its clock, and microseconds since the rig booted before that; a
+ * comment line marks each switch. With --ntp-port the tool also answers
+ * SNTP requests from its own clock, so rigs sent "TIME_SYNC <this host's
+ * IP>:N" produce captures that merge with each other and with host logs.
+ */
+
+#include "sample_stream.h"
+#include "clock_sync.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// OPTIONS
+// =============================================================================
+
+struct Options
+{
+    uint16_t port = 8082;
+    std::string group;
+    std::string output = "capture.csv";
+    bool raw = false;
+    double duration_s = 0;
+    size_t reorder_window = 8;
+    uint16_t ntp_port = 0; // 0: do not serve time
+};
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int)
+{
+    stop_requested = 1;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "Usage: %s [--port N] [--group ADDR] [--output FILE] [--raw] [--duration S] [--reorder N]\n"
+            "          [--ntp-port N]\n"
+            "  --port N      UDP port to listen on (default 8082)\n"
+            "  --group ADDR  Join this multicast group\n"
+            "  --output FILE Output file, '-' for stdout (default capture.csv)\n"
+            "  --raw         Write length-prefixed datagrams instead of CSV\n"
+            "  --duration S  Stop after S seconds\n"
+            "  --reorder N   Datagrams to hold while waiting for a late one (default 8)\n"
+            "  --ntp-port N  Answer the rigs' SNTP requests on this UDP port (123 needs root)\n",
+            argv0);
+}
+
+static bool parse_options(int argc, char **argv, Options &opt)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (arg == "--raw")
+        {
+            opt.raw = true;
+            continue;
+        }
+        if (value == nullptr)
+        {
+            return false;
+        }
+
+        if (arg == "--port")
+        {
+            opt.port = (uint16_t)atoi(value);
+        }
+        else if (arg == "--group")
+        {
+            opt.group = value;
+        }
+        else if (arg == "--output")
+        {
+            opt.output = value;
+        }
+        else if (arg == "--duration")
+        {
+            opt.duration_s = atof(value);
+        }
+        else if (arg == "--reorder")
+        {
+            opt.reorder_window = (size_t)atoi(value);
+        }
+        else if (arg == "--ntp-port")
+        {
+            opt.ntp_port = (uint16_t)atoi(value);
+            if (opt.ntp_port == 0)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+        i++;
+    }
+
+    return opt.port != 0;
+}
+
+// =============================================================================
+// OUTPUT
+// =============================================================================
+
+class CaptureWriter
+{
+public:
+    CaptureWriter(FILE *out, bool raw) : out_(out), raw_(raw)
+    {
+        sample_stream_tracker_init(&tracker_);
+        if (!raw_)
+        {
+            fprintf(out_, "# rig_capture sample stream\n");
+        }
+    }
+
+    void write(const sample_stream_header_t &header, const std::vector<uint8_t> &datagram)
+    {
+        uint64_t lost_before = tracker_.samples_lost;
+        uint32_t datagrams_lost_before = tracker_.datagrams_lost;
+        sample_stream_event_t event = sample_stream_track(&tracker_, &header);
+
+        if (header.flags & SAMPLE_STREAM_FLAG_OVERRUN)
+        {
+            overrun_blocks_++;
+        }
+
+        if (raw_)
+        {
+            uint8_t len[2] = {(uint8_t)datagram.size(), (uint8_t)(datagram.size() >> 8)};
+            fwrite(len, 1, 2, out_);
+            fwrite(datagram.data(), 1, datagram.size(), out_);
+            return;
+        }
+
+        if (!header_written_ || header.channel_count != channels_)
+        {
+            channels_ = header.channel_count;
+            fprintf(out_, "sample,timestamp_us");
+            for (unsigned ch = 0; ch < channels_; ch++)
+            {
+                fprintf(out_, ",ch%u", ch);
+            }
+            fprintf(out_, "\n");
+            header_written_ = true;
+        }
+
+        int host_time = (header.flags & SAMPLE_STREAM_FLAG_HOST_TIME) ? 1 : 0;
+        if (host_time != clock_)
+        {
+            fprintf(out_, "# timestamps from sample %u: %s\n", header.first_sample,
+                    host_time ? "host clock, Unix microseconds" : "device clock, microseconds since boot");
+            clock_ = host_time;
+        }
+
+        if (event == SAMPLE_STREAM_RESTART)
+        {
+            fprintf(out_, "# stream restarted at sequence %u\n", header.sequence);
+        }
+        else if (event == SAMPLE_STREAM_GAP)
+        {
+            fprintf(out_, "# gap: %u datagrams, %llu samples missing before sample %u%s\n",
+                    tracker_.datagrams_lost - datagrams_lost_before,
+                    (unsigned long long)(tracker_.samples_lost - lost_before), header.first_sample,
+                    (header.flags & SAMPLE_STREAM_FLAG_OVERRUN) ? " (device overrun)" : "");
+        }
+
+        const uint8_t *payload = datagram.data() + SAMPLE_STREAM_HEADER_SIZE;
+        double period_us = header.sample_rate_hz ? 1e6 / header.sample_rate_hz : 0;
+
+        for (uint16_t frame = 0; frame < header.frame_count; frame++)
+        {
+            fprintf(out_, "%u,%llu", header.first_sample + frame,
+                    (unsigned long long)(header.timestamp_us + (uint64_t)(frame * period_us)));
+            for (unsigned ch = 0; ch < channels_; ch++)
+            {
+                fprintf(out_, ",%u", sample_stream_get_sample(payload, (size_t)frame * channels_ + ch));
+            }
+            fputc('\n', out_);
+        }
+        frames_ += header.frame_count;
+    }
+
+    void late()
+    {
+        tracker_.datagrams_late++;
+    }
+
+    const sample_stream_tracker_t &tracker() const { return tracker_; }
+    uint64_t frames() const { return frames_; }
+    uint32_t overrun_blocks() const { return overrun_blocks_; }
+
+private:
+    FILE *out_;
+    bool raw_;
+    bool header_written_ = false;
+    unsigned channels_ = 0;
+    int clock_ = -1; // Which clock the last block's timestamps were on
+    uint64_t frames_ = 0;
+    uint32_t overrun_blocks_ = 0;
+    sample_stream_tracker_t tracker_;
+};
+
+// =============================================================================
+// REORDERING
+// =============================================================================
+
+/**
+ * Holds up to `window` datagrams that arrived ahead of a missing one, so a
+ * datagram that was merely reordered by the network is not counted as lost.
+ */
+class Reassembler
+{
+public:
+    Reassembler(CaptureWriter &writer, size_t window) : writer_(writer), window_(window) {}
+
+    void push(const sample_stream_header_t &header, std::vector<uint8_t> datagram)
+    {
+        if (!started_)
+        {
+            started_ = true;
+            next_ = header.sequence;
+        }
+
+        int32_t ahead = (int32_t)(header.sequence - next_);
+        if (ahead < 0)
+        {
+            if (header.sequence == 0 || -ahead >= 4096)
+            {
+                // Device restarted its stream: finish the old one first
+                flush();
+                next_ = header.sequence;
+            }
+            else
+            {
+                writer_.late(); // Already given up on, or a duplicate
+                return;
+            }
+        }
+
+        pending_[header.sequence] = Entry{header, std::move(datagram)};
+        drain();
+
+        if (pending_.size() > window_)
+        {
+            // Stop waiting for the missing datagram
+            next_ = pending_.begin()->first;
+            drain();
+        }
+    }
+
+    void flush()
+    {
+        while (!pending_.empty())
+        {
+            next_ = pending_.begin()->first;
+            drain();
+        }
+    }
+
+private:
+    struct Entry
+    {
+        sample_stream_header_t header;
+        std::vector<uint8_t> datagram;
+    };
+
+    void drain()
+    {
+        for (auto it = pending_.find(next_); it != pending_.end(); it = pending_.find(next_))
+        {
+            writer_.write(it->second.header, it->second.datagram);
+            pending_.erase(it);
+            next_++;
+        }
+    }
+
+    CaptureWriter &writer_;
+    size_t window_;
+    bool started_ = false;
+    uint32_t next_ = 0;
+    std::map<uint32_t, Entry> pending_;
+};
+
+// =============================================================================
+// TIME SERVICE
+// =============================================================================
+
+static int64_t host_time_us()
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int open_ntp_socket(uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+        perror("socket");
+        return -1;
+    }
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        perror("bind (ntp)");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Answer one SNTP request. The receive time is taken straight after
+ * recvfrom() and the transmit time just before sendto(), so the rig sees
+ * only the network in its round trip.
+ */
+static bool answer_ntp(int fd)
+{
+    uint8_t request[256];
+    uint8_t reply[CLOCK_SYNC_NTP_PACKET_SIZE];
+    sockaddr_in from = {};
+    socklen_t from_len = sizeof(from);
+
+    ssize_t len = recvfrom(fd, request, sizeof(request), 0, (sockaddr *)&from, &from_len);
+    int64_t receive_us = host_time_us();
+    if (len <= 0)
+    {
+        return false;
+    }
+
+    if (clock_sync_ntp_answer(request, (size_t)len, receive_us, host_time_us(), reply) == 0)
+    {
+        return false;
+    }
+    return sendto(fd, reply, sizeof(reply), 0, (sockaddr *)&from, from_len) == (ssize_t)sizeof(reply);
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+static int open_socket(const Options &opt)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+        perror("socket");
+        return -1;
+    }
+
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    // Ride out scheduling hiccups on the host without kernel drops
+    int rcvbuf = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(opt.port);
+    if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+
+    if (!opt.group.empty())
+    {
+        ip_mreq mreq = {};
+        if (inet_pton(AF_INET, opt.group.c_str(), &mreq.imr_multiaddr) != 1 ||
+            setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+        {
+            fprintf(stderr, "Cannot join multicast group %s\n", opt.group.c_str());
+            close(fd);
+            return -1;
+        }
+    }
+
+    return fd;
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    if (!parse_options(argc, argv, opt))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    int fd = open_socket(opt);
+    if (fd < 0)
+    {
+        return 1;
+    }
+
+    int ntp_fd = -1;
+    if (opt.ntp_port != 0)
+    {
+        ntp_fd = open_ntp_socket(opt.ntp_port);
+        if (ntp_fd < 0)
+        {
+            close(fd);
+            return 1;
+        }
+    }
+
+    FILE *out = opt.output == "-" ? stdout : fopen(opt.output.c_str(), opt.raw ? "wb" : "w");
+    if (out == nullptr)
+    {
+        perror(opt.output.c_str());
+        close(fd);
+        if (ntp_fd >= 0)
+        {
+            close(ntp_fd);
+        }
+        return 1;
+    }
+    static char out_buffer[1 << 16];
+    setvbuf(out, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    CaptureWriter writer(out, opt.raw);
+    Reassembler reassembler(writer, opt.reorder_window);
+    uint32_t rejected = 0;
+    uint32_t time_requests = 0;
+
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    auto last_report = start;
+    fprintf(stderr, "Listening on UDP port %u, writing %s\n", opt.port, opt.output.c_str());
+    if (ntp_fd >= 0)
+    {
+        fprintf(stderr, "Serving time on UDP port %u\n", opt.ntp_port);
+    }
+
+    std::vector<uint8_t> buffer(65536);
+    while (!stop_requested)
+    {
+        auto now = clock::now();
+        if (opt.duration_s > 0 && std::chrono::duration<double>(now - start).count() >= opt.duration_s)
+        {
+            break;
+        }
+
+        if (now - last_report >= std::chrono::seconds(2))
+        {
+            const sample_stream_tracker_t &t = writer.tracker();
+            fprintf(stderr, "\r%llu frames, %u datagrams, %u lost, %u late, %llu samples missing   ",
+                    (unsigned long long)writer.frames(), t.datagrams, t.datagrams_lost, t.datagrams_late,
+                    (unsigned long long)t.samples_lost);
+            last_report = now;
+        }
+
+        pollfd pfds[2] = {{fd, POLLIN, 0}, {ntp_fd, POLLIN, 0}};
+        int ready = poll(pfds, ntp_fd >= 0 ? 2 : 1, 200);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("poll");
+            break;
+        }
+        if (ready == 0)
+        {
+            // Idle: whatever is still held will not be completed
+            reassembler.flush();
+            continue;
+        }
+
+        if (ntp_fd >= 0 && (pfds[1].revents & POLLIN) && answer_ntp(ntp_fd))
+        {
+            time_requests++;
+        }
+        if (!(pfds[0].revents & POLLIN))
+        {
+            continue;
+        }
+
+        ssize_t len = recv(fd, buffer.data(), buffer.size(), 0);
+        if (len <= 0)
+        {
+            continue;
+        }
+
+        sample_stream_header_t header;
+        if (!sample_stream_parse(buffer.data(), (size_t)len, &header, nullptr))
+        {
+            rejected++;
+            continue;
+        }
+
+        reassembler.push(header, std::vector<uint8_t>(buffer.begin(), buffer.begin() + len));
+    }
+
+    reassembler.flush();
+    fflush(out);
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    close(fd);
+    if (ntp_fd >= 0)
+    {
+        close(ntp_fd);
+    }
+
+    const sample_stream_tracker_t &t = writer.tracker();
+    fprintf(stderr, "\nCaptured %llu frames in %u datagrams\n", (unsigned long long)writer.frames(), t.datagrams);
+    fprintf(stderr, "  datagrams lost:   %u\n", t.datagrams_lost);
+    fprintf(stderr, "  datagrams late:   %u (dropped)\n", t.datagrams_late);
+    fprintf(stderr, "  samples missing:  %llu\n", (unsigned long long)t.samples_lost);
+    fprintf(stderr, "  device overruns:  %u blocks\n", writer.overrun_blocks());
+    fprintf(stderr, "  stream restarts:  %u\n", t.restarts);
+    fprintf(stderr, "  invalid packets:  %u\n", rejected);
+    if (ntp_fd >= 0)
+    {
+        fprintf(stderr, "  time requests:    %u answered\n", time_requests);
+    }
+    return 0;
+}
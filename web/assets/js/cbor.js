@@ -0,0 +1,160 @@
+// Minimal CBOR (RFC 8949) codec for the rig.cbor WebSocket subprotocol.
+// Covers what the firmware sends and accepts: integers, floats, text,
+// arrays and maps (definite and indefinite length), booleans and null.
+const RigCbor = {
+    encode(value) {
+        const bytes = [];
+        const textEncoder = new TextEncoder();
+
+        const head = (major, length) => {
+            major <<= 5;
+            if (length < 24) {
+                bytes.push(major | length);
+            } else if (length < 0x100) {
+                bytes.push(major | 24, length);
+            } else if (length < 0x10000) {
+                bytes.push(major | 25, length >> 8, length & 0xff);
+            } else if (length < 0x100000000) {
+                bytes.push(major | 26, (length >>> 24) & 0xff, (length >> 16) & 0xff,
+                    (length >> 8) & 0xff, length & 0xff);
+            } else {
+                const high = Math.floor(length / 0x100000000);
+                bytes.push(major | 27);
+                for (const part of [high, length >>> 0]) {
+                    bytes.push((part >>> 24) & 0xff, (part >> 16) & 0xff, (part >> 8) & 0xff, part & 0xff);
+                }
+            }
+        };
+
+        const item = (v) => {
+            if (v === null || v === undefined) {
+                bytes.push(0xf6);
+            } else if (typeof v === 'boolean') {
+                bytes.push(v ? 0xf5 : 0xf4);
+            } else if (typeof v === 'number') {
+                if (Number.isSafeInteger(v)) {
+                    v >= 0 ? head(0, v) : head(1, -1 - v);
+                } else {
+                    const view = new DataView(new ArrayBuffer(8));
+                    view.setFloat64(0, v);
+                    bytes.push(0xfb, ...new Uint8Array(view.buffer));
+                }
+            } else if (typeof v === 'string') {
+                const utf8 = textEncoder.encode(v);
+                head(3, utf8.length);
+                bytes.push(...utf8);
+            } else if (Array.isArray(v)) {
+                head(4, v.length);
+                v.forEach(item);
+            } else {
+                const entries = Object.entries(v).filter(([, member]) => member !== undefined);
+                head(5, entries.length);
+                for (const [key, member] of entries) {
+                    item(key);
+                    item(member);
+                }
+            }
+        };
+
+        item(value);
+        return new Uint8Array(bytes);
+    },
+
+    decode(buffer) {
+        const view = new DataView(buffer);
+        const textDecoder = new TextDecoder();
+        let offset = 0;
+
+        const argument = (info) => {
+            if (info < 24) {
+                return info;
+            }
+            switch (info) {
+                case 24: return view.getUint8(offset++);
+                case 25: offset += 2; return view.getUint16(offset - 2);
+                case 26: offset += 4; return view.getUint32(offset - 4);
+                case 27: {
+                    offset += 8;
+                    return view.getUint32(offset - 8) * 0x100000000 + view.getUint32(offset - 4);
+                }
+                case 31: return -1; // Indefinite length
+                default: throw new Error(`Unsupported CBOR argument ${info}`);
+            }
+        };
+
+        const halfToFloat = (half) => {
+            const exponent = (half >> 10) & 0x1f;
+            const mantissa = half & 0x3ff;
+            const sign = half & 0x8000 ? -1 : 1;
+            if (exponent === 0) {
+                return sign * mantissa * Math.pow(2, -24);
+            }
+            if (exponent === 0x1f) {
+                return mantissa ? NaN : sign * Infinity;
+            }
+            return sign * (1 + mantissa / 1024) * Math.pow(2, exponent - 15);
+        };
+
+        const isBreak = () => {
+            if (view.getUint8(offset) === 0xff) {
+                offset++;
+                return true;
+            }
+            return false;
+        };
+
+        const item = () => {
+            const initial = view.getUint8(offset++);
+            const major = initial >> 5;
+            const info = initial & 0x1f;
+
+            if (major === 7) {
+                switch (info) {
+                    case 20: return false;
+                    case 21: return true;
+                    case 22: return null;
+                    case 23: return undefined;
+                    case 25: offset += 2; return halfToFloat(view.getUint16(offset - 2));
+                    case 26: offset += 4; return view.getFloat32(offset - 4);
+                    case 27: offset += 8; return view.getFloat64(offset - 8);
+                    default: throw new Error(`Unsupported CBOR simple value ${info}`);
+                }
+            }
+
+            const length = argument(info);
+            switch (major) {
+                case 0: return length;
+                case 1: return -1 - length;
+                case 2:
+                case 3: {
+                    const raw = new Uint8Array(buffer, offset, length);
+                    offset += length;
+                    return major === 3 ? textDecoder.decode(raw) : raw;
+                }
+                case 4: {
+                    const array = [];
+                    for (let i = 0; length < 0 ? !isBreak() : i < length; i++) {
+                        array.push(item());
+                    }
+                    return array;
+                }
+                case 5: {
+                    const object = {};
+                    for (let i = 0; length < 0 ? !isBreak() : i < length; i++) {
+                        const key = item();
+                        object[key] = item();
+                    }
+                    return object;
+                }
+                default: // Tag: the tagged item stands for itself
+                    return item();
+            }
+        };
+
+        const value = item();
+        if (offset !== view.byteLength) {
+            throw new Error('Trailing bytes after CBOR item');
+        }
+        return value;
+    }
+};
@@ -0,0 +1,223 @@
+// Live copy of the rig's display, painted from the binary frames the
+// DISPLAY_MIRROR command subscribes to. The wire format is described in
+// src/utils/display_stream.h: a 4-byte header, then SIZE / RECT / SCROLL
+// records whose pixels are RLE-coded RGB565.
+
+const DISPLAY_STREAM_MAGIC = 0x4452;
+const DISPLAY_STREAM_VERSION = 1;
+const OP_SIZE = 0x01;
+const OP_RECT = 0x02;
+const OP_SCROLL = 0x03;
+
+class DisplayMirror {
+    constructor(canvas) {
+        this.canvas = canvas;
+        this.context = canvas.getContext('2d');
+        this.image = null;
+        this.pixels = null; // Uint32Array view of the image, one RGBA pixel per element
+        this.dirty = null;  // {x0, y0, x1, y1} still to paint
+        this.paintQueued = false;
+        this.ws = null;
+        this.nextRequestId = 1;
+        this.stats = { messages: 0, bytes: 0, pixels: 0, errors: 0 };
+        this.onStatus = null;
+        this.onStats = null;
+    }
+
+    connect(ip) {
+        this.disconnect();
+        const wsUrl = `ws://${ip}:8080/ws`;
+        // Plain JSON: the only binary frames on this connection are then the mirror's
+        this.ws = new WebSocket(wsUrl, ['rig.json']);
+        this.ws.binaryType = 'arraybuffer';
+        this.setStatus(`Connecting to ${wsUrl}...`);
+
+        this.ws.onopen = () => {
+            this.setStatus(`Connected to ${ip}`);
+            this.ws.send(JSON.stringify({
+                type: 'command',
+                id: this.nextRequestId++,
+                command: 'DISPLAY_MIRROR',
+                params: { enabled: true }
+            }));
+        };
+        this.ws.onclose = (event) => this.setStatus(`Disconnected (code: ${event.code})`);
+        this.ws.onerror = () => this.setStatus('Connection error');
+        this.ws.onmessage = (event) => {
+            if (event.data instanceof ArrayBuffer) {
+                this.apply(new Uint8Array(event.data));
+                return;
+            }
+            const data = JSON.parse(event.data);
+            if (data.type === 'result' && data.command === 'DISPLAY_MIRROR') {
+                this.setStatus(data.ok ? `Mirroring ${data.result.width}x${data.result.height}`
+                                       : `Mirror refused: ${data.error}`);
+            }
+        };
+    }
+
+    disconnect() {
+        if (this.ws) {
+            this.ws.onclose = null;
+            this.ws.close();
+            this.ws = null;
+        }
+    }
+
+    setStatus(text) {
+        if (this.onStatus) {
+            this.onStatus(text);
+        }
+    }
+
+    // Apply one message; a malformed one is counted and dropped from the fault on
+    apply(message) {
+        const view = new DataView(message.buffer, message.byteOffset, message.byteLength);
+        if (message.length < 4 || view.getUint16(0, true) !== DISPLAY_STREAM_MAGIC ||
+            message[2] !== DISPLAY_STREAM_VERSION) {
+            this.stats.errors++;
+            return;
+        }
+
+        this.stats.messages++;
+        this.stats.bytes += message.length;
+        let pos = 4;
+        while (pos < message.length) {
+            const op = message[pos];
+            if (op === OP_SIZE) {
+                this.resize(view.getUint16(pos + 1, true), view.getUint16(pos + 3, true));
+                pos += 5;
+            } else if (op === OP_RECT && this.image) {
+                const x = view.getUint16(pos + 1, true);
+                const y = view.getUint16(pos + 3, true);
+                const w = view.getUint16(pos + 5, true);
+                const h = view.getUint16(pos + 7, true);
+                pos = this.decode(message, view, pos + 9, x, y, w, h);
+            } else if (op === OP_SCROLL && this.image) {
+                const x = view.getUint16(pos + 1, true);
+                const w = view.getUint16(pos + 3, true);
+                const h = view.getUint16(pos + 5, true);
+                const width = this.image.width;
+                for (let row = 0; row < h; row++) {
+                    const start = row * width + x;
+                    this.pixels.copyWithin(start, start + 1, start + w);
+                }
+                this.markDirty(x, 0, w, h);
+                pos = this.decode(message, view, pos + 7, x + w - 1, 0, 1, h);
+            } else {
+                pos = -1;
+            }
+            if (pos < 0) {
+                this.stats.errors++;
+                break;
+            }
+        }
+        this.queuePaint();
+    }
+
+    // RLE pixels of a w x h area into the image; returns the position after them, -1 if malformed
+    decode(message, view, pos, x, y, w, h) {
+        const image = this.image;
+        if (w === 0 || x + w > image.width || y + h > image.height) {
+            return -1;
+        }
+        const count = w * h;
+        let k = 0;
+        while (k < count) {
+            if (pos >= message.length) {
+                return -1;
+            }
+            const c = message[pos++];
+            const run = (c & 0x7F) + 1;
+            const repeat = (c & 0x80) !== 0;
+            if (k + run > count || pos + (repeat ? 2 : run * 2) > message.length) {
+                return -1;
+            }
+            for (let n = 0; n < run; n++, k++) {
+                const index = (y + Math.floor(k / w)) * image.width + x + k % w;
+                this.pixels[index] = rgb565ToRgba(view.getUint16(pos, true));
+                if (!repeat) {
+                    pos += 2;
+                }
+            }
+            if (repeat) {
+                pos += 2;
+            }
+        }
+        this.stats.pixels += count;
+        this.markDirty(x, y, w, h);
+        return pos;
+    }
+
+    resize(width, height) {
+        this.canvas.width = width;
+        this.canvas.height = height;
+        this.image = this.context.createImageData(width, height);
+        this.pixels = new Uint32Array(this.image.data.buffer);
+        this.pixels.fill(rgb565ToRgba(0));
+        this.markDirty(0, 0, width, height);
+    }
+
+    markDirty(x, y, w, h) {
+        if (!this.dirty) {
+            this.dirty = { x0: x, y0: y, x1: x + w, y1: y + h };
+            return;
+        }
+        this.dirty.x0 = Math.min(this.dirty.x0, x);
+        this.dirty.y0 = Math.min(this.dirty.y0, y);
+        this.dirty.x1 = Math.max(this.dirty.x1, x + w);
+        this.dirty.y1 = Math.max(this.dirty.y1, y + h);
+    }
+
+    // Paint once per animation frame, however many messages arrived
+    queuePaint() {
+        if (this.paintQueued) {
+            return;
+        }
+        this.paintQueued = true;
+        requestAnimationFrame(() => {
+            this.paintQueued = false;
+            if (this.dirty && this.image) {
+                const d = this.dirty;
+                this.context.putImageData(this.image, 0, 0, d.x0, d.y0, d.x1 - d.x0, d.y1 - d.y0);
+            }
+            this.dirty = null;
+            if (this.onStats) {
+                this.onStats(this.stats);
+            }
+        });
+    }
+}
+
+// ImageData is RGBA in memory order; on little-endian hosts that is ABGR as a Uint32
+function rgb565ToRgba(pixel) {
+    const r = ((pixel >> 11) & 0x1F) * 255 / 31;
+    const g = ((pixel >> 5) & 0x3F) * 255 / 63;
+    const b = (pixel & 0x1F) * 255 / 31;
+    return (0xFF000000 | (Math.round(b) << 16) | (Math.round(g) << 8) | Math.round(r)) >>> 0;
+}
+
+document.addEventListener('DOMContentLoaded', () => {
+    const mirror = new DisplayMirror(document.getElementById('displayCanvas'));
+    const ipInput = document.getElementById('picoIP');
+    const status = document.getElementById('mirrorStatus');
+    const statsText = document.getElementById('mirrorStats');
+    const started = performance.now();
+
+    ipInput.value = (location.protocol === 'http:' && location.hostname) ? location.hostname : '192.168.1.100';
+    mirror.onStatus = (text) => { status.textContent = text; };
+    mirror.onStats = (stats) => {
+        const seconds = (performance.now() - started) / 1000;
+        const ratio = stats.bytes ? (stats.pixels * 2 / stats.bytes).toFixed(1) : '-';
+        statsText.textContent = `${stats.messages} messages, ${(stats.bytes / 1024).toFixed(1)} KB ` +
+            `(${(stats.bytes / 1024 / seconds).toFixed(1)} KB/s), ${stats.pixels} pixels, ` +
+            `${ratio}:1 compression, ${stats.errors} errors`;
+    };
+
+    document.getElementById('connectButton').addEventListener('click', () => mirror.connect(ipInput.value));
+    document.getElementById('disconnectButton').addEventListener('click', () => {
+        mirror.disconnect();
+        status.textContent = 'Disconnected';
+    });
+    mirror.connect(ipInput.value);
+});
@@ -1,7 +1,8 @@
 // Global application state
 let appState = {
     connected: false,
-    picoIP: '192.168.1.100', // Default IP
+    // When the page is served by the rig itself, talk back to the same host
+    picoIP: (location.protocol === 'http:' && location.hostname) ? location.hostname : '192.168.1.100',
     logLevel: 'info'
 };
 
@@ -183,7 +184,7 @@ function emergencyStop() {
 }
 
 // Logging Functions
-function addLog(level, source, message) {
+function addLog(level, source, message, time) {
     // Check log level filtering
     const levels = ['error', 'warn', 'info', 'debug'];
     const currentLevelIndex = levels.indexOf(appState.logLevel);
@@ -199,7 +200,8 @@ function addLog(level, source, message) {
     const entry = document.createElement('div');
     entry.className = 'log-entry';
     
-    const timestamp = new Date().toLocaleTimeString();
+    // Device logs carry their own time (ms since the epoch) once the rig's clock is synced
+    const timestamp = new Date(time ?? Date.now()).toLocaleTimeString();
     
     entry.innerHTML = `
         <span class="log-timestamp">[${timestamp}]</span>
@@ -6,6 +6,9 @@ class PicoWebSocketClient {
         this.reconnectAttempts = 0;
         this.maxReconnectAttempts = 5;
         this.reconnectDelay = 1000; // Start with 1 second
+        this.nextRequestId = 1;
+        this.pendingRequests = new Map(); // id -> {resolve, reject}
+        this.encoding = 'json'; // 'cbor' once the rig accepts the binary subprotocol
         this.callbacks = {
             onConnect: [],
             onDisconnect: [],
@@ -23,7 +26,9 @@ class PicoWebSocketClient {
         const wsUrl = `ws://${ip}:8080/ws`;
         
         try {
-            this.ws = new WebSocket(wsUrl);
+            // Prefer compact CBOR; firmware without it answers with plain JSON
+            this.ws = new WebSocket(wsUrl, ['rig.cbor', 'rig.json']);
+            this.ws.binaryType = 'arraybuffer';
             this.setupEventHandlers();
             addLog('info', 'WebSocket', `Connecting to ${wsUrl}...`);
         } catch (error) {
@@ -38,6 +43,7 @@ class PicoWebSocketClient {
             this.ws = null;
         }
         this.isConnected = false;
+        this.rejectPendingRequests('Disconnected');
         this.triggerCallback('onDisconnect');
     }
 
@@ -46,7 +52,8 @@ class PicoWebSocketClient {
             this.isConnected = true;
             this.reconnectAttempts = 0;
             this.reconnectDelay = 1000;
-            addLog('info', 'WebSocket', `Connected to Pico W at ${this.picoIP}`);
+            this.encoding = this.ws.protocol === 'rig.cbor' ? 'cbor' : 'json';
+            addLog('info', 'WebSocket', `Connected to Pico W at ${this.picoIP} (${this.encoding})`);
             this.triggerCallback('onConnect');
             
             // Request initial status
@@ -55,6 +62,7 @@ class PicoWebSocketClient {
 
         this.ws.onclose = (event) => {
             this.isConnected = false;
+            this.rejectPendingRequests('Connection closed');
             addLog('warn', 'WebSocket', `Connection closed (code: ${event.code})`);
             this.triggerCallback('onDisconnect');
             
@@ -77,7 +85,9 @@ class PicoWebSocketClient {
 
         this.ws.onmessage = (event) => {
             try {
-                const data = JSON.parse(event.data);
+                const data = event.data instanceof ArrayBuffer
+                    ? RigCbor.decode(event.data)
+                    : JSON.parse(event.data);
                 this.handleMessage(data);
             } catch (error) {
                 // Handle plain text messages
@@ -103,14 +113,51 @@ class PicoWebSocketClient {
                 this.handleSystemInfo(data);
                 break;
             case 'log':
-                addLog(data.level || 'info', data.source || 'Pico', data.message);
+                addLog(data.level || 'info', data.source || 'Pico', data.message,
+                       data.synced ? data.ts / 1000 : undefined);
                 break;
             case 'error':
                 addLog('error', 'Pico', data.message);
                 break;
+            case 'result':
+            case 'batch_result':
+                this.handleResult(data);
+                break;
         }
     }
 
+    handleResult(data) {
+        const pending = this.pendingRequests.get(data.id);
+        this.pendingRequests.delete(data.id);
+
+        if (data.type === 'batch_result') {
+            if (pending) {
+                if (data.results) {
+                    pending.resolve(data.results);
+                } else {
+                    pending.reject(new Error(data.error));
+                }
+            }
+            return;
+        }
+
+        if (!data.ok) {
+            addLog('warn', 'Command', `${data.command || 'Command'} failed: ${data.error}`);
+        }
+        if (pending) {
+            if (data.ok) {
+                pending.resolve(data.result);
+            } else {
+                pending.reject(new Error(data.error));
+            }
+        }
+    }
+
+    rejectPendingRequests(reason) {
+        this.pendingRequests.forEach(pending => pending.reject(new Error(reason)));
+        this.pendingRequests.clear();
+    }
+
     handleStatusUpdate(data) {
         if (data.channels) {
             updateChannelStates(data.channels);
@@ -121,6 +168,13 @@ class PicoWebSocketClient {
     }
 
     handleChannelData(data) {
+        // Updates are change-only: fields that did not move are omitted and
+        // merged into the last known state by updateChannelData().
+        if (data.enabled !== undefined && diagnosticInterface) {
+            const states = diagnosticInterface.channelStates.slice();
+            states[data.channel - 1] = data.enabled;
+            updateChannelStates(states);
+        }
         updateChannelData(data.channel, data);
     }
 
@@ -129,21 +183,26 @@ class PicoWebSocketClient {
     }
 
     sendCommand(command, params = {}) {
-        if (!this.isConnected || !this.ws) {
-            addLog('warn', 'WebSocket', 'Not connected - command ignored');
-            return false;
-        }
-
-        const message = {
+        return this.sendMessage({
             type: 'command',
+            id: this.nextRequestId++,
             command: command,
             params: params,
             timestamp: Date.now()
-        };
+        });
+    }
+
+    sendMessage(message) {
+        if (!this.isConnected || !this.ws) {
+            addLog('warn', 'WebSocket', 'Not connected - command ignored');
+            return false;
+        }
 
         try {
-            this.ws.send(JSON.stringify(message));
-            addLog('debug', 'TX', `${command} ${JSON.stringify(params)}`);
+            this.ws.send(this.encoding === 'cbor' ? RigCbor.encode(message) : JSON.stringify(message));
+            addLog('debug', 'TX', message.type === 'batch'
+                ? `batch of ${message.commands.length}`
+                : `${message.command} ${JSON.stringify(message.params)}`);
             return true;
         } catch (error) {
             addLog('error', 'WebSocket', `Send failed: ${error.message}`);
@@ -151,6 +210,44 @@ class PicoWebSocketClient {
         }
     }
 
+    // Resolves with the command's result, rejects with its error
+    request(command, params = {}) {
+        const id = this.nextRequestId++;
+        return this.track(id, {
+            type: 'command',
+            id: id,
+            command: command,
+            params: params,
+            timestamp: Date.now()
+        });
+    }
+
+    // Runs [{command, params}, ...] in one frame, in order; resolves with
+    // one {command, ok, result|error} entry per command
+    batch(commands, stopOnError = false) {
+        const id = this.nextRequestId++;
+        return this.track(id, {
+            type: 'batch',
+            id: id,
+            stopOnError: stopOnError,
+            commands: commands.map((entry, index) => ({
+                id: index,
+                command: entry.command,
+                params: entry.params || {}
+            }))
+        });
+    }
+
+    track(id, message) {
+        return new Promise((resolve, reject) => {
+            this.pendingRequests.set(id, { resolve, reject });
+            if (!this.sendMessage(message)) {
+                this.pendingRequests.delete(id);
+                reject(new Error('Not connected'));
+            }
+        });
+    }
+
     // Event system
     on(event, callback) {
         if (this.callbacks[event]) {